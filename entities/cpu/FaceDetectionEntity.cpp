@@ -5,13 +5,39 @@
 
 #include "FaceDetectionEntity.h"
 #include "pipeline/data/FramePacket.h"
+#include "pipeline/utils/FrameArena.h"
+#include "pipeline/simd/PixelKernels.h"
 
 #include <cmath>
 #include <algorithm>
 #include <cstring>
+#include <limits>
 
 namespace pipeline {
 
+namespace {
+
+// 块匹配每个采样点的平均灰度差超过该值视为跟踪丢失
+constexpr float kTrackLostSad = 24.0f;
+
+// 重新检测的人脸与上一帧人脸IoU不低于该值时沿用跟踪ID
+constexpr float kTrackMatchIoU = 0.3f;
+
+float faceIoU(const FaceInfo& a, const FaceInfo& b) {
+    float left = std::max(a.x, b.x);
+    float top = std::max(a.y, b.y);
+    float right = std::min(a.x + a.width, b.x + b.width);
+    float bottom = std::min(a.y + a.height, b.y + b.height);
+    if (right <= left || bottom <= top) {
+        return 0.0f;
+    }
+    float intersection = (right - left) * (bottom - top);
+    float unionArea = a.width * a.height + b.width * b.height - intersection;
+    return unionArea > 0.0f ? intersection / unionArea : 0.0f;
+}
+
+} // namespace
+
 // =============================================================================
 // PIMPL实现类
 // =============================================================================
@@ -255,6 +281,10 @@ void FaceDetectionEntity::setTrackingEnabled(bool enabled) {
     mTrackingEnabled = enabled;
 }
 
+void FaceDetectionEntity::setMotionThreshold(float threshold) {
+    mMotionThreshold = std::max(0.0f, threshold);
+}
+
 // =============================================================================
 // CPU处理
 // =============================================================================
@@ -270,27 +300,47 @@ bool FaceDetectionEntity::processOnCPU(const uint8_t* data,
     }
     
     mFrameCounter++;
+    mFramesSinceDetection++;
+    mGrayFrame = nullptr;  // 灰度图每帧最多转换一次
+    mObservedThisFrame = false;
+    
+    // 画面变化检测与块匹配都在缩小的跟踪图上进行
+    buildTrackFrame(grayFrame(data, width, height, stride), width, height);
     
-    // 决定是执行检测还是跟踪
-    bool needDetection = (mFrameCounter % mDetectionInterval == 0) || 
-                         mLastResult.faces.empty();
+    // 检测调度：到达最长间隔、跟踪丢失或场景切换时执行完整检测
+    bool needDetection = mForceDetection || mFramesSinceDetection >= mDetectionInterval;
+    if (!needDetection && mMotionThreshold > 0.0f && measureMotion() > mMotionThreshold) {
+        needDetection = true;
+    }
     
-    std::vector<FaceInfo> faces;
+    // 结果在 mLastResult.faces 上原地更新，检测结果先写入复用的暂存区，
+    // 稳态下（含各人脸的关键点数组）不产生分配
+    std::vector<FaceInfo>& faces = mLastResult.faces;
     
     if (needDetection) {
-        // 执行完整检测
-        if (!detectFaces(data, width, height, stride, faces)) {
-            // 检测失败，使用上次结果
-            faces = mLastResult.faces;
+        // 执行完整检测（失败时保留上次结果，下一帧重试）
+        mDetectedFaces.clear();
+        if (detectFaces(data, width, height, stride, mDetectedFaces)) {
+            assignTracks(mDetectedFaces);
+            faces.swap(mDetectedFaces);
+            mMotionReference.assign(mTrackFrame.begin(), mTrackFrame.end());
+            mMotionReferenceWidth = mTrackWidth;
+            mMotionReferenceHeight = mTrackHeight;
+            mFramesSinceDetection = 0;
+            mForceDetection = false;
+            mObservedThisFrame = true;
         }
-    } else if (mTrackingEnabled && !mLastResult.faces.empty()) {
-        // 执行跟踪
-        faces = mLastResult.faces;
-        trackFaces(data, width, height, stride, faces);
-    } else {
-        // 复用上次结果
-        faces = mLastResult.faces;
+    } else if (mTrackingEnabled && !faces.empty()) {
+        // 执行跟踪，丢失时下一帧重新检测
+        mForceDetection = !trackFaces(data, width, height, stride, faces);
+        mObservedThisFrame = true;
     }
+    // 否则在 onProcessComplete 中按时间戳外推上次结果
+    
+    // 本帧跟踪图作为下一帧块匹配的参考
+    mPreviousTrackFrame.swap(mTrackFrame);
+    mPreviousTrackWidth = mTrackWidth;
+    mPreviousTrackHeight = mTrackHeight;
     
     // 检测关键点
     if (mDetectLandmarks && !faces.empty()) {
@@ -299,42 +349,15 @@ bool FaceDetectionEntity::processOnCPU(const uint8_t* data,
         }
     }
     
-    // 更新结果
-    mLastResult.faces = faces;
-    mLastResult.timestamp = 0; // 由调用方设置
+    // 更新结果（时间戳在 onProcessComplete 中设置）
     mLastResult.imageWidth = width;
     mLastResult.imageHeight = height;
     
-    // 存储到metadata
-    // 将结果序列化为可存储的格式
+    // 完整结果在 onProcessComplete 中写入类型化元数据；
+    // 这里只保留少量字符串键兼容旧的读取方
     if (!faces.empty()) {
-        // 存储人脸数量
         metadata["face_count"] = static_cast<int>(faces.size());
         
-        // 存储每个人脸的信息
-        for (size_t i = 0; i < faces.size(); ++i) {
-            const auto& face = faces[i];
-            std::string prefix = "face_" + std::to_string(i) + "_";
-            
-            metadata[prefix + "x"] = face.x;
-            metadata[prefix + "y"] = face.y;
-            metadata[prefix + "w"] = face.width;
-            metadata[prefix + "h"] = face.height;
-            metadata[prefix + "confidence"] = face.confidence;
-            metadata[prefix + "roll"] = face.roll;
-            metadata[prefix + "pitch"] = face.pitch;
-            metadata[prefix + "yaw"] = face.yaw;
-            
-            // 存储关键点
-            if (!face.landmarks.empty()) {
-                metadata[prefix + "landmark_count"] = static_cast<int>(face.landmarks.size());
-                for (size_t j = 0; j < face.landmarks.size(); ++j) {
-                    metadata[prefix + "lm_" + std::to_string(j) + "_x"] = face.landmarks[j].x;
-                    metadata[prefix + "lm_" + std::to_string(j) + "_y"] = face.landmarks[j].y;
-                }
-            }
-        }
-        
         // 存储主要人脸的边界框（便于简单访问）
         std::string boundsStr = std::to_string(faces[0].x) + "," + 
                                std::to_string(faces[0].y) + "," +
@@ -349,6 +372,56 @@ bool FaceDetectionEntity::processOnCPU(const uint8_t* data,
     return true;
 }
 
+void FaceDetectionEntity::onProcessComplete(FramePacketPtr input, FramePacketPtr output) {
+    if (!output) {
+        return;
+    }
+    uint64_t timestamp = input ? input->getTimestamp() : output->getTimestamp();
+    mLastResult.timestamp = timestamp;
+    
+    auto& faces = mLastResult.faces;
+    size_t count = std::min(faces.size(), mTracks.size());
+    
+    // 观测帧：由相邻两次观测估计各人脸速度（指数平滑抑制检测框抖动）
+    if (mObservedThisFrame) {
+        for (size_t i = 0; i < count; ++i) {
+            FaceTrack& track = mTracks[i];
+            const FaceInfo& face = faces[i];
+            if (track.observedTimestamp != 0 && timestamp > track.observedTimestamp) {
+                float dt = static_cast<float>(timestamp - track.observedTimestamp);
+                float vx = (face.x - track.observedX) / dt;
+                float vy = (face.y - track.observedY) / dt;
+                track.velocityX = track.hasVelocity ? 0.5f * (track.velocityX + vx) : vx;
+                track.velocityY = track.hasVelocity ? 0.5f * (track.velocityY + vy) : vy;
+                track.hasVelocity = true;
+            }
+            track.observedX = face.x;
+            track.observedY = face.y;
+            track.observedTimestamp = timestamp;
+        }
+    }
+    
+    // 赋值复用槽位中已有 vector 的容量
+    if (FaceDetectionResult* result = output->emplaceMetadata(kFaceDetectionResultKey)) {
+        *result = mLastResult;
+        if (!mObservedThisFrame) {
+            // 未检测也未跟踪的帧：按时间戳沿速度外推，下游美颜区域随人脸平滑移动
+            for (size_t i = 0; i < std::min(count, result->faces.size()); ++i) {
+                const FaceTrack& track = mTracks[i];
+                if (!track.hasVelocity || timestamp <= track.observedTimestamp) {
+                    continue;
+                }
+                FaceInfo& face = result->faces[i];
+                float dt = static_cast<float>(timestamp - track.observedTimestamp);
+                face.x = std::clamp(track.observedX + track.velocityX * dt,
+                                    0.0f, std::max(0.0f, 1.0f - face.width));
+                face.y = std::clamp(track.observedY + track.velocityY * dt,
+                                    0.0f, std::max(0.0f, 1.0f - face.height));
+            }
+        }
+    }
+}
+
 // =============================================================================
 // 检测实现
 // =============================================================================
@@ -357,11 +430,8 @@ bool FaceDetectionEntity::detectFaces(const uint8_t* data,
                                       uint32_t width, uint32_t height,
                                       uint32_t stride,
                                       std::vector<FaceInfo>& faces) {
-    // 转换为灰度图
-    convertToGray(data, width, height, stride, mGrayBuffer);
-    
     // 调用检测后端
-    return mImpl->detect(mGrayBuffer.data(), width, height,
+    return mImpl->detect(grayFrame(data, width, height, stride), width, height,
                         mMinFaceSize, mConfidenceThreshold, mMaxFaces, faces);
 }
 
@@ -373,59 +443,189 @@ bool FaceDetectionEntity::detectLandmarks(const uint8_t* data,
         return false;
     }
     
-    // 确保灰度缓冲区存在
-    if (mGrayBuffer.empty()) {
-        convertToGray(data, width, height, stride, mGrayBuffer);
-    }
-    
-    // 调用关键点检测
-    return mImpl->detectLandmarks(mGrayBuffer.data(), width, height, face, mLandmarkCount);
+    // 调用关键点检测（与检测/跟踪共用本帧灰度图）
+    return mImpl->detectLandmarks(grayFrame(data, width, height, stride), width, height,
+                                  face, mLandmarkCount);
 }
 
 bool FaceDetectionEntity::trackFaces(const uint8_t* data,
                                      uint32_t width, uint32_t height,
                                      uint32_t stride,
                                      std::vector<FaceInfo>& faces) {
-    // 简单的跟踪实现：使用模板匹配或光流
-    // 这里提供一个简化的实现，实际使用中应该用更robust的跟踪算法
+    // 上一帧跟踪图中的人脸区域作为模板，在本帧邻域内做SAD块匹配（先步长2粗搜再±1细化）
+    if (mTrackWidth < 8 || mTrackHeight < 8 || mPreviousTrackWidth != mTrackWidth ||
+        mPreviousTrackHeight != mTrackHeight) {
+        return false;
+    }
     
-    // 转换为灰度图
-    convertToGray(data, width, height, stride, mGrayBuffer);
+    const int frameWidth = static_cast<int>(mTrackWidth);
+    const int frameHeight = static_cast<int>(mTrackHeight);
+    const uint8_t* previous = mPreviousTrackFrame.data();
+    const uint8_t* current = mTrackFrame.data();
+    bool allTracked = true;
+    
+    for (auto& face : faces) {
+        int boxWidth = std::clamp(static_cast<int>(std::lround(face.width * frameWidth)), 4, frameWidth);
+        int boxHeight = std::clamp(static_cast<int>(std::lround(face.height * frameHeight)), 4, frameHeight);
+        int boxX = std::clamp(static_cast<int>(std::lround(face.x * frameWidth)), 0, frameWidth - boxWidth);
+        int boxY = std::clamp(static_cast<int>(std::lround(face.y * frameHeight)), 0, frameHeight - boxHeight);
+        
+        // 模板最多约 16x16 个采样点，搜索半径随人脸尺寸变化
+        int sampleStep = std::max(1, std::max(boxWidth, boxHeight) / 16);
+        int radius = std::max(2, std::max(boxWidth, boxHeight) / 4);
+        
+        auto sad = [&](int dx, int dy) -> uint32_t {
+            int x0 = boxX + dx;
+            int y0 = boxY + dy;
+            if (x0 < 0 || y0 < 0 || x0 + boxWidth > frameWidth || y0 + boxHeight > frameHeight) {
+                return std::numeric_limits<uint32_t>::max();
+            }
+            uint32_t sum = 0;
+            for (int y = 0; y < boxHeight; y += sampleStep) {
+                const uint8_t* ref = previous + (boxY + y) * frameWidth + boxX;
+                const uint8_t* cur = current + (y0 + y) * frameWidth + x0;
+                for (int x = 0; x < boxWidth; x += sampleStep) {
+                    sum += static_cast<uint32_t>(std::abs(static_cast<int>(ref[x]) - static_cast<int>(cur[x])));
+                }
+            }
+            return sum;
+        };
+        
+        int bestDx = 0;
+        int bestDy = 0;
+        uint32_t bestSad = sad(0, 0);
+        for (int dy = -radius; dy <= radius; dy += 2) {
+            for (int dx = -radius; dx <= radius; dx += 2) {
+                uint32_t value = sad(dx, dy);
+                if (value < bestSad) {
+                    bestSad = value;
+                    bestDx = dx;
+                    bestDy = dy;
+                }
+            }
+        }
+        int coarseDx = bestDx;
+        int coarseDy = bestDy;
+        for (int dy = coarseDy - 1; dy <= coarseDy + 1; ++dy) {
+            for (int dx = coarseDx - 1; dx <= coarseDx + 1; ++dx) {
+                uint32_t value = sad(dx, dy);
+                if (value < bestSad) {
+                    bestSad = value;
+                    bestDx = dx;
+                    bestDy = dy;
+                }
+            }
+        }
+        
+        uint32_t samples = static_cast<uint32_t>(((boxWidth + sampleStep - 1) / sampleStep) *
+                                                 ((boxHeight + sampleStep - 1) / sampleStep));
+        if (static_cast<float>(bestSad) / samples > kTrackLostSad) {
+            allTracked = false;
+            continue;
+        }
+        
+        face.x = std::clamp(static_cast<float>(boxX + bestDx) / frameWidth,
+                            0.0f, std::max(0.0f, 1.0f - face.width));
+        face.y = std::clamp(static_cast<float>(boxY + bestDy) / frameHeight,
+                            0.0f, std::max(0.0f, 1.0f - face.height));
+    }
     
-    // TODO: 实现真正的跟踪算法
-    // 可以使用：
-    // 1. KCF跟踪器
-    // 2. 光流法
-    // 3. 简单的模板匹配
+    return allTracked;
+}
+
+void FaceDetectionEntity::buildTrackFrame(const uint8_t* gray, uint32_t width, uint32_t height) {
+    mTrackWidth = std::min(width, kTrackMaxWidth);
+    mTrackHeight = std::max(1u, static_cast<uint32_t>(static_cast<uint64_t>(height) * mTrackWidth / width));
+    mTrackFrame.resize(static_cast<size_t>(mTrackWidth) * mTrackHeight);
     
-    // 简化处理：假设人脸位置变化不大，直接返回
-    // 在实际应用中，应该根据相邻帧的特征点匹配来更新位置
+    if (mTrackWidth == width && mTrackHeight == height) {
+        std::memcpy(mTrackFrame.data(), gray, mTrackFrame.size());
+        return;
+    }
+    simd::scale(gray, width, width, height,
+                mTrackFrame.data(), mTrackWidth, mTrackWidth, mTrackHeight,
+                1, simd::ScaleFilter::Box);
+}
+
+float FaceDetectionEntity::measureMotion() const {
+    if (mMotionReference.empty() || mMotionReferenceWidth != mTrackWidth ||
+        mMotionReferenceHeight != mTrackHeight) {
+        return std::numeric_limits<float>::max();
+    }
     
-    return true;
+    // 隔点采样足以区分场景切换与普通运动
+    uint64_t sum = 0;
+    uint64_t samples = 0;
+    for (uint32_t y = 0; y < mTrackHeight; y += 2) {
+        const uint8_t* ref = mMotionReference.data() + static_cast<size_t>(y) * mTrackWidth;
+        const uint8_t* cur = mTrackFrame.data() + static_cast<size_t>(y) * mTrackWidth;
+        for (uint32_t x = 0; x < mTrackWidth; x += 2) {
+            sum += static_cast<uint64_t>(std::abs(static_cast<int>(ref[x]) - static_cast<int>(cur[x])));
+            ++samples;
+        }
+    }
+    return samples > 0 ? static_cast<float>(sum) / samples : 0.0f;
 }
 
-void FaceDetectionEntity::convertToGray(const uint8_t* rgba,
-                                        uint32_t width, uint32_t height,
-                                        uint32_t stride,
-                                        std::vector<uint8_t>& gray) {
-    gray.resize(width * height);
+void FaceDetectionEntity::assignTracks(std::vector<FaceInfo>& faces) {
+    // mTracks 与 mLastResult.faces 对应；匹配上的沿用ID与速度，其余分配新ID
+    mPreviousTracks.swap(mTracks);
+    mTracks.clear();
+    const auto& previousFaces = mLastResult.faces;
+    size_t previousCount = std::min(previousFaces.size(), mPreviousTracks.size());
     
-    for (uint32_t y = 0; y < height; ++y) {
-        const uint8_t* row = rgba + y * stride;
-        uint8_t* grayRow = gray.data() + y * width;
+    for (auto& face : faces) {
+        size_t bestIndex = previousCount;
+        float bestIoU = kTrackMatchIoU;
+        for (size_t i = 0; i < previousCount; ++i) {
+            if (mPreviousTracks[i].id == 0) {
+                continue;  // 已被其他人脸认领
+            }
+            float iou = faceIoU(face, previousFaces[i]);
+            if (iou >= bestIoU) {
+                bestIoU = iou;
+                bestIndex = i;
+            }
+        }
         
-        for (uint32_t x = 0; x < width; ++x) {
-            // RGBA格式，使用标准灰度转换公式
-            // Gray = 0.299*R + 0.587*G + 0.114*B
-            const uint8_t* pixel = row + x * 4;
-            uint8_t r = pixel[0];
-            uint8_t g = pixel[1];
-            uint8_t b = pixel[2];
-            
-            // 使用整数运算近似：(77*R + 150*G + 29*B) >> 8
-            grayRow[x] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b) >> 8);
+        FaceTrack track;
+        if (bestIndex < previousCount) {
+            track = mPreviousTracks[bestIndex];
+            mPreviousTracks[bestIndex].id = 0;
+        } else {
+            track.id = mNextTrackId++;
         }
+        face.trackId = track.id;
+        mTracks.push_back(track);
     }
 }
 
+const uint8_t* FaceDetectionEntity::grayFrame(const uint8_t* rgba,
+                                              uint32_t width, uint32_t height,
+                                              uint32_t stride) {
+    if (mGrayFrame) {
+        return mGrayFrame;
+    }
+    
+    // 帧内执行时取自帧内存区（本帧结束回收），否则使用成员缓冲
+    size_t size = static_cast<size_t>(width) * height;
+    uint8_t* gray = nullptr;
+    if (FrameArena* arena = FrameArena::current()) {
+        gray = arena->allocateArray<uint8_t>(size);
+    } else {
+        mGrayBuffer.resize(size);
+        gray = mGrayBuffer.data();
+    }
+    convertToGray(rgba, width, height, stride, gray);
+    mGrayFrame = gray;
+    return gray;
+}
+
+void FaceDetectionEntity::convertToGray(const uint8_t* rgba,
+                                        uint32_t width, uint32_t height,
+                                        uint32_t stride,
+                                        uint8_t* gray) {
+    simd::rgbaToGray(rgba, stride, gray, width, width, height);
+}
+
 } // namespace pipeline
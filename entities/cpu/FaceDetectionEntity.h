@@ -31,6 +31,9 @@ struct FaceInfo {
     // 置信度
     float confidence = 0;
     
+    // 跟踪ID（同一张人脸跨帧保持不变，0表示未分配）
+    uint32_t trackId = 0;
+    
     // 关键点（可选）
     std::vector<FaceLandmark> landmarks;
     
@@ -50,6 +53,11 @@ struct FaceDetectionResult {
     uint32_t imageHeight = 0;
 };
 
+/**
+ * @brief 人脸检测结果的类型化元数据键（下游通过 packet->getMetadata(kFaceDetectionResultKey) 读取）
+ */
+inline const MetadataKey<FaceDetectionResult> kFaceDetectionResultKey{"face_detection_result"};
+
 /**
  * @brief 人脸检测算法后端
  */
@@ -171,8 +179,9 @@ public:
     /**
      * @brief 设置检测间隔帧数
      * 
-     * 不是每帧都执行检测，而是间隔N帧检测一次，
-     * 中间帧使用跟踪算法或直接复用上次结果。
+     * 不是每帧都执行检测，而是最多间隔N帧检测一次，
+     * 中间帧使用跟踪算法或按时间戳外推上次结果。
+     * 画面大幅变化或跟踪丢失时提前检测。
      * @param interval 间隔帧数（1表示每帧检测）
      */
     void setDetectionInterval(uint32_t interval);
@@ -194,6 +203,20 @@ public:
      */
     bool isTrackingEnabled() const { return mTrackingEnabled; }
     
+    /**
+     * @brief 设置触发重新检测的画面变化阈值
+     * 
+     * 在缩小的灰度图上计算与上次检测帧的平均绝对差（0-255），
+     * 超过阈值视为场景切换，下一次处理立即执行完整检测。
+     * @param threshold 阈值（0表示只按间隔检测）
+     */
+    void setMotionThreshold(float threshold);
+    
+    /**
+     * @brief 获取画面变化阈值
+     */
+    float getMotionThreshold() const { return mMotionThreshold; }
+    
     // ==========================================================================
     // 结果获取
     // ==========================================================================
@@ -223,6 +246,8 @@ protected:
     
     PixelFormat getRequiredFormat() const override { return PixelFormat::RGBA8; }
     
+    void onProcessComplete(FramePacketPtr input, FramePacketPtr output) override;
+    
 private:
     /**
      * @brief 执行人脸检测
@@ -241,7 +266,8 @@ private:
                         FaceInfo& face);
     
     /**
-     * @brief 跟踪人脸
+     * @brief 跟踪人脸（在跟踪图上对上一帧的人脸区域做块匹配）
+     * @return 全部人脸跟踪成功返回true
      */
     bool trackFaces(const uint8_t* data,
                    uint32_t width, uint32_t height,
@@ -249,12 +275,34 @@ private:
                    std::vector<FaceInfo>& faces);
     
     /**
-     * @brief 转换为灰度图
+     * @brief 由本帧灰度图生成跟踪图（宽度不超过 kTrackMaxWidth）
+     */
+    void buildTrackFrame(const uint8_t* gray, uint32_t width, uint32_t height);
+    
+    /**
+     * @brief 跟踪图相对上次检测帧的平均绝对差（尺寸不同时返回最大值）
+     */
+    float measureMotion() const;
+    
+    /**
+     * @brief 为新检测结果分配跟踪ID（与上一帧的人脸按IoU匹配）
+     */
+    void assignTracks(std::vector<FaceInfo>& faces);
+    
+    /**
+     * @brief 获取本帧灰度图（首次调用时转换，帧内多次调用共用）
+     */
+    const uint8_t* grayFrame(const uint8_t* rgba,
+                             uint32_t width, uint32_t height,
+                             uint32_t stride);
+    
+    /**
+     * @brief 转换为灰度图（gray 至少 width * height 字节）
      */
     void convertToGray(const uint8_t* rgba,
                       uint32_t width, uint32_t height,
                       uint32_t stride,
-                      std::vector<uint8_t>& gray);
+                      uint8_t* gray);
     
 private:
     // 后端
@@ -275,6 +323,36 @@ private:
     // 性能参数
     uint32_t mDetectionInterval = 3;
     bool mTrackingEnabled = true;
+    float mMotionThreshold = 12.0f;
+    
+    // 跟踪状态（与 mLastResult.faces 一一对应）
+    struct FaceTrack {
+        uint32_t id = 0;
+        float observedX = 0;          // 上次观测（检测或跟踪）的位置
+        float observedY = 0;
+        uint64_t observedTimestamp = 0;
+        float velocityX = 0;          // 每时间戳单位的位移（归一化坐标）
+        float velocityY = 0;
+        bool hasVelocity = false;
+    };
+    std::vector<FaceTrack> mTracks;
+    std::vector<FaceTrack> mPreviousTracks;  // 重新检测时用于匹配ID（复用容量）
+    uint32_t mNextTrackId = 1;
+    
+    // 检测调度
+    static constexpr uint32_t kTrackMaxWidth = 160;
+    std::vector<uint8_t> mTrackFrame;         // 本帧跟踪图（缩小的灰度图）
+    std::vector<uint8_t> mPreviousTrackFrame; // 上一帧跟踪图
+    std::vector<uint8_t> mMotionReference;    // 上次检测帧的跟踪图
+    uint32_t mTrackWidth = 0;
+    uint32_t mTrackHeight = 0;
+    uint32_t mPreviousTrackWidth = 0;
+    uint32_t mPreviousTrackHeight = 0;
+    uint32_t mMotionReferenceWidth = 0;
+    uint32_t mMotionReferenceHeight = 0;
+    uint32_t mFramesSinceDetection = 0;
+    bool mForceDetection = true;              // 首帧、跟踪丢失或场景切换
+    bool mObservedThisFrame = false;          // 本帧人脸位置来自检测或跟踪
     
     // 状态
     uint32_t mFrameCounter = 0;
@@ -282,7 +360,9 @@ private:
     std::string mResultMetadataKey = "face_detection";
     
     // 临时缓冲
-    std::vector<uint8_t> mGrayBuffer;
+    std::vector<uint8_t> mGrayBuffer;       // 无帧内存区时的灰度图缓冲
+    const uint8_t* mGrayFrame = nullptr;    // 本帧灰度图（每帧开始时清空）
+    std::vector<FaceInfo> mDetectedFaces;   // 检测结果暂存区（与 mLastResult.faces 交换复用）
     std::vector<uint8_t> mScaledBuffer;
     
     // 后端实现（使用PIMPL模式隐藏具体实现）
@@ -4,8 +4,10 @@
  */
 
 #include "BeautyEntity.h"
+#include "../cpu/FaceDetectionEntity.h"
 #include "pipeline/data/FramePacket.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/PipelineFacade.h"
 
 #include <cmath>
 #include <algorithm>
@@ -154,6 +156,130 @@ void main() {
 }
 )";
 
+// 可分离高斯（双线性优化）：每次采样落在两个离散抽头之间，由硬件插值一次取回两抽头的加权和
+const char* kSeparableBlurFragmentShader = R"(
+precision mediump float;
+varying vec2 vTexCoord;
+
+uniform sampler2D uInputTexture;
+uniform vec2 uDirection;        // 单位纹素 * 轴向（水平 (1/w, 0)，垂直 (0, 1/h)）
+uniform float uOffsets[8];
+uniform float uWeights[8];
+uniform int uTapCount;
+
+void main() {
+    vec4 result = texture2D(uInputTexture, vTexCoord) * uWeights[0];
+    for (int i = 1; i < 8; i++) {
+        if (i >= uTapCount) break;
+        vec2 offset = uDirection * uOffsets[i];
+        result += texture2D(uInputTexture, vTexCoord + offset) * uWeights[i];
+        result += texture2D(uInputTexture, vTexCoord - offset) * uWeights[i];
+    }
+    gl_FragColor = result;
+}
+)";
+
+// 可分离高斯（计算内核）：每个工作组处理一行/一列上的128个像素，
+// 先把像素及两侧各32个边缘像素读进共享内存，每个像素的全部抽头都从共享内存取，
+// 每个源像素只采样一次；半径最大32，不必像片段路径那样截断大半径的核
+const char* kSeparableBlurComputeShader = R"(
+#version 310 es
+precision mediump float;
+precision mediump image2D;
+
+#define GROUP_SIZE 128
+#define MAX_RADIUS 32
+
+layout(local_size_x = GROUP_SIZE, local_size_y = 1) in;
+
+uniform sampler2D uInputTexture;
+layout(rgba8, binding = 0) writeonly uniform mediump image2D uOutputImage;
+
+uniform ivec2 uOutputSize;
+uniform ivec2 uDirection;       // 水平 (1, 0)，垂直 (0, 1)
+uniform ivec4 uRegion;          // 模糊区域 {x, y, w, h}（输出像素）
+uniform float uWeights[MAX_RADIUS + 1];
+uniform int uRadius;
+
+shared vec4 sTile[GROUP_SIZE + 2 * MAX_RADIUS];
+
+vec4 fetch(int along, int across) {
+    ivec2 p = uDirection.x == 1 ? ivec2(along, across) : ivec2(across, along);
+    p = clamp(p, ivec2(0), uOutputSize - 1);
+    // 输入可能是全分辨率（水平Pass）：按归一化坐标采样，双线性兼作降采样
+    return texture(uInputTexture, (vec2(p) + 0.5) / vec2(uOutputSize));
+}
+
+void main() {
+    int lineLength = uDirection.x == 1 ? uRegion.z : uRegion.w;
+    int lineStart = uDirection.x == 1 ? uRegion.x : uRegion.y;
+    int across = int(gl_WorkGroupID.y) + (uDirection.x == 1 ? uRegion.y : uRegion.x);
+    int groupStart = lineStart + int(gl_WorkGroupID.x) * GROUP_SIZE;
+    int local = int(gl_LocalInvocationID.x);
+
+    // 载入本组像素与两侧边缘（每个线程最多载入两个）
+    for (int i = local; i < GROUP_SIZE + 2 * MAX_RADIUS; i += GROUP_SIZE) {
+        sTile[i] = fetch(groupStart + i - MAX_RADIUS, across);
+    }
+    barrier();
+
+    int along = groupStart + local;
+    if (along >= lineStart + lineLength) {
+        return;
+    }
+    int center = local + MAX_RADIUS;
+    vec4 result = sTile[center] * uWeights[0];
+    for (int i = 1; i <= MAX_RADIUS; i++) {
+        if (i > uRadius) break;
+        result += (sTile[center - i] + sTile[center + i]) * uWeights[i];
+    }
+    ivec2 p = uDirection.x == 1 ? ivec2(along, across) : ivec2(across, along);
+    imageStore(uOutputImage, p, result);
+}
+)";
+
+constexpr uint32_t kComputeBlurGroupSize = 128;
+constexpr int kComputeBlurMaxRadius = 32;
+
+// 双重Kawase下采样：中心 + 4个对角半像素采样
+const char* kKawaseDownFragmentShader = R"(
+precision mediump float;
+varying vec2 vTexCoord;
+
+uniform sampler2D uInputTexture;
+uniform vec2 uHalfTexel;        // 源纹理的半纹素
+
+void main() {
+    vec4 sum = texture2D(uInputTexture, vTexCoord) * 4.0;
+    sum += texture2D(uInputTexture, vTexCoord - uHalfTexel);
+    sum += texture2D(uInputTexture, vTexCoord + uHalfTexel);
+    sum += texture2D(uInputTexture, vTexCoord + vec2(uHalfTexel.x, -uHalfTexel.y));
+    sum += texture2D(uInputTexture, vTexCoord - vec2(uHalfTexel.x, -uHalfTexel.y));
+    gl_FragColor = sum / 8.0;
+}
+)";
+
+// 双重Kawase上采样：十字4点 + 对角4点（权重2）
+const char* kKawaseUpFragmentShader = R"(
+precision mediump float;
+varying vec2 vTexCoord;
+
+uniform sampler2D uInputTexture;
+uniform vec2 uHalfTexel;
+
+void main() {
+    vec4 sum = texture2D(uInputTexture, vTexCoord + vec2(-uHalfTexel.x * 2.0, 0.0));
+    sum += texture2D(uInputTexture, vTexCoord + vec2(uHalfTexel.x * 2.0, 0.0));
+    sum += texture2D(uInputTexture, vTexCoord + vec2(0.0, -uHalfTexel.y * 2.0));
+    sum += texture2D(uInputTexture, vTexCoord + vec2(0.0, uHalfTexel.y * 2.0));
+    sum += texture2D(uInputTexture, vTexCoord + vec2(-uHalfTexel.x, uHalfTexel.y)) * 2.0;
+    sum += texture2D(uInputTexture, vTexCoord + vec2(uHalfTexel.x, uHalfTexel.y)) * 2.0;
+    sum += texture2D(uInputTexture, vTexCoord + vec2(uHalfTexel.x, -uHalfTexel.y)) * 2.0;
+    sum += texture2D(uInputTexture, vTexCoord + vec2(-uHalfTexel.x, -uHalfTexel.y)) * 2.0;
+    gl_FragColor = sum / 12.0;
+}
+)";
+
 // 锐化着色器
 const char* kSharpenFragmentShader = R"(
 precision highp float;
@@ -194,7 +320,8 @@ uniform sampler2D uBlurTexture;
 uniform float uSmoothLevel;
 uniform float uWhitenLevel;
 uniform float uRuddyLevel;
-uniform vec4 uFaceBounds;
+uniform vec4 uFaceBounds[4];
+uniform int uFaceCount;
 uniform bool uUseFaceDetection;
 
 // 皮肤检测
@@ -248,10 +375,15 @@ void main() {
     // 检测是否在人脸区域
     bool inFaceRegion = true;
     if (uUseFaceDetection) {
-        inFaceRegion = vTexCoord.x >= uFaceBounds.x && 
-                       vTexCoord.x <= uFaceBounds.x + uFaceBounds.z &&
-                       vTexCoord.y >= uFaceBounds.y && 
-                       vTexCoord.y <= uFaceBounds.y + uFaceBounds.w;
+        inFaceRegion = false;
+        for (int i = 0; i < 4; i++) {
+            if (i >= uFaceCount) break;
+            vec4 b = uFaceBounds[i];
+            if (vTexCoord.x >= b.x && vTexCoord.x <= b.x + b.z &&
+                vTexCoord.y >= b.y && vTexCoord.y <= b.y + b.w) {
+                inFaceRegion = true;
+            }
+        }
     }
     
     // 检测是否为皮肤区域
@@ -299,18 +431,117 @@ BeautyEntity::~BeautyEntity() = default;
 // =============================================================================
 
 void BeautyEntity::setSmoothLevel(float level) {
-    mSmoothLevel = std::clamp(level, 0.0f, 1.0f);
+    level = std::clamp(level, 0.0f, 1.0f);
+    mParamBlock.update([level](BeautyParams& params) { params.smoothLevel = level; });
+}
+
+float BeautyEntity::getSmoothLevel() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.smoothLevel; });
 }
 
 void BeautyEntity::setSmoothAlgorithm(BeautyAlgorithm algorithm) {
-    if (mSmoothAlgorithm != algorithm) {
-        mSmoothAlgorithm = algorithm;
-//        mNeedsShaderUpdate = true;
-    }
+    mParamBlock.update([algorithm](BeautyParams& params) { params.smoothAlgorithm = algorithm; });
+}
+
+BeautyAlgorithm BeautyEntity::getSmoothAlgorithm() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.smoothAlgorithm; });
 }
 
 void BeautyEntity::setSmoothRadius(float radius) {
-    mSmoothRadius = std::clamp(radius, 1.0f, 20.0f);
+    radius = std::clamp(radius, 1.0f, 20.0f);
+    mParamBlock.update([radius](BeautyParams& params) { params.smoothRadius = radius; });
+}
+
+void BeautyEntity::setBlurConfig(const BeautyBlurConfig& config) {
+    BeautyBlurConfig clamped = config;
+    clamped.downsample = std::clamp<uint32_t>(config.downsample, 1, 4);
+    clamped.kawaseIterations = std::clamp<uint32_t>(config.kawaseIterations, 1, 4);
+    clamped.roiPadding = std::max(0.0f, config.roiPadding);
+    mParamBlock.update([&clamped](BeautyParams& params) { params.blur = clamped; });
+}
+
+BeautyBlurConfig BeautyEntity::getBlurConfig() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.blur; });
+}
+
+void BeautyEntity::setQualityLevel(QualityLevel quality) {
+    BeautyBlurConfig config = getBlurConfig();
+    switch (quality) {
+        case QualityLevel::Low:
+            config.mode = BeautyBlurMode::DualKawase;
+            config.downsample = 4;
+            config.kawaseIterations = 1;
+            config.faceROIOnly = true;
+            break;
+        case QualityLevel::Medium:
+            config.mode = BeautyBlurMode::Separable;
+            config.downsample = 2;
+            config.faceROIOnly = true;
+            break;
+        case QualityLevel::High:
+            config.mode = BeautyBlurMode::Separable;
+            config.downsample = 2;
+            config.faceROIOnly = false;
+            break;
+        case QualityLevel::Ultra:
+            config.mode = BeautyBlurMode::Reference;
+            config.downsample = 1;
+            config.faceROIOnly = false;
+            break;
+    }
+    // ROI 依赖人脸检测结果，未接入检测时退回整帧模糊
+    config.faceROIOnly = config.faceROIOnly && getUseFaceDetection();
+    setBlurConfig(config);
+}
+
+void BeautyEntity::computeLinearSampledKernel(float sigma,
+                                              std::vector<float>& offsets,
+                                              std::vector<float>& weights,
+                                              size_t maxTaps) {
+    offsets.clear();
+    weights.clear();
+    maxTaps = std::max<size_t>(maxTaps, 1);
+    
+    // 单侧离散抽头数受采样数限制：N+1 次采样覆盖 2N 个离散抽头
+    const int maxRadius = static_cast<int>(2 * (maxTaps - 1));
+    sigma = std::max(sigma, 0.1f);
+    const int radius = std::min(static_cast<int>(std::ceil(sigma * 3.0f)), maxRadius);
+    
+    std::vector<float> discrete(static_cast<size_t>(radius) + 1);
+    float sum = 0.0f;
+    for (int i = 0; i <= radius; ++i) {
+        discrete[i] = std::exp(-(i * i) / (2.0f * sigma * sigma));
+        sum += (i == 0) ? discrete[i] : 2.0f * discrete[i];
+    }
+    for (auto& w : discrete) {
+        w /= sum;
+    }
+    
+    offsets.push_back(0.0f);
+    weights.push_back(discrete[0]);
+    for (int i = 1; i <= radius; i += 2) {
+        const float a = discrete[i];
+        const float b = (i + 1 <= radius) ? discrete[i + 1] : 0.0f;
+        const float w = a + b;
+        offsets.push_back((i * a + (i + 1) * b) / w);
+        weights.push_back(w);
+    }
+}
+
+void BeautyEntity::computeDiscreteKernel(float sigma, std::vector<float>& weights,
+                                         int maxRadius) {
+    sigma = std::max(sigma, 0.1f);
+    const int radius = std::clamp(static_cast<int>(std::ceil(sigma * 3.0f)), 0,
+                                  std::max(maxRadius, 0));
+    weights.assign(static_cast<size_t>(radius) + 1, 0.0f);
+    float sum = 0.0f;
+    for (int i = 0; i <= radius; ++i) {
+        weights[i] = std::exp(-(i * i) / (2.0f * sigma * sigma));
+        sum += (i == 0) ? weights[i] : 2.0f * weights[i];
+    }
+    for (auto& w : weights) {
+        w /= sum;
+    }
 }
 
 // =============================================================================
@@ -318,7 +549,12 @@ void BeautyEntity::setSmoothRadius(float radius) {
 // =============================================================================
 
 void BeautyEntity::setWhitenLevel(float level) {
-    mWhitenLevel = std::clamp(level, 0.0f, 1.0f);
+    level = std::clamp(level, 0.0f, 1.0f);
+    mParamBlock.update([level](BeautyParams& params) { params.whitenLevel = level; });
+}
+
+float BeautyEntity::getWhitenLevel() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.whitenLevel; });
 }
 
 // =============================================================================
@@ -326,7 +562,12 @@ void BeautyEntity::setWhitenLevel(float level) {
 // =============================================================================
 
 void BeautyEntity::setRuddyLevel(float level) {
-    mRuddyLevel = std::clamp(level, 0.0f, 1.0f);
+    level = std::clamp(level, 0.0f, 1.0f);
+    mParamBlock.update([level](BeautyParams& params) { params.ruddyLevel = level; });
+}
+
+float BeautyEntity::getRuddyLevel() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.ruddyLevel; });
 }
 
 // =============================================================================
@@ -334,7 +575,12 @@ void BeautyEntity::setRuddyLevel(float level) {
 // =============================================================================
 
 void BeautyEntity::setSharpenLevel(float level) {
-    mSharpenLevel = std::clamp(level, 0.0f, 1.0f);
+    level = std::clamp(level, 0.0f, 1.0f);
+    mParamBlock.update([level](BeautyParams& params) { params.sharpenLevel = level; });
+}
+
+float BeautyEntity::getSharpenLevel() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.sharpenLevel; });
 }
 
 // =============================================================================
@@ -342,11 +588,25 @@ void BeautyEntity::setSharpenLevel(float level) {
 // =============================================================================
 
 void BeautyEntity::setEyeEnlargeLevel(float level) {
-    mEyeEnlargeLevel = std::clamp(level, 0.0f, 1.0f);
+    level = std::clamp(level, 0.0f, 1.0f);
+    mParamBlock.update([level](BeautyParams& params) { params.eyeEnlargeLevel = level; });
 }
 
 void BeautyEntity::setFaceSlimLevel(float level) {
-    mFaceSlimLevel = std::clamp(level, 0.0f, 1.0f);
+    level = std::clamp(level, 0.0f, 1.0f);
+    mParamBlock.update([level](BeautyParams& params) { params.faceSlimLevel = level; });
+}
+
+// =============================================================================
+// 人脸信息
+// =============================================================================
+
+void BeautyEntity::setUseFaceDetection(bool use) {
+    mParamBlock.update([use](BeautyParams& params) { params.useFaceDetection = use; });
+}
+
+bool BeautyEntity::getUseFaceDetection() const {
+    return mParamBlock.read([](const BeautyParams& params) { return params.useFaceDetection; });
 }
 
 // =============================================================================
@@ -354,37 +614,58 @@ void BeautyEntity::setFaceSlimLevel(float level) {
 // =============================================================================
 
 void BeautyEntity::setPreset(const std::string& presetName) {
+    // 一个预设的几项参数一次发布，渲染线程不会看到新旧混合的组合
+    auto apply = [this](float smooth, float whiten, float ruddy, float sharpen) {
+        mParamBlock.update([=](BeautyParams& params) {
+            params.smoothLevel = smooth;
+            params.whitenLevel = whiten;
+            params.ruddyLevel = ruddy;
+            params.sharpenLevel = sharpen;
+        });
+    };
     if (presetName == "natural") {
-        mSmoothLevel = 0.3f;
-        mWhitenLevel = 0.2f;
-        mRuddyLevel = 0.1f;
-        mSharpenLevel = 0.0f;
+        apply(0.3f, 0.2f, 0.1f, 0.0f);
     } else if (presetName == "clear") {
-        mSmoothLevel = 0.5f;
-        mWhitenLevel = 0.4f;
-        mRuddyLevel = 0.2f;
-        mSharpenLevel = 0.1f;
+        apply(0.5f, 0.4f, 0.2f, 0.1f);
     } else if (presetName == "goddess") {
-        mSmoothLevel = 0.7f;
-        mWhitenLevel = 0.5f;
-        mRuddyLevel = 0.3f;
-        mSharpenLevel = 0.15f;
+        apply(0.7f, 0.5f, 0.3f, 0.15f);
     } else if (presetName == "none") {
         reset();
     }
 }
 
 void BeautyEntity::reset() {
-    mSmoothLevel = 0.0f;
-    mWhitenLevel = 0.0f;
-    mRuddyLevel = 0.0f;
-    mSharpenLevel = 0.0f;
-    mEyeEnlargeLevel = 0.0f;
-    mFaceSlimLevel = 0.0f;
+    mParamBlock.update([](BeautyParams& params) {
+        params.smoothLevel = 0.0f;
+        params.whitenLevel = 0.0f;
+        params.ruddyLevel = 0.0f;
+        params.sharpenLevel = 0.0f;
+        params.eyeEnlargeLevel = 0.0f;
+        params.faceSlimLevel = 0.0f;
+    });
+}
+
+void BeautyEntity::latchParameters() {
+    if (!mParamBlock.acquire()) {
+        return;
+    }
+    const BeautyParams& params = mParamBlock.current();
+    mSmoothLevel = params.smoothLevel;
+    mSmoothRadius = params.smoothRadius;
+    mSmoothAlgorithm = params.smoothAlgorithm;
+    mBlurConfig = params.blur;
+    mWhitenLevel = params.whitenLevel;
+    mRuddyLevel = params.ruddyLevel;
+    mSharpenLevel = params.sharpenLevel;
+    mEyeEnlargeLevel = params.eyeEnlargeLevel;
+    mFaceSlimLevel = params.faceSlimLevel;
+    mUseFaceDetection = params.useFaceDetection;
+    markParametersDirty();
 }
 
 void BeautyEntity::onParameterChanged(const std::string& key) {
     // 参数变化时的回调
+    GPUEntity::onParameterChanged(key);
 }
 
 // =============================================================================
@@ -395,17 +676,17 @@ bool BeautyEntity::setupShader() {
     mVertexShaderSource = kBeautyVertexShader;
     mFragmentShaderSource = kBilateralFilterFragmentShader;
     
-    // TODO: 创建着色器程序
-    // mShaderProgram = mRenderContext->createShaderProgram(
-    //     mVertexShaderSource, mFragmentShaderSource);
+    mShaderProgram = acquireShaderProgram(mVertexShaderSource, mFragmentShaderSource);
     
-    // 创建其他着色器
-    // mBilateralShader = mRenderContext->createShaderProgram(
-    //     kBeautyVertexShader, kBilateralFilterFragmentShader);
-    // mSharpenShader = mRenderContext->createShaderProgram(
-    //     kBeautyVertexShader, kSharpenFragmentShader);
-    // mBeautyBlendShader = mRenderContext->createShaderProgram(
-    //     kBeautyVertexShader, kBeautyBlendFragmentShader);
+    // 创建其他着色器（双边滤波与主程序源码相同，缓存返回同一个程序）
+    mBilateralShader = acquireShaderProgram(kBeautyVertexShader, kBilateralFilterFragmentShader);
+    mSharpenShader = acquireShaderProgram(kBeautyVertexShader, kSharpenFragmentShader);
+    mBeautyBlendShader = acquireShaderProgram(kBeautyVertexShader, kBeautyBlendFragmentShader);
+    mSeparableBlurShader = acquireShaderProgram(kBeautyVertexShader, kSeparableBlurFragmentShader);
+    mKawaseDownShader = acquireShaderProgram(kBeautyVertexShader, kKawaseDownFragmentShader);
+    mKawaseUpShader = acquireShaderProgram(kBeautyVertexShader, kKawaseUpFragmentShader);
+    mComputeBlurShader = isComputeSupported(mRenderContext)
+        ? acquireComputeProgram(kSeparableBlurComputeShader) : nullptr;
     
     // 缓存Uniform位置
     // mSmoothLevelLocation = mBeautyBlendShader->getUniformLocation("uSmoothLevel");
@@ -429,12 +710,16 @@ void BeautyEntity::setUniforms(FramePacket* input) {
     }
 }
 
-bool BeautyEntity::createBlurTextures() {
+bool BeautyEntity::createBlurTextures(uint32_t width, uint32_t height) {
     if (!mRenderContext) return false;
     
-    // TODO: 创建模糊中间纹理
-    // mBlurTexture1 = mRenderContext->createTexture(mOutputWidth, mOutputHeight, PixelFormat::RGBA8);
-    // mBlurTexture2 = mRenderContext->createTexture(mOutputWidth, mOutputHeight, PixelFormat::RGBA8);
+    // 模糊中间纹理只在本帧多Pass之间存活：从纹理池取出，Pass结束后 releaseBlurTextures 归还，
+    // 降采样路径下尺寸只有输入的 1/4~1/16（无纹理池时退化为自行创建）
+    mBlurTexture1 = acquireTransientTexture(width, height, PixelFormat::RGBA8);
+    mBlurTexture2 = acquireTransientTexture(width, height, PixelFormat::RGBA8);
+    // TODO: 无纹理池时创建
+    // mBlurTexture1 = mRenderContext->createTexture(width, height, PixelFormat::RGBA8);
+    // mBlurTexture2 = mRenderContext->createTexture(width, height, PixelFormat::RGBA8);
     // mBlurFBO1 = mRenderContext->createFrameBuffer();
     // mBlurFBO1->attachColorTexture(mBlurTexture1);
     // mBlurFBO2 = mRenderContext->createFrameBuffer();
@@ -443,6 +728,225 @@ bool BeautyEntity::createBlurTextures() {
     return true;
 }
 
+void BeautyEntity::releaseBlurTextures() {
+    mBlurTexture1.reset();
+    mBlurTexture2.reset();
+    mKawaseChain.clear();
+}
+
+bool BeautyEntity::computeBlurRegion(uint32_t blurWidth, uint32_t blurHeight, float margin) {
+    mBlurRegion = BlurRegion{0, 0, static_cast<int32_t>(blurWidth), static_cast<int32_t>(blurHeight)};
+    if (!mBlurConfig.faceROIOnly || !mUseFaceDetection) {
+        return true;
+    }
+    if (mFaceRegionCount == 0) {
+        // 无人脸：混合着色器不会使用模糊结果，整组模糊 Pass 可以省掉
+        return false;
+    }
+    
+    // 外扩后的人脸框并集（纹理坐标，与混合着色器的 uFaceBounds 一致）
+    float x0 = 1.0f, y0 = 1.0f, x1 = 0.0f, y1 = 0.0f;
+    for (size_t i = 0; i < mFaceRegionCount; ++i) {
+        const float* box = mFaceRegions[i].boundingBox;
+        const float padX = box[2] * mBlurConfig.roiPadding;
+        const float padY = box[3] * mBlurConfig.roiPadding;
+        x0 = std::min(x0, box[0] - padX);
+        y0 = std::min(y0, box[1] - padY);
+        x1 = std::max(x1, box[0] + box[2] + padX);
+        y1 = std::max(y1, box[1] + box[3] + padY);
+    }
+    
+    // 核半径外的像素也会被ROI边缘采样到，裁剪区域需额外留出 margin
+    const float left = std::floor(x0 * blurWidth - margin);
+    const float top = std::floor(y0 * blurHeight - margin);
+    const float right = std::ceil(x1 * blurWidth + margin);
+    const float bottom = std::ceil(y1 * blurHeight + margin);
+    
+    const int32_t rx0 = std::clamp(static_cast<int32_t>(left), 0, static_cast<int32_t>(blurWidth));
+    const int32_t ry0 = std::clamp(static_cast<int32_t>(top), 0, static_cast<int32_t>(blurHeight));
+    const int32_t rx1 = std::clamp(static_cast<int32_t>(right), 0, static_cast<int32_t>(blurWidth));
+    const int32_t ry1 = std::clamp(static_cast<int32_t>(bottom), 0, static_cast<int32_t>(blurHeight));
+    if (rx1 <= rx0 || ry1 <= ry0) {
+        return false;
+    }
+    mBlurRegion = BlurRegion{rx0, ry0, rx1 - rx0, ry1 - ry0};
+    return true;
+}
+
+std::shared_ptr<lrengine::render::LRTexture> BeautyEntity::performBlur(
+    std::shared_ptr<lrengine::render::LRTexture> input,
+    uint32_t width, uint32_t height) {
+    if (!input || mSmoothLevel <= 0.0f || width == 0 || height == 0) {
+        return nullptr;
+    }
+    
+    // 磨皮半径按全分辨率像素设置，代理分辨率帧等比缩小，预览与录制的磨皮范围一致
+    const float radius = mSmoothRadius * getRenderScale();
+    
+    if (mBlurConfig.mode == BeautyBlurMode::Reference) {
+        if (!computeBlurRegion(width, height, radius) ||
+            !createBlurTextures(width, height)) {
+            return nullptr;
+        }
+        performBilateralFilter(input, mBlurTexture1);
+        return mBlurTexture1;
+    }
+    
+    const uint32_t divisor = std::max<uint32_t>(1, mBlurConfig.downsample);
+    const uint32_t blurWidth = std::max<uint32_t>(1, width / divisor);
+    const uint32_t blurHeight = std::max<uint32_t>(1, height / divisor);
+    
+    if (mBlurConfig.mode == BeautyBlurMode::DualKawase) {
+        performDualKawaseBlur(input, width, height, blurWidth, blurHeight);
+        return mKawaseChain.empty() ? nullptr : mKawaseChain.front();
+    }
+    
+    // 换算到模糊纹理像素
+    const float sigma = std::max(0.5f, radius / (3.0f * divisor));
+    performSeparableBlur(input, blurWidth, blurHeight, sigma);
+    return mBlurTexture2;
+}
+
+void BeautyEntity::performSeparableBlur(std::shared_ptr<lrengine::render::LRTexture> input,
+                                        uint32_t blurWidth, uint32_t blurHeight, float sigma) {
+    if (sigma != mKernelSigma) {
+        computeLinearSampledKernel(sigma, mKernelOffsets, mKernelWeights);
+        mKernelSigma = sigma;
+    }
+    const float margin = mKernelOffsets.empty() ? 0.0f : std::ceil(mKernelOffsets.back());
+    if (!computeBlurRegion(blurWidth, blurHeight, margin) ||
+        !createBlurTextures(blurWidth, blurHeight)) {
+        releaseBlurTextures();
+        return;
+    }
+    
+    if (mComputeBlurShader && isComputePreferred()) {
+        performComputeBlur(input, blurWidth, blurHeight, sigma);
+        return;
+    }
+    
+    // Pass 1: 水平。直接采样全分辨率输入，1/2 时硬件双线性兼作降采样的2x2平均；
+    // 1/4 降采样会跳过部分源像素，低质量档因此使用 DualKawase
+    // mBlurFBO1->attachColorTexture(mBlurTexture1);
+    // mBlurFBO1->bind();
+    // glViewport(0, 0, blurWidth, blurHeight);
+    // glEnable(GL_SCISSOR_TEST);
+    // glScissor(mBlurRegion.x, mBlurRegion.y, mBlurRegion.width, mBlurRegion.height);
+    // mSeparableBlurShader->use();
+    // input->bind(0);
+    // mSeparableBlurShader->setUniform("uInputTexture", 0);
+    // mSeparableBlurShader->setUniform("uDirection", 1.0f / blurWidth, 0.0f);
+    // mSeparableBlurShader->setUniformArray("uOffsets", mKernelOffsets.data(), mKernelOffsets.size());
+    // mSeparableBlurShader->setUniformArray("uWeights", mKernelWeights.data(), mKernelWeights.size());
+    // mSeparableBlurShader->setUniform("uTapCount", static_cast<int>(mKernelOffsets.size()));
+    // drawFullscreenQuad();
+    
+    // Pass 2: 垂直（mBlurTexture1 -> mBlurTexture2）
+    // mBlurFBO2->attachColorTexture(mBlurTexture2);
+    // mBlurFBO2->bind();
+    // mBlurTexture1->bind(0);
+    // mSeparableBlurShader->setUniform("uDirection", 0.0f, 1.0f / blurHeight);
+    // drawFullscreenQuad();
+    // glDisable(GL_SCISSOR_TEST);
+    (void)input;
+}
+
+void BeautyEntity::performComputeBlur(std::shared_ptr<lrengine::render::LRTexture> input,
+                                      uint32_t blurWidth, uint32_t blurHeight, float sigma) {
+    if (sigma != mComputeKernelSigma) {
+        computeDiscreteKernel(sigma, mComputeKernelWeights, kComputeBlurMaxRadius);
+        mComputeKernelSigma = sigma;
+    }
+    // 离散核半径可能大于片段路径的截断半径，区域余量按实际半径重算
+    const float margin = static_cast<float>(mComputeKernelWeights.size() - 1);
+    if (!computeBlurRegion(blurWidth, blurHeight, margin)) {
+        return;
+    }
+    const uint32_t regionWidth = static_cast<uint32_t>(mBlurRegion.width);
+    const uint32_t regionHeight = static_cast<uint32_t>(mBlurRegion.height);
+    
+    // mComputeBlurShader->setUniform("uOutputSize", (int)blurWidth, (int)blurHeight);
+    // mComputeBlurShader->setUniform("uRegion", mBlurRegion.x, mBlurRegion.y,
+    //                                mBlurRegion.width, mBlurRegion.height);
+    // mComputeBlurShader->setUniformArray("uWeights", mComputeKernelWeights.data(),
+    //                                     mComputeKernelWeights.size());
+    // mComputeBlurShader->setUniform("uRadius", (int)mComputeKernelWeights.size() - 1);
+    // mRenderContext->SetComputeProgram(mComputeBlurShader.get());
+    
+    // Pass 1: 水平（输入 -> mBlurTexture1），每行 ceil(w / 128) 个工作组
+    // mRenderContext->SetTexture(input.get(), 0);
+    // mComputeBlurShader->setUniform("uDirection", 1, 0);
+    bindImageTexture(mBlurTexture1, 0, ImageAccess::WriteOnly, PixelFormat::RGBA8);
+    dispatchCompute(getDispatchGroupCount(regionWidth, kComputeBlurGroupSize), regionHeight);
+    computeBarrier();
+    
+    // Pass 2: 垂直（mBlurTexture1 -> mBlurTexture2）
+    // mRenderContext->SetTexture(mBlurTexture1.get(), 0);
+    // mComputeBlurShader->setUniform("uDirection", 0, 1);
+    bindImageTexture(mBlurTexture2, 0, ImageAccess::WriteOnly, PixelFormat::RGBA8);
+    dispatchCompute(getDispatchGroupCount(regionHeight, kComputeBlurGroupSize), regionWidth);
+    computeBarrier();
+    (void)input;
+}
+
+void BeautyEntity::performDualKawaseBlur(std::shared_ptr<lrengine::render::LRTexture> input,
+                                         uint32_t width, uint32_t height,
+                                         uint32_t blurWidth, uint32_t blurHeight) {
+    const uint32_t iterations = std::max<uint32_t>(1, mBlurConfig.kawaseIterations);
+    
+    // 每级采样跨度翻倍，最底层的一个像素约覆盖模糊分辨率的 2^iterations 像素
+    const float margin = static_cast<float>(2u << iterations);
+    mKawaseChain.clear();
+    if (!computeBlurRegion(blurWidth, blurHeight, margin)) {
+        return;
+    }
+    
+    // 链 [0] 为模糊分辨率，之后逐级减半；上采样写回 [0]
+    for (uint32_t level = 0; level <= iterations; ++level) {
+        const uint32_t w = std::max<uint32_t>(1, blurWidth >> level);
+        const uint32_t h = std::max<uint32_t>(1, blurHeight >> level);
+        auto texture = acquireTransientTexture(w, h, PixelFormat::RGBA8);
+        if (!texture) {
+            mKawaseChain.clear();
+            return;
+        }
+        mKawaseChain.push_back(std::move(texture));
+    }
+    
+    // 下采样：input -> [0] -> [1] ... -> [iterations]，半纹素取源纹理尺寸
+    // 各级裁剪区域为 mBlurRegion 按 2^level 缩小
+    for (uint32_t level = 0; level <= iterations; ++level) {
+        // auto src = (level == 0) ? input : mKawaseChain[level - 1];
+        // uint32_t srcWidth = (level == 0) ? width : std::max<uint32_t>(1, blurWidth >> (level - 1));
+        // uint32_t srcHeight = (level == 0) ? height : std::max<uint32_t>(1, blurHeight >> (level - 1));
+        // mBlurFBO1->attachColorTexture(mKawaseChain[level]);
+        // mBlurFBO1->bind();
+        // glViewport(0, 0, blurWidth >> level, blurHeight >> level);
+        // glScissor(mBlurRegion.x >> level, mBlurRegion.y >> level,
+        //           (mBlurRegion.width >> level) + 1, (mBlurRegion.height >> level) + 1);
+        // mKawaseDownShader->use();
+        // src->bind(0);
+        // mKawaseDownShader->setUniform("uHalfTexel", 0.5f / srcWidth, 0.5f / srcHeight);
+        // drawFullscreenQuad();
+    }
+    
+    // 上采样：[iterations] -> ... -> [0]
+    for (uint32_t level = iterations; level > 0; --level) {
+        // mBlurFBO1->attachColorTexture(mKawaseChain[level - 1]);
+        // mBlurFBO1->bind();
+        // glViewport(0, 0, blurWidth >> (level - 1), blurHeight >> (level - 1));
+        // mKawaseUpShader->use();
+        // mKawaseChain[level]->bind(0);
+        // mKawaseUpShader->setUniform("uHalfTexel",
+        //     0.5f / std::max<uint32_t>(1, blurWidth >> level),
+        //     0.5f / std::max<uint32_t>(1, blurHeight >> level));
+        // drawFullscreenQuad();
+    }
+    (void)input;
+    (void)width;
+    (void)height;
+}
+
 void BeautyEntity::performBilateralFilter(
     std::shared_ptr<lrengine::render::LRTexture> input,
     std::shared_ptr<lrengine::render::LRTexture> output) {
@@ -455,7 +959,7 @@ void BeautyEntity::performBilateralFilter(
     // mBilateralShader->use();
     // mBilateralShader->setUniform("uInputTexture", input, 0);
     // mBilateralShader->setUniform("uSmoothLevel", mSmoothLevel);
-    // mBilateralShader->setUniform("uSmoothRadius", mSmoothRadius);
+    // mBilateralShader->setUniform("uSmoothRadius", mSmoothRadius * getRenderScale());
     // drawFullscreenQuad();
     
     // Pass 2: 垂直
@@ -486,6 +990,36 @@ bool BeautyEntity::readFaceInfo(FramePacket* packet) {
         return false;
     }
     
+    mFaceRegionCount = 0;
+    
+    // 优先读取类型化的检测结果（无字符串查找）
+    if (const FaceDetectionResult* result = packet->getMetadata(kFaceDetectionResultKey)) {
+        if (result->faces.empty()) {
+            mCurrentFace.valid = false;
+            return false;
+        }
+        float x0 = 1.0f, y0 = 1.0f, x1 = 0.0f, y1 = 0.0f;
+        for (const auto& face : result->faces) {
+            if (mFaceRegionCount >= kMaxFaceRegions) break;
+            FaceInfo& region = mFaceRegions[mFaceRegionCount++];
+            region.boundingBox[0] = face.x;
+            region.boundingBox[1] = face.y;
+            region.boundingBox[2] = face.width;
+            region.boundingBox[3] = face.height;
+            region.valid = true;
+            x0 = std::min(x0, face.x);
+            y0 = std::min(y0, face.y);
+            x1 = std::max(x1, face.x + face.width);
+            y1 = std::max(y1, face.y + face.height);
+        }
+        mCurrentFace.boundingBox[0] = x0;
+        mCurrentFace.boundingBox[1] = y0;
+        mCurrentFace.boundingBox[2] = x1 - x0;
+        mCurrentFace.boundingBox[3] = y1 - y0;
+        mCurrentFace.valid = true;
+        return true;
+    }
+    
     // 从metadata读取人脸信息
     auto faces = packet->getMetadata<std::string>(mFaceMetadataKey);
     if (!faces) {
@@ -502,6 +1036,8 @@ bool BeautyEntity::readFaceInfo(FramePacket* packet) {
     //     &mCurrentFace.boundingBox[3]);
     
     mCurrentFace.valid = true;
+    mFaceRegions[0] = mCurrentFace;
+    mFaceRegionCount = 1;
     return true;
 }
 
@@ -542,32 +1078,15 @@ bool BeautyEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
 //    uint32_t width = inputTexture->getWidth();
 //    uint32_t height = inputTexture->getHeight();
 //
-//    // 确保中间纹理已创建
-//    if (!mBlurTexture1 || mBlurTexture1->getWidth() != width) {
-//        if (!createBlurTextures()) {
-//            return false;
-//        }
-//    }
-//
 //    // 确保FBO已创建
 //    if (!ensureFrameBuffer(width, height, mOutputFormat)) {
 //        return false;
 //    }
 //
-//    // TODO: 多Pass渲染
-//
-//    // Pass 1: 磨皮（双边滤波）
-//    if (mSmoothLevel > 0.0f) {
-//        // mBlurFBO1->bind();
-//        // glViewport(0, 0, width, height);
-//        // mBilateralShader->use();
-//        // inputTexture->bind(0);
-//        // mBilateralShader->setUniform("uInputTexture", 0);
-//        // mBilateralShader->setUniform("uTexelSize", 1.0f/width, 1.0f/height);
-//        // mBilateralShader->setUniform("uSmoothLevel", mSmoothLevel);
-//        // mBilateralShader->setUniform("uSmoothRadius", mSmoothRadius);
-//        // drawFullscreenQuad();
-//    }
+//    // Pass 1: 磨皮模糊（按 mBlurConfig 选择全分辨率双边 / 降采样可分离 / DualKawase，
+//    // 启用人脸ROI时只模糊人脸框附近，无人脸时返回nullptr）
+//    auto blurTexture = performBlur(inputTexture, width, height);
+//    float smoothLevel = blurTexture ? mSmoothLevel : 0.0f;
 //
 //    // Pass 2: 美颜混合（美白、红润）
 //    // mFrameBuffer->bind();
@@ -575,19 +1094,20 @@ bool BeautyEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
 //    // mBeautyBlendShader->use();
 //    // inputTexture->bind(0);
 //    // mBeautyBlendShader->setUniform("uInputTexture", 0);
-//    // if (mSmoothLevel > 0.0f) {
-//    //     mBlurTexture1->bind(1);
+//    // if (blurTexture) {
+//    //     blurTexture->bind(1);   // 低分辨率结果由线性过滤放大
 //    //     mBeautyBlendShader->setUniform("uBlurTexture", 1);
 //    // }
-//    // mBeautyBlendShader->setUniform("uSmoothLevel", mSmoothLevel);
+//    // mBeautyBlendShader->setUniform("uSmoothLevel", smoothLevel);
 //    // mBeautyBlendShader->setUniform("uWhitenLevel", mWhitenLevel);
 //    // mBeautyBlendShader->setUniform("uRuddyLevel", mRuddyLevel);
 //    // mBeautyBlendShader->setUniform("uUseFaceDetection", mUseFaceDetection);
-//    // if (mCurrentFace.valid) {
-//    //     mBeautyBlendShader->setUniform("uFaceBounds",
-//    //         mCurrentFace.boundingBox[0], mCurrentFace.boundingBox[1],
-//    //         mCurrentFace.boundingBox[2], mCurrentFace.boundingBox[3]);
+//    // for (size_t i = 0; i < mFaceRegionCount; ++i) {
+//    //     mBeautyBlendShader->setUniform("uFaceBounds[" + std::to_string(i) + "]",
+//    //         mFaceRegions[i].boundingBox[0], mFaceRegions[i].boundingBox[1],
+//    //         mFaceRegions[i].boundingBox[2], mFaceRegions[i].boundingBox[3]);
 //    // }
+//    // mBeautyBlendShader->setUniform("uFaceCount", static_cast<int>(mFaceRegionCount));
 //    // drawFullscreenQuad();
 //
 //    // Pass 3: 锐化（可选）
@@ -601,6 +1121,9 @@ bool BeautyEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
 //    // 设置输出纹理
 //    // output->setTexture(mFrameBuffer->getColorAttachment());
 //
+//    // 归还中间纹理
+//    releaseBlurTextures();
+//
 //    // 添加美颜参数到元数据
 //    output->setMetadata("beauty_smooth", mSmoothLevel);
 //    output->setMetadata("beauty_whiten", mWhitenLevel);
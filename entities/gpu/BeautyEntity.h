@@ -6,9 +6,14 @@
 #pragma once
 
 #include "pipeline/entity/GPUEntity.h"
+#include "pipeline/utils/ParameterBlock.h"
+
+#include <vector>
 
 namespace pipeline {
 
+enum class QualityLevel : uint8_t;
+
 /**
  * @brief 美颜算法类型
  */
@@ -19,6 +24,29 @@ enum class BeautyAlgorithm : uint8_t {
     HighPass         // 高通滤波
 };
 
+/**
+ * @brief 磨皮模糊路径
+ */
+enum class BeautyBlurMode : uint8_t {
+    Reference,       // 全分辨率双边滤波（效果基准，填充率最高）
+    Separable,       // 降采样 + 可分离高斯（双线性采样合并相邻抽头）
+    DualKawase       // 降采样 + 双重Kawase（每级固定4~8次采样，半径越大越划算）
+};
+
+/**
+ * @brief 磨皮模糊配置
+ *
+ * 磨皮结果只作为低频皮肤层与原图混合，在1/2或1/4分辨率下计算几乎看不出差别，
+ * 1080p 下可把模糊 Pass 的像素数降到 1/4~1/16。
+ */
+struct BeautyBlurConfig {
+    BeautyBlurMode mode = BeautyBlurMode::Separable;
+    uint32_t downsample = 2;            ///< 模糊分辨率除数（1/2/4）
+    uint32_t kawaseIterations = 2;      ///< DualKawase 下采样级数
+    bool faceROIOnly = false;           ///< 只在人脸框（外扩后）内模糊，无人脸时跳过模糊
+    float roiPadding = 0.2f;            ///< 人脸框外扩比例（相对框宽高）
+};
+
 /**
  * @brief 美颜Entity
  * 
@@ -57,7 +85,7 @@ public:
     /**
      * @brief 获取磨皮强度
      */
-    float getSmoothLevel() const { return mSmoothLevel; }
+    float getSmoothLevel() const;
     
     /**
      * @brief 设置磨皮算法
@@ -67,7 +95,7 @@ public:
     /**
      * @brief 获取磨皮算法
      */
-    BeautyAlgorithm getSmoothAlgorithm() const { return mSmoothAlgorithm; }
+    BeautyAlgorithm getSmoothAlgorithm() const;
     
     /**
      * @brief 设置磨皮半径
@@ -75,6 +103,46 @@ public:
      */
     void setSmoothRadius(float radius);
     
+    /**
+     * @brief 设置模糊路径配置
+     */
+    void setBlurConfig(const BeautyBlurConfig& config);
+    
+    /**
+     * @brief 获取模糊路径配置
+     */
+    BeautyBlurConfig getBlurConfig() const;
+    
+    /**
+     * @brief 按质量级别选择模糊路径
+     *
+     * Low: 1/4 DualKawase + 人脸ROI；Medium: 1/2 可分离 + 人脸ROI；
+     * High: 1/2 可分离；Ultra: 全分辨率双边滤波。
+     */
+    void setQualityLevel(QualityLevel quality);
+    
+    /**
+     * @brief 计算双线性优化的可分离高斯核
+     *
+     * 相邻两个离散抽头合并为一次双线性采样（偏移取两者的加权位置），
+     * 2N+1 个离散抽头只需 N+1 次采样。
+     * @param sigma 高斯标准差（模糊纹理像素）
+     * @param offsets 输出：各采样偏移（offsets[0] = 0 为中心）
+     * @param weights 输出：各采样权重（单侧，除中心外左右对称使用）
+     * @param maxTaps 最多采样数（含中心）
+     */
+    static void computeLinearSampledKernel(float sigma,
+                                           std::vector<float>& offsets,
+                                           std::vector<float>& weights,
+                                           size_t maxTaps = 8);
+    
+    /**
+     * @brief 计算离散高斯核（计算内核路径使用，单侧 radius+1 个权重，已归一化）
+     * @param maxRadius 半径上限（受工作组共享内存的边缘余量限制）
+     */
+    static void computeDiscreteKernel(float sigma, std::vector<float>& weights,
+                                      int maxRadius);
+    
     // ==========================================================================
     // 美白参数
     // ==========================================================================
@@ -88,7 +156,7 @@ public:
     /**
      * @brief 获取美白强度
      */
-    float getWhitenLevel() const { return mWhitenLevel; }
+    float getWhitenLevel() const;
     
     // ==========================================================================
     // 红润参数
@@ -103,7 +171,7 @@ public:
     /**
      * @brief 获取红润强度
      */
-    float getRuddyLevel() const { return mRuddyLevel; }
+    float getRuddyLevel() const;
     
     // ==========================================================================
     // 锐化参数
@@ -118,7 +186,7 @@ public:
     /**
      * @brief 获取锐化强度
      */
-    float getSharpenLevel() const { return mSharpenLevel; }
+    float getSharpenLevel() const;
     
     // ==========================================================================
     // 大眼瘦脸参数
@@ -146,12 +214,12 @@ public:
      * 如果启用，将从FramePacket的metadata中读取人脸检测结果，
      * 只对人脸区域应用美颜效果。
      */
-    void setUseFaceDetection(bool use) { mUseFaceDetection = use; }
+    void setUseFaceDetection(bool use);
     
     /**
      * @brief 获取是否使用人脸信息
      */
-    bool getUseFaceDetection() const { return mUseFaceDetection; }
+    bool getUseFaceDetection() const;
     
     /**
      * @brief 设置人脸区域元数据键名
@@ -174,6 +242,7 @@ public:
     void reset();
     
 protected:
+    void latchParameters() override;
     bool setupShader() override;
     void setUniforms(FramePacket* input) override;
     bool processGPU(const std::vector<FramePacketPtr>& inputs, 
@@ -184,8 +253,37 @@ protected:
 private:
     /**
      * @brief 创建模糊纹理
+     * @param width 模糊分辨率宽度
+     * @param height 模糊分辨率高度
+     */
+    bool createBlurTextures(uint32_t width, uint32_t height);
+    
+    /**
+     * @brief 按当前模糊配置执行磨皮模糊
+     * @return 模糊结果（可能低于输入分辨率，混合时双线性放大）；跳过模糊时返回nullptr
+     */
+    std::shared_ptr<lrengine::render::LRTexture> performBlur(
+        std::shared_ptr<lrengine::render::LRTexture> input,
+        uint32_t width, uint32_t height);
+    
+    void performSeparableBlur(std::shared_ptr<lrengine::render::LRTexture> input,
+                              uint32_t blurWidth, uint32_t blurHeight, float sigma);
+    void performComputeBlur(std::shared_ptr<lrengine::render::LRTexture> input,
+                            uint32_t blurWidth, uint32_t blurHeight, float sigma);
+    void performDualKawaseBlur(std::shared_ptr<lrengine::render::LRTexture> input,
+                               uint32_t width, uint32_t height,
+                               uint32_t blurWidth, uint32_t blurHeight);
+    
+    /**
+     * @brief 计算模糊裁剪区域（模糊纹理像素，已含核半径余量）
+     * @return 无人脸且启用ROI时返回false
      */
-    bool createBlurTextures();
+    bool computeBlurRegion(uint32_t blurWidth, uint32_t blurHeight, float margin);
+    
+    /**
+     * @brief 归还本帧借用的模糊纹理
+     */
+    void releaseBlurTextures();
     
     /**
      * @brief 执行双边滤波
@@ -204,10 +302,29 @@ private:
     bool readFaceInfo(FramePacket* packet);
     
 private:
+    /**
+     * @brief 美颜参数（UI线程写入，渲染线程每帧锁存一次）
+     */
+    struct BeautyParams {
+        float smoothLevel = 0.5f;
+        float smoothRadius = 7.0f;
+        BeautyAlgorithm smoothAlgorithm = BeautyAlgorithm::Bilateral;
+        BeautyBlurConfig blur;
+        float whitenLevel = 0.3f;
+        float ruddyLevel = 0.2f;
+        float sharpenLevel = 0.0f;
+        float eyeEnlargeLevel = 0.0f;
+        float faceSlimLevel = 0.0f;
+        bool useFaceDetection = false;
+    };
+    ParameterBlock<BeautyParams> mParamBlock;
+    
+    // 以下参数为本帧锁存值，只在渲染线程读写
     // 磨皮参数
     float mSmoothLevel = 0.5f;
     float mSmoothRadius = 7.0f;
     BeautyAlgorithm mSmoothAlgorithm = BeautyAlgorithm::Bilateral;
+    BeautyBlurConfig mBlurConfig;
     
     // 美白参数
     float mWhitenLevel = 0.3f;
@@ -231,18 +348,44 @@ private:
         float boundingBox[4] = {0, 0, 1, 1}; // x, y, width, height (normalized)
         bool valid = false;
     };
-    FaceInfo mCurrentFace;
+    FaceInfo mCurrentFace;                          // 全部人脸框的并集
+    static constexpr size_t kMaxFaceRegions = 4;    // 混合着色器 uFaceBounds 数组长度
+    FaceInfo mFaceRegions[kMaxFaceRegions];
+    size_t mFaceRegionCount = 0;
+    
+    // 模糊裁剪区域（模糊纹理像素）
+    struct BlurRegion {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+    };
+    BlurRegion mBlurRegion;
+    
+    // 可分离高斯核（sigma 不变时复用）
+    float mKernelSigma = -1.0f;
+    std::vector<float> mKernelOffsets;
+    std::vector<float> mKernelWeights;
+    
+    // 计算内核的离散高斯核（大半径时不受片段路径8次采样的限制）
+    float mComputeKernelSigma = -1.0f;
+    std::vector<float> mComputeKernelWeights;
     
-    // 中间纹理
+    // 中间纹理（每帧取自纹理池，多Pass结束后归还）
     std::shared_ptr<lrengine::render::LRTexture> mBlurTexture1;
     std::shared_ptr<lrengine::render::LRTexture> mBlurTexture2;
     std::shared_ptr<lrengine::render::LRFrameBuffer> mBlurFBO1;
     std::shared_ptr<lrengine::render::LRFrameBuffer> mBlurFBO2;
+    std::vector<std::shared_ptr<lrengine::render::LRTexture>> mKawaseChain;     // [0] 为模糊分辨率
     
     // 着色器（多Pass）
     std::shared_ptr<lrengine::render::LRShaderProgram> mBilateralShader;
     std::shared_ptr<lrengine::render::LRShaderProgram> mSharpenShader;
     std::shared_ptr<lrengine::render::LRShaderProgram> mBeautyBlendShader;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mSeparableBlurShader;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mKawaseDownShader;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mKawaseUpShader;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mComputeBlurShader;     // 设备不支持计算着色器时为空
     
     // Uniform位置
     int32_t mSmoothLevelLocation = -1;
@@ -6,6 +6,7 @@
 #include "FilterEntity.h"
 #include "pipeline/data/FramePacket.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/utils/PipelineLog.h"
 #include "lrengine/core/LRTexture.h"
 #include <fstream>
 #include <sstream>
@@ -31,8 +32,8 @@ void main() {
 }
 )";
 
-// 3D LUT着色器
-const char* kLUT3DFragmentShader = R"(
+// 3D LUT着色器（头部 + 采样函数 + main，采样函数按插值方式选择）
+const char* kLUT3DFragmentHeader = R"(
 precision highp float;
 varying vec2 vTexCoord;
 
@@ -57,9 +58,12 @@ vec3 adjustSaturation(vec3 color, float saturation) {
     float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
     return mix(vec3(luminance), color, saturation);
 }
+)";
 
+// 三线性采样模板（占位符与下方四面体模板相同）
+const char* kLUT3DTrilinearTemplate = R"(
 // 3D LUT采样
-vec3 sampleLUT(vec3 color, float size) {
+vec3 SAMPLE_LUT(vec3 color, float size) {
     // LUT作为2D纹理存储，需要计算正确的UV
     float sliceSize = 1.0 / size;
     float slicePixelSize = sliceSize / size;
@@ -77,13 +81,15 @@ vec3 sampleLUT(vec3 color, float size) {
     uv1.y = slicePixelSize * 0.5 + color.g * sliceInnerSize;
     
     // 采样两个切片并插值
-    vec3 lutColor0 = texture2D(uLUTTexture, uv0).rgb;
-    vec3 lutColor1 = texture2D(uLUTTexture, uv1).rgb;
+    vec3 lutColor0 = LUT_FETCH(uv0).rgb;
+    vec3 lutColor1 = LUT_FETCH(uv1).rgb;
     
     float blueFrac = fract(color.b * (size - 1.0));
     return mix(lutColor0, lutColor1, blueFrac);
 }
+)";
 
+const char* kLUT3DFragmentMain = R"(
 void main() {
     vec4 originalColor = texture2D(uInputTexture, vTexCoord);
     vec3 color = originalColor.rgb;
@@ -104,6 +110,86 @@ void main() {
 }
 )";
 
+// 双LUT过渡：同一次绘制中采样当前与目标LUT，按交叉淡化或分割线混合
+const char* kLUT3DTransitionFragmentMain = R"(
+uniform sampler2D uLUTTexture2;
+uniform float uLUTSize2;
+uniform float uTransitionProgress;  // 0 = 当前LUT，1 = 目标LUT
+uniform float uTransitionWipe;      // 0 交叉淡化，1 目标自右侧划入，-1 目标自左侧划入
+uniform float uTransitionSoftness;  // 分割线羽化半宽（纹理坐标）
+
+void main() {
+    vec4 originalColor = texture2D(uInputTexture, vTexCoord);
+    vec3 color = originalColor.rgb;
+    
+    color = adjustBrightness(color, uBrightness);
+    color = adjustContrast(color, uContrast);
+    color = adjustSaturation(color, uSaturation);
+    color = clamp(color, 0.0, 1.0);
+    
+    float weight = uTransitionProgress;
+    if (uTransitionWipe > 0.5) {
+        float edge = 1.0 - uTransitionProgress;
+        weight = smoothstep(edge - uTransitionSoftness, edge + uTransitionSoftness, vTexCoord.x);
+    } else if (uTransitionWipe < -0.5) {
+        float edge = uTransitionProgress;
+        weight = 1.0 - smoothstep(edge - uTransitionSoftness, edge + uTransitionSoftness, vTexCoord.x);
+    }
+    
+    vec3 fromColor = uLUTSize > 0.0 ? sampleLUT(color, uLUTSize) : color;
+    vec3 toColor = uLUTSize2 > 0.0 ? sampleLUT2(color, uLUTSize2) : color;
+    color = mix(color, mix(fromColor, toColor, weight), uIntensity);
+    
+    gl_FragColor = vec4(color, originalColor.a);
+}
+)";
+
+// 四面体插值模板：LUT_FETCH(uv) 与 SAMPLE_LUT 在生成着色器时替换，
+// 独立着色器与融合片段（GLSL ES 1.00 / 3.00）、主LUT与过渡LUT共用同一份实现。
+// 只在格点中心取样（双线性过滤在纹素中心返回原值），单元内按 r/g/b 小数部分的大小顺序
+// 选出6个四面体之一，4个顶点加权。
+const char* kLUT3DTetrahedralTemplate = R"(
+vec3 SAMPLE_LUT_fetch(vec3 p, float size) {
+    vec2 uv = vec2((p.b * size + p.r + 0.5) / (size * size), (p.g + 0.5) / size);
+    return LUT_FETCH(uv).rgb;
+}
+
+vec3 SAMPLE_LUT(vec3 color, float size) {
+    vec3 p = color * (size - 1.0);
+    vec3 p0 = floor(p);
+    vec3 p1 = min(p0 + 1.0, size - 1.0);
+    vec3 f = p - p0;
+    
+    vec3 c000 = SAMPLE_LUT_fetch(p0, size);
+    vec3 c111 = SAMPLE_LUT_fetch(p1, size);
+    vec3 result;
+    if (f.r > f.g) {
+        if (f.g > f.b) {
+            result = (1.0 - f.r) * c000 + (f.r - f.g) * SAMPLE_LUT_fetch(vec3(p1.r, p0.g, p0.b), size)
+                   + (f.g - f.b) * SAMPLE_LUT_fetch(vec3(p1.r, p1.g, p0.b), size) + f.b * c111;
+        } else if (f.r > f.b) {
+            result = (1.0 - f.r) * c000 + (f.r - f.b) * SAMPLE_LUT_fetch(vec3(p1.r, p0.g, p0.b), size)
+                   + (f.b - f.g) * SAMPLE_LUT_fetch(vec3(p1.r, p0.g, p1.b), size) + f.g * c111;
+        } else {
+            result = (1.0 - f.b) * c000 + (f.b - f.r) * SAMPLE_LUT_fetch(vec3(p0.r, p0.g, p1.b), size)
+                   + (f.r - f.g) * SAMPLE_LUT_fetch(vec3(p1.r, p0.g, p1.b), size) + f.g * c111;
+        }
+    } else {
+        if (f.b > f.g) {
+            result = (1.0 - f.b) * c000 + (f.b - f.g) * SAMPLE_LUT_fetch(vec3(p0.r, p0.g, p1.b), size)
+                   + (f.g - f.r) * SAMPLE_LUT_fetch(vec3(p0.r, p1.g, p1.b), size) + f.r * c111;
+        } else if (f.b > f.r) {
+            result = (1.0 - f.g) * c000 + (f.g - f.b) * SAMPLE_LUT_fetch(vec3(p0.r, p1.g, p0.b), size)
+                   + (f.b - f.r) * SAMPLE_LUT_fetch(vec3(p0.r, p1.g, p1.b), size) + f.r * c111;
+        } else {
+            result = (1.0 - f.g) * c000 + (f.g - f.r) * SAMPLE_LUT_fetch(vec3(p0.r, p1.g, p0.b), size)
+                   + (f.r - f.b) * SAMPLE_LUT_fetch(vec3(p1.r, p1.g, p0.b), size) + f.b * c111;
+        }
+    }
+    return result;
+}
+)";
+
 // 颜色矩阵着色器
 const char* kColorMatrixFragmentShader = R"(
 precision highp float;
@@ -146,6 +232,86 @@ void main() {
 }
 )";
 
+// 融合片段（GLSL ES 3.00，$ 为融合前缀占位符）：与上面两个着色器的 main 等价
+const char* kAdjustSnippetDeclarations = R"(
+uniform float $intensity;
+uniform float $brightness;
+uniform float $contrast;
+uniform float $saturation;
+
+vec3 $adjust(vec3 color) {
+    color = color + $brightness;
+    color = (color - 0.5) * $contrast + 0.5;
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    return mix(vec3(luminance), color, $saturation);
+}
+)";
+
+const char* kLUT3DSnippetDeclarations = R"(
+uniform sampler2D $lut;
+uniform float $lutSize;
+)";
+
+const char* kLUT3DTransitionSnippetDeclarations = R"(
+uniform sampler2D $lut2;
+uniform float $lutSize2;
+uniform float $progress;
+uniform float $wipe;
+uniform float $softness;
+)";
+
+const char* kLUT3DTransitionSnippetBody = R"(
+    vec3 rgb = clamp($adjust(color.rgb), 0.0, 1.0);
+    float weight = $progress;
+    if ($wipe > 0.5) {
+        weight = smoothstep(1.0 - $progress - $softness, 1.0 - $progress + $softness, uv.x);
+    } else if ($wipe < -0.5) {
+        weight = 1.0 - smoothstep($progress - $softness, $progress + $softness, uv.x);
+    }
+    vec3 fromColor = $lutSize > 0.0 ? $sampleLUT(rgb, $lutSize) : rgb;
+    vec3 toColor = $lutSize2 > 0.0 ? $sampleLUT2(rgb, $lutSize2) : rgb;
+    rgb = mix(rgb, mix(fromColor, toColor, weight), $intensity);
+    return vec4(rgb, color.a);
+)";
+
+const char* kLUT3DSnippetBody = R"(
+    vec3 rgb = clamp($adjust(color.rgb), 0.0, 1.0);
+    if ($lutSize > 0.0) {
+        rgb = mix(rgb, $sampleLUT(rgb, $lutSize), $intensity);
+    }
+    return vec4(rgb, color.a);
+)";
+
+const char* kColorMatrixSnippetDeclarations = R"(
+uniform mat4 $colorMatrix;
+)";
+
+const char* kColorMatrixSnippetBody = R"(
+    vec3 rgb = $adjust(color.rgb);
+    rgb = mix(rgb, ($colorMatrix * vec4(rgb, 1.0)).rgb, $intensity);
+    return vec4(clamp(rgb, 0.0, 1.0), color.a);
+)";
+
+/**
+ * @brief 由采样模板生成LUT采样函数
+ * @param fetch 替换 `LUT_FETCH(` 的纹理读取前缀，如 "texture2D(uLUTTexture, "
+ * @param name 生成的函数名（辅助函数以其为前缀）
+ */
+std::string buildLUTSampler(LUTInterpolation interpolation,
+                            const std::string& fetch, const std::string& name) {
+    std::string source = (interpolation == LUTInterpolation::Tetrahedral)
+        ? kLUT3DTetrahedralTemplate : kLUT3DTrilinearTemplate;
+    auto replaceAll = [&source](const std::string& from, const std::string& to) {
+        for (size_t pos = source.find(from); pos != std::string::npos;
+             pos = source.find(from, pos + to.size())) {
+            source.replace(pos, from.size(), to);
+        }
+    };
+    replaceAll("LUT_FETCH(", fetch);
+    replaceAll("SAMPLE_LUT", name);
+    return source;
+}
+
 } // anonymous namespace
 
 // =============================================================================
@@ -175,7 +341,13 @@ bool FilterEntity::loadLUTFromFile(const std::string& path) {
     }
     
     if (ext == ".cube") {
-        return parseCubeFile(path);
+        auto asset = LUTCache::instance().load(path, mLUTFormat);
+        if (!asset) {
+            return false;
+        }
+        mLUTPath = path;
+        setLUTAsset(std::move(asset));
+        return true;
     } else if (ext == ".3dl") {
         // TODO: 实现.3dl格式解析
         return false;
@@ -184,59 +356,121 @@ bool FilterEntity::loadLUTFromFile(const std::string& path) {
     return false;
 }
 
-bool FilterEntity::parseCubeFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        return false;
+bool FilterEntity::prefetchLUT(const std::string& path) const {
+    return LUTCache::instance().prefetch(path, mLUTFormat);
+}
+
+void FilterEntity::setLUTStorageFormat(LUTStorageFormat format) {
+    if (mLUTFormat == format) {
+        return;
     }
-    
-    std::string line;
-    uint32_t lutSize = 0;
-    std::vector<float> lutData;
-    
-    while (std::getline(file, line)) {
-        // 跳过空行和注释
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        
-        // 解析LUT大小
-        if (line.find("LUT_3D_SIZE") != std::string::npos) {
-            std::istringstream iss(line);
-            std::string token;
-            iss >> token >> lutSize;
-            lutData.reserve(lutSize * lutSize * lutSize * 3);
-            continue;
-        }
-        
-        // 跳过其他头部信息
-        if (line.find("TITLE") != std::string::npos ||
-            line.find("DOMAIN_MIN") != std::string::npos ||
-            line.find("DOMAIN_MAX") != std::string::npos) {
-            continue;
+    mLUTFormat = format;
+    if (!mLUTPath.empty()) {
+        if (auto asset = LUTCache::instance().load(mLUTPath, mLUTFormat)) {
+            setLUTAsset(std::move(asset));
         }
-        
-        // 解析RGB值
-        std::istringstream iss(line);
-        float r, g, b;
-        if (iss >> r >> g >> b) {
-            lutData.push_back(r);
-            lutData.push_back(g);
-            lutData.push_back(b);
+    }
+    if (!mTransitionPath.empty()) {
+        if (auto asset = LUTCache::instance().load(mTransitionPath, mLUTFormat)) {
+            mTransitionAsset = std::move(asset);
+            mTransitionNeedsUpdate = true;
+            markParametersDirty();
         }
     }
-    
-    if (lutSize == 0 || lutData.empty()) {
+}
+
+void FilterEntity::setLUTInterpolation(LUTInterpolation interpolation) {
+    if (mLUTInterpolation != interpolation) {
+        mLUTInterpolation = interpolation;
+        invalidateShader();
+    }
+}
+
+// =============================================================================
+// 滤镜过渡
+// =============================================================================
+
+bool FilterEntity::loadTransitionLUTFromFile(const std::string& path) {
+    auto asset = LUTCache::instance().load(path, mLUTFormat);
+    if (!asset) {
         return false;
     }
-    
+    const bool wasActive = isTransitionActive();
+    mTransitionAsset = std::move(asset);
+    mTransitionPath = path;
+    mTransitionNeedsUpdate = true;
+    if (wasActive != isTransitionActive()) {
+        invalidateShader();
+    }
+    markParametersDirty();
+    return true;
+}
+
+void FilterEntity::setTransitionProgress(float progress) {
+    // 进入/离开过渡时的着色器变体切换在锁存时判断
+    progress = std::clamp(progress, 0.0f, 1.0f);
+    mParamBlock.update([progress](FilterParams& params) { params.transitionProgress = progress; });
+}
+
+float FilterEntity::getTransitionProgress() const {
+    return mParamBlock.read([](const FilterParams& params) { return params.transitionProgress; });
+}
+
+void FilterEntity::setTransitionMode(FilterTransitionMode mode, float softness) {
+    softness = std::clamp(softness, 0.0f, 0.5f);
+    mParamBlock.update([mode, softness](FilterParams& params) {
+        params.transitionMode = mode;
+        params.transitionSoftness = softness;
+    });
+}
+
+void FilterEntity::commitTransition() {
+    if (!mTransitionAsset) {
+        return;
+    }
+    const bool wasActive = isTransitionActive();
+    std::string path = std::move(mTransitionPath);
+    setLUTAsset(std::move(mTransitionAsset));
+    mLUTPath = std::move(path);
+    // 目标纹理已上传，直接接管，避免提交当帧再查一次缓存
+    if (mTransitionTexture && !mTransitionNeedsUpdate) {
+        mLUTTexture = std::move(mTransitionTexture);
+        mLUTNeedsUpdate = false;
+    }
+    mTransitionAsset.reset();
+    mTransitionTexture.reset();
+    mTransitionPath.clear();
+    mTransitionNeedsUpdate = false;
+    mParamBlock.update([](FilterParams& params) { params.transitionProgress = 0.0f; });
+    if (wasActive) {
+        invalidateShader();
+    }
+    markParametersDirty();
+}
+
+void FilterEntity::cancelTransition() {
+    const bool wasActive = isTransitionActive();
+    mTransitionAsset.reset();
+    mTransitionTexture.reset();
+    mTransitionPath.clear();
+    mTransitionNeedsUpdate = false;
+    mParamBlock.update([](FilterParams& params) { params.transitionProgress = 0.0f; });
+    if (wasActive) {
+        invalidateShader();
+    }
+    markParametersDirty();
+}
+
+void FilterEntity::setLUTAsset(LUTAssetPtr asset) {
+    // 尺寸与模式不变时着色器不需要重建，只换纹理
+    if (mLUTType != LUTType::LUT3D) {
+        invalidateShader();
+    }
     mLUTType = LUTType::LUT3D;
-    mLUTSize = lutSize;
-    mLUTData = std::move(lutData);
+    mLUTSize = asset->size;
+    mLUTAsset = std::move(asset);
     mLUTNeedsUpdate = true;
-    mNeedsShaderUpdate = true;
-    
-    return true;
+    markParametersDirty();
 }
 
 bool FilterEntity::loadLUT3D(const uint8_t* data, uint32_t size) {
@@ -244,79 +478,79 @@ bool FilterEntity::loadLUT3D(const uint8_t* data, uint32_t size) {
         return false;
     }
     
-    // 转换uint8到float
-    size_t totalSize = size * size * size * 3;
-    mLUTData.resize(totalSize);
-    
+    // 转换uint8到float后按存储格式打包
+    size_t totalSize = static_cast<size_t>(size) * size * size * 3;
+    std::vector<float> lutData(totalSize);
     for (size_t i = 0; i < totalSize; ++i) {
-        mLUTData[i] = data[i] / 255.0f;
+        lutData[i] = data[i] / 255.0f;
     }
     
-    mLUTType = LUTType::LUT3D;
-    mLUTSize = size;
-    mLUTNeedsUpdate = true;
-    mNeedsShaderUpdate = true;
-    
-    return true;
+    return loadLUT3DFloat(lutData.data(), size);
 }
 
 bool FilterEntity::loadLUT3DFloat(const float* data, uint32_t size) {
-    if (!data || size == 0) {
+    auto asset = LUTCache::pack(data, size, mLUTFormat);
+    if (!asset) {
         return false;
     }
     
-    size_t totalSize = size * size * size * 3;
-    mLUTData.assign(data, data + totalSize);
-    
-    mLUTType = LUTType::LUT3D;
-    mLUTSize = size;
-    mLUTNeedsUpdate = true;
-    mNeedsShaderUpdate = true;
-    
+    // 内存LUT无路径可作键，不进缓存
+    mLUTPath.clear();
+    setLUTAsset(std::move(asset));
     return true;
 }
 
 void FilterEntity::setColorMatrix(const float matrix[16]) {
-    std::memcpy(mColorMatrix, matrix, 16 * sizeof(float));
+    mParamBlock.update([matrix](FilterParams& params) {
+        std::memcpy(params.colorMatrix, matrix, sizeof(params.colorMatrix));
+    });
     mLUTType = LUTType::ColorMatrix;
-    mNeedsShaderUpdate = true;
+    invalidateShader();
 }
 
 bool FilterEntity::setPreset(const std::string& presetName) {
-    // 内置预设滤镜
+    // 内置预设滤镜（同一预设的参数一次发布）
     if (presetName == "normal" || presetName == "none") {
         // 重置为原始
-        mIntensity = 0.0f;
+        mParamBlock.update([](FilterParams& params) { params.intensity = 0.0f; });
         return true;
     }
     
     if (presetName == "warm") {
         // 暖色调
-        mTemperature = 0.3f;
-        mTint = 0.1f;
-        updateColorCorrection();
+        mParamBlock.update([](FilterParams& params) {
+            params.temperature = 0.3f;
+            params.tint = 0.1f;
+            params.updateColorCorrection();
+        });
         return true;
     }
     
     if (presetName == "cool") {
         // 冷色调
-        mTemperature = -0.3f;
-        mTint = -0.1f;
-        updateColorCorrection();
+        mParamBlock.update([](FilterParams& params) {
+            params.temperature = -0.3f;
+            params.tint = -0.1f;
+            params.updateColorCorrection();
+        });
         return true;
     }
     
     if (presetName == "vivid") {
         // 鲜艳
-        mSaturation = 1.3f;
-        mContrast = 1.1f;
+        mParamBlock.update([](FilterParams& params) {
+            params.saturation = 1.3f;
+            params.contrast = 1.1f;
+        });
         return true;
     }
     
     if (presetName == "vintage") {
         // 复古
-        mSaturation = 0.8f;
-        mContrast = 0.9f;
+        mParamBlock.update([](FilterParams& params) {
+            params.saturation = 0.8f;
+            params.contrast = 0.9f;
+        });
         // 设置偏黄色调矩阵
         float vintageMatrix[16] = {
             1.2f, 0.1f, 0.0f, 0.0f,
@@ -330,7 +564,7 @@ bool FilterEntity::setPreset(const std::string& presetName) {
     
     if (presetName == "bw" || presetName == "blackwhite") {
         // 黑白
-        mSaturation = 0.0f;
+        mParamBlock.update([](FilterParams& params) { params.saturation = 0.0f; });
         return true;
     }
     
@@ -342,45 +576,84 @@ bool FilterEntity::setPreset(const std::string& presetName) {
 // =============================================================================
 
 void FilterEntity::setIntensity(float intensity) {
-    mIntensity = std::clamp(intensity, 0.0f, 1.0f);
+    intensity = std::clamp(intensity, 0.0f, 1.0f);
+    mParamBlock.update([intensity](FilterParams& params) { params.intensity = intensity; });
+}
+
+float FilterEntity::getIntensity() const {
+    return mParamBlock.read([](const FilterParams& params) { return params.intensity; });
 }
 
 void FilterEntity::setBrightness(float brightness) {
-    mBrightness = std::clamp(brightness, -1.0f, 1.0f);
+    brightness = std::clamp(brightness, -1.0f, 1.0f);
+    mParamBlock.update([brightness](FilterParams& params) { params.brightness = brightness; });
 }
 
 void FilterEntity::setContrast(float contrast) {
-    mContrast = std::clamp(contrast, 0.0f, 2.0f);
+    contrast = std::clamp(contrast, 0.0f, 2.0f);
+    mParamBlock.update([contrast](FilterParams& params) { params.contrast = contrast; });
 }
 
 void FilterEntity::setSaturation(float saturation) {
-    mSaturation = std::clamp(saturation, 0.0f, 2.0f);
+    saturation = std::clamp(saturation, 0.0f, 2.0f);
+    mParamBlock.update([saturation](FilterParams& params) { params.saturation = saturation; });
 }
 
 void FilterEntity::setTemperature(float temperature) {
-    mTemperature = std::clamp(temperature, -1.0f, 1.0f);
-    updateColorCorrection();
+    temperature = std::clamp(temperature, -1.0f, 1.0f);
+    mParamBlock.update([temperature](FilterParams& params) {
+        params.temperature = temperature;
+        params.updateColorCorrection();
+    });
 }
 
 void FilterEntity::setTint(float tint) {
-    mTint = std::clamp(tint, -1.0f, 1.0f);
-    updateColorCorrection();
+    tint = std::clamp(tint, -1.0f, 1.0f);
+    mParamBlock.update([tint](FilterParams& params) {
+        params.tint = tint;
+        params.updateColorCorrection();
+    });
 }
 
-void FilterEntity::updateColorCorrection() {
+void FilterEntity::FilterParams::updateColorCorrection() {
     // 根据色温和色调更新颜色矩阵
     // 色温影响红/蓝通道
-    float tempScale = 0.2f * mTemperature;
+    float tempScale = 0.2f * temperature;
     // 色调影响绿通道
-    float tintScale = 0.1f * mTint;
+    float tintScale = 0.1f * tint;
     
-    mColorMatrix[0] = 1.0f + tempScale;  // R
-    mColorMatrix[5] = 1.0f + tintScale;  // G
-    mColorMatrix[10] = 1.0f - tempScale; // B
+    colorMatrix[0] = 1.0f + tempScale;  // R
+    colorMatrix[5] = 1.0f + tintScale;  // G
+    colorMatrix[10] = 1.0f - tempScale; // B
+}
+
+void FilterEntity::latchParameters() {
+    if (!mParamBlock.acquire()) {
+        return;
+    }
+    const FilterParams& params = mParamBlock.current();
+    
+    // 只有在进入/离开过渡时切换着色器变体，拖动过程中只改 uniform
+    const bool wasActive = isTransitionActive();
+    mIntensity = params.intensity;
+    mBrightness = params.brightness;
+    mContrast = params.contrast;
+    mSaturation = params.saturation;
+    mTemperature = params.temperature;
+    mTint = params.tint;
+    std::memcpy(mColorMatrix, params.colorMatrix, sizeof(mColorMatrix));
+    mTransitionProgress = params.transitionProgress;
+    mTransitionMode = params.transitionMode;
+    mTransitionSoftness = params.transitionSoftness;
+    if (wasActive != isTransitionActive()) {
+        invalidateShader();
+    }
+    markParametersDirty();
 }
 
 void FilterEntity::onParameterChanged(const std::string& key) {
     // 参数变化时的回调
+    GPUEntity::onParameterChanged(key);
 }
 
 // =============================================================================
@@ -392,14 +665,20 @@ bool FilterEntity::setupShader() {
     
     // 根据LUT类型选择Fragment Shader
     if (mLUTType == LUTType::LUT3D) {
-        mFragmentShaderSource = kLUT3DFragmentShader;
+        mFragmentShaderSource = kLUT3DFragmentHeader;
+        mFragmentShaderSource += buildLUTSampler(mLUTInterpolation, "texture2D(uLUTTexture, ", "sampleLUT");
+        if (isTransitionActive()) {
+            mFragmentShaderSource += buildLUTSampler(mLUTInterpolation, "texture2D(uLUTTexture2, ", "sampleLUT2");
+            mFragmentShaderSource += kLUT3DTransitionFragmentMain;
+        } else {
+            mFragmentShaderSource += kLUT3DFragmentMain;
+        }
     } else {
         mFragmentShaderSource = kColorMatrixFragmentShader;
     }
     
-    // TODO: 使用LREngine创建着色器
-    // mShaderProgram = mRenderContext->createShaderProgram(
-    //     mVertexShaderSource, mFragmentShaderSource);
+    // LUT / 颜色矩阵两种模式来回切换时命中缓存，不重复编译
+    mShaderProgram = acquireShaderProgram(mVertexShaderSource, mFragmentShaderSource);
     
     // 缓存Uniform位置
     // mIntensityLocation = mShaderProgram->getUniformLocation("uIntensity");
@@ -423,29 +702,116 @@ void FilterEntity::setUniforms(FramePacket* input) {
     
     // if (mLUTType == LUTType::LUT3D) {
     //     mShaderProgram->setUniform(mLUTSizeLocation, (float)mLUTSize);
+    //     if (isTransitionActive()) {
+    //         mShaderProgram->setUniform("uLUTSize2", (float)mTransitionAsset->size);
+    //         mShaderProgram->setUniform("uTransitionProgress", mTransitionProgress);
+    //         mShaderProgram->setUniform("uTransitionWipe", getTransitionWipeSign());
+    //         mShaderProgram->setUniform("uTransitionSoftness", mTransitionSoftness);
+    //     }
     // } else {
     //     mShaderProgram->setUniformMatrix(mColorMatrixLocation, mColorMatrix);
     // }
 }
 
+// =============================================================================
+// 着色器融合
+// =============================================================================
+
+bool FilterEntity::getPixelSnippet(PixelShaderSnippet& snippet) const {
+    // 全部效果只依赖当前像素（LUT按颜色查表），可与相邻逐像素节点合并
+    snippet.declarations = kAdjustSnippetDeclarations;
+    if (mLUTType == LUTType::LUT3D) {
+        snippet.declarations += kLUT3DSnippetDeclarations;
+        snippet.declarations += buildLUTSampler(mLUTInterpolation, "texture($lut, ", "$sampleLUT");
+        if (isTransitionActive()) {
+            snippet.declarations += kLUT3DTransitionSnippetDeclarations;
+            snippet.declarations += buildLUTSampler(mLUTInterpolation, "texture($lut2, ", "$sampleLUT2");
+            snippet.body = kLUT3DTransitionSnippetBody;
+        } else {
+            snippet.body = kLUT3DSnippetBody;
+        }
+    } else {
+        snippet.declarations += kColorMatrixSnippetDeclarations;
+        snippet.body = kColorMatrixSnippetBody;
+    }
+    return true;
+}
+
+void FilterEntity::setSnippetUniforms(lrengine::render::LRShaderProgram* program,
+                                      const std::string& prefix, uint32_t& textureUnit) {
+    if (!program) return;
+    
+    // 融合后本节点不再执行 processGPU，LUT纹理在此按需创建
+    ensureLUTTextures();
+    LUTCache::instance().uploadPending(mRenderContext, 1);
+    
+    // TODO: 设置Uniforms（名字带融合前缀）
+    // program->setUniform(prefix + "intensity", mIntensity);
+    // program->setUniform(prefix + "brightness", mBrightness);
+    // program->setUniform(prefix + "contrast", mContrast);
+    // program->setUniform(prefix + "saturation", mSaturation);
+    
+    if (mLUTType == LUTType::LUT3D) {
+        // program->setUniform(prefix + "lutSize", (float)mLUTSize);
+        // mRenderContext->SetTexture(mLUTTexture.get(), textureUnit);
+        // program->setUniform(prefix + "lut", (int)textureUnit);
+        ++textureUnit;
+        if (isTransitionActive()) {
+            // program->setUniform(prefix + "lutSize2", (float)mTransitionAsset->size);
+            // program->setUniform(prefix + "progress", mTransitionProgress);
+            // program->setUniform(prefix + "wipe", getTransitionWipeSign());
+            // program->setUniform(prefix + "softness", mTransitionSoftness);
+            // mRenderContext->SetTexture(mTransitionTexture.get(), textureUnit);
+            // program->setUniform(prefix + "lut2", (int)textureUnit);
+            ++textureUnit;
+        }
+    } else {
+        // program->setUniformMatrix(prefix + "colorMatrix", mColorMatrix);
+    }
+}
+
 bool FilterEntity::createLUTTexture() {
-    if (mLUTData.empty() || mLUTSize == 0) {
+    if (!mLUTAsset || mLUTSize == 0) {
         return false;
     }
     
-    // TODO: 创建LUT纹理
-    // 3D LUT存储为2D纹理，尺寸为 (size * size, size)
-    // uint32_t texWidth = mLUTSize * mLUTSize;
-    // uint32_t texHeight = mLUTSize;
-    // 
-    // mLUTTexture = mRenderContext->createTexture(texWidth, texHeight, PixelFormat::RGB8);
-    // mLUTTexture->upload(mLUTData.data());
-    // mLUTTexture->setFilter(FilterMode::Linear, FilterMode::Linear);
+    // 图集 (size * size, size)，同一文件在同一上下文中只上传一次
+    mLUTTexture = LUTCache::instance().acquireTexture(mRenderContext, mLUTAsset);
+    if (!mLUTTexture) {
+        // 保留待更新标记，下一帧重试；不在没有LUT的情况下绘制
+        return false;
+    }
     
     mLUTNeedsUpdate = false;
     return true;
 }
 
+bool FilterEntity::createTransitionTexture() {
+    if (!mTransitionAsset) {
+        return false;
+    }
+    mTransitionTexture = LUTCache::instance().acquireTexture(mRenderContext, mTransitionAsset);
+    if (!mTransitionTexture) {
+        return false;
+    }
+    mTransitionNeedsUpdate = false;
+    return true;
+}
+
+bool FilterEntity::ensureLUTTextures() {
+    bool lutReady = !(mLUTType == LUTType::LUT3D && mLUTNeedsUpdate) || createLUTTexture();
+    bool transitionReady = !(isTransitionActive() && mTransitionNeedsUpdate) || createTransitionTexture();
+    if (lutReady && transitionReady) {
+        return true;
+    }
+    if (!mLUTUnavailableWarned) {
+        mLUTUnavailableWarned = true;
+        PIPELINE_LOGW("FilterEntity %s: LUT texture unavailable, frames are left unfiltered",
+                      getName().c_str());
+    }
+    return false;
+}
+
 // =============================================================================
 // GPU处理
 // =============================================================================
@@ -470,13 +836,15 @@ bool FilterEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
         mNeedsShaderUpdate = false;
     }
     
-    // 确保LUT纹理已创建
-    if (mLUTType == LUTType::LUT3D && mLUTNeedsUpdate) {
-        if (!createLUTTexture()) {
-            return false;
-        }
+    // 确保LUT纹理已创建；不可用时本帧原样直通（不计为失败），下一帧重试
+    if (!ensureLUTTextures()) {
+        output->setTexture(inputTexture);
+        return true;
     }
     
+    // 每帧最多上传一张预取的LUT，切换滤镜时纹理已就绪
+    LUTCache::instance().uploadPending(mRenderContext, 1);
+    
     // 确保FBO已创建
     uint32_t width = inputTexture->GetWidth();
     uint32_t height = inputTexture->GetHeight();
@@ -506,6 +874,11 @@ bool FilterEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
     //     mLUTTexture->bind();
     //     mShaderProgram->setUniform("uLUTTexture", 1);
     // }
+    // if (isTransitionActive() && mTransitionTexture) {
+    //     glActiveTexture(GL_TEXTURE2);
+    //     mTransitionTexture->bind();
+    //     mShaderProgram->setUniform("uLUTTexture2", 2);
+    // }
     
     // 6. 绘制
     // drawFullscreenQuad();
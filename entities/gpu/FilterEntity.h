@@ -6,6 +6,8 @@
 #pragma once
 
 #include "pipeline/entity/GPUEntity.h"
+#include "LUTCache.h"
+#include "pipeline/utils/ParameterBlock.h"
 
 namespace pipeline {
 
@@ -18,6 +20,15 @@ enum class LUTType : uint8_t {
     ColorMatrix  // 颜色矩阵
 };
 
+/**
+ * @brief 滤镜过渡方式
+ */
+enum class FilterTransitionMode : uint8_t {
+    Crossfade,       // 整帧交叉淡化
+    WipeFromRight,   // 目标滤镜自右侧划入（向左滑动）
+    WipeFromLeft     // 目标滤镜自左侧划入（向右滑动）
+};
+
 /**
  * @brief LUT滤镜Entity
  * 
@@ -46,12 +57,85 @@ public:
     /**
      * @brief 从文件加载3D LUT
      * 
-     * 支持.cube和.3dl格式。
+     * 支持.cube和.3dl格式。经 LUTCache 按路径复用，切回已用过的滤镜不再解析和上传。
      * @param path LUT文件路径
      * @return 是否成功
      */
     bool loadLUTFromFile(const std::string& path);
     
+    /**
+     * @brief 预取LUT（可在任意线程调用）
+     *
+     * 滑动切换滤镜时提前预取相邻滤镜：解析与打包在调用线程完成，
+     * 纹理上传在之后的帧中由本Entity在GPU线程逐张完成。
+     * @param path LUT文件路径
+     * @return 文件可用返回true
+     */
+    bool prefetchLUT(const std::string& path) const;
+    
+    /**
+     * @brief 设置LUT纹理存储格式（默认RGBA8）
+     *
+     * 已从文件加载的LUT按新格式重新取自缓存。
+     */
+    void setLUTStorageFormat(LUTStorageFormat format);
+    
+    LUTStorageFormat getLUTStorageFormat() const { return mLUTFormat; }
+    
+    /**
+     * @brief 设置LUT插值方式
+     */
+    void setLUTInterpolation(LUTInterpolation interpolation);
+    
+    LUTInterpolation getLUTInterpolation() const { return mLUTInterpolation; }
+    
+    // ==========================================================================
+    // 滤镜过渡
+    // ==========================================================================
+    
+    /**
+     * @brief 加载过渡目标LUT
+     *
+     * 过渡期间一次绘制同时采样当前LUT与目标LUT，不需要两个 FilterEntity
+     * 加一个 CompositeEntity。目标LUT经缓存获取，提前 prefetchLUT 时不产生卡顿。
+     * 仅在 3D LUT 模式下生效。
+     * @param path LUT文件路径
+     * @return 是否成功
+     */
+    bool loadTransitionLUTFromFile(const std::string& path);
+    
+    /**
+     * @brief 设置过渡进度
+     * @param progress 0 为当前滤镜，1 为目标滤镜
+     */
+    void setTransitionProgress(float progress);
+    
+    float getTransitionProgress() const;
+    
+    /**
+     * @brief 设置过渡方式
+     * @param mode 过渡方式
+     * @param softness 分割线羽化半宽（纹理坐标，交叉淡化时忽略）
+     */
+    void setTransitionMode(FilterTransitionMode mode, float softness = 0.01f);
+    
+    /**
+     * @brief 结束过渡：目标LUT成为当前LUT
+     */
+    void commitTransition();
+    
+    /**
+     * @brief 取消过渡：丢弃目标LUT
+     */
+    void cancelTransition();
+    
+    /**
+     * @brief 是否正在过渡（有目标LUT且进度大于0）
+     */
+    bool isTransitionActive() const {
+        return mLUTType == LUTType::LUT3D && mTransitionAsset && mTransitionProgress > 0.0f;
+    }
+    
     /**
      * @brief 从内存加载3D LUT
      * @param data LUT数据（RGB格式）
@@ -94,7 +178,7 @@ public:
     /**
      * @brief 获取滤镜强度
      */
-    float getIntensity() const { return mIntensity; }
+    float getIntensity() const;
     
     /**
      * @brief 设置亮度调整
@@ -136,9 +220,14 @@ public:
      */
     uint32_t getLUTSize() const { return mLUTSize; }
     
+    bool getPixelSnippet(PixelShaderSnippet& snippet) const override;
+    
 protected:
+    void latchParameters() override;
     bool setupShader() override;
     void setUniforms(FramePacket* input) override;
+    void setSnippetUniforms(lrengine::render::LRShaderProgram* program,
+                            const std::string& prefix, uint32_t& textureUnit) override;
     bool processGPU(const std::vector<FramePacketPtr>& inputs, 
                    FramePacketPtr output) override;
     
@@ -147,28 +236,84 @@ protected:
 private:
     /**
      * @brief 创建LUT纹理
+     * @return 纹理不可用时返回false并保留待更新标记（下一帧重试）
      */
     bool createLUTTexture();
     
     /**
-     * @brief 解析.cube文件
+     * @brief 获取过渡目标LUT纹理
+     */
+    bool createTransitionTexture();
+    
+    /**
+     * @brief 按需创建本帧用到的LUT纹理（单独绘制与融合绘制共用）
+     * @return 有纹理不可用时返回false（只告警一次，下一帧重试）
+     */
+    bool ensureLUTTextures();
+    
+    /**
+     * @brief 过渡着色器的 wipe 参数：交叉淡化 0，自右划入 1，自左划入 -1
      */
-    bool parseCubeFile(const std::string& path);
+    float getTransitionWipeSign() const {
+        return mTransitionMode == FilterTransitionMode::WipeFromRight ? 1.0f :
+               mTransitionMode == FilterTransitionMode::WipeFromLeft ? -1.0f : 0.0f;
+    }
     
     /**
-     * @brief 生成颜色校正参数
+     * @brief 使用打包好的LUT
      */
-    void updateColorCorrection();
+    void setLUTAsset(LUTAssetPtr asset);
+    
     
 private:
     // LUT数据
     LUTType mLUTType = LUTType::LUT3D;
     uint32_t mLUTSize = 0;
-    std::vector<float> mLUTData;
+    LUTAssetPtr mLUTAsset;                              // 打包后的图集数据（文件LUT与缓存共享）
+    std::string mLUTPath;                               // 来自文件时的路径，切换存储格式时重新加载
+    LUTStorageFormat mLUTFormat = LUTStorageFormat::RGBA8;
+    LUTInterpolation mLUTInterpolation = LUTInterpolation::Trilinear;
     std::shared_ptr<lrengine::render::LRTexture> mLUTTexture;
     bool mLUTNeedsUpdate = false;
     
-    // 滤镜参数
+    // 过渡目标LUT
+    LUTAssetPtr mTransitionAsset;
+    std::string mTransitionPath;
+    std::shared_ptr<lrengine::render::LRTexture> mTransitionTexture;
+    bool mTransitionNeedsUpdate = false;
+    bool mLUTUnavailableWarned = false;                 // LUT纹理不可用时只告警一次
+    float mTransitionProgress = 0.0f;
+    FilterTransitionMode mTransitionMode = FilterTransitionMode::Crossfade;
+    float mTransitionSoftness = 0.01f;
+    
+    /**
+     * @brief 可跨线程调整的滤镜参数（写入方全量副本，渲染线程逐帧锁存）
+     */
+    struct FilterParams {
+        float intensity = 1.0f;
+        float brightness = 0.0f;
+        float contrast = 1.0f;
+        float saturation = 1.0f;
+        float temperature = 0.0f;
+        float tint = 0.0f;
+        float colorMatrix[16] = {
+            1, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 0, 1, 0,
+            0, 0, 0, 1
+        };
+        float transitionProgress = 0.0f;
+        FilterTransitionMode transitionMode = FilterTransitionMode::Crossfade;
+        float transitionSoftness = 0.01f;
+        
+        /**
+         * @brief 按色温和色调更新颜色矩阵的对角项
+         */
+        void updateColorCorrection();
+    };
+    ParameterBlock<FilterParams> mParamBlock;
+    
+    // 滤镜参数（本帧锁存值，渲染线程读写）
     float mIntensity = 1.0f;
     float mBrightness = 0.0f;
     float mContrast = 1.0f;
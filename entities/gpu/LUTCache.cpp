@@ -0,0 +1,332 @@
+/**
+ * @file LUTCache.cpp
+ * @brief LUTCache实现
+ */
+
+#include "LUTCache.h"
+#include "pipeline/utils/HalfFloat.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace pipeline {
+
+PixelFormat getLUTPixelFormat(LUTStorageFormat format) {
+    switch (format) {
+        case LUTStorageFormat::RGBA8:   return PixelFormat::RGBA8;
+        case LUTStorageFormat::RGBA16F: return PixelFormat::RGBA16F;
+        case LUTStorageFormat::RGBA32F: return PixelFormat::RGBA32F;
+    }
+    return PixelFormat::RGBA8;
+}
+
+// =============================================================================
+// 解析与打包
+// =============================================================================
+
+bool LUTCache::parseCubeFile(const std::string& path, uint32_t& size, std::vector<float>& rgb) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    size = 0;
+    rgb.clear();
+
+    while (std::getline(file, line)) {
+        // 跳过空行和注释
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // 解析LUT大小
+        if (line.find("LUT_3D_SIZE") != std::string::npos) {
+            std::istringstream iss(line);
+            std::string token;
+            iss >> token >> size;
+            rgb.reserve(static_cast<size_t>(size) * size * size * 3);
+            continue;
+        }
+
+        // 跳过其他头部信息
+        if (line.find("TITLE") != std::string::npos ||
+            line.find("DOMAIN_MIN") != std::string::npos ||
+            line.find("DOMAIN_MAX") != std::string::npos) {
+            continue;
+        }
+
+        // 解析RGB值
+        std::istringstream iss(line);
+        float r, g, b;
+        if (iss >> r >> g >> b) {
+            rgb.push_back(r);
+            rgb.push_back(g);
+            rgb.push_back(b);
+        }
+    }
+
+    return size > 0 && rgb.size() == static_cast<size_t>(size) * size * size * 3;
+}
+
+std::shared_ptr<LUTAsset> LUTCache::pack(const float* rgb, uint32_t size, LUTStorageFormat format) {
+    if (!rgb || size == 0) {
+        return nullptr;
+    }
+
+    auto asset = std::make_shared<LUTAsset>();
+    asset->size = size;
+    asset->format = format;
+    asset->atlasWidth = size * size;
+    asset->atlasHeight = size;
+
+    const size_t texelCount = static_cast<size_t>(size) * size * size;
+    const size_t texelBytes = format == LUTStorageFormat::RGBA8 ? 4 :
+                              format == LUTStorageFormat::RGBA16F ? 8 : 16;
+    asset->texels.resize(texelCount * texelBytes);
+    uint8_t* dst = asset->texels.data();
+
+    // .cube 顺序为 r 最快、b 最慢；图集中 (b * size + r, g)
+    for (uint32_t b = 0; b < size; ++b) {
+        for (uint32_t g = 0; g < size; ++g) {
+            for (uint32_t r = 0; r < size; ++r) {
+                const float* src = rgb + ((static_cast<size_t>(b) * size + g) * size + r) * 3;
+                const size_t texel = static_cast<size_t>(g) * asset->atlasWidth + b * size + r;
+                switch (format) {
+                    case LUTStorageFormat::RGBA8: {
+                        uint8_t* out = dst + texel * 4;
+                        for (int c = 0; c < 3; ++c) {
+                            out[c] = static_cast<uint8_t>(
+                                std::clamp(src[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+                        }
+                        out[3] = 255;
+                        break;
+                    }
+                    case LUTStorageFormat::RGBA16F: {
+                        uint16_t out[4] = {floatToHalf(src[0]), floatToHalf(src[1]),
+                                           floatToHalf(src[2]), floatToHalf(1.0f)};
+                        std::memcpy(dst + texel * 8, out, sizeof(out));
+                        break;
+                    }
+                    case LUTStorageFormat::RGBA32F: {
+                        float out[4] = {src[0], src[1], src[2], 1.0f};
+                        std::memcpy(dst + texel * 16, out, sizeof(out));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return asset;
+}
+
+// =============================================================================
+// 缓存
+// =============================================================================
+
+LUTCache& LUTCache::instance() {
+    static LUTCache sInstance;
+    return sInstance;
+}
+
+std::string LUTCache::makeKey(const std::string& path, LUTStorageFormat format) {
+    return path + "#" + std::to_string(static_cast<int>(format));
+}
+
+LUTAssetPtr LUTCache::load(const std::string& path, LUTStorageFormat format) {
+    const std::string key = makeKey(path, format);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(key);
+        if (it != mEntries.end()) {
+            it->second.lastUse = ++mUseCounter;
+            return it->second.asset;
+        }
+    }
+
+    // 解析在锁外进行：预取线程读文件时不阻塞GPU线程取纹理
+    uint32_t size = 0;
+    std::vector<float> rgb;
+    if (!parseCubeFile(path, size, rgb)) {
+        PIPELINE_LOGE("Failed to parse LUT file %s", path.c_str());
+        return nullptr;
+    }
+    auto asset = pack(rgb.data(), size, format);
+    if (!asset) {
+        return nullptr;
+    }
+    asset->key = key;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto result = mEntries.emplace(key, Entry{});
+    Entry& entry = result.first->second;
+    if (result.second) {
+        entry.asset = std::move(asset);
+        mCachedBytes += entry.asset->byteSize();
+    }
+    entry.lastUse = ++mUseCounter;
+    LUTAssetPtr loaded = entry.asset;
+    evictLocked();
+    return loaded;
+}
+
+bool LUTCache::prefetch(const std::string& path, LUTStorageFormat format) {
+    LUTAssetPtr asset = load(path, format);
+    if (!asset) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (std::find(mPendingUploads.begin(), mPendingUploads.end(), asset->key) ==
+        mPendingUploads.end()) {
+        mPendingUploads.push_back(asset->key);
+    }
+    return true;
+}
+
+std::shared_ptr<lrengine::render::LRTexture> LUTCache::acquireTexture(
+    lrengine::render::LRRenderContext* context, const LUTAssetPtr& asset) {
+    if (!context || !asset) {
+        return nullptr;
+    }
+    if (asset->key.empty()) {
+        return uploadTexture(context, *asset);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(asset->key);
+        if (it != mEntries.end()) {
+            it->second.lastUse = ++mUseCounter;
+            for (const auto& texture : it->second.textures) {
+                if (texture.first == context) {
+                    return texture.second;
+                }
+            }
+        }
+    }
+
+    auto texture = uploadTexture(context, *asset);
+    if (!texture) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mEntries.find(asset->key);
+    if (it != mEntries.end() && it->second.asset == asset) {
+        it->second.textures.emplace_back(context, texture);
+    }
+    return texture;
+}
+
+size_t LUTCache::uploadPending(lrengine::render::LRRenderContext* context, size_t maxUploads) {
+    size_t uploaded = 0;
+    while (uploaded < maxUploads) {
+        LUTAssetPtr asset;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mPendingUploads.empty()) {
+                break;
+            }
+            auto it = mEntries.find(mPendingUploads.front());
+            mPendingUploads.pop_front();
+            if (it == mEntries.end()) {
+                continue;       // 排队期间已被淘汰
+            }
+            asset = it->second.asset;
+        }
+        if (acquireTexture(context, asset)) {
+            ++uploaded;
+        }
+    }
+    return uploaded;
+}
+
+void LUTCache::purge(lrengine::render::LRRenderContext* context) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!context) {
+        mEntries.clear();
+        mPendingUploads.clear();
+        mCachedBytes = 0;
+        return;
+    }
+    for (auto& pair : mEntries) {
+        auto& textures = pair.second.textures;
+        textures.erase(std::remove_if(textures.begin(), textures.end(),
+                                      [context](const auto& t) { return t.first == context; }),
+                       textures.end());
+    }
+}
+
+void LUTCache::setCapacity(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCapacity = maxBytes;
+    evictLocked();
+}
+
+size_t LUTCache::getCachedBytes() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCachedBytes;
+}
+
+void LUTCache::evictLocked() {
+    while (mCachedBytes > mCapacity) {
+        // 正在被滤镜使用的LUT（缓存外仍有引用）不淘汰
+        auto victim = mEntries.end();
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            if (it->second.asset.use_count() > 1) {
+                continue;
+            }
+            if (victim == mEntries.end() || it->second.lastUse < victim->second.lastUse) {
+                victim = it;
+            }
+        }
+        if (victim == mEntries.end()) {
+            break;
+        }
+        mCachedBytes -= victim->second.asset->byteSize();
+        mEntries.erase(victim);
+    }
+}
+
+std::shared_ptr<lrengine::render::LRTexture> LUTCache::uploadTexture(
+    lrengine::render::LRRenderContext* context, const LUTAsset& asset) {
+    (void)context;
+
+    // 图集纹理：线性过滤、边缘截断；四面体插值在着色器内取最近的8个格点
+    /*
+    lrengine::render::TextureDescriptor desc;
+    desc.width = asset.atlasWidth;
+    desc.height = asset.atlasHeight;
+    desc.format = getLUTPixelFormat(asset.format);   // 按 TexturePool::convertPixelFormat 的映射
+    desc.mipLevels = 1;
+    desc.type = lrengine::render::TextureType::Texture2D;
+    desc.minFilter = lrengine::render::FilterMode::Linear;
+    desc.magFilter = lrengine::render::FilterMode::Linear;
+    desc.wrapS = lrengine::render::WrapMode::ClampToEdge;
+    desc.wrapT = lrengine::render::WrapMode::ClampToEdge;
+
+    auto texture = std::shared_ptr<lrengine::render::LRTexture>(context->CreateTexture(desc));
+    if (!texture) {
+        PIPELINE_LOGE("Failed to create %ux%u LUT atlas", asset.atlasWidth, asset.atlasHeight);
+        return nullptr;
+    }
+    texture->UpdateData(asset.texels.data());
+    return texture;
+    */
+
+    // 渲染后端的纹理数据上传尚未接入（与 TexturePool 的纹理创建相同），此时没有图集纹理；
+    // 调用方据此报错而不是在没有LUT的情况下绘制。打包结果仍保留在缓存中，接入后直接可用。
+    static std::atomic<bool> sWarned{false};
+    if (!sWarned.exchange(true, std::memory_order_relaxed)) {
+        PIPELINE_LOGW("LUT atlas upload is not available in this build (%ux%u %s atlas not uploaded)",
+                      asset.atlasWidth, asset.atlasHeight, asset.key.c_str());
+    }
+    return nullptr;
+}
+
+} // namespace pipeline
@@ -0,0 +1,159 @@
+/**
+ * @file LUTCache.h
+ * @brief 3D LUT 缓存 - 打包为2D图集纹理，按文件路径复用，支持预取
+ */
+
+#pragma once
+
+#include "pipeline/data/EntityTypes.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 前向声明
+namespace lrengine {
+namespace render {
+class LRRenderContext;
+class LRTexture;
+} // namespace render
+} // namespace lrengine
+
+namespace pipeline {
+
+/**
+ * @brief LUT纹理存储格式
+ *
+ * 64³ LUT：RGBA8 1MB，RGBA16F 2MB，原浮点RGB 3MB。
+ * RGBA8 对SDR滤镜足够；超出 [0,1] 的HDR LUT 使用 RGBA16F，否则会被截断。
+ */
+enum class LUTStorageFormat : uint8_t {
+    RGBA8,          // 8位定点（默认）
+    RGBA16F,        // 半精度浮点
+    RGBA32F         // 单精度浮点（仅用于比对精度）
+};
+
+/**
+ * @brief LUT插值方式
+ */
+enum class LUTInterpolation : uint8_t {
+    Trilinear,      // 两个蓝色切片各一次双线性采样再插值（2次采样）
+    Tetrahedral     // 四面体插值（4次纹素中心采样，色相过渡更平滑）
+};
+
+/**
+ * @brief 获取LUT存储格式对应的纹理像素格式
+ */
+PixelFormat getLUTPixelFormat(LUTStorageFormat format);
+
+/**
+ * @brief 打包后的3D LUT
+ *
+ * 图集布局：宽 size*size、高 size，蓝色分量为切片序号，
+ * 纹素 (b * size + r, g) 对应 LUT[r][g][b]。
+ */
+struct LUTAsset {
+    std::string key;                    ///< 缓存键（内存加载的LUT为空，不进缓存）
+    uint32_t size = 0;                  ///< 每维格点数
+    LUTStorageFormat format = LUTStorageFormat::RGBA8;
+    uint32_t atlasWidth = 0;
+    uint32_t atlasHeight = 0;
+    std::vector<uint8_t> texels;        ///< 按 format 打包的图集数据（行主序，无行填充）
+
+    size_t byteSize() const { return texels.size(); }
+};
+
+using LUTAssetPtr = std::shared_ptr<const LUTAsset>;
+
+/**
+ * @brief 进程级LUT缓存
+ *
+ * 同一路径 + 存储格式只解析、打包一次；每个渲染上下文只上传一次纹理。
+ * 滤镜滑动切换时先 prefetch 下一张，解析在调用线程完成，
+ * 上传由 FilterEntity 在GPU线程每帧最多处理一张，避免单帧卡顿。
+ */
+class LUTCache {
+public:
+    static LUTCache& instance();
+
+    // 禁止拷贝
+    LUTCache(const LUTCache&) = delete;
+    LUTCache& operator=(const LUTCache&) = delete;
+
+    /**
+     * @brief 加载LUT文件（命中缓存时不读文件，可在任意线程调用）
+     * @return 失败返回nullptr
+     */
+    LUTAssetPtr load(const std::string& path, LUTStorageFormat format);
+
+    /**
+     * @brief 预取：解析打包并排队等待上传
+     * @return 文件可用返回true
+     */
+    bool prefetch(const std::string& path, LUTStorageFormat format);
+
+    /**
+     * @brief 获取LUT纹理（GPU线程）；缓存内的LUT每个上下文只上传一次
+     * @return 上传失败（或渲染后端不支持纹理上传）时返回nullptr，不缓存失败结果
+     */
+    std::shared_ptr<lrengine::render::LRTexture> acquireTexture(
+        lrengine::render::LRRenderContext* context, const LUTAssetPtr& asset);
+
+    /**
+     * @brief 上传已预取的LUT（GPU线程）
+     * @param maxUploads 本次最多上传数
+     * @return 实际上传数
+     */
+    size_t uploadPending(lrengine::render::LRRenderContext* context, size_t maxUploads = 1);
+
+    /**
+     * @brief 释放上下文的LUT纹理（context 为空时清空整个缓存）
+     */
+    void purge(lrengine::render::LRRenderContext* context = nullptr);
+
+    /**
+     * @brief 设置容量（打包数据字节数），超出时淘汰最久未用且无人引用的LUT
+     */
+    void setCapacity(size_t maxBytes);
+
+    size_t getCachedBytes() const;
+
+    /**
+     * @brief 将浮点RGB LUT（r最快变化）打包为图集
+     */
+    static std::shared_ptr<LUTAsset> pack(const float* rgb, uint32_t size, LUTStorageFormat format);
+
+    /**
+     * @brief 解析 .cube 文件
+     */
+    static bool parseCubeFile(const std::string& path, uint32_t& size, std::vector<float>& rgb);
+
+private:
+    LUTCache() = default;
+
+    struct Entry {
+        LUTAssetPtr asset;
+        std::vector<std::pair<lrengine::render::LRRenderContext*,
+                              std::shared_ptr<lrengine::render::LRTexture>>> textures;
+        uint64_t lastUse = 0;
+    };
+
+    static std::string makeKey(const std::string& path, LUTStorageFormat format);
+    static std::shared_ptr<lrengine::render::LRTexture> uploadTexture(
+        lrengine::render::LRRenderContext* context, const LUTAsset& asset);
+    void evictLocked();
+
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, Entry> mEntries;
+    std::deque<std::string> mPendingUploads;
+    size_t mCachedBytes = 0;
+    size_t mCapacity = 16u << 20;       // 约16张 64³ RGBA8 LUT
+    uint64_t mUseCounter = 0;
+};
+
+} // namespace pipeline
@@ -20,6 +20,7 @@
 #include "core/PipelineConfig.h"
 #include "core/PipelineGraph.h"
 #include "core/PipelineExecutor.h"
+#include "core/WorkStealingThreadPool.h"
 #include "core/PipelineManager.h"
 
 // 资源池
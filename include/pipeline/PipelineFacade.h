@@ -43,6 +43,7 @@ namespace pipeline {
 // 类型别名，简化命名空间
 using InputFormat = input::InputFormat;
 using EncoderType = output::EncoderType;
+using EncoderConfig = output::EncoderConfig;
 using OutputDataFormat = output::OutputFormat;
 
 // =============================================================================
@@ -82,6 +83,7 @@ struct PipelineFacadeConfig {
     // 基础配置
     PipelinePreset preset = PipelinePreset::CameraPreview;
     QualityLevel quality = QualityLevel::Medium;
+    bool enableAdaptiveQuality = false;   // 按温控与帧耗时在 quality 与 Low 之间自动升降档
     
     // 平台配置
     PlatformContextConfig platformConfig;
@@ -89,6 +91,7 @@ struct PipelineFacadeConfig {
     // 渲染配置
     uint32_t renderWidth = 1920;
     uint32_t renderHeight = 1080;
+    float previewRenderScale = 1.0f;      // 仅显示时的代理渲染比例（编码/文件输出时自动全分辨率）
     bool enableAsync = true;
     int32_t maxQueueSize = 3;
     
@@ -96,6 +99,7 @@ struct PipelineFacadeConfig {
     bool enableGPUOptimization = true;
     bool enableMultiThreading = true;
     int32_t threadPoolSize = 4;
+    bool enableTransferQueue = false;     // 上传/读回在共享上下文（Metal 为第二个命令队列）上与渲染并行
     
     // 调试配置
     bool enableProfiling = false;
@@ -119,6 +123,9 @@ struct PipelineCallbacks {
     std::function<void(PipelineState)> onStateChanged;
     std::function<void(const std::string&)> onError;
     
+    // 启动回调：首帧完成时调用一次，参数为自启动起的耗时（微秒）
+    std::function<void(int64_t startupUs)> onFirstFrame;
+    
     // 性能回调
     std::function<void(const ExecutionStats&)> onStatsUpdate;
 };
@@ -282,6 +289,15 @@ public:
      */
     int32_t setupEncoderOutput(void* encoderSurface, EncoderType encoderType = EncoderType::H264);
     
+    /**
+     * @brief 设置硬件编码输出（渲染结果直接写入编码器输入表面，无CPU读回）
+     * @param encoderSurface Android: MediaCodec 输入 Surface 的 ANativeWindow*；
+     *                       iOS: AVAssetWriterInputPixelBufferAdaptor*
+     * @param config 编码配置（宽高为0时使用渲染尺寸）
+     * @return 输出目标ID
+     */
+    int32_t setupEncoderOutput(void* encoderSurface, const EncoderConfig& config);
+    
     /**
      * @brief 设置回调输出
      * @param callback 帧回调
@@ -293,6 +309,9 @@ public:
     
     /**
      * @brief 设置文件输出
+     * 
+     * 以渲染尺寸硬件编码 H.264，写为分片 MP4；封装与写文件在IO队列进行，
+     * 分片周期落盘，长时间录制内存不增长，异常退出只损失最后一个分片。
      * @param filePath 文件路径
      * @return 输出目标ID
      */
@@ -393,15 +412,28 @@ public:
     void setMirror(bool horizontal, bool vertical);
     
     /**
-     * @brief 设置裁剪区域
+     * @brief 设置裁剪区域（归一化坐标）
+     * 
+     * 区域作为ROI从输入随帧传递，开启 setRoiLimited 的Entity只处理该区域。
      */
     void setCropRect(float x, float y, float width, float height);
     
     /**
-     * @brief 设置帧率限制
+     * @brief 设置输入帧率上限（在输入提交端按时间戳抽帧，<= 0 取消）
      */
     void setFrameRateLimit(int32_t fps);
     
+    /**
+     * @brief 下一帧以全分辨率渲染（代理分辨率预览下拍照）
+     */
+    void requestFullResolutionFrame();
+    
+    /**
+     * @brief 拍照/连拍（全分辨率带外执行，不影响预览，见 PipelineManager::capture）
+     */
+    bool capture(const std::vector<FramePacketPtr>& frames,
+                 PipelineManager::CaptureCallback callback);
+    
     // ==========================================================================
     // 回调设置
     // ==========================================================================
@@ -450,6 +482,22 @@ public:
      */
     double getAverageProcessTime() const;
     
+    /**
+     * @brief 拉取实时指标（计数器与仪表，见 PipelineManager::getMetrics）
+     */
+    MetricsSnapshot getMetricsSnapshot() const;
+    
+    /**
+     * @brief 开始周期推送指标（回调在推送线程上执行）
+     * @param intervalMs 推送间隔（毫秒）
+     */
+    bool startMetricsPush(uint32_t intervalMs, std::function<void(const MetricsSnapshot&)> callback);
+    
+    /**
+     * @brief 停止周期推送
+     */
+    void stopMetricsPush();
+    
     // ==========================================================================
     // 高级功能
     // ==========================================================================
@@ -495,6 +543,11 @@ private:
      */
     bool initializePlatformContext();
     
+    /**
+     * @brief 创建传输上下文并交给 PipelineManager（需在其 initialize 之前）
+     */
+    void setupTransferContext();
+    
     /**
      * @brief 初始化渲染上下文
      */
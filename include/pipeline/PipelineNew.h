@@ -47,6 +47,7 @@ class Pipeline : public std::enable_shared_from_this<Pipeline> {
 public:
     static PipelineBuilder create();
     static std::shared_ptr<Pipeline> fromJsonFile(const std::string& configFilePath);
+    static std::shared_ptr<Pipeline> fromBinaryFile(const std::string& binaryFilePath);
     
     ~Pipeline();
     Pipeline(const Pipeline&) = delete;
@@ -82,6 +83,8 @@ public:
     void setMirror(bool horizontal, bool vertical);
     void setFrameRateLimit(int32_t fps);
     
+    bool capture(const std::vector<FramePacketPtr>& frames, PipelineManager::CaptureCallback callback);
+    
     void setFrameProcessedCallback(std::function<void(FramePacketPtr)> callback);
     void setErrorCallback(std::function<void(const std::string&)> callback);
     void setStateCallback(std::function<void(PipelineState)> callback);
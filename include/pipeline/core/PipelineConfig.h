@@ -9,7 +9,10 @@
 #include <string>
 #include <unordered_map>
 #include <any>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 
 // 前向声明
@@ -24,8 +27,12 @@ namespace pipeline {
 // 前向声明
 class TexturePool;
 class FramePacketPool;
+class FrameArena;
+class AsyncReadbackService;
+class GpuResourceRegistry;
 class PipelineGraph;
 class PipelineExecutor;
+class WorkStealingThreadPool;
 
 /**
  * @brief 管线配置
@@ -40,16 +47,37 @@ struct PipelineConfig {
     
     // 资源池配置
     uint32_t texturePoolSize = 16;        // 纹理池大小
-    uint32_t framePacketPoolSize = 5;     // 帧包池大小
-    uint32_t bufferPoolSize = 8;          // 缓冲池大小
+    size_t texturePoolMaxBytes = 0;       // 纹理池显存预算（字节，0表示不限）
+    bool degradeOnMemoryPressure = true;  // 严重内存压力时降低CPU处理分辨率
+    uint32_t framePacketPoolSize = 16;    // 帧包池大小（在途帧数 x 产出帧包的Entity数）
+    uint32_t bufferPoolSize = 8;          // 缓冲池每个尺寸级保留的空闲CPU缓冲数
+    bool enableAsyncReadback = false;     // GPU输出异步读回给下游CPU节点（PBO / 共享MTLBuffer）
+    uint32_t readbackRingSize = 3;        // 异步读回暂存槽位数
+    bool enableGpuFences = true;          // GPU输出交给非GPU节点时插入栅栏（EGL sync / MTLSharedEvent）
+    bool enableTransferQueue = false;     // CPU帧上传与异步读回在共享上下文的传输队列执行，与渲染重叠
+    bool shareResources = false;          // 与同一渲染上下文的其他管线共用纹理池、GPU资源表与GPU队列（见 ResourceHub）
+    size_t sharedTextureQuotaBytes = 0;   // 共用时本管线在用纹理的配额（字节，0表示不限）
     
     // 执行配置
     uint32_t maxConcurrentFrames = 3;     // 最大并发帧数
     bool enableParallelExecution = true;  // 启用并行执行
     bool enableFrameSkipping = true;      // 启用跳帧
+    uint32_t cpuThreadCount = 0;          // CPU工作线程数（0表示自动）
+    bool enableWorkStealing = false;      // CPU任务使用工作窃取线程池
+    bool pinCPUWorkersToBigCores = false; // CPU工作线程绑定大核（ARM big.LITTLE）
+    bool enablePriorityLanes = false;     // 按调度通道优先执行（预览优先于录制）
+    bool enableShaderFusion = true;       // 融合相邻的逐像素GPU节点，省去中间渲染目标
+    bool enableCommandRecording = false;  // 一帧的GPU节点共用一个命令缓冲，帧末提交一次（Metal）
+    bool enableStateTracking = true;      // 跳过相邻GPU节点间重复的FBO/程序/纹理绑定（GLES）
+    bool enableLazyOutputs = false;       // 按需产出：本帧无人读取的输入输出（如隔帧检测的CPU帧）不做转换/上传
+    bool enableFormatNegotiation = false; // 协商节点间纹理格式：YUV 尽量保持到第一个需要 RGB 的节点，LUT 等可要求高精度格式
+    bool enableStagedStartup = false;     // 分阶段启动：资源加载在CPU线程并行、着色器预热排在GPU队列，可降级节点首帧后加入
+    std::string shaderCacheDirectory;     // 着色器二进制缓存目录（空=仅进程内缓存）
+    float previewRenderScale = 1.0f;      // 仅预览时的代理渲染比例（录制/拍照帧仍全分辨率，1=关闭）
     
     // 调试配置
     bool enableProfiling = false;         // 启用性能分析
+    bool enableTracing = false;           // 启用事件追踪（Chrome Trace 导出）
     bool enableValidation = true;         // 启用验证
     bool enableLogging = false;           // 启用日志
 };
@@ -106,6 +134,81 @@ public:
      */
     std::shared_ptr<FramePacketPool> getFramePacketPool() const { return mFramePacketPool; }
     
+    /**
+     * @brief 设置异步读回服务
+     */
+    void setReadbackService(std::shared_ptr<AsyncReadbackService> service);
+    
+    /**
+     * @brief 获取异步读回服务（未启用时为空）
+     */
+    std::shared_ptr<AsyncReadbackService> getReadbackService() const { return mReadbackService; }
+    
+    /**
+     * @brief 设置GPU共享资源表
+     */
+    void setGpuResourceRegistry(std::shared_ptr<GpuResourceRegistry> registry);
+    
+    /**
+     * @brief 获取GPU共享资源表（全屏四边形、管线状态、采样器；未设置时为空）
+     */
+    std::shared_ptr<GpuResourceRegistry> getGpuResourceRegistry() const { return mGpuResources; }
+    
+    /**
+     * @brief 获取输出帧包
+     * 
+     * 优先从帧包池非阻塞取出（最后一个引用释放时自动归还）；
+     * 未设置帧包池或池已耗尽时退化为堆分配，不阻塞也不丢帧。
+     * @return 帧包（不为空）
+     */
+    FramePacketPtr acquireFramePacket();
+    
+    /**
+     * @brief 获取当前帧的内存区
+     * 
+     * 仅在Entity执行期间有效，内存在本帧结束时整体回收，不得存入会流出本帧的数据。
+     * @return 帧内存区，不在帧内执行或未启用时返回nullptr
+     */
+    FrameArena* getFrameArena() const;
+    
+    /**
+     * @brief 获取当前帧的内存资源（供 std::pmr 容器使用）
+     * @return 帧内存区，不可用时返回默认堆资源
+     */
+    std::pmr::memory_resource* getFrameMemoryResource() const;
+    
+    // ==========================================================================
+    // 并行
+    // ==========================================================================
+    
+    /**
+     * @brief 设置CPU工作线程池（由 PipelineExecutor 设置）
+     */
+    void setCPUThreadPool(WorkStealingThreadPool* pool) { mCPUThreadPool.store(pool); }
+    
+    /**
+     * @brief 在CPU工作线程池中并行执行 body(0..count-1)，返回时全部完成
+     * 
+     * 调用线程参与执行，可在Entity的process中调用；未启用线程池时串行执行。
+     */
+    void parallelFor(uint32_t count, const std::function<void(uint32_t)>& body) const;
+    
+    /**
+     * @brief 设置传输队列投递器（由 PipelineExecutor 设置，为空表示没有传输队列）
+     */
+    void setTransferPoster(std::function<void(std::function<void()>)> poster);
+    
+    /**
+     * @brief 是否有独立的传输队列（共享上下文上的上传/读回线程）
+     */
+    bool hasTransferQueue() const;
+    
+    /**
+     * @brief 向传输队列投递任务
+     * @return 没有传输队列时返回false，任务不会执行
+     */
+    bool postTransfer(std::function<void()> task) const;
+    
     // ==========================================================================
     // 配置
     // ==========================================================================
@@ -215,6 +318,13 @@ private:
     // 资源池
     std::shared_ptr<TexturePool> mTexturePool;
     std::shared_ptr<FramePacketPool> mFramePacketPool;
+    std::shared_ptr<AsyncReadbackService> mReadbackService;
+    std::shared_ptr<GpuResourceRegistry> mGpuResources;
+    std::atomic<WorkStealingThreadPool*> mCPUThreadPool{nullptr};
+    
+    // 传输队列
+    mutable std::mutex mTransferMutex;
+    std::function<void(std::function<void()>)> mTransferPoster;
     
     // 配置
     PipelineConfig mConfig;
@@ -0,0 +1,189 @@
+/**
+ * @file PipelineConfigBinary.h
+ * @brief 二进制 Pipeline 配置 - 离线由 JSON 预编译，启动时映射后直接读取
+ *
+ * JSON 配置在启动路径上需要完整解析、逐项查表；低端设备上这部分耗时明显。
+ * 二进制格式在离线阶段（PipelineConfigLoader::compileBinary）把枚举、尺寸与
+ * 滤镜参数全部解析完毕，按固定布局写出。加载时只校验文件头与校验和，
+ * 各段以定长记录数组原地读取（文件经 mmap 映射，不做反序列化）。
+ *
+ * 布局（小端；定长记录段 4 字节对齐，shaderKeys 段 8 字节对齐）：
+ * @code
+ * BinaryGraphHeader | BinaryGraphSettings | BinaryFilterRecord[n] | uint64_t shaderKeys[m] | 字符串表
+ * @endcode
+ */
+
+#pragma once
+
+#include "pipeline/core/PipelineError.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace pipeline {
+
+class Pipeline;
+class PipelineBuilder;
+
+// =============================================================================
+// 文件布局
+// =============================================================================
+
+/// 文件魔数 "PLBG"
+constexpr uint32_t kBinaryGraphMagic = 0x47424C50u;
+
+/// 格式版本：记录布局或枚举取值变化时递增，旧文件随之拒绝加载
+constexpr uint16_t kBinaryGraphVersion = 1;
+
+/// 字符串表中的空引用
+constexpr uint32_t kBinaryNoString = 0xFFFFFFFFu;
+
+/**
+ * @brief 文件头（偏移均相对文件起始）
+ */
+struct BinaryGraphHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;        ///< sizeof(BinaryGraphHeader)，用于识别布局不一致的编译产物
+    uint32_t totalSize;
+    uint32_t checksum;          ///< 文件头之后全部内容的 FNV-1a 32
+    uint32_t settingsOffset;
+    uint32_t filterOffset;
+    uint32_t filterCount;
+    uint32_t shaderKeyOffset;
+    uint32_t shaderKeyCount;
+    uint32_t stringOffset;
+    uint32_t stringSize;
+    uint32_t reserved;
+};
+
+/**
+ * @brief 全局设置的有效位
+ */
+enum BinaryGraphFlags : uint32_t {
+    kBinaryHasPlatform   = 1u << 0,
+    kBinaryHasInput      = 1u << 1,
+    kBinaryHasQuality    = 1u << 2,
+    kBinaryHasResolution = 1u << 3,
+};
+
+/**
+ * @brief 全局设置（枚举已解析为取值）
+ */
+struct BinaryGraphSettings {
+    uint32_t flags;
+    uint8_t preset;             ///< PipelinePreset
+    uint8_t platform;           ///< PlatformType
+    uint8_t inputFormat;        ///< input::InputFormat
+    uint8_t quality;            ///< QualityLevel
+    uint32_t inputWidth;
+    uint32_t inputHeight;
+    uint32_t outputWidth;
+    uint32_t outputHeight;
+};
+
+/**
+ * @brief 滤镜种类
+ */
+enum class BinaryFilterKind : uint8_t {
+    Beauty,     ///< params = {smooth, whiten}
+    Color,      ///< params = {intensity}，nameOffset 为滤镜名
+    Sharpen,    ///< params = {amount}
+    Blur,       ///< params = {radius}
+};
+
+/**
+ * @brief 滤镜记录（按构建顺序排列）
+ */
+struct BinaryFilterRecord {
+    uint8_t kind;               ///< BinaryFilterKind
+    uint8_t reserved[3];
+    uint32_t nameOffset;        ///< 字符串表偏移（kBinaryNoString 表示无）
+    float params[2];
+};
+
+static_assert(sizeof(BinaryGraphHeader) == 48, "BinaryGraphHeader layout changed");
+static_assert(sizeof(BinaryGraphSettings) == 24, "BinaryGraphSettings layout changed");
+static_assert(sizeof(BinaryFilterRecord) == 16, "BinaryFilterRecord layout changed");
+
+// =============================================================================
+// 只读视图
+// =============================================================================
+
+/**
+ * @brief 二进制配置的只读视图（不持有内存，数据需在使用期间保持有效）
+ */
+class BinaryGraphView {
+public:
+    /**
+     * @brief 校验并建立视图
+     * @param data 文件内容（需 8 字节对齐以便原地读取 uint64_t 段，mmap 与 new 出的内存均满足）
+     * @param size 内容大小
+     */
+    static Result<BinaryGraphView> parse(const void* data, size_t size);
+
+    BinaryGraphView() = default;
+
+    const BinaryGraphSettings& settings() const { return *mSettings; }
+
+    uint32_t filterCount() const { return mHeader->filterCount; }
+    const BinaryFilterRecord& filter(uint32_t index) const { return mFilters[index]; }
+
+    /**
+     * @brief 配置用到的着色器缓存键（ShaderProgramCache::hashSource）
+     *
+     * 可在GPU上下文就绪前据此预取磁盘上的程序二进制。
+     */
+    uint32_t shaderKeyCount() const { return mHeader->shaderKeyCount; }
+    uint64_t shaderKey(uint32_t index) const { return mShaderKeys[index]; }
+
+    /**
+     * @brief 字符串表中的字符串（offset 为 kBinaryNoString 时返回空串）
+     */
+    const char* string(uint32_t offset) const;
+
+private:
+    const BinaryGraphHeader* mHeader = nullptr;
+    const BinaryGraphSettings* mSettings = nullptr;
+    const BinaryFilterRecord* mFilters = nullptr;
+    const uint64_t* mShaderKeys = nullptr;
+    const char* mStrings = nullptr;
+    uint32_t mStringSize = 0;
+};
+
+// =============================================================================
+// 加载器
+// =============================================================================
+
+/**
+ * @brief 二进制 Pipeline 配置加载器
+ *
+ * 与 PipelineConfigLoader 产出相同的 Pipeline，但不依赖 JSON 解析。
+ */
+class PipelineBinaryLoader {
+public:
+    /**
+     * @brief 映射文件并构建 Pipeline
+     * @param filePath 由 PipelineConfigLoader::compileBinaryFile 生成的文件
+     */
+    static Result<std::shared_ptr<Pipeline>> fromFile(const std::string& filePath);
+
+    /**
+     * @brief 由内存中的二进制构建 Pipeline（如打包在资源中的配置）
+     */
+    static Result<std::shared_ptr<Pipeline>> fromMemory(const void* data, size_t size);
+
+    /**
+     * @brief 把视图中的配置应用到 builder（调用方可继续追加输出、回调）
+     */
+    static void applyTo(const BinaryGraphView& view, PipelineBuilder& builder);
+};
+
+/**
+ * @brief 二进制内容校验和（FNV-1a 32）
+ */
+uint32_t binaryGraphChecksum(const void* data, size_t size);
+
+} // namespace pipeline
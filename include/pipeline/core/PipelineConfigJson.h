@@ -3,6 +3,7 @@
 #include "pipeline/PipelineNew.h"
 #include "pipeline/core/PipelineError.h"
 #include <nlohmann/json.hpp>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,22 @@ public:
      */
     static Result<std::shared_ptr<Pipeline>> fromString(const std::string& jsonString);
     
+    /**
+     * @brief 把 JSON 配置预编译为二进制格式（离线工具或构建脚本调用）
+     * 
+     * 产物由 PipelineBinaryLoader 加载，启动时无需 JSON 解析。
+     * 可选字段 "shaderCacheKeys"（数字或十六进制字符串数组）原样写入，供加载端预取。
+     * 
+     * @param jsonString JSON 字符串
+     * @return 二进制内容或错误
+     */
+    static Result<std::vector<uint8_t>> compileBinary(const std::string& jsonString);
+    
+    /**
+     * @brief 编译 JSON 文件并写出二进制文件
+     */
+    static Result<void> compileBinaryFile(const std::string& jsonPath, const std::string& binaryPath);
+    
     /**
      * @brief 验证 JSON 配置
      * @param json JSON 对象
@@ -7,10 +7,19 @@
 
 #include "pipeline/data/EntityTypes.h"
 #include "PipelineGraph.h"
+#include "pipeline/utils/LatencyHistogram.h"
 #include <memory>
 #include <atomic>
 #include <functional>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 // 前向声明TaskQueue类型
 namespace task {
@@ -23,8 +32,12 @@ namespace pipeline {
 
 // 前向声明
 class PipelineContext;
+class WorkStealingThreadPool;
+class FrameArena;
+class FrameArenaPool;
 class TexturePool;
 class FramePacketPool;
+struct ShaderFusionChain;
 
 /**
  * @brief 执行器配置
@@ -33,12 +46,55 @@ struct ExecutorConfig {
     std::string gpuQueueLabel = "Pipeline.GPU";
     std::string cpuQueueLabel = "Pipeline.CPU";
     std::string ioQueueLabel = "Pipeline.IO";
+    std::string transferQueueLabel = "Pipeline.Transfer";
     
-    uint32_t maxConcurrentFrames = 3;     // 最大并发帧数
-    uint32_t cpuThreadCount = 0;           // CPU线程数（0表示自动）
+    uint32_t maxConcurrentFrames = 3;     // 最大并发帧数（在途帧上限，1表示逐帧执行）
+    uint32_t cpuThreadCount = 0;           // CPU线程数（0表示自动，仅工作窃取线程池生效）
+    bool useWorkStealingCPUPool = false;   // CPUParallel Entity 使用工作窃取线程池（替代TaskQueue并发队列）
+    bool enableTransferQueue = false;      // 上传/读回走独立传输队列（需 setTransferContextBinding 提供共享上下文）
+    bool pinCPUWorkersToBigCores = false;  // 工作线程绑定到大核（ARM big.LITTLE）
     bool enableParallelExecution = true;   // 是否启用并行执行
+    bool enableCriticalPathPriority = true; // 同时就绪的Entity按实测耗时估算的剩余关键路径从长到短投递
     bool enableFrameSkipping = true;       // 是否启用跳帧
     uint32_t maxPendingFrames = 5;         // 最大待处理帧数（超过则跳帧）
+    
+    // 调度通道（异步任务链）：同一队列内就绪任务按通道优先级出队，在Entity边界抢占
+    bool enablePriorityLanes = false;      // 启用调度通道
+    uint32_t laneStarvationLimit = 4;      // 低优先级通道最多被连续越过的次数，超过则优先执行一次
+    
+    // 延迟预算（异步任务链）：输入就绪到帧完成的目标时长
+    uint32_t latencyBudgetMs = 0;          // 延迟预算（毫秒，0表示关闭），如预览取33
+    bool enableDegradation = true;         // 预算不足时优先跳过可降级Entity（isOptional）
+    uint32_t maxConsecutiveDeadlineDrops = 2; // 连续因时限丢帧上限，超过则强制执行以免画面冻结
+    
+    bool enableShaderFusion = true;        // 相邻逐像素GPU Entity合并为一次绘制（见 ShaderFusion.h）
+    bool enableCommandRecording = false;   // 一帧的GPU节点编码进同一命令缓冲，帧末提交一次（Metal，见 GpuCommandContext）
+    bool enableStateTracking = true;       // 跳过相邻GPU节点之间未变化的FBO/程序/纹理绑定
+    bool enableLazyOutputs = false;        // 按需产出（异步任务链）：本帧无人读取的输出不生成图像数据（见 ProcessEntity::wantsInput）
+    bool enableFormatNegotiation = false;  // 编译计划时协商各输出的像素格式（见 ProcessEntity::getAcceptedInputFormats）
+    
+    // 图编辑（异步任务链）：新计划在IO队列按图快照编译、GPU队列预热，就绪前旧计划继续出帧
+    bool enableAsyncPlanSwap = true;       // 关闭则在帧开始时同步编译（旧行为）
+    
+    // 代理分辨率：只有预览目标时按比例缩小渲染，录制/拍照帧仍为全分辨率
+    float proxyRenderScale = 1.0f;         // 代理渲染比例（(0, 1]，1表示关闭）
+    
+    bool enableProfiling = false;          // 采集各Entity耗时直方图（见 getEntityStats）
+    bool enableTracing = false;            // 初始化时开启 PipelineTrace（导出见 PipelineTrace::writeChromeTrace）
+    
+    // 帧内存区：每个在途帧一个，Entity 经 PipelineContext::getFrameArena() 取用临时内存
+    size_t frameArenaSize = 256 * 1024;    // 帧内存区初始块大小（字节，0表示不提供）
+};
+
+/**
+ * @brief 传输上下文绑定（均在传输队列线程上调用）
+ * 
+ * attach 让与渲染上下文同一共享组的第二个上下文在当前线程生效（EGL 共享上下文；
+ * Metal 无需绑定，可直接返回true），detach 在关闭时解除。
+ */
+struct TransferContextBinding {
+    std::function<bool()> attach;
+    std::function<void()> detach;
 };
 
 /**
@@ -51,20 +107,147 @@ struct ExecutionStats {
     uint64_t peakFrameTime = 0;         // 峰值帧处理时间
     uint64_t lastFrameTime = 0;         // 最后一帧处理时间
     
-    // 各队列统计
+    // 延迟预算统计
+    uint64_t deadlineDroppedFrames = 0; // 因预计超出时限丢弃的帧数（计入droppedFrames）
+    uint64_t degradedFrames = 0;        // 降级执行的帧数
+    uint64_t inputDroppedFrames = 0;    // 输入队列满或被新帧覆盖而丢弃的帧数（计入droppedFrames）
+    uint64_t lastPredictedLatency = 0;  // 最近一次预测的剩余延迟（微秒）
+    
+    uint64_t proxyFrames = 0;           // 以代理分辨率执行的帧数
+    
+    // 各队列统计（异步任务链中Entity执行耗时累计，微秒）
     uint64_t gpuQueueTime = 0;
     uint64_t cpuQueueTime = 0;
     uint64_t ioQueueTime = 0;
 };
 
+/**
+ * @brief 单个Entity的性能统计（微秒）
+ */
+struct EntityStats {
+    EntityId entityId = InvalidEntityId;
+    std::string name;
+    ExecutionQueue queue = ExecutionQueue::GPU;
+    HistogramSummary wallTime;          // 执行耗时
+    HistogramSummary queueWait;         // 就绪到开始执行的排队耗时
+    HistogramSummary gpuTime;           // GPU线程占用耗时（仅GPU队列Entity；CPU侧测量，不含GPU异步执行）
+};
+
+/**
+ * @brief 性能剖析快照
+ */
+struct ProfilingSnapshot {
+    ExecutionStats frameStats;          // 帧级统计
+    HistogramSummary frameTime;         // 帧耗时分布（微秒）
+    std::vector<EntityStats> entities;  // 各Entity统计（按执行顺序）
+};
+
+/**
+ * @brief 编译后的执行计划
+ * 
+ * 由某一图版本编译得到，创建后只读，可被多个在途帧共享。
+ * 每个Entity分配一个密集索引（拓扑序），Entity指针、执行队列、
+ * 上游计数等按索引连续存放；变长列表（后继、输入绑定、层级）
+ * 采用 offsets + 扁平数组的布局。帧调度期间无哈希查找、无内存分配。
+ */
+struct CompiledPlan {
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+    
+    uint64_t graphVersion = 0;                                // 对应的图版本
+    
+    // 按索引存放（size() 个元素）
+    std::vector<ProcessEntityPtr> entities;                   // Entity指针
+    std::vector<EntityId> entityIds;                          // EntityId
+    std::vector<task::TaskQueue*> queues;                     // 执行队列（由执行器持有，计划不延长其生命周期）
+    std::vector<ExecutionQueue> queueTypes;                   // 执行队列类型
+    std::vector<int32_t> upstreamCounts;                      // 上游Entity数量
+    std::vector<ExecutionLane> lanes;                         // 生效的调度通道（已解析继承）
+    std::vector<uint8_t> directGpuAccess;                     // GPU队列上绕过 GpuCommandContext 的Entity（非GPUEntity）
+    uint32_t gpuEntityCount = 0;                              // GPU队列上的Entity数
+    
+    // 后继：successors[successorOffsets[i] .. successorOffsets[i+1])
+    std::vector<uint32_t> successorOffsets;
+    std::vector<uint32_t> successors;
+    
+    // 输入端口：inputSlots[inputOffsets[i] + port] 为来源输出槽位
+    std::vector<uint32_t> inputOffsets;
+    std::vector<uint32_t> inputSlots;
+    
+    std::vector<uint8_t> inputDeferred;                       // 与 inputSlots 对应：是否为延迟输入
+    
+    // 输出槽位：Entity i 的输出端口 k 存放于帧输出 outputOffsets[i] + k
+    std::vector<uint32_t> outputOffsets;
+    
+    // 延迟输入投递：Entity i 完成后按 deferredInputs[deferredOffsets[i] .. deferredOffsets[i+1]) 投递
+    struct DeferredInput {
+        uint32_t slot;                                        // 来源输出槽位
+        uint32_t consumer;                                    // 接收Entity索引
+        uint32_t port;                                        // 接收端口索引
+    };
+    std::vector<uint32_t> deferredOffsets;
+    std::vector<DeferredInput> deferredInputs;
+    
+    // 旁路分支：结果只经延迟输入流出的Entity。不与相邻帧交接，仍在忙时跳过本帧，
+    // 慢分支因此不占用帧序，也不拖慢主分支
+    std::vector<uint8_t> sideBranch;
+    std::unique_ptr<std::atomic<uint8_t>[]> sideBranchBusy;   // 运行期状态：是否有帧正在执行
+    
+    // 着色器融合：链首与成员共享同一条链；成员（headIndex != i）在异步/批量路径中直通输入，
+    // 由链首一次绘制。按端口执行的同步路径不使用
+    std::vector<std::shared_ptr<const ShaderFusionChain>> fusion;
+    
+    // 执行层级：levelEntities[levelOffsets[l] .. levelOffsets[l+1])
+    std::vector<uint32_t> levelOffsets;
+    std::vector<uint32_t> levelEntities;
+    
+    // 输出槽位生命周期（按槽位）：最后一个消费者结束后释放帧包，
+    // 生命周期不重叠的中间结果得以复用同一块池化纹理/缓冲
+    std::vector<int32_t> slotConsumerCounts;                  // 引用该槽位的输入端口数（0表示保留到帧结束）
+    std::vector<uint32_t> slotLastLevel;                      // 最后被消费的执行层级
+    uint32_t peakLiveSlots = 0;                               // 按层级执行时同时存活的最大槽位数
+    
+    // 槽位消费者（按需产出）：slotConsumers[slotConsumerOffsets[s] .. slotConsumerOffsets[s+1]) 读取槽位 s，
+    // 含延迟输入；被剔除的Entity不在其中（其消费者已接到上游）。没有消费者的槽位无需生成图像数据
+    struct SlotConsumer {
+        uint32_t entity;                                      // 消费Entity索引
+        uint32_t port;                                        // 输入端口索引
+    };
+    std::vector<uint32_t> slotConsumerOffsets;
+    std::vector<SlotConsumer> slotConsumers;
+    
+    // 格式协商：negotiatedFormats[i] 的字节 k 为Entity i 输出端口 k 的格式（未启用协商时为空）
+    std::vector<uint64_t> negotiatedFormats;
+    
+    // 编译时剔除的禁用Entity（单入单出，上游结果直通给消费者）
+    std::vector<EntityId> splicedEntities;
+    
+    // EntityId -> 索引（仅供外部按ID查询，不在调度热路径上使用）
+    std::unordered_map<EntityId, uint32_t> indexOf;
+    
+    size_t size() const { return entities.size(); }
+    size_t levelCount() const { return levelOffsets.empty() ? 0 : levelOffsets.size() - 1; }
+    size_t outputSlotCount() const { return outputOffsets.empty() ? 0 : outputOffsets.back(); }
+    
+    /**
+     * @brief 查找Entity索引
+     * @return 索引，不存在返回 kInvalidSlot
+     */
+    uint32_t findIndex(EntityId id) const {
+        auto it = indexOf.find(id);
+        return it == indexOf.end() ? kInvalidSlot : it->second;
+    }
+};
+
 /**
  * @brief 管线执行调度器
  * 
  * 负责根据拓扑顺序调度Entity执行，特点：
  * - 集成TaskQueue进行异步调度
- * - 按执行队列类型分配任务（GPU/CPU/IO）
- * - 支持层次并行（同层Entity并行执行）
+ * - 按执行队列类型分配任务（GPU/CPU/IO），CPU任务可改用工作窃取线程池
+ * - 数据流调度：Entity的上游全部完成即投递，无层级屏障；同时就绪时关键路径长的优先
  * - 使用Consumable管理依赖链
+ * - 帧流水线：最多maxConcurrentFrames帧同时在途，
+ *   第N+1帧可在第N帧仍处于GPU阶段时进入Input/CPU阶段
  * - 支持跳帧和背压控制
  * 
  * 线程安全：继承 enable_shared_from_this 以支持异步回调安全访问
@@ -114,7 +297,7 @@ public:
     // 资源池
     // ==========================================================================
     
-    void setContext(std::shared_ptr<PipelineContext> context) { mContext = context; }
+    void setContext(std::shared_ptr<PipelineContext> context);
 
     /**
      * @brief 获取管线上下文
@@ -145,18 +328,113 @@ public:
     bool processFrameAsync(FramePacketPtr input, 
                           std::function<void(FramePacketPtr)> callback);
     
+    /**
+     * @brief 批量处理多帧（离线/转码场景，吞吐优先）
+     * 
+     * 整批只调度一次：逐层执行，每个Entity在其队列上连续处理批内所有帧，
+     * GPU Entity在批内保持着色器/FBO绑定（见 ProcessEntity::beginBatch）。
+     * 源Entity（无上游）不执行，批内数据包按帧序直接作为其输出。
+     * 不触发逐帧完成回调，返回即整批完成；不参与跳帧。
+     * 中间结果在最后一个消费层结束后释放，批大小不宜超过帧包池容量。
+     * @param inputs 输入数据包（按帧序）
+     * @return 成功处理的帧数
+     */
+    size_t processFrames(const std::vector<FramePacketPtr>& inputs);
+    
+    /**
+     * @brief 在调用线程上内联执行一帧（拍照等带外执行）
+     * 
+     * 按执行计划顺序逐个执行，不经过任务队列，不需要 initialize()，
+     * 不触发回调、不计入统计。源Entity不执行，输入直接作为其首个输出；
+     * Output 类型的Entity也不执行（不上屏、不送编码器），其首个输入即为结果。
+     * 调用方负责线程（GPU Entity需在GL线程）以及与其他执行器的互斥。
+     * @param input 输入数据包
+     * @return 结果数据包；执行失败返回nullptr
+     */
+    FramePacketPtr processFrameInline(FramePacketPtr input);
+    
     /**
      * @brief 等待所有帧处理完成
+     * 
+     * 阻塞于条件变量，最后一帧完成时被唤醒（不轮询）。
      * @param timeoutMs 超时时间（毫秒），-1表示无限等待
      * @return 是否成功等待
      */
     bool flush(int64_t timeoutMs = -1);
     
+    /**
+     * @brief 异步等待所有帧处理完成
+     * 
+     * 已排空时立即在调用线程回调，否则在完成最后一帧的线程上回调。
+     * @param callback 完成回调，参数为是否已排空（false表示执行器关闭时仍有帧未完成）
+     */
+    void flushAsync(std::function<void(bool)> callback);
+    
     /**
      * @brief 取消所有待处理帧
      */
     void cancelAll();
     
+    /**
+     * @brief 在GPU队列上同步执行任务（GL资源须在GPU线程创建/释放）
+     * 
+     * 未初始化时在调用线程执行。不得在GPU队列线程上调用。
+     */
+    void runOnGPUQueue(const std::function<void()>& task);
+    
+    /**
+     * @brief 向GPU队列投递任务（不等待）
+     * 
+     * 未初始化时在调用线程执行。
+     */
+    void postToGPUQueue(std::function<void()> task);
+    
+    /**
+     * @brief 使用外部提供的GPU串行队列（需在 initialize 之前调用）
+     * 
+     * 同一渲染上下文上的多条管线共用一个GPU线程（见 ResourceHub）；
+     * 为空时执行器按 gpuQueueLabel 自建独占队列。
+     */
+    void setSharedGPUQueue(std::shared_ptr<task::TaskQueue> queue);
+    
+    /**
+     * @brief 设置传输上下文绑定（需在 initialize 之前调用）
+     */
+    void setTransferContextBinding(TransferContextBinding binding);
+    
+    /**
+     * @brief 是否启用了独立传输队列（绑定失败时退化为没有）
+     */
+    bool hasTransferQueue() const { return mTransferQueue != nullptr; }
+    
+    /**
+     * @brief 向传输队列投递任务（不等待）
+     * 
+     * 传输队列是独占线程的串行队列，共享上下文在其上常驻；上传/读回在这里与
+     * GPU队列上的渲染并行，两边经 GpuFence 同步。没有传输队列时投递到GPU队列。
+     */
+    void postToTransferQueue(std::function<void()> task);
+    
+    /**
+     * @brief 向IO队列投递任务（不等待，如文件封装写入）
+     * 
+     * 未初始化时在调用线程执行。
+     */
+    void postToIOQueue(std::function<void()> task);
+    
+    /**
+     * @brief 向CPU并行队列投递任务（不等待，如启动时的模型/LUT加载）
+     * 
+     * 未初始化时在调用线程执行。
+     */
+    void postToCPUQueue(std::function<void()> task);
+    
+    /**
+     * @brief 释放执行器持有的空闲内存（空闲帧内存区收缩至初始大小）
+     * @return 释放的字节数
+     */
+    size_t trimIdleMemory();
+    
     // ==========================================================================
     // 状态查询
     // ==========================================================================
@@ -166,16 +444,47 @@ public:
      */
     uint32_t getPendingFrameCount() const { return mPendingFrames.load(); }
     
+    /**
+     * @brief 获取当前在途帧数（异步任务链）
+     */
+    uint32_t getInFlightFrameCount() const;
+    
+    /**
+     * @brief 获取当前编译后的执行计划（只读快照，可能为空）
+     */
+    std::shared_ptr<const CompiledPlan> getCompiledPlan() const;
+    
     /**
      * @brief 获取执行统计
      */
     ExecutionStats getStats() const;
     
     /**
-     * @brief 重置统计数据
+     * @brief 重置统计数据（含性能剖析直方图）
      */
     void resetStats();
     
+    /**
+     * @brief 设置是否启用性能剖析
+     */
+    void setProfilingEnabled(bool enabled) { mProfilingEnabled.store(enabled); }
+    
+    /**
+     * @brief 是否启用性能剖析
+     */
+    bool isProfilingEnabled() const { return mProfilingEnabled.load(); }
+    
+    /**
+     * @brief 获取单个Entity的性能统计
+     * @return 未启用剖析或该Entity尚未执行时返回空
+     */
+    std::optional<EntityStats> getEntityStats(EntityId entityId) const;
+    
+    /**
+     * @brief 获取性能剖析快照（帧统计 + 所有Entity统计）
+     */
+    ProfilingSnapshot getProfilingSnapshot() const;
+    
     // ==========================================================================
     // 配置
     // ==========================================================================
@@ -195,13 +504,45 @@ public:
      */
     void setFrameSkippingEnabled(bool enabled);
     
+    /**
+     * @brief 设置代理渲染比例（运行中修改从下一帧生效）
+     * @param scale (0, 1]，1表示始终全分辨率
+     */
+    void setProxyRenderScale(float scale);
+    
+    /**
+     * @brief 获取代理渲染比例
+     */
+    float getProxyRenderScale() const { return mProxyRenderScale.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 申请接下来若干帧以全分辨率执行（拍照等按需全分辨率场景）
+     * 
+     * 与录制目标自动触发的全分辨率互不影响；未启用代理分辨率时无效果。
+     * @param frameCount 帧数
+     */
+    void requestFullResolution(uint32_t frameCount = 1);
+    
     /**
      * @brief 设置回调
      */
+    /**
+     * @brief 新计划切换前的预热（GPU队列调用，参数为编译所用的图快照）
+     * 
+     * 用于编译着色器、分配FBO与预热纹理池，新加入的Entity首帧不再卡顿。
+     */
+    using PlanPreparer = std::function<void(const PipelineGraph& snapshot)>;
+    void setPlanPreparer(PlanPreparer preparer);
+    
     void setFrameCompleteCallback(std::function<void(FramePacketPtr)> callback);
     void setFrameDroppedCallback(std::function<void(FramePacketPtr)> callback);
     void setErrorCallback(std::function<void(EntityId, const std::string&)> callback);
     
+    /**
+     * @brief 记录输入端丢弃的帧（进入Pipeline之前，没有对应的FramePacket，不触发丢帧回调）
+     */
+    void recordInputDrops(uint64_t count);
+    
     // ==========================================================================
     // 异步任务链接口
     // ==========================================================================
@@ -212,8 +553,11 @@ public:
      * 核心接口：将Entity的process任务投递到对应的TaskQueue。
      * 这是异步任务链的起点。
      * 
+     * contextData 为空时仅支持 InputEntity：开启一个新的在途帧（受
+     * maxConcurrentFrames 限制）。帧内其余Entity由依赖计数驱动自动投递。
+     * 
      * @param entityId Entity ID
-     * @param contextData 上下文数据（可选，用于传递帧信息）
+     * @param contextData 上下文数据（可选，用于传递帧执行状态）
      * @return 是否成功提交
      */
     bool submitEntityTask(EntityId entityId, 
@@ -222,8 +566,8 @@ public:
     /**
      * @brief 提交下游任务
      * 
-     * Entity完成后调用，自动查找并投递所有下游Entity的任务。
-     * 实现任务链式传播。
+     * @deprecated 下游投递已由帧内依赖计数自动完成（见
+     * FrameExecutionState），此接口仅保留兼容，调用无效果。
      * 
      * @param entityId 当前完成的Entity ID
      */
@@ -232,7 +576,7 @@ public:
     /**
      * @brief 检查Pipeline是否完成
      * 
-     * 检查是否所有Entity都已完成，用于判断是否应该重启循环。
+     * entityId 为 sink 且没有未结束的在途帧时返回 true。
      * 
      * @param entityId 当前完成的Entity ID
      * @return 是否整个Pipeline已完成
@@ -242,19 +586,20 @@ public:
     /**
      * @brief 重启Pipeline循环
      * 
-     * Pipeline完成后自动调用，重新投递InputEntity任务。
-     * 实现自动循环机制。
+     * 在途帧数未达上限且InputEntity空闲时，开启新帧并投递InputEntity任务。
+     * 帧完成或InputEntity完成时自动调用，实现自动循环机制。
      */
     void restartPipelineLoop();
     
     /**
      * @brief 设置InputEntity ID
      * 
-     * 用于重启循环时知道从哪个Entity开始。
+     * 用于重启循环时知道从哪个Entity开始。多路输入切换主时钟时调用，
+     * 已编译的计划随之作废（旁路与剪接都以主输入为准），在途帧结束后按新主输入重建。
      * 
      * @param entityId InputEntity的ID
      */
-    void setInputEntityId(EntityId entityId) { mInputEntityId = entityId; }
+    void setInputEntityId(EntityId entityId);
     
 private:
     // 配置
@@ -266,10 +611,26 @@ private:
     std::atomic<bool> mRunning{false};
     std::atomic<uint32_t> mPendingFrames{0};
     
+    // 排空通知（flush/flushAsync）
+    std::mutex mFlushMutex;
+    std::condition_variable mFlushCondition;
+    std::vector<std::function<void(bool)>> mFlushCallbacks;
+    
     // 任务队列
     std::shared_ptr<task::TaskQueue> mGPUQueue;
     std::shared_ptr<task::TaskQueue> mCPUQueue;
     std::shared_ptr<task::TaskQueue> mIOQueue;
+    std::shared_ptr<task::TaskQueue> mSharedGPUQueue;   // 外部提供的GPU队列（与其他管线共用）
+    
+    // 传输队列（enableTransferQueue 且共享上下文绑定成功时创建）
+    std::shared_ptr<task::TaskQueue> mTransferQueue;
+    TransferContextBinding mTransferBinding;
+    
+    // 工作窃取线程池（useWorkStealingCPUPool 时承接帧内 CPUParallel 任务）
+    std::unique_ptr<WorkStealingThreadPool> mCPUPool;
+    
+    // 帧内存区池（frameArenaSize > 0 时创建）
+    std::shared_ptr<FrameArenaPool> mFrameArenaPool;
     
     // 资源
     std::shared_ptr<PipelineContext> mContext;
@@ -279,39 +640,137 @@ private:
     // 统计
     mutable std::mutex mStatsMutex;
     ExecutionStats mStats;
+    std::atomic<uint64_t> mQueueTimeUs[3]{};      // GPU/CPU/IO 累计执行耗时（按 ExecutionQueue 取下标）
+    
+    // 代理分辨率
+    std::atomic<float> mProxyRenderScale{1.0f};
+    std::atomic<uint32_t> mFullResolutionRequests{0};
+    std::atomic<uint64_t> mProxyFrames{0};
+    
+    /**
+     * @brief 单个Entity的剖析数据（创建后地址不变，执行线程无锁写入）
+     */
+    struct EntityProfile {
+        EntityId entityId = InvalidEntityId;
+        std::string name;
+        ExecutionQueue queue = ExecutionQueue::GPU;
+        uint32_t order = 0;                         // 最近一次计划中的执行顺序
+        LatencyHistogram wallTime;
+        LatencyHistogram queueWait;
+        LatencyHistogram gpuTime;
+    };
+    
+    // 性能剖析
+    std::atomic<bool> mProfilingEnabled{false};
+    mutable std::mutex mProfileMutex;
+    std::unordered_map<EntityId, std::unique_ptr<EntityProfile>> mEntityProfiles;
+    LatencyHistogram mFrameTimeHistogram;
     
     // 回调
     std::function<void(FramePacketPtr)> mFrameCompleteCallback;
     std::function<void(FramePacketPtr)> mFrameDroppedCallback;
     std::function<void(EntityId, const std::string&)> mErrorCallback;
     
-    // 图版本（用于检测变化）
-    uint64_t mLastGraphVersion = 0;
-    std::vector<std::vector<EntityId>> mExecutionLevels;
-    
     // ==========================================================================
     // 异步任务链状态
     // ==========================================================================
     
+    /**
+     * @brief 延迟模型
+     * 
+     * 按执行计划索引记录各Entity执行耗时（EMA），以及输入就绪到帧完成的
+     * 实测延迟（EMA，包含排队），用于预测新帧能否在预算内完成。
+     * 同时按索引绑定各Entity的剖析数据，执行时无需查表。
+     */
+    struct LatencyModel {
+        explicit LatencyModel(const CompiledPlan& plan);
+        
+        uint64_t graphVersion = 0;
+        std::unique_ptr<std::atomic<uint64_t>[]> stageTimeUs;   // 各Entity执行耗时EMA
+        std::unique_ptr<std::atomic<uint64_t>[]> criticalRankUs; // 各Entity到出口的最长链耗时（调度优先级）
+        std::atomic<uint64_t> postInputLatencyUs{0};            // 输入就绪到帧完成耗时EMA（降级帧折算为完整执行）
+        std::atomic<uint32_t> consecutiveDrops{0};              // 连续因时限丢弃的帧数
+        std::vector<EntityProfile*> profiles;                   // 各Entity剖析数据（由执行器持有）
+    };
+    
     /**
      * @brief 帧执行状态
      * 
-     * 跟踪当前帧的执行状态，记录哪些Entity已完成。
+     * 跟踪一个在途帧的执行状态。每个Entity持有一个原子计数，
+     * 表示尚未满足的依赖数（上游Entity + 前一帧中的同一Entity），
+     * 计数归零即可投递，完成时只需递减后继计数，无需加锁。
+     * 
+     * 同一Entity按帧序执行：前一帧的Entity结束与新帧创建通过
+     * handoffFlags 交接，先到的一方置位，后到的一方负责递减计数。
      */
     struct FrameExecutionState {
-        std::set<EntityId> completedEntities;  // 已完成的Entity
-        std::mutex mutex;                       // 状态锁
-        uint64_t frameId = 0;                   // 帧ID
-        int64_t timestamp = 0;                  // 时间戳
+        std::shared_ptr<const CompiledPlan> plan;                // 创建时的执行计划
+        uint32_t inputIndex = UINT32_MAX;                        // InputEntity索引
+        std::unique_ptr<std::atomic<int32_t>[]> pendingCounts;   // 未满足依赖数
+        std::unique_ptr<std::atomic<uint8_t>[]> handoffFlags;    // 与下一帧的交接标记
+        std::atomic<uint32_t> remainingEntities{0};              // 未结束的Entity数
+        std::atomic<uint32_t> remainingGPUEntities{0};           // 未结束的GPU队列Entity数（归零时提交帧命令）
+        std::atomic<bool> aborted{false};                        // 是否已放弃（执行失败/等待中）
+        std::atomic<bool> inputSucceeded{false};                 // InputEntity是否产出数据
+        std::atomic<bool> degraded{false};                       // 是否降级执行（跳过可降级Entity）
+        std::unique_ptr<std::atomic<uint64_t>[]> sideBranchSkips; // 按索引的位图：旁路上游本帧已跳过，该Entity随之跳过
+        std::shared_ptr<LatencyModel> latency;                   // 延迟模型
+        uint64_t degradeSavingsUs = 0;                           // 降级预计节省的耗时（微秒）
+        std::unique_ptr<int64_t[]> readyTimes;                   // 各Entity就绪时间（启用剖析时分配，纳秒）
+        std::chrono::steady_clock::time_point inputReadyTime;    // InputEntity产出数据的时间
+        // 下一在途帧：创建者在交接前写入，交接方经 handoffFlags 同步后读取
+        std::shared_ptr<FrameExecutionState> nextFrame;
+        std::vector<FramePacketPtr> outputs;                     // 各Entity输出（按 outputOffsets 扁平存放）
+        std::unique_ptr<std::atomic<int32_t>[]> slotRefs;        // 各输出槽位未结束的消费者数
+        std::shared_ptr<FrameArena> arena;                       // 帧内存区（帧状态释放时回收）
+        uint64_t frameId = 0;                                    // 帧ID
+        int64_t timestamp = 0;                                   // 时间戳
+        float renderScale = 1.0f;                                // 渲染比例（帧开始时选定）
+        std::vector<uint64_t> outputDemand;                      // 各Entity本帧有消费者的输出端口（按需产出时帧开始计算，否则为空）
+        std::chrono::steady_clock::time_point startTime;         // 开始时间
     };
+    using FrameStatePtr = std::shared_ptr<FrameExecutionState>;
     
-    // 当前帧执行状态
-    std::shared_ptr<FrameExecutionState> mCurrentFrameState;
-    std::mutex mFrameStateMutex;
+    using ReadyList = std::vector<std::pair<FrameStatePtr, uint32_t>>;
+    
+    // 编译后的执行计划（随图版本重建，通过 std::atomic_load/atomic_store 整体替换）
+    std::shared_ptr<const CompiledPlan> mCompiledPlan;
+    
+    // 后台准备好的下一份计划，在途帧结束后的帧边界换入
+    std::shared_ptr<const CompiledPlan> mPreparedPlan;
+    std::atomic<bool> mPlanPreparing{false};
+    std::mutex mPlanPreparerMutex;
+    PlanPreparer mPlanPreparer;
+    
+    // 在途帧（按帧序，队首最早），仅在开启/移除帧时加锁
+    std::deque<FrameStatePtr> mInFlightFrames;
+    mutable std::mutex mFrameStateMutex;
+    uint64_t mNextFrameSeq = 0;          // 下一帧序号
+    std::shared_ptr<LatencyModel> mLatencyModel;  // 随计划重建（mFrameStateMutex 保护）
     
     // InputEntity ID（用于重启循环）
     EntityId mInputEntityId = InvalidEntityId;
     
+    /**
+     * @brief 调度通道（每个执行队列一个）
+     * 
+     * 任务先按通道入列，再向底层队列投递一个出队跳板；跳板执行时取出当前
+     * 优先级最高的任务，因此可在Entity边界抢占，不受底层队列FIFO顺序限制。
+     */
+    struct LaneScheduler {
+        std::mutex mutex;
+        std::deque<std::function<void()>> pending[kExecutionLaneCount];
+        uint32_t bypassed[kExecutionLaneCount] = {};   // 各通道被连续越过的次数
+    };
+    LaneScheduler mLaneSchedulers[3];    // 按 ExecutionQueue 索引
+    
+    // 栅栏等待线程（首个挂起在GPU栅栏上的Entity出现时启动）
+    std::mutex mFenceWaitMutex;
+    std::condition_variable mFenceWaitCondition;
+    std::deque<std::pair<GpuFencePtr, std::function<void()>>> mFenceWaits;
+    std::thread mFenceWaitThread;
+    bool mFenceWaitStopping = false;
+    
     // ==========================================================================
     // 内部方法
     // ==========================================================================
@@ -321,47 +780,310 @@ private:
      */
     bool createTaskQueues();
     
+    /**
+     * @brief 在GPU线程上配置命令录制与状态跟踪
+     */
+    void configureGpuCommands();
+    
+    /**
+     * @brief 执行绕过 GpuCommandContext 的GPU队列Entity前，提交已录制命令并使状态失效（所在队列线程调用）
+     */
+    static void prepareGpuCommands(const CompiledPlan& plan, uint32_t index);
+    
+    /**
+     * @brief 帧的GPU工作全部结束：在GPU队列上提交本帧命令缓冲（仅录制模式）
+     */
+    void commitFrameCommands();
+    
+    /**
+     * @brief 创建传输队列并在其线程上绑定共享上下文（失败时不创建）
+     */
+    void createTransferQueue();
+    
+    /**
+     * @brief 解除共享上下文绑定并释放传输队列
+     */
+    void destroyTransferQueue();
+    
+    /**
+     * @brief 选定新帧的渲染比例：有全分辨率申请或Entity需要时为1，否则为代理比例
+     */
+    float selectRenderScale(const CompiledPlan& plan);
+    
+    /**
+     * @brief 计算新帧各输出端口是否有消费者读取（逆拓扑序；禁用的Entity按端口直通，沿其输出继续追溯）
+     */
+    static void computeOutputDemand(const CompiledPlan& plan, FrameExecutionState& frame);
+    
+    /**
+     * @brief 协商各输出槽位的像素格式（逆拓扑序汇总消费者可接受的格式，编译计划时调用）
+     */
+    static void negotiateFormats(CompiledPlan& plan);
+    
+    /**
+     * @brief 执行前写入该Entity的协商结果（所在队列线程调用）
+     */
+    static void applyNegotiatedFormats(const CompiledPlan& plan, uint32_t index) {
+        if (!plan.negotiatedFormats.empty()) {
+            plan.entities[index]->setNegotiatedOutputFormats(plan.negotiatedFormats[index]);
+        }
+    }
+    
     /**
      * @brief 更新执行计划
      */
     void updateExecutionPlan();
     
+    /**
+     * @brief 获取当前计划，图版本变化时重新编译
+     */
+    std::shared_ptr<const CompiledPlan> acquireCompiledPlan();
+    
     /**
      * @brief 执行单个Entity
+     * @param arena 本帧内存区（可为nullptr）
      */
-    void executeEntity(EntityId entityId, FramePacketPtr frameContext);
+    void executeEntity(const CompiledPlan& plan, uint32_t index, FrameArena* arena);
     
     /**
-     * @brief 执行一个层级
+     * @brief 按依赖就绪并行执行一帧（同步路径，返回时所有Entity已结束）
+     * @param arena 本帧内存区（可为nullptr）
      */
-    void executeLevel(const std::vector<EntityId>& level, 
-                     FramePacketPtr frameContext,
-                     std::shared_ptr<task::TaskGroup> group);
+    void executeDataflow(const CompiledPlan& plan, FrameArena* arena);
     
     /**
      * @brief 获取Entity对应的任务队列
      */
-    std::shared_ptr<task::TaskQueue> getQueueForEntity(EntityId entityId) const;
+    std::shared_ptr<task::TaskQueue> getQueueForEntity(const ProcessEntity& entity) const;
     
     /**
      * @brief 执行单个Entity任务（内部方法）
      * 
-     * 在submitEntityTask中被调用，执行Entity的process逻辑。
+     * 在submitFrameTask投递的任务中被调用，执行Entity的process逻辑。
      * 
-     * @param entityId Entity ID
-     * @param contextData 上下文数据
+     * @param index Entity在执行计划中的索引
+     * @param frame 所属帧
+     */
+    void executeEntityTask(uint32_t index, const FrameStatePtr& frame);
+    
+    /**
+     * @brief Entity执行结束后的收尾：记录输出、延迟输入、开启下一帧并派发就绪的后继
+     * @param executed 是否实际执行（false表示已直通）
+     */
+    void completeEntityTask(uint32_t index, const FrameStatePtr& frame, bool success,
+                            bool executed, bool sideSkipped, ReadyList& ready);
+    
+    /**
+     * @brief Entity登记了等待：交给等待源，完成后在续体队列上恢复（不占用当前线程）
+     */
+    void suspendEntityTask(uint32_t index, const FrameStatePtr& frame, EntityAwaitPtr await);
+    
+    /**
+     * @brief 在续体队列上执行续体，完成后收尾或再次挂起
+     */
+    void resumeEntityTask(uint32_t index, const FrameStatePtr& frame, EntityAwait& await);
+    
+    /**
+     * @brief 投递到指定执行队列（CPUParallel优先进工作窃取线程池）
+     */
+    void postToExecutionQueue(ExecutionQueue queue, std::function<void()> task);
+    
+    /**
+     * @brief 栅栏signal后回调（在栅栏等待线程上执行，回调只应投递任务）
+     */
+    void enqueueFenceWait(GpuFencePtr fence, std::function<void()> onSignaled);
+    
+    void fenceWaitLoop();
+    
+    /**
+     * @brief 停止栅栏等待线程，未signal的等待直接丢弃
+     */
+    void stopFenceWaiter();
+    
+    /**
+     * @brief 投递帧内Entity任务到对应队列
+     * @return 是否成功投递
+     */
+    bool submitFrameTask(uint32_t index, const FrameStatePtr& frame);
+    
+    /**
+     * @brief 任务按通道入列
+     */
+    void enqueueLaneTask(ExecutionQueue queue, ExecutionLane lane, std::function<void()> task);
+    
+    /**
+     * @brief 取出优先级最高的任务（低优先级通道超过饥饿上限时优先取出）
+     * @return 任务，无任务时为空
+     */
+    std::function<void()> popLaneTask(ExecutionQueue queue);
+    
+    /**
+     * @brief 丢弃所有通道中未执行的任务（关闭时调用）
      */
-    void executeEntityTask(EntityId entityId, std::shared_ptr<void> contextData);
+    void clearLaneTasks();
     
     /**
-     * @brief 检查所有依赖是否就绪
+     * @brief 编译执行计划
+     */
+    std::shared_ptr<const CompiledPlan> compilePlan(const PipelineGraph& graph) const;
+    
+    /**
+     * @brief 发起后台计划准备（已在准备中则忽略）
+     */
+    void schedulePlanPreparation();
+    
+    /**
+     * @brief IO队列：复制图快照并编译，再交给GPU队列预热
+     */
+    void preparePlan();
+    
+    void publishPreparedPlan(std::shared_ptr<const CompiledPlan> plan);
+    
+    /**
+     * @brief 沿单一消费者边串接可融合的GPU Entity（compilePlan 末尾调用）
+     */
+    void compileShaderFusion(CompiledPlan& plan,
+                             const std::vector<std::vector<uint32_t>>& successorLists) const;
+    
+    /**
+     * @brief 尝试开启新帧（调用方需持有 mFrameStateMutex）
      * 
-     * 检查Entity的所有上游是否已完成。
+     * 图版本变化时，等待旧计划的在途帧全部结束后再以新计划开启。
      * 
-     * @param entityId Entity ID
-     * @return 是否所有依赖就绪
+     * @param ready 输出：新帧中可立即执行的Entity
+     * @return 是否开启了新帧
+     */
+    bool tryBeginFrameLocked(ReadyList& ready);
+    
+    /**
+     * @brief 收集Entity在该帧的输入（按输入端口顺序，写入复用的缓冲）
+     */
+    static void gatherFrameInputs(uint32_t index, const FrameExecutionState& frame,
+                                  std::vector<FramePacketPtr>& inputs);
+    
+    /**
+     * @brief Entity在该帧结束（执行或跳过）后递减其输入槽位的引用，最后一个消费者释放帧包
+     */
+    static void releaseFrameInputs(uint32_t index, FrameExecutionState& frame);
+    
+    /**
+     * @brief 延迟预算决策（InputEntity产出数据后调用）
+     * 
+     * 预测剩余延迟 = max(关键路径耗时, 实测输入后延迟)。超出预算时：
+     * 若跳过可降级Entity可满足预算则降级，否则丢弃本帧（经丢帧回调通知）。
+     * 
+     * @return 本帧是否继续执行
+     */
+    bool applyLatencyBudget(const FrameStatePtr& frame);
+    
+    /**
+     * @brief 为计划中的每个Entity绑定剖析数据（调用方需持有 mFrameStateMutex）
+     */
+    void bindEntityProfiles(const CompiledPlan& plan, LatencyModel& model);
+    
+    /**
+     * @brief 记录Entity一次执行的剖析数据
+     */
+    void recordEntityProfile(const FrameExecutionState& frame, uint32_t index,
+                             int64_t startNs, uint64_t wallUs);
+    
+    /**
+     * @brief 生成Entity统计
+     */
+    static EntityStats makeEntityStats(const EntityProfile& profile);
+    
+    /**
+     * @brief 按耗时EMA刷新各Entity的剩余关键路径（帧开始时调用，持有 mFrameStateMutex）
+     */
+    static void updateCriticalRanks(const CompiledPlan& plan, LatencyModel& model);
+    
+    /**
+     * @brief 计算从InputEntity之后的关键路径耗时（微秒）
+     * @param skipOptional 是否将可降级Entity耗时计为0
+     */
+    static uint64_t estimateCriticalPathUs(const CompiledPlan& plan, const LatencyModel& model,
+                                           uint32_t inputIndex, bool skipOptional);
+    
+    /**
+     * @brief 递减依赖计数，归零时加入就绪列表
+     */
+    static void releaseDependency(const FrameStatePtr& frame, uint32_t index, ReadyList& ready);
+    
+    /**
+     * @brief 提交下游任务（帧内）
+     * 
+     * 交接给下一帧并递减后继计数，O(出度)且无锁。
+     */
+    void submitDownstreamTasks(const FrameStatePtr& frame, uint32_t index, ReadyList& ready);
+    
+    /**
+     * @brief Entity在某帧结束（完成/失败/跳过）
+     */
+    void finishFrameEntity(const FrameStatePtr& frame, uint32_t index, bool success,
+                           ReadyList& ready);
+    
+    /**
+     * @brief 投递就绪列表（已放弃帧中的Entity直接跳过）
+     */
+    void dispatchReady(ReadyList& ready);
+    
+    /**
+     * @brief 帧结束处理（移除、统计、回调、开启新帧）
+     */
+    void onFrameFinished(const FrameStatePtr& frame, ReadyList& ready);
+    
+    /**
+     * @brief 丢弃所有在途帧（停止时调用）
+     */
+    void clearInFlightFrames();
+    
+    /**
+     * @brief 同步执行一帧（processFrame/processFrameAsync共用，不含计数）
+     */
+    bool runFrame(const FramePacketPtr& input);
+    
+    /**
+     * @brief 批量执行状态（输出按 帧 * 槽位数 + 槽位 平铺）
+     */
+    struct BatchState {
+        size_t frameCount = 0;
+        size_t slotCount = 0;
+        std::vector<FramePacketPtr> outputs;
+        std::unique_ptr<std::atomic<bool>[]> alive;   // 帧是否仍在传播
+        std::vector<uint8_t> live;                    // 当前层开始时的 alive 快照（层内只读）
+        std::shared_ptr<FrameArena> arena;            // 整批共用的帧内存区（批结束时回收）
+    };
+    
+    /**
+     * @brief 同步执行一批（不含计数）
+     * @return 成功处理的帧数
+     */
+    size_t runBatch(const std::vector<FramePacketPtr>& inputs);
+    
+    /**
+     * @brief 在当前队列上让一个Entity连续处理批内所有存活帧
+     */
+    void executeBatchEntity(const CompiledPlan& plan, uint32_t index, BatchState& batch);
+    
+    /**
+     * @brief 丢弃被背压跳过的帧（回调与统计）
+     */
+    void dropSkippedFrame(const FramePacketPtr& input);
+    
+    /**
+     * @brief 递减待处理帧数，归零时通知排空
+     */
+    void finishPendingFrame(uint32_t count = 1);
+    
+    /**
+     * @brief 唤醒 flush 等待方并执行 flushAsync 回调
+     */
+    void notifyDrained();
+    
+    /**
+     * @brief 以当前排空状态执行并清空所有 flushAsync 回调（关闭时调用）
      */
-    bool areAllDependenciesReady(EntityId entityId);
+    void cancelFlushCallbacks();
     
     /**
      * @brief 处理Entity执行完成
@@ -11,6 +11,7 @@
 #include <unordered_set>
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <string>
 
 namespace pipeline {
@@ -169,12 +170,16 @@ public:
     
     /**
      * @brief 检测是否存在环
+     * 
+     * connect 会拒绝成环的连接，因此正常构建的图总是返回false。
      * @return 如果存在环返回true
      */
     bool hasCycle() const;
     
     /**
      * @brief 获取拓扑排序结果
+     * 
+     * 拓扑序随增删边增量维护（Pearce–Kelly），这里只做一次去空位拷贝。
      * @return 按拓扑顺序排列的Entity ID列表
      */
     std::vector<EntityId> getTopologicalOrder() const;
@@ -250,6 +255,9 @@ public:
     
     /**
      * @brief 克隆图结构
+     * 
+     * 克隆图版本号与源图相同。端口连接存放在共享的Entity上，
+     * 克隆图只应作为只读快照使用，对其增删连接会同时改动源图的端口。
      * @return 克隆的图（Entity共享引用）
      */
     std::unique_ptr<PipelineGraph> clone() const;
@@ -276,7 +284,7 @@ public:
     uint64_t getVersion() const { return mVersion; }
     
     /**
-     * @brief 标记图已修改
+     * @brief 标记图已修改（拓扑未变但影响执行计划，如Entity启用状态）
      */
     void markDirty();
     
@@ -296,10 +304,18 @@ private:
     // 邻接表（入边）
     std::unordered_map<EntityId, std::vector<Connection>> mIncomingEdges;
     
-    // 版本控制
-    uint64_t mVersion = 0;
+    // 版本控制（执行器在工作线程中读取以检测图变化）
+    std::atomic<uint64_t> mVersion{0};
     
-    // 拓扑缓存
+    // 增量拓扑序：mOrder[i] 为第 i 位的Entity，删除的节点留空位（InvalidEntityId），空位过半时压实
+    std::vector<EntityId> mOrder;
+    std::unordered_map<EntityId, size_t> mOrderIndex;
+    size_t mOrderHoles = 0;
+    
+    // 执行层级（到源节点的最长路径），增删边时只沿受影响的下游更新
+    std::unordered_map<EntityId, uint32_t> mLevels;
+    
+    // 对外返回的拓扑序与分层（由上面两者生成）
     mutable bool mTopologyCacheValid = false;
     mutable std::vector<EntityId> mTopologicalOrderCache;
     mutable std::vector<std::vector<EntityId>> mExecutionLevelsCache;
@@ -309,21 +325,22 @@ private:
     // ==========================================================================
     
     /**
-     * @brief 执行拓扑排序（Kahn算法）
+     * @brief 为新边 src→dst 调整拓扑序（Pearce–Kelly）
+     * 
+     * 只搜索并重排位置落在 [dst, src] 区间内、与新边相通的节点。
+     * @return 新边会成环时返回false，拓扑序保持不变
      */
-    bool topologicalSort(std::vector<EntityId>& result) const;
+    bool reorderForEdgeLocked(EntityId srcId, EntityId dstId);
     
     /**
-     * @brief 计算执行层级
+     * @brief 从给定节点起按拓扑序重算下游层级，层级不变处停止传播
      */
-    void computeExecutionLevels() const;
+    void propagateLevelsLocked(const std::vector<EntityId>& seeds);
     
     /**
-     * @brief DFS检测环
+     * @brief 去掉拓扑序中的空位并重建位置索引
      */
-    bool hasCycleDFS(EntityId node, 
-                     std::unordered_set<EntityId>& visited,
-                     std::unordered_set<EntityId>& recursionStack) const;
+    void compactOrderLocked();
     
     /**
      * @brief 使缓存失效
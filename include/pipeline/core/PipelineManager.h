@@ -9,11 +9,17 @@
 #include "PipelineConfig.h"
 #include "PipelineGraph.h"
 #include "PipelineExecutor.h"
+#include "QualityController.h"
 #include "pipeline/output/OutputConfig.h"
+#include "pipeline/output/Mp4FragmentWriter.h"
+#include "pipeline/utils/MetricsRegistry.h"
+#include <cstdint>
 #include <memory>
 #include <functional>
 #include <map>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 // 前向声明
 namespace lrengine {
@@ -42,6 +48,8 @@ class OutputTarget;
 class OutputEntity;
 } // namespace output
 
+class ResourceLease;
+
 /**
  * @brief 管线状态
  */
@@ -54,6 +62,18 @@ enum class PipelineState : uint8_t {
     Error        // 错误状态
 };
 
+/**
+ * @brief 内存压力等级
+ * 
+ * Android 对应 onTrimMemory（RUNNING_LOW/BACKGROUND 为 Low，RUNNING_CRITICAL/MODERATE 为 Moderate，
+ * COMPLETE 为 Critical），iOS 内存警告对应 Critical。
+ */
+enum class MemoryPressureLevel : uint8_t {
+    Low,         // 释放超过空闲超时的资源
+    Moderate,    // 释放全部空闲资源（纹理、帧包、CPU缓冲、帧内存区）
+    Critical     // 同 Moderate，并降低CPU处理分辨率
+};
+
 /**
  * @brief 管线管理器
  * 
@@ -96,6 +116,11 @@ public:
      */
     bool initialize();
     
+    /**
+     * @brief 提供传输上下文绑定（PipelineConfig::enableTransferQueue 时使用，需在 initialize 之前调用）
+     */
+    void setTransferContextBinding(TransferContextBinding binding) { mTransferBinding = std::move(binding); }
+    
     /**
      * @brief 启动管线
      * @return 是否成功
@@ -180,6 +205,14 @@ public:
      */
     std::vector<ProcessEntityPtr> getAllEntities() const;
     
+    /**
+     * @brief 启用/禁用Entity
+     * 
+     * 禁用的单入单出Entity在下一份执行计划中被剔除（上游结果直通下游），
+     * 不再占用执行层级和输出纹理；新计划在帧边界换入，切换不丢帧。
+     */
+    bool setEntityEnabled(EntityId entityId, bool enabled);
+    
     // ==========================================================================
     // 连接管理
     // ==========================================================================
@@ -230,11 +263,49 @@ public:
     bool processFrameAsync(FramePacketPtr input,
                           std::function<void(FramePacketPtr)> callback);
     
+    /**
+     * @brief 批量处理多帧（同步，离线/转码场景）
+     * @param inputs 输入数据包（按帧序）
+     * @return 成功处理的帧数
+     */
+    size_t processFrames(const std::vector<FramePacketPtr>& inputs);
+    
     /**
      * @brief 等待所有帧处理完成
      */
     bool flush(int64_t timeoutMs = -1);
     
+    /**
+     * @brief 异步等待所有帧处理完成
+     * @param callback 完成回调，参数为是否已排空
+     */
+    void flushAsync(std::function<void(bool)> callback);
+    
+    /**
+     * @brief 申请接下来若干帧以全分辨率执行（启用 previewRenderScale 时用于拍照）
+     * @param frameCount 帧数
+     */
+    void requestFullResolution(uint32_t frameCount = 1);
+    
+    /**
+     * @brief 拍照结果回调（index 为帧在本次请求中的序号，result 为空表示该帧失败）
+     */
+    using CaptureCallback = std::function<void(size_t index, FramePacketPtr result)>;
+    
+    /**
+     * @brief 拍照/连拍：以全分辨率带外执行一组帧，不打断预览节奏
+     * 
+     * 按图快照（PipelineGraph::clone）编译的执行计划在GPU队列内联执行，
+     * 每帧等预览在途帧排空后才进入队列，连拍帧之间让出给预览。
+     * 纹理取自单独的纹理池，着色器与GPU共享资源沿用预览。
+     * 帧尺寸与输入配置不同时按比例放大各Entity的显式输出尺寸，无需改动Entity配置。
+     * 输出节点不执行，回调结果为送往输出节点的全分辨率数据包。
+     * @param frames 全分辨率输入数据包（纹理已就绪，按帧序）
+     * @param callback 逐帧结果回调（在IO队列调用）
+     * @return 是否已提交
+     */
+    bool capture(const std::vector<FramePacketPtr>& frames, CaptureCallback callback);
+    
     // ==========================================================================
     // 输入输出快捷接口
     // ==========================================================================
@@ -275,6 +346,45 @@ public:
      */
     EntityId setupInput(const input::InputConfig& config);
     
+    /**
+     * @brief 追加一路从属输入（多摄像头）
+     * 
+     * 新输入以从属时钟角色加入图中：只接收数据，不驱动出帧，
+     * 由主输入所在的帧按主时钟节奏采样其最新一帧。
+     * 各路需经 ClockSyncEntity 对齐后再接入 CompositeEntity。
+     * 
+     * @param config 输入配置（clockRole 被忽略）
+     * @param name Entity 名称
+     * @return 输入实体 ID，失败返回 InvalidEntityId
+     */
+    EntityId addInputSource(const input::InputConfig& config, const std::string& name);
+    
+    /**
+     * @brief 指定主时钟输入（可在运行中切换）
+     * 
+     * 原主输入降为从属，之后的帧由新主输入驱动。
+     * 
+     * @param entityId setupInput / addInputSource 返回的输入实体 ID
+     * @return 该 ID 不是本管线的输入时返回 false
+     */
+    bool setMasterInput(EntityId entityId);
+    
+    /**
+     * @brief 设置输入帧率上限
+     * 
+     * 作用于主输入与全部从属输入，超出上限的帧在 submitData 入口按时间戳抽掉，
+     * 不再占用转换、上传与帧包。之后加入且未自带上限（InputConfig::maxFrameRate）的输入同样生效。
+     * 
+     * @param fps 上限（<= 0 取消限制）
+     */
+    void setFrameRateLimit(float fps);
+    
+    /**
+     * @brief 设置主输入的裁剪区域（以ROI随帧传递，见 InputEntity::setCropRect）
+     * @return 尚未配置输入时返回false
+     */
+    bool setCropRect(const RoiRect& rect);
+    
 #if defined(__APPLE__)
     /**
      * @brief 设置 PixelBuffer 输入（iOS/macOS）
@@ -329,13 +439,16 @@ public:
     /**
      * @brief 设置回调输出
      * @param callback 帧回调函数
-     * @param dataFormat 数据格式
+     * @param dataFormat 数据格式（YUV420/NV12/NV21 在GPU上转换后读回）
+     * @param width 回调数据宽度（0 表示渲染尺寸，仅 YUV 格式生效）
+     * @param height 回调数据高度（0 表示渲染尺寸，仅 YUV 格式生效）
      * @return 目标 ID
      */
     int32_t setupCallbackOutput(
         std::function<void(const uint8_t*, size_t, uint32_t, uint32_t, 
                           output::OutputFormat, int64_t)> callback,
-        output::OutputFormat dataFormat);
+        output::OutputFormat dataFormat,
+        uint32_t width = 0, uint32_t height = 0);
     
     /**
      * @brief 设置编码器输出
@@ -345,6 +458,29 @@ public:
      */
     int32_t setupEncoderOutput(void* encoderSurface, output::EncoderType encoderType);
     
+    /**
+     * @brief 设置硬件编码输出（零拷贝渲染到编码器输入表面）
+     * @param encoderSurface Android: MediaCodec 输入 Surface 的 ANativeWindow*；
+     *                       iOS: AVAssetWriterInputPixelBufferAdaptor*
+     * @param config 编码配置（宽高必须有效，即编码器输入表面的尺寸）
+     * @param platformManager AndroidEGLContextManager* / IOSMetalContextManager*
+     * @return 输出目标 ID,失败返回 -1
+     */
+    int32_t setupEncoderOutput(void* encoderSurface, const output::EncoderConfig& config,
+                               void* platformManager = nullptr);
+    
+    /**
+     * @brief 设置文件输出（硬件编码 + 分片 MP4，封装写入在IO队列）
+     * @param filePath 输出文件路径（.mp4）
+     * @param config 编码配置（宽高必须有效）
+     * @param platformManager AndroidEGLContextManager* / IOSMetalContextManager*
+     * @param writerConfig 分片与写缓冲配置
+     * @return 输出目标 ID,失败返回 -1
+     */
+    int32_t setupFileOutput(const std::string& filePath, const output::EncoderConfig& config,
+                            void* platformManager = nullptr,
+                            const output::Mp4WriterConfig& writerConfig = output::Mp4WriterConfig());
+    
     /**
      * @brief 移除输出目标
      * @param targetId 目标 ID
@@ -409,6 +545,14 @@ public:
      */
     void setFrameCompleteCallback(std::function<void(FramePacketPtr)> callback);
     
+    /**
+     * @brief 设置首帧就绪回调（需在 start() 之前设置）
+     * 
+     * 每次 start() 后第一帧完成时调用一次（帧完成线程），参数为自 start() 起的耗时（微秒）。
+     * 分阶段启动时此刻只保证必需路径已就绪，可降级节点可能仍在加载，就绪后自行加入。
+     */
+    void setFirstFrameCallback(std::function<void(int64_t startupUs)> callback);
+    
     /**
      * @brief 设置帧丢弃回调
      */
@@ -438,6 +582,30 @@ public:
      */
     void resetStats();
     
+    /**
+     * @brief 获取单个Entity的性能统计（需启用 PipelineConfig::enableProfiling）
+     * @return 未启用剖析或该Entity尚未执行时返回空
+     */
+    std::optional<EntityStats> getEntityStats(EntityId entityId) const;
+    
+    /**
+     * @brief 获取性能剖析快照（帧耗时分布 + 各Entity耗时分布）
+     */
+    ProfilingSnapshot getProfilingSnapshot() const;
+    
+    /**
+     * @brief 指标注册表
+     *
+     * initialize() 后包含执行器帧统计与丢帧原因、输入/输出队列深度、帧包池与纹理池占用、
+     * 各输出目标的交付数与延迟分布；业务可在其上注册自己的计数器，或开启周期推送。
+     */
+    MetricsRegistry& getMetrics() { return mMetrics; }
+    
+    /**
+     * @brief 拉取当前全部指标（等价于 getMetrics().snapshot()）
+     */
+    MetricsSnapshot getMetricsSnapshot() const { return mMetrics.snapshot(); }
+    
     /**
      * @brief 导出图为DOT格式
      */
@@ -448,6 +616,62 @@ public:
      */
     std::string exportGraphToJson() const;
     
+    // ==========================================================================
+    // 内存管理
+    // ==========================================================================
+    
+    /**
+     * @brief 响应系统内存压力
+     * 
+     * 统一收缩纹理池、帧包池、CPU缓冲池与帧内存区；Critical 且开启
+     * PipelineConfig::degradeOnMemoryPressure 时把各 CPUEntity 的处理比例降至一半以下，
+     * 直到调用 recoverFromMemoryPressure()。纹理在GPU队列上释放。
+     * @return 回收的字节数
+     */
+    size_t onMemoryPressure(MemoryPressureLevel level);
+    
+    /**
+     * @brief 内存压力解除，恢复被降低的CPU处理比例
+     */
+    void recoverFromMemoryPressure();
+    
+    // ==========================================================================
+    // 自适应质量
+    // ==========================================================================
+    
+    /**
+     * @brief 应用一组质量参数
+     * 
+     * 渲染比例乘在 previewRenderScale 上交给执行器，其余参数经
+     * ProcessEntity::onQualityChanged 通知图中所有Entity（之后加入的Entity同样收到）。
+     */
+    void applyQualitySettings(const QualitySettings& settings);
+    
+    /**
+     * @brief 开启自适应质量
+     * 
+     * 帧完成时按 ExecutionStats 评估负载，并监听平台温控状态，
+     * 在 ceiling 与 Low 之间按滞回规则升降档。
+     * @param ceiling 最高档位（通常为初始化时选定的质量）
+     */
+    void enableAdaptiveQuality(QualityLevel ceiling,
+                               const QualityControllerConfig& config = QualityControllerConfig());
+    
+    /**
+     * @brief 关闭自适应质量（保持当前参数）
+     */
+    void disableAdaptiveQuality();
+    
+    /**
+     * @brief 转发温控状态（平台监听不可用时由应用层调用，如 Android API 30 以下）
+     */
+    void onThermalStateChanged(ThermalState state);
+    
+    /**
+     * @brief 当前质量控制器（未开启时为空）
+     */
+    QualityControllerPtr getQualityController() const;
+    
 private:
     /**
      * @brief 私有构造函数
@@ -467,9 +691,76 @@ private:
     
     /**
      * @brief 初始化GPU资源
+     * 
+     * 按拓扑序从输入尺寸推导各GPUEntity的输出规格，预热其着色器/FBO，
+     * 并按规格预分配纹理池。图未变化时重复调用直接返回。
      */
     bool initializeGPUResources();
     
+    /**
+     * @brief 注册管线内置指标的采集器（initialize 时调用，destroy 时移除）
+     */
+    void registerMetricCollectors();
+    
+    /**
+     * @brief 预热范围（分阶段启动时先预热必需路径，可降级节点在首帧后预热）
+     */
+    enum class WarmupScope : uint8_t {
+        All,
+        Required,
+        Optional
+    };
+    
+    /**
+     * @brief 按给定的图（实时图或编辑后的快照）预热各GPUEntity与纹理池
+     * @param scope 只为范围内的Entity编译着色器、统计纹理需求（尺寸仍按整图传播）
+     */
+    void warmupGraph(const PipelineGraph& graph, WarmupScope scope = WarmupScope::All);
+    
+    /**
+     * @brief 在调用线程依次加载各Entity的CPU侧资源
+     */
+    bool loadEntityResources();
+    
+    /**
+     * @brief 分阶段启动
+     * 
+     * 必需路径的着色器预热投递到GPU队列（排在首帧之前），各Entity的资源加载投递到CPU队列并行执行；
+     * 只等待必需Entity加载完成。可降级Entity在后台加载，就绪前由执行器旁路。
+     */
+    bool runStagedStartup();
+    
+    /**
+     * @brief 首帧完成：记录启动耗时、投递延后的预热并通知回调（每次 start() 只执行一次）
+     */
+    void reportFirstFrame();
+    
+    /**
+     * @brief 按显示目标数量切换呈现方式
+     * 
+     * 两个及以上显示时各屏改为按自己的 VSync 拉取共享的最新帧，只剩一个时恢复逐帧绘制。
+     */
+    void updateDisplayPresentation();
+    
+    /**
+     * @brief 向执行器安装帧完成回调（开启自适应质量时在用户回调前先评估负载）
+     */
+    void installFrameCompleteCallback();
+    
+    struct CaptureSession;
+    struct CaptureJob;
+    
+    /**
+     * @brief 取与当前图版本一致的拍照会话（图变化后重新克隆）
+     */
+    std::shared_ptr<CaptureSession> acquireCaptureSession();
+    
+    /**
+     * @brief 等预览排空后把下一帧拍照投递到GPU队列
+     */
+    static void scheduleCaptureFrame(std::weak_ptr<PipelineExecutor> preview,
+                                     std::shared_ptr<CaptureJob> job);
+    
 private:
     // 配置
     lrengine::render::LRRenderContext* mRenderContext;
@@ -486,6 +777,35 @@ private:
     // 资源池
     std::shared_ptr<TexturePool> mTexturePool;
     std::shared_ptr<FramePacketPool> mFramePacketPool;
+    std::shared_ptr<AsyncReadbackService> mReadbackService;  // 异步读回（未启用时为空）
+    TransferContextBinding mTransferBinding;                 // 传输队列的共享上下文绑定
+    std::shared_ptr<GpuResourceRegistry> mGpuResources;      // 各GPU节点共用的顶点缓冲/管线状态/采样器
+    std::shared_ptr<ResourceLease> mResourceLease;           // 进程级共享资源（shareResources 时）
+    uint64_t mWarmedGraphVersion = UINT64_MAX;    // 上次预热时的图版本
+    
+    // 启动：首帧回调与分阶段启动时延后到首帧之后的预热快照
+    std::mutex mStartupMutex;
+    std::function<void(int64_t)> mFirstFrameCallback;
+    std::shared_ptr<PipelineGraph> mDeferredWarmupGraph;
+    std::atomic<int64_t> mStartTimeUs{0};
+    std::atomic<bool> mFirstFrameReported{true};
+    
+    // 拍照会话（图快照 + 独立纹理池），在途任务持有时旧会话延后释放
+    std::mutex mCaptureMutex;
+    std::shared_ptr<CaptureSession> mCaptureSession;
+    
+    // 内存压力降级前的CPU处理比例（EntityId -> 原比例）
+    std::map<EntityId, float> mPressureScaleBackup;
+    
+    // 自适应质量：控制器在帧完成线程评估，参数在 mQualityMutex 下应用
+    mutable std::mutex mQualityMutex;
+    QualityControllerPtr mQualityController;
+    std::unique_ptr<ThermalMonitor> mThermalMonitor;
+    std::unique_ptr<QualitySettings> mQualitySettings;  // 已应用的参数（未应用过时为空）
+    
+    // 指标：内置采集器只读取各组件已有的统计，快照时才执行
+    MetricsRegistry mMetrics;
+    MetricsRegistry::CollectorId mMetricsCollectorId = MetricsRegistry::kInvalidCollectorId;
     
     // 特殊Entity引用
     EntityId mInputEntityId = InvalidEntityId;
@@ -503,6 +823,10 @@ private:
     // 输入实体管理
     std::shared_ptr<input::InputEntity> mInputEntity;
     
+    // 从属输入（多路输入时；主时钟输入始终是 mInputEntity）
+    std::vector<std::shared_ptr<input::InputEntity>> mInputSources;
+    float mFrameRateLimit = 0.0f;
+    
     // 平台特定输入策略
 #if defined(__APPLE__)
     std::shared_ptr<input::ios::PixelBufferInputStrategy> mPixelBufferStrategy;
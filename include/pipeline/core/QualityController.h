@@ -0,0 +1,170 @@
+/**
+ * @file QualityController.h
+ * @brief 自适应质量控制 - 按设备温控状态与帧耗时趋势在运行中升降质量档位
+ *
+ * QualityLevel 原本只在初始化时选定；长时间录制时手机发热降频，固定档位会持续丢帧。
+ * QualityController 定期读取 ExecutionStats（帧耗时滑动平均、窗口内丢帧率）并结合
+ * 平台温控信号（Android PowerManager 热状态 / iOS NSProcessInfo.thermalState），
+ * 在初始档位与最低档位之间逐级调整：降档快、升档慢，且每次变化后保持最短停留时间，
+ * 避免在临界负载附近来回切换。
+ */
+
+#pragma once
+
+#include "pipeline/core/PipelineExecutor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace pipeline {
+
+enum class QualityLevel : uint8_t;
+
+// =============================================================================
+// 温控状态
+// =============================================================================
+
+/**
+ * @brief 设备温控状态（与 NSProcessInfoThermalState 同级划分）
+ */
+enum class ThermalState : uint8_t {
+    Nominal,    ///< 正常
+    Fair,       ///< 轻微发热（Android LIGHT / MODERATE）
+    Serious,    ///< 已明显降频（Android SEVERE），上限压到 Medium
+    Critical    ///< 即将强制降频或关机（Android CRITICAL 及以上），上限压到 Low
+};
+
+/**
+ * @brief 平台温控信号来源
+ */
+class ThermalMonitor {
+public:
+    using ThermalCallback = std::function<void(ThermalState state)>;
+
+    virtual ~ThermalMonitor() = default;
+
+    /**
+     * @brief 开始监听；启动时先回调一次当前状态（回调线程由平台决定）
+     */
+    virtual bool start(ThermalCallback callback) = 0;
+
+    /**
+     * @brief 停止；返回后不再触发回调
+     */
+    virtual void stop() = 0;
+};
+
+/**
+ * @brief 创建平台温控监听（不支持的平台或系统版本返回 nullptr）
+ */
+std::unique_ptr<ThermalMonitor> createPlatformThermalMonitor();
+
+// =============================================================================
+// 质量参数
+// =============================================================================
+
+/**
+ * @brief 某一质量档位下各节点应采用的参数
+ *
+ * 执行器据 renderScale 调整渲染分辨率；其余字段经 ProcessEntity::onQualityChanged
+ * 交给各节点自行解释（模糊半径、检测间隔、LUT 精度等）。
+ */
+struct QualitySettings {
+    uint8_t level = 2;                  ///< 对应的 QualityLevel 取值
+    float renderScale = 1.0f;           ///< 渲染分辨率比例（乘在 previewRenderScale 上）
+    float blurRadiusScale = 1.0f;       ///< 模糊类滤镜的半径比例
+    uint32_t detectionInterval = 1;     ///< 检测类节点每 N 帧推理一次
+    bool highPrecisionLut = true;       ///< 颜色查找表使用高精度（false 时可用 16^3 等小表）
+};
+
+/**
+ * @brief 自适应质量配置
+ */
+struct QualityControllerConfig {
+    int64_t frameBudgetUs = 33333;          ///< 单帧预算（默认 30fps）
+    int64_t evaluationIntervalUs = 1000000; ///< 评估窗口长度
+    float downgradeLoad = 0.9f;             ///< 平均帧耗时 / 预算 超过该值视为过载
+    float upgradeLoad = 0.6f;               ///< 低于该值视为有余量
+    float downgradeDropRatio = 0.05f;       ///< 窗口内丢帧率超过该值视为过载
+    uint32_t downgradeWindows = 2;          ///< 连续过载窗口数达到后降一档
+    uint32_t upgradeWindows = 5;            ///< 连续有余量窗口数达到后升一档
+    int64_t minDwellUs = 3000000;           ///< 两次调整之间的最短间隔
+};
+
+// =============================================================================
+// QualityController
+// =============================================================================
+
+/**
+ * @brief 自适应质量控制器
+ *
+ * onThermalState 可在任意线程调用；evaluate 由管线在帧完成时调用
+ * （未到评估窗口时立即返回），档位变化需要重新应用参数时返回 true。
+ */
+class QualityController {
+public:
+    /**
+     * @param ceiling 最高档位（即初始化时选定的 QualityLevel）
+     */
+    explicit QualityController(QualityLevel ceiling,
+                               const QualityControllerConfig& config = QualityControllerConfig());
+
+    /**
+     * @brief 各档位的默认参数
+     */
+    static QualitySettings settingsFor(QualityLevel level);
+
+    void setCeiling(QualityLevel ceiling);
+
+    /**
+     * @brief 记录温控状态（升温立即生效，降温后仍按升档规则逐级恢复）
+     */
+    void onThermalState(ThermalState state);
+
+    ThermalState getThermalState() const { return mThermalState.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 评估一次
+     * @param stats 执行器统计
+     * @param nowUs 当前时间（单调时钟，微秒）
+     * @return 档位是否变化（需重新应用参数）
+     */
+    bool evaluate(const ExecutionStats& stats, int64_t nowUs);
+
+    QualityLevel getLevel() const;
+
+    QualitySettings getSettings() const { return settingsFor(getLevel()); }
+
+    /**
+     * @brief 单调时钟（微秒）
+     */
+    static int64_t nowUs();
+
+private:
+    // 温控状态允许的最高档位
+    uint8_t thermalCapLocked() const;
+
+    QualityControllerConfig mConfig;
+    std::atomic<ThermalState> mThermalState{ThermalState::Nominal};
+    std::atomic<bool> mPendingApply{false};     // setCeiling 降档后待应用
+
+    mutable std::mutex mMutex;
+    uint8_t mCeiling;
+    std::atomic<uint8_t> mLevel;
+
+    // 评估窗口
+    bool mWindowStarted = false;
+    int64_t mWindowStartUs = 0;
+    int64_t mLastChangeUs = 0;
+    uint64_t mWindowTotalFrames = 0;
+    uint64_t mWindowDroppedFrames = 0;
+    uint32_t mOverloadedWindows = 0;
+    uint32_t mHeadroomWindows = 0;
+};
+
+using QualityControllerPtr = std::shared_ptr<QualityController>;
+
+} // namespace pipeline
@@ -0,0 +1,129 @@
+/**
+ * @file WorkStealingThreadPool.h
+ * @brief 工作窃取线程池 - CPUParallel Entity 的执行后端
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <string>
+
+namespace pipeline {
+
+/**
+ * @brief 工作窃取线程池配置
+ */
+struct WorkStealingPoolConfig {
+    std::string label = "Pipeline.CPU";  // 线程名前缀
+    uint32_t threadCount = 0;            // 工作线程数（0表示自动）
+    bool pinToBigCores = false;          // 是否绑定到大核（ARM big.LITTLE，仅Linux/Android生效）
+};
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程持有一个本地双端队列：
+ * - 工作线程内提交的任务压入本地队尾，本线程从队尾取（LIFO，缓存友好）
+ * - 外部线程提交的任务轮询分配到各工作线程队尾
+ * - 本地队列为空时从其他线程队首窃取（FIFO，减少与所有者的竞争）
+ *
+ * 与 TaskQueue 并发队列相比，后继任务倾向于在产生它的线程上执行，
+ * 适合 FaceDetection 等重 CPU Entity。
+ *
+ * 线程安全：submit 可在任意线程调用；stop 可在工作线程内调用
+ * （此时该线程被分离而非 join）。
+ */
+class WorkStealingThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingThreadPool(const WorkStealingPoolConfig& config = WorkStealingPoolConfig());
+
+    ~WorkStealingThreadPool();
+
+    // 禁止拷贝
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    // ==========================================================================
+    // 生命周期
+    // ==========================================================================
+
+    /**
+     * @brief 启动工作线程
+     * @return 是否成功
+     */
+    bool start();
+
+    /**
+     * @brief 停止工作线程（未执行的任务被丢弃）
+     */
+    void stop();
+
+    /**
+     * @brief 是否正在运行
+     */
+    bool isRunning() const;
+
+    // ==========================================================================
+    // 任务提交
+    // ==========================================================================
+
+    /**
+     * @brief 提交任务
+     * @return 是否成功（未运行时返回false）
+     */
+    bool submit(Task task);
+
+    /**
+     * @brief 并行执行 body(0..count-1)，返回时全部执行完毕
+     *
+     * 调用线程同样领取并执行分片，因此可在工作线程内调用而不会死锁；
+     * 空闲的工作线程以窃取方式参与。未运行时在调用线程串行执行。
+     */
+    void parallelFor(uint32_t count, const std::function<void(uint32_t)>& body);
+    
+    /**
+     * @brief 当前线程是否为本池的工作线程
+     */
+    bool isWorkerThread() const;
+
+    // ==========================================================================
+    // 状态查询
+    // ==========================================================================
+
+    /**
+     * @brief 获取工作线程数
+     */
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(mThreads.size()); }
+
+    /**
+     * @brief 获取累计窃取次数
+     */
+    uint64_t getStealCount() const;
+
+    /**
+     * @brief 获取大核CPU编号（按最高频率识别，无法识别或所有核心相同时为空）
+     */
+    static std::vector<int> detectBigCores();
+
+private:
+    struct State;
+
+    WorkStealingPoolConfig mConfig;
+    std::shared_ptr<State> mState;   // 工作线程共享，线程被分离时仍保持有效
+    std::vector<std::thread> mThreads;
+    std::mutex mLifecycleMutex;
+
+    static void workerLoop(std::shared_ptr<State> state, uint32_t index,
+                           std::vector<int> affinity, std::string name);
+};
+
+} // namespace pipeline
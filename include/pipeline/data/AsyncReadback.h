@@ -0,0 +1,258 @@
+/**
+ * @file AsyncReadback.h
+ * @brief 异步GPU读回 - 纹理到CPU缓冲的环形暂存读回
+ *
+ * GPU线程在渲染完成后发起读回（GLES：PBO + 同步对象；Metal：blit 到共享 MTLBuffer），
+ * 立即返回；CPU消费者在 FramePacket::getCpuBuffer() 时才等待结果。
+ * 读回与后续帧的GPU工作重叠，GPU队列不因 glReadPixels 同步等待而停顿。
+ */
+
+#pragma once
+
+#include "pipeline/data/EntityTypes.h"
+#include "pipeline/data/GpuFence.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 前向声明
+namespace lrengine {
+namespace render {
+class LRTexture;
+} // namespace render
+} // namespace lrengine
+
+namespace pipeline {
+
+/**
+ * @brief 读回后端（平台相关，除完成回调外均在GPU线程调用）
+ *
+ * 后端管理固定数量的暂存槽位（PBO / MTLBuffer），每个槽位同时只承载一次读回。
+ */
+class ReadbackBackend {
+public:
+    virtual ~ReadbackBackend() = default;
+
+    /**
+     * @brief 发起读回（不等待GPU完成）
+     * @return 是否成功
+     */
+    virtual bool begin(uint32_t slot, lrengine::render::LRTexture& texture,
+                       uint32_t width, uint32_t height, uint32_t stride, size_t bytes) = 0;
+
+    /**
+     * @brief 槽位的GPU拷贝是否已完成（不阻塞）
+     */
+    virtual bool isComplete(uint32_t slot) = 0;
+
+    /**
+     * @brief 阻塞等待槽位的GPU拷贝完成
+     */
+    virtual void waitComplete(uint32_t slot) = 0;
+
+    /**
+     * @brief 将已完成槽位的数据复制到 dst（之后槽位可复用）
+     */
+    virtual bool read(uint32_t slot, uint8_t* dst, size_t bytes) = 0;
+
+    /**
+     * @brief 释放全部暂存资源
+     */
+    virtual void release() = 0;
+
+    /**
+     * @brief 后端是否会在GPU完成时主动回调（Metal completion handler）
+     *
+     * 返回true时服务在回调中完成复制，无需 poll。
+     */
+    virtual bool supportsCompletionCallback() const { return false; }
+
+    /**
+     * @brief 设置完成回调（可能在任意线程调用）
+     */
+    void setCompletionCallback(std::function<void(uint32_t slot)> callback) {
+        mCompletionCallback = std::move(callback);
+    }
+
+protected:
+    std::function<void(uint32_t slot)> mCompletionCallback;
+};
+
+/**
+ * @brief 一次读回的结果
+ */
+class ReadbackRequest {
+public:
+    /**
+     * @brief 数据是否已就绪（或已失败）
+     */
+    bool isReady() const { return mState.load(std::memory_order_acquire) != State::Pending; }
+
+    /**
+     * @brief 等待数据就绪
+     *
+     * 尚未完成时请求GPU线程立即收取结果（不等待下一次 poll）。
+     * @param timeoutMs 超时（毫秒，0表示一直等待）
+     * @return 成功取得数据返回true
+     */
+    bool wait(uint32_t timeoutMs = 0);
+
+    /**
+     * @brief 就绪（或失败）时回调一次，不阻塞
+     *
+     * 已就绪时在调用线程立即回调；否则在完成读回的线程上回调，并请求GPU线程尽快收取。
+     * 只保留最后一次设置的回调。
+     */
+    void whenReady(std::function<void()> callback);
+
+    /**
+     * @brief 获取结果缓冲（就绪前为空）
+     */
+    std::shared_ptr<uint8_t> getBuffer() const;
+
+    size_t getSize() const { return mSize; }
+    uint32_t getStride() const { return mStride; }
+
+private:
+    friend class AsyncReadbackService;
+
+    enum class State : uint8_t { Pending, Ready, Failed };
+
+    void complete(std::shared_ptr<uint8_t> buffer);
+    void fail();
+    void notifyReady();
+
+    std::atomic<State> mState{State::Pending};
+    mutable std::mutex mMutex;
+    std::condition_variable mCond;
+    std::shared_ptr<uint8_t> mBuffer;
+    size_t mSize = 0;
+    uint32_t mStride = 0;
+    std::function<void()> mFlush;     // 请求GPU线程收取结果
+    std::function<void()> mReadyCallback;
+};
+
+using ReadbackRequestPtr = std::shared_ptr<ReadbackRequest>;
+
+/**
+ * @brief 异步读回服务
+ *
+ * 环形暂存槽位：第N帧的拷贝仍在进行时GPU可继续执行第N+1帧；
+ * 槽位用尽时 enqueue 等待最早的一次完成（消费者落后超过环长时才会发生）。
+ * enqueue/poll 必须在GPU线程调用。
+ */
+class AsyncReadbackService : public std::enable_shared_from_this<AsyncReadbackService> {
+public:
+    /**
+     * @param backend 平台读回后端
+     * @param ringSize 暂存槽位数（2~3 即可覆盖一帧的GPU延迟）
+     */
+    explicit AsyncReadbackService(std::unique_ptr<ReadbackBackend> backend, uint32_t ringSize = 3);
+
+    ~AsyncReadbackService();
+
+    // 禁止拷贝
+    AsyncReadbackService(const AsyncReadbackService&) = delete;
+    AsyncReadbackService& operator=(const AsyncReadbackService&) = delete;
+
+    /**
+     * @brief 创建当前平台的读回后端（不支持时返回nullptr）
+     * @param slotCount 暂存槽位数
+     */
+    static std::unique_ptr<ReadbackBackend> createPlatformBackend(uint32_t slotCount);
+
+    /**
+     * @brief 发起纹理读回（GPU线程）
+     * @return 读回句柄，失败返回nullptr
+     */
+    ReadbackRequestPtr enqueue(lrengine::render::LRTexture& texture,
+                               uint32_t width, uint32_t height, PixelFormat format);
+
+    /**
+     * @brief 在投递器所在线程（传输队列）上发起读回
+     *
+     * 立即返回句柄；投递的任务先让传输上下文在GPU上等待 fence，再发起拷贝，
+     * 渲染线程不执行任何读回命令。纹理在拷贝完成前一直被持有，不会回到纹理池被覆盖。
+     * 未设置投递器时等同 enqueue（在调用线程发起）。
+     * 使用该接口后 enqueue/poll/flush 都只应在传输线程调用。
+     * @param texture 源纹理
+     * @param fence 渲染完成栅栏（可为空）
+     * @return 读回句柄，参数无效时返回nullptr
+     */
+    ReadbackRequestPtr enqueueAfter(std::shared_ptr<lrengine::render::LRTexture> texture,
+                                    GpuFencePtr fence,
+                                    uint32_t width, uint32_t height, PixelFormat format);
+
+    /**
+     * @brief 收取已完成的读回（GPU线程，不阻塞）
+     */
+    void poll();
+
+    /**
+     * @brief 收取全部在途读回（GPU线程，阻塞直到完成）
+     */
+    void flush();
+
+    /**
+     * @brief 设置投递器：ReadbackRequest::wait 经它把 flush 投递到GPU线程
+     */
+    void setGPUTaskPoster(std::function<void(std::function<void()>)> poster);
+
+    /**
+     * @brief 释放后端资源，未完成的读回标记为失败（GPU线程）
+     */
+    void shutdown();
+
+    /**
+     * @brief 获取在途读回数量
+     */
+    size_t getPendingCount() const;
+
+private:
+    struct Slot {
+        ReadbackRequestPtr request;
+        std::shared_ptr<lrengine::render::LRTexture> source;    // enqueueAfter 的源纹理（拷贝完成前持有）
+        uint64_t sequence = 0;
+        bool busy = false;
+    };
+
+    // 创建待完成的句柄
+    ReadbackRequestPtr createRequest(size_t bytes, uint32_t stride);
+
+    // 选定槽位并发起拷贝（调用方不持有 mMutex）
+    bool beginRequest(const ReadbackRequestPtr& request, lrengine::render::LRTexture& texture,
+                      std::shared_ptr<lrengine::render::LRTexture> keepAlive,
+                      uint32_t width, uint32_t height);
+
+    // 复制槽位结果并通知等待方（调用方持有 mMutex）
+    void finishSlotLocked(uint32_t slot);
+
+    // 等待指定槽位完成并收取（等待期间不持有 mMutex，完成回调可能需要它）
+    void waitSlot(std::unique_lock<std::mutex>& lock, uint32_t slot);
+
+    // 供 ReadbackRequest::wait 调用：在GPU线程上收取全部在途读回
+    void requestFlush();
+
+    std::unique_ptr<ReadbackBackend> mBackend;
+    mutable std::mutex mMutex;
+    std::vector<Slot> mSlots;
+    uint64_t mNextSequence = 0;
+    bool mCallbackInstalled = false;
+    std::function<void(std::function<void()>)> mPoster;
+    std::vector<ReadbackRequestPtr> mDeferred;          // 已投递、尚未发起的 enqueueAfter 请求
+    std::atomic<bool> mFlushPosted{false};
+    std::atomic<std::thread::id> mGPUThread{};          // 最近一次 enqueue 的线程（即GPU线程）
+};
+
+/**
+ * @brief 平台后端（仅在对应平台编译）
+ */
+std::unique_ptr<ReadbackBackend> createGLESReadbackBackend(uint32_t slotCount);
+std::unique_ptr<ReadbackBackend> createMetalReadbackBackend(uint32_t slotCount);
+
+} // namespace pipeline
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -62,9 +65,36 @@ enum class PixelFormat : uint8_t {
     RGBA32F,     // 32位浮点RGBA
     R8,          // 单通道8位
     RG8,         // 双通道8位
-    OES          // 外部纹理（Android OES）
+    OES,         // 外部纹理（Android OES）
+    RGB10A2      // 10位RGB + 2位Alpha（与RGBA8同带宽，LUT/调色等需要更高精度时使用）
 };
 
+/**
+ * @brief 像素格式集合（位 k 对应 PixelFormat 的第 k 个取值），用于格式协商
+ */
+using PixelFormatSet = uint32_t;
+
+constexpr PixelFormatSet pixelFormatBit(PixelFormat format) {
+    return PixelFormatSet(1) << static_cast<uint32_t>(format);
+}
+
+constexpr PixelFormatSet kAnyPixelFormat = ~PixelFormatSet(0);
+
+/// 可作为普通纹理采样的RGB类格式
+constexpr PixelFormatSet kRGBPixelFormats =
+    pixelFormatBit(PixelFormat::RGBA8) | pixelFormatBit(PixelFormat::BGRA8) |
+    pixelFormatBit(PixelFormat::RGBA16F) | pixelFormatBit(PixelFormat::RGBA32F) |
+    pixelFormatBit(PixelFormat::RGB10A2);
+
+/// 多平面YUV格式（以 LRPlanarTexture 承载）
+constexpr PixelFormatSet kYUVPixelFormats =
+    pixelFormatBit(PixelFormat::YUV420) | pixelFormatBit(PixelFormat::NV12) |
+    pixelFormatBit(PixelFormat::NV21);
+
+constexpr bool containsPixelFormat(PixelFormatSet set, PixelFormat format) {
+    return (set & pixelFormatBit(format)) != 0;
+}
+
 /**
  * @brief 执行队列类型
  */
@@ -74,6 +104,18 @@ enum class ExecutionQueue : uint8_t {
     IO           // IO队列
 };
 
+/**
+ * @brief 调度通道（同一执行队列内的优先级，值越小越优先）
+ */
+enum class ExecutionLane : uint8_t {
+    Realtime,    // 实时通道（预览显示）
+    Normal,      // 普通通道
+    Throughput,  // 吞吐通道（编码/回调输出），可让位于实时通道
+    Inherit      // 继承下游分支中最高的通道，无下游时为Normal（默认）
+};
+
+constexpr size_t kExecutionLaneCount = 3;  // 不含Inherit
+
 // =============================================================================
 // 连接信息
 // =============================================================================
@@ -88,6 +130,60 @@ struct Connection {
     std::string dstPort;
 };
 
+// =============================================================================
+// 感兴趣区域
+// =============================================================================
+
+/**
+ * @brief 感兴趣区域（归一化到所在帧包的图像尺寸，方向与纹理坐标/缓冲行序一致）
+ *
+ * 默认覆盖整幅图像；与分辨率无关，经代理缩放或CPU降采样后仍表示同一块画面。
+ */
+struct RoiRect {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+
+    bool isFull() const { return x <= 0.0f && y <= 0.0f && x + width >= 1.0f && y + height >= 1.0f; }
+    bool isEmpty() const { return width <= 0.0f || height <= 0.0f; }
+
+    /**
+     * @brief 两个区域的外接矩形（多个人脸框合并为一个ROI）
+     */
+    RoiRect united(const RoiRect& other) const {
+        float x0 = std::min(x, other.x);
+        float y0 = std::min(y, other.y);
+        float x1 = std::max(x + width, other.x + other.width);
+        float y1 = std::max(y + height, other.y + other.height);
+        return {x0, y0, x1 - x0, y1 - y0};
+    }
+
+    /**
+     * @brief 四周外扩（归一化），为卷积核等邻域采样留出余量
+     */
+    RoiRect expanded(float margin) const {
+        return {x - margin, y - margin, width + 2.0f * margin, height + 2.0f * margin};
+    }
+
+    /**
+     * @brief 换算为像素范围 [x0, x1) x [y0, y1)，向外取整并裁剪到图像内
+     * @return 区域与图像无交集时返回false
+     */
+    bool toPixels(uint32_t imageWidth, uint32_t imageHeight,
+                  uint32_t& x0, uint32_t& y0, uint32_t& x1, uint32_t& y1) const {
+        auto toPixel = [](float v, uint32_t extent, bool roundUp) {
+            float scaled = std::min(std::max(v, 0.0f), 1.0f) * static_cast<float>(extent);
+            return static_cast<uint32_t>(roundUp ? std::ceil(scaled) : std::floor(scaled));
+        };
+        x0 = toPixel(x, imageWidth, false);
+        y0 = toPixel(y, imageHeight, false);
+        x1 = toPixel(x + width, imageWidth, true);
+        y1 = toPixel(y + height, imageHeight, true);
+        return x1 > x0 && y1 > y0;
+    }
+};
+
 // =============================================================================
 // 前向声明
 // =============================================================================
@@ -152,6 +248,7 @@ inline size_t getPixelFormatBytesPerPixel(PixelFormat format) {
     switch (format) {
         case PixelFormat::RGBA8:
         case PixelFormat::BGRA8:
+        case PixelFormat::RGB10A2:
             return 4;
         case PixelFormat::RGB8:
             return 3;
@@ -0,0 +1,97 @@
+/**
+ * @file ExternalImage.h
+ * @brief 外部图像 - 零拷贝导入的平台原生纹理（按平面）
+ *
+ * 相机帧（CVPixelBuffer / AHardwareBuffer / SurfaceTexture）直接映射为GPU可采样的纹理，
+ * 不经CPU上传、也不先转换为RGBA。下游GPUEntity按平面采样，
+ * 在自己的着色器里完成YUV->RGB（见 getYUVToRGBMatrix）。
+ */
+
+#pragma once
+
+#include "EntityTypes.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace pipeline {
+
+/**
+ * @brief 外部图像格式
+ */
+enum class ExternalImageFormat : uint8_t {
+    BGRA,           ///< 单平面 BGRA8
+    NV12,           ///< 平面0: Y (R8)，平面1: 交织 CbCr (RG8)
+    External        ///< 单个 samplerExternalOES 纹理（驱动负责YUV转换）
+};
+
+/**
+ * @brief YUV 色彩标准
+ */
+enum class YUVColorSpace : uint8_t {
+    BT601,
+    BT709,
+    BT2020
+};
+
+/**
+ * @brief 外部图像的单个平面
+ */
+struct ExternalImagePlane {
+    void* handle = nullptr;         ///< Metal: id<MTLTexture>；GLES: 纹理名（uintptr_t）
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/**
+ * @brief 零拷贝导入的外部图像
+ *
+ * 平面句柄的有效期由 holder 保证（CVMetalTextureRef、EGLImage 缓存项等），
+ * 持有本对象即可安全采样。只读，可被多个数据包共享。
+ */
+struct ExternalImage {
+    static constexpr uint32_t kMaxPlanes = 3;
+
+    ExternalImageFormat format = ExternalImageFormat::BGRA;
+    YUVColorSpace colorSpace = YUVColorSpace::BT709;
+    bool fullRange = false;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    ExternalImagePlane planes[kMaxPlanes];
+    uint32_t planeCount = 0;
+
+    uint32_t glTarget = 0;          ///< GLES 纹理目标（GL_TEXTURE_2D / GL_TEXTURE_EXTERNAL_OES），Metal为0
+
+    // 纹理坐标变换（SurfaceTexture.getTransformMatrix，列主序）
+    float transform[16] = {
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        0, 0, 0, 1
+    };
+
+    std::shared_ptr<void> holder;   ///< 平台资源的生命周期持有者
+
+    bool isYUV() const { return format == ExternalImageFormat::NV12; }
+};
+
+using ExternalImagePtr = std::shared_ptr<const ExternalImage>;
+
+/**
+ * @brief 获取 YUV->RGB 的 3x4 行主序矩阵（输入为 [0,1] 归一化的 Y/Cb/Cr）
+ *
+ * rgb = M[:, 0..2] * (y, cb, cr) + M[:, 3]，已包含 video range 的偏移与拉伸，
+ * 可直接作为 uniform 传给着色器。
+ * @param colorSpace 色彩标准
+ * @param fullRange 是否为 full range
+ * @param matrix 输出 12 个元素
+ */
+void getYUVToRGBMatrix(YUVColorSpace colorSpace, bool fullRange, float matrix[12]);
+
+/**
+ * @brief 外部图像格式对应的管线像素格式（用于数据包描述）
+ */
+PixelFormat getExternalImagePixelFormat(ExternalImageFormat format);
+
+} // namespace pipeline
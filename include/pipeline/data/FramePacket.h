@@ -6,6 +6,7 @@
 #pragma once
 
 #include "EntityTypes.h"
+#include "MetadataKey.h"
 #include <atomic>
 #include <any>
 #include <unordered_map>
@@ -17,12 +18,15 @@ namespace lrengine {
 namespace render {
 class LRTexture;
 class LRPlanarTexture;
-class LRFence;
 } // namespace render
 } // namespace lrengine
 
 namespace pipeline {
 
+class ReadbackRequest;
+class GpuFence;
+struct ExternalImage;
+
 /**
  * @brief 帧数据包
  * 
@@ -80,6 +84,74 @@ public:
      */
     void setSequenceNumber(uint64_t seq) { mSequenceNumber = seq; }
     
+    /**
+     * @brief 获取内容代号
+     *
+     * 每次写入图像数据（纹理/多平面纹理/外部图像/CPU缓冲）都会分配新的全局唯一代号；
+     * 下游比较代号即可判断输入是否与上一帧相同。0 表示未知，不能据此复用结果。
+     */
+    uint64_t getContentGeneration() const { return mContentGeneration; }
+    
+    /**
+     * @brief 设置内容代号（转发未修改的图像时沿用上游代号）
+     */
+    void setContentGeneration(uint64_t generation) { mContentGeneration = generation; }
+    
+    /**
+     * @brief 分配新的内容代号（进程内单调递增，从1开始）
+     */
+    static uint64_t nextContentGeneration();
+    
+    /**
+     * @brief 获取本帧的渲染比例（相对全分辨率，1 为全分辨率）
+     * 
+     * 由执行器在帧开始时按输出目标选定（仅预览时使用代理分辨率），随帧向下游传递。
+     */
+    float getRenderScale() const { return mRenderScale; }
+    
+    /**
+     * @brief 设置本帧的渲染比例
+     */
+    void setRenderScale(float scale) { mRenderScale = scale; }
+    
+    /**
+     * @brief 获取本帧包像素相对全分辨率的比例
+     * 
+     * 源帧为1；按代理分辨率渲染的GPU输出与 getRenderScale() 相同。
+     */
+    float getPixelScale() const { return mPixelScale; }
+    
+    /**
+     * @brief 设置本帧包像素相对全分辨率的比例
+     */
+    void setPixelScale(float scale) { mPixelScale = scale; }
+    
+    /**
+     * @brief 生产者是否按需省略了本帧包的图像数据
+     * 
+     * 按需产出时，本帧没有消费者需要的输出只携带时间戳、尺寸与元数据，
+     * 不含纹理与CPU缓冲（getCpuBuffer 返回 nullptr）。只有声明本帧不读取该输入的
+     * 消费者（ProcessEntity::wantsInput 返回 false）会收到这样的帧包。
+     */
+    bool isPayloadElided() const { return mPayloadElided; }
+    
+    void setPayloadElided(bool elided) { mPayloadElided = elided; }
+    
+    /**
+     * @brief 获取感兴趣区域（默认整幅图像）
+     * 
+     * 由输入裁剪或检测类Entity写入并随帧向下游传递；声明只改写ROI的Entity
+     * （ProcessEntity::setRoiLimited）只处理该区域，区域外输出与输入一致。
+     */
+    const RoiRect& getRoi() const { return mRoi; }
+    
+    void setRoi(const RoiRect& roi) { mRoi = roi; }
+    
+    /**
+     * @brief 是否设置了小于整幅图像的ROI
+     */
+    bool hasRoi() const { return !mRoi.isFull(); }
+    
     // ==========================================================================
     // 图像数据
     // ==========================================================================
@@ -104,14 +176,35 @@ public:
      */
     void setPlanarTexture(std::shared_ptr<lrengine::render::LRPlanarTexture> texture);
     
+    /**
+     * @brief 获取零拷贝导入的外部图像（相机原生纹理，按平面采样）
+     */
+    std::shared_ptr<const ExternalImage> getExternalImage() const { return mExternalImage; }
+    
+    /**
+     * @brief 设置外部图像
+     */
+    void setExternalImage(std::shared_ptr<const ExternalImage> image);
+    
     /**
      * @brief 获取CPU缓冲数据（懒加载）
      * 
-     * 如果CPU缓冲为空且存在GPU纹理，将从GPU读取数据。
+     * 如果CPU缓冲为空且有在途的异步读回，等待其结果；
+     * 否则若存在GPU纹理，将从GPU读取数据。
      * @return CPU缓冲指针，可能为nullptr
      */
     const uint8_t* getCpuBuffer();
     
+    /**
+     * @brief 关联异步读回（GPU线程发起，getCpuBuffer 时才等待结果）
+     */
+    void setPendingReadback(std::shared_ptr<ReadbackRequest> request) { mPendingReadback = std::move(request); }
+    
+    /**
+     * @brief 是否有尚未取用的异步读回
+     */
+    bool hasPendingReadback() const { return mPendingReadback != nullptr; }
+    
     /**
      * @brief 获取CPU缓冲数据（不触发加载）
      */
@@ -127,6 +220,27 @@ public:
      */
     void setCpuBuffer(const uint8_t* data, size_t size, bool takeOwnership = true);
     
+    /**
+     * @brief 共享CPU缓冲（零拷贝）
+     * 
+     * 只持有引用、不复制数据，缓冲在所有持有者释放后由其删除器回收。
+     * 可传入别名指针（指向平台buffer内部数据，同时持有平台buffer），
+     * 或由生产者循环复用的缓冲。共享期间生产者不得改写其内容。
+     * @param buffer 缓冲
+     * @param size 数据大小
+     */
+    void setCpuBuffer(std::shared_ptr<uint8_t> buffer, size_t size);
+    
+    /**
+     * @brief 获取CPU缓冲句柄（共享引用，不复制，不触发加载）
+     */
+    std::shared_ptr<uint8_t> getCpuBufferHandle() const { return mCpuBuffer; }
+    
+    /**
+     * @brief 获取CPU缓冲大小（字节）
+     */
+    size_t getCpuBufferSize() const { return mCpuBufferSize; }
+    
     /**
      * @brief 清除CPU缓冲
      */
@@ -212,10 +326,51 @@ public:
     void removeMetadata(const std::string& key);
     
     /**
-     * @brief 清除所有元数据
+     * @brief 清除所有元数据（含类型化元数据）
      */
     void clearMetadata();
     
+    // ==========================================================================
+    // 类型化元数据（热路径：数组下标访问，无字符串哈希、无锁、不经 std::any）
+    // 只应由产出该帧包的Entity在下发前写入，下发后下游只读
+    // ==========================================================================
+    
+    /**
+     * @brief 设置类型化元数据
+     */
+    template<typename T, typename U>
+    void setMetadata(const MetadataKey<T>& key, U&& value) {
+        mTypedMetadata.set(key, std::forward<U>(value));
+    }
+    
+    /**
+     * @brief 获取可写的类型化元数据，不存在时默认构造（原地填充，避免临时对象）
+     * @return 值指针，键无效时返回nullptr
+     */
+    template<typename T>
+    T* emplaceMetadata(const MetadataKey<T>& key) {
+        return mTypedMetadata.emplace(key);
+    }
+    
+    /**
+     * @brief 获取类型化元数据
+     * @return 值指针（生命周期同帧包），不存在返回nullptr
+     */
+    template<typename T>
+    const T* getMetadata(const MetadataKey<T>& key) const {
+        return mTypedMetadata.get(key);
+    }
+    
+    template<typename T>
+    bool hasMetadata(const MetadataKey<T>& key) const {
+        return mTypedMetadata.has(key.slot());
+    }
+    
+    template<typename T>
+    void removeMetadata(const MetadataKey<T>& key) {
+        mTypedMetadata.remove(key.slot());
+    }
+    
     // ==========================================================================
     // GPU同步
     // ==========================================================================
@@ -223,22 +378,24 @@ public:
     /**
      * @brief 获取GPU栅栏
      */
-    std::shared_ptr<lrengine::render::LRFence> getGpuFence() const { return mGpuFence; }
+    std::shared_ptr<GpuFence> getGpuFence() const { return mGpuFence; }
     
     /**
      * @brief 设置GPU栅栏
      */
-    void setGpuFence(std::shared_ptr<lrengine::render::LRFence> fence);
+    void setGpuFence(std::shared_ptr<GpuFence> fence);
     
     /**
-     * @brief 等待GPU操作完成
+     * @brief 在CPU上等待生产本帧的GPU操作完成（任意线程）
      * @param timeoutMs 超时时间（毫秒），-1表示无限等待
-     * @return 是否成功等待
+     * @return 是否成功等待（没有栅栏时立即返回true）
      */
     bool waitGpu(int64_t timeoutMs = -1);
     
     /**
-     * @brief 标记GPU操作完成
+     * @brief 在当前GPU命令流插入栅栏，标记本帧的GPU操作（生产者在GPU线程提交渲染后调用）
+     * 
+     * 平台不支持栅栏时不设置，消费者等待立即返回（依赖串行GPU队列的隐式顺序）。
      */
     void signalGpu();
     
@@ -291,12 +448,19 @@ private:
     uint64_t mFrameId = 0;
     uint64_t mTimestamp = 0;
     uint64_t mSequenceNumber = 0;
+    uint64_t mContentGeneration = 0;
+    float mRenderScale = 1.0f;
+    float mPixelScale = 1.0f;
+    bool mPayloadElided = false;
+    RoiRect mRoi;
     
     // 图像数据
     std::shared_ptr<lrengine::render::LRTexture> mTexture;
     std::shared_ptr<lrengine::render::LRPlanarTexture> mPlanarTexture;  // 多平面纹理
+    std::shared_ptr<const ExternalImage> mExternalImage;                // 零拷贝导入的外部图像
     std::shared_ptr<uint8_t> mCpuBuffer;  // 使用 uint8_t 而非 uint8_t[] 以简化操作
     size_t mCpuBufferSize = 0;
+    std::shared_ptr<ReadbackRequest> mPendingReadback;  // 在途的异步读回
     uint32_t mWidth = 0;
     uint32_t mHeight = 0;
     uint32_t mStride = 0;
@@ -305,9 +469,10 @@ private:
     // 元数据
     mutable std::mutex mMetadataMutex;
     std::unordered_map<std::string, std::any> mMetadata;
+    MetadataStore mTypedMetadata;
     
     // GPU同步
-    std::shared_ptr<lrengine::render::LRFence> mGpuFence;
+    std::shared_ptr<GpuFence> mGpuFence;
     
     // 引用计数和池
     std::atomic<int32_t> mRefCount{1};
@@ -0,0 +1,152 @@
+/**
+ * @file GpuCommandContext.h
+ * @brief GPU命令上下文 - 帧级命令缓冲录制（Metal）与冗余绑定过滤（GLES）
+ *
+ * 每个GPU线程一份（GpuCommandContext::current()），多条管线共用GPU队列时也只有一份，
+ * 因此记录的绑定状态就是该线程上GL上下文的真实状态。
+ *
+ * - 录制模式（Metal）：一帧内所有GPU节点的渲染通道编码进同一个命令缓冲，
+ *   每个通道一个渲染编码器，帧内最后一个GPU节点结束后只提交一次。
+ *   插入栅栏、发起读回、执行非GPU节点前会先提交，保证依赖的渲染命令已在队列中。
+ * - 状态跟踪（GLES）：连续节点之间FBO/程序/管线状态/纹理/顶点缓冲相同则跳过绑定。
+ *   绕过本类直接改动GL状态的代码（读回、显示、外部纹理导入）执行后须调用 invalidateState()，
+ *   执行器在这些任务前后已自动处理。
+ *
+ * 所有方法只能在所属GPU线程调用。
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace pipeline {
+
+/**
+ * @brief 平台命令缓冲后端
+ */
+class CommandBufferBackend {
+public:
+    virtual ~CommandBufferBackend() = default;
+
+    /**
+     * @brief 新建命令缓冲
+     * @return 原生句柄（Metal 为 id<MTLCommandBuffer>），失败返回 nullptr
+     */
+    virtual void* begin() = 0;
+
+    /**
+     * @brief 提交并释放 begin() 返回的命令缓冲
+     */
+    virtual void commit(void* commandBuffer) = 0;
+};
+
+/**
+ * @brief 平台后端（仅在对应平台编译）
+ */
+std::unique_ptr<CommandBufferBackend> createMetalCommandBufferBackend();
+
+/**
+ * @brief 命令统计
+ */
+struct GpuCommandStats {
+    uint64_t passes = 0;          // 渲染通道数
+    uint64_t commits = 0;         // 命令缓冲提交次数（仅录制模式）
+    uint64_t bindsIssued = 0;     // 实际发出的绑定
+    uint64_t bindsSkipped = 0;    // 因状态未变而跳过的绑定
+};
+
+/**
+ * @brief GPU命令上下文（线程内单例）
+ */
+class GpuCommandContext {
+public:
+    /// 跟踪的纹理单元数（超出的单元总是重新绑定）
+    static constexpr uint32_t kMaxTrackedTextureUnits = 16;
+
+    /**
+     * @brief 当前线程的命令上下文
+     */
+    static GpuCommandContext& current();
+
+    GpuCommandContext(const GpuCommandContext&) = delete;
+    GpuCommandContext& operator=(const GpuCommandContext&) = delete;
+
+    // ==========================================================================
+    // 帧级录制
+    // ==========================================================================
+
+    /**
+     * @brief 开关录制模式（平台不支持时保持关闭；关闭前提交已录制的命令）
+     * @return 录制模式是否生效
+     */
+    bool setRecordingEnabled(bool enabled);
+    bool isRecording() const { return mBackend != nullptr && mRecording; }
+
+    /**
+     * @brief 开始一个渲染通道
+     * @return 录制模式下为本帧命令缓冲（按需新建），否则为 nullptr（由渲染上下文自行提交）
+     */
+    void* beginPass();
+
+    /**
+     * @brief 提交已录制的命令缓冲，并使跟踪的状态失效
+     * @return 是否有命令被提交
+     */
+    bool commit();
+
+    /**
+     * @brief 是否有尚未提交的命令
+     */
+    bool hasPendingCommands() const { return mOpenBuffer != nullptr; }
+
+    // ==========================================================================
+    // 状态跟踪
+    // ==========================================================================
+
+    void setStateTrackingEnabled(bool enabled);
+    bool isStateTrackingEnabled() const { return mTracking; }
+
+    /**
+     * @brief 以下 bind* 返回 true 表示调用方需要实际发出该绑定
+     */
+    bool bindFrameBuffer(const void* frameBuffer);
+    bool setViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+    bool bindPipelineState(const void* pipelineState);
+    bool bindProgram(const void* program);
+    bool bindVertexBuffer(const void* vertexBuffer);
+    bool bindTexture(uint32_t unit, const void* texture);
+
+    /**
+     * @brief 忘记全部已跟踪的状态，下一次绑定必定发出
+     */
+    void invalidateState();
+
+    GpuCommandStats getStats() const { return mStats; }
+    void resetStats() { mStats = GpuCommandStats(); }
+
+private:
+    GpuCommandContext();
+    ~GpuCommandContext();
+
+    // 状态相同返回 false 并计入跳过，否则记下新值
+    bool track(const void*& slot, const void* value);
+
+    bool mRecording = false;
+    bool mTracking = true;
+    std::unique_ptr<CommandBufferBackend> mBackend;
+    void* mOpenBuffer = nullptr;
+
+    const void* mFrameBuffer = nullptr;
+    const void* mPipelineState = nullptr;
+    const void* mProgram = nullptr;
+    const void* mVertexBuffer = nullptr;
+    std::array<const void*, kMaxTrackedTextureUnits> mTextures{};
+    std::array<uint32_t, 4> mViewport{};
+    bool mViewportValid = false;
+
+    GpuCommandStats mStats;
+};
+
+} // namespace pipeline
@@ -0,0 +1,58 @@
+/**
+ * @file GpuFence.h
+ * @brief GPU栅栏 - 跨队列/跨线程的GPU完成同步
+ *
+ * 生产者（GPU线程）在提交渲染命令后插入栅栏，消费者（CPU/IO线程、其他GL上下文）
+ * 只等待该帧自己的GPU工作完成，无需 glFinish 等全管线同步。
+ * GLES：EGL_KHR_fence_sync；Metal：MTLSharedEvent。
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace pipeline {
+
+/**
+ * @brief GPU栅栏
+ */
+class GpuFence {
+public:
+    virtual ~GpuFence() = default;
+
+    /**
+     * @brief 在CPU上等待栅栏（任意线程）
+     * @param timeoutMs 超时时间（毫秒），-1表示无限等待
+     * @return 已signal返回true，超时或出错返回false
+     */
+    virtual bool wait(int64_t timeoutMs = -1) = 0;
+
+    /**
+     * @brief 栅栏是否已signal（不阻塞）
+     */
+    virtual bool isSignaled() const = 0;
+
+    /**
+     * @brief 让当前GPU命令流等待栅栏（不阻塞CPU）
+     *
+     * 供另一上下文/队列上的GPU消费者使用；不支持时退化为CPU等待。
+     */
+    virtual void waitOnGPU() { wait(-1); }
+
+    /**
+     * @brief 在当前GPU命令流末尾插入栅栏（GPU线程，已提交的渲染命令之后）
+     * @return 栅栏，平台不支持时返回nullptr
+     */
+    static std::shared_ptr<GpuFence> insert();
+};
+
+using GpuFencePtr = std::shared_ptr<GpuFence>;
+
+/**
+ * @brief 平台栅栏（仅在对应平台编译）
+ */
+GpuFencePtr createEGLSyncFence();
+GpuFencePtr createMetalSharedEventFence();
+
+} // namespace pipeline
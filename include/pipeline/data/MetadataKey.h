@@ -0,0 +1,255 @@
+/**
+ * @file MetadataKey.h
+ * @brief 类型化元数据键与帧包内联元数据存储
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace pipeline {
+
+/// 类型化元数据槽位总数（进程内所有 MetadataKey 共用）
+constexpr uint32_t kMaxMetadataSlots = 32;
+
+namespace detail {
+
+/**
+ * @brief 分配槽位（每个 MetadataKey 构造时调用一次）
+ */
+inline uint32_t allocateMetadataSlot() {
+    static std::atomic<uint32_t> sNextSlot{0};
+    return sNextSlot.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 槽位值的类型擦除操作（每个类型一份静态表）
+ */
+struct MetadataSlotOps {
+    size_t size;
+    size_t alignment;
+    void (*copyConstruct)(void* dst, const void* src);
+    void (*copyAssign)(void* dst, const void* src);
+    void (*destroy)(void* value);
+};
+
+template <typename T>
+const MetadataSlotOps* metadataSlotOps() {
+    static const MetadataSlotOps ops{
+        sizeof(T),
+        alignof(T),
+        [](void* dst, const void* src) { new (dst) T(*static_cast<const T*>(src)); },
+        [](void* dst, const void* src) { *static_cast<T*>(dst) = *static_cast<const T*>(src); },
+        [](void* value) { static_cast<T*>(value)->~T(); },
+    };
+    return &ops;
+}
+
+} // namespace detail
+
+/**
+ * @brief 类型化元数据键
+ *
+ * 每个键在构造时分配固定槽位，访问为数组下标，无字符串哈希。
+ * 键应定义为命名空间作用域的 inline 常量（每个键只构造一次），例如：
+ *
+ *   inline const MetadataKey<FaceDetectionResult> kFaceDetectionResultKey{"face_detection"};
+ */
+template <typename T>
+class MetadataKey {
+public:
+    using ValueType = T;
+
+    explicit MetadataKey(const char* name)
+        : mName(name)
+        , mSlot(detail::allocateMetadataSlot()) {
+        assert(mSlot < kMaxMetadataSlots && "too many MetadataKey definitions");
+    }
+
+    MetadataKey(const MetadataKey&) = delete;
+    MetadataKey& operator=(const MetadataKey&) = delete;
+
+    const char* name() const { return mName; }
+    uint32_t slot() const { return mSlot; }
+    bool isValid() const { return mSlot < kMaxMetadataSlots; }
+
+private:
+    const char* mName;
+    uint32_t mSlot;
+};
+
+/**
+ * @brief 帧包内联元数据存储
+ *
+ * 值存放在内联 arena 中（超出时退化为一次堆分配，存储随帧包复用保留），
+ * 不经 std::any、不加锁。约定单写多读：只由产出帧包的Entity在下发前写入，
+ * 下游只读。
+ */
+class MetadataStore {
+public:
+    static constexpr size_t kArenaSize = 512;
+
+    MetadataStore() = default;
+
+    ~MetadataStore() {
+        clear();
+        for (auto& slot : mSlots) {
+            if (slot.heap) {
+                ::operator delete(slot.storage, std::align_val_t(slot.ops->alignment));
+            }
+        }
+    }
+
+    // 禁止拷贝（使用 copyFrom）
+    MetadataStore(const MetadataStore&) = delete;
+    MetadataStore& operator=(const MetadataStore&) = delete;
+
+    /**
+     * @brief 设置值（已存在时赋值）
+     */
+    template <typename T, typename U>
+    void set(const MetadataKey<T>& key, U&& value) {
+        Slot* slot = prepare<T>(key);
+        if (!slot) {
+            return;
+        }
+        if (slot->constructed) {
+            *static_cast<T*>(slot->storage) = std::forward<U>(value);
+        } else {
+            new (slot->storage) T(std::forward<U>(value));
+            slot->constructed = true;
+        }
+    }
+
+    /**
+     * @brief 获取可写值，不存在时默认构造（便于原地填充）
+     */
+    template <typename T>
+    T* emplace(const MetadataKey<T>& key) {
+        Slot* slot = prepare<T>(key);
+        if (!slot) {
+            return nullptr;
+        }
+        if (!slot->constructed) {
+            new (slot->storage) T();
+            slot->constructed = true;
+        }
+        return static_cast<T*>(slot->storage);
+    }
+
+    /**
+     * @brief 获取值，不存在返回nullptr
+     */
+    template <typename T>
+    const T* get(const MetadataKey<T>& key) const {
+        if (!key.isValid() || !mSlots[key.slot()].constructed) {
+            return nullptr;
+        }
+        return static_cast<const T*>(mSlots[key.slot()].storage);
+    }
+
+    bool has(uint32_t slot) const {
+        return slot < kMaxMetadataSlots && mSlots[slot].constructed;
+    }
+
+    /**
+     * @brief 移除值（析构对象，保留存储）
+     */
+    void remove(uint32_t slot) {
+        if (slot < kMaxMetadataSlots) {
+            destroy(mSlots[slot]);
+        }
+    }
+
+    /**
+     * @brief 清除所有值（保留存储供复用）
+     */
+    void clear() {
+        if (mConstructedMask == 0) {
+            return;
+        }
+        for (auto& slot : mSlots) {
+            destroy(slot);
+        }
+    }
+
+    /**
+     * @brief 复制另一存储的所有值
+     */
+    void copyFrom(const MetadataStore& other) {
+        for (uint32_t i = 0; i < kMaxMetadataSlots; ++i) {
+            const Slot& source = other.mSlots[i];
+            Slot& target = mSlots[i];
+            if (!source.constructed) {
+                destroy(target);
+                continue;
+            }
+            if (!target.storage) {
+                target.ops = source.ops;
+                target.storage = allocate(source.ops->size, source.ops->alignment, target.heap);
+            }
+            if (target.constructed) {
+                source.ops->copyAssign(target.storage, source.storage);
+            } else {
+                source.ops->copyConstruct(target.storage, source.storage);
+                target.constructed = true;
+                mConstructedMask |= 1u << i;
+            }
+        }
+    }
+
+private:
+    static_assert(kMaxMetadataSlots <= 32, "mConstructedMask holds one bit per slot");
+
+    struct Slot {
+        void* storage = nullptr;
+        const detail::MetadataSlotOps* ops = nullptr;
+        bool constructed = false;
+        bool heap = false;
+    };
+
+    template <typename T>
+    Slot* prepare(const MetadataKey<T>& key) {
+        if (!key.isValid()) {
+            return nullptr;
+        }
+        Slot& slot = mSlots[key.slot()];
+        if (!slot.storage) {
+            slot.ops = detail::metadataSlotOps<T>();
+            slot.storage = allocate(sizeof(T), alignof(T), slot.heap);
+        }
+        mConstructedMask |= 1u << key.slot();
+        return &slot;
+    }
+
+    void* allocate(size_t size, size_t alignment, bool& heap) {
+        size_t offset = (mArenaUsed + alignment - 1) & ~(alignment - 1);
+        if (alignment <= alignof(std::max_align_t) && offset + size <= kArenaSize) {
+            mArenaUsed = offset + size;
+            heap = false;
+            return mArena + offset;
+        }
+        heap = true;
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+
+    void destroy(Slot& slot) {
+        if (slot.constructed) {
+            slot.ops->destroy(slot.storage);
+            slot.constructed = false;
+        }
+        mConstructedMask &= ~(1u << static_cast<uint32_t>(&slot - mSlots));
+    }
+
+    Slot mSlots[kMaxMetadataSlots];
+    uint32_t mConstructedMask = 0;        // 快速判断是否为空
+    size_t mArenaUsed = 0;
+    alignas(std::max_align_t) unsigned char mArena[kArenaSize];
+};
+
+} // namespace pipeline
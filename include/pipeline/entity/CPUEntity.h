@@ -9,6 +9,27 @@
 
 namespace pipeline {
 
+/**
+ * @brief 分块处理的行带
+ *
+ * src/dst 指向整幅图像首行，本块负责写入 [rowBegin, rowEnd) 行；
+ * 邻域滤波可读取 [rowBegin - haloTop, rowEnd + haloBottom) 行（图像边缘处已截断）。
+ */
+struct CPUTile {
+    const uint8_t* src = nullptr;
+    uint8_t* dst = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;            // 整幅图像高度
+    uint32_t srcStride = 0;
+    uint32_t dstStride = 0;
+    PixelFormat format = PixelFormat::RGBA8;
+    uint32_t rowBegin = 0;
+    uint32_t rowEnd = 0;
+    uint32_t haloTop = 0;
+    uint32_t haloBottom = 0;
+    uint32_t index = 0;             // 行带序号
+};
+
 /**
  * @brief CPU处理节点
  * 
@@ -25,6 +46,7 @@ namespace pipeline {
  * 
  * 可选重写：
  * - getRequiredFormat(): 指定所需的像素格式
+ * - processTileOnCPU(): 分块模式下的逐行带处理（见 setTiledProcessing）
  */
 class CPUEntity : public ProcessEntity {
 public:
@@ -86,6 +108,23 @@ public:
      */
     bool getPassthroughInput() const { return mPassthroughInput; }
     
+    /**
+     * @brief 设置分块并行处理
+     * 
+     * 启用后帧按行带切分，经CPU工作线程池并行调用 processTileOnCPU，
+     * 各行带直接写入同一块输出缓冲，输出数据包携带该CPU缓冲（不再透传输入纹理），
+     * processOnCPU 不再被调用。适用于逐像素或小邻域的CPU特效。
+     * @param enabled 是否启用
+     * @param haloRows 邻域滤波所需的上下邻接行数
+     * @param minBandRows 每个行带的最少行数（避免切分过细）
+     */
+    void setTiledProcessing(bool enabled, uint32_t haloRows = 0, uint32_t minBandRows = 64);
+    
+    /**
+     * @brief 是否启用分块并行处理
+     */
+    bool isTiledProcessingEnabled() const { return mTiledProcessing; }
+    
 protected:
     // ==========================================================================
     // 子类实现接口
@@ -101,6 +140,9 @@ protected:
     /**
      * @brief CPU处理逻辑（子类必须实现）
      * 
+     * 开启 setRoiLimited 且输入带ROI时，data/width/height 是ROI的子区视图（stride 不变），
+     * 结果坐标相对视图左上角，视图在整幅图像中的偏移见 getRoiOffsetX/Y。
+     * 
      * @param data 像素数据指针
      * @param width 图像宽度
      * @param height 图像高度
@@ -116,6 +158,14 @@ protected:
                              PixelFormat format,
                              std::unordered_map<std::string, std::any>& metadata) = 0;
     
+    /**
+     * @brief 分块模式下处理一个行带（启用分块时子类需重写）
+     * 
+     * 可被多个线程同时调用（各自不同的行带），只能写入本行带的输出行。
+     * @return 是否成功
+     */
+    virtual bool processTileOnCPU(const CPUTile& tile) { return false; }
+    
     /**
      * @brief 获取所需的像素格式
      * 
@@ -124,6 +174,11 @@ protected:
      */
     virtual PixelFormat getRequiredFormat() const { return PixelFormat::RGBA8; }
     
+    /**
+     * @brief 格式协商时接受的输入格式：所需格式，未指定时为任意单平面格式
+     */
+    PixelFormatSet getDefaultAcceptedInputFormats(size_t port) const override;
+    
     /**
      * @brief CPU处理完成后的回调（可选重写）
      * 
@@ -137,6 +192,12 @@ protected:
     // 辅助方法
     // ==========================================================================
     
+    /**
+     * @brief 本次 processOnCPU 视图在（缩放后）图像中的偏移，整帧处理时为0
+     */
+    uint32_t getRoiOffsetX() const { return mRoiOffsetX; }
+    uint32_t getRoiOffsetY() const { return mRoiOffsetY; }
+    
     /**
      * @brief 确保CPU缓冲可用
      * @param packet 数据包
@@ -144,6 +205,13 @@ protected:
      */
     bool ensureCpuBuffer(FramePacketPtr packet);
     
+    /**
+     * @brief 分块并行处理整帧并生成输出数据包
+     */
+    FramePacketPtr processTiled(FramePacketPtr input, const uint8_t* data,
+                                uint32_t width, uint32_t height, uint32_t stride,
+                                PixelFormat format, PipelineContext& context);
+    
     /**
      * @brief 缩放图像
      * @param src 源数据
@@ -152,7 +220,7 @@ protected:
      * @param dstWidth 目标宽度
      * @param dstHeight 目标高度
      * @param format 像素格式
-     * @return 缩放后的数据
+     * @return 缩放后的数据（帧内执行时取自帧内存区，仅本帧内有效）
      */
     std::shared_ptr<uint8_t> scaleImage(const uint8_t* src,
                                         uint32_t srcWidth, uint32_t srcHeight,
@@ -164,6 +232,11 @@ protected:
     bool mWriteBackTexture = false;
     bool mPassthroughInput = true;
     float mProcessingScale = 1.0f;
+    bool mTiledProcessing = false;
+    uint32_t mTileHaloRows = 0;
+    uint32_t mTileMinBandRows = 64;
+    uint32_t mRoiOffsetX = 0;
+    uint32_t mRoiOffsetY = 0;
     
     // 临时缓冲
     std::shared_ptr<uint8_t> mScaledBuffer;
@@ -0,0 +1,88 @@
+/**
+ * @file ClockSyncEntity.h
+ * @brief 时钟同步实体 - 多路输入按主机时钟对齐后送入合成
+ *
+ * 多摄像头管线中各路 InputEntity 节奏不同，帧由主时钟所在的输入驱动。
+ * 本实体放在 CompositeEntity 之前：主路原样通过，每条从属路在最近几帧中
+ * 选出主机时间与主路最接近的一帧，使合成的各路画面在时间上对齐。
+ */
+
+#pragma once
+
+#include "pipeline/entity/ProcessEntity.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace pipeline {
+
+/**
+ * @brief 时钟同步实体
+ *
+ * 端口 "input0".."inputN-1" 对应 "output0".."outputN-1"，端口 0 为主时钟。
+ * 从属路不会阻塞主路：InputEntity 在从属角色下没有新帧时沿用上一帧，
+ * 本实体据包指针识别新帧并保留最近 kHistoryDepth 帧供挑选。
+ *
+ * @code
+ * auto sync = std::make_shared<ClockSyncEntity>("sync", 2);
+ * graph->connect(frontCamera, GPU_OUTPUT_PORT, sync, "input0");
+ * graph->connect(backCamera, GPU_OUTPUT_PORT, sync, "input1");
+ * graph->connect(sync, "output0", composite, "input0");
+ * graph->connect(sync, "output1", composite, "input1");
+ * @endcode
+ */
+class ClockSyncEntity : public ProcessEntity {
+public:
+    /// 每条从属路保留的历史帧数
+    static constexpr size_t kHistoryDepth = 4;
+    
+    /**
+     * @param name Entity 名称
+     * @param inputCount 输入路数（含主路，至少 1）
+     */
+    explicit ClockSyncEntity(const std::string& name = "ClockSyncEntity", size_t inputCount = 2);
+    
+    ~ClockSyncEntity() override;
+    
+    EntityType getType() const override { return EntityType::Composite; }
+    
+    ExecutionQueue getExecutionQueue() const override { return ExecutionQueue::GPU; }
+    
+    size_t getSyncInputCount() const { return mHistories.size(); }
+    
+    /**
+     * @brief 某一路最近一帧相对主路的时间差（微秒，主路恒为 0）
+     */
+    int64_t getLastSkewUs(size_t port) const;
+    
+    /**
+     * @brief 帧包的主机时间（有时钟戳取时钟戳，否则取帧时间戳）
+     */
+    static int64_t hostTimeOf(const FramePacket& packet);
+    
+protected:
+    bool process(const std::vector<FramePacketPtr>& inputs,
+                std::vector<FramePacketPtr>& outputs,
+                PipelineContext& context) override;
+    
+    void finalize(PipelineContext& context) override;
+    
+private:
+    // 记入一条从属路的新帧（与上次相同的包不重复记录）
+    void recordFollower(size_t port, const FramePacketPtr& packet);
+    
+    // 在历史中选出与 masterHostUs 最接近的一帧
+    FramePacketPtr pickNearest(size_t port, int64_t masterHostUs, int64_t& skewUs) const;
+    
+    // 每路历史帧（只在执行本实体的队列上访问）
+    std::vector<std::deque<FramePacketPtr>> mHistories;
+    
+    // 各路最近一次的时间差，供其他线程查询
+    std::unique_ptr<std::atomic<int64_t>[]> mLastSkewUs;
+};
+
+using ClockSyncEntityPtr = std::shared_ptr<ClockSyncEntity>;
+
+} // namespace pipeline
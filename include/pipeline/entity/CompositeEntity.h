@@ -6,6 +6,7 @@
 #pragma once
 
 #include "GPUEntity.h"
+#include "pipeline/utils/ParameterBlock.h"
 
 namespace pipeline {
 
@@ -32,7 +33,8 @@ enum class CompositeLayout : uint8_t {
     SplitHorizontal, // 水平分屏
     SplitVertical,   // 垂直分屏
     Grid2x2,         // 2x2网格
-    PictureInPicture // 画中画
+    PictureInPicture, // 画中画
+    Layers           // 自由图层：按Z序实例化绘制，层数变化不重建着色器
 };
 
 /**
@@ -63,6 +65,9 @@ struct PipConfig {
  * 1. 添加多个输入端口
  * 2. 设置混合模式和布局
  * 3. 配置各输入的参数（位置、大小、透明度等）
+ * 
+ * 配置接口可在任意线程调用：修改写入参数块，渲染线程在每帧执行开始时锁存，
+ * 拖动滑杆不会与绘制争锁，也不会出现一帧内参数前后不一致。
  */
 class CompositeEntity : public GPUEntity {
 public:
@@ -94,7 +99,7 @@ public:
     /**
      * @brief 获取混合模式
      */
-    BlendMode getBlendMode() const { return mBlendMode; }
+    BlendMode getBlendMode() const;
     
     /**
      * @brief 设置布局模式
@@ -104,7 +109,7 @@ public:
     /**
      * @brief 获取布局模式
      */
-    CompositeLayout getLayout() const { return mLayout; }
+    CompositeLayout getLayout() const;
     
     /**
      * @brief 设置画中画配置
@@ -114,7 +119,7 @@ public:
     /**
      * @brief 获取画中画配置
      */
-    const PipConfig& getPipConfig() const { return mPipConfig; }
+    PipConfig getPipConfig() const;
     
     // ==========================================================================
     // 输入配置
@@ -158,6 +163,33 @@ public:
      */
     void setInputZOrder(size_t inputIndex, int32_t zOrder);
     
+    /**
+     * @brief 设置输入在输出中的目标矩形（Layers 布局）
+     * @param inputIndex 输入索引
+     * @param x,y,width,height 归一化输出坐标
+     */
+    void setInputRect(size_t inputIndex, float x, float y, float width, float height);
+    
+    /**
+     * @brief 设置输入的采样区域（Layers 布局，贴纸图集中的子图）
+     *
+     * 多个图层引用同一张图集纹理时只占用一个纹理单元。
+     */
+    void setInputSourceRect(size_t inputIndex, float x, float y, float width, float height);
+    
+    /**
+     * @brief 声明输入不透明（Layers 布局）
+     *
+     * 不透明且 alpha 为1的图层会遮挡其下方被完全覆盖的图层，被遮挡的图层不绘制；
+     * 覆盖整个输出时还可省去清屏。
+     */
+    void setInputOpaque(size_t inputIndex, bool opaque);
+    
+    /**
+     * @brief 上一帧实际绘制的图层数（Layers 布局，跳过不可见/被遮挡的图层后）
+     */
+    size_t getDrawnLayerCount() const { return mLayerInstances.size(); }
+    
     // ==========================================================================
     // 输入管理
     // ==========================================================================
@@ -171,7 +203,7 @@ public:
     /**
      * @brief 获取输入数量
      */
-    size_t getInputCount() const { return mInputConfigs.size(); }
+    size_t getInputCount() const;
     
     /**
      * @brief 设置是否需要所有输入就绪
@@ -186,6 +218,7 @@ protected:
     // 实现
     // ==========================================================================
     
+    void latchParameters() override;
     bool setupShader() override;
     void setUniforms(FramePacket* input) override;
     bool processGPU(const std::vector<FramePacketPtr>& inputs, 
@@ -201,6 +234,47 @@ protected:
      */
     void calculateUVTransforms();
     
+    /**
+     * @brief 单个图层实例（与实例化顶点属性布局一致）
+     */
+    struct LayerInstance {
+        float dstRect[4];       // 输出中的位置 x, y, w, h
+        float srcRect[4];       // 纹理采样区域 x, y, w, h
+        float alpha;
+        float textureSlot;      // 批次内纹理单元序号
+    };
+    
+    /**
+     * @brief 一次实例化绘制（纹理单元数有限，超出时分批，着色器不变）
+     */
+    struct LayerBatch {
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+        std::vector<lrengine::render::LRTexture*> textures;
+    };
+    
+    /**
+     * @brief 锁存的输入配置变化：Layers 布局只标记该图层新旧目标矩形为脏区
+     */
+    void markInputDirty(size_t inputIndex, const float newRect[4]);
+    
+    /**
+     * @brief 按Z序收集可见图层，剔除被遮挡图层并按纹理单元分批
+     * @return 需要绘制的图层数
+     */
+    size_t buildLayerBatches(const std::vector<FramePacketPtr>& inputs);
+    
+    /**
+     * @brief Layers 布局的绘制
+     * 
+     * 目前只完成实例批次、遮挡剔除与脏区裁剪；实例化绘制的提交等渲染后端提供
+     * 实例属性与 DrawInstanced 接口后接入，在此之前本布局不产生画面（首次使用时告警）。
+     */
+    bool processLayers(const std::vector<FramePacketPtr>& inputs);
+    
+    /// 单批最多纹理单元（GLES 3.0 保证片段着色器至少16个）
+    static constexpr size_t kMaxLayerTextureUnits = 8;
+    
 protected:
     /**
      * @brief 单个输入的配置
@@ -216,9 +290,23 @@ protected:
             0, 0, 0, 1
         };
         float uvTransform[4] = {0, 0, 1, 1}; // x, y, width, height in UV space
+        float rect[4] = {0, 0, 1, 1};        // Layers 布局：输出中的目标矩形
+        float sourceRect[4] = {0, 0, 1, 1};  // Layers 布局：纹理采样区域
+        bool opaque = false;                 // Layers 布局：参与遮挡剔除
     };
     
-    // 混合配置
+    /**
+     * @brief 可跨线程设置的参数（写入方视角的完整配置）
+     */
+    struct CompositeParams {
+        BlendMode blendMode = BlendMode::Normal;
+        CompositeLayout layout = CompositeLayout::Blend;
+        PipConfig pip;
+        std::vector<InputConfig> inputs;
+    };
+    ParameterBlock<CompositeParams> mParamBlock;
+    
+    // 本帧锁存的配置（仅渲染线程访问）
     BlendMode mBlendMode = BlendMode::Normal;
     CompositeLayout mLayout = CompositeLayout::Blend;
     PipConfig mPipConfig;
@@ -232,6 +320,13 @@ protected:
     int32_t mInputCountLocation = -1;
     std::vector<int32_t> mInputAlphaLocations;
     std::vector<int32_t> mInputUVTransformLocations;
+    
+    // Layers 布局（每帧重建，容量复用）
+    std::vector<size_t> mLayerOrder;
+    std::vector<LayerInstance> mLayerInstances;
+    std::vector<LayerBatch> mLayerBatches;
+    bool mLayersCoverOutput = false;        // 最底层绘制图层为覆盖全屏的不透明层，无需清屏
+    bool mLayersDrawWarned = false;         // 渲染线程读写
 
     bool mNeedsShaderUpdate = false;
 };
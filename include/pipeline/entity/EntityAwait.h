@@ -0,0 +1,65 @@
+/**
+ * @file EntityAwait.h
+ * @brief Entity异步等待 - 多步GPU/CPU工作不占用队列线程
+ *
+ * 以续体代替 C++20 协程（工程为 C++17）：process() 中登记一个等待
+ * （GPU栅栏、读回结果、CPU子任务）后返回，执行器在等待完成后把续体投递到指定队列继续执行，
+ * 其间该队列线程照常处理其他帧。续体可以再次登记等待，最后一个续体给出本帧输出。
+ *
+ * @code
+ * bool process(const std::vector<FramePacketPtr>& inputs,
+ *              std::vector<FramePacketPtr>& outputs, PipelineContext& context) override {
+ *     renderBlurPasses(inputs[0]);
+ *     awaitFence(GpuFence::insert(), [this, input = inputs[0]](auto& outputs, auto& context) {
+ *         outputs.push_back(blend(input, context));
+ *         return true;
+ *     });
+ *     return true;
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include "pipeline/data/EntityTypes.h"
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/data/GpuFence.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace pipeline {
+
+class PipelineContext;
+
+/**
+ * @brief 续体：与 process 相同的输出约定，返回false表示本帧失败
+ */
+using EntityContinuation = std::function<bool(std::vector<FramePacketPtr>& outputs, PipelineContext& context)>;
+
+/**
+ * @brief 一次登记的等待
+ */
+struct EntityAwait {
+    enum class Kind : uint8_t {
+        Fence,      ///< GPU栅栏 signal
+        Readback,   ///< 读回结果就绪（或失败）
+        Task        ///< CPU子任务执行完毕（在CPU并行队列上执行）
+    };
+
+    Kind kind = Kind::Task;
+    GpuFencePtr fence;
+    ReadbackRequestPtr readback;
+    std::function<void()> task;
+    ExecutionQueue resumeQueue = ExecutionQueue::GPU;   ///< 续体在哪个队列上执行
+    EntityContinuation continuation;
+
+    /**
+     * @brief 在当前线程阻塞直到等待完成（不支持挂起的同步执行路径使用）
+     */
+    void waitBlocking();
+};
+
+using EntityAwaitPtr = std::unique_ptr<EntityAwait>;
+
+} // namespace pipeline
@@ -6,6 +6,8 @@
 #pragma once
 
 #include "ProcessEntity.h"
+#include "ShaderFusion.h"
+#include "pipeline/pool/GpuResourceRegistry.h"
 
 // 前向声明LREngine类型
 namespace lrengine {
@@ -22,6 +24,8 @@ class LRTexture;
 
 namespace pipeline {
 
+class TexturePool;
+
 /**
  * @brief GPU处理节点
  * 
@@ -37,6 +41,7 @@ namespace pipeline {
  * - setupShader(): 设置着色器程序
  * - setUniforms(): 设置着色器参数
  * - processGPU(): GPU处理逻辑（可选，默认为全屏绘制）
+ * - processGPUCompute(): 计算内核路径（可选，见 setComputeShaderSource）
  */
 class GPUEntity : public ProcessEntity {
 public:
@@ -124,6 +129,174 @@ public:
      */
     PixelFormat getOutputFormat() const { return mOutputFormat; }
     
+    /**
+     * @brief 实际输出格式：协商结果优先，未协商时为 getOutputFormat()
+     */
+    PixelFormat getEffectiveOutputFormat() const;
+    
+    /**
+     * @brief 输出候选格式：配置的格式优先，其后按带宽从低到高的高精度格式
+     */
+    std::vector<PixelFormat> getOutputFormatCandidates(size_t port) const override;
+    
+    /**
+     * @brief 根据输入尺寸推导输出尺寸（未设置输出尺寸时沿用输入尺寸）
+     */
+    void resolveOutputSize(uint32_t inputWidth, uint32_t inputHeight,
+                           uint32_t& width, uint32_t& height) const;
+    
+    /**
+     * @brief 按输入帧的渲染比例推导输出尺寸
+     * 
+     * 显式输出尺寸视为全分辨率尺寸；沿用输入尺寸时先按输入的像素比例还原全分辨率。
+     * 两者再乘以本帧渲染比例（代理分辨率预览时小于1）。
+     */
+    void resolveOutputSize(const FramePacket& input, uint32_t& width, uint32_t& height) const;
+    
+    /**
+     * @brief 预热GPU资源
+     * 
+     * 创建着色器、全屏四边形与指定尺寸的FBO，首帧不再承担创建开销。
+     * 需在持有渲染上下文的线程调用。
+     * @return 是否成功
+     */
+    bool warmupResources(PipelineContext& context, uint32_t width, uint32_t height);
+    
+    /**
+     * @brief 启用/禁用输出的异步读回
+     * 
+     * 启用且上下文提供读回服务时，渲染完成后立即发起读回并挂到输出帧包上，
+     * 下游CPU节点调用 getCpuBuffer() 时才等待结果。
+     */
+    void setAsyncReadback(bool enabled) { mAsyncReadback = enabled; }
+    
+    /**
+     * @brief 是否启用异步读回
+     */
+    bool isAsyncReadbackEnabled() const { return mAsyncReadback; }
+    
+    /**
+     * @brief 启用/禁用输出栅栏
+     * 
+     * 启用时渲染提交后在输出帧包上插入GPU栅栏，
+     * 其他队列/线程上的消费者只等待本帧的GPU工作，而非整条管线。
+     */
+    void setSignalFence(bool enabled) { mSignalFence = enabled; }
+    
+    /**
+     * @brief 是否启用输出栅栏
+     */
+    bool isSignalFenceEnabled() const { return mSignalFence; }
+    
+    // ==========================================================================
+    // 输出复用
+    // ==========================================================================
+    
+    /**
+     * @brief 启用/禁用未变化输出的复用
+     * 
+     * 启用后节点保留上一帧的输出纹理：所有输入的内容代号与参数版本都未变时不再绘制，
+     * 直接输出上一帧的纹理（静态贴纸、暂停的视频背景）；只有局部区域变化时
+     * （如贴纸移动）在保留的纹理上按裁剪矩形重绘该区域。
+     * 保留的纹理不回纹理池，每个启用的节点常驻一张输出纹理。
+     * 融合链内的节点不复用；输出还依赖逐帧元数据（如人脸框）的节点不宜启用，
+     * 元数据变化不会改变内容代号。
+     */
+    void setReuseUnchangedOutput(bool enabled);
+    
+    /**
+     * @brief 是否启用输出复用
+     */
+    bool isReuseUnchangedOutputEnabled() const { return mReuseUnchangedOutput; }
+    
+    /**
+     * @brief 因输入与参数均未变化而跳过绘制的帧数
+     */
+    uint64_t getReusedFrameCount() const { return mReusedFrames.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 仅重绘局部区域的帧数
+     */
+    uint64_t getPartialRenderCount() const { return mPartialRenders.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 按输入ROI只绘制局部区域的帧数（需 setRoiLimited(true)）
+     */
+    uint64_t getRoiRenderCount() const { return mRoiRenders.load(std::memory_order_relaxed); }
+    
+    // ==========================================================================
+    // 计算着色器
+    // ==========================================================================
+    
+    /**
+     * @brief 是否优先使用计算内核（默认是）
+     * 
+     * 子类提供了计算内核、设备支持（GLES 3.1 / Metal）且输出格式可做图像写入时走
+     * processGPUCompute，否则回退到片段绘制。关闭后总是走片段路径，便于比对结果。
+     */
+    void setComputePreferred(bool preferred) { mComputePreferred = preferred; }
+    
+    bool isComputePreferred() const { return mComputePreferred; }
+    
+    /**
+     * @brief 本节点当前是否走计算路径（prepare 之后有效）
+     */
+    bool isComputeActive() const;
+    
+    /**
+     * @brief 渲染上下文是否支持计算着色器（需在持有上下文的线程调用）
+     */
+    static bool isComputeSupported(lrengine::render::LRRenderContext* context);
+    
+    /**
+     * @brief 格式能否作为计算着色器的写入图像（rgba8 / rgba16f / rgba32f / r8）
+     */
+    static bool isImageStoreFormat(PixelFormat format);
+    
+    // ==========================================================================
+    // 批处理
+    // ==========================================================================
+    
+    /**
+     * @brief 批处理开始：批内首帧绑定管线状态后保持，后续帧不再重复绑定
+     */
+    void beginBatch(PipelineContext& context, size_t frameCount) override;
+    
+    /**
+     * @brief 批处理结束：恢复逐帧绑定
+     */
+    void endBatch(PipelineContext& context) override;
+    
+    // ==========================================================================
+    // 着色器融合
+    // ==========================================================================
+    
+    /**
+     * @brief 获取逐像素着色器片段
+     * 
+     * 只读取当前像素的效果实现此接口后，执行计划会把它与相邻的逐像素Entity
+     * 合并为一次全屏绘制（见 ShaderFusion.h）。
+     * @return 是否支持融合（默认不支持）
+     */
+    virtual bool getPixelSnippet(PixelShaderSnippet& snippet) const { return false; }
+    
+    /**
+     * @brief 是否可参与融合：提供片段，且输出不需要单独读回或插入栅栏
+     */
+    bool isFusionCandidate() const;
+    
+    /**
+     * @brief 着色器版本（片段内容变化时递增，融合链据此重建程序）
+     */
+    uint64_t getShaderRevision() const { return mShaderRevision.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 设置本次执行绘制的融合链
+     * 
+     * 由执行器在链首执行前设置、执行后清除；链由执行计划持有。
+     */
+    void setActiveFusion(const ShaderFusionChain* chain) { mActiveFusion = chain; }
+    
 protected:
     // ==========================================================================
     // 子类实现接口
@@ -134,6 +307,11 @@ protected:
      */
     bool prepare(PipelineContext& context) override;
     
+    /**
+     * @brief 默认只接受RGB类纹理（子类可放宽，如直接采样多平面纹理的转换节点）
+     */
+    PixelFormatSet getDefaultAcceptedInputFormats(size_t port) const override;
+    
     /**
      * @brief 核心处理逻辑
      */
@@ -173,11 +351,152 @@ protected:
     virtual bool processGPU(const std::vector<FramePacketPtr>& inputs, 
                            FramePacketPtr output);
     
+    /**
+     * @brief 计算内核处理逻辑（子类可选重写）
+     * 
+     * 默认实现：输入纹理绑定为采样器（单元从0起），输出纹理绑定为图像单元0（只写），
+     * 按工作组大小覆盖整张输出（局部重绘时只覆盖裁剪矩形，起点传入 uOrigin）。
+     * 归约类内核（直方图、肤色统计）重写此方法，多次调度之间用 computeBarrier() 同步。
+     */
+    virtual bool processGPUCompute(const std::vector<FramePacketPtr>& inputs,
+                                   FramePacketPtr output);
+    
+    /**
+     * @brief 设置计算内核的uniform参数（每次调度前调用）
+     */
+    virtual void setComputeUniforms(FramePacket* input) {}
+    
+    /**
+     * @brief 设置计算内核源码（GLSL 310 es / 由LREngine转译为MSL）
+     * @param localSizeX 工作组宽度，须与内核中 layout(local_size_x) 一致
+     * @param localSizeY 工作组高度
+     */
+    void setComputeShaderSource(const std::string& source,
+                                uint32_t localSizeX = 16, uint32_t localSizeY = 16);
+    
+    /**
+     * @brief 经着色器缓存获取计算程序（子类的额外内核也用此接口）
+     */
+    std::shared_ptr<lrengine::render::LRShaderProgram> acquireComputeProgram(
+        const std::string& computeSource);
+    
+    /**
+     * @brief 图像访问方式
+     */
+    enum class ImageAccess : uint8_t {
+        ReadOnly,
+        WriteOnly,
+        ReadWrite
+    };
+    
+    /**
+     * @brief 将纹理绑定为图像单元（image load/store）
+     * 
+     * 池中纹理以不可变存储分配，可直接绑定；格式须满足 isImageStoreFormat。
+     */
+    void bindImageTexture(const std::shared_ptr<lrengine::render::LRTexture>& texture,
+                          uint32_t unit, ImageAccess access, PixelFormat format);
+    
+    /**
+     * @brief 调度计算内核
+     */
+    void dispatchCompute(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ = 1);
+    
+    /**
+     * @brief 图像写入对后续采样/图像读取可见（两次调度之间、调度与片段绘制之间）
+     */
+    void computeBarrier();
+    
+    /**
+     * @brief 覆盖 size 个像素所需的工作组数
+     */
+    static uint32_t getDispatchGroupCount(uint32_t size, uint32_t localSize) {
+        return localSize == 0 ? 0 : (size + localSize - 1) / localSize;
+    }
+    
+    /**
+     * @brief 设置融合片段的uniform（链首绘制前对每个启用的成员调用）
+     * @param program 融合后的着色器程序
+     * @param prefix 该成员片段的名字前缀
+     * @param textureUnit 下一个可用纹理单元，绑定额外纹理（如LUT）后递增
+     */
+    virtual void setSnippetUniforms(lrengine::render::LRShaderProgram* program,
+                                    const std::string& prefix, uint32_t& textureUnit) {}
+    
+    /**
+     * @brief 片段或着色器内容变化：下次绘制前重建（含所在融合链的程序）
+     */
+    void invalidateShader();
+    
+    /**
+     * @brief 参数变化：下一帧整帧重绘（启用输出复用时）
+     * 
+     * 设置影响输出的参数后调用；setParameter 已自动调用。
+     */
+    void markParametersDirty();
+    
+    /**
+     * @brief 参数变化只影响输出的局部区域
+     * @param rect 归一化矩形 {x, y, w, h}，与上一帧之前的脏区合并
+     */
+    void markParametersDirty(const float rect[4]);
+    
+    /**
+     * @brief 本次绘制的裁剪矩形（像素，左下原点）
+     * 
+     * 局部重绘时返回true，子类的多Pass绘制需对最终写入输出的Pass应用同一裁剪。
+     */
+    bool getRenderScissor(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height) const;
+    
+    /**
+     * @brief 当前帧的渲染比例（相对全分辨率）
+     * 
+     * 以像素为单位的参数（模糊半径、描边宽度等）按全分辨率设置，绘制时乘以此比例，
+     * 代理分辨率预览与全分辨率录制的观感一致。归一化坐标（人脸框、贴纸位置）无需换算。
+     */
+    float getRenderScale() const { return mRenderScale; }
+    
+    /**
+     * @brief 经进程级缓存获取着色器程序（见 ShaderProgramCache）
+     * 
+     * 相同源码在同一渲染上下文中只编译一次，配置磁盘缓存后跨启动复用程序二进制。
+     * @return 程序，编译失败返回nullptr
+     */
+    std::shared_ptr<lrengine::render::LRShaderProgram> acquireShaderProgram(
+        const std::string& vertexSource, const std::string& fragmentSource);
+    
+    /**
+     * @brief 设置固定功能混合方式（默认不混合）
+     * 
+     * 混合属于管线状态，变化后下次绘制前从共享资源表重新取状态对象。
+     */
+    void setRasterBlend(RasterBlend blend) { mRasterBlend = blend; }
+    
+    /**
+     * @brief 确保管线状态与当前程序/混合方式/输出格式一致
+     * 
+     * 状态对象取自上下文的 GpuResourceRegistry，相同组合的节点共用一个对象，
+     * 驱动看到的状态切换随之减少。无资源表时返回false（绘制沿用当前绑定的状态）。
+     */
+    bool ensurePipelineState();
+    
     /**
      * @brief 创建/更新FrameBuffer
+     * 
+     * 有纹理池时输出纹理每帧从池中取出，随输出帧包释放归还，
+     * 生命周期不重叠的中间结果因此复用同一纹理；FBO仅在尺寸变化时重建。
      */
     bool ensureFrameBuffer(uint32_t width, uint32_t height);
     
+    /**
+     * @brief 从纹理池取临时纹理
+     * 
+     * 最后一个引用释放时归还池中，适用于多Pass中间纹理（用完即释放）。
+     * @return 纹理，无纹理池时返回nullptr
+     */
+    std::shared_ptr<lrengine::render::LRTexture> acquireTransientTexture(
+        uint32_t width, uint32_t height, PixelFormat format = PixelFormat::RGBA8);
+    
     /**
      * @brief 创建全屏顶点缓冲
      */
@@ -202,6 +521,25 @@ protected:
      */
     void unbindInputTextures(size_t count, uint32_t startSlot = 0);
     
+    void onParameterChanged(const std::string& key) override;
+    
+private:
+    bool ensureFusedProgram(const ShaderFusionChain& chain);
+    bool ensureComputeProgram();
+    bool canReuseOutput(const std::vector<FramePacketPtr>& inputs,
+                        uint32_t width, uint32_t height, bool& partial);
+    void updateOutputCache(const std::vector<FramePacketPtr>& inputs);
+    void resetOutputCache();
+    
+    /**
+     * @brief ROI局部绘制：输入整帧拷入输出，裁剪矩形设为ROI
+     * @return 不满足条件（未开启、无ROI、输入非单平面纹理）时返回false，按整帧绘制
+     */
+    bool beginRoiRender(const FramePacket& input, uint32_t width, uint32_t height);
+    bool processFusedGPU(const ShaderFusionChain& chain,
+                         const std::vector<FramePacketPtr>& inputs,
+                         FramePacketPtr output);
+    
 protected:
     // 渲染上下文
     lrengine::render::LRRenderContext* mRenderContext = nullptr;
@@ -216,17 +554,75 @@ protected:
     // FrameBuffer
     std::shared_ptr<lrengine::render::LRFrameBuffer> mFrameBuffer;
     std::shared_ptr<lrengine::render::LRTexture> mOutputTexture;
+    uint32_t mFrameBufferWidth = 0;
+    uint32_t mFrameBufferHeight = 0;
+    bool mOutputFromPool = false;        // 本帧输出纹理来自纹理池（交给输出帧包后不再持有）
+    
+    // 纹理池（prepare时取自上下文）
+    std::weak_ptr<TexturePool> mTexturePool;
     
-    // 管线状态
+    // 共享资源表（prepare时取自上下文）
+    std::weak_ptr<GpuResourceRegistry> mGpuResources;
+    
+    // 管线状态（由资源表去重，记录取得时的键以便程序/格式变化后重新获取）
     std::shared_ptr<lrengine::render::LRPipelineState> mPipelineState;
+    const lrengine::render::LRShaderProgram* mPipelineStateProgram = nullptr;
+    RasterBlend mPipelineStateBlend = RasterBlend::None;
+    PixelFormat mPipelineStateFormat = PixelFormat::RGBA8;
+    RasterBlend mRasterBlend = RasterBlend::None;
     
-    // 全屏顶点缓冲
+    // 全屏顶点缓冲（有资源表时为整条管线共用的一份）
     std::shared_ptr<lrengine::render::LRVertexBuffer> mFullscreenQuad;
     
+    // 批处理：批内着色器/FBO/顶点缓冲已绑定时跳过重复绑定
+    bool mInBatch = false;
+    bool mBatchBound = false;
+    uint32_t mBoundWidth = 0;
+    uint32_t mBoundHeight = 0;
+    
+    // 着色器融合（链首在GPU队列上使用，成员的片段版本变化时重建）
+    const ShaderFusionChain* mActiveFusion = nullptr;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mFusedProgram;
+    std::string mFusedFragmentSource;
+    uint64_t mFusedProgramKey = 0;
+    std::vector<uint8_t> mFusedStageEnabled;     // 与链成员对应：程序中是否包含该成员
+    std::atomic<uint64_t> mShaderRevision{0};
+    
+    // 计算内核（源码为空表示只有片段路径）
+    std::string mComputeShaderSource;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mComputeProgram;
+    uint32_t mComputeLocalSize[2] = {16, 16};
+    bool mComputePreferred = true;
+    bool mComputeNeedsRebuild = false;
+    int8_t mComputeSupport = -1;                // -1 未查询（prepare时在GPU线程查询）
+    
     // 输出配置
     uint32_t mOutputWidth = 0;   // 0表示使用输入尺寸
     uint32_t mOutputHeight = 0;
     PixelFormat mOutputFormat = PixelFormat::RGBA8;
+    PixelFormat mFrameFormat = PixelFormat::RGBA8;  // 本帧生效的输出格式（prepare 时按协商结果确定）
+    float mRenderScale = 1.0f;   // 当前帧的渲染比例（process 开始时取自输入）
+    bool mAsyncReadback = false;
+    bool mSignalFence = false;
+    
+    // 输出复用（只在GPU队列上读写缓存；参数版本与脏区可由任意线程更新）
+    bool mReuseUnchangedOutput = false;
+    std::shared_ptr<lrengine::render::LRTexture> mCachedOutputTexture;
+    std::vector<uint64_t> mCachedInputGenerations;
+    uint64_t mCachedGeneration = 0;
+    uint64_t mCachedParameterVersion = 0;
+    uint32_t mCachedWidth = 0;
+    uint32_t mCachedHeight = 0;
+    PixelFormat mCachedFormat = PixelFormat::Unknown;
+    std::atomic<uint64_t> mParameterVersion{1};
+    std::mutex mDirtyMutex;
+    float mDirtyRect[4] = {0, 0, 0, 0};         // 归一化 {x, y, w, h}，宽或高为0表示无局部脏区
+    bool mDirtyFull = false;
+    bool mScissorActive = false;
+    uint32_t mScissor[4] = {0, 0, 0, 0};
+    std::atomic<uint64_t> mReusedFrames{0};
+    std::atomic<uint64_t> mPartialRenders{0};
+    std::atomic<uint64_t> mRoiRenders{0};
     
     // 默认着色器源码
     static const char* sDefaultVertexShader;
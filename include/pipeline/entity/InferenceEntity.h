@@ -0,0 +1,411 @@
+/**
+ * @file InferenceEntity.h
+ * @brief 神经网络推理节点 - 可插拔推理后端的CPUEntity基类
+ */
+
+#pragma once
+
+#include "CPUEntity.h"
+
+#include <any>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pipeline {
+
+// =============================================================================
+// 张量
+// =============================================================================
+
+/**
+ * @brief 张量布局
+ */
+enum class TensorLayout : uint8_t {
+    NHWC,       ///< 通道在末维（TFLite/NNAPI/CoreML 常用）
+    NCHW        ///< 通道在第二维（NCNN/ONNX 常用）
+};
+
+/**
+ * @brief 张量元素类型
+ */
+enum class TensorDataType : uint8_t {
+    Float32,
+    Float16,
+    Int8,       ///< 仿射量化：real = (q - zeroPoint) * scale
+    UInt8
+};
+
+/**
+ * @brief 元素字节数
+ */
+size_t getTensorDataTypeSize(TensorDataType type);
+
+/**
+ * @brief 张量描述（由后端在加载模型后给出）
+ *
+ * 图像输入的 shape 按 layout 解释：NHWC 为 {N, H, W, C}，NCHW 为 {N, C, H, W}；
+ * N 为模型支持的最大批大小。
+ */
+struct TensorDesc {
+    std::string name;
+    std::vector<int32_t> shape;
+    TensorLayout layout = TensorLayout::NHWC;
+    TensorDataType dataType = TensorDataType::Float32;
+    float scale = 1.0f;             ///< 量化参数（整型张量）
+    int32_t zeroPoint = 0;
+
+    size_t elementCount() const;
+    size_t byteSize() const { return elementCount() * getTensorDataTypeSize(dataType); }
+
+    int32_t batch() const { return shape.empty() ? 1 : shape[0]; }
+    int32_t height() const;
+    int32_t width() const;
+    int32_t channels() const;
+};
+
+/**
+ * @brief 张量（加载模型时分配，跨帧复用）
+ */
+struct Tensor {
+    TensorDesc desc;
+    std::vector<uint8_t> storage;
+
+    uint8_t* data() { return storage.data(); }
+    const uint8_t* data() const { return storage.data(); }
+
+    template<typename T>
+    T* as() { return reinterpret_cast<T*>(storage.data()); }
+
+    template<typename T>
+    const T* as() const { return reinterpret_cast<const T*>(storage.data()); }
+
+    /**
+     * @brief 按元素下标读取实数值（整型反量化、fp16 展开）
+     */
+    float valueAt(size_t index) const;
+
+    /**
+     * @brief 单个批元素的元素数
+     */
+    size_t itemElementCount() const;
+};
+
+// =============================================================================
+// 推理后端
+// =============================================================================
+
+/**
+ * @brief 推理加速代理
+ */
+enum class InferenceDelegate : uint8_t {
+    CPU,        ///< 后端自身的CPU实现
+    GPU,        ///< GPU delegate（TFLite GPU / NCNN Vulkan）
+    NNAPI,      ///< Android NNAPI
+    CoreML      ///< Apple CoreML / ANE
+};
+
+/**
+ * @brief 推理选项
+ */
+struct InferenceOptions {
+    InferenceDelegate delegate = InferenceDelegate::CPU;
+    uint32_t numThreads = 2;
+    uint32_t maxBatchSize = 1;      ///< 单次推理的最大批大小（受模型输入 N 维限制）
+    bool allowFp16 = true;          ///< 允许代理以 fp16 精度计算
+};
+
+/**
+ * @brief 推理后端接口
+ *
+ * 由具体推理库（NCNN、TFLite 等）的适配层实现并经 InferenceBackendRegistry 注册。
+ * 输入/输出张量由 InferenceEntity 持有并跨帧复用，后端只读写其中的数据。
+ */
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    /**
+     * @brief 加载模型
+     * @return 是否成功；代理不可用时应回退到CPU并返回true
+     */
+    virtual bool load(const std::string& modelPath, const InferenceOptions& options) = 0;
+
+    /**
+     * @brief 输入/输出张量描述（load 成功后有效）
+     */
+    virtual std::vector<TensorDesc> getInputDescs() const = 0;
+    virtual std::vector<TensorDesc> getOutputDescs() const = 0;
+
+    /**
+     * @brief 执行推理
+     * @param inputs 已填充的输入张量
+     * @param outputs 输出张量（按 getOutputDescs 分配）
+     * @param batchSize 本次有效的批元素数（不超过张量 N 维）
+     */
+    virtual bool run(const std::vector<Tensor>& inputs,
+                     std::vector<Tensor>& outputs,
+                     uint32_t batchSize) = 0;
+
+    /**
+     * @brief 实际生效的代理（load 之后）
+     */
+    virtual InferenceDelegate getActiveDelegate() const { return InferenceDelegate::CPU; }
+
+    virtual const char* getName() const = 0;
+};
+
+using InferenceBackendPtr = std::unique_ptr<InferenceBackend>;
+
+/**
+ * @brief 推理后端注册表
+ *
+ * 推理库适配层在启动时按名称注册工厂（如 "ncnn"、"tflite"），
+ * InferenceEntity 按名称创建后端，管线本身不直接依赖任何推理库。
+ */
+class InferenceBackendRegistry {
+public:
+    using Factory = std::function<InferenceBackendPtr()>;
+
+    static InferenceBackendRegistry& instance();
+
+    void registerBackend(const std::string& name, Factory factory);
+
+    /**
+     * @brief 按名称创建后端
+     * @return 未注册返回nullptr
+     */
+    InferenceBackendPtr create(const std::string& name) const;
+
+    bool hasBackend(const std::string& name) const;
+
+private:
+    InferenceBackendRegistry() = default;
+
+    mutable std::mutex mMutex;
+    std::vector<std::pair<std::string, Factory>> mFactories;
+};
+
+// =============================================================================
+// 预处理
+// =============================================================================
+
+/**
+ * @brief 图像输入的预处理参数
+ *
+ * 像素值按 (pixel - mean[c]) / stddev[c] 归一化后写入张量，整型张量再按其量化参数量化。
+ */
+struct TensorPreprocess {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    float stddev[3] = {1.0f, 1.0f, 1.0f};
+    bool swapRB = false;            ///< RGBA 输入按 BGR 顺序写入
+    bool grayscale = false;         ///< 单通道模型输入（亮度）
+};
+
+/**
+ * @brief 批元素对应的源图像区域（像素坐标）
+ *
+ * 后处理用于把模型输出坐标映射回原图。
+ */
+struct InferenceRegion {
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+};
+
+// =============================================================================
+// InferenceEntity
+// =============================================================================
+
+/**
+ * @brief 神经网络推理节点
+ *
+ * 负责模型一次性加载、从管线CPU缓冲直接生成输入张量（缩放/归一化/布局/量化一步完成）、
+ * 输入输出张量跨帧复用，以及按区域批量推理。子类只需实现后处理：
+ *
+ * - postprocess(): 解析输出张量，写入元数据（必须实现）
+ * - collectRegions(): 每帧需要推理的区域，默认整帧；关键点等二阶段模型按人脸框返回多个区域，
+ *   区域按最大批大小分批推理
+ *
+ * @code
+ * class SegmentationEntity : public InferenceEntity {
+ * protected:
+ *     bool postprocess(const std::vector<Tensor>& outputs, size_t batchBegin, size_t batchSize,
+ *                      const std::vector<InferenceRegion>& regions,
+ *                      std::unordered_map<std::string, std::any>& metadata) override;
+ * };
+ *
+ * auto seg = std::make_shared<SegmentationEntity>("segmentation");
+ * seg->setModel("tflite", "/data/selfie_seg.tflite", options);
+ * @endcode
+ */
+class InferenceEntity : public CPUEntity {
+public:
+    explicit InferenceEntity(const std::string& name = "InferenceEntity");
+
+    ~InferenceEntity() override;
+
+    // ==========================================================================
+    // 模型配置
+    // ==========================================================================
+
+    /**
+     * @brief 设置模型（首次处理时在CPU队列上加载，参数不变时不会重复加载）
+     * @param backendName 已注册的后端名称
+     * @param modelPath 模型路径
+     * @param options 推理选项
+     */
+    void setModel(const std::string& backendName, const std::string& modelPath,
+                  const InferenceOptions& options = InferenceOptions());
+
+    /**
+     * @brief 直接指定后端实例（自定义后端，不经注册表）
+     */
+    void setModel(InferenceBackendPtr backend, const std::string& modelPath,
+                  const InferenceOptions& options = InferenceOptions());
+
+    /**
+     * @brief 立即加载模型（可在初始化阶段调用以避免首帧卡顿）
+     */
+    bool loadModel();
+
+    /**
+     * @brief 模型是否已加载
+     */
+    bool isModelLoaded() const;
+
+    /**
+     * @brief 设置图像输入的预处理参数
+     */
+    void setPreprocess(const TensorPreprocess& preprocess);
+
+    const TensorPreprocess& getPreprocess() const { return mPreprocess; }
+
+    /**
+     * @brief 获取输入/输出张量描述（模型加载后有效）
+     */
+    std::vector<TensorDesc> getInputDescs() const;
+    std::vector<TensorDesc> getOutputDescs() const;
+
+    /**
+     * @brief 最近一次推理耗时（微秒，不含预处理）
+     */
+    uint64_t getLastInferenceTimeUs() const { return mLastInferenceTimeUs; }
+
+    /**
+     * @brief 每 interval 帧推理一次（其余帧沿用上次结果，<= 1 表示逐帧）
+     */
+    void setInferenceInterval(uint32_t interval);
+
+    uint32_t getInferenceInterval() const { return mInferenceInterval.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 按质量档位调整检测间隔
+     */
+    void onQualityChanged(const QualitySettings& settings) override;
+
+    /**
+     * @brief 只有检测间隔的首帧需要像素，中间帧的CPU输入可由生产者省略（按需产出）
+     */
+    bool wantsInput(size_t port) override;
+
+protected:
+    bool process(const std::vector<FramePacketPtr>& inputs,
+                 std::vector<FramePacketPtr>& outputs,
+                 PipelineContext& context) override;
+
+    bool processOnCPU(const uint8_t* data,
+                     uint32_t width,
+                     uint32_t height,
+                     uint32_t stride,
+                     PixelFormat format,
+                     std::unordered_map<std::string, std::any>& metadata) override;
+
+    PixelFormat getRequiredFormat() const override { return PixelFormat::RGBA8; }
+
+    // ==========================================================================
+    // 子类接口
+    // ==========================================================================
+
+    /**
+     * @brief 本帧需要推理的区域（像素坐标，相对 processOnCPU 的图像）
+     *
+     * 默认返回整帧；返回空表示本帧无需推理（postprocess 不会被调用）。
+     */
+    virtual void collectRegions(uint32_t width, uint32_t height,
+                                std::vector<InferenceRegion>& regions);
+
+    /**
+     * @brief 解析一批推理输出
+     * @param outputs 输出张量（前 batchSize 个批元素有效）
+     * @param batchBegin 本批首个区域在 regions 中的下标
+     * @param batchSize 本批区域数
+     * @param regions 本帧全部区域
+     * @param metadata 结果元数据
+     */
+    virtual bool postprocess(const std::vector<Tensor>& outputs,
+                             size_t batchBegin, size_t batchSize,
+                             const std::vector<InferenceRegion>& regions,
+                             std::unordered_map<std::string, std::any>& metadata) = 0;
+
+    /**
+     * @brief 模型加载完成（可在此读取张量描述、准备后处理缓冲）
+     */
+    virtual void onModelLoaded() {}
+
+    // ==========================================================================
+    // 辅助方法
+    // ==========================================================================
+
+    /**
+     * @brief 将源图像区域缩放写入输入张量的第 batchIndex 个批元素
+     */
+    bool fillImageTensor(Tensor& tensor, size_t batchIndex,
+                         const uint8_t* rgba, uint32_t width, uint32_t height,
+                         uint32_t stride, const InferenceRegion& region);
+
+    /**
+     * @brief 输入张量（模型加载后有效，子类可直接填充非图像输入）
+     */
+    std::vector<Tensor>& inputTensors() { return mInputs; }
+
+private:
+    bool ensureModelLoaded();
+    void rebuildLut(const TensorDesc& desc);
+
+    // 模型
+    std::string mBackendName;
+    std::string mModelPath;
+    InferenceOptions mOptions;
+    InferenceBackendPtr mBackend;
+    bool mModelLoaded = false;
+    bool mLoadFailed = false;           // 加载失败后不再每帧重试，重新 setModel 时复位
+    mutable std::mutex mModelMutex;
+
+    // 张量（跨帧复用）
+    std::vector<Tensor> mInputs;
+    std::vector<Tensor> mOutputs;
+    uint32_t mBatchCapacity = 1;
+
+    // 预处理
+    TensorPreprocess mPreprocess;
+    std::vector<uint8_t> mLut;          // [通道][像素值] -> 张量元素（按输入张量类型存放）
+    bool mLutDirty = true;
+    std::vector<InferenceRegion> mRegions;
+    std::vector<int32_t> mColumnMap;    // 张量列 -> 源列（每个区域重算）
+
+    uint64_t mLastInferenceTimeUs = 0;
+
+    // 检测间隔：跳过的帧复制上次推理写入的元数据
+    std::atomic<uint32_t> mInferenceInterval{1};
+    uint64_t mFramesSinceInference = 0;
+    std::unordered_map<std::string, std::any> mLastResults;
+    std::atomic<uint32_t> mDemandPhase{0};  // 已应答 wantsInput 的帧数（帧开始时按帧序递增）
+};
+
+} // namespace pipeline
@@ -10,6 +10,7 @@
 
 #include "pipeline/entity/ProcessEntity.h"
 #include "pipeline/input/FrameSynchronizer.h"
+#include "pipeline/data/MetadataKey.h"
 #include <memory>
 
 namespace pipeline {
@@ -27,6 +28,12 @@ static constexpr const char* MERGE_CPU_INPUT_PORT = "cpu_in";
 /// 合并后输出端口名称
 static constexpr const char* MERGE_OUTPUT_PORT = "merged_out";
 
+/// 合并包引用的 GPU 路原始帧包（其元数据原样可读，不复制）
+inline const MetadataKey<FramePacketPtr> kMergedGPUSourceKey{"merged_gpu_source"};
+
+/// 合并包引用的 CPU 路原始帧包（检测结果等元数据从这里读取）
+inline const MetadataKey<FramePacketPtr> kMergedCPUSourceKey{"merged_cpu_source"};
+
 // =============================================================================
 // 合并策略
 // =============================================================================
@@ -38,7 +45,8 @@ enum class MergeStrategy : uint8_t {
     WaitBoth,       ///< 等待双路都完成
     GPUPriority,    ///< GPU 优先，CPU 可选
     CPUPriority,    ///< CPU 优先，GPU 可选
-    Latest          ///< 使用最新到达的数据
+    Latest,         ///< 使用最新到达的数据
+    LatestSideData  ///< GPU 路不等待 CPU 路，附带最近一次完成的 CPU 结果
 };
 
 /**
@@ -48,8 +56,9 @@ struct MergeConfig {
     MergeStrategy strategy = MergeStrategy::WaitBoth;
     int64_t maxWaitTimeMs = 33;         ///< 最大等待时间（毫秒）
     int64_t timestampToleranceUs = 1000; ///< 时间戳容差（微秒）
-    bool copyGPUData = true;            ///< 是否拷贝 GPU 数据
-    bool copyCPUData = true;            ///< 是否拷贝 CPU 数据
+    bool copyGPUData = false;           ///< 是否拷贝 GPU 数据（暂不支持：纹理拷贝需 LREngine blit，开启后仍共享纹理并告警一次）
+    bool copyCPUData = false;           ///< 是否拷贝 CPU 数据（默认共享缓冲；生产者会复用缓冲时开启）
+    int64_t maxSideDataAgeUs = -1;      ///< LatestSideData：CPU 结果最大年龄（微秒），-1 表示不限
 };
 
 // =============================================================================
@@ -65,6 +74,8 @@ struct MergedFrame {
     int64_t timestamp = 0;      ///< 时间戳
     bool hasGPU = false;        ///< 是否有 GPU 数据
     bool hasCPU = false;        ///< 是否有 CPU 数据
+    int64_t cpuAgeUs = 0;       ///< CPU 结果相对本帧的年龄（微秒，LatestSideData）
+    uint64_t cpuAgeFrames = 0;  ///< CPU 结果落后的帧数（LatestSideData）
 };
 
 using MergedFramePtr = std::shared_ptr<MergedFrame>;
@@ -90,6 +101,15 @@ using MergedFramePtr = std::shared_ptr<MergedFrame>;
  * pipeline->connect(cpuEntity, "output", mergeEntity, MERGE_CPU_INPUT_PORT);
  * pipeline->connect(mergeEntity, MERGE_OUTPUT_PORT, outputEntity, "input");
  * @endcode
+ * 
+ * LatestSideData 策略下 CPU 端口为延迟输入：执行器不再让本Entity等待 CPU 分支，
+ * CPU 分支完成时把结果投递进来，每帧 GPU 结果到达即合并最近一次的 CPU 结果，
+ * 其年龄写入元数据 "cpuAgeUs" / "cpuAgeFrames"。CPU 分支仍在处理旧帧时，
+ * 新帧的 CPU 分支直接跳过，不在帧序上堆积。
+ * 
+ * 合并不复制数据：输出包取自 FramePacketPool，共享 GPU 结果的纹理与栅栏、
+ * CPU 结果的缓冲，两路原始帧包经 kMergedGPUSourceKey / kMergedCPUSourceKey 引用。
+ * 原始包随合并包一同释放并归还各自的池。
  */
 class MergeEntity : public ProcessEntity {
 public:
@@ -109,6 +129,10 @@ public:
     
     ExecutionQueue getExecutionQueue() const override { return ExecutionQueue::GPU; }
     
+    bool isInputDeferred(size_t port) const override;
+    
+    void onDeferredInput(size_t port, FramePacketPtr packet) override;
+    
     // ==========================================================================
     // 配置
     // ==========================================================================
@@ -197,8 +221,11 @@ private:
     void processGPUInput(FramePacketPtr packet);
     void processCPUInput(FramePacketPtr packet);
     
-    // 创建合并后的输出包
-    FramePacketPtr createMergedPacket(const MergedFrame& frame);
+    // LatestSideData：GPU 结果 + 最近一次 CPU 结果
+    bool mergeLatestSideData(const std::vector<FramePacketPtr>& inputs, MergedFrame& merged);
+    
+    // 创建合并后的输出包（引用两路数据，不复制）
+    FramePacketPtr createMergedPacket(const MergedFrame& frame, PipelineContext& context);
     
 private:
     // 配置
@@ -216,6 +243,12 @@ private:
     uint64_t mCPUFrameCount = 0;
     uint64_t mDroppedFrameCount = 0;
     
+    // copyGPUData 暂不支持，只告警一次
+    bool mCopyGPUWarned = false;
+    
+    // 最近一次完成的 CPU 结果（LatestSideData，mMergeMutex 保护）
+    FramePacketPtr mLatestCPUResult;
+    
     // 线程安全
     mutable std::mutex mMergeMutex;
     
@@ -7,6 +7,7 @@
 
 #include "pipeline/data/EntityTypes.h"
 #include "pipeline/data/FramePort.h"
+#include "pipeline/entity/EntityAwait.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -19,6 +20,7 @@ namespace pipeline {
 
 // 前向声明
 class PipelineContext;
+struct QualitySettings;
 
 /**
  * @brief Entity配置参数
@@ -26,6 +28,8 @@ class PipelineContext;
 struct EntityConfig {
     std::string name;                          // Entity名称
     bool enabled = true;                       // 是否启用
+    bool optional = false;                     // 是否可降级（延迟预算不足时跳过）
+    ExecutionLane lane = ExecutionLane::Inherit; // 调度通道
     int32_t priority = 0;                      // 执行优先级
     std::unordered_map<std::string, std::any> params; // 自定义参数
 };
@@ -138,6 +142,156 @@ public:
      */
     void setEnabled(bool enabled) { mEnabled.store(enabled); }
     
+    /**
+     * @brief 检查是否可降级
+     * 
+     * 可降级Entity（如美颜、滤镜）在帧可能错过显示时限时可被执行器跳过，
+     * 此时输入按端口顺序直通到输出。
+     */
+    bool isOptional() const { return mOptional.load(); }
+    
+    /**
+     * @brief 设置是否可降级
+     */
+    void setOptional(bool optional) { mOptional.store(optional); }
+    
+    /**
+     * @brief 是否只处理输入的感兴趣区域
+     * 
+     * 局部效果（磨皮、锐化等）开启后，输入帧包带ROI时只处理该区域，区域外与输入一致；
+     * 工作量随ROI面积缩小。全帧变换（缩放、调色、几何变换）不应开启。
+     */
+    bool isRoiLimited() const { return mRoiLimited.load(std::memory_order_relaxed); }
+    
+    void setRoiLimited(bool limited) { mRoiLimited.store(limited, std::memory_order_relaxed); }
+    
+    /**
+     * @brief 加载CPU侧资源（模型文件、LUT解析等，调用 onLoadResources）
+     * 
+     * 由 PipelineManager::start() 调用：分阶段启动时在CPU线程上与着色器预热并行，
+     * 否则在调用线程依次执行；运行中才加入图的Entity在首次执行时同步加载。
+     * 加载成功后再次调用直接返回true。
+     * @return 是否成功
+     */
+    bool loadResources();
+    
+    /**
+     * @brief 标记资源待加载（未加载过时在加载完成前 areResourcesReady 返回false）
+     */
+    void markResourcesPending();
+    
+    /**
+     * @brief 资源是否已就绪
+     * 
+     * 可降级Entity在资源就绪前被执行器旁路，加载完成后从下一帧起加入处理。
+     */
+    bool areResourcesReady() const { return mResourcesReady.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 获取调度通道
+     */
+    ExecutionLane getExecutionLane() const { return mLane.load(); }
+    
+    /**
+     * @brief 设置调度通道
+     * 
+     * 通常只需在输出节点上设置（如显示为Realtime、编码为Throughput），
+     * 上游Entity默认继承所服务分支中最高的通道。执行计划重新编译后生效。
+     */
+    void setExecutionLane(ExecutionLane lane) { mLane.store(lane); }
+
+    /**
+     * @brief 输入端口是否为延迟输入
+     *
+     * 延迟输入不构成帧内依赖：本Entity不等待其来源，执行时该端口输入为空；
+     * 来源在本帧完成后经 onDeferredInput 投递结果。执行计划重新编译后生效。
+     * @param port 输入端口索引
+     */
+    virtual bool isInputDeferred(size_t port) const { return false; }
+
+    /**
+     * @brief 接收延迟输入（来源Entity所在线程调用，可能与 process 并发）
+     * @param port 输入端口索引
+     * @param packet 来源的输出数据包
+     */
+    virtual void onDeferredInput(size_t port, FramePacketPtr packet) {}
+
+    /**
+     * @brief 本Entity的输出是否需要全分辨率帧
+     *
+     * 启用代理分辨率预览时，执行器在每帧开始前询问计划内所有Entity：
+     * 任一返回true（如正在录制的编码目标）则本帧以全分辨率执行，否则按代理比例执行。
+     * 可在调度线程调用，实现需线程安全。
+     */
+    virtual bool requiresFullResolution() const { return false; }
+
+    /**
+     * @brief 质量档位变化（自适应质量降档/升档时由管线调用）
+     *
+     * 子类按需调整自身参数（模糊半径、检测间隔、LUT 精度等），下一帧起生效。
+     * 可能与 process 并发调用，实现需线程安全。
+     */
+    virtual void onQualityChanged(const QualitySettings& settings) {}
+
+    /**
+     * @brief 下一帧是否读取该输入端口
+     *
+     * 启用按需产出（ExecutorConfig::enableLazyOutputs）时，执行器在每帧开始时按帧序
+     * 对计划内每个输入端口询问一次：某个输出的全部消费者都返回false，其生产者本帧就省略
+     * 该输出的图像数据（FramePacket::isPayloadElided），返回false的一方须能处理这样的帧包。
+     * 默认总是读取。在调度线程调用，可能与 process 并发，实现需线程安全。
+     * @param port 输入端口索引
+     */
+    virtual bool wantsInput(size_t port) { return true; }
+
+    /**
+     * @brief 本帧各输出端口是否有消费者（位 k 对应端口 k，执行器在 process 前写入）
+     *
+     * 未启用按需产出时全部为1。生产者据此跳过无人读取的格式转换/上传。
+     */
+    void setOutputDemand(uint64_t mask) { mOutputDemand.store(mask, std::memory_order_relaxed); }
+    bool isOutputDemanded(size_t port) const {
+        return port >= 64 || ((mOutputDemand.load(std::memory_order_relaxed) >> port) & 1) != 0;
+    }
+
+    // ==========================================================================
+    // 格式协商
+    // ==========================================================================
+
+    /**
+     * @brief 输入端口可接受的像素格式
+     *
+     * 执行器编译计划时，对每个可协商的输出取其全部消费者可接受格式的交集，选出生产者
+     * 候选格式中第一个落在交集内的格式；转换因此推迟到第一个不接受原格式的节点之前。
+     * 显式设置过的端口以设置为准，否则由 getDefaultAcceptedInputFormats 决定。
+     */
+    PixelFormatSet getAcceptedInputFormats(size_t port) const;
+
+    /**
+     * @brief 限定输入端口的格式（如 LUT 只接受 RGBA16F/RGB10A2 以保留精度），在搭建图时设置
+     */
+    void setAcceptedInputFormats(size_t port, PixelFormatSet formats);
+
+    /**
+     * @brief 输出端口的候选格式（按偏好排序，为空表示格式固定、不参与协商）
+     *
+     * 在编译计划的线程调用，可能与 process 并发。
+     */
+    virtual std::vector<PixelFormat> getOutputFormatCandidates(size_t port) const { return {}; }
+
+    /**
+     * @brief 协商出的输出格式（字节 k 对应端口 k，执行器在 process 前写入）
+     *
+     * 未参与协商或端口序号不小于8时为 PixelFormat::Unknown，生产者按自身配置输出。
+     */
+    void setNegotiatedOutputFormats(uint64_t packed) { mNegotiatedFormats.store(packed, std::memory_order_relaxed); }
+    PixelFormat getNegotiatedOutputFormat(size_t port) const {
+        if (port >= 8) {
+            return PixelFormat::Unknown;
+        }
+        return static_cast<PixelFormat>((mNegotiatedFormats.load(std::memory_order_relaxed) >> (port * 8)) & 0xFF);
+    }
+
     // ==========================================================================
     // 端口管理
     // ==========================================================================
@@ -200,6 +354,14 @@ public:
      */
     const std::vector<std::unique_ptr<OutputPort>>& getOutputPorts() const { return mOutputPorts; }
     
+    /**
+     * @brief 释放端口持有的帧包引用
+     * 
+     * 执行器以绑定输入执行并收集输出后调用，帧包生命周期改由执行计划管理，
+     * 中间结果（及其纹理）在最后一个消费者结束后即可归还池中。
+     */
+    void releasePortPackets();
+    
     // ==========================================================================
     // 依赖管理
     // ==========================================================================
@@ -240,6 +402,63 @@ public:
      */
     bool execute(PipelineContext& context);
     
+    /**
+     * @brief 使用指定输入执行Entity（帧流水线模式）
+     * 
+     * 与execute(context)流程一致，但输入数据包由调用方按输入端口顺序给出，
+     * 不再从InputPort读取。多帧在途时，端口中的数据可能已被后续帧覆盖，
+     * 执行器通过此接口把属于当前帧的数据包直接交给Entity。
+     * 
+     * @param context 管线上下文
+     * @param inputs 输入数据包（与输入端口一一对应，未连接端口可为空）
+     * @return 是否执行成功
+     */
+    bool execute(PipelineContext& context, const std::vector<FramePacketPtr>& inputs);
+    
+    /**
+     * @brief 可挂起的执行（执行器异步任务链使用）
+     * 
+     * 与execute(context, inputs)相同，但process()登记了等待时不在当前线程等待：
+     * 返回true且hasPendingAwait()为真，端口、finalize与发送都推迟到最后一个续体完成之后。
+     * 调用方取走等待（takePendingAwait），等待完成后在其resumeQueue上调用resumeAwait。
+     */
+    bool executeAsync(PipelineContext& context, const std::vector<FramePacketPtr>& inputs);
+    
+    /**
+     * @brief 上一次执行或续体是否登记了尚未完成的等待
+     */
+    bool hasPendingAwait() const { return mPendingAwait != nullptr; }
+    
+    /**
+     * @brief 取走登记的等待（之后hasPendingAwait()为假）
+     */
+    EntityAwaitPtr takePendingAwait() { return std::move(mPendingAwait); }
+    
+    /**
+     * @brief 等待完成后执行其续体
+     * 
+     * 续体可再次登记等待（返回true且hasPendingAwait()为真）；否则其输出写入端口并完成本次执行。
+     * @param await 已完成的等待
+     * @param context 管线上下文
+     * @return 续体是否成功
+     */
+    bool resumeAwait(EntityAwait& await, PipelineContext& context);
+    
+    /**
+     * @brief 批处理开始
+     * 
+     * 执行器批量模式下，本Entity在其队列上连续处理批内各帧前调用。
+     * 子类可在此建立跨帧复用的状态（如GPU绑定），默认无操作。
+     * @param context 管线上下文
+     * @param frameCount 批内帧数
+     */
+    virtual void beginBatch(PipelineContext& context, size_t frameCount) {}
+    
+    /**
+     * @brief 批处理结束（与beginBatch成对调用）
+     */
+    virtual void endBatch(PipelineContext& context) {}
+    
     /**
      * @brief 取消执行
      */
@@ -335,6 +554,22 @@ protected:
     // 子类实现接口
     // ==========================================================================
     
+    /**
+     * @brief 锁存本帧参数（每次执行开始时调用一次，早于prepare）
+     * 
+     * 使用 ParameterBlock 的子类在此 acquire，本帧内只读取锁存的值。
+     */
+    virtual void latchParameters() {}
+    
+    /**
+     * @brief 加载CPU侧资源（子类实现）
+     * 
+     * 在CPU工作线程上调用，可能与其他Entity的加载及GPU队列上的预热并发；
+     * 不得访问GPU上下文，需要的纹理等在 prepare() 中由已加载的数据创建。
+     * @return 是否成功
+     */
+    virtual bool onLoadResources() { return true; }
+    
     /**
      * @brief 准备阶段（获取资源、初始化）
      * @param context 管线上下文
@@ -372,6 +607,38 @@ protected:
      */
     virtual void onStateChanged(EntityState oldState, EntityState newState) {}
     
+    // ==========================================================================
+    // 异步等待（在process()或续体中调用，每次至多登记一个）
+    // ==========================================================================
+    
+    /**
+     * @brief 等待GPU栅栏后执行续体
+     * 
+     * 登记后process()应直接返回true，其outputs不再使用，本帧输出由最后一个续体给出。
+     * @param fence 栅栏（为空时续体立即可执行）
+     * @param next 续体
+     * @param resumeOn 续体所在队列（默认本Entity的执行队列）
+     */
+    void awaitFence(GpuFencePtr fence, EntityContinuation next);
+    void awaitFence(GpuFencePtr fence, EntityContinuation next, ExecutionQueue resumeOn);
+    
+    /**
+     * @brief 等待读回结果（成功或失败）后执行续体，续体中通过request取数据
+     */
+    void awaitReadback(ReadbackRequestPtr request, EntityContinuation next);
+    void awaitReadback(ReadbackRequestPtr request, EntityContinuation next, ExecutionQueue resumeOn);
+    
+    /**
+     * @brief 在CPU并行队列上执行子任务，完成后执行续体
+     */
+    void awaitTask(std::function<void()> task, EntityContinuation next);
+    void awaitTask(std::function<void()> task, EntityContinuation next, ExecutionQueue resumeOn);
+    
+    /**
+     * @brief 未显式设置时输入端口接受的格式（默认不限）
+     */
+    virtual PixelFormatSet getDefaultAcceptedInputFormats(size_t port) const { return kAnyPixelFormat; }
+    
     // ==========================================================================
     // 辅助方法
     // ==========================================================================
@@ -406,6 +673,35 @@ protected:
      */
     void sendOutputs();
     
+private:
+    /**
+     * @brief 执行流程实现
+     * @param boundInputs 外部绑定的输入（为空时从InputPort收集）
+     */
+    bool executeInternal(PipelineContext& context,
+                         const std::vector<FramePacketPtr>* boundInputs,
+                         bool allowSuspend = false);
+    
+    /**
+     * @brief 登记等待（已有未完成的等待时报错并替换）
+     */
+    void registerAwait(EntityAwaitPtr await);
+    
+    /**
+     * @brief 输出写入端口、finalize并发送
+     */
+    void completeExecution(std::vector<FramePacketPtr>& outputs, PipelineContext& context);
+    
+    /**
+     * @brief 累计处理耗时（续体的耗时计入同一次执行，不增加次数）
+     */
+    void recordProcessDuration(int64_t durationUs, bool newExecution);
+    
+    /**
+     * @brief 检查外部绑定的输入是否满足所有已连接端口
+     */
+    bool areBoundInputsReady(const std::vector<FramePacketPtr>& inputs) const;
+    
 private:
     // 身份信息
     EntityId mId;
@@ -415,12 +711,24 @@ private:
     // 状态
     std::atomic<EntityState> mState{EntityState::Idle};
     std::atomic<bool> mEnabled{true};
+    std::atomic<bool> mOptional{false};
+    std::atomic<bool> mRoiLimited{false};
+    std::atomic<bool> mResourcesReady{true};
+    std::atomic<bool> mResourcesLoaded{false};
+    std::mutex mResourceLoadMutex;
+    std::atomic<ExecutionLane> mLane{ExecutionLane::Inherit};
     std::atomic<bool> mCancelled{false};
+    std::atomic<uint64_t> mOutputDemand{~uint64_t(0)};
+    std::atomic<uint64_t> mNegotiatedFormats{0};
     std::string mErrorMessage;
     
     // 端口
     std::vector<std::unique_ptr<InputPort>> mInputPorts;
     std::vector<std::unique_ptr<OutputPort>> mOutputPorts;
+    std::vector<PixelFormatSet> mAcceptedInputFormats;      // 按端口，0表示未设置
+    
+    // 异步等待：同一Entity按帧序串行执行，挂起期间不会被下一帧重入
+    EntityAwaitPtr mPendingAwait;
     mutable std::mutex mPortsMutex;
     
     // 参数
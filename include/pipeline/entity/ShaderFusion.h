@@ -0,0 +1,62 @@
+/**
+ * @file ShaderFusion.h
+ * @brief 着色器融合 - 相邻逐像素GPU Entity合并为一次全屏绘制
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pipeline {
+
+class GPUEntity;
+
+/**
+ * @brief 逐像素着色器片段
+ *
+ * 逐像素GPU Entity（颜色矩阵、LUT、亮度/对比度等，只读取当前像素）以片段形式描述自身效果，
+ * 融合时多个片段按链顺序串接进同一个片段着色器（GLSL ES 3.00）。
+ *
+ * 片段中的 `$` 是名字前缀占位符，融合时替换为每个成员唯一的前缀（如 `f0_`），
+ * 避免不同成员的 uniform / 函数重名：
+ * @code
+ * snippet.declarations = "uniform float $intensity;\n";
+ * snippet.body = "return vec4(color.rgb * $intensity, color.a);";
+ * @endcode
+ * body 是函数 `vec4 $apply(vec4 color, vec2 uv)` 的函数体，
+ * color 为上一成员的输出，uv 为当前纹理坐标。
+ */
+struct PixelShaderSnippet {
+    std::string declarations;       ///< uniform、sampler 与辅助函数
+    std::string body;               ///< $apply 的函数体
+};
+
+/**
+ * @brief 着色器融合链（编译执行计划时生成，随计划共享）
+ *
+ * 链首正常执行并一次绘制整条链；其余成员在执行器中直通输入，
+ * 不再分配中间渲染目标。
+ */
+struct ShaderFusionChain {
+    uint64_t id = 0;                        ///< 全局唯一，区分不同计划生成的链
+    uint32_t headIndex = UINT32_MAX;        ///< 链首在执行计划中的索引
+    std::vector<GPUEntity*> members;        ///< 按执行顺序（members[0] 为链首）
+};
+
+/**
+ * @brief 成员 i 的名字前缀
+ */
+std::string getFusionPrefix(size_t memberIndex);
+
+/**
+ * @brief 生成融合后的片段着色器
+ * @param snippets 按链顺序的片段（与 prefixes 一一对应）
+ * @param prefixes 各片段使用的名字前缀
+ * @return GLSL ES 3.00 片段着色器源码；输入纹理为 uTexture（纹理单元0）
+ */
+std::string buildFusedFragmentShader(const std::vector<PixelShaderSnippet>& snippets,
+                                     const std::vector<std::string>& prefixes);
+
+} // namespace pipeline
@@ -0,0 +1,83 @@
+/**
+ * @file ClockDomain.h
+ * @brief 时钟域 - 把各路输入的采集时间戳换算到统一的主机单调时钟
+ *
+ * 前后摄等多路输入的时间戳可能来自不同时基（传感器时钟、媒体时钟），不能直接比较。
+ * 每路输入在提交时记录 (源时间戳, 主机收到时间)，二者之差在最近一段窗口内的最小值
+ * 对应传输延迟最小的一帧，取它作为时钟偏移：源时间戳加上偏移即落到主机时钟上。
+ */
+
+#pragma once
+
+#include "pipeline/data/EntityTypes.h"
+#include "pipeline/data/MetadataKey.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace pipeline {
+namespace input {
+
+/**
+ * @brief 输入帧的时钟戳（InputEntity 写入帧包元数据）
+ */
+struct SourceClockStamp {
+    EntityId source = InvalidEntityId;  ///< 产出该帧的 InputEntity
+    int64_t sourceTimestampUs = 0;      ///< 源时钟上的采集时间戳
+    int64_t hostTimeUs = 0;             ///< 换算到主机单调时钟的采集时间
+};
+
+/// 帧包上的时钟戳
+inline const MetadataKey<SourceClockStamp> kSourceClockKey{"source_clock"};
+
+/**
+ * @brief 单路输入的时钟映射
+ *
+ * observe 只在提交线程调用；toHostUs 可在任意线程调用。
+ */
+class ClockDomain {
+public:
+    /// 偏移估计窗口（帧数）：足以覆盖偶发的调度抖动，又能跟上时钟漂移
+    static constexpr size_t kWindowSize = 32;
+    
+    /**
+     * @brief 记录一次提交
+     * @param sourceUs 源时间戳（微秒）
+     * @param hostUs 提交时的主机时间（hostNowUs）
+     */
+    void observe(int64_t sourceUs, int64_t hostUs);
+    
+    /**
+     * @brief 是否已有偏移估计
+     */
+    bool isCalibrated() const { return mCalibrated.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 源时间戳换算到主机时钟（尚未校准时原样返回）
+     */
+    int64_t toHostUs(int64_t sourceUs) const {
+        return sourceUs + mOffsetUs.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief 清空估计（输入停止后调用，不与 observe 并发）
+     */
+    void reset();
+    
+    /**
+     * @brief 主机单调时钟（微秒）
+     */
+    static int64_t hostNowUs();
+    
+private:
+    std::array<int64_t, kWindowSize> mOffsets{};
+    size_t mCount = 0;
+    size_t mNext = 0;
+    
+    std::atomic<int64_t> mOffsetUs{0};
+    std::atomic<bool> mCalibrated{false};
+};
+
+} // namespace input
+} // namespace pipeline
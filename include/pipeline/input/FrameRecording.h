@@ -0,0 +1,215 @@
+/**
+ * @file FrameRecording.h
+ * @brief 输入录制与确定性回放 - 复现线上慢帧、在同一负载上对比不同构建的性能
+ *
+ * - FrameRecorder：InputEntity 调试模式下把提交的 CPU 帧（各平面紧密排列）、时间戳与
+ *   参数修改顺序写入内存映射文件，提交线程上只有一次逐行拷贝。
+ * - FrameRecordingReader：映射录制文件，readFrame 零拷贝地还原 InputData。
+ * - FrameReplayer：按原始节奏或最快速度把录制重新提交给 InputEntity，
+ *   参数修改在录制时所处的帧之前重新应用。
+ *
+ * 文件布局（本机字节序）：文件头，随后是按 8 字节对齐的记录（帧 / 参数）。
+ * GPU 纹理输入无法录制，只计入 getSkippedFrameCount。
+ */
+
+#pragma once
+
+#include "pipeline/input/InputEntity.h"
+
+#include <any>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pipeline {
+namespace input {
+
+/**
+ * @brief 录制中的一次参数修改
+ */
+struct RecordedParameter {
+    uint64_t frameIndex = 0;        ///< 修改发生前已录制的帧数（回放时在该帧之前应用）
+    std::string entityName;
+    std::string key;
+    std::any value;                 ///< 按录制时的类型还原（bool/int32/uint32/int64/float/double/string）
+};
+
+// =============================================================================
+// FrameRecorder
+// =============================================================================
+
+/**
+ * @brief 输入录制器（线程安全：帧与参数可能来自不同线程，按到达顺序写入）
+ */
+class FrameRecorder {
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * @brief 创建录制文件（已存在则覆盖）
+     * @param path 文件路径
+     * @param config 输入配置（写入文件头，回放时据此配置 InputEntity）
+     */
+    bool open(const std::string& path, const InputConfig& config);
+
+    /**
+     * @brief 结束录制：截断到实际长度并解除映射
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @brief 录制一帧（仅 CPU 数据；平面按行紧密拷贝，不要求输入连续）
+     */
+    bool recordFrame(const InputData& data);
+
+    /**
+     * @brief 录制一次参数修改（不支持的值类型忽略并返回 false）
+     */
+    bool recordParameter(const std::string& entityName, const std::string& key, const std::any& value);
+
+    uint64_t getFrameCount() const;
+    uint64_t getSkippedFrameCount() const;
+    uint64_t getBytesWritten() const;
+
+private:
+    struct Writer;
+
+    // 追加一条记录：header 与 payload 连续写入，末尾补齐到 8 字节
+    bool appendRecord(uint32_t type, const std::vector<std::pair<const void*, size_t>>& parts);
+
+    mutable std::mutex mMutex;
+    std::unique_ptr<Writer> mWriter;
+    uint64_t mFrameCount = 0;
+    uint64_t mSkippedFrames = 0;
+};
+
+using FrameRecorderPtr = std::shared_ptr<FrameRecorder>;
+
+// =============================================================================
+// FrameRecordingReader
+// =============================================================================
+
+/**
+ * @brief 录制文件读取器（打开后只读，可在多个线程读取）
+ */
+class FrameRecordingReader {
+public:
+    FrameRecordingReader() = default;
+    ~FrameRecordingReader();
+
+    FrameRecordingReader(const FrameRecordingReader&) = delete;
+    FrameRecordingReader& operator=(const FrameRecordingReader&) = delete;
+
+    /**
+     * @brief 打开录制文件并建立帧索引（截断的末尾记录忽略）
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    bool isOpen() const { return mMapping != nullptr; }
+
+    /**
+     * @brief 录制时的输入配置
+     */
+    const InputConfig& getInputConfig() const { return mConfig; }
+
+    uint64_t getFrameCount() const { return mFrames.size(); }
+
+    /**
+     * @brief 读取第 index 帧（零拷贝，platformBufferHolder 持有映射）
+     * @param frame 输出；时间戳与录制时一致，hostTimeUs 为录制时的提交时间
+     */
+    bool readFrame(uint64_t index, InputData& frame) const;
+
+    /**
+     * @brief 全部参数修改（按录制顺序）
+     */
+    const std::vector<RecordedParameter>& getParameters() const { return mParameters; }
+
+private:
+    struct Mapping;
+
+    std::shared_ptr<Mapping> mMapping;
+    InputConfig mConfig;
+    std::vector<size_t> mFrames;    // 各帧记录的载荷偏移
+    std::vector<RecordedParameter> mParameters;
+};
+
+// =============================================================================
+// FrameReplayer
+// =============================================================================
+
+/**
+ * @brief 回放速度
+ */
+enum class ReplaySpeed : uint8_t {
+    Original,   ///< 按录制时的提交间隔
+    Max         ///< 不等待，尽快提交
+};
+
+/**
+ * @brief 回放选项
+ */
+struct ReplayOptions {
+    ReplaySpeed speed = ReplaySpeed::Original;
+
+    /// 最快速度下等待输入队列有空位再提交，每帧都被处理（对比构建时应开启）
+    bool lossless = true;
+
+    /// 回放次数；多次时后一轮的时间戳顺延，保持单调
+    uint32_t loops = 1;
+
+    /// 参数修改回调（为空则忽略），如：
+    /// manager->getEntityByName(p.entityName)->setParameter(p.key, p.value)
+    std::function<void(const RecordedParameter&)> onParameter;
+};
+
+/**
+ * @brief 录制回放器
+ *
+ * @code
+ * FrameRecordingReader reader;
+ * reader.open("/sdcard/slow_case.plrec");
+ * inputEntity->configure(reader.getInputConfig());
+ * FrameReplayer replayer(reader);
+ * ReplayOptions options;
+ * options.speed = ReplaySpeed::Max;
+ * replayer.replay(*inputEntity, options);
+ * @endcode
+ */
+class FrameReplayer {
+public:
+    explicit FrameReplayer(const FrameRecordingReader& reader) : mReader(reader) {}
+
+    /**
+     * @brief 在调用线程上回放（阻塞至结束或 stop）
+     * @return 成功提交的帧数
+     */
+    uint64_t replay(InputEntity& input, const ReplayOptions& options);
+
+    /**
+     * @brief 请求停止正在进行的回放（可在任意线程调用）
+     */
+    void stop() { mStopRequested.store(true, std::memory_order_release); }
+
+private:
+    // 等待输入队列腾出位置；停止或 InputEntity 不再运行时返回 false
+    bool waitForQueueSpace(const InputEntity& input) const;
+
+    const FrameRecordingReader& mReader;
+    std::atomic<bool> mStopRequested{false};
+};
+
+} // namespace input
+} // namespace pipeline
@@ -9,13 +9,15 @@
 #pragma once
 
 #include "pipeline/data/EntityTypes.h"
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <queue>
-#include <unordered_map>
 #include <functional>
 #include <chrono>
+#include <vector>
 
 namespace pipeline {
 namespace input {
@@ -54,7 +56,7 @@ struct FrameSyncConfig {
     SyncPolicy policy = SyncPolicy::WaitBoth;
     int64_t maxWaitTimeMs = 33;         ///< 最大等待时间（毫秒）
     int64_t timestampToleranceUs = 1000; ///< 时间戳容差（微秒）
-    size_t maxPendingFrames = 3;        ///< 最大待同步帧数
+    size_t maxPendingFrames = 3;        ///< 每路最大待同步帧数（上限为 FrameSynchronizer::kRingCapacity）
     bool enableGPU = true;              ///< 是否启用 GPU 路径
     bool enableCPU = true;              ///< 是否启用 CPU 路径
 };
@@ -64,6 +66,10 @@ struct FrameSyncConfig {
  * 
  * 基于时间戳同步 GPU 和 CPU 两路数据：
  * 
+ * 每路未配对的帧存放在按时间戳排序的定长环中，新帧只在对侧环的容差窗口内查找配对，
+ * 锁内没有整表扫描；待同步/已同步计数由原子变量维护，查询不加锁，
+ * 回调在锁外触发，两路生产者只在短暂的配对操作上竞争。
+ * 
  * @code
  * FrameSynchronizer sync;
  * sync.configure(FrameSyncConfig{
@@ -190,44 +196,84 @@ public:
      */
     void flush();
     
+    /// 每路环的固定容量
+    static constexpr size_t kRingCapacity = 8;
+    
 private:
-    // 内部帧记录
+    enum Stream : size_t { kGPU = 0, kCPU = 1, kStreamCount = 2 };
+    
+    // 单路未配对帧
     struct PendingFrame {
-        FramePacketPtr gpuFrame;
-        FramePacketPtr cpuFrame;
+        FramePacketPtr frame;
         int64_t timestamp = 0;
         std::chrono::steady_clock::time_point arrivalTime;
-        bool hasGPU = false;
-        bool hasCPU = false;
     };
     
-    // 查找匹配的时间戳
-    int64_t findMatchingTimestamp(int64_t timestamp);
+    /**
+     * @brief 按时间戳升序的定长环
+     * 
+     * 时间戳基本单调到达，插入通常落在队尾；满时淘汰最旧的一帧。
+     */
+    class TimestampRing {
+    public:
+        size_t size() const { return mCount; }
+        bool empty() const { return mCount == 0; }
+        
+        const PendingFrame& at(size_t i) const { return mSlots[(mHead + i) % kRingCapacity]; }
+        PendingFrame& at(size_t i) { return mSlots[(mHead + i) % kRingCapacity]; }
+        
+        // 插入并保持有序；capacity 为本路上限，超出时返回true并淘汰最旧一帧
+        bool insert(PendingFrame frame, size_t capacity);
+        
+        // 容差窗口内时间戳最接近的一帧，没有返回 kNotFound
+        size_t findNearest(int64_t timestamp, int64_t tolerance) const;
+        
+        PendingFrame take(size_t i);
+        void clear();
+        
+        static constexpr size_t kNotFound = static_cast<size_t>(-1);
+        
+    private:
+        std::array<PendingFrame, kRingCapacity> mSlots;
+        size_t mHead = 0;
+        size_t mCount = 0;
+    };
+    
+    using EmitList = std::vector<SyncedFramePtr>;
+    
+    // 推送一路帧（持有 mMutex），完成的同步帧追加到 emitted
+    void pushLocked(Stream stream, FramePacketPtr frame, int64_t timestamp, EmitList& emitted);
     
-    // 尝试完成同步
-    void tryComplete(int64_t timestamp);
+    // 该路帧单独到达时是否即可输出（策略或对侧未启用）
+    bool completesAlone(Stream stream) const;
     
-    // 检查超时
-    void checkTimeouts();
+    // 输出超时的未配对帧（只看各环最旧的若干帧）
+    void checkTimeouts(EmitList& emitted);
     
-    // 清理旧帧
-    void cleanupOldFrames();
+    // 生成同步帧并放入已同步队列（持有 mMutex）
+    void emitSyncedFrame(Stream stream, PendingFrame&& frame, PendingFrame* matched, EmitList& emitted);
     
-    // 发出同步帧
-    void emitSyncedFrame(const PendingFrame& frame);
+    // 锁外触发回调
+    void dispatchCallbacks(const EmitList& emitted);
+    
+    void updatePendingCountsLocked();
     
 private:
     FrameSyncConfig mConfig;
-    SyncCallback mCallback;
+    std::shared_ptr<SyncCallback> mCallback;      // 拷贝后在锁外调用
     
-    // 待同步帧（按时间戳索引）
+    // 两路未配对帧
     mutable std::mutex mMutex;
-    std::unordered_map<int64_t, PendingFrame> mPendingFrames;
+    std::array<TimestampRing, kStreamCount> mRings;
     
     // 已完成的同步帧队列
     std::queue<SyncedFramePtr> mSyncedFrames;
     std::condition_variable mSyncedCond;
     
+    // 查询用计数（锁内更新，锁外读取）
+    std::array<std::atomic<size_t>, kStreamCount> mPendingCounts{};
+    std::atomic<size_t> mSyncedCount{0};
+    
     // 统计
     uint64_t mTotalGPUFrames = 0;
     uint64_t mTotalCPUFrames = 0;
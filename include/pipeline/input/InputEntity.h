@@ -10,10 +10,15 @@
 #pragma once
 
 #include "pipeline/entity/ProcessEntity.h"
+#include "pipeline/data/ExternalImage.h"
+#include "pipeline/data/GpuFence.h"
 #include "pipeline/input/InputFormat.h"
+#include "pipeline/input/ClockDomain.h"
+#include "pipeline/utils/ParameterBlock.h"
+#include "pipeline/utils/SPSCQueue.h"
+#include <any>
 #include <memory>
 #include <functional>
-#include <queue>
 #include <condition_variable>
 
 // 前向声明 LREngine 类型
@@ -95,9 +100,16 @@ struct InputData {
     GPUInputData gpu;
     InputDataType dataType = InputDataType::CPUBuffer;
     
+    // 提交时的主机单调时间（InputEntity 填写，用于多路输入的时钟对齐）
+    int64_t hostTimeUs = 0;
+    
     // 平台特定 buffer (CVPixelBufferRef / AHardwareBuffer 等)
     void* platformBuffer = nullptr;
     
+    // 传输队列预先上传的纹理与上传完成栅栏（InputEntity 内部填写，提交方无需设置）
+    std::shared_ptr<lrengine::render::LRPlanarTexture> uploadedTexture;
+    std::shared_ptr<GpuFence> uploadFence;
+    
     // 🔥 新增：用于管理平台 buffer 的生命周期
     // 使用 shared_ptr + 自定义删除器来确保 buffer 在使用期间不被释放
     std::shared_ptr<void> platformBufferHolder;
@@ -153,6 +165,19 @@ public:
         return false;
     }
     
+    /**
+     * @brief 零拷贝导入平台原生图像（InputConfig::zeroCopyGPUImport 启用时优先调用）
+     * 
+     * 直接把相机帧映射为可采样的外部图像，不上传、不转换；
+     * 不支持时返回false，InputEntity 回退到 processToGPUPlanar。
+     * @param input 输入数据
+     * @param outputImage 输出外部图像
+     * @return 是否成功
+     */
+    virtual bool processToGPUExternal(const InputData& input, ExternalImagePtr& outputImage) {
+        return false;
+    }
+    
     /**
      * @brief 处理输入数据，生成 CPU 数据
      * @param input 输入数据
@@ -168,6 +193,14 @@ public:
                               uint32_t targetWidth = 0,
                               uint32_t targetHeight = 0) = 0;
     
+    /**
+     * @brief processToGPUPlanar 能否在传输队列线程（共享上下文）上调用
+     * 
+     * 返回true时，有传输队列的管线在提交阶段就把 CPU 帧上传好，与正在进行的渲染重叠；
+     * 此时 processToGPUPlanar 与 processToCPU 可能在两个线程上同时执行。
+     */
+    virtual bool supportsTransferUpload() const { return false; }
+    
     /**
      * @brief 释放资源
      */
@@ -255,10 +288,54 @@ public:
      */
     void setInputStrategy(InputStrategyPtr strategy);
     
+    /**
+     * @brief 设置 CPU 输出规格（可在运行中调用，下一帧生效）
+     * @param spec 所需的分辨率与格式
+     */
+    void setCPUOutputSpec(const CPUOutputSpec& spec);
+    
+    /**
+     * @brief 切换时钟角色（可在运行中调用）
+     * 
+     * 降为从属时唤醒正在等待数据的处理任务，本帧沿用上一帧输出返回。
+     */
+    void setClockRole(InputClockRole role);
+    
+    InputClockRole getClockRole() const { return mClockRole.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 本路时钟映射（源时间戳 → 主机时钟）
+     */
+    const ClockDomain& getClockDomain() const { return mClockDomain; }
+    
+    /**
+     * @brief 设置提交端帧率上限（可在运行中调用）
+     * 
+     * 超出上限的帧在 submitData 入口按时间戳直接丢弃，不进入队列，
+     * 不做格式转换、纹理上传或帧包分配。时间戳抖动在帧间隔的 1/4 以内时不影响抽帧节奏。
+     * @param fps 上限（<= 0 表示不限）
+     */
+    void setFrameRateLimit(float fps);
+    
+    float getFrameRateLimit() const;
+    
+    /**
+     * @brief 设置裁剪区域（可在任意线程调用，下一帧生效）
+     * 
+     * 区域作为ROI写入本输入的GPU与CPU输出帧包，两路输出的尺寸与坐标保持一致；
+     * 下游开启 setRoiLimited 的Entity只处理该区域，最终裁剪由输出端按ROI完成。
+     * @param rect 归一化区域（默认整幅图像表示不裁剪）
+     */
+    void setCropRect(const RoiRect& rect);
+    
+    RoiRect getCropRect() const;
+    
     // ==========================================================================
     // 数据提交接口
     // ==========================================================================
     
+    // 提交接口均不加锁、不阻塞，但只允许一个线程提交（通常为采集回调线程）
+    
     /**
      * @brief 提交 CPU 数据（如 YUV buffer）
      * @param data CPU 输入数据
@@ -276,7 +353,8 @@ public:
     /**
      * @brief 提交双路数据
      * @param data 包含CPU和GPU的输入数据
-     * @return 是否成功
+     * @return 是否成功（因帧率上限被抽掉的帧同样返回 true，计入 getRateLimitedFrameCount；
+     *         在传输队列上传时入队是异步的，同样返回 true，队列满的丢帧计入丢帧统计）
      */
     bool submitData(const InputData& data);
         
@@ -297,7 +375,7 @@ public:
      * @brief 启动处理循环
      * 
      * 将InputEntity的process任务投递到TaskQueue，
-     * 进入等待数据状态。
+     * 进入等待数据状态。从属输入只开始接收数据，由主时钟所在的帧驱动执行。
      */
     void startProcessingLoop();
         
@@ -365,6 +443,54 @@ public:
      */
     uint64_t getFrameCount() const { return mFrameCount; }
     
+    /**
+     * @brief 获取因队列满或被新帧覆盖而丢弃的输入帧数
+     */
+    uint64_t getDroppedFrameCount() const { return mDroppedFrameCount.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 获取因帧率上限在提交端抽掉的帧数（不计入丢帧）
+     */
+    uint64_t getRateLimitedFrameCount() const { return mRateLimitedFrameCount.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 已提交、尚未被处理的输入帧数（近似值）
+     */
+    size_t getPendingInputCount() const;
+    
+    /**
+     * @brief 处理循环是否在运行（未运行时提交会被拒绝）
+     */
+    bool isProcessingLoopRunning() const { return mTaskRunning.load(std::memory_order_acquire); }
+    
+    // ==========================================================================
+    // 录制（调试）
+    // ==========================================================================
+    
+    /**
+     * @brief 开始把提交的帧录制到文件（见 FrameRecording.h，可在运行中调用）
+     * 
+     * 录制发生在帧率抽帧与入队之前，回放时这些决策会按同样的输入重新做出。
+     * 只录制 CPU 数据，每帧在提交线程上多一次逐行拷贝。
+     * @param path 录制文件路径（已存在则覆盖）
+     */
+    bool startRecording(const std::string& path);
+    
+    /**
+     * @brief 结束录制并关闭文件
+     */
+    void stopRecording();
+    
+    bool isRecording() const { return std::atomic_load(&mRecorder) != nullptr; }
+    
+    /**
+     * @brief 录制一次参数修改（未录制时忽略），回放时在同一帧之前经 ReplayOptions::onParameter 重新应用
+     * 
+     * 应用在录制期间修改任意 Entity 的参数时一并调用。
+     */
+    void recordParameterChange(const std::string& entityName, const std::string& key,
+                               const std::any& value);
+    
     /**
      * @brief 检查 GPU 输出是否启用
      */
@@ -375,11 +501,18 @@ public:
      */
     bool isCPUOutputEnabled() const;
     
+    /**
+     * @brief GPU 输出的候选格式：YUV 输入优先保持多平面纹理，下游需要 RGB 时才在上传时转换
+     */
+    std::vector<PixelFormat> getOutputFormatCandidates(size_t port) const override;
+    
 protected:
     // ==========================================================================
     // ProcessEntity 生命周期
     // ==========================================================================
     
+    void latchParameters() override;
+    
     bool prepare(PipelineContext& context) override;
     
     bool process(const std::vector<FramePacketPtr>& inputs,
@@ -395,15 +528,64 @@ private:
     // 处理提交的数据
     bool processInputData(const InputData& data);
     
+    // 从输入队列/信箱取一帧（仅处理线程）
+    bool popInput(InputData& data);
+    
+    // 放入输入队列/信箱并唤醒处理线程（同一时刻只有一个生产线程）
+    bool enqueueInput(InputData&& data);
+    
+    // 是否改由传输队列上传并入队（此时传输线程是唯一的生产线程）
+    bool shouldUploadOnTransfer() const;
+    
+    // 传输线程：上传 CPU 帧并插入栅栏（失败时该帧在处理线程被丢弃）
+    void uploadOnTransfer(InputData& data);
+    
+    // 将新增的丢帧数上报到执行器统计（仅处理线程）
+    void reportDroppedFrames();
+    
+    // 从缓冲池取一块CPU输出缓冲（容量不小于 size），作为当前帧输出
+    uint8_t* acquireCPUOutputBuffer(size_t size);
+    
+    // 提交端帧率限制：本帧是否应抽掉（只在提交线程调用）
+    bool rateLimited(int64_t timestampUs);
+    
+    // 从属输入无新帧时沿用上一帧的输出包
+    bool reuseLastOutputs(std::vector<FramePacketPtr>& outputs);
+    
+    // 给输出包打上时钟戳
+    void stampClock(const FramePacketPtr& packet, const InputData& data, int64_t timestamp) const;
+    
+    // 输入已是连续RGBA且带生命周期持有者时，直接借用输入数据作为当前帧输出
+    bool borrowCPUInput(const InputData& data);
+    
+    // 本帧是否生成该输出：已启用且有消费者读取（按需产出关闭时等同于已启用）
+    bool producesGPUOutput() const;
+    bool producesCPUOutput() const;
+    
+    // GPU 输出是否可以是多平面 YUV 纹理（未协商时沿用策略的默认行为）
+    bool allowsPlanarGPUOutput() const;
+    
     // 创建输出数据包
-    FramePacketPtr createGPUOutputPacket(int64_t timestamp);
-    FramePacketPtr createCPUOutputPacket(int64_t timestamp);
+    FramePacketPtr createGPUOutputPacket(PipelineContext& context, int64_t timestamp);
+    FramePacketPtr createCPUOutputPacket(PipelineContext& context, int64_t timestamp);
+    
+    // 本帧无人读取的输出：只带时间戳与尺寸，不含图像数据
+    FramePacketPtr createElidedPacket(PipelineContext& context, int64_t timestamp);
+    
+    // 按输出规格生成缩小/灰度输出（缩放与转换一次完成，不经过全分辨率 RGBA）
+    bool produceScaledCPUOutput(const CPUInputData& input, const CPUOutputSpec& spec);
+    
+    // 取一块临时缓冲（容量不小于 size），仅在单帧处理期间使用
+    uint8_t* acquireScratchBuffer(size_t size);
     
     // 格式转换（使用 libyuv）
     bool convertToRGBA(const CPUInputData& input, uint8_t* output);
     bool convertToYUV420P(const CPUInputData& input, uint8_t* yOut,
                           uint8_t* uOut, uint8_t* vOut);
     
+    // 基准测试直接测量格式转换（tests/bench/pipeline_bench.cpp）
+    friend struct InputEntityBenchAccess;
+    
 private:
     // 配置
     InputConfig mConfig;
@@ -419,16 +601,33 @@ private:
     
     lrengine::LRTexturePtr mGPUOutputTexture;
     std::shared_ptr<lrengine::render::LRPlanarTexture> mGPUOutputPlanarTexture;
+    ExternalImagePtr mGPUOutputExternalImage;           // 当前帧的零拷贝导入结果
+    
+    // CPU 输出缓冲区：每帧从共享缓冲池取一块，FramePacket 直接共享，不复制
+    std::shared_ptr<uint8_t> mCPUOutputBuffer;          // 当前帧的输出（可为借用的平台buffer）
+    size_t mCPUOutputSize = 0;                          // 当前帧有效数据大小
+    size_t mCPUBufferCapacity = 0;                      // 默认输出容量（width * height * 4）
+    uint32_t mCPUOutputWidth = 0;                       // 当前帧输出尺寸与格式（0 表示沿用配置）
+    uint32_t mCPUOutputHeight = 0;
+    PixelFormat mCPUOutputFormat = PixelFormat::Unknown;
+    
+    // CPU 输出规格：mCPUOutputSpec 由 mQueueMutex 保护，出队时拷贝到 mActiveCPUOutputSpec
+    CPUOutputSpec mCPUOutputSpec;
+    CPUOutputSpec mActiveCPUOutputSpec;
     
-    // CPU 输出缓冲区
-    std::vector<uint8_t> mCPUOutputBuffer;
+    // 缩放/转换的中间缓冲（如缩小后的 YUV 平面）
+    std::shared_ptr<uint8_t> mScratchBuffer;
+    size_t mScratchCapacity = 0;
     
     // ==========================================================================
     // 异步任务链数据 (新增)
     // ==========================================================================
     
-    // 输入数据队列 (线程安全)
-    std::queue<InputData> mInputQueue;
+    // 输入数据：FIFO 模式走 SPSC 环形队列，LatestOnly 模式走三缓冲信箱，均无锁
+    std::unique_ptr<SPSCQueue<InputData>> mInputQueue;
+    LatestMailbox<InputData> mInputMailbox;
+    
+    // 处理线程无数据时在此等待；提交方仅在 mWaitingForData 为 true 时加锁唤醒
     std::mutex mQueueMutex;
     std::condition_variable mDataAvailableCV;
     
@@ -436,12 +635,33 @@ private:
     std::atomic<bool> mTaskRunning{false};       // 任务是否在运行
     std::atomic<bool> mWaitingForData{false};    // 是否等待数据
     
+    // 时钟：角色可在运行中切换；偏移估计只在提交线程更新
+    std::atomic<InputClockRole> mClockRole{InputClockRole::Master};
+    ClockDomain mClockDomain;
+    
+    // 从属输入最近一次的输出（没有新帧时沿用，下游只读）
+    FramePacketPtr mLastGPUPacket;
+    FramePacketPtr mLastCPUPacket;
+    
+    // 帧率上限：间隔可在任意线程修改，抽帧节奏只在提交线程推进
+    std::atomic<int64_t> mFrameIntervalUs{0};
+    int64_t mActiveIntervalUs = 0;
+    int64_t mNextDueUs = 0;
+    bool mRateAnchored = false;
+    std::atomic<uint64_t> mRateLimitedFrameCount{0};
+    
+    // 裁剪区域（写入方任意线程，每次执行开始时锁存）
+    ParameterBlock<RoiRect> mCropRect;
+    
+    // 丢帧统计（提交线程累加，处理线程上报差值）
+    std::atomic<uint64_t> mDroppedFrameCount{0};
+    uint64_t mReportedDropCount = 0;
+    
+    // 调试录制（控制线程替换，提交线程经 atomic_load 读取）
+    std::shared_ptr<class FrameRecorder> mRecorder;
+    
     // PipelineExecutor 引用 (用于投递下游任务)
     class PipelineExecutor* mExecutor = nullptr;
-    
-    // 队列配置
-    size_t mMaxQueueSize = 3;                    // 最大队列长度
-    bool mDropOldestOnFull = true;               // 队列满时是否丢弃最旧帧
 };
 
 using InputEntityPtr = std::shared_ptr<InputEntity>;
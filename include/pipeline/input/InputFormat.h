@@ -45,6 +45,47 @@ enum class InputSourceType : uint8_t {
     Custom      // 自定义输入
 };
 
+/**
+ * @brief 输入队列模式（采集线程 -> InputEntity）
+ */
+enum class InputQueueMode : uint8_t {
+    Fifo,       // 有界FIFO，满时丢弃新帧（录制/离线处理）
+    LatestOnly  // 只保留最新一帧，未处理的旧帧被覆盖（预览）
+};
+
+/**
+ * @brief CPU 输出格式
+ */
+enum class CPUOutputFormat : uint8_t {
+    RGBA,       // RGBA 像素数据
+    Gray        // 单通道亮度（YUV 输入直接取 Y 平面，不做颜色转换）
+};
+
+/**
+ * @brief CPU 输出规格
+ *
+ * 由 CPU 路径的消费者（如人脸检测）声明所需的分辨率与格式，
+ * InputEntity 直接从输入平面一次完成缩放与转换，不再先生成全分辨率 RGBA。
+ * 宽高均为 0 时使用输入尺寸，只给出一边时按输入宽高比推算另一边。
+ */
+struct CPUOutputSpec {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    CPUOutputFormat format = CPUOutputFormat::RGBA;
+    
+    bool isDefault() const {
+        return width == 0 && height == 0 && format == CPUOutputFormat::RGBA;
+    }
+};
+
+/**
+ * @brief 多路输入时的时钟角色
+ */
+enum class InputClockRole : uint8_t {
+    Master,     ///< 主时钟：等待新帧，每帧由它开启
+    Follower    ///< 从属：不等待，按主时钟节拍取最新一帧，没有新帧时沿用上一帧
+};
+
 /**
  * @brief 输入配置
  */
@@ -55,6 +96,12 @@ struct InputConfig {
     uint32_t width = 0;
     uint32_t height = 0;
     bool enableDualOutput = false;  // 是否启用双路输出
+    CPUOutputSpec cpuOutput;        // CPU 输出规格（默认全分辨率 RGBA）
+    InputQueueMode queueMode = InputQueueMode::Fifo;
+    uint32_t queueCapacity = 3;     // FIFO 模式的队列长度
+    bool zeroCopyGPUImport = false; // GPU 路径输出零拷贝外部图像（下游需按平面采样 FramePacket::getExternalImage）
+    InputClockRole clockRole = InputClockRole::Master; // 多路输入（如前后摄画中画）时只有一路为主时钟
+    float maxFrameRate = 0.0f;      // 提交端帧率上限（按时间戳抽帧，0 表示不限）
 };
 
 } // namespace input
@@ -0,0 +1,100 @@
+/**
+ * @file RawBufferInputStrategy.h
+ * @brief 通用内存输入策略 - 把 CPU 帧上传为 GPU 纹理
+ *
+ * 没有相机与平台 buffer 的场景（Linux 渲染服务器、离线转码、单元测试）下，
+ * 输入只有内存中的 RGBA/BGRA/RGB/NV12/NV21/I420 帧。本策略在 GPU 路径把各平面直接上传到
+ * LRPlanarTexture（YUV 不经 CPU 转换，交给着色器采样），CPU 路径按目标尺寸转换为 RGBA。
+ */
+
+#pragma once
+
+#include "pipeline/input/InputEntity.h"
+
+#include <memory>
+#include <vector>
+
+namespace pipeline {
+namespace input {
+
+/**
+ * @brief 通用内存输入策略
+ *
+ * 纹理按尺寸/格式复用：仍被在途帧包引用的纹理不会被覆盖，
+ * 全部被占用时新建一张（上限 kMaxTextures，到达上限时本帧 GPU 路径失败）。
+ *
+ * 使用示例：
+ * @code
+ * auto strategy = std::make_shared<RawBufferInputStrategy>();
+ * inputEntity->setInputStrategy(strategy);
+ *
+ * RawVideoFileReader reader;
+ * reader.open("input.yuv", InputFormat::YUV420, 1920, 1080, 30.0f);
+ * InputData frame;
+ * for (uint64_t i = 0; reader.readFrame(i, frame); ++i) {
+ *     inputEntity->submitData(frame);
+ * }
+ * @endcode
+ */
+class RawBufferInputStrategy : public InputStrategy {
+public:
+    /// 同时存在的上传纹理上限（覆盖最大在途帧数）
+    static constexpr size_t kMaxTextures = 4;
+
+    RawBufferInputStrategy();
+    ~RawBufferInputStrategy() override;
+
+    // ==========================================================================
+    // InputStrategy 接口实现
+    // ==========================================================================
+
+    bool initialize(lrengine::render::LRRenderContext* context) override;
+
+    bool processToGPUPlanar(const InputData& input,
+                            std::shared_ptr<lrengine::render::LRPlanarTexture>& outputTexture) override;
+
+    bool processToCPU(const InputData& input,
+                      uint8_t* outputBuffer,
+                      size_t& outputSize,
+                      uint32_t targetWidth = 0,
+                      uint32_t targetHeight = 0) override;
+
+    void release() override;
+
+    // GPU 路径只使用自己的纹理表与中间缓冲，可以放到传输线程（共享上下文）上执行
+    bool supportsTransferUpload() const override { return true; }
+
+    const char* getName() const override { return "RawBufferInputStrategy"; }
+
+private:
+    struct UploadTexture {
+        std::shared_ptr<lrengine::render::LRPlanarTexture> texture;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        InputFormat format = InputFormat::RGBA;
+    };
+
+    // 取一张未被帧包引用、规格匹配的纹理，没有则新建
+    std::shared_ptr<lrengine::render::LRPlanarTexture> acquireTexture(uint32_t width, uint32_t height,
+                                                                      InputFormat format);
+
+    // 把输入转换为 width x height 的 RGBA（尺寸不同时先转换后缩放）
+    bool convertToRGBA(const CPUInputData& input, uint8_t* output,
+                       uint32_t width, uint32_t height);
+
+    lrengine::render::LRRenderContext* mRenderContext = nullptr;
+    std::vector<UploadTexture> mTextures;
+
+    // CPU 路径缩放前的全尺寸中间结果
+    std::vector<uint8_t> mScratch;
+
+    // GPU 路径上 RGB/BGRA 先转成的 RGBA（与 CPU 路径分开，两条路径可能不在同一线程）
+    std::vector<uint8_t> mUploadScratch;
+
+    bool mInitialized = false;
+};
+
+using RawBufferInputStrategyPtr = std::shared_ptr<RawBufferInputStrategy>;
+
+} // namespace input
+} // namespace pipeline
@@ -0,0 +1,84 @@
+/**
+ * @file RawVideoFileReader.h
+ * @brief 裸帧文件读取 - 以内存映射方式把 .rgba/.yuv/.nv12 文件逐帧交给 InputEntity
+ *
+ * 服务端批处理常以未压缩的裸帧文件作为输入。文件整体 mmap 后，readFrame 只填写
+ * 指向映射区的平面指针，不做拷贝；帧的 platformBufferHolder 持有映射，
+ * 在途帧包仍在读时 close() 也不会使映射失效。
+ */
+
+#pragma once
+
+#include "pipeline/input/InputEntity.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace pipeline {
+namespace input {
+
+/**
+ * @brief 裸帧文件读取器（非线程安全，一个实例只在一个提交线程使用）
+ */
+class RawVideoFileReader {
+public:
+    RawVideoFileReader() = default;
+    ~RawVideoFileReader();
+
+    RawVideoFileReader(const RawVideoFileReader&) = delete;
+    RawVideoFileReader& operator=(const RawVideoFileReader&) = delete;
+
+    /**
+     * @brief 打开文件
+     * @param path 文件路径
+     * @param format 帧格式（仅支持 CPU 格式，YUV 各平面紧密排列）
+     * @param width 帧宽
+     * @param height 帧高
+     * @param fps 帧率，用于生成时间戳
+     * @return 文件大小不足一帧或格式不支持时返回 false
+     */
+    bool open(const std::string& path, InputFormat format,
+              uint32_t width, uint32_t height, float fps);
+
+    void close();
+
+    bool isOpen() const { return mMapping != nullptr; }
+
+    /**
+     * @brief 完整帧数（文件末尾不足一帧的部分忽略）
+     */
+    uint64_t getFrameCount() const { return mFrameCount; }
+
+    /**
+     * @brief 单帧字节数
+     */
+    size_t getFrameSize() const { return mFrameSize; }
+
+    /**
+     * @brief 读取第 index 帧（零拷贝）
+     * @param index 帧序号
+     * @param frame 输出；时间戳为 index / fps（微秒）
+     * @return 越界或未打开时返回 false
+     */
+    bool readFrame(uint64_t index, InputData& frame) const;
+
+    /**
+     * @brief 按格式计算单帧字节数（不支持的格式返回 0）
+     */
+    static size_t frameSizeFor(InputFormat format, uint32_t width, uint32_t height);
+
+private:
+    struct Mapping;
+
+    std::shared_ptr<Mapping> mMapping;
+    InputFormat mFormat = InputFormat::RGBA;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    float mFps = 30.0f;
+    size_t mFrameSize = 0;
+    uint64_t mFrameCount = 0;
+};
+
+} // namespace input
+} // namespace pipeline
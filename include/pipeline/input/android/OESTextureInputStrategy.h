@@ -54,6 +54,8 @@ public:
     bool processToGPU(const InputData& input,
                       lrengine::LRTexturePtr& outputTexture) override;
     
+    bool processToGPUExternal(const InputData& input, ExternalImagePtr& outputImage) override;
+    
     bool processToCPU(const InputData& input,
                       uint8_t* outputBuffer,
                       size_t& outputSize,
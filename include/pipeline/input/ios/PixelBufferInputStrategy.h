@@ -57,6 +57,8 @@ public:
     bool processToGPUPlanar(const InputData& input,
                             std::shared_ptr<lrengine::render::LRPlanarTexture>& outputTexture) override;
     
+    bool processToGPUExternal(const InputData& input, ExternalImagePtr& outputImage) override;
+    
     bool processToCPU(const InputData& input,
                       uint8_t* outputBuffer,
                       size_t& outputSize,
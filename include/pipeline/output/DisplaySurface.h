@@ -10,6 +10,8 @@
 #pragma once
 
 #include "pipeline/output/OutputConfig.h"
+#include "pipeline/output/FramePacer.h"
+#include <algorithm>
 #include <memory>
 #include <cstdint>
 
@@ -194,6 +196,14 @@ public:
      */
     virtual void waitGPU() {}
     
+    /**
+     * @brief 设置下一次 endFrame 呈现的帧时间戳（微秒）
+     * 
+     * 编码器输入表面据此生成样本时间戳；屏幕显示表面不需要，默认忽略。
+     * @return 表面是否使用该时间戳
+     */
+    virtual bool setPresentationTime(int64_t timestampUs) { (void)timestampUs; return false; }
+    
     // ==========================================================================
     // 状态查询
     // ==========================================================================
@@ -244,11 +254,55 @@ public:
      */
     lrengine::render::LRRenderContext* getRenderContext() const { return mRenderContext; }
     
+    // ==========================================================================
+    // 帧节奏
+    // ==========================================================================
+    
+    /**
+     * @brief 设置帧节奏控制器（为空时渲染完立即呈现）
+     */
+    void setFramePacer(FramePacerPtr pacer) { mFramePacer = std::move(pacer); }
+    
+    const FramePacerPtr& getFramePacer() const { return mFramePacer; }
+    
+    /**
+     * @brief 设置本帧内容时间戳（微秒），endFrame 时交给帧节奏控制器安排上屏时间
+     */
+    void setFrameTimestamp(int64_t timestampUs) { mFrameTimestampUs = timestampUs; }
+    
+    /**
+     * @brief 设置最多同时在途的帧数（已提交GPU但未上屏），默认 3 即三缓冲
+     * 
+     * 第 N+1 帧的渲染与第 N 帧的扫描输出重叠；超出时 beginFrame 等待最早一帧完成，
+     * 而不是在交换缓冲时阻塞。
+     */
+    virtual void setMaxFramesInFlight(uint32_t count) {
+        mMaxFramesInFlight = std::max<uint32_t>(1, std::min<uint32_t>(count, 3));
+    }
+    
+    uint32_t getMaxFramesInFlight() const { return mMaxFramesInFlight; }
+    
 protected:
+    /**
+     * @brief 取本帧的目标上屏时间（FramePacer::nowNs 时钟），未启用帧节奏时返回 -1
+     */
+    int64_t takePacedPresentTimeNs() {
+        if (!mFramePacer) {
+            return -1;
+        }
+        const int64_t target = mFramePacer->schedule(mFrameTimestampUs, FramePacer::nowNs());
+        mFrameTimestampUs = 0;
+        return target;
+    }
+    
     SurfaceState mState = SurfaceState::Uninitialized;
     DisplayConfig mDisplayConfig;
     bool mVSyncEnabled = true;
     lrengine::render::LRRenderContext* mRenderContext = nullptr;
+    
+    FramePacerPtr mFramePacer;
+    int64_t mFrameTimestampUs = 0;
+    uint32_t mMaxFramesInFlight = 3;
 };
 
 using DisplaySurfacePtr = std::shared_ptr<DisplaySurface>;
@@ -0,0 +1,152 @@
+/**
+ * @file FramePacer.h
+ * @brief 帧节奏控制 - 按 VSync 网格安排上屏时间，消除 60/120Hz 下的抖动
+ *
+ * 渲染完成就立即交换时，帧的上屏时刻取决于GPU耗时落在哪个 VSync 之前，
+ * 30fps 内容在 60Hz 屏上会出现 1-3 个 VSync 交替停留（judder）。
+ * FramePacer 把内容时间戳映射到 VSync 网格上的目标上屏时间，
+ * 表面通过 eglPresentationTimeANDROID / presentDrawable:atTime: 交给系统合成器按时上屏，
+ * 交换调用本身不再等待 VSync。
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace pipeline {
+namespace output {
+
+/**
+ * @brief VSync 时间来源（Choreographer / CADisplayLink）
+ *
+ * 回调时间均为 FramePacer::nowNs() 所用的单调时钟（纳秒）。
+ */
+class VsyncSource {
+public:
+    using VsyncCallback = std::function<void(int64_t vsyncTimeNs, int64_t periodNs)>;
+
+    virtual ~VsyncSource() = default;
+
+    /**
+     * @brief 开始接收 VSync（回调在平台线程触发）
+     */
+    virtual bool start(VsyncCallback callback) = 0;
+
+    /**
+     * @brief 停止；返回后不再触发回调
+     */
+    virtual void stop() = 0;
+};
+
+/**
+ * @brief 创建平台 VSync 来源（不支持的平台返回 nullptr）
+ */
+std::unique_ptr<VsyncSource> createPlatformVsyncSource();
+
+/**
+ * @brief 帧节奏统计
+ */
+struct FramePacingStats {
+    uint64_t scheduled = 0;         ///< 安排上屏的帧数
+    uint64_t late = 0;              ///< 理想 VSync 已过、顺延到下一个 VSync 的帧数
+    uint64_t reanchors = 0;         ///< 内容时钟跳变（暂停、seek）后重新对齐的次数
+    int64_t vsyncPeriodNs = 0;      ///< 当前刷新周期
+};
+
+/**
+ * @brief 帧节奏控制器
+ *
+ * onVsync 可在任意线程调用；schedule 在渲染线程（GPU队列）调用。
+ * 内容时钟与显示时钟以首帧对齐，之后每帧的目标时间 = 对齐点 + 内容时间差，
+ * 再取整到最近的 VSync：24fps 在 60Hz 上得到最均匀的 3:2 分布，30fps 每帧恰好 2 个 VSync。
+ */
+class FramePacer {
+public:
+    FramePacer();
+    ~FramePacer();
+
+    // 禁止拷贝
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    /**
+     * @brief 挂接 VSync 来源（替换已有来源）
+     */
+    void attachVsyncSource(std::unique_ptr<VsyncSource> source);
+
+    /**
+     * @brief 是否已挂接可用的 VSync 来源
+     */
+    bool hasVsyncSource() const;
+    
+    /**
+     * @brief VSync 监听（在平台 VSync 线程调用，只应投递任务、不做绘制）
+     */
+    using VsyncListener = std::function<void(int64_t vsyncTimeNs)>;
+    
+    void setVsyncListener(VsyncListener listener);
+    
+    /**
+     * @brief 记录一次 VSync
+     * @param periodNs 平台给出的刷新周期；为 0 时由相邻 VSync 估算
+     */
+    void onVsync(int64_t vsyncTimeNs, int64_t periodNs = 0);
+
+    /**
+     * @brief 为一帧安排上屏时间
+     * @param contentTimestampUs 帧内容时间戳（微秒）；<= 0 时按下一个 VSync 上屏
+     * @param nowNs 当前时间（nowNs() 时钟）
+     * @return 目标上屏时间（纳秒，nowNs() 时钟）
+     */
+    int64_t schedule(int64_t contentTimestampUs, int64_t nowNs);
+
+    /**
+     * @brief 丢弃对齐点（暂停恢复、表面重建后调用）
+     */
+    void reset();
+
+    /**
+     * @brief 当前刷新周期（尚无 VSync 时为 60Hz）
+     */
+    int64_t getVsyncPeriodNs() const;
+
+    FramePacingStats getStats() const;
+
+    /**
+     * @brief 单调时钟（纳秒，与 Choreographer 的 CLOCK_MONOTONIC 一致）
+     */
+    static int64_t nowNs();
+
+private:
+    // 更新 VSync 网格（调用方持有 mMutex）
+    void recordVsyncLocked(int64_t vsyncTimeNs, int64_t periodNs);
+    
+    // 不早于 earliestNs 的最近 VSync
+    int64_t nextVsyncAtOrAfter(int64_t earliestNs) const;
+
+    mutable std::mutex mMutex;
+    std::unique_ptr<VsyncSource> mSource;
+    std::shared_ptr<VsyncListener> mListener;     // 拷贝后在锁外调用
+
+    // VSync 网格
+    int64_t mLastVsyncNs = 0;
+    int64_t mPeriodNs = 16666667;
+    bool mPeriodFromPlatform = false;
+
+    // 内容时钟对齐点
+    bool mAnchored = false;
+    int64_t mAnchorContentUs = 0;
+    int64_t mAnchorPresentNs = 0;
+    int64_t mLastContentUs = 0;
+    int64_t mLastTargetNs = 0;
+
+    FramePacingStats mStats;
+};
+
+using FramePacerPtr = std::shared_ptr<FramePacer>;
+
+} // namespace output
+} // namespace pipeline
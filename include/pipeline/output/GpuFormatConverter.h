@@ -0,0 +1,124 @@
+/**
+ * @file GpuFormatConverter.h
+ * @brief GPU 格式转换 - 在GPU队列上把 RGBA 输出转成 I420/NV12/NV21 并异步读回
+ *
+ * 转换结果按字节布局打包进一张 RGBA8 纹理（宽 w/4、高 h*3/2，每个 texel 4 字节），
+ * 读回的内存即为紧密排列的 YUV 数据，CPU 无需再转换；读回量为 RGBA 的 3/8。
+ */
+
+#pragma once
+
+#include "pipeline/output/OutputConfig.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+// 前向声明
+namespace lrengine {
+namespace render {
+class LRRenderContext;
+class LRShaderProgram;
+class LRPipelineState;
+class LRVertexBuffer;
+class LRSampler;
+class LRFrameBuffer;
+class LRTexture;
+} // namespace render
+} // namespace lrengine
+
+namespace pipeline {
+
+class PipelineContext;
+class ReadbackRequest;
+
+namespace output {
+
+/**
+ * @brief RGBA → YUV 转换 + 缩放 + 异步读回
+ *
+ * 颜色矩阵为 BT.601 Video Range（WebRTC / libyuv 的默认约定）。
+ * 除构造外所有方法都在GPU队列调用。
+ */
+class GpuFormatConverter {
+public:
+    /**
+     * @param format YUV420 / NV12 / NV21
+     * @param width 目标宽度（0 表示与源相同）
+     * @param height 目标高度（0 表示与源相同）
+     */
+    GpuFormatConverter(OutputFormat format, uint32_t width, uint32_t height);
+    ~GpuFormatConverter();
+
+    // 禁止拷贝
+    GpuFormatConverter(const GpuFormatConverter&) = delete;
+    GpuFormatConverter& operator=(const GpuFormatConverter&) = delete;
+
+    /**
+     * @brief 是否支持转换到该格式
+     */
+    static bool isSupported(OutputFormat format);
+
+    /**
+     * @brief 转换后的数据大小（宽高需已对齐到 4）
+     */
+    static size_t getConvertedSize(OutputFormat format, uint32_t width, uint32_t height);
+
+    /**
+     * @brief 按请求与源尺寸求出实际输出尺寸（对齐到 4 的倍数）
+     */
+    static void resolveSize(uint32_t requestWidth, uint32_t requestHeight,
+                            uint32_t sourceWidth, uint32_t sourceHeight,
+                            uint32_t& width, uint32_t& height);
+
+    bool matches(OutputFormat format, uint32_t width, uint32_t height) const {
+        return mFormat == format && mRequestWidth == width && mRequestHeight == height;
+    }
+
+    OutputFormat getFormat() const { return mFormat; }
+
+    /**
+     * @brief 转换一帧并发起读回（不等待GPU）
+     * @param source 源 RGBA 纹理
+     * @param outWidth 实际输出宽度
+     * @param outHeight 实际输出高度
+     * @return 读回句柄；上下文或读回服务不可用时返回nullptr
+     */
+    std::shared_ptr<ReadbackRequest> convert(lrengine::render::LRTexture& source,
+                                             uint32_t sourceWidth, uint32_t sourceHeight,
+                                             PipelineContext& context,
+                                             uint32_t& outWidth, uint32_t& outHeight);
+
+    /**
+     * @brief 释放GPU资源
+     */
+    void release();
+
+private:
+    // 首次使用及上下文变化时创建着色器与共享资源
+    bool ensureResources(PipelineContext& context);
+
+    // 归还已读回完成的打包纹理（纹理池自动回收）
+    void recyclePackedTextures();
+
+    OutputFormat mFormat;
+    uint32_t mRequestWidth;
+    uint32_t mRequestHeight;
+
+    lrengine::render::LRRenderContext* mRenderContext = nullptr;
+    std::shared_ptr<lrengine::render::LRShaderProgram> mProgram;
+    std::shared_ptr<lrengine::render::LRPipelineState> mPipelineState;
+    std::shared_ptr<lrengine::render::LRVertexBuffer> mQuad;
+    std::shared_ptr<lrengine::render::LRSampler> mSampler;
+    std::shared_ptr<lrengine::render::LRFrameBuffer> mFrameBuffer;
+
+    // 读回完成前打包纹理不能被下一帧覆盖
+    struct InFlight {
+        std::shared_ptr<ReadbackRequest> request;
+        std::shared_ptr<lrengine::render::LRTexture> texture;
+    };
+    std::deque<InFlight> mInFlight;
+};
+
+} // namespace output
+} // namespace pipeline
@@ -0,0 +1,165 @@
+/**
+ * @file Mp4FragmentWriter.h
+ * @brief 流式分片 MP4 (fMP4) 写入器 - 长时间录制时内存与崩溃损失都有上限
+ *
+ * 文件布局：ftyp + moov(空样本表, mvex) + [moof + mdat]* + mfra。
+ * 每个分片独立可解码，进程被杀或断电时只丢失最后一个未落盘的分片；
+ * 写入器只缓存当前分片的样本，内存占用与录制时长无关。
+ */
+
+#pragma once
+
+#include "pipeline/output/OutputConfig.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pipeline {
+namespace output {
+
+/**
+ * @brief 已编码的视频样本
+ *
+ * 样本数据为 4 字节长度前缀的 NAL 单元（AVCC / HVCC 格式）；
+ * codecConfig 为 true 时数据是解码配置记录（avcC / hvcC 盒子的内容）。
+ */
+struct EncodedSample {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    int64_t ptsUs = 0;              ///< 显示时间戳（微秒）
+    bool keyFrame = false;
+    bool codecConfig = false;
+};
+
+/**
+ * @brief fMP4 写入配置
+ */
+struct Mp4WriterConfig {
+    int64_t fragmentDurationUs = 2000000;   ///< 分片目标时长：达到后在下一个关键帧处切分
+    size_t maxFragmentBytes = 8u << 20;     ///< 分片样本数据上限：超出时不等关键帧直接切分
+    size_t writeBufferSize = 1u << 20;      ///< 写缓冲大小（按 4KB 对齐）
+    bool syncOnFragment = true;             ///< 每个分片落盘后 fdatasync
+    uint32_t timescale = 90000;             ///< 视频轨时间刻度
+};
+
+/**
+ * @brief 写入统计
+ */
+struct Mp4WriterStats {
+    uint64_t samples = 0;
+    uint64_t fragments = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t droppedSamples = 0;    ///< 收到解码配置前或时间戳回退而丢弃的样本
+    int64_t durationUs = 0;
+};
+
+/**
+ * @brief 分片 MP4 写入器（单轨视频，H.264 / H.265）
+ *
+ * 非线程安全：全部调用需在同一串行队列上进行（FileOutputTarget 使用执行器的IO队列）。
+ * 编码器不输出 B 帧（解码顺序与显示顺序一致），样本按时间戳递增写入。
+ */
+class Mp4FragmentWriter {
+public:
+    Mp4FragmentWriter() = default;
+    ~Mp4FragmentWriter();
+
+    // 禁止拷贝
+    Mp4FragmentWriter(const Mp4FragmentWriter&) = delete;
+    Mp4FragmentWriter& operator=(const Mp4FragmentWriter&) = delete;
+
+    /**
+     * @brief 创建文件（已存在时截断）
+     * @param type 只支持 H264 / H265
+     */
+    bool open(const std::string& path, EncoderType type, uint32_t width, uint32_t height,
+              const Mp4WriterConfig& config = Mp4WriterConfig());
+
+    /**
+     * @brief 写入样本；首个解码配置到达时写出文件头
+     */
+    bool writeSample(const EncodedSample& sample);
+
+    /**
+     * @brief 立即结束当前分片并落盘
+     */
+    bool flushFragment();
+
+    /**
+     * @brief 写出最后一个分片与随机访问索引 (mfra) 并关闭文件
+     */
+    bool close();
+
+    bool isOpen() const { return mFd >= 0; }
+
+    const Mp4WriterStats& getStats() const { return mStats; }
+
+    // =========================================================================
+    // 码流格式转换（Android MediaCodec 输出 Annex-B）
+    // =========================================================================
+
+    /**
+     * @brief Annex-B（起始码分隔）转为 4 字节长度前缀
+     */
+    static void annexBToLengthPrefixed(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 由 Annex-B 参数集（SPS/PPS，H.265 另含 VPS）生成解码配置记录
+     * @return 缺少必需的参数集时返回 false
+     */
+    static bool buildDecoderConfig(EncoderType type, const uint8_t* annexB, size_t size,
+                                   std::vector<uint8_t>& record);
+
+private:
+    struct PendingSample {
+        size_t offset = 0;          // 在 mFragmentData 中的偏移
+        uint32_t size = 0;
+        int64_t ptsUs = 0;
+        bool keyFrame = false;
+    };
+
+    struct RandomAccessEntry {
+        uint64_t time = 0;          // 轨道时间刻度
+        uint64_t moofOffset = 0;
+    };
+
+    bool writeHeader();
+    bool writeFragment(int64_t nextPtsUs);
+    bool writeIndex();
+
+    uint64_t toTrackTime(int64_t us) const;
+
+    // 缓冲写：攒满写缓冲后 pwrite，超大块直接写
+    bool append(const uint8_t* data, size_t size);
+    bool flushBuffer();
+    bool syncFile();
+
+    int mFd = -1;
+    std::string mPath;
+    EncoderType mType = EncoderType::H264;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    Mp4WriterConfig mConfig;
+
+    std::vector<uint8_t> mDecoderConfig;
+    bool mHeaderWritten = false;
+
+    std::vector<PendingSample> mPending;
+    std::vector<uint8_t> mFragmentData;
+    int64_t mFirstPtsUs = -1;
+    int64_t mLastPtsUs = -1;
+    int64_t mLastDurationUs = 0;
+    uint32_t mSequence = 0;
+    std::vector<RandomAccessEntry> mRandomAccess;
+
+    uint8_t* mBuffer = nullptr;     // 对齐写缓冲
+    size_t mBufferUsed = 0;
+    uint64_t mFileOffset = 0;       // 已写入文件的字节数（不含缓冲）
+
+    Mp4WriterStats mStats;
+};
+
+} // namespace output
+} // namespace pipeline
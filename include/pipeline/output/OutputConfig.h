@@ -9,6 +9,7 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 
 // 前向声明
 namespace lrengine {
@@ -19,6 +20,10 @@ class LRPlanarTexture;
 } // namespace lrengine
 
 namespace pipeline {
+
+class FramePacket;
+class ReadbackRequest;
+
 namespace output {
 
 // =============================================================================
@@ -50,6 +55,53 @@ enum class OutputTargetType : uint8_t {
     Custom      ///< 自定义目标
 };
 
+/**
+ * @brief 输出目标的执行位置
+ */
+enum class OutputAffinity : uint8_t {
+    Inline,     ///< 在 OutputEntity 所在的GPU队列上同步调用（需要管线渲染上下文的目标，如显示）
+    Worker      ///< 目标独占的工作线程，经有界队列交付
+};
+
+/**
+ * @brief 目标队列满时的处理方式
+ */
+enum class OutputDropPolicy : uint8_t {
+    DropOldest, ///< 丢弃最早排队的帧（预览类回调：只关心最新画面）
+    DropNewest, ///< 丢弃新到的帧（已排队的帧按序交付）
+    Block       ///< 等待队列空位，超过 blockTimeoutMs 后丢弃新帧（编码、文件：尽量不丢）
+};
+
+/**
+ * @brief 输出目标的分发配置
+ */
+struct OutputDispatchConfig {
+    OutputAffinity affinity = OutputAffinity::Worker;
+    OutputDropPolicy dropPolicy = OutputDropPolicy::DropOldest;
+    size_t queueSize = 0;           ///< 队列深度（0 表示使用 OutputConfig::outputQueueSize）
+    uint32_t blockTimeoutMs = 20;   ///< Block 策略下单帧的最长等待，防止拖住管线
+};
+
+/**
+ * @brief 各类目标的默认分发配置
+ */
+inline OutputDispatchConfig getDefaultDispatchConfig(OutputTargetType type) {
+    OutputDispatchConfig config;
+    switch (type) {
+        case OutputTargetType::Display:
+            config.affinity = OutputAffinity::Inline;
+            break;
+        case OutputTargetType::Encoder:
+        case OutputTargetType::File:
+        case OutputTargetType::Stream:
+            config.dropPolicy = OutputDropPolicy::Block;
+            break;
+        default:
+            break;
+    }
+    return config;
+}
+
 /**
  * @brief 输出数据类型
  */
@@ -184,14 +236,26 @@ struct OutputTargetConfig {
 struct OutputConfig {
     std::vector<OutputTargetConfig> targets;    ///< 输出目标列表
     bool enableMultiTarget = false;             ///< 启用多目标输出
-    bool asyncOutput = true;                    ///< 异步输出
-    size_t outputQueueSize = 3;                 ///< 输出队列大小
+    bool asyncOutput = true;                    ///< 异步输出（关闭时所有目标都在GPU队列上依次同步调用）
+    size_t outputQueueSize = 3;                 ///< 每个 Worker 目标的默认队列深度
 };
 
 // =============================================================================
 // 输出数据包
 // =============================================================================
 
+/**
+ * @brief GPU 转换后的 CPU 帧（GPU队列上发起，读回在目标线程等待）
+ */
+struct ConvertedFrame {
+    OutputFormat format = OutputFormat::RGBA;
+    uint32_t requestWidth = 0;      ///< 请求尺寸（0 表示源尺寸），用于匹配目标
+    uint32_t requestHeight = 0;
+    uint32_t width = 0;             ///< 实际输出尺寸
+    uint32_t height = 0;
+    std::shared_ptr<ReadbackRequest> readback;
+};
+
 /**
  * @brief 输出数据包
  */
@@ -214,6 +278,12 @@ struct OutputData {
     int64_t timestamp = 0;
     uint64_t frameId = 0;
     
+    // 源帧包：排队交付期间保持 cpuData 与纹理存活
+    std::shared_ptr<FramePacket> source;
+    
+    // 按回调目标请求的格式/尺寸在GPU上转换的结果（每种请求一份）
+    std::vector<ConvertedFrame> converted;
+    
     // 便捷方法
     bool hasGpuData() const {
         return planarTexture || textureId != 0 || metalTexture != nullptr;
@@ -13,7 +13,15 @@
 #include "pipeline/entity/ProcessEntity.h"
 #include "pipeline/output/OutputConfig.h"
 #include "pipeline/output/DisplaySurface.h"
+#include "pipeline/output/GpuFormatConverter.h"
+#include "pipeline/output/Mp4FragmentWriter.h"
+#include "pipeline/utils/LatencyHistogram.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <unordered_map>
 #include <vector>
 #include <queue>
 
@@ -88,8 +96,27 @@ public:
      */
     virtual void setEnabled(bool enabled) { mEnabled = enabled; }
     
+    /**
+     * @brief 设置分发配置（执行位置、队列深度、丢帧策略）
+     * 
+     * 需在加入 OutputEntity 之前设置；未设置时使用 getDefaultDispatchConfig(getType())。
+     */
+    void setDispatchConfig(const OutputDispatchConfig& config) {
+        mDispatchConfig = config;
+        mHasDispatchConfig = true;
+    }
+    
+    /**
+     * @brief 获取分发配置
+     */
+    OutputDispatchConfig getDispatchConfig() const {
+        return mHasDispatchConfig ? mDispatchConfig : getDefaultDispatchConfig(getType());
+    }
+    
 protected:
     bool mEnabled = true;
+    OutputDispatchConfig mDispatchConfig;
+    bool mHasDispatchConfig = false;
 };
 
 using OutputTargetPtr = std::shared_ptr<OutputTarget>;
@@ -101,6 +128,40 @@ using OutputTargetPtr = std::shared_ptr<OutputTarget>;
 /**
  * @brief 显示输出目标
  */
+/**
+ * @brief 最新成品帧缓存（多显示共用）
+ * 
+ * 图每帧只发布一次；各显示在自己的 VSync 上取最新一帧做缩放绘制：
+ * 低刷新率的屏跳过中间帧，高刷新率的屏在无新帧时保持上一帧，图不必按最快的屏运行。
+ * 缓存只持有最新一帧的纹理与源帧包。
+ */
+class LatestFrameCache {
+public:
+    /**
+     * @brief 发布一帧（GPU队列）
+     */
+    void publish(const OutputData& data);
+    
+    /**
+     * @brief 取比 generation 更新的帧
+     * @param generation 调用方已呈现的代数，成功时更新为当前代数
+     * @return 没有新帧时返回false
+     */
+    bool acquireNewer(uint64_t& generation, OutputData& data) const;
+    
+    /**
+     * @brief 丢弃缓存的帧
+     */
+    void clear();
+    
+private:
+    mutable std::mutex mMutex;
+    OutputData mFrame;
+    uint64_t mGeneration = 0;
+};
+
+using LatestFrameCachePtr = std::shared_ptr<LatestFrameCache>;
+
 class DisplayOutputTarget : public OutputTarget {
 public:
     explicit DisplayOutputTarget(const std::string& name);
@@ -128,8 +189,33 @@ public:
      * @brief 设置显示配置
      */
     void setDisplayConfig(const DisplayConfig& config);
+    
+    using TaskPoster = std::function<void(std::function<void()>)>;
+    
+    /**
+     * @brief 改为按本屏 VSync 拉取最新帧（多显示时使用）
+     * 
+     * output() 不再逐帧绘制；表面帧节奏控制器的每次 VSync 经 gpuPoster 在GPU队列上
+     * 绘制缓存中尚未呈现的最新帧。表面没有 VSync 来源时仍按 output() 逐帧绘制。
+     * @param cache 为空时恢复逐帧绘制
+     */
+    void setLatestFrameSource(LatestFrameCachePtr cache, TaskPoster gpuPoster);
+    
+    /**
+     * @brief 是否在按 VSync 拉取最新帧
+     */
+    bool isPullingLatestFrame() const;
 
 private:
+    // 绘制一帧（GPU队列）；contentTimestampUs 交给帧节奏控制器，0 表示下一个 VSync
+    bool renderFrame(const OutputData& data, int64_t contentTimestampUs);
+    
+    // 拉取模式的共享状态，VSync 回调与投递的任务持有它（定义见 OutputEntity.cpp）
+    struct PullState;
+    
+    // 停止拉取模式：注销 VSync 监听并等待进行中的绘制结束
+    void stopPulling();
+    
     // CPU 数据上传到纹理
     std::shared_ptr<lrengine::render::LRPlanarTexture> getOrCreateCpuPlanarTexture(
         lrengine::render::LRRenderContext* context,
@@ -141,6 +227,8 @@ private:
     DisplaySurfacePtr mSurface;
     DisplayConfig mDisplayConfig;
     
+    std::shared_ptr<PullState> mPull;
+    
     // CPU 数据渲染用的临时纹理
     std::shared_ptr<lrengine::render::LRPlanarTexture> mCpuDataPlanarTexture;
     uint32_t mCpuDataWidth = 0;
@@ -178,16 +266,196 @@ public:
      */
     void setGPUCallback(GPUOutputCallback callback);
     
+    /**
+     * @brief 设置 CPU 回调的数据格式与分辨率
+     * 
+     * YUV420 / NV12 / NV21 时管线在GPU上完成缩放与格式转换，只读回转换后的数据，
+     * 回调拿到的是紧密排列的 YUV（宽高对齐到 4）；其他格式按原样交付 RGBA。
+     * @param width 输出宽度（0 表示渲染尺寸）
+     * @param height 输出高度（0 表示渲染尺寸）
+     */
+    void setCPUOutputFormat(OutputFormat format, uint32_t width = 0, uint32_t height = 0);
+    
+    /**
+     * @brief 获取需要GPU转换的请求（GPU队列调用）
+     * @return 不需要转换时返回false
+     */
+    bool getConversionRequest(OutputFormat& format, uint32_t& width, uint32_t& height) const;
+    
 private:
     std::string mName;
     CPUOutputCallback mCpuCallback;
     GPUOutputCallback mGpuCallback;
+    
+    // CPU 输出格式（业务线程设置，GPU队列读取）
+    mutable std::mutex mFormatMutex;
+    OutputFormat mCpuFormat = OutputFormat::RGBA;
+    uint32_t mCpuWidth = 0;
+    uint32_t mCpuHeight = 0;
+};
+
+// =============================================================================
+// 编码输出目标
+// =============================================================================
+
+/**
+ * @brief 硬件编码输出目标
+ * 
+ * 直接渲染到编码器的输入表面，帧数据全程留在GPU：
+ * - Android：MediaCodec 输入 Surface（AndroidEGLSurface，EGL_RECORDABLE_ANDROID），
+ *   时间戳经 eglPresentationTimeANDROID 传给编码器
+ * - iOS：AVAssetWriterInputPixelBufferAdaptor 的 CVPixelBufferPool（iOSMetalSurface 像素缓冲模式），
+ *   GPU 完成后按帧时间戳追加
+ * 
+ * 只接受GPU纹理输入，不做CPU读回；必须在GPU队列上执行（Inline），
+ * 编码本身由硬件异步完成，不阻塞渲染线程。
+ */
+class EncoderOutputTarget : public OutputTarget {
+public:
+    EncoderOutputTarget(const std::string& name, const EncoderConfig& config);
+    ~EncoderOutputTarget() override;
+    
+    const std::string& getName() const override { return mName; }
+    OutputTargetType getType() const override { return OutputTargetType::Encoder; }
+    
+    bool initialize() override;
+    void release() override;
+    bool output(const OutputData& data) override;
+    bool isReady() const override;
+    
+    /**
+     * @brief 设置编码器输入表面（已绑定到编码器并完成 initialize）
+     */
+    void setEncoderSurface(DisplaySurfacePtr surface);
+    
+    DisplaySurfacePtr getEncoderSurface() const { return mSurface; }
+    
+    const EncoderConfig& getEncoderConfig() const { return mConfig; }
+    
+    /**
+     * @brief 已送入编码器的帧数
+     */
+    uint64_t getEncodedFrameCount() const { return mEncodedFrames; }
+
+private:
+    std::string mName;
+    EncoderConfig mConfig;
+    DisplaySurfacePtr mSurface;
+    DisplayConfig mDisplayConfig;
+    
+    int64_t mLastTimestamp = -1;        // 上一帧送入编码器的时间戳（微秒）
+    uint64_t mEncodedFrames = 0;
+    bool mWarnedCpuInput = false;
+};
+
+// =============================================================================
+// 文件输出目标
+// =============================================================================
+
+/**
+ * @brief 已编码样本来源（平台硬件编码器的输出端）
+ * 
+ * 样本格式见 EncodedSample：长度前缀 NAL，解码配置单独作为 codecConfig 样本给出。
+ */
+class EncodedSampleSource {
+public:
+    using SampleSink = std::function<void(const EncodedSample&)>;
+    
+    virtual ~EncodedSampleSource() = default;
+    
+    /**
+     * @brief 取出已完成编码的样本（不等待）
+     * @return 交给 sink 的样本数
+     */
+    virtual size_t drain(const SampleSink& sink) = 0;
+    
+    /**
+     * @brief 结束输入并取出剩余样本（最多等待 timeoutMs）
+     */
+    virtual void finish(const SampleSink& sink, int64_t timeoutMs) = 0;
+};
+
+using EncodedSampleSourcePtr = std::shared_ptr<EncodedSampleSource>;
+
+/**
+ * @brief 文件输出目标（硬件编码 + 分片 MP4）
+ * 
+ * 帧在GPU队列上渲染进编码器输入表面（内部的 EncoderOutputTarget），
+ * 编码结果的取出与封装投递到执行器的IO队列，文件写入不占用GPU线程。
+ * 按分片落盘：录制任意时长内存都有上限，异常退出只损失最后一个分片。
+ */
+class FileOutputTarget : public OutputTarget {
+public:
+    using TaskPoster = std::function<void(std::function<void()>)>;
+    
+    FileOutputTarget(const std::string& name, const std::string& filePath,
+                     const EncoderConfig& config,
+                     const Mp4WriterConfig& writerConfig = Mp4WriterConfig());
+    ~FileOutputTarget() override;
+    
+    const std::string& getName() const override { return mName; }
+    OutputTargetType getType() const override { return OutputTargetType::File; }
+    
+    /**
+     * @brief 创建文件（重复调用返回当前状态）
+     */
+    bool initialize() override;
+    
+    /**
+     * @brief 结束编码并在IO队列上写完最后的分片与索引
+     */
+    void release() override;
+    
+    bool output(const OutputData& data) override;
+    bool isReady() const override;
+    
+    /**
+     * @brief 设置编码器：渲染端（输入表面）与样本端（编码输出）
+     */
+    void setEncoder(std::shared_ptr<EncoderOutputTarget> renderTarget, EncodedSampleSourcePtr source);
+    
+    /**
+     * @brief 设置封装任务的投递方式（通常为执行器IO队列；未设置时在调用线程执行）
+     */
+    void setIOTaskPoster(TaskPoster poster);
+    
+    const std::string& getFilePath() const { return mFilePath; }
+    
+    /**
+     * @brief 写入统计（IO队列上最近一次封装后的快照）
+     */
+    Mp4WriterStats getWriterStats() const;
+
+private:
+    struct MuxState;
+    
+    void post(std::function<void()> task);
+    void scheduleDrain();
+    
+    std::string mName;
+    std::string mFilePath;
+    EncoderConfig mConfig;
+    Mp4WriterConfig mWriterConfig;
+    
+    std::shared_ptr<EncoderOutputTarget> mRenderTarget;
+    std::shared_ptr<MuxState> mMux;     // 由IO队列任务共同持有，release 后仍可写完文件
+    TaskPoster mPoster;
 };
 
 // =============================================================================
 // OutputEntity
 // =============================================================================
 
+/**
+ * @brief 单个输出目标的分发统计
+ */
+struct OutputTargetStats {
+    uint64_t delivered = 0;     ///< 已交付帧数
+    uint64_t dropped = 0;       ///< 因队列满或等待超时丢弃的帧数
+    size_t queued = 0;          ///< 当前排队帧数（Inline 目标恒为0）
+    HistogramSummary latencyUs; ///< 分发到 output() 返回的耗时分布（微秒，含排队）
+};
+
 /**
  * @brief 输出实体类
  * 
@@ -284,11 +552,29 @@ public:
      */
     const std::vector<OutputTargetPtr>& getTargets() const { return mTargets; }
     
+    /**
+     * @brief 获取最新成品帧缓存
+     */
+    LatestFrameCachePtr getLatestFrameCache() const { return mLatestFrame; }
+    
+    /**
+     * @brief 开关每帧发布到最新帧缓存（关闭时释放缓存的帧）
+     */
+    void setLatestFramePublishing(bool enabled);
+    
     /**
      * @brief 清除所有输出目标
      */
     void clearTargets();
     
+    /**
+     * @brief 是否有启用的录制类目标（编码、文件、推流）
+     * 
+     * 显示与回调目标不强制全分辨率：显示端负责放大到屏幕尺寸，
+     * 拍照等需要全分辨率回调的场景经 PipelineExecutor::requestFullResolution 按需申请。
+     */
+    bool requiresFullResolution() const override;
+    
     // ==========================================================================
     // 便捷方法
     // ==========================================================================
@@ -315,12 +601,22 @@ public:
     /**
      * @brief 获取已输出帧数
      */
-    uint64_t getOutputFrameCount() const { return mOutputFrameCount; }
+    uint64_t getOutputFrameCount() const { return mOutputFrameCount.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 获取丢弃帧数（各目标丢帧之和）
+     */
+    uint64_t getDroppedFrameCount() const { return mDroppedFrameCount.load(std::memory_order_relaxed); }
     
     /**
-     * @brief 获取丢弃帧数
+     * @brief 获取目标的分发统计（目标不存在时返回全0）
      */
-    uint64_t getDroppedFrameCount() const { return mDroppedFrameCount; }
+    OutputTargetStats getTargetStats(const std::string& name) const;
+    
+    /**
+     * @brief 获取全部目标的分发统计（按添加顺序，名称 -> 统计）
+     */
+    std::vector<std::pair<std::string, OutputTargetStats>> getAllTargetStats() const;
     
 protected:
     // ==========================================================================
@@ -340,11 +636,20 @@ private:
     void initializePorts();
     
     // 处理输出
-    bool processOutput(FramePacketPtr packet);
+    bool processOutput(FramePacketPtr packet, PipelineContext& context);
+    
+    // 为请求 YUV 的回调目标做GPU转换并发起读回（GPU队列）
+    void convertForTargets(const FramePacketPtr& packet, OutputData& data, PipelineContext& context);
     
     // 分发到所有目标
     void dispatchToTargets(const OutputData& data);
     
+    // 目标的分发通道：Worker 目标带有界队列与工作线程，Inline 目标只计数（定义见 OutputEntity.cpp）
+    class TargetQueue;
+    
+    // 停止目标的工作线程（调用方持有 mTargetsMutex）
+    void stopTargetQueueLocked(const OutputTarget* target);
+    
 private:
     // 配置
     OutputConfig mConfig;
@@ -352,15 +657,23 @@ private:
     
     // 输出目标
     std::vector<OutputTargetPtr> mTargets;
+    std::unordered_map<const OutputTarget*, std::shared_ptr<TargetQueue>> mTargetQueues;
     mutable std::mutex mTargetsMutex;
     
+    // 多显示共用的最新帧
+    LatestFrameCachePtr mLatestFrame = std::make_shared<LatestFrameCache>();
+    std::atomic<bool> mPublishLatestFrame{false};
+    
+    // GPU 格式转换器（按请求的格式/尺寸各一个，仅GPU队列访问）
+    std::vector<std::unique_ptr<GpuFormatConverter>> mConverters;
+    
     // 默认目标（便捷访问）
     std::shared_ptr<DisplayOutputTarget> mDisplayTarget;
     std::shared_ptr<CallbackOutputTarget> mCallbackTarget;
     
     // 统计
-    uint64_t mOutputFrameCount = 0;
-    uint64_t mDroppedFrameCount = 0;
+    std::atomic<uint64_t> mOutputFrameCount{0};
+    std::atomic<uint64_t> mDroppedFrameCount{0};
 };
 
 using OutputEntityPtr = std::shared_ptr<OutputEntity>;
@@ -16,6 +16,8 @@
 #include <GLES3/gl3.h>
 #include <android/native_window.h>
 
+#include <deque>
+
 namespace pipeline {
 namespace output {
 namespace android {
@@ -66,6 +68,11 @@ public:
     void waitGPU() override;
     void setVSyncEnabled(bool enabled) override;
     
+    /**
+     * @brief 经 eglPresentationTimeANDROID 传给 MediaCodec 输入表面
+     */
+    bool setPresentationTime(int64_t timestampUs) override;
+    
     // ==========================================================================
     // Android 特定接口
     // ==========================================================================
@@ -85,6 +92,13 @@ public:
      */
     void setSharedContextMode(bool shared) { mUseSharedContext = shared; }
     
+    /**
+     * @brief 设置可录制模式（窗口为 MediaCodec 输入表面时开启，需在 attachToWindow 之前）
+     * 
+     * 选择带 EGL_RECORDABLE_ANDROID 的配置，编码器可直接消费交换出的缓冲，无需读回。
+     */
+    void setRecordable(bool recordable) { mRecordable = recordable; }
+    
 private:
     // 创建 EGL window surface
     bool createEGLWindowSurface();
@@ -101,6 +115,12 @@ private:
     // 绘制纹理到屏幕
     bool drawTextureToScreen(GLuint textureId, const DisplayConfig& config);
     
+    // 在途帧超过上限时等待最早一帧的 GPU 围栏
+    void waitForFrameSlot();
+    
+    // 删除全部在途围栏（需上下文为当前）
+    void clearFrameFences();
+    
 private:
     AndroidEGLContextManager* mEGLManager = nullptr;
     ANativeWindow* mNativeWindow = nullptr;
@@ -123,6 +143,13 @@ private:
     
     // 配置
     bool mUseSharedContext = true;
+    bool mRecordable = false;
+    
+    // 待呈现帧的时间戳（纳秒，-1 表示不设置）
+    int64_t mPresentationTimeNs = -1;
+    
+    // 已提交但可能未完成的帧（每帧交换前插入的围栏）
+    std::deque<GLsync> mFrameFences;
     
     // 状态
     bool mResourcesInitialized = false;
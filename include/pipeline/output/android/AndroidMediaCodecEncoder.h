@@ -0,0 +1,70 @@
+/**
+ * @file AndroidMediaCodecEncoder.h
+ * @brief Android MediaCodec 硬件编码器（NDK，输入 Surface 模式）
+ *
+ * 管线把帧渲染进 getInputSurface() 返回的窗口（AndroidEGLSurface），
+ * 编码输出由 drain() 在IO队列上取出并转为 MP4 样本格式。需要 API 26+。
+ */
+
+#pragma once
+
+#include "pipeline/output/OutputEntity.h"
+
+#ifdef __ANDROID__
+
+#include <android/native_window.h>
+#include <media/NdkMediaCodec.h>
+
+#include <vector>
+
+namespace pipeline {
+namespace output {
+namespace android {
+
+/**
+ * @brief MediaCodec 编码会话
+ */
+class AndroidMediaCodecEncoder : public EncodedSampleSource {
+public:
+    AndroidMediaCodecEncoder() = default;
+    ~AndroidMediaCodecEncoder() override;
+
+    // 禁止拷贝
+    AndroidMediaCodecEncoder(const AndroidMediaCodecEncoder&) = delete;
+    AndroidMediaCodecEncoder& operator=(const AndroidMediaCodecEncoder&) = delete;
+
+    /**
+     * @brief 创建并启动编码器（H.264 / H.265）
+     */
+    bool initialize(const EncoderConfig& config);
+
+    /**
+     * @brief 停止并释放编码器
+     */
+    void release();
+
+    /**
+     * @brief 编码器输入窗口（由编码器持有，AndroidEGLSurface 绑定时会自行 acquire）
+     */
+    ANativeWindow* getInputSurface() const { return mInputSurface; }
+
+    size_t drain(const SampleSink& sink) override;
+    void finish(const SampleSink& sink, int64_t timeoutMs) override;
+
+private:
+    // 取出一个输出缓冲；返回 false 表示暂无输出或已结束
+    bool drainOne(const SampleSink& sink, int64_t timeoutUs);
+
+    AMediaCodec* mCodec = nullptr;
+    ANativeWindow* mInputSurface = nullptr;
+    EncoderType mType = EncoderType::H264;
+    bool mEndOfStream = false;
+
+    std::vector<uint8_t> mScratch;      // Annex-B 转长度前缀的复用缓冲
+};
+
+} // namespace android
+} // namespace output
+} // namespace pipeline
+
+#endif // __ANDROID__
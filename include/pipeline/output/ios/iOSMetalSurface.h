@@ -48,7 +48,9 @@ public:
     
     bool attachToLayer(void* layer) override;
     void detach() override;
-    bool isAttached() const override { return mMetalLayer != nullptr; }
+    bool isAttached() const override {
+        return mMetalLayer != nullptr || mPixelBufferAdaptor != nullptr || mPixelBufferPool != nullptr;
+    }
     
     SurfaceSize getSize() const override;
     void setSize(uint32_t width, uint32_t height) override;
@@ -62,6 +64,16 @@ public:
     void waitGPU() override;
     void setVSyncEnabled(bool enabled) override;
     
+    /**
+     * @brief 同步调整 CAMetalLayer.maximumDrawableCount（2 或 3）
+     */
+    void setMaxFramesInFlight(uint32_t count) override;
+    
+    /**
+     * @brief 像素缓冲模式下作为追加到 AVAssetWriter 的样本时间
+     */
+    bool setPresentationTime(int64_t timestampUs) override;
+    
     // ==========================================================================
     // iOS 特定接口
     // ==========================================================================
@@ -86,6 +98,33 @@ public:
      */
     void setColorSpace(void* colorSpace);
     
+    /**
+     * @brief 绑定到 AVAssetWriterInputPixelBufferAdaptor（编码输出，替代 CAMetalLayer）
+     * 
+     * 每帧从 adaptor 的 CVPixelBufferPool 取缓冲，经 CVMetalTextureCache 包装为渲染目标，
+     * GPU 完成后按 setPresentationTime 的时间追加，整个过程没有CPU读回。
+     * adaptor 的 sourcePixelBufferAttributes 需包含 kCVPixelBufferMetalCompatibilityKey，
+     * 像素格式与 setPixelFormat 一致（默认 BGRA）。
+     * @param adaptor AVAssetWriterInputPixelBufferAdaptor*
+     */
+    bool attachToPixelBufferAdaptor(void* adaptor, uint32_t width, uint32_t height);
+    
+    /**
+     * @brief 像素缓冲就绪回调（Metal 完成线程调用）
+     * @param pixelBuffer CVPixelBufferRef，回调返回后由表面释放，需要保留时自行 CFRetain
+     * @param timestampUs setPresentationTime 设置的时间戳
+     */
+    using PixelBufferHandler = std::function<void(void* pixelBuffer, int64_t timestampUs)>;
+    
+    /**
+     * @brief 绑定到任意 CVPixelBufferPool（如 VTCompressionSession 的输入池）
+     * 
+     * 与 adaptor 模式相同的零拷贝渲染，GPU 完成后把缓冲交给 handler。
+     * @param pool CVPixelBufferPoolRef
+     */
+    bool attachToPixelBufferPool(void* pool, uint32_t width, uint32_t height,
+                                 PixelBufferHandler handler);
+    
 private:
     // 配置 Metal Layer
     bool configureMetalLayer();
@@ -93,9 +132,18 @@ private:
     // 获取下一个 drawable
     bool acquireNextDrawable();
     
+    // 像素缓冲模式：从池中取缓冲并包装为 Metal 纹理
+    bool acquireNextPixelBuffer();
+    
+    // 释放当前帧的像素缓冲
+    void releaseCurrentPixelBuffer();
+    
     // 创建渲染管线
     bool createRenderPipeline();
     
+    // 在途帧计数（完成回调可能晚于表面析构，故以 shared_ptr 持有）
+    struct InFlightLimiter;
+    
     // 清理资源
     void cleanupResources();
     
@@ -118,6 +166,18 @@ private:
     void* mCurrentDrawable = nullptr;      // id<CAMetalDrawable>
     void* mCurrentCommandBuffer = nullptr; // id<MTLCommandBuffer>
     
+    // 像素缓冲模式（编码输出）
+    void* mPixelBufferAdaptor = nullptr;   // AVAssetWriterInputPixelBufferAdaptor*
+    void* mPixelBufferPool = nullptr;      // CVPixelBufferPoolRef（池模式）
+    PixelBufferHandler mPixelBufferHandler;
+    void* mTextureCache = nullptr;         // CVMetalTextureCacheRef
+    void* mCurrentPixelBuffer = nullptr;   // CVPixelBufferRef
+    void* mCurrentPixelTexture = nullptr;  // CVMetalTextureRef
+    int64_t mPresentationTimeUs = 0;
+    
+    // 已提交、GPU 尚未完成的帧
+    std::shared_ptr<InFlightLimiter> mInFlight;
+    
     // 表面尺寸
     uint32_t mWidth = 0;
     uint32_t mHeight = 0;
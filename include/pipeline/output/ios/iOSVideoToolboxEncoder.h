@@ -0,0 +1,87 @@
+/**
+ * @file iOSVideoToolboxEncoder.h
+ * @brief iOS VideoToolbox 硬件编码器
+ *
+ * iOSMetalSurface 以池模式渲染进 getPixelBufferPool() 的缓冲，GPU 完成后调用 encode()；
+ * 编码输出（AVCC 样本与 avcC/hvcC 记录）在 VideoToolbox 线程入队，由 drain() 在IO队列取出。
+ */
+
+#pragma once
+
+#include "pipeline/output/OutputEntity.h"
+
+#if defined(__APPLE__)
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace pipeline {
+namespace output {
+namespace ios {
+
+/**
+ * @brief VTCompressionSession 编码会话
+ */
+class iOSVideoToolboxEncoder : public EncodedSampleSource {
+public:
+    iOSVideoToolboxEncoder() = default;
+    ~iOSVideoToolboxEncoder() override;
+
+    // 禁止拷贝
+    iOSVideoToolboxEncoder(const iOSVideoToolboxEncoder&) = delete;
+    iOSVideoToolboxEncoder& operator=(const iOSVideoToolboxEncoder&) = delete;
+
+    /**
+     * @brief 创建编码会话（H.264 / H.265，BGRA Metal 兼容输入）
+     */
+    bool initialize(const EncoderConfig& config);
+
+    /**
+     * @brief 结束会话
+     */
+    void release();
+
+    /**
+     * @brief 会话的输入缓冲池（CVPixelBufferPoolRef）
+     */
+    void* getPixelBufferPool() const;
+
+    /**
+     * @brief 提交一帧（任意线程）
+     * @param pixelBuffer CVPixelBufferRef
+     */
+    bool encode(void* pixelBuffer, int64_t timestampUs);
+
+    size_t drain(const SampleSink& sink) override;
+    void finish(const SampleSink& sink, int64_t timeoutMs) override;
+
+    /**
+     * @brief VideoToolbox 输出回调（内部使用）
+     */
+    void onEncoded(int32_t status, void* sampleBuffer);
+
+private:
+    struct QueuedSample {
+        std::vector<uint8_t> data;
+        int64_t ptsUs = 0;
+        bool keyFrame = false;
+        bool codecConfig = false;
+    };
+
+    void* mSession = nullptr;           // VTCompressionSessionRef
+    EncoderType mType = EncoderType::H264;
+    bool mConfigQueued = false;         // 仅在 VideoToolbox 回调线程访问
+
+    std::mutex mMutex;
+    std::deque<QueuedSample> mQueue;
+    size_t mMaxQueued = 120;            // IO队列长时间阻塞时的上限（约4秒）
+    uint64_t mDropped = 0;
+    bool mWaitKeyFrame = false;         // 溢出丢帧后等下一个关键帧，避免写入无法解码的 P 帧
+};
+
+} // namespace ios
+} // namespace output
+} // namespace pipeline
+
+#endif // defined(__APPLE__)
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "pipeline/core/PipelineConfig.h"
+#include <functional>
 #include <memory>
 #include <mutex>
 
@@ -22,6 +23,9 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <android/hardware_buffer.h>
+#include <deque>
 #endif // __ANDROID__
 
 #if defined(__APPLE__)
@@ -36,6 +40,12 @@
 #endif
 #endif // __APPLE__
 
+// Linux 服务器无窗口渲染（由构建系统在找到 EGL 时定义）
+#if defined(PIPELINE_HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif // PIPELINE_HEADLESS_EGL
+
 // 前向声明
 namespace lrengine {
 namespace render {
@@ -46,6 +56,8 @@ class LRPlanarTexture;
 
 namespace pipeline {
 
+struct ExternalImage;
+
 // =============================================================================
 // 平台相关枚举
 // =============================================================================
@@ -131,6 +143,29 @@ public:
      */
     bool releaseCurrent();
     
+    /**
+     * @brief 创建传输上下文（与主上下文同一共享组，自带 1x1 PBuffer）
+     * 
+     * 供传输队列做纹理上传与 PBO 读回。纹理、缓冲与同步对象在共享组内可见；
+     * FBO、VAO 等容器对象不共享，需在传输线程上自行创建。已创建时直接返回true。
+     */
+    bool createTransferContext();
+    
+    /**
+     * @brief 在当前线程激活传输上下文（每个线程只应激活主上下文或传输上下文之一）
+     */
+    bool makeTransferCurrent();
+    
+    /**
+     * @brief 取消传输上下文绑定（需在激活它的线程调用）
+     */
+    bool releaseTransferCurrent();
+    
+    /**
+     * @brief 获取传输上下文（未创建时为 EGL_NO_CONTEXT）
+     */
+    EGLContext getTransferContext() const { return mTransferContext; }
+    
     /**
      * @brief 获取当前EGL上下文
      */
@@ -151,17 +186,53 @@ public:
      */
     bool isCurrent() const;
     
+    /**
+     * @brief 零拷贝导入 AHardwareBuffer（EGLImage -> GL_TEXTURE_EXTERNAL_OES）
+     * 
+     * 相机 buffer 池循环使用同一批 buffer，EGLImage 与纹理按 buffer 缓存复用。
+     * 需在持有本上下文（或其共享上下文）的线程调用。
+     * @param buffer 硬件缓冲
+     * @return 外部图像，失败返回nullptr
+     */
+    std::shared_ptr<const ExternalImage> importHardwareBuffer(AHardwareBuffer* buffer);
+    
+    /**
+     * @brief 释放所有导入缓存（需在 GL 线程调用）
+     */
+    void clearImportCache();
+    
     /**
      * @brief 销毁资源
      */
     void destroy();
     
 private:
+    struct ImportedBuffer {
+        AHardwareBuffer* buffer = nullptr;
+        EGLImageKHR image = EGL_NO_IMAGE_KHR;
+        GLuint texture = 0;
+    };
+    
+    bool loadImportExtensions();
+    void releaseImportedBuffer(const ImportedBuffer& entry);
+    
     EGLDisplay mDisplay = EGL_NO_DISPLAY;
     EGLContext mContext = EGL_NO_CONTEXT;
     EGLSurface mSurface = EGL_NO_SURFACE;
     EGLConfig mConfig = nullptr;
     
+    // 传输上下文（上传/读回线程）
+    EGLContext mTransferContext = EGL_NO_CONTEXT;
+    EGLSurface mTransferSurface = EGL_NO_SURFACE;
+    
+    // AHardwareBuffer 导入（扩展函数按需加载）
+    PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC mGetNativeClientBuffer = nullptr;
+    PFNEGLCREATEIMAGEKHRPROC mCreateImage = nullptr;
+    PFNEGLDESTROYIMAGEKHRPROC mDestroyImage = nullptr;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC mImageTargetTexture = nullptr;
+    bool mImportExtensionsLoaded = false;
+    std::deque<std::shared_ptr<ImportedBuffer>> mImportCache;   // 按导入顺序，超出上限时淘汰空闲项
+    
     bool mInitialized = false;
     std::mutex mMutex;
 };
@@ -212,15 +283,56 @@ public:
         lrengine::render::LRRenderContext* renderContext);
     
     /**
-     * @brief 将LRTexture内容复制到CVPixelBuffer
+     * @brief 将LRTexture内容复制到CVPixelBuffer（同步，等待GPU完成）
+     * 
+     * 目标支持 32BGRA 与 NV12（420YpCbCr8BiPlanar Video/Full Range），
+     * 尺寸不同时按双线性缩放；RGBA→YUV 在 compute 着色器中完成，没有CPU转换。
      * @param texture 源纹理
-     * @param pixelBuffer 目标CVPixelBuffer
+     * @param pixelBuffer 目标CVPixelBuffer（需 IOSurface 支持且 Metal 兼容）
      * @return 是否成功
      */
     bool copyTextureToPixelBuffer(
         std::shared_ptr<lrengine::render::LRPlanarTexture> texture,
         CVPixelBufferRef pixelBuffer);
     
+    /**
+     * @brief 异步拷贝完成回调（Metal 完成线程调用）
+     * @param pixelBuffer 目标缓冲，回调返回后管理器不再持有，需要保留时自行 CVPixelBufferRetain
+     */
+    using PixelBufferCompletion = std::function<void(CVPixelBufferRef pixelBuffer, bool success)>;
+    
+    /**
+     * @brief 异步版本：提交GPU转换后立即返回，完成时回调
+     * @return 是否成功提交（失败时不会回调）
+     */
+    bool copyTextureToPixelBufferAsync(
+        std::shared_ptr<lrengine::render::LRPlanarTexture> texture,
+        CVPixelBufferRef pixelBuffer,
+        PixelBufferCompletion completion);
+    
+    /**
+     * @brief 从内部 CVPixelBufferPool 取缓冲并异步转换进去
+     * 
+     * 池按尺寸/格式复用，在途缓冲超过上限时本次返回 false（调用方持有过多缓冲）。
+     * @param width 目标宽度，0 表示与纹理相同
+     * @param height 目标高度，0 表示与纹理相同
+     * @param pixelFormat kCVPixelFormatType_32BGRA 或 420YpCbCr8BiPlanar(Video|Full)Range
+     */
+    bool copyTextureToPooledPixelBuffer(
+        std::shared_ptr<lrengine::render::LRPlanarTexture> texture,
+        uint32_t width, uint32_t height, OSType pixelFormat,
+        PixelBufferCompletion completion);
+    
+    /**
+     * @brief 零拷贝导入 CVPixelBuffer（按平面 CVMetalTextureCache 映射，不上传、不转换）
+     * 
+     * NV12 输出 Y(R8) + CbCr(RG8) 两个平面，32BGRA 输出单平面。
+     * 返回的图像持有 CVMetalTexture 与 pixelBuffer 的引用。
+     * @param pixelBuffer CVPixelBufferRef
+     * @return 外部图像，格式不支持或未启用纹理缓存时返回nullptr
+     */
+    std::shared_ptr<const ExternalImage> importPixelBuffer(CVPixelBufferRef pixelBuffer);
+    
     /**
      * @brief 获取Metal设备
      */
@@ -231,6 +343,14 @@ public:
      */
     void* getTextureCache() const { return mTextureCache; }
     
+    /**
+     * @brief 获取传输命令队列（id<MTLCommandQueue>，首次调用时创建）
+     * 
+     * 独立于 LREngine 渲染队列的第二个队列，像素缓冲转换与其他上传/读回在其上提交，
+     * 与渲染并行；与渲染的先后关系由 MTLSharedEvent 栅栏（GpuFence）保证。
+     */
+    void* getTransferCommandQueue();
+    
     /**
      * @brief 刷新纹理缓存
      */
@@ -242,15 +362,175 @@ public:
     void destroy();
     
 private:
+    // 编码纹理→像素缓冲转换；waitUntilCompleted 为 true 时同步等待
+    bool encodeTextureToPixelBuffer(
+        const std::shared_ptr<lrengine::render::LRPlanarTexture>& texture,
+        CVPixelBufferRef pixelBuffer,
+        PixelBufferCompletion completion,
+        bool waitUntilCompleted);
+    
+    // 首次使用时编译转换着色器（需持有 mMutex）
+    bool ensureConversionPipelines();
+    
+    // 创建传输命令队列（需持有 mMutex）
+    bool ensureTransferQueueLocked();
+    
+    // 从内部池取缓冲，尺寸/格式变化时重建池（需持有 mMutex）
+    CVPixelBufferRef createPooledPixelBuffer(uint32_t width, uint32_t height, OSType pixelFormat);
+    
     void* mMetalDevice = nullptr;                    // MTLDevice*
     void* mTextureCache = nullptr;
     
+    // GPU 格式转换（提交到传输队列）
+    void* mCommandQueue = nullptr;                   // id<MTLCommandQueue>，即传输队列
+    void* mBGRAPipeline = nullptr;                   // id<MTLComputePipelineState>
+    void* mLumaPipeline = nullptr;                   // id<MTLComputePipelineState>
+    void* mChromaPipeline = nullptr;                 // id<MTLComputePipelineState>
+    
+    // 输出缓冲池
+    CVPixelBufferPoolRef mPixelBufferPool = nullptr;
+    uint32_t mPoolWidth = 0;
+    uint32_t mPoolHeight = 0;
+    OSType mPoolFormat = 0;
+    
     bool mInitialized = false;
     std::mutex mMutex;
 };
 
 #endif // __APPLE__
 
+// =============================================================================
+// Linux 无窗口（服务器）平台
+// =============================================================================
+
+#if defined(PIPELINE_HEADLESS_EGL)
+
+/**
+ * @brief 无窗口 EGL 上下文管理器（Linux 渲染服务器）
+ * 
+ * 不依赖 X11/Wayland，显示按以下顺序选择（Auto）：
+ * 1. EGL_EXT_platform_device：直接枚举 GPU（NVIDIA 驱动、Mesa 均支持），可按 deviceIndex 选卡
+ * 2. GBM：打开 DRM render node 创建 gbm_device（需构建时找到 libgbm）
+ * 3. EGL_MESA_platform_surfaceless
+ * 4. eglGetDisplay(EGL_DEFAULT_DISPLAY)
+ * 
+ * 支持 EGL_KHR_surfaceless_context 时不创建任何 Surface，否则退化为 1x1 PBuffer；
+ * 渲染结果一律写入 FBO。每个实例持有独立上下文，多个实例可在不同线程（或不同 GPU）上并行工作；
+ * 同一显示被多个实例共用时按引用计数初始化/终止。
+ */
+class HeadlessEGLContextManager {
+public:
+    /**
+     * @brief 显示来源
+     */
+    enum class DisplayBackend : uint8_t {
+        Auto,           ///< 按上述顺序依次尝试
+        Device,         ///< EGL_EXT_platform_device
+        GBM,            ///< GBM + DRM render node
+        Surfaceless,    ///< EGL_MESA_platform_surfaceless
+        Default         ///< eglGetDisplay(EGL_DEFAULT_DISPLAY)
+    };
+    
+    /**
+     * @brief 上下文配置
+     */
+    struct Config {
+        DisplayBackend backend = DisplayBackend::Auto;
+        int32_t deviceIndex = 0;                    // Device / GBM 下的 GPU 序号
+        const char* renderNode = nullptr;           // GBM 设备节点，为空时取 /dev/dri/renderD{128 + deviceIndex}
+        bool desktopGL = true;                      // 桌面 OpenGL（与 LREngine 的 Linux 后端一致），false 为 GLES
+        int32_t glMajorVersion = 3;                 // 桌面 GL 取 Core Profile 3.3+，GLES 取 3
+        int32_t glMinorVersion = 3;
+        EGLContext sharedContext = EGL_NO_CONTEXT;  // 共享源上下文（需来自同一显示）
+        bool enableDebug = false;
+        int32_t pbufferWidth = 1;                   // 不支持 surfaceless 时的 PBuffer 尺寸
+        int32_t pbufferHeight = 1;
+    };
+    
+    HeadlessEGLContextManager();
+    ~HeadlessEGLContextManager();
+    
+    HeadlessEGLContextManager(const HeadlessEGLContextManager&) = delete;
+    HeadlessEGLContextManager& operator=(const HeadlessEGLContextManager&) = delete;
+    
+    /**
+     * @brief 初始化显示与上下文（初始化后上下文不绑定到任何线程）
+     */
+    bool initialize(const Config& config);
+    
+    /**
+     * @brief 创建与本上下文共享资源的新上下文（如上传线程），调用方负责 eglDestroyContext
+     */
+    EGLContext createSharedContext(EGLContext sourceContext = EGL_NO_CONTEXT);
+    
+    /**
+     * @brief 绑定到当前线程
+     */
+    bool makeCurrent();
+    
+    /**
+     * @brief 解除当前线程绑定
+     */
+    bool releaseCurrent();
+    
+    bool isCurrent() const;
+    
+    /**
+     * @brief 创建常驻的传输上下文（共享组同主上下文，由本管理器负责销毁）
+     */
+    bool createTransferContext();
+    
+    /**
+     * @brief 在当前线程绑定/解除传输上下文（传输队列线程调用）
+     */
+    bool makeTransferCurrent();
+    bool releaseTransferCurrent();
+    
+    EGLDisplay getDisplay() const { return mDisplay; }
+    EGLContext getContext() const { return mContext; }
+    EGLSurface getSurface() const { return mSurface; }
+    EGLContext getTransferContext() const { return mTransferContext; }
+    
+    /**
+     * @brief 实际使用的显示来源
+     */
+    DisplayBackend getActiveBackend() const { return mActiveBackend; }
+    
+    /**
+     * @brief 可用 GPU 数量（EGL_EXT_device_enumeration，不支持时返回 0）
+     */
+    static int32_t queryDeviceCount();
+    
+    void destroy();
+    
+private:
+    bool openDisplay(const Config& config);
+    bool openDeviceDisplay(int32_t deviceIndex);
+    bool openGBMDisplay(const Config& config);
+    bool openPlatformDisplay(EGLenum platform, void* nativeDisplay);
+    void closeDisplay();
+    
+    EGLDisplay mDisplay = EGL_NO_DISPLAY;
+    EGLContext mContext = EGL_NO_CONTEXT;
+    EGLSurface mSurface = EGL_NO_SURFACE;
+    EGLConfig mConfig = nullptr;
+    DisplayBackend mActiveBackend = DisplayBackend::Auto;
+    Config mSettings;
+    
+    // 传输上下文（surfaceless 时不需要 Surface）
+    EGLContext mTransferContext = EGL_NO_CONTEXT;
+    EGLSurface mTransferSurface = EGL_NO_SURFACE;
+    
+    // GBM 显示（void* 避免在头文件中引入 gbm.h）
+    int mDrmFd = -1;
+    void* mGbmDevice = nullptr;
+    
+    bool mInitialized = false;
+    mutable std::mutex mMutex;
+};
+
+#endif // PIPELINE_HEADLESS_EGL
+
 // =============================================================================
 // 平台上下文统一接口
 // =============================================================================
@@ -273,6 +553,11 @@ struct PlatformContextConfig {
     // iOS特定
     IOSMetalContextManager::Config iosConfig;
 #endif
+    
+#if defined(PIPELINE_HEADLESS_EGL)
+    // Linux 无窗口
+    HeadlessEGLContextManager::Config headlessConfig;
+#endif
 };
 
 /**
@@ -313,6 +598,23 @@ public:
      */
     bool releaseCurrent();
     
+    /**
+     * @brief 创建传输上下文（EGL：同一共享组的第二个上下文；Metal：第二个命令队列）
+     * 
+     * 传输上下文只在执行器的传输队列线程上激活，承担上传与读回。
+     */
+    bool createTransferContext();
+    
+    /**
+     * @brief 在当前线程激活传输上下文（Metal 无需激活，直接返回true）
+     */
+    bool makeTransferCurrent();
+    
+    /**
+     * @brief 取消当前线程上的传输上下文
+     */
+    bool releaseTransferCurrent();
+    
     /**
      * @brief 检查上下文是否已初始化
      */
@@ -343,6 +645,17 @@ public:
         const float* transformMatrix = nullptr);
 #endif
     
+    // =========================================================================
+    // Linux 无窗口接口
+    // =========================================================================
+    
+#if defined(PIPELINE_HEADLESS_EGL)
+    /**
+     * @brief 获取无窗口 EGL 管理器
+     */
+    HeadlessEGLContextManager* getHeadlessEGLManager() { return mHeadlessEGLManager.get(); }
+#endif
+    
     // =========================================================================
     // iOS特定接口
     // =========================================================================
@@ -385,6 +698,10 @@ private:
 #if defined(PIPELINE_PLATFORM_IOS) || defined(PIPELINE_PLATFORM_MACOS)
     std::unique_ptr<IOSMetalContextManager> mIOSMetalManager;
 #endif
+    
+#if defined(PIPELINE_HEADLESS_EGL)
+    std::unique_ptr<HeadlessEGLContextManager> mHeadlessEGLManager;
+#endif
 };
 
 } // namespace pipeline
@@ -8,13 +8,17 @@
 #include "pipeline/data/FramePacket.h"
 #include <memory>
 #include <vector>
-#include <queue>
 #include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <chrono>
 
 namespace pipeline {
 
+namespace detail {
+struct FramePacketPoolCore;
+struct BufferPoolCore;
+} // namespace detail
+
 /**
  * @brief 帧包池配置
  */
@@ -32,7 +36,11 @@ struct FramePacketPoolConfig {
  * - 固定容量（根据管线深度配置）
  * - 支持背压机制（池空时阻塞生产者）
  * - 快速重置（清空metadata但保留纹理引用）
- * - 引用计数自动回收
+ * - 引用计数自动回收：取出的帧包带回收删除器，最后一个引用释放时归还到池
+ * 
+ * 空闲帧包与 shared_ptr 控制块均存放在无锁环形队列中，稳态下取出/归还
+ * 不加锁、不分配内存；仅在池空阻塞等待或全部归还通知时使用互斥量。
+ * 池可先于帧包销毁，在外的帧包归还时直接释放。
  */
 class FramePacketPool : public std::enable_shared_from_this<FramePacketPool> {
 public:
@@ -55,7 +63,7 @@ public:
     /**
      * @brief 获取帧包
      * 
-     * 从池中获取一个空闲的FramePacket。
+     * 从池中获取一个空闲的FramePacket，最后一个引用释放时自动归还。
      * 如果池空且启用了阻塞，则等待直到有可用的帧包或超时。
      * @return FramePacket智能指针，如果超时返回nullptr
      */
@@ -71,6 +79,7 @@ public:
     /**
      * @brief 释放帧包回池
      * 
+     * 仅放弃调用方持有的引用；帧包在最后一个引用释放时归还。
      * @param packet 帧包智能指针
      */
     void release(FramePacketPtr packet);
@@ -78,7 +87,7 @@ public:
     /**
      * @brief 创建自动释放的帧包
      * 
-     * 返回的帧包在引用计数为0时自动归还到池中。
+     * 与 acquire() 相同（所有帧包均自动归还），保留以兼容旧接口。
      * @return FramePacket智能指针
      */
     FramePacketPtr acquireAutoRelease();
@@ -98,10 +107,16 @@ public:
     /**
      * @brief 清空池
      * 
-     * 释放所有帧包。正在使用的帧包会在释放时被丢弃。
+     * 释放所有空闲帧包。正在使用的帧包仍会在释放时归还。
      */
     void clear();
     
+    /**
+     * @brief 释放空闲帧包，最多保留 keepCount 个
+     * @return 释放的帧包数
+     */
+    size_t trim(size_t keepCount = 0);
+    
     /**
      * @brief 等待所有帧包归还
      * @param timeoutMs 超时时间（毫秒），-1表示无限等待
@@ -120,6 +135,8 @@ public:
     
     /**
      * @brief 获取正在使用的帧包数量
+     * 
+     * 归还的帧包先回到空闲队列再递减计数，并发取还时可能短暂多计（仅供统计）。
      */
     size_t getInUseCount() const;
     
@@ -171,7 +188,12 @@ public:
     /**
      * @brief 获取总释放次数
      */
-    uint64_t getTotalReleases() const { return mTotalReleases.load(); }
+    uint64_t getTotalReleases() const;
+    
+    /**
+     * @brief 获取已创建的帧包数（含使用中）
+     */
+    uint32_t getCreatedCount() const;
     
     /**
      * @brief 获取阻塞等待次数
@@ -192,20 +214,14 @@ private:
     // 配置
     FramePacketPoolConfig mConfig;
     
-    // 帧包存储
-    mutable std::mutex mMutex;
-    std::condition_variable mCondition;
-    std::queue<FramePacketPtr> mAvailable;
-    std::atomic<uint32_t> mInUseCount{0};
-    std::atomic<uint32_t> mTotalCreated{0};
+    // 帧包存储（空闲队列、计数与通知；被在外帧包的删除器共同持有）
+    std::shared_ptr<detail::FramePacketPoolCore> mCore;
     
     // 状态
-    std::atomic<bool> mShutdown{false};
     std::atomic<uint64_t> mNextFrameId{1};
     
     // 统计
     std::atomic<uint64_t> mTotalAllocations{0};
-    std::atomic<uint64_t> mTotalReleases{0};
     std::atomic<uint64_t> mBlockCount{0};
     std::atomic<uint64_t> mTimeoutCount{0};
     
@@ -214,70 +230,136 @@ private:
     // ==========================================================================
     
     /**
-     * @brief 创建新帧包
-     */
-    FramePacketPtr createPacket();
-    
-    /**
-     * @brief 重置帧包状态
+     * @brief 取出空闲帧包，无空闲时在容量内创建
+     * @return 帧包裸指针，池满时返回nullptr
      */
-    void resetPacket(FramePacketPtr packet);
+    FramePacket* takePacket();
     
     /**
-     * @brief 自动释放删除器
+     * @brief 包装为带回收删除器的智能指针
      */
-    static void autoReleaseDeleter(FramePacket* packet, 
-                                   std::weak_ptr<FramePacketPool> weakPool);
+    FramePacketPtr wrapPacket(FramePacket* packet);
+};
+
+/**
+ * @brief 缓冲池配置
+ */
+struct BufferPoolConfig {
+    size_t maxBuffersPerClass = 16;                 // 每个尺寸级保留的空闲缓冲上限
+    size_t maxPooledBytes = 256u * 1024 * 1024;     // 空闲缓冲总字节上限（超出时直接释放）
+};
+
+/**
+ * @brief 缓冲池统计
+ */
+struct BufferPoolStats {
+    size_t pooledBytes = 0;      // 共享空闲链表中的字节（trim/clear 可回收）
+    size_t threadCachedBytes = 0; // 各线程缓存中的空闲字节（只含小尺寸级，trim 无法回收）
+    size_t liveBytes = 0;        // 在外（被持有）字节
+    uint64_t hits = 0;           // 复用次数
+    uint64_t misses = 0;         // 新分配次数
 };
 
 /**
  * @brief 缓冲池
  * 
- * 管理CPU缓冲区的复用。
+ * 管理CPU帧缓冲的复用（按尺寸分级的 slab）：
+ * - 尺寸对数线性分级（每个 2 的幂再分 4 级，容量浪费不超过 25%），同级缓冲可互换
+ * - 缓冲按 kAlignment（64 字节）对齐，便于 SIMD 访问
+ * - 取出的缓冲带回收删除器，最后一个引用释放时自动归还，无需调用 release
+ * - 每线程缓存少量最近归还的小缓冲（不超过 kThreadCacheMaxSize），同线程取还不加锁；
+ *   帧尺寸的大缓冲总是回到共享链表，trim/clear 可以全部回收
+ * - 空闲字节上限与 trim 接口，供内存压力时回收
+ * 
+ * 池可先于缓冲销毁，在外的缓冲归还时直接释放。
  */
 class BufferPool {
 public:
+    static constexpr size_t kAlignment = 64;
+    static constexpr size_t kMinClassSize = 256;
+    static constexpr size_t kThreadCacheMaxSize = 64 * 1024;   // 进入线程缓存的最大尺寸级
+    
     /**
      * @brief 构造函数
-     * @param maxBuffers 最大缓冲区数量
+     * @param maxBuffers 每个尺寸级最大空闲缓冲数量
      */
     explicit BufferPool(size_t maxBuffers = 16);
     
+    explicit BufferPool(const BufferPoolConfig& config);
+    
     ~BufferPool();
     
+    // 禁止拷贝
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    
+    /**
+     * @brief 全局共享池
+     * 
+     * FramePacket、InputEntity、CPUEntity 等的CPU帧缓冲默认从这里分配。
+     */
+    static BufferPool& shared();
+    
     /**
      * @brief 获取缓冲区
-     * @param size 所需大小
-     * @return 缓冲区智能指针
+     * @param size 所需大小（实际容量为所在尺寸级大小）
+     * @return 64字节对齐的缓冲区智能指针，size为0时返回nullptr
      */
     std::shared_ptr<uint8_t> acquire(size_t size);
     
     /**
      * @brief 释放缓冲区
+     * 
+     * 仅放弃调用方持有的引用；池内缓冲在最后一个引用释放时归还，其他缓冲直接释放。
      */
     void release(std::shared_ptr<uint8_t> buffer, size_t size);
     
     /**
-     * @brief 清空池
+     * @brief 清空池（释放共享链表中的所有空闲缓冲）
+     * 
+     * 线程缓存中的小缓冲（每线程至多两个，不超过 kThreadCacheMaxSize）在该线程
+     * 下次归还缓冲或退出时释放，期间仍计入 getMemoryUsage。
      */
     void clear();
     
     /**
-     * @brief 获取内存使用量
+     * @brief 收缩空闲缓冲至不超过 targetBytes（先释放最久未用的）
+     * 
+     * 只作用于共享链表；线程缓存中的小缓冲在该线程下次归还或退出时释放。
+     * @return 释放的字节数
+     */
+    size_t trim(size_t targetBytes = 0);
+    
+    /**
+     * @brief 释放空闲超过 idleTime 的缓冲
+     * @return 释放的字节数
+     */
+    size_t trimIdle(std::chrono::milliseconds idleTime);
+    
+    /**
+     * @brief 设置配置（缩小上限时立即收缩）
+     */
+    void setConfig(const BufferPoolConfig& config);
+    
+    BufferPoolConfig getConfig() const;
+    
+    /**
+     * @brief 获取内存使用量（空闲缓冲字节，含线程缓存）
      */
     size_t getMemoryUsage() const;
     
+    /**
+     * @brief 获取统计信息
+     */
+    BufferPoolStats getStats() const;
+    
+    /**
+     * @brief 获取 size 对应的实际分配容量
+     */
+    static size_t getAllocationSize(size_t size);
+    
 private:
-    struct BufferEntry {
-        std::shared_ptr<uint8_t> buffer;
-        size_t size;
-        std::chrono::steady_clock::time_point lastUsed;
-    };
-    
-    mutable std::mutex mMutex;
-    std::vector<BufferEntry> mBuffers;
-    size_t mMaxBuffers;
-    std::atomic<size_t> mTotalMemory{0};
+    std::shared_ptr<detail::BufferPoolCore> mCore;
 };
 
 } // namespace pipeline
@@ -0,0 +1,166 @@
+/**
+ * @file GpuResourceRegistry.h
+ * @brief GPU共享资源表 - 全屏四边形、管线状态对象、采样器在同一渲染上下文内共用
+ *
+ * 每个GPU节点原本各自创建顶点缓冲和管线状态，节点越多创建开销越大，
+ * 相邻节点之间的状态切换也无法被驱动合并。资源表按描述去重：
+ * 整条管线只有一个全屏四边形VBO，相同 (程序, 混合, 颜色格式) 的节点共享同一个管线状态，
+ * 图重建时沿用已有对象，不会反复创建/销毁。
+ */
+
+#pragma once
+
+#include "pipeline/data/EntityTypes.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+// 前向声明
+namespace lrengine {
+namespace render {
+class LRRenderContext;
+class LRShaderProgram;
+class LRPipelineState;
+class LRVertexBuffer;
+class LRSampler;
+} // namespace render
+} // namespace lrengine
+
+namespace pipeline {
+
+/**
+ * @brief 固定功能混合方式（光栅阶段，与 CompositeEntity 的着色器混合模式无关）
+ */
+enum class RasterBlend : uint8_t {
+    None,           // 不混合（覆盖写入，滤镜默认）
+    Alpha,          // 颜色 src * a + dst * (1 - a)，alpha 通道 a + dstA * (1 - a)（图层叠加）
+    Premultiplied,  // src + dst * (1 - a)
+    Additive        // src + dst
+};
+
+/**
+ * @brief 采样过滤方式
+ */
+enum class SamplerFilter : uint8_t {
+    Nearest,
+    Linear
+};
+
+/**
+ * @brief 采样边缘处理
+ */
+enum class SamplerWrap : uint8_t {
+    ClampToEdge,
+    Repeat,
+    MirroredRepeat
+};
+
+/**
+ * @brief 资源表统计
+ */
+struct GpuResourceStats {
+    uint64_t pipelineStateHits = 0;     // 命中已有管线状态
+    uint64_t pipelineStateCreates = 0;  // 实际创建次数
+    uint64_t samplerCreates = 0;
+    size_t cachedPipelineStates = 0;
+    size_t cachedSamplers = 0;
+    bool hasFullscreenQuad = false;
+};
+
+/**
+ * @brief 渲染上下文级的GPU共享资源表
+ *
+ * 所有方法需在持有渲染上下文的线程调用（GPU队列或 prepare 阶段）；
+ * 内部加锁只为统计与 trim 可在其他线程读取。
+ * 管线状态以程序指针为键，条目同时持有程序引用，程序被缓存淘汰后指针也不会被复用。
+ */
+class GpuResourceRegistry {
+public:
+    using ShaderProgramPtr = std::shared_ptr<lrengine::render::LRShaderProgram>;
+    using PipelineStatePtr = std::shared_ptr<lrengine::render::LRPipelineState>;
+    using VertexBufferPtr = std::shared_ptr<lrengine::render::LRVertexBuffer>;
+    using SamplerPtr = std::shared_ptr<lrengine::render::LRSampler>;
+
+    explicit GpuResourceRegistry(lrengine::render::LRRenderContext* context);
+    ~GpuResourceRegistry();
+
+    // 禁止拷贝
+    GpuResourceRegistry(const GpuResourceRegistry&) = delete;
+    GpuResourceRegistry& operator=(const GpuResourceRegistry&) = delete;
+
+    /**
+     * @brief 获取共享的全屏四边形（首次调用时创建）
+     *
+     * 顶点布局：位置 (x, y) + 纹理坐标 (u, v)，三角形条带，4个顶点。
+     */
+    VertexBufferPtr acquireFullscreenQuad();
+
+    /**
+     * @brief 获取管线状态（相同程序、混合方式、颜色格式共用一个对象）
+     * @return 程序为空或创建失败时返回nullptr
+     */
+    PipelineStatePtr acquirePipelineState(const ShaderProgramPtr& program,
+                                          RasterBlend blend = RasterBlend::None,
+                                          PixelFormat colorFormat = PixelFormat::RGBA8);
+
+    /**
+     * @brief 获取采样器
+     */
+    SamplerPtr acquireSampler(SamplerFilter filter = SamplerFilter::Linear,
+                              SamplerWrap wrap = SamplerWrap::ClampToEdge);
+
+    /**
+     * @brief 释放只被资源表引用的管线状态（图重建后旧程序对应的状态）
+     * @return 释放的对象数
+     */
+    size_t trim();
+
+    /**
+     * @brief 释放全部资源（上下文销毁前调用）
+     */
+    void clear();
+
+    GpuResourceStats getStats() const;
+
+    lrengine::render::LRRenderContext* getRenderContext() const { return mRenderContext; }
+
+private:
+    struct PipelineStateKey {
+        const lrengine::render::LRShaderProgram* program = nullptr;
+        RasterBlend blend = RasterBlend::None;
+        PixelFormat colorFormat = PixelFormat::RGBA8;
+
+        bool operator<(const PipelineStateKey& other) const {
+            return std::tie(program, blend, colorFormat) <
+                   std::tie(other.program, other.blend, other.colorFormat);
+        }
+    };
+
+    struct PipelineStateEntry {
+        ShaderProgramPtr program;       // 保持程序存活，键中的指针不会失效
+        PipelineStatePtr state;
+    };
+
+    PipelineStatePtr createPipelineState(const ShaderProgramPtr& program,
+                                         RasterBlend blend, PixelFormat colorFormat);
+    SamplerPtr createSampler(SamplerFilter filter, SamplerWrap wrap);
+    VertexBufferPtr createFullscreenQuad();
+
+    lrengine::render::LRRenderContext* mRenderContext = nullptr;
+
+    mutable std::mutex mMutex;
+    VertexBufferPtr mFullscreenQuad;
+    std::map<PipelineStateKey, PipelineStateEntry> mPipelineStates;
+    std::map<std::pair<SamplerFilter, SamplerWrap>, SamplerPtr> mSamplers;
+
+    std::atomic<uint64_t> mPipelineStateHits{0};
+    std::atomic<uint64_t> mPipelineStateCreates{0};
+    std::atomic<uint64_t> mSamplerCreates{0};
+};
+
+} // namespace pipeline
@@ -0,0 +1,163 @@
+/**
+ * @file ResourceHub.h
+ * @brief 进程级资源中心 - 同一渲染上下文上的多条管线共用纹理池、GPU资源表与GPU队列
+ *
+ * 预览管线和缩略图/导出管线同时运行时，各自的 TexturePool 会为相同尺寸的中间纹理
+ * 分别分配显存。接入资源中心后，同一渲染上下文只有一个共享纹理池，
+ * 每条管线经纹理池视图（TexturePool::createView）取用，按管线统计在用字节并执行配额；
+ * GpuResourceRegistry 与 GPU 串行队列也按上下文共用（GL 上下文只能在一个线程上使用）。
+ *
+ * 帧包池不共享：其容量就是每条管线的背压深度，帧包本身也不占显存。
+ */
+
+#pragma once
+
+#include "pipeline/pool/TexturePool.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace task {
+class TaskQueue;
+} // namespace task
+
+namespace pipeline {
+
+class GpuResourceRegistry;
+
+/**
+ * @brief 单条管线的资源配额
+ */
+struct ResourceQuota {
+    size_t textureBytes = 0;        // 在用纹理字节上限（0表示不限）
+};
+
+/**
+ * @brief 单条管线的资源统计
+ */
+struct ResourceClientStats {
+    std::string name;
+    lrengine::render::LRRenderContext* renderContext = nullptr;
+    size_t textureCount = 0;        // 在用纹理数
+    size_t textureBytes = 0;        // 在用纹理字节数
+    size_t peakTextureBytes = 0;
+    size_t quotaBytes = 0;
+    uint64_t quotaRejects = 0;      // 因配额被拒绝的分配次数
+};
+
+/**
+ * @brief 管线持有的共享资源租约，析构时从资源中心注销
+ *
+ * 同一上下文的最后一个租约释放时，共享纹理池、GPU资源表与该上下文的着色器缓存一并释放，
+ * 因此应在 GPU 资源可以销毁的时机（管线 release）释放租约。
+ */
+class ResourceLease {
+public:
+    ~ResourceLease();
+
+    ResourceLease(const ResourceLease&) = delete;
+    ResourceLease& operator=(const ResourceLease&) = delete;
+
+    const std::string& getName() const { return mName; }
+    lrengine::render::LRRenderContext* getRenderContext() const { return mRenderContext; }
+
+    /**
+     * @brief 本管线的纹理池视图
+     */
+    const std::shared_ptr<TexturePool>& getTexturePool() const { return mTexturePool; }
+
+    /**
+     * @brief 上下文共用的GPU资源表
+     */
+    const std::shared_ptr<GpuResourceRegistry>& getGpuResources() const { return mGpuResources; }
+
+    /**
+     * @brief 上下文共用的GPU串行队列（attach 时未请求则为空）
+     */
+    const std::shared_ptr<task::TaskQueue>& getGPUQueue() const { return mGPUQueue; }
+
+    ResourceClientStats getStats() const;
+
+private:
+    friend class ResourceHub;
+    ResourceLease() = default;
+
+    std::string mName;
+    lrengine::render::LRRenderContext* mRenderContext = nullptr;
+    std::shared_ptr<TexturePool> mTexturePool;
+    std::shared_ptr<GpuResourceRegistry> mGpuResources;
+    std::shared_ptr<task::TaskQueue> mGPUQueue;
+};
+
+using ResourceLeasePtr = std::shared_ptr<ResourceLease>;
+
+/**
+ * @brief 进程级资源中心（线程安全）
+ *
+ * 使用示例：
+ * @code
+ * ResourceQuota quota;
+ * quota.textureBytes = 64u << 20;
+ * auto lease = ResourceHub::shared().attach(context, "Thumbnail", poolConfig, quota, true);
+ * pipelineContext->setTexturePool(lease->getTexturePool());
+ * @endcode
+ */
+class ResourceHub {
+public:
+    static ResourceHub& shared();
+
+    ResourceHub(const ResourceHub&) = delete;
+    ResourceHub& operator=(const ResourceHub&) = delete;
+
+    /**
+     * @brief 登记一条管线
+     * @param context 渲染上下文（共享范围）
+     * @param name 管线名称（用于统计）
+     * @param poolConfig 纹理池配置；上下文已有共享池时只放宽数量与预算，不收紧
+     * @param quota 本管线配额
+     * @param shareGPUQueue 是否共用该上下文的GPU串行队列
+     * @return 租约；context 为空时返回 nullptr
+     */
+    ResourceLeasePtr attach(lrengine::render::LRRenderContext* context,
+                            const std::string& name,
+                            const TexturePoolConfig& poolConfig,
+                            const ResourceQuota& quota,
+                            bool shareGPUQueue);
+
+    /**
+     * @brief 全部管线的资源统计
+     */
+    std::vector<ResourceClientStats> getClientStats() const;
+
+    /**
+     * @brief 上下文当前的管线数
+     */
+    size_t getClientCount(lrengine::render::LRRenderContext* context) const;
+
+    /**
+     * @brief 上下文共享纹理池的总显存（含空闲纹理）
+     */
+    size_t getTextureMemoryUsage(lrengine::render::LRRenderContext* context) const;
+
+private:
+    ResourceHub() = default;
+
+    struct ContextResources {
+        std::shared_ptr<TexturePool> texturePool;
+        std::shared_ptr<GpuResourceRegistry> gpuResources;
+        std::shared_ptr<task::TaskQueue> gpuQueue;
+        std::vector<ResourceLease*> leases;
+    };
+
+    friend class ResourceLease;
+    void detach(ResourceLease* lease);
+
+    mutable std::mutex mMutex;
+    std::unordered_map<lrengine::render::LRRenderContext*, ContextResources> mContexts;
+};
+
+} // namespace pipeline
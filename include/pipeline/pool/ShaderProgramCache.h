@@ -0,0 +1,161 @@
+/**
+ * @file ShaderProgramCache.h
+ * @brief 着色器程序缓存 - 进程内按源码哈希复用，磁盘持久化程序二进制
+ *
+ * 冷启动时每个GPU节点都要编译着色器，低端 Android 上可达数百毫秒。
+ * 同一源码在同一渲染上下文中只编译一次（布局变化、计划重编、融合链重建都命中内存缓存）；
+ * 配置磁盘目录与平台二进制后端后，第二次启动直接加载程序二进制
+ * （GLES glProgramBinary / Metal binary archive），跳过编译。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 前向声明
+namespace lrengine {
+namespace render {
+class LRRenderContext;
+class LRShaderProgram;
+} // namespace render
+} // namespace lrengine
+
+namespace pipeline {
+
+using ShaderProgramPtr = std::shared_ptr<lrengine::render::LRShaderProgram>;
+
+/**
+ * @brief 程序二进制后端（平台相关，在持有渲染上下文的线程调用）
+ */
+class ProgramBinaryBackend {
+public:
+    virtual ~ProgramBinaryBackend() = default;
+
+    /**
+     * @brief 驱动标识（如 GL_RENDERER + GL_VERSION）
+     *
+     * 二进制只在同一驱动上有效，标识变化（系统/驱动升级）时旧文件自动失效。
+     */
+    virtual std::string getDriverKey() = 0;
+
+    /**
+     * @brief 取出已链接程序的二进制
+     */
+    virtual bool saveBinary(lrengine::render::LRShaderProgram& program,
+                            std::vector<uint8_t>& binary) = 0;
+
+    /**
+     * @brief 由二进制创建程序（驱动拒绝时返回nullptr，缓存随后回退到编译）
+     */
+    virtual ShaderProgramPtr loadBinary(lrengine::render::LRRenderContext* context,
+                                        const std::vector<uint8_t>& binary) = 0;
+};
+
+/**
+ * @brief 着色器缓存统计
+ */
+struct ShaderCacheStats {
+    uint64_t memoryHits = 0;        // 进程内命中
+    uint64_t diskHits = 0;          // 由磁盘二进制加载
+    uint64_t compiles = 0;          // 实际编译次数
+    uint64_t binaryWrites = 0;      // 写入磁盘的二进制数
+    uint64_t binaryRejects = 0;     // 驱动拒绝或文件损坏（已删除）
+    size_t cachedPrograms = 0;
+};
+
+/**
+ * @brief 进程级着色器程序缓存
+ *
+ * 键为 (渲染上下文, 顶点+片段源码哈希)；命中时还会比较源码全文，哈希冲突不会返回错误的程序。
+ * 缓存持有程序引用，上下文销毁前应调用 purge(context)。
+ */
+class ShaderProgramCache {
+public:
+    using CompileFunc = std::function<ShaderProgramPtr()>;
+
+    static ShaderProgramCache& instance();
+
+    // 禁止拷贝
+    ShaderProgramCache(const ShaderProgramCache&) = delete;
+    ShaderProgramCache& operator=(const ShaderProgramCache&) = delete;
+
+    /**
+     * @brief 设置磁盘缓存目录（空字符串关闭持久化）
+     * @param directory 目录（需已存在且可写，如应用缓存目录）
+     */
+    void setDiskCacheDirectory(const std::string& directory);
+
+    /**
+     * @brief 设置程序二进制后端（未设置时只有进程内缓存）
+     */
+    void setBinaryBackend(std::unique_ptr<ProgramBinaryBackend> backend);
+
+    /**
+     * @brief 获取程序：内存命中 -> 磁盘二进制 -> compile()
+     *
+     * 需在持有 context 的线程调用；compile 失败（返回nullptr）时不缓存。
+     */
+    ShaderProgramPtr acquire(lrengine::render::LRRenderContext* context,
+                             const std::string& vertexSource,
+                             const std::string& fragmentSource,
+                             const CompileFunc& compile);
+
+    /**
+     * @brief 释放上下文的全部程序（context 为空时释放全部）
+     * @return 释放的程序数
+     */
+    size_t purge(lrengine::render::LRRenderContext* context = nullptr);
+
+    /**
+     * @brief 释放只被缓存引用的程序
+     */
+    size_t trim();
+
+    ShaderCacheStats getStats() const;
+
+    /**
+     * @brief 源码哈希（FNV-1a 64）
+     */
+    static uint64_t hashSource(const std::string& vertexSource, const std::string& fragmentSource);
+
+private:
+    ShaderProgramCache() = default;
+
+    struct Entry {
+        std::string vertexSource;
+        std::string fragmentSource;
+        ShaderProgramPtr program;
+    };
+    using Key = std::pair<lrengine::render::LRRenderContext*, uint64_t>;
+
+    ShaderProgramPtr loadFromDisk(lrengine::render::LRRenderContext* context,
+                                  uint64_t hash, uint64_t check);
+    void storeToDisk(lrengine::render::LRShaderProgram& program, uint64_t hash, uint64_t check);
+    std::string binaryPath(uint64_t hash) const;
+    uint64_t driverKeyHash();
+
+    mutable std::mutex mMutex;
+    std::multimap<Key, Entry> mEntries;         // 同键多项即哈希冲突
+
+    std::mutex mDiskMutex;                      // 磁盘读写与二进制后端
+
+    std::string mDirectory;
+    std::unique_ptr<ProgramBinaryBackend> mBackend;
+    uint64_t mDriverKeyHash = 0;                // 懒计算，需在GPU线程取驱动标识
+
+    std::atomic<uint64_t> mMemoryHits{0};
+    std::atomic<uint64_t> mDiskHits{0};
+    std::atomic<uint64_t> mCompiles{0};
+    std::atomic<uint64_t> mBinaryWrites{0};
+    std::atomic<uint64_t> mBinaryRejects{0};
+};
+
+} // namespace pipeline
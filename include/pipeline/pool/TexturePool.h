@@ -10,6 +10,7 @@
 #include <vector>
 #include <unordered_map>
 #include <mutex>
+#include <atomic>
 #include <functional>
 #include <chrono>
 
@@ -43,10 +44,11 @@ struct TextureSpec {
  */
 struct TextureSpecHash {
     size_t operator()(const TextureSpec& spec) const {
-        size_t h1 = std::hash<uint32_t>{}(spec.width);
-        size_t h2 = std::hash<uint32_t>{}(spec.height);
-        size_t h3 = std::hash<uint8_t>{}(static_cast<uint8_t>(spec.format));
-        return h1 ^ (h2 << 1) ^ (h3 << 2);
+        // 宽高各取低24位、格式8位拼成一个键，常见尺寸之间不冲突
+        uint64_t key = (static_cast<uint64_t>(spec.width & 0xFFFFFF) << 32) |
+                       (static_cast<uint64_t>(spec.height & 0xFFFFFF) << 8) |
+                       static_cast<uint64_t>(spec.format);
+        return std::hash<uint64_t>{}(key);
     }
 };
 
@@ -54,22 +56,31 @@ struct TextureSpecHash {
  * @brief 纹理池配置
  */
 struct TexturePoolConfig {
-    uint32_t maxTexturesPerBucket = 4;    // 每个桶的最大纹理数
-    uint32_t maxTotalTextures = 32;       // 最大总纹理数
+    uint32_t maxTexturesPerBucket = 4;    // 每个桶保留的最大空闲纹理数
+    uint32_t maxTotalTextures = 32;       // 最大总纹理数（超出时不再回收归还的纹理）
     uint32_t idleTimeoutMs = 5000;        // 空闲超时（毫秒）
-    bool enableLRU = true;                 // 启用LRU淘汰
+    bool enableLRU = true;                 // 启用LRU淘汰（超出预算时跨桶淘汰最久未用的空闲纹理）
+    size_t maxBytes = 0;                   // 显存预算（字节，0表示不限）
+    uint32_t trimIntervalMs = 1000;        // 空闲清理间隔（毫秒，在 acquire/release 中顺带执行，0表示仅 cleanup()）
 };
 
 /**
  * @brief 纹理池
  * 
  * 管理GPU纹理资源的复用，特点：
- * - 按尺寸和格式分桶管理
- * - LRU淘汰策略
+ * - 按尺寸和格式分桶管理，每个桶一条侵入式空闲链表，取出/归还 O(1)
+ * - 数量与内存计数增量维护，状态查询不加锁
+ * - 显存预算（maxBytes）：超出时跨桶按LRU淘汰空闲纹理，不阻塞调用方
  * - 支持预热（预分配常用尺寸）
- * - 自动释放长时间未使用的纹理
+ * - 空闲超时的纹理在 acquire/release 中按 trimIntervalMs 顺带释放
+ *
+ * 纹理的创建与销毁都发生在调用 acquire/release/cleanup 的线程上（通常为GPU队列），
+ * 因此不使用独立的清理线程：GL资源只能在持有上下文的线程上释放。
+ *
+ * 视图（createView）：多条管线共用一个池时，每条管线持有一个视图。视图本身不存放纹理，
+ * 取出/归还转给共享池，只统计本管线在用的纹理数与字节数，并按配额拒绝超出的分配。
  */
-class TexturePool {
+class TexturePool : public std::enable_shared_from_this<TexturePool> {
 public:
     /**
      * @brief 构造函数
@@ -85,6 +96,15 @@ public:
     TexturePool(const TexturePool&) = delete;
     TexturePool& operator=(const TexturePool&) = delete;
     
+    /**
+     * @brief 创建共享池的视图
+     * @param upstream 共享池
+     * @param quotaBytes 本视图在用纹理的字节上限（0表示不限）
+     * @return 视图；upstream 为空时返回 nullptr
+     */
+    static std::shared_ptr<TexturePool> createView(std::shared_ptr<TexturePool> upstream,
+                                                   size_t quotaBytes = 0);
+    
     // ==========================================================================
     // 纹理获取和释放
     // ==========================================================================
@@ -119,7 +139,8 @@ public:
     /**
      * @brief 创建自动释放的纹理
      * 
-     * 返回的纹理在智能指针销毁时自动归还到池中。
+     * 返回的纹理在智能指针销毁时自动归还到池中。池由 shared_ptr 持有时，
+     * 池先于纹理销毁也是安全的（纹理随之直接释放）。
      * @return 带自定义删除器的纹理智能指针
      */
     std::shared_ptr<lrengine::render::LRTexture> acquireAutoRelease(
@@ -155,7 +176,8 @@ public:
     /**
      * @brief 清空池
      * 
-     * 释放所有纹理（包括正在使用的）。
+     * 释放所有纹理（包括正在使用的）。视图不持有纹理，调用无效果，
+     * 在用纹理归还时照常转给共享池。
      */
     void clear();
     
@@ -166,6 +188,12 @@ public:
      */
     void shrink();
     
+    /**
+     * @brief 按LRU释放空闲纹理，直到池内纹理总内存不超过 targetBytes
+     * @return 释放的字节数
+     */
+    size_t trim(size_t targetBytes);
+    
     // ==========================================================================
     // 状态查询
     // ==========================================================================
@@ -191,10 +219,15 @@ public:
     size_t getTotalCount() const;
     
     /**
-     * @brief 获取池的内存使用量（字节）
+     * @brief 获取池的内存使用量（字节，视图为本视图在用纹理的字节数）
      */
     size_t getMemoryUsage() const;
     
+    /**
+     * @brief 内存使用量峰值（字节）
+     */
+    size_t getPeakMemoryUsage() const { return mPeakBytes.load(std::memory_order_relaxed); }
+    
     /**
      * @brief 获取命中率
      */
@@ -219,33 +252,89 @@ public:
      */
     void setConfig(const TexturePoolConfig& config);
     
+    // ==========================================================================
+    // 视图
+    // ==========================================================================
+    
+    /**
+     * @brief 是否为共享池的视图
+     */
+    bool isView() const { return mUpstream != nullptr; }
+    
+    /**
+     * @brief 视图对应的共享池（非视图为空）
+     */
+    const std::shared_ptr<TexturePool>& getUpstream() const { return mUpstream; }
+    
+    /**
+     * @brief 设置视图配额（字节，0表示不限；已在用的纹理不受影响）
+     */
+    void setQuotaBytes(size_t quotaBytes) { mQuotaBytes.store(quotaBytes, std::memory_order_relaxed); }
+    size_t getQuotaBytes() const { return mQuotaBytes.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 因超出配额被拒绝的分配次数
+     */
+    uint64_t getQuotaRejectCount() const { return mQuotaRejects.load(std::memory_order_relaxed); }
+    
 private:
+    struct Bucket;
+    
     /**
      * @brief 纹理项
      */
     struct TextureEntry {
         std::shared_ptr<lrengine::render::LRTexture> texture;
-        TextureSpec spec;
+        Bucket* bucket = nullptr;
         std::chrono::steady_clock::time_point lastUsed;
         bool inUse = false;
+        
+        // 空闲时同时位于所在桶的空闲链表与全局LRU链表
+        TextureEntry* freePrev = nullptr;
+        TextureEntry* freeNext = nullptr;
+        TextureEntry* lruPrev = nullptr;
+        TextureEntry* lruNext = nullptr;
     };
     
     /**
      * @brief 桶
      */
     struct Bucket {
-        std::vector<TextureEntry> entries;
+        TextureSpec spec;
+        size_t textureBytes = 0;
+        TextureEntry* freeHead = nullptr;    // 最近归还
+        TextureEntry* freeTail = nullptr;    // 最久未用
+        size_t freeCount = 0;
+        size_t totalCount = 0;
     };
     
+    using TextureList = std::vector<std::shared_ptr<lrengine::render::LRTexture>>;
+    
     // 渲染上下文
     lrengine::render::LRRenderContext* mRenderContext;
     
+    // 视图：共享池与配额；mViewTextures 记录经本视图取出、尚未归还的纹理（mMutex 保护）
+    std::shared_ptr<TexturePool> mUpstream;
+    std::atomic<size_t> mQuotaBytes{0};
+    std::unordered_map<const lrengine::render::LRTexture*, size_t> mViewTextures;
+    std::atomic<uint64_t> mQuotaRejects{0};
+    
     // 配置
     TexturePoolConfig mConfig;
     
-    // 纹理存储（按规格分桶）
+    // 纹理存储（按规格分桶），以下均由 mMutex 保护
     mutable std::mutex mMutex;
-    std::unordered_map<TextureSpec, Bucket, TextureSpecHash> mBuckets;
+    std::unordered_map<TextureSpec, std::unique_ptr<Bucket>, TextureSpecHash> mBuckets;
+    std::unordered_map<const lrengine::render::LRTexture*, std::unique_ptr<TextureEntry>> mEntries;
+    TextureEntry* mLruHead = nullptr;        // 最久未用的空闲纹理
+    TextureEntry* mLruTail = nullptr;
+    std::chrono::steady_clock::time_point mLastTrimTime;
+    
+    // 计数（锁内更新，锁外读取）
+    std::atomic<size_t> mTotalCount{0};
+    std::atomic<size_t> mIdleCount{0};
+    std::atomic<size_t> mTotalBytes{0};
+    std::atomic<size_t> mPeakBytes{0};
     
     // 统计
     std::atomic<uint64_t> mHitCount{0};
@@ -257,16 +346,65 @@ private:
     // 内部方法
     // ==========================================================================
     
+    /**
+     * @brief 视图的取出/归还：按配额预留字节后转给共享池
+     */
+    std::shared_ptr<lrengine::render::LRTexture> acquireThroughView(const TextureSpec& spec);
+    void releaseThroughView(std::shared_ptr<lrengine::render::LRTexture> texture);
+    
+    /**
+     * @brief 更新内存峰值
+     */
+    void updatePeakBytes(size_t bytes);
+    
     /**
      * @brief 创建新纹理
      */
     std::shared_ptr<lrengine::render::LRTexture> createTexture(const TextureSpec& spec);
     
     /**
-     * @brief 从桶中获取纹理
+     * @brief 从桶中获取纹理（锁内调用）
      */
     std::shared_ptr<lrengine::render::LRTexture> acquireFromBucket(Bucket& bucket);
     
+    /**
+     * @brief 获取或创建桶（锁内调用）
+     */
+    Bucket& getBucketLocked(const TextureSpec& spec);
+    
+    /**
+     * @brief 登记新纹理（锁内调用），inUse 为 false 时加入空闲链表
+     */
+    void registerTextureLocked(Bucket& bucket, std::shared_ptr<lrengine::render::LRTexture> texture,
+                               bool inUse, std::chrono::steady_clock::time_point now);
+    
+    /**
+     * @brief 空闲链表维护（锁内调用）
+     */
+    void pushIdleLocked(TextureEntry* entry);
+    void removeIdleLocked(TextureEntry* entry);
+    
+    /**
+     * @brief 移除纹理，纹理对象移入 victims 由调用方在锁外释放（锁内调用）
+     */
+    void destroyEntryLocked(TextureEntry* entry, TextureList& victims);
+    
+    /**
+     * @brief 按LRU淘汰空闲纹理直到总内存不超过 targetBytes（锁内调用）
+     */
+    size_t evictLocked(size_t targetBytes, TextureList& victims);
+    
+    /**
+     * @brief 释放超过空闲超时的纹理（锁内调用），force 为 false 时按 trimIntervalMs 节流
+     */
+    void trimIdleLocked(std::chrono::steady_clock::time_point now, TextureList& victims,
+                        bool force = false);
+    
+    /**
+     * @brief 按配置收缩（锁内调用）
+     */
+    void shrinkLocked(TextureList& victims);
+    
     /**
      * @brief 计算纹理内存大小
      */
@@ -0,0 +1,131 @@
+/**
+ * @file PixelKernels.h
+ * @brief CPU像素内核 - 灰度、YUV转换、缩放、LUT与混合
+ *
+ * 灰度转换为自带的 NEON/SSE2/AVX2 实现（启动时按CPU特性选择），
+ * 其余内核经 libyuv（其内部同样按CPU特性分派 NEON/SSSE3/AVX2）。
+ * 像素格式均为内存字节序 RGBA（libyuv 中称为 ABGR），步长单位为字节。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pipeline {
+namespace simd {
+
+/**
+ * @brief CPU特性
+ */
+struct CpuFeatures {
+    bool neon = false;
+    bool sse2 = false;
+    bool avx2 = false;
+};
+
+/**
+ * @brief 获取当前CPU特性（首次调用时检测）
+ */
+const CpuFeatures& cpuFeatures();
+
+/**
+ * @brief 启用/禁用自带的SIMD实现（禁用后走标量路径，用于对比与排查）
+ */
+void setSimdEnabled(bool enabled);
+
+// =============================================================================
+// 颜色转换
+// =============================================================================
+
+/**
+ * @brief RGBA -> 灰度，Gray = (77*R + 150*G + 29*B) >> 8
+ */
+void rgbaToGray(const uint8_t* rgba, uint32_t rgbaStride,
+                uint8_t* gray, uint32_t grayStride,
+                uint32_t width, uint32_t height);
+
+/**
+ * @brief RGBA -> I420（BT.601 limited range）
+ */
+bool rgbaToI420(const uint8_t* rgba, uint32_t rgbaStride,
+                uint8_t* y, uint32_t yStride,
+                uint8_t* u, uint32_t uStride,
+                uint8_t* v, uint32_t vStride,
+                uint32_t width, uint32_t height);
+
+/**
+ * @brief RGBA -> NV12（BT.601 limited range）
+ */
+bool rgbaToNV12(const uint8_t* rgba, uint32_t rgbaStride,
+                uint8_t* y, uint32_t yStride,
+                uint8_t* uv, uint32_t uvStride,
+                uint32_t width, uint32_t height);
+
+/**
+ * @brief I420 -> RGBA
+ */
+bool i420ToRgba(const uint8_t* y, uint32_t yStride,
+                const uint8_t* u, uint32_t uStride,
+                const uint8_t* v, uint32_t vStride,
+                uint8_t* rgba, uint32_t rgbaStride,
+                uint32_t width, uint32_t height);
+
+/**
+ * @brief NV12 -> RGBA
+ */
+bool nv12ToRgba(const uint8_t* y, uint32_t yStride,
+                const uint8_t* uv, uint32_t uvStride,
+                uint8_t* rgba, uint32_t rgbaStride,
+                uint32_t width, uint32_t height);
+
+// =============================================================================
+// 缩放
+// =============================================================================
+
+/**
+ * @brief 缩放滤波方式
+ */
+enum class ScaleFilter : uint8_t {
+    Bilinear,    // 双线性（放大或小幅缩小）
+    Box          // 盒式平均（大幅缩小时无混叠）
+};
+
+/**
+ * @brief 缩放图像
+ * @param channels 每像素字节数：1 与 4 走 libyuv，其他走标量路径
+ */
+bool scale(const uint8_t* src, uint32_t srcStride, uint32_t srcWidth, uint32_t srcHeight,
+           uint8_t* dst, uint32_t dstStride, uint32_t dstWidth, uint32_t dstHeight,
+           uint32_t channels, ScaleFilter filter = ScaleFilter::Bilinear);
+
+// =============================================================================
+// LUT与混合
+// =============================================================================
+
+/**
+ * @brief 逐通道查表（RGBA），table[value * 4 + channel]，src 与 dst 可相同
+ */
+bool applyChannelLut(const uint8_t* src, uint32_t srcStride,
+                     uint8_t* dst, uint32_t dstStride,
+                     uint32_t width, uint32_t height,
+                     const uint8_t* table);
+
+/**
+ * @brief 预乘 alpha（RGBA），src 与 dst 可相同
+ */
+bool premultiplyAlpha(const uint8_t* src, uint32_t srcStride,
+                      uint8_t* dst, uint32_t dstStride,
+                      uint32_t width, uint32_t height);
+
+/**
+ * @brief alpha 混合：dst = fg + bg * (1 - fg.a)
+ * @param fg 前景（须已预乘 alpha，见 premultiplyAlpha）
+ */
+bool blendOver(const uint8_t* fg, uint32_t fgStride,
+               const uint8_t* bg, uint32_t bgStride,
+               uint8_t* dst, uint32_t dstStride,
+               uint32_t width, uint32_t height);
+
+} // namespace simd
+} // namespace pipeline
@@ -0,0 +1,155 @@
+/**
+ * @file FrameArena.h
+ * @brief 帧内存区 - 帧内临时内存的 bump 分配器
+ *
+ * 每个在途帧持有一个 FrameArena，Entity 执行期间可经
+ * PipelineContext::getFrameArena()/getFrameMemoryResource() 取用，
+ * 帧结束时整体回收，稳态下不产生 malloc/free。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace pipeline {
+
+/**
+ * @brief 帧内存区
+ *
+ * 从当前块中以原子 bump 指针分配，可被同一帧并行执行的多个Entity并发使用；
+ * 块用尽时加锁追加新块。deallocate 为空操作，内存在 reset() 时整体回收。
+ * 分配的内存仅在本帧内有效，不得存入会随帧包流出的数据。
+ */
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kDefaultChunkSize = 256 * 1024;
+    static constexpr size_t kChunkAlignment = 64;
+
+    explicit FrameArena(size_t initialSize = kDefaultChunkSize);
+    ~FrameArena() override;
+
+    // 禁止拷贝
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief 分配未初始化的数组（适用于可平凡析构的类型）
+     */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief 回收全部内存（调用时不得有使用者）
+     *
+     * 上一帧用到多个块时合并为一个足够大的块，后续帧只需一次 bump 分配。
+     */
+    void reset();
+
+    /**
+     * @brief 释放多余容量，仅保留初始大小
+     * @return 释放的字节数
+     */
+    size_t shrink();
+
+    /**
+     * @brief 获取已分配字节数（含对齐填充）
+     */
+    size_t getBytesUsed() const;
+
+    /**
+     * @brief 获取当前容量
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 当前线程正在执行的帧的内存区（不在帧内执行时返回nullptr）
+     */
+    static FrameArena* current();
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    friend class FrameArenaScope;
+
+    struct Chunk {
+        uint8_t* data = nullptr;
+        size_t capacity = 0;
+        std::atomic<size_t> used{0};
+    };
+
+    Chunk* addChunkLocked(size_t capacity);
+
+    size_t mInitialSize;
+    mutable std::mutex mMutex;                      // 保护 mChunks 追加
+    std::vector<std::unique_ptr<Chunk>> mChunks;
+    std::atomic<Chunk*> mCurrent{nullptr};
+};
+
+/**
+ * @brief 设置当前线程的帧内存区（RAII，析构时恢复）
+ */
+class FrameArenaScope {
+public:
+    explicit FrameArenaScope(FrameArena* arena);
+    ~FrameArenaScope();
+
+    FrameArenaScope(const FrameArenaScope&) = delete;
+    FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+
+private:
+    FrameArena* mPrevious;
+};
+
+/**
+ * @brief 帧内存区池
+ *
+ * 在途帧开始时取出，帧状态释放时自动 reset 并归还，块容量随之复用。
+ */
+class FrameArenaPool {
+public:
+    /**
+     * @param chunkSize 新建内存区的初始块大小
+     * @param maxArenas 最多保留的空闲内存区数（通常为最大在途帧数）
+     */
+    FrameArenaPool(size_t chunkSize, size_t maxArenas);
+
+    // 禁止拷贝
+    FrameArenaPool(const FrameArenaPool&) = delete;
+    FrameArenaPool& operator=(const FrameArenaPool&) = delete;
+
+    /**
+     * @brief 取出内存区，最后一个引用释放时归还
+     */
+    std::shared_ptr<FrameArena> acquire();
+
+    /**
+     * @brief 收缩所有空闲内存区至初始大小
+     * @return 释放的字节数
+     */
+    size_t shrink();
+
+private:
+    struct Core {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<FrameArena>> freeArenas;
+        size_t chunkSize = 0;
+        size_t maxArenas = 0;
+    };
+
+    std::shared_ptr<Core> mCore;
+};
+
+} // namespace pipeline
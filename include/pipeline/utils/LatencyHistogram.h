@@ -0,0 +1,85 @@
+/**
+ * @file LatencyHistogram.h
+ * @brief 无锁延迟直方图 - 对数线性分桶（HDR风格）
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace pipeline {
+
+/**
+ * @brief 直方图摘要（单位与记录值一致，通常为微秒）
+ */
+struct HistogramSummary {
+    uint64_t count = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    uint64_t mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+};
+
+/**
+ * @brief 无锁延迟直方图
+ *
+ * 按 2 的幂分组，每组再线性细分为 kSubBuckets 个桶，相对误差约 1/kSubBuckets。
+ * 记录仅为若干 relaxed 原子操作，可在任意线程并发调用；
+ * 读取为近似快照（并发记录时各计数可能不完全一致）。
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kSubBucketBits = 3;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;   // 每组8个桶，误差约12.5%
+    static constexpr uint32_t kGroups = 64 - kSubBucketBits + 1;
+    static constexpr uint32_t kBucketCount = kGroups * kSubBuckets;
+
+    LatencyHistogram();
+
+    // 禁止拷贝
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief 记录一个值
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief 清空
+     */
+    void reset();
+
+    /**
+     * @brief 获取记录数
+     */
+    uint64_t getCount() const { return mCount.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 获取百分位值（返回所在桶的上界）
+     * @param percentile 百分位（0-100）
+     */
+    uint64_t getPercentile(double percentile) const;
+
+    /**
+     * @brief 获取摘要
+     */
+    HistogramSummary getSummary() const;
+
+private:
+    std::atomic<uint64_t> mBuckets[kBucketCount];
+    std::atomic<uint64_t> mCount{0};
+    std::atomic<uint64_t> mSum{0};
+    std::atomic<uint64_t> mMin{UINT64_MAX};
+    std::atomic<uint64_t> mMax{0};
+
+    static uint32_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(uint32_t index);
+    uint64_t percentileFromCounts(const uint64_t* counts, uint64_t total, double percentile) const;
+};
+
+} // namespace pipeline
@@ -0,0 +1,119 @@
+/**
+ * @file MPMCQueue.h
+ * @brief 有界无锁多生产者多消费者队列（环形缓冲）
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace pipeline {
+
+/**
+ * @brief 有界无锁MPMC队列
+ *
+ * 每个槽位带序号（Vyukov 算法），入队/出队各为一次CAS，无锁、无分配。
+ * 容量向上取整为 2 的幂；T 需可默认构造与移动（通常为指针）。
+ */
+template <typename T>
+class MPMCQueue {
+public:
+    explicit MPMCQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mMask = size - 1;
+        mCells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 禁止拷贝
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    /**
+     * @brief 入队
+     * @return 队列已满返回false
+     */
+    bool tryPush(T value) {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &mCells[pos & mMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队
+     * @return 队列为空返回false
+     */
+    bool tryPop(T& value) {
+        size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &mCells[pos & mMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = mDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mMask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 获取容量
+     */
+    size_t capacity() const { return mMask + 1; }
+
+    /**
+     * @brief 获取近似元素数（并发读写时仅供参考）
+     */
+    size_t sizeApprox() const {
+        size_t enqueued = mEnqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = mDequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> mCells;
+    size_t mMask = 0;
+    alignas(64) std::atomic<size_t> mEnqueuePos{0};
+    alignas(64) std::atomic<size_t> mDequeuePos{0};
+};
+
+} // namespace pipeline
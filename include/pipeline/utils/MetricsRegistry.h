@@ -0,0 +1,186 @@
+/**
+ * @file MetricsRegistry.h
+ * @brief 实时指标注册表 - 计数器/仪表的统一拉取接口与可选周期推送
+ *
+ * 两类来源：
+ * - 自有指标：counter()/gauge() 返回地址稳定的对象，热路径上只有一次 relaxed 原子操作；
+ * - 采集器：addCollector() 注册的回调在 snapshot() 时读取各组件已有的统计
+ *   （执行器、池、输入输出队列），不给处理路径增加任何开销。
+ *
+ * 注册与快照之间有锁，更新指标无锁；常开用于线上遥测时只需控制快照频率。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pipeline {
+
+/**
+ * @brief 指标类型
+ */
+enum class MetricType : uint8_t {
+    Counter,    ///< 单调递增（累计值）
+    Gauge       ///< 瞬时值（队列深度、命中率、内存占用等）
+};
+
+/**
+ * @brief 单个指标采样
+ */
+struct MetricSample {
+    std::string name;
+    MetricType type = MetricType::Gauge;
+    double value = 0.0;
+};
+
+/**
+ * @brief 指标快照
+ */
+struct MetricsSnapshot {
+    int64_t timestampUs = 0;            ///< 采样时间（steady_clock，微秒）
+    std::vector<MetricSample> samples;  ///< 自有指标按名称排序在前，随后是各采集器的输出
+
+    void addCounter(const std::string& name, uint64_t value) {
+        samples.push_back({name, MetricType::Counter, static_cast<double>(value)});
+    }
+
+    void addGauge(const std::string& name, double value) {
+        samples.push_back({name, MetricType::Gauge, value});
+    }
+
+    /**
+     * @brief 按名称查找（线性查找，不存在返回 nullptr）
+     */
+    const MetricSample* find(const std::string& name) const;
+};
+
+/**
+ * @brief 计数器（任意线程并发累加）
+ */
+class MetricCounter {
+public:
+    void add(uint64_t delta = 1) { mValue.fetch_add(delta, std::memory_order_relaxed); }
+    uint64_t get() const { return mValue.load(std::memory_order_relaxed); }
+    void reset() { mValue.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> mValue{0};
+};
+
+/**
+ * @brief 仪表（最后写入者生效）
+ */
+class MetricGauge {
+public:
+    void set(double value) { mValue.store(value, std::memory_order_relaxed); }
+    double get() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> mValue{0.0};
+};
+
+/**
+ * @brief 指标注册表
+ *
+ * @code
+ * auto& decoded = registry.counter("decoder.frames");
+ * decoded.add();                                   // 热路径
+ *
+ * registry.startPeriodicPush(1000, [](const MetricsSnapshot& s) { upload(s); });
+ * @endcode
+ */
+class MetricsRegistry {
+public:
+    using Collector = std::function<void(MetricsSnapshot&)>;
+    using CollectorId = uint64_t;
+    using PushCallback = std::function<void(const MetricsSnapshot&)>;
+
+    static constexpr CollectorId kInvalidCollectorId = 0;
+
+    MetricsRegistry() = default;
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // ==========================================================================
+    // 自有指标
+    // ==========================================================================
+
+    /**
+     * @brief 获取或创建计数器（引用在注册表生命周期内有效，调用方应缓存）
+     */
+    MetricCounter& counter(const std::string& name);
+
+    /**
+     * @brief 获取或创建仪表
+     */
+    MetricGauge& gauge(const std::string& name);
+
+    // ==========================================================================
+    // 采集器
+    // ==========================================================================
+
+    /**
+     * @brief 注册采集器（在 snapshot() 的调用线程上串行执行）
+     *
+     * 采集器内不能再调用本注册表的任何方法。
+     */
+    CollectorId addCollector(Collector collector);
+
+    /**
+     * @brief 移除采集器；返回后该采集器不会再被调用，其捕获的对象可以安全释放
+     */
+    void removeCollector(CollectorId id);
+
+    // ==========================================================================
+    // 读取
+    // ==========================================================================
+
+    /**
+     * @brief 拉取全部指标的当前值
+     */
+    MetricsSnapshot snapshot() const;
+
+    /**
+     * @brief 开始周期推送：后台线程每隔 intervalMs 取一次快照交给回调
+     *
+     * 已在推送时替换间隔与回调。回调在推送线程上执行，其中不能调用 stopPeriodicPush。
+     */
+    bool startPeriodicPush(uint32_t intervalMs, PushCallback callback);
+
+    /**
+     * @brief 停止周期推送（等待进行中的回调返回）
+     */
+    void stopPeriodicPush();
+
+    bool isPushing() const;
+
+private:
+    void pushLoop();
+
+    mutable std::mutex mMutex;
+    std::map<std::string, std::unique_ptr<MetricCounter>> mCounters;
+    std::map<std::string, std::unique_ptr<MetricGauge>> mGauges;
+    std::vector<std::pair<CollectorId, Collector>> mCollectors;
+    CollectorId mNextCollectorId = 1;
+
+    // 周期推送
+    mutable std::mutex mPushMutex;
+    std::condition_variable mPushCondition;
+    std::thread mPushThread;
+    PushCallback mPushCallback;
+    uint32_t mPushIntervalMs = 0;
+    bool mPushStopping = false;
+};
+
+} // namespace pipeline
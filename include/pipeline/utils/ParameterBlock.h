@@ -0,0 +1,121 @@
+/**
+ * @file ParameterBlock.h
+ * @brief 参数块 - UI线程写、渲染线程逐帧读取的三缓冲参数
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace pipeline {
+
+/**
+ * @brief 三缓冲参数块
+ *
+ * 写入方在自己的暂存副本上修改后整块发布；读取方每帧开始时 acquire() 一次，
+ * 之后整帧读取 current()，不会读到写了一半的参数。读取方不加锁、不拷贝，
+ * 多个写入线程之间由写锁串行（只与其他写入者竞争，不与渲染竞争）。
+ * T 宜为平凡可拷贝的参数结构；含容器时发布的拷贝发生在写入线程。
+ *
+ * @code
+ * mParams.update([&](Params& p) { p.intensity = value; });   // UI线程
+ *
+ * if (mParams.acquire()) {                                   // 渲染线程，每帧一次
+ *     applyUniforms(mParams.current());
+ * }
+ * @endcode
+ */
+template <typename T>
+class ParameterBlock {
+public:
+    explicit ParameterBlock(const T& initial = T())
+        : mStaging(initial)
+    {
+        for (auto& slot : mSlots) {
+            slot = initial;
+        }
+    }
+
+    // 禁止拷贝
+    ParameterBlock(const ParameterBlock&) = delete;
+    ParameterBlock& operator=(const ParameterBlock&) = delete;
+
+    // ==========================================================================
+    // 写入方（任意线程）
+    // ==========================================================================
+
+    /**
+     * @brief 修改暂存副本并发布
+     * @param fn 形如 void(T&) 的修改函数
+     */
+    template <typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        fn(mStaging);
+        publishLocked();
+    }
+
+    /**
+     * @brief 整块替换并发布
+     */
+    void publish(const T& value) {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        mStaging = value;
+        publishLocked();
+    }
+
+    /**
+     * @brief 读取写入方视角的最新值（可能尚未被渲染线程取走）
+     * @param fn 形如 R(const T&) 的读取函数
+     */
+    template <typename Fn>
+    auto read(Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        return fn(static_cast<const T&>(mStaging));
+    }
+
+    // ==========================================================================
+    // 读取方（同一时刻只有一个线程）
+    // ==========================================================================
+
+    /**
+     * @brief 取走最新发布的参数
+     * @return 自上次 acquire 以来有新发布时返回true
+     */
+    bool acquire() {
+        if (!(mMiddle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        uint8_t previous = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+        mFront = previous & kIndexMask;
+        return true;
+    }
+
+    /**
+     * @brief 最近一次 acquire 取得的参数（读取方在两次 acquire 之间保持不变）
+     */
+    const T& current() const { return mSlots[mFront]; }
+
+private:
+    void publishLocked() {
+        mSlots[mBack] = mStaging;
+        uint8_t previous = mMiddle.exchange(static_cast<uint8_t>(mBack | kFresh),
+                                            std::memory_order_acq_rel);
+        mBack = previous & kIndexMask;
+    }
+
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    mutable std::mutex mWriteMutex;
+    T mStaging;                         // 写入方的完整副本（写锁保护）
+    T mSlots[3];
+    alignas(64) std::atomic<uint8_t> mMiddle{1};
+    uint8_t mBack = 0;                  // 写入方独占（写锁保护）
+    alignas(64) uint8_t mFront = 2;     // 读取方独占
+};
+
+} // namespace pipeline
@@ -3,14 +3,24 @@
  * @brief Pipeline日志系统
  * 
  * 仿照LREngine日志系统设计，提供统一的日志输出接口
+ * 
+ * 默认同步输出：调用线程内完成格式化、时间转换与写控制台/文件。
+ * enableAsync() 后切换为低开销模式：调用线程只把格式串指针与参数的二进制副本
+ * 写入本线程独占的无锁环形缓冲，格式化与输出全部由后台线程完成。
+ * 另可通过 PIPELINE_LOG_COMPILE_LEVEL 在编译期整体去掉低级别日志调用。
  */
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <string>
 #include <cstdarg>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
 
 namespace pipeline {
 
@@ -45,6 +55,91 @@ struct LogEntry {
  */
 using LogCallback = std::function<void(const LogEntry&)>;
 
+namespace detail {
+
+/// 单条异步记录的参数区大小，超出时在调用线程预先格式化为文本
+constexpr size_t kLogRecordPayloadSize = 200;
+
+/**
+ * @brief 异步日志记录（定长，直接存放在环形缓冲槽位中）
+ * 
+ * format/file/function 均为字面量，进程内长期有效，只记录指针。
+ */
+struct LogRecord {
+    using Formatter = int (*)(char* out, size_t size, const char* format, const uint8_t* payload);
+    
+    uint64_t timestampUs;
+    const char* format;
+    const char* file;
+    const char* function;
+    Formatter formatter;        // nullptr 表示 payload 已是格式化好的文本
+    int32_t line;
+    LogLevel level;
+    uint8_t payload[kLogRecordPayloadSize];
+};
+
+/**
+ * @brief 参数编解码：标量按字节拷贝，C 字符串连同结尾 '\0' 拷入记录
+ */
+template <typename T>
+struct LogArg {
+    static_assert(std::is_trivially_copyable<T>::value, "Log arguments must be printf-compatible scalars");
+    using Decoded = T;
+    static size_t size(const T&) { return sizeof(T); }
+    static void write(uint8_t*& out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+    static T read(const uint8_t*& in) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+template <>
+struct LogArg<const char*> {
+    using Decoded = const char*;
+    static const char* text(const char* value) { return value ? value : "(null)"; }
+    static size_t size(const char* value) { return std::strlen(text(value)) + 1; }
+    static void write(uint8_t*& out, const char* value) {
+        const size_t bytes = size(value);
+        std::memcpy(out, text(value), bytes);
+        out += bytes;
+    }
+    static const char* read(const uint8_t*& in) {
+        const char* value = reinterpret_cast<const char*>(in);
+        in += std::strlen(value) + 1;
+        return value;
+    }
+};
+
+template <>
+struct LogArg<char*> : LogArg<const char*> {};
+
+/// printf 风格格式化入口（供解码后的参数展开调用）
+int formatPrintf(char* out, size_t size, const char* format, ...);
+
+template <typename... Args>
+int formatRecord(char* out, size_t size, const char* format, const uint8_t* payload) {
+    // 花括号初始化保证参数按书写顺序依次解码
+    std::tuple<typename LogArg<Args>::Decoded...> values{LogArg<Args>::read(payload)...};
+    (void)payload;
+    return std::apply([&](auto... decoded) { return formatPrintf(out, size, format, decoded...); }, values);
+}
+
+/// 当前线程环形缓冲中的下一个空槽位（缓冲已满时返回 nullptr 并计入丢弃数）
+LogRecord* beginAsyncRecord();
+
+/// 发布 beginAsyncRecord 取得的槽位
+void commitAsyncRecord(LogRecord* record);
+
+extern std::atomic<bool> g_asyncEnabled;
+extern std::atomic<LogLevel> g_minLevel;
+
+} // namespace detail
+
 /**
  * @brief Pipeline日志处理类
  * 
@@ -94,6 +189,48 @@ public:
     static void logFormat(LogLevel level, const char* file, int32_t line, 
                           const char* function, const char* format, ...);
     
+    /**
+     * @brief 日志宏入口：异步模式下只记录参数副本，否则等同 logFormat
+     * 
+     * Fatal 始终同步输出，保证进程退出前可见。
+     */
+    template <typename... Args>
+    static void logf(LogLevel level, const char* file, int32_t line,
+                     const char* function, const char* format, const Args&... args) {
+        if (level < detail::g_minLevel.load(std::memory_order_relaxed) || level >= LogLevel::Fatal ||
+            !detail::g_asyncEnabled.load(std::memory_order_relaxed)) {
+            logFormat(level, file, line, function, format, args...);
+            return;
+        }
+        logAsync<std::decay_t<Args>...>(level, file, line, function, format, args...);
+    }
+    
+    /**
+     * @brief 启用异步输出
+     * 
+     * 每个写日志的线程首次写入时分配独立的环形缓冲（单生产者单消费者，写入无锁），
+     * 后台线程定期汇总各缓冲、按时间排序后输出。缓冲写满时新记录被丢弃并计数，
+     * 由后台线程以一条 Warning 汇报，调用线程永不阻塞。
+     * 
+     * @param recordsPerThread 每线程缓冲的记录数（向上取 2 的幂）
+     */
+    static void enableAsync(size_t recordsPerThread = 1024);
+    
+    /**
+     * @brief 关闭异步输出（输出全部已缓冲记录并停止后台线程）
+     */
+    static void disableAsync();
+    
+    /**
+     * @brief 是否处于异步模式
+     */
+    static bool isAsync();
+    
+    /**
+     * @brief 异步模式下因缓冲已满丢弃的记录总数
+     */
+    static uint64_t getAsyncDroppedCount();
+    
     /**
      * @brief 设置最低日志级别
      * @param level 最低级别（低于此级别的日志将被忽略）
@@ -142,7 +279,7 @@ public:
     static void setLogCallback(LogCallback callback);
     
     /**
-     * @brief 刷新日志缓冲区
+     * @brief 刷新日志缓冲区（异步模式下先在调用线程输出全部已缓冲记录）
      */
     static void flush();
     
@@ -159,26 +296,84 @@ private:
      */
     static void logFormatV(LogLevel level, const char* file, int32_t line,
                            const char* function, const char* format, va_list args);
+    
+    template <typename... Decayed, typename... Args>
+    static void logAsync(LogLevel level, const char* file, int32_t line,
+                         const char* function, const char* format, const Args&... args) {
+        detail::LogRecord* record = detail::beginAsyncRecord();
+        if (!record) {
+            return;
+        }
+        record->format = format;
+        record->file = file;
+        record->function = function;
+        record->line = line;
+        record->level = level;
+        
+        size_t bytes = 0;
+        ((bytes += detail::LogArg<Decayed>::size(args)), ...);
+        if (bytes <= detail::kLogRecordPayloadSize) {
+            uint8_t* out = record->payload;
+            (detail::LogArg<Decayed>::write(out, args), ...);
+            (void)out;
+            record->formatter = &detail::formatRecord<Decayed...>;
+        } else {
+            // 长字符串参数：在调用线程格式化，超出部分截断
+            detail::formatPrintf(reinterpret_cast<char*>(record->payload), detail::kLogRecordPayloadSize,
+                                 format, args...);
+            record->formatter = nullptr;
+        }
+        detail::commitAsyncRecord(record);
+    }
 };
 
 // ============================================================================
-// 格式化日志宏（printf 风格，支持可变参数）
+// 编译期级别裁剪：低于 PIPELINE_LOG_COMPILE_LEVEL 的日志调用整体展开为空
+// （取值同 LogLevel，未指定时调试构建保留全部，其余构建去掉 Trace/Debug）
 // ============================================================================
-#define PIPELINE_LOGT(fmt, ...)   pipeline::PipelineLog::logFormat(pipeline::LogLevel::Trace, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
-#define PIPELINE_LOGD(fmt, ...)   pipeline::PipelineLog::logFormat(pipeline::LogLevel::Debug, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
-#define PIPELINE_LOGI(fmt, ...)   pipeline::PipelineLog::logFormat(pipeline::LogLevel::Info, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
-#define PIPELINE_LOGW(fmt, ...)   pipeline::PipelineLog::logFormat(pipeline::LogLevel::Warning, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
-#define PIPELINE_LOGE(fmt, ...)   pipeline::PipelineLog::logFormat(pipeline::LogLevel::Error, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
-#define PIPELINE_LOGF(fmt, ...)   pipeline::PipelineLog::logFormat(pipeline::LogLevel::Fatal, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
+#if !defined(PIPELINE_LOG_COMPILE_LEVEL)
+    #if defined(PIPELINE_DEBUG) || defined(_DEBUG) || defined(DEBUG)
+        #define PIPELINE_LOG_COMPILE_LEVEL 0
+    #else
+        #define PIPELINE_LOG_COMPILE_LEVEL 2
+    #endif
+#endif
+
+#define PIPELINE_LOG_AT(level, fmt, ...) \
+    pipeline::PipelineLog::logf(level, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
 
 // ============================================================================
-// 条件编译：Release 模式下禁用 Trace/Debug
+// 格式化日志宏（printf 风格，支持可变参数）
 // ============================================================================
-#if !defined(PIPELINE_DEBUG) && !defined(_DEBUG) && !defined(DEBUG)
-    #undef PIPELINE_LOGT
-    #undef PIPELINE_LOGD
-    #define PIPELINE_LOGT(fmt, ...) ((void)0)
-    #define PIPELINE_LOGD(fmt, ...) ((void)0)
+#if PIPELINE_LOG_COMPILE_LEVEL <= 0
+    #define PIPELINE_LOGT(fmt, ...)   PIPELINE_LOG_AT(pipeline::LogLevel::Trace, fmt, ##__VA_ARGS__)
+#else
+    #define PIPELINE_LOGT(fmt, ...)   ((void)0)
+#endif
+#if PIPELINE_LOG_COMPILE_LEVEL <= 1
+    #define PIPELINE_LOGD(fmt, ...)   PIPELINE_LOG_AT(pipeline::LogLevel::Debug, fmt, ##__VA_ARGS__)
+#else
+    #define PIPELINE_LOGD(fmt, ...)   ((void)0)
+#endif
+#if PIPELINE_LOG_COMPILE_LEVEL <= 2
+    #define PIPELINE_LOGI(fmt, ...)   PIPELINE_LOG_AT(pipeline::LogLevel::Info, fmt, ##__VA_ARGS__)
+#else
+    #define PIPELINE_LOGI(fmt, ...)   ((void)0)
+#endif
+#if PIPELINE_LOG_COMPILE_LEVEL <= 3
+    #define PIPELINE_LOGW(fmt, ...)   PIPELINE_LOG_AT(pipeline::LogLevel::Warning, fmt, ##__VA_ARGS__)
+#else
+    #define PIPELINE_LOGW(fmt, ...)   ((void)0)
+#endif
+#if PIPELINE_LOG_COMPILE_LEVEL <= 4
+    #define PIPELINE_LOGE(fmt, ...)   PIPELINE_LOG_AT(pipeline::LogLevel::Error, fmt, ##__VA_ARGS__)
+#else
+    #define PIPELINE_LOGE(fmt, ...)   ((void)0)
+#endif
+#if PIPELINE_LOG_COMPILE_LEVEL <= 5
+    #define PIPELINE_LOGF(fmt, ...)   PIPELINE_LOG_AT(pipeline::LogLevel::Fatal, fmt, ##__VA_ARGS__)
+#else
+    #define PIPELINE_LOGF(fmt, ...)   ((void)0)
 #endif
 
 } // namespace pipeline
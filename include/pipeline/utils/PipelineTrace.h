@@ -0,0 +1,137 @@
+/**
+ * @file PipelineTrace.h
+ * @brief Pipeline事件追踪 - 导出 Chrome Trace Event JSON
+ *
+ * 运行期开启，事件写入每线程环形缓冲（无锁、无分配），
+ * 导出后可在 chrome://tracing 或 ui.perfetto.dev 中查看各队列的重叠与阻塞。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace pipeline {
+
+/**
+ * @brief Pipeline事件追踪
+ *
+ * 静态类，提供全局追踪功能。事件名称与分类必须为静态字符串
+ * （字面量），Entity名称通过 setEntityName 注册，导出时解析。
+ */
+class PipelineTrace {
+public:
+    PipelineTrace() = delete;  // 静态类，禁止实例化
+
+    static constexpr size_t kDefaultEventsPerThread = 8192;
+
+    /**
+     * @brief 开始追踪（清空已有事件）
+     * @param eventsPerThread 每线程环形缓冲容量（仅对新建缓冲生效），满后覆盖最旧事件
+     */
+    static void start(size_t eventsPerThread = kDefaultEventsPerThread);
+
+    /**
+     * @brief 停止追踪（保留已记录事件以便导出）
+     */
+    static void stop();
+
+    /**
+     * @brief 是否正在追踪
+     */
+    static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 当前时间（纳秒，steady_clock）
+     */
+    static int64_t now();
+
+    /**
+     * @brief 记录一个完整区间事件（Chrome 'X'）
+     * @param name 事件名（静态字符串）
+     * @param category 分类（静态字符串，如 "gpu"/"cpu"/"io"/"pool"）
+     * @param startNs 开始时间（now()）
+     * @param durationNs 持续时间
+     * @param entityId 关联Entity（0表示无）
+     * @param frameId 关联帧ID
+     */
+    static void complete(const char* name, const char* category, int64_t startNs,
+                         int64_t durationNs, uint64_t entityId = 0, uint64_t frameId = 0);
+
+    /**
+     * @brief 记录一个瞬时事件（Chrome 'i'）
+     * @param value 附加数值（如纹理尺寸），导出为 args.value
+     */
+    static void instant(const char* name, const char* category, uint64_t entityId = 0,
+                        uint64_t frameId = 0, uint64_t value = 0);
+
+    /**
+     * @brief 注册Entity名称（导出时用作事件名）
+     */
+    static void setEntityName(uint64_t entityId, const std::string& name);
+
+    /**
+     * @brief 设置当前线程名称（不会创建缓冲，可在线程启动时无条件调用）
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief 当前线程未命名时设置名称（用于无法控制创建的队列线程）
+     */
+    static void setThreadNameIfUnset(const char* name);
+
+    /**
+     * @brief 导出 Chrome Trace Event JSON
+     *
+     * 建议在 stop() 之后导出；追踪进行中导出时，正被覆盖的事件可能不完整。
+     */
+    static std::string exportChromeTrace();
+
+    /**
+     * @brief 导出到文件
+     * @return 是否成功
+     */
+    static bool writeChromeTrace(const std::string& filepath);
+
+    /**
+     * @brief 获取当前缓冲中的事件数
+     */
+    static size_t getEventCount();
+
+private:
+    static std::atomic<bool> sEnabled;
+};
+
+/**
+ * @brief 区间追踪辅助（RAII），未开启追踪时开销为一次原子读
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category, uint64_t entityId = 0, uint64_t frameId = 0)
+        : mName(name)
+        , mCategory(category)
+        , mEntityId(entityId)
+        , mFrameId(frameId)
+        , mStartNs(PipelineTrace::isEnabled() ? PipelineTrace::now() : 0) {}
+
+    ~TraceScope() {
+        if (mStartNs != 0 && PipelineTrace::isEnabled()) {
+            PipelineTrace::complete(mName, mCategory, mStartNs, PipelineTrace::now() - mStartNs,
+                                    mEntityId, mFrameId);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* mName;
+    const char* mCategory;
+    uint64_t mEntityId;
+    uint64_t mFrameId;
+    int64_t mStartNs;
+};
+
+} // namespace pipeline
@@ -0,0 +1,169 @@
+/**
+ * @file SPSCQueue.h
+ * @brief 有界无锁单生产者单消费者队列与"最新值"信箱
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace pipeline {
+
+/**
+ * @brief 有界无锁SPSC队列
+ *
+ * 仅允许一个生产者线程与一个消费者线程，入队/出队各一次 acquire/release，
+ * 无CAS、无分配。槽数为 2 的幂，但可入队数量严格不超过 capacity。
+ */
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity)
+        : mCapacity(capacity > 0 ? capacity : 1)
+    {
+        size_t size = 2;
+        while (size < mCapacity) {
+            size <<= 1;
+        }
+        mMask = size - 1;
+        mSlots = std::make_unique<T[]>(size);
+    }
+
+    // 禁止拷贝
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /**
+     * @brief 入队（仅生产者线程）
+     * @return 队列已满返回false
+     */
+    bool tryPush(T value) {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead >= mCapacity) {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead >= mCapacity) {
+                return false;
+            }
+        }
+        mSlots[tail & mMask] = std::move(value);
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队（仅消费者线程）
+     * @return 队列为空返回false
+     */
+    bool tryPop(T& value) {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail) {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail) {
+                return false;
+            }
+        }
+        // 取出后重置槽位，及时释放元素持有的资源
+        value = std::move(mSlots[head & mMask]);
+        mSlots[head & mMask] = T();
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 获取容量
+     */
+    size_t capacity() const { return mCapacity; }
+
+    /**
+     * @brief 获取近似元素数（并发读写时仅供参考）
+     */
+    size_t sizeApprox() const {
+        size_t tail = mTail.load(std::memory_order_acquire);
+        size_t head = mHead.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    std::unique_ptr<T[]> mSlots;
+    size_t mCapacity = 0;
+    size_t mMask = 0;
+
+    // 生产者侧
+    alignas(64) std::atomic<size_t> mTail{0};
+    size_t mCachedHead = 0;
+
+    // 消费者侧
+    alignas(64) std::atomic<size_t> mHead{0};
+    size_t mCachedTail = 0;
+};
+
+/**
+ * @brief "最新值"信箱（三缓冲）
+ *
+ * 生产者总是写入自己的后台槽，再与中间槽原子交换；消费者取走中间槽中的新值。
+ * 消费者来不及取走的旧值被新值覆盖（publish 返回true），适用于只关心最新帧的预览。
+ * 仅允许一个生产者线程与一个消费者线程，双方都不会阻塞。
+ */
+template <typename T>
+class LatestMailbox {
+public:
+    LatestMailbox() = default;
+
+    // 禁止拷贝
+    LatestMailbox(const LatestMailbox&) = delete;
+    LatestMailbox& operator=(const LatestMailbox&) = delete;
+
+    /**
+     * @brief 发布新值（仅生产者线程）
+     * @return 覆盖了尚未取走的旧值时返回true
+     */
+    bool publish(T value) {
+        mSlots[mBack] = std::move(value);
+        uint8_t previous = mMiddle.exchange(static_cast<uint8_t>(mBack | kFresh),
+                                            std::memory_order_acq_rel);
+        mBack = previous & kIndexMask;
+        if (previous & kFresh) {
+            // 被覆盖的旧值现归生产者所有，立即释放其资源
+            mSlots[mBack] = T();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 取走最新值（仅消费者线程）
+     * @return 没有新值返回false
+     */
+    bool tryTake(T& value) {
+        if (!(mMiddle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        uint8_t previous = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+        mFront = previous & kIndexMask;
+        value = std::move(mSlots[mFront]);
+        mSlots[mFront] = T();
+        return true;
+    }
+
+    /**
+     * @brief 是否有尚未取走的新值
+     */
+    bool hasValue() const {
+        return (mMiddle.load(std::memory_order_acquire) & kFresh) != 0;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    T mSlots[3];
+    alignas(64) std::atomic<uint8_t> mMiddle{1};
+    alignas(64) uint8_t mBack = 0;     // 生产者独占
+    alignas(64) uint8_t mFront = 2;    // 消费者独占
+};
+
+} // namespace pipeline
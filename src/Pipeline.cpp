@@ -1,5 +1,6 @@
 #include "pipeline/PipelineNew.h"
 #include "pipeline/core/PipelineError.h"
+#include "pipeline/core/PipelineConfigBinary.h"
 #include "PipelineImpl.h"
 #include <stdexcept>
 
@@ -19,6 +20,15 @@ std::shared_ptr<Pipeline> Pipeline::fromJsonFile(const std::string& configFilePa
     return nullptr;
 }
 
+std::shared_ptr<Pipeline> Pipeline::fromBinaryFile(const std::string& binaryFilePath) {
+    // 离线由 PipelineConfigLoader::compileBinaryFile 生成，启动时映射读取
+    auto result = PipelineBinaryLoader::fromFile(binaryFilePath);
+    if (!result) {
+        return nullptr;
+    }
+    return result.value();
+}
+
 // ============================================================================
 // 构造/析构
 // ============================================================================
@@ -187,6 +197,11 @@ void Pipeline::setFrameRateLimit(int32_t fps) {
     if (mImpl) mImpl->setFrameRateLimit(fps);
 }
 
+bool Pipeline::capture(const std::vector<FramePacketPtr>& frames,
+                       PipelineManager::CaptureCallback callback) {
+    return mImpl ? mImpl->capture(frames, std::move(callback)) : false;
+}
+
 // ============================================================================
 // 回调
 // ============================================================================
@@ -85,8 +85,13 @@ bool PipelineFacade::initialize() {
 #endif
         pipelineConfig.enableProfiling = mConfig.enableProfiling;
         pipelineConfig.enableLogging = mConfig.enableDebugLog;
+        pipelineConfig.previewRenderScale = mConfig.previewRenderScale;
+        pipelineConfig.enableTransferQueue = mConfig.enableTransferQueue;
         
         mPipelineManager = PipelineManager::create(mRenderContext, pipelineConfig);
+        if (mPipelineManager && mConfig.enableTransferQueue) {
+            setupTransferContext();
+        }
         if (!mPipelineManager || !mPipelineManager->initialize()) {
             if (mCallbacks.onError) {
                 mCallbacks.onError("Failed to create PipelineManager");
@@ -115,6 +120,9 @@ bool PipelineFacade::initialize() {
         
         // 6. 配置回调桥接
         setupCallbackBridges();
+        
+        // 7. 质量档位
+        applyQualitySettings(mConfig.quality);
     }
 
     {
@@ -325,12 +333,42 @@ int32_t PipelineFacade::setupDisplayOutput(void* surface, int32_t width, int32_t
 }
 
 int32_t PipelineFacade::setupEncoderOutput(void* encoderSurface, EncoderType encoderType) {
+    EncoderConfig config;
+    config.type = encoderType;
+    return setupEncoderOutput(encoderSurface, config);
+}
+
+int32_t PipelineFacade::setupEncoderOutput(void* encoderSurface, const EncoderConfig& config) {
     if (!mPipelineManager) {
         PIPELINE_LOGE("Pipeline not initialized");
         return -1;
     }
     
-    return mPipelineManager->setupEncoderOutput(encoderSurface, encoderType);
+    EncoderConfig encoderConfig = config;
+    if (encoderConfig.width == 0 || encoderConfig.height == 0) {
+        encoderConfig.width = mConfig.renderWidth;
+        encoderConfig.height = mConfig.renderHeight;
+    }
+    
+    // 编码表面与显示表面一样需要平台上下文管理器
+    void* platformManager = nullptr;
+    if (mPlatformContext) {
+#if defined(__APPLE__)
+        platformManager = mPlatformContext->getIOSMetalManager();
+#elif defined(__ANDROID__)
+        platformManager = mPlatformContext->getAndroidEGLManager();
+#endif
+    }
+    
+    int32_t targetId = mPipelineManager->setupEncoderOutput(encoderSurface, encoderConfig, platformManager);
+    if (targetId < 0) {
+        PIPELINE_LOGE("Failed to setup encoder output");
+        if (mCallbacks.onError) {
+            mCallbacks.onError("Failed to setup encoder output");
+        }
+        return -1;
+    }
+    return targetId;
 }
 
 int32_t PipelineFacade::setupCallbackOutput(FrameCallback callback, OutputDataFormat dataFormat) {
@@ -358,10 +396,29 @@ int32_t PipelineFacade::setupFileOutput(const std::string& filePath) {
         return -1;
     }
     
-    // TODO: 实现文件输出
-    (void)filePath;
-    PIPELINE_LOGW("setupFileOutput not yet implemented");
-    return -1;
+    // 按渲染尺寸编码 H.264，默认每 2 秒一个分片
+    EncoderConfig config;
+    config.width = mConfig.renderWidth;
+    config.height = mConfig.renderHeight;
+    
+    void* platformManager = nullptr;
+    if (mPlatformContext) {
+#if defined(__APPLE__)
+        platformManager = mPlatformContext->getIOSMetalManager();
+#elif defined(__ANDROID__)
+        platformManager = mPlatformContext->getAndroidEGLManager();
+#endif
+    }
+    
+    int32_t targetId = mPipelineManager->setupFileOutput(filePath, config, platformManager);
+    if (targetId < 0) {
+        PIPELINE_LOGE("Failed to setup file output");
+        if (mCallbacks.onError) {
+            mCallbacks.onError("Failed to setup file output");
+        }
+        return -1;
+    }
+    return targetId;
 }
 
 bool PipelineFacade::removeOutputTarget(int32_t targetId) {
@@ -419,15 +476,40 @@ bool PipelineFacade::removeEntity(EntityId entityId) {
 }
 
 void PipelineFacade::setEntityEnabled(EntityId entityId, bool enabled) {
-    // TODO: 实现
+    if (mPipelineManager) {
+        mPipelineManager->setEntityEnabled(entityId, enabled);
+    }
 }
 
 // 其他方法占位
 void PipelineFacade::setOutputResolution(uint32_t width, uint32_t height) {}
 void PipelineFacade::setRotation(int32_t degrees) {}
 void PipelineFacade::setMirror(bool horizontal, bool vertical) {}
-void PipelineFacade::setCropRect(float x, float y, float width, float height) {}
-void PipelineFacade::setFrameRateLimit(int32_t fps) {}
+void PipelineFacade::setCropRect(float x, float y, float width, float height) {
+    if (mPipelineManager) {
+        mPipelineManager->setCropRect(RoiRect{x, y, width, height});
+    }
+}
+
+void PipelineFacade::setFrameRateLimit(int32_t fps) {
+    if (mPipelineManager) {
+        mPipelineManager->setFrameRateLimit(static_cast<float>(fps));
+    }
+}
+
+void PipelineFacade::requestFullResolutionFrame() {
+    if (mPipelineManager) {
+        mPipelineManager->requestFullResolution(1);
+    }
+}
+
+bool PipelineFacade::capture(const std::vector<FramePacketPtr>& frames,
+                             PipelineManager::CaptureCallback callback) {
+    if (!mPipelineManager) {
+        return false;
+    }
+    return mPipelineManager->capture(frames, std::move(callback));
+}
 
 void PipelineFacade::setCallbacks(const PipelineCallbacks& callbacks) {
     mCallbacks = callbacks;
@@ -468,6 +550,28 @@ double PipelineFacade::getAverageProcessTime() const {
     return 0.0;
 }
 
+MetricsSnapshot PipelineFacade::getMetricsSnapshot() const {
+    if (!mPipelineManager) {
+        return MetricsSnapshot();
+    }
+    return mPipelineManager->getMetricsSnapshot();
+}
+
+bool PipelineFacade::startMetricsPush(uint32_t intervalMs,
+                                      std::function<void(const MetricsSnapshot&)> callback) {
+    if (!mPipelineManager) {
+        PIPELINE_LOGE("Pipeline not initialized, cannot push metrics");
+        return false;
+    }
+    return mPipelineManager->getMetrics().startPeriodicPush(intervalMs, std::move(callback));
+}
+
+void PipelineFacade::stopMetricsPush() {
+    if (mPipelineManager) {
+        mPipelineManager->getMetrics().stopPeriodicPush();
+    }
+}
+
 std::string PipelineFacade::exportGraph() const {
     // TODO: 实现
     return "";
@@ -623,12 +727,27 @@ void PipelineFacade::setupCallbackBridges() {
     if (mCallbacks.onStateChanged) {
         mPipelineManager->setStateCallback(mCallbacks.onStateChanged);
     }
+    if (mCallbacks.onFirstFrame) {
+        mPipelineManager->setFirstFrameCallback(mCallbacks.onFirstFrame);
+    }
     
     PIPELINE_LOGI("Callback bridges configured");
 }
 
+void PipelineFacade::applyQualitySettings(QualityLevel quality) {
+    if (!mPipelineManager) {
+        return;
+    }
+    if (mConfig.enableAdaptiveQuality) {
+        // 以选定档位为上限，运行中按负载与温控自动调整
+        mPipelineManager->enableAdaptiveQuality(quality);
+    } else {
+        mPipelineManager->applyQualitySettings(QualityController::settingsFor(quality));
+    }
+}
+
 bool PipelineFacade::initializePlatformContext() {
-#if defined(__ANDROID__) || defined(__APPLE__)
+#if defined(__ANDROID__) || defined(__APPLE__) || defined(PIPELINE_HEADLESS_EGL)
     if (!mPlatformContext) {
         mPlatformContext = std::make_unique<PlatformContext>();
     }
@@ -650,6 +769,12 @@ bool PipelineFacade::initializePlatformContext() {
     }
 #endif
 
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (cfg.platform == PlatformType::Unknown) {
+        cfg.platform = PlatformType::Linux;
+    }
+#endif
+
     // 具体平台初始化
     return mPlatformContext->initialize(cfg);
 #else
@@ -658,6 +783,19 @@ bool PipelineFacade::initializePlatformContext() {
 #endif
 }
 
+void PipelineFacade::setupTransferContext() {
+    // 没有平台上下文或创建失败时不提供绑定，执行器把传输留在GPU队列
+    PlatformContext* platform = mPlatformContext.get();
+    if (!platform || !platform->createTransferContext()) {
+        PIPELINE_LOGW("Transfer context unavailable, uploads and readbacks stay on the GPU queue");
+        return;
+    }
+    TransferContextBinding binding;
+    binding.attach = [platform]() { return platform->makeTransferCurrent(); };
+    binding.detach = [platform]() { platform->releaseTransferCurrent(); };
+    mPipelineManager->setTransferContextBinding(std::move(binding));
+}
+
 bool PipelineFacade::initializeRenderContext() {
     if (mRenderContext) {
         return true;
@@ -195,10 +195,7 @@ bool PipelineImpl::removeEntity(EntityId entityId) {
 
 void PipelineImpl::setEntityEnabled(EntityId entityId, bool enabled) {
     if (mManager) {
-        auto entity = mManager->getEntity(entityId);
-        if (entity) {
-            entity->setEnabled(enabled);
-        }
+        mManager->setEntityEnabled(entityId, enabled);
     }
 }
 
@@ -273,8 +270,17 @@ void PipelineImpl::setMirror(bool horizontal, bool vertical) {
 }
 
 void PipelineImpl::setFrameRateLimit(int32_t fps) {
-    (void)fps;
-    // TODO: 实现帧率限制
+    if (mManager) {
+        mManager->setFrameRateLimit(static_cast<float>(fps));
+    }
+}
+
+bool PipelineImpl::capture(const std::vector<FramePacketPtr>& frames,
+                           PipelineManager::CaptureCallback callback) {
+    if (!mManager) {
+        return false;
+    }
+    return mManager->capture(frames, std::move(callback));
 }
 
 // ============================================================================
@@ -391,7 +397,9 @@ bool PipelineImpl::setupOutputEntity() {
 }
 
 bool PipelineImpl::applyQualitySettings() {
-    // TODO: 根据 quality 设置质量参数
+    if (mManager) {
+        mManager->applyQualitySettings(QualityController::settingsFor(mBuilderState.quality));
+    }
     return true;
 }
 
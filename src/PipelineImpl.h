@@ -229,6 +229,8 @@ public:
     void setMirror(bool horizontal, bool vertical);
     void setFrameRateLimit(int32_t fps);
     
+    bool capture(const std::vector<FramePacketPtr>& frames, PipelineManager::CaptureCallback callback);
+    
     // ========================================================================
     // 回调
     // ========================================================================
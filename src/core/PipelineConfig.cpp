@@ -4,8 +4,12 @@
  */
 
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/data/AsyncReadback.h"
 #include "pipeline/pool/TexturePool.h"
+#include "pipeline/pool/GpuResourceRegistry.h"
 #include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/core/WorkStealingThreadPool.h"
+#include "pipeline/utils/FrameArena.h"
 #include <chrono>
 
 namespace pipeline {
@@ -34,6 +38,69 @@ void PipelineContext::setFramePacketPool(std::shared_ptr<FramePacketPool> pool)
     mFramePacketPool = pool;
 }
 
+void PipelineContext::setReadbackService(std::shared_ptr<AsyncReadbackService> service) {
+    mReadbackService = std::move(service);
+}
+
+void PipelineContext::setTransferPoster(std::function<void(std::function<void()>)> poster) {
+    std::lock_guard<std::mutex> lock(mTransferMutex);
+    mTransferPoster = std::move(poster);
+}
+
+bool PipelineContext::hasTransferQueue() const {
+    std::lock_guard<std::mutex> lock(mTransferMutex);
+    return static_cast<bool>(mTransferPoster);
+}
+
+bool PipelineContext::postTransfer(std::function<void()> task) const {
+    std::function<void(std::function<void()>)> poster;
+    {
+        std::lock_guard<std::mutex> lock(mTransferMutex);
+        poster = mTransferPoster;
+    }
+    if (!poster || !task) {
+        return false;
+    }
+    poster(std::move(task));
+    return true;
+}
+
+void PipelineContext::setGpuResourceRegistry(std::shared_ptr<GpuResourceRegistry> registry) {
+    mGpuResources = std::move(registry);
+}
+
+FramePacketPtr PipelineContext::acquireFramePacket() {
+    if (mFramePacketPool) {
+        if (auto packet = mFramePacketPool->tryAcquire()) {
+            return packet;
+        }
+    }
+    return std::make_shared<FramePacket>();
+}
+
+FrameArena* PipelineContext::getFrameArena() const {
+    return FrameArena::current();
+}
+
+std::pmr::memory_resource* PipelineContext::getFrameMemoryResource() const {
+    FrameArena* arena = FrameArena::current();
+    return arena ? static_cast<std::pmr::memory_resource*>(arena) : std::pmr::get_default_resource();
+}
+
+// =============================================================================
+// 并行
+// =============================================================================
+
+void PipelineContext::parallelFor(uint32_t count, const std::function<void(uint32_t)>& body) const {
+    if (WorkStealingThreadPool* pool = mCPUThreadPool.load()) {
+        pool->parallelFor(count, body);
+        return;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        body(i);
+    }
+}
+
 // =============================================================================
 // 共享数据
 // =============================================================================
@@ -0,0 +1,236 @@
+/**
+ * @file PipelineConfigBinary.cpp
+ * @brief 二进制 Pipeline 配置加载
+ */
+
+#include "pipeline/core/PipelineConfigBinary.h"
+#include "pipeline/PipelineNew.h"
+
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pipeline {
+
+namespace {
+
+// 段 [offset, offset + bytes) 是否落在文件内且满足对齐
+bool sectionInBounds(uint32_t offset, uint64_t bytes, uint32_t totalSize, size_t alignment) {
+    return offset % alignment == 0 && static_cast<uint64_t>(offset) + bytes <= totalSize;
+}
+
+/**
+ * @brief 只读文件映射（不支持 mmap 的平台退化为整体读入）
+ */
+class MappedFile {
+public:
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (mMapped) {
+            munmap(mMapped, mSize);
+        }
+#endif
+    }
+
+    bool open(const std::string& path) {
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        mSize = static_cast<size_t>(st.st_size);
+        void* mapped = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            mSize = 0;
+            return false;
+        }
+        mMapped = mapped;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        mBuffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(mBuffer.data()),
+                                           static_cast<std::streamsize>(mBuffer.size())));
+#endif
+    }
+
+    const void* data() const { return mMapped ? mMapped : mBuffer.data(); }
+    size_t size() const { return mMapped ? mSize : mBuffer.size(); }
+
+private:
+    void* mMapped = nullptr;
+    size_t mSize = 0;
+    std::vector<uint8_t> mBuffer;
+};
+
+} // anonymous namespace
+
+uint32_t binaryGraphChecksum(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// =============================================================================
+// BinaryGraphView
+// =============================================================================
+
+Result<BinaryGraphView> BinaryGraphView::parse(const void* data, size_t size) {
+    if (!data || size < sizeof(BinaryGraphHeader) ||
+        reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) {
+        return Result<BinaryGraphView>::error(
+            PipelineError::invalidArgument("Binary graph too small or misaligned"));
+    }
+
+    const auto* base = static_cast<const uint8_t*>(data);
+    const auto* header = reinterpret_cast<const BinaryGraphHeader*>(base);
+    if (header->magic != kBinaryGraphMagic) {
+        return Result<BinaryGraphView>::error(
+            PipelineError::invalidArgument("Not a binary pipeline graph"));
+    }
+    if (header->version != kBinaryGraphVersion || header->headerSize != sizeof(BinaryGraphHeader)) {
+        return Result<BinaryGraphView>::error(
+            PipelineError::notSupported("Binary graph version " + std::to_string(header->version) +
+                                        " does not match this build, recompile it from JSON"));
+    }
+    if (header->totalSize != size) {
+        return Result<BinaryGraphView>::error(
+            PipelineError::invalidArgument("Binary graph truncated"));
+    }
+
+    const uint32_t total = header->totalSize;
+    if (!sectionInBounds(header->settingsOffset, sizeof(BinaryGraphSettings), total, 4) ||
+        !sectionInBounds(header->filterOffset,
+                         static_cast<uint64_t>(header->filterCount) * sizeof(BinaryFilterRecord), total, 4) ||
+        !sectionInBounds(header->shaderKeyOffset,
+                         static_cast<uint64_t>(header->shaderKeyCount) * sizeof(uint64_t), total, 8) ||
+        !sectionInBounds(header->stringOffset, header->stringSize, total, 1)) {
+        return Result<BinaryGraphView>::error(
+            PipelineError::invalidArgument("Binary graph section out of bounds"));
+    }
+    if (binaryGraphChecksum(base + sizeof(BinaryGraphHeader), size - sizeof(BinaryGraphHeader)) !=
+        header->checksum) {
+        return Result<BinaryGraphView>::error(
+            PipelineError::invalidArgument("Binary graph checksum mismatch"));
+    }
+    // 字符串表以 '\0' 结尾，保证任意偏移取出的字符串都不会越界
+    if (header->stringSize > 0 && base[header->stringOffset + header->stringSize - 1] != '\0') {
+        return Result<BinaryGraphView>::error(
+            PipelineError::invalidArgument("Binary graph string table unterminated"));
+    }
+
+    BinaryGraphView view;
+    view.mHeader = header;
+    view.mSettings = reinterpret_cast<const BinaryGraphSettings*>(base + header->settingsOffset);
+    view.mFilters = reinterpret_cast<const BinaryFilterRecord*>(base + header->filterOffset);
+    view.mShaderKeys = reinterpret_cast<const uint64_t*>(base + header->shaderKeyOffset);
+    view.mStrings = reinterpret_cast<const char*>(base + header->stringOffset);
+    view.mStringSize = header->stringSize;
+    return Result<BinaryGraphView>::success(std::move(view));
+}
+
+const char* BinaryGraphView::string(uint32_t offset) const {
+    if (offset == kBinaryNoString || offset >= mStringSize) {
+        return "";
+    }
+    return mStrings + offset;
+}
+
+// =============================================================================
+// PipelineBinaryLoader
+// =============================================================================
+
+Result<std::shared_ptr<Pipeline>> PipelineBinaryLoader::fromFile(const std::string& filePath) {
+    MappedFile file;
+    if (!file.open(filePath)) {
+        return Result<std::shared_ptr<Pipeline>>::error(
+            PipelineError::resourceError("Failed to map binary graph: " + filePath));
+    }
+    return fromMemory(file.data(), file.size());
+}
+
+Result<std::shared_ptr<Pipeline>> PipelineBinaryLoader::fromMemory(const void* data, size_t size) {
+    auto viewResult = BinaryGraphView::parse(data, size);
+    if (!viewResult) {
+        return Result<std::shared_ptr<Pipeline>>::error(viewResult.error());
+    }
+
+    PipelineBuilder builder;
+    applyTo(viewResult.value(), builder);
+
+    auto pipeline = builder.build();
+    if (!pipeline) {
+        return Result<std::shared_ptr<Pipeline>>::error(
+            PipelineError::initializationFailed("Failed to build pipeline from binary graph"));
+    }
+    return Result<std::shared_ptr<Pipeline>>::success(pipeline);
+}
+
+void PipelineBinaryLoader::applyTo(const BinaryGraphView& view, PipelineBuilder& builder) {
+    const BinaryGraphSettings& settings = view.settings();
+
+    builder.withPreset(static_cast<PipelinePreset>(settings.preset));
+    if (settings.flags & kBinaryHasPlatform) {
+        builder.withPlatform(static_cast<PlatformType>(settings.platform));
+    }
+    if (settings.flags & kBinaryHasInput) {
+        switch (static_cast<input::InputFormat>(settings.inputFormat)) {
+            case input::InputFormat::YUV420:
+                builder.withYUVInput(settings.inputWidth, settings.inputHeight);
+                break;
+            case input::InputFormat::NV12:
+                builder.withNV12Input(settings.inputWidth, settings.inputHeight);
+                break;
+            default:
+                builder.withRGBAInput(settings.inputWidth, settings.inputHeight);
+                break;
+        }
+    }
+    if (settings.flags & kBinaryHasQuality) {
+        builder.withQuality(static_cast<QualityLevel>(settings.quality));
+    }
+    if (settings.flags & kBinaryHasResolution) {
+        builder.withResolution(settings.outputWidth, settings.outputHeight);
+    }
+
+    for (uint32_t i = 0; i < view.filterCount(); ++i) {
+        const BinaryFilterRecord& filter = view.filter(i);
+        switch (static_cast<BinaryFilterKind>(filter.kind)) {
+            case BinaryFilterKind::Beauty:
+                builder.withBeautyFilter(filter.params[0], filter.params[1]);
+                break;
+            case BinaryFilterKind::Color:
+                builder.withColorFilter(view.string(filter.nameOffset), filter.params[0]);
+                break;
+            case BinaryFilterKind::Sharpen:
+                builder.withSharpenFilter(filter.params[0]);
+                break;
+            case BinaryFilterKind::Blur:
+                builder.withBlurFilter(filter.params[0]);
+                break;
+        }
+    }
+}
+
+} // namespace pipeline
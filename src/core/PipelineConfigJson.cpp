@@ -1,6 +1,9 @@
 #include "pipeline/core/PipelineConfigJson.h"
+#include "pipeline/core/PipelineConfigBinary.h"
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
 
 namespace pipeline {
@@ -115,6 +118,185 @@ Result<std::shared_ptr<Pipeline>> PipelineConfigLoader::fromString(const std::st
     }
 }
 
+// ============================================================================
+// 二进制预编译
+// ============================================================================
+
+namespace {
+
+// 追加定长记录，返回其偏移
+template<typename T>
+uint32_t appendRecord(std::vector<uint8_t>& out, const T& record) {
+    const uint32_t offset = static_cast<uint32_t>(out.size());
+    out.resize(out.size() + sizeof(T));
+    std::memcpy(out.data() + offset, &record, sizeof(T));
+    return offset;
+}
+
+void alignTo(std::vector<uint8_t>& out, size_t alignment) {
+    out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+} // anonymous namespace
+
+Result<std::vector<uint8_t>> PipelineConfigLoader::compileBinary(const std::string& jsonString) {
+    try {
+        nlohmann::json json = nlohmann::json::parse(jsonString);
+        if (!validate(json)) {
+            return Result<std::vector<uint8_t>>::error(
+                PipelineError::invalidArgument("Invalid JSON config: " + s_lastValidationError));
+        }
+        
+        // 与 fromString 相同的解析规则，结果落到定长记录里
+        BinaryGraphSettings settings{};
+        auto presetResult = parsePreset(json);
+        if (!presetResult) {
+            return Result<std::vector<uint8_t>>::error(presetResult.error());
+        }
+        settings.preset = static_cast<uint8_t>(presetResult.value());
+        
+        if (json.contains("platform") && json["platform"].contains("type")) {
+            auto platformResult = parsePlatform(json);
+            if (platformResult) {
+                settings.platform = static_cast<uint8_t>(platformResult.value());
+                settings.flags |= kBinaryHasPlatform;
+            }
+        }
+        if (json.contains("input")) {
+            auto inputFormatResult = parseInputFormat(json);
+            if (inputFormatResult) {
+                settings.inputFormat = static_cast<uint8_t>(inputFormatResult.value());
+                settings.inputWidth = json["input"].value("width", 1920);
+                settings.inputHeight = json["input"].value("height", 1080);
+                settings.flags |= kBinaryHasInput;
+            }
+        }
+        if (json.contains("quality")) {
+            auto qualityResult = parseQuality(json);
+            if (qualityResult) {
+                settings.quality = static_cast<uint8_t>(qualityResult.value());
+                settings.flags |= kBinaryHasQuality;
+            }
+        }
+        if (json.contains("output") && json["output"].contains("resolution")) {
+            settings.outputWidth = json["output"]["resolution"].value("width", 1920);
+            settings.outputHeight = json["output"]["resolution"].value("height", 1080);
+            settings.flags |= kBinaryHasResolution;
+        }
+        
+        std::vector<BinaryFilterRecord> filters;
+        std::string strings;
+        if (json.contains("filters") && json["filters"].is_array()) {
+            for (const auto& filter : json["filters"]) {
+                if (!filter.contains("type")) {
+                    return Result<std::vector<uint8_t>>::error(
+                        PipelineError::invalidArgument("Filter missing 'type' field"));
+                }
+                if (!filter.contains("params")) {
+                    continue;
+                }
+                const std::string type = filter["type"].get<std::string>();
+                const auto& params = filter["params"];
+                
+                BinaryFilterRecord record{};
+                record.nameOffset = kBinaryNoString;
+                if (type == "beauty") {
+                    record.kind = static_cast<uint8_t>(BinaryFilterKind::Beauty);
+                    record.params[0] = params.value("smooth", 0.5f);
+                    record.params[1] = params.value("whiten", 0.5f);
+                } else if (type == "color") {
+                    record.kind = static_cast<uint8_t>(BinaryFilterKind::Color);
+                    record.nameOffset = static_cast<uint32_t>(strings.size());
+                    strings += params.value("name", "vintage");
+                    strings.push_back('\0');
+                    record.params[0] = params.value("intensity", 1.0f);
+                } else if (type == "sharpen") {
+                    record.kind = static_cast<uint8_t>(BinaryFilterKind::Sharpen);
+                    record.params[0] = params.value("amount", 0.5f);
+                } else if (type == "blur") {
+                    record.kind = static_cast<uint8_t>(BinaryFilterKind::Blur);
+                    record.params[0] = params.value("radius", 5.0f);
+                } else {
+                    continue;
+                }
+                filters.push_back(record);
+            }
+        }
+        
+        std::vector<uint64_t> shaderKeys;
+        if (json.contains("shaderCacheKeys") && json["shaderCacheKeys"].is_array()) {
+            for (const auto& key : json["shaderCacheKeys"]) {
+                if (key.is_number_unsigned()) {
+                    shaderKeys.push_back(key.get<uint64_t>());
+                } else if (key.is_string()) {
+                    shaderKeys.push_back(std::stoull(key.get<std::string>(), nullptr, 16));
+                }
+            }
+        }
+        
+        // 依次写出各段；文件头最后回填
+        std::vector<uint8_t> out(sizeof(BinaryGraphHeader), 0);
+        BinaryGraphHeader header{};
+        header.magic = kBinaryGraphMagic;
+        header.version = kBinaryGraphVersion;
+        header.headerSize = sizeof(BinaryGraphHeader);
+        header.settingsOffset = appendRecord(out, settings);
+        
+        header.filterOffset = static_cast<uint32_t>(out.size());
+        header.filterCount = static_cast<uint32_t>(filters.size());
+        for (const auto& record : filters) {
+            appendRecord(out, record);
+        }
+        
+        alignTo(out, alignof(uint64_t));
+        header.shaderKeyOffset = static_cast<uint32_t>(out.size());
+        header.shaderKeyCount = static_cast<uint32_t>(shaderKeys.size());
+        for (uint64_t key : shaderKeys) {
+            appendRecord(out, key);
+        }
+        
+        header.stringOffset = static_cast<uint32_t>(out.size());
+        header.stringSize = static_cast<uint32_t>(strings.size());
+        out.insert(out.end(), strings.begin(), strings.end());
+        
+        header.totalSize = static_cast<uint32_t>(out.size());
+        header.checksum = binaryGraphChecksum(out.data() + sizeof(BinaryGraphHeader),
+                                              out.size() - sizeof(BinaryGraphHeader));
+        std::memcpy(out.data(), &header, sizeof(header));
+        
+        return Result<std::vector<uint8_t>>::success(std::move(out));
+        
+    } catch (const std::exception& e) {
+        return Result<std::vector<uint8_t>>::error(
+            PipelineError::invalidArgument("JSON parse error: " + std::string(e.what())));
+    }
+}
+
+Result<void> PipelineConfigLoader::compileBinaryFile(const std::string& jsonPath,
+                                                     const std::string& binaryPath) {
+    std::ifstream input(jsonPath);
+    if (!input.is_open()) {
+        return Result<void>::error(
+            PipelineError::resourceError("Failed to open config file: " + jsonPath));
+    }
+    std::string jsonString((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    
+    auto binaryResult = compileBinary(jsonString);
+    if (!binaryResult) {
+        return Result<void>::error(binaryResult.error());
+    }
+    const auto& binary = binaryResult.value();
+    
+    std::ofstream output(binaryPath, std::ios::binary | std::ios::trunc);
+    if (!output.is_open() ||
+        !output.write(reinterpret_cast<const char*>(binary.data()),
+                      static_cast<std::streamsize>(binary.size()))) {
+        return Result<void>::error(
+            PipelineError::resourceError("Failed to write binary graph: " + binaryPath));
+    }
+    return Result<void>::success();
+}
+
 bool PipelineConfigLoader::validate(const nlohmann::json& json) {
     // 检查版本
     if (!json.contains("version")) {
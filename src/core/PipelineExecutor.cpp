@@ -5,10 +5,16 @@
 
 #include "pipeline/core/PipelineExecutor.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/core/WorkStealingThreadPool.h"
 #include "pipeline/entity/ProcessEntity.h"
+#include "pipeline/entity/GPUEntity.h"
+#include "pipeline/entity/ShaderFusion.h"
+#include "pipeline/data/GpuCommandContext.h"
 #include "pipeline/pool/TexturePool.h"
 #include "pipeline/pool/FramePacketPool.h"
 #include "pipeline/utils/PipelineLog.h"
+#include "pipeline/utils/PipelineTrace.h"
+#include "pipeline/utils/FrameArena.h"
 
 
 // TaskQueue头文件
@@ -17,14 +23,47 @@
 #include "TaskGroup.h"
 #include "TaskOperator.h"
 
+#include <algorithm>
 #include <chrono>
+#include <thread>
 
 namespace pipeline {
 
+namespace {
+
+// 追踪事件分类（按 ExecutionQueue 取下标）
+const char* const kQueueTraceCategories[] = {"gpu", "cpu", "io"};
+
+// 融合成员只有一个已连接输入（见 compileShaderFusion）
+FramePacketPtr firstConnectedInput(const std::vector<FramePacketPtr>& inputs) {
+    for (const auto& input : inputs) {
+        if (input) {
+            return input;
+        }
+    }
+    return nullptr;
+}
+
+// 关键路径长度：ranks 传入各Entity自身耗时，返回时为从该Entity到出口的最长链耗时。
+// 计划按拓扑序排列，后继索引总是更大，逆序遍历一次即可
+void accumulateCriticalRanks(const CompiledPlan& plan, std::vector<uint64_t>& ranks) {
+    for (size_t i = plan.size(); i-- > 0;) {
+        uint64_t downstream = 0;
+        for (uint32_t k = plan.successorOffsets[i]; k < plan.successorOffsets[i + 1]; ++k) {
+            downstream = std::max(downstream, ranks[plan.successors[k]]);
+        }
+        ranks[i] += downstream;
+    }
+}
+
+} // namespace
+
 PipelineExecutor::PipelineExecutor(PipelineGraph* graph, const ExecutorConfig& config)
     : mConfig(config)
     , mGraph(graph)
+    , mProfilingEnabled(config.enableProfiling)
 {
+    setProxyRenderScale(config.proxyRenderScale);
     PIPELINE_LOGI("Creating PipelineExecutor");
 }
 
@@ -48,20 +87,47 @@ bool PipelineExecutor::initialize() {
         return false;
     }
     
+    if (mConfig.enableTracing && !PipelineTrace::isEnabled()) {
+        PipelineTrace::start();
+    }
+    
     // 创建任务队列
     if (!createTaskQueues()) {
         PIPELINE_LOGE("Failed to create task queues");
         return false;
     }
     
+    if (mConfig.frameArenaSize > 0 && !mFrameArenaPool) {
+        // 在途帧各一个，另加同步执行路径一个
+        mFrameArenaPool = std::make_shared<FrameArenaPool>(
+            mConfig.frameArenaSize, std::max<uint32_t>(1, mConfig.maxConcurrentFrames) + 1);
+    }
+    
+    if (mContext) {
+        mContext->setCPUThreadPool(mCPUPool.get());
+    }
+    
+    configureGpuCommands();
+    
+    // 传输队列：CPU帧上传与读回在共享上下文上进行，不占用GPU队列
+    createTransferQueue();
+    if (mContext && mTransferQueue) {
+        std::weak_ptr<PipelineExecutor> weakSelf = weak_from_this();
+        mContext->setTransferPoster([weakSelf](std::function<void()> task) {
+            if (auto self = weakSelf.lock()) {
+                self->postToTransferQueue(std::move(task));
+            }
+        });
+    }
+    
     // 更新执行计划
     updateExecutionPlan();
     
     // 初始化帧状态
     {
         std::lock_guard<std::mutex> lock(mFrameStateMutex);
-        mCurrentFrameState = std::make_shared<FrameExecutionState>();
-        mCurrentFrameState->frameId = 0;
+        mInFlightFrames.clear();
+        mNextFrameSeq = 0;
     }
     
     mInitialized.store(true);
@@ -74,10 +140,34 @@ void PipelineExecutor::shutdown() {
     PIPELINE_LOGI("Shutting down PipelineExecutor");
     mRunning.store(false);
     
+    // 异步任务链的在途帧不会再推进，直接丢弃
+    clearInFlightFrames();
+    
     // 等待所有任务完成
     flush(5000);
     
+    // 仍未排空的 flushAsync 回调在此以 false 通知，避免调用方永久等待
+    cancelFlushCallbacks();
+    
+    // 通道中未执行的任务不再需要（跳板执行时取不到任务直接返回）
+    clearLaneTasks();
+    
+    // 挂起在栅栏上的Entity所属帧已丢弃，不再恢复
+    stopFenceWaiter();
+    std::atomic_store(&mPreparedPlan, std::shared_ptr<const CompiledPlan>());
+    
     // 清理队列
+    if (mCPUPool) {
+        if (mContext) {
+            mContext->setCPUThreadPool(nullptr);
+        }
+        mCPUPool->stop();
+        mCPUPool.reset();
+    }
+    destroyTransferQueue();
+    if (mConfig.enableCommandRecording) {
+        runOnGPUQueue([]() { GpuCommandContext::current().commit(); });
+    }
     mGPUQueue.reset();
     mCPUQueue.reset();
     mIOQueue.reset();
@@ -98,64 +188,101 @@ bool PipelineExecutor::processFrame(FramePacketPtr input) {
     
     // 检查是否应该跳帧
     if (shouldSkipFrame()) {
-        if (mFrameDroppedCallback) {
-            mFrameDroppedCallback(input);
-        }
-        mStats.droppedFrames++;
-        PIPELINE_LOGW("Dropped frame %llu", input->getFrameId());
+        dropSkippedFrame(input);
         return false;
     }
     
-    // 检查图是否有变化
-    if (mGraph->getVersion() != mLastGraphVersion) {
-        updateExecutionPlan();
-        PIPELINE_LOGI("Graph changed, updated execution plan");
+    mPendingFrames.fetch_add(1);
+    bool success = runFrame(input);
+    finishPendingFrame();
+    return success;
+}
+
+bool PipelineExecutor::processFrameAsync(FramePacketPtr input,
+                                         std::function<void(FramePacketPtr)> callback) {
+    if (!mRunning.load() || !input) {
+        PIPELINE_LOGW("PipelineExecutor is not running or input is null");
+        return false;
+    }
+    
+    // 检查是否应该跳帧
+    if (shouldSkipFrame()) {
+        dropSkippedFrame(input);
+        return false;
     }
     
+    // 提交时即计入待处理，执行完成后释放
     mPendingFrames.fetch_add(1);
     
-    auto startTime = std::chrono::high_resolution_clock::now();
+    // 在IO队列异步执行
+    mIOQueue->async([this, input, callback]() {
+        if (mRunning.load()) {
+            runFrame(input);
+        }
+        if (callback) {
+            callback(input);
+        }
+        finishPendingFrame();
+    });
+    
+    return true;
+}
+
+size_t PipelineExecutor::processFrames(const std::vector<FramePacketPtr>& inputs) {
+    if (!mRunning.load()) {
+        PIPELINE_LOGW("PipelineExecutor is not running");
+        return 0;
+    }
+    if (inputs.empty()) {
+        return 0;
+    }
+    
+    // 整批计入待处理，批结束时一次性释放（离线场景不跳帧）
+    auto count = static_cast<uint32_t>(inputs.size());
+    mPendingFrames.fetch_add(count);
+    size_t completed = runBatch(inputs);
+    finishPendingFrame(count);
+    return completed;
+}
+
+bool PipelineExecutor::runFrame(const FramePacketPtr& input) {
+    // 检查图是否有变化
+    auto plan = acquireCompiledPlan();
+    if (!plan) {
+        PIPELINE_LOGE("No execution plan available");
+        return false;
+    }
     
+    auto startTime = std::chrono::high_resolution_clock::now();
     // 更新上下文
     mContext->setCurrentFrameId(input->getFrameId());
     mContext->setCurrentTimestamp(input->getTimestamp());
+    input->setRenderScale(selectRenderScale(*plan));
     
     // 重置所有Entity状态
-    for (const auto& level : mExecutionLevels) {
-        for (EntityId id : level) {
-            auto entity = mGraph->getEntity(id);
-            if (entity) {
-                entity->resetForNextFrame();
-            }
-        }
+    for (const auto& entity : plan->entities) {
+        entity->resetForNextFrame();
     }
     
-    // 设置输入到第一个Entity
-    auto sourceEntities = mGraph->getSourceEntities();
-    for (EntityId srcId : sourceEntities) {
-        auto entity = mGraph->getEntity(srcId);
-        if (entity && entity->getOutputPortCount() > 0) {
+    // 本帧内存区（函数返回时回收）
+    std::shared_ptr<FrameArena> arena = mFrameArenaPool ? mFrameArenaPool->acquire() : nullptr;
+    
+    // 设置输入到源Entity（无上游）
+    for (size_t i = 0; i < plan->size(); ++i) {
+        const auto& entity = plan->entities[i];
+        if (plan->upstreamCounts[i] == 0 && entity->getOutputPortCount() > 0) {
             entity->getOutputPort(size_t(0))->setPacket(input);
             entity->getOutputPort(size_t(0))->send();
         }
     }
     
-    // 按层级执行
-    for (const auto& level : mExecutionLevels) {
-        if (!mRunning.load()) {
-            break;
-        }
-        
-        if (mConfig.enableParallelExecution && level.size() > 1) {
-            // 并行执行同层Entity
-            auto group = task::TaskQueueFactory::GetInstance().createTaskGroup();
-            executeLevel(level, input, group);
-            group->wait();
-        } else {
-            // 串行执行
-            for (EntityId id : level) {
-                executeEntity(id, input);
-            }
+    if (mConfig.enableParallelExecution) {
+        // 按依赖就绪调度，不设层级屏障
+        executeDataflow(*plan, arena.get());
+    } else {
+        // 串行执行（索引即拓扑序）
+        for (uint32_t index = 0; index < plan->size() && mRunning.load(); ++index) {
+            executeEntity(*plan, index, arena.get());
         }
     }
     
@@ -164,8 +291,7 @@ bool PipelineExecutor::processFrame(FramePacketPtr input) {
         endTime - startTime).count();
     
     updateStats(frameTime);
-    
-    mPendingFrames.fetch_sub(1);
+    commitFrameCommands();
     
     // 触发完成回调
     onFrameComplete(input);
@@ -173,113 +299,631 @@ bool PipelineExecutor::processFrame(FramePacketPtr input) {
     return true;
 }
 
-bool PipelineExecutor::processFrameAsync(FramePacketPtr input,
-                                         std::function<void(FramePacketPtr)> callback) {
-    if (!mRunning.load() || !input) {
-        PIPELINE_LOGW("PipelineExecutor is not running or input is null");
-        return false;
+size_t PipelineExecutor::runBatch(const std::vector<FramePacketPtr>& inputs) {
+    auto plan = acquireCompiledPlan();
+    if (!plan) {
+        PIPELINE_LOGE("No execution plan available");
+        return 0;
     }
     
-    // 检查是否应该跳帧
-    if (shouldSkipFrame()) {
-        if (mFrameDroppedCallback) {
-            mFrameDroppedCallback(input);
+    TraceScope trace("processFrames", "frame", 0, inputs.front() ? inputs.front()->getFrameId() : 0);
+    auto startTime = std::chrono::steady_clock::now();
+    
+    BatchState batch;
+    batch.frameCount = inputs.size();
+    batch.slotCount = plan->outputSlotCount();
+    batch.outputs.resize(batch.frameCount * batch.slotCount);
+    batch.alive = std::make_unique<std::atomic<bool>[]>(batch.frameCount);
+    batch.live.resize(batch.frameCount);
+    batch.arena = mFrameArenaPool ? mFrameArenaPool->acquire() : nullptr;
+    for (size_t f = 0; f < batch.frameCount; ++f) {
+        batch.alive[f].store(inputs[f] != nullptr, std::memory_order_relaxed);
+    }
+    
+    // 源Entity（无上游）不执行，批内数据包按帧序直接作为其首个输出
+    std::vector<uint8_t> injected(plan->size(), 0);
+    for (size_t i = 0; i < plan->size(); ++i) {
+        uint32_t base = plan->outputOffsets[i];
+        if (plan->upstreamCounts[i] != 0 || base == plan->outputOffsets[i + 1]) {
+            continue;
+        }
+        injected[i] = 1;
+        for (size_t f = 0; f < batch.frameCount; ++f) {
+            batch.outputs[f * batch.slotCount + base] = inputs[f];
         }
-        mStats.droppedFrames++;
-        PIPELINE_LOGW("Dropped frame %llu", input->getFrameId());
-        return false;
     }
     
-    mPendingFrames.fetch_add(1);
+    // 逐层执行：每个Entity只调度一次，在其队列上连续处理整批
+    for (uint32_t level = 0; level < plan->levelCount(); ++level) {
+        if (!mRunning.load()) {
+            break;
+        }
+        
+        // 同层Entity基于层开始时的存活快照执行，结果与调度顺序无关
+        for (size_t f = 0; f < batch.frameCount; ++f) {
+            batch.live[f] = batch.alive[f].load(std::memory_order_relaxed) ? 1 : 0;
+        }
+        
+        uint32_t begin = plan->levelOffsets[level];
+        uint32_t end = plan->levelOffsets[level + 1];
+        if (mConfig.enableParallelExecution && end - begin > 1) {
+            auto group = task::TaskQueueFactory::GetInstance().createTaskGroup();
+            for (uint32_t k = begin; k < end; ++k) {
+                uint32_t index = plan->levelEntities[k];
+                if (injected[index]) {
+                    continue;
+                }
+                const CompiledPlan* planPtr = plan.get();
+                group->asyncQueue(
+                    std::make_shared<task::TaskOperator>([this, planPtr, index, &batch](
+                        const std::shared_ptr<task::TaskOperator>&) {
+                        executeBatchEntity(*planPtr, index, batch);
+                    }),
+                    getQueueForEntity(*plan->entities[index])
+                );
+            }
+            group->wait();
+        } else {
+            for (uint32_t k = begin; k < end; ++k) {
+                uint32_t index = plan->levelEntities[k];
+                if (injected[index]) {
+                    continue;
+                }
+                plan->queues[index]->sync([this, &plan, index, &batch]() {
+                    executeBatchEntity(*plan, index, batch);
+                });
+            }
+        }
+        
+        for (uint32_t slot = 0; slot < batch.slotCount; ++slot) {
+            // 该槽位的最后一个消费者在本层结束，释放整批的中间结果
+            if (plan->slotLastLevel[slot] != level) {
+                continue;
+            }
+            for (size_t f = 0; f < batch.frameCount; ++f) {
+                batch.outputs[f * batch.slotCount + slot].reset();
+            }
+        }
+    }
     
-    // 在IO队列异步执行
-    mIOQueue->async([this, input, callback]() {
-        processFrame(input);
-        if (callback) {
-            callback(input);
+    // 整批共用一个命令缓冲
+    commitFrameCommands();
+    
+    size_t completed = 0;
+    for (size_t f = 0; f < batch.frameCount; ++f) {
+        if (batch.alive[f].load(std::memory_order_relaxed)) {
+            ++completed;
         }
-    });
+    }
     
-    return true;
+    // 统计按摊销后的单帧耗时记录
+    auto batchTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count());
+    if (completed > 0) {
+        uint64_t perFrame = batchTime / completed;
+        for (size_t f = 0; f < completed; ++f) {
+            updateStats(perFrame);
+        }
+    }
+    if (completed < batch.frameCount) {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mStats.droppedFrames += batch.frameCount - completed;
+    }
+    
+    PIPELINE_LOGD("Batch of %zu frames completed (%zu succeeded) in %llu us",
+                  batch.frameCount, completed, static_cast<unsigned long long>(batchTime));
+    return completed;
 }
 
-bool PipelineExecutor::flush(int64_t timeoutMs) {
-    auto startTime = std::chrono::steady_clock::now();
+FramePacketPtr PipelineExecutor::processFrameInline(FramePacketPtr input) {
+    if (!input || !mContext) {
+        return nullptr;
+    }
+    auto plan = acquireCompiledPlan();
+    if (!plan || plan->size() == 0) {
+        PIPELINE_LOGE("No execution plan available");
+        return nullptr;
+    }
     
-    while (mPendingFrames.load() > 0) {
-        if (timeoutMs >= 0) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - startTime).count();
-            if (elapsed >= timeoutMs) {
-                return false;
+    TraceScope trace("processFrameInline", "frame", 0, input->getFrameId());
+    mContext->setCurrentFrameId(input->getFrameId());
+    mContext->setCurrentTimestamp(input->getTimestamp());
+    
+    std::vector<FramePacketPtr> outputs(plan->outputSlotCount());
+    std::vector<FramePacketPtr> inputs;
+    FramePacketPtr result;
+    FramePacketPtr lastOutput;
+    
+    for (uint32_t index = 0; index < plan->size(); ++index) {
+        ProcessEntity& entity = *plan->entities[index];
+        uint32_t base = plan->outputOffsets[index];
+        uint32_t slots = plan->outputOffsets[index + 1] - base;
+        if (plan->upstreamCounts[index] == 0 && slots > 0) {
+            outputs[base] = input;
+            continue;
+        }
+        
+        // 延迟输入的来源排在后面，单帧执行时尚无结果
+        inputs.clear();
+        for (uint32_t k = plan->inputOffsets[index]; k < plan->inputOffsets[index + 1]; ++k) {
+            uint32_t slot = plan->inputSlots[k];
+            if (slot == CompiledPlan::kInvalidSlot || plan->inputDeferred[k]) {
+                inputs.emplace_back();
+            } else {
+                inputs.push_back(outputs[slot]);
+            }
+        }
+        FramePacketPtr firstInput = firstConnectedInput(inputs);
+        if (!firstInput) {
+            continue;   // 上游失败或未连接
+        }
+        if (entity.getType() == EntityType::Output) {
+            if (!result) {
+                result = firstInput;
+            }
+            continue;
+        }
+        
+        prepareGpuCommands(*plan, index);
+        applyNegotiatedFormats(*plan, index);
+        if (!entity.execute(*mContext, inputs)) {
+            if (entity.getType() != EntityType::Composite) {
+                PIPELINE_LOGW("Entity %llu failed in inline frame %llu",
+                              plan->entityIds[index], input->getFrameId());
             }
+            continue;
+        }
+        const auto& ports = entity.getOutputPorts();
+        for (uint32_t k = 0; k < slots && k < ports.size(); ++k) {
+            outputs[base + k] = ports[k]->getPacket();
+        }
+        entity.releasePortPackets();
+        if (slots > 0 && outputs[base]) {
+            lastOutput = outputs[base];
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
     
-    return true;
+    // 图中没有输出节点时取最后一个产出的结果
+    if (mConfig.enableCommandRecording) {
+        GpuCommandContext::current().commit();
+    }
+    return result ? result : lastOutput;
 }
 
-void PipelineExecutor::cancelAll() {
-    // 取消所有Entity
-    auto entities = mGraph->getAllEntities();
-    for (auto& entity : entities) {
-        entity->cancel();
+void PipelineExecutor::executeBatchEntity(const CompiledPlan& plan, uint32_t index,
+                                          BatchState& batch) {
+    ProcessEntity& entity = *plan.entities[index];
+    uint32_t base = plan.outputOffsets[index];
+    size_t slots = plan.outputOffsets[index + 1] - base;
+    const auto& ports = entity.getOutputPorts();
+    std::vector<FramePacketPtr> inputs;
+    inputs.reserve(plan.inputOffsets[index + 1] - plan.inputOffsets[index]);
+    
+    TraceScope trace("executeBatch", kQueueTraceCategories[static_cast<size_t>(plan.queueTypes[index])],
+                     plan.entityIds[index]);
+    FrameArenaScope arenaScope(batch.arena.get());
+    const ShaderFusionChain* fusion = plan.fusion[index].get();
+    bool fusedMember = fusion && fusion->headIndex != index;
+    if (fusion && !fusedMember) {
+        fusion->members[0]->setActiveFusion(fusion);
+    }
+    prepareGpuCommands(plan, index);
+    entity.beginBatch(*mContext, batch.frameCount);
+    
+    for (size_t f = 0; f < batch.frameCount; ++f) {
+        if (!mRunning.load(std::memory_order_relaxed)) {
+            break;
+        }
+        if (!batch.live[f]) {
+            continue;
+        }
+        
+        FramePacketPtr* frameOutputs = batch.outputs.data() + f * batch.slotCount;
+        inputs.clear();
+        for (uint32_t k = plan.inputOffsets[index]; k < plan.inputOffsets[index + 1]; ++k) {
+            uint32_t slot = plan.inputSlots[k];
+            if (slot == CompiledPlan::kInvalidSlot) {
+                inputs.emplace_back();
+            } else {
+                inputs.push_back(frameOutputs[slot]);
+            }
+        }
+        
+        if (fusedMember) {
+            FramePacketPtr result = firstConnectedInput(inputs);
+            for (size_t k = 0; k < slots; ++k) {
+                frameOutputs[base + k] = result;
+            }
+            continue;
+        }
+        
+        applyNegotiatedFormats(plan, index);
+        if (!entity.execute(*mContext, inputs)) {
+            // 本帧不再向下游传播（CompositeEntity返回false表示等待其他路，不算错误）
+            batch.alive[f].store(false, std::memory_order_relaxed);
+            if (entity.getType() != EntityType::Composite) {
+                PIPELINE_LOGE("Entity %llu execution failed in batch", plan.entityIds[index]);
+                onEntityError(plan.entityIds[index], "Entity execution failed");
+            }
+            continue;
+        }
+        
+        for (size_t k = 0; k < slots && k < ports.size(); ++k) {
+            frameOutputs[base + k] = ports[k]->getPacket();
+        }
+        entity.releasePortPackets();
+    }
+    
+    entity.endBatch(*mContext);
+    if (fusion && !fusedMember) {
+        fusion->members[0]->setActiveFusion(nullptr);
     }
-    PIPELINE_LOGI("Cancelled all entities");
 }
 
-// =============================================================================
-// 状态查询
-// =============================================================================
+void PipelineExecutor::dropSkippedFrame(const FramePacketPtr& input) {
+    if (mFrameDroppedCallback) {
+        mFrameDroppedCallback(input);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mStats.droppedFrames++;
+    }
+    PIPELINE_LOGW("Dropped frame %llu", input->getFrameId());
+}
 
-ExecutionStats PipelineExecutor::getStats() const {
-    std::lock_guard<std::mutex> lock(mStatsMutex);
-    return mStats;
+void PipelineExecutor::finishPendingFrame(uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (mPendingFrames.fetch_sub(count) == count) {
+        notifyDrained();
+    }
 }
 
-void PipelineExecutor::resetStats() {
-    std::lock_guard<std::mutex> lock(mStatsMutex);
-    mStats = ExecutionStats();
+void PipelineExecutor::notifyDrained() {
+    std::vector<std::function<void(bool)>> callbacks;
+    {
+        // 加锁后再通知：等待方在锁内检查计数，不会丢失唤醒
+        std::lock_guard<std::mutex> lock(mFlushMutex);
+        if (mPendingFrames.load() != 0) {
+            return;
+        }
+        callbacks.swap(mFlushCallbacks);
+    }
+    mFlushCondition.notify_all();
+    
+    for (auto& callback : callbacks) {
+        callback(true);
+    }
 }
 
-// =============================================================================
-// 配置
-// =============================================================================
+bool PipelineExecutor::flush(int64_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(mFlushMutex);
+    auto drained = [this]() { return mPendingFrames.load() == 0; };
+    
+    if (timeoutMs < 0) {
+        mFlushCondition.wait(lock, drained);
+        return true;
+    }
+    return mFlushCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), drained);
+}
 
-void PipelineExecutor::setParallelExecutionEnabled(bool enabled) {
-    mConfig.enableParallelExecution = enabled;
+void PipelineExecutor::flushAsync(std::function<void(bool)> callback) {
+    if (!callback) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mFlushMutex);
+        if (mPendingFrames.load() != 0) {
+            mFlushCallbacks.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback(true);
 }
 
-void PipelineExecutor::setFrameSkippingEnabled(bool enabled) {
-    mConfig.enableFrameSkipping = enabled;
+void PipelineExecutor::runOnGPUQueue(const std::function<void()>& task) {
+    if (!task) {
+        return;
+    }
+    if (!mGPUQueue) {
+        task();
+        return;
+    }
+    mGPUQueue->sync([&task]() { task(); });
 }
 
-void PipelineExecutor::setFrameCompleteCallback(std::function<void(FramePacketPtr)> callback) {
-    mFrameCompleteCallback = std::move(callback);
+void PipelineExecutor::postToGPUQueue(std::function<void()> task) {
+    if (!task) {
+        return;
+    }
+    if (!mGPUQueue) {
+        task();
+        return;
+    }
+    mGPUQueue->async(std::move(task));
 }
 
-void PipelineExecutor::setFrameDroppedCallback(std::function<void(FramePacketPtr)> callback) {
-    mFrameDroppedCallback = std::move(callback);
+void PipelineExecutor::setSharedGPUQueue(std::shared_ptr<task::TaskQueue> queue) {
+    if (mInitialized.load()) {
+        PIPELINE_LOGW("Shared GPU queue must be set before initialize()");
+        return;
+    }
+    mSharedGPUQueue = std::move(queue);
 }
 
-void PipelineExecutor::setErrorCallback(std::function<void(EntityId, const std::string&)> callback) {
-    mErrorCallback = std::move(callback);
+void PipelineExecutor::setTransferContextBinding(TransferContextBinding binding) {
+    if (mInitialized.load()) {
+        PIPELINE_LOGW("Transfer context binding must be set before initialize()");
+        return;
+    }
+    mTransferBinding = std::move(binding);
 }
 
-// =============================================================================
-// 内部方法
-// =============================================================================
+void PipelineExecutor::postToTransferQueue(std::function<void()> task) {
+    if (!task) {
+        return;
+    }
+    if (mTransferQueue) {
+        mTransferQueue->async(std::move(task));
+        return;
+    }
+    postToGPUQueue(std::move(task));
+}
 
-bool PipelineExecutor::createTaskQueues() {
-    auto& factory = task::TaskQueueFactory::GetInstance();
-    
-    // GPU串行队列（独占线程，保证OpenGL上下文安全）
-    mGPUQueue = factory.createSerialTaskQueue(
-        mConfig.gpuQueueLabel,
-        task::WorkThreadPriority::WTP_High,
-        true  // 独占线程
-    );
+void PipelineExecutor::postToIOQueue(std::function<void()> task) {
+    if (!task) {
+        return;
+    }
+    if (!mIOQueue) {
+        task();
+        return;
+    }
+    mIOQueue->async(std::move(task));
+}
+
+void PipelineExecutor::postToCPUQueue(std::function<void()> task) {
+    if (!task) {
+        return;
+    }
+    postToExecutionQueue(ExecutionQueue::CPUParallel, std::move(task));
+}
+
+size_t PipelineExecutor::trimIdleMemory() {
+    return mFrameArenaPool ? mFrameArenaPool->shrink() : 0;
+}
+
+void PipelineExecutor::cancelFlushCallbacks() {
+    std::vector<std::function<void(bool)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mFlushMutex);
+        callbacks.swap(mFlushCallbacks);
+    }
+    bool drained = mPendingFrames.load() == 0;
+    for (auto& callback : callbacks) {
+        callback(drained);
+    }
+}
+
+void PipelineExecutor::cancelAll() {
+    // 取消所有Entity
+    auto entities = mGraph->getAllEntities();
+    for (auto& entity : entities) {
+        entity->cancel();
+    }
+    PIPELINE_LOGI("Cancelled all entities");
+}
+
+// =============================================================================
+// 状态查询
+// =============================================================================
+
+ExecutionStats PipelineExecutor::getStats() const {
+    ExecutionStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        stats = mStats;
+    }
+    stats.gpuQueueTime = mQueueTimeUs[static_cast<size_t>(ExecutionQueue::GPU)].load();
+    stats.cpuQueueTime = mQueueTimeUs[static_cast<size_t>(ExecutionQueue::CPUParallel)].load();
+    stats.ioQueueTime = mQueueTimeUs[static_cast<size_t>(ExecutionQueue::IO)].load();
+    stats.proxyFrames = mProxyFrames.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PipelineExecutor::resetStats() {
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mStats = ExecutionStats();
+    }
+    for (auto& queueTime : mQueueTimeUs) {
+        queueTime.store(0);
+    }
+    mProxyFrames.store(0, std::memory_order_relaxed);
+    
+    std::lock_guard<std::mutex> lock(mProfileMutex);
+    mFrameTimeHistogram.reset();
+    for (auto& [id, profile] : mEntityProfiles) {
+        profile->wallTime.reset();
+        profile->queueWait.reset();
+        profile->gpuTime.reset();
+    }
+}
+
+std::optional<EntityStats> PipelineExecutor::getEntityStats(EntityId entityId) const {
+    std::lock_guard<std::mutex> lock(mProfileMutex);
+    auto it = mEntityProfiles.find(entityId);
+    if (it == mEntityProfiles.end() || it->second->wallTime.getCount() == 0) {
+        return std::nullopt;
+    }
+    return makeEntityStats(*it->second);
+}
+
+ProfilingSnapshot PipelineExecutor::getProfilingSnapshot() const {
+    ProfilingSnapshot snapshot;
+    snapshot.frameStats = getStats();
+    
+    std::lock_guard<std::mutex> lock(mProfileMutex);
+    snapshot.frameTime = mFrameTimeHistogram.getSummary();
+    
+    std::vector<const EntityProfile*> profiles;
+    profiles.reserve(mEntityProfiles.size());
+    for (const auto& [id, profile] : mEntityProfiles) {
+        profiles.push_back(profile.get());
+    }
+    std::sort(profiles.begin(), profiles.end(),
+              [](const EntityProfile* a, const EntityProfile* b) { return a->order < b->order; });
+    
+    snapshot.entities.reserve(profiles.size());
+    for (const auto* profile : profiles) {
+        snapshot.entities.push_back(makeEntityStats(*profile));
+    }
+    return snapshot;
+}
+
+EntityStats PipelineExecutor::makeEntityStats(const EntityProfile& profile) {
+    EntityStats stats;
+    stats.entityId = profile.entityId;
+    stats.name = profile.name;
+    stats.queue = profile.queue;
+    stats.wallTime = profile.wallTime.getSummary();
+    stats.queueWait = profile.queueWait.getSummary();
+    stats.gpuTime = profile.gpuTime.getSummary();
+    return stats;
+}
+
+// =============================================================================
+// 配置
+// =============================================================================
+
+void PipelineExecutor::setParallelExecutionEnabled(bool enabled) {
+    mConfig.enableParallelExecution = enabled;
+}
+
+void PipelineExecutor::setFrameSkippingEnabled(bool enabled) {
+    mConfig.enableFrameSkipping = enabled;
+}
+
+void PipelineExecutor::setFrameCompleteCallback(std::function<void(FramePacketPtr)> callback) {
+    mFrameCompleteCallback = std::move(callback);
+}
+
+void PipelineExecutor::setFrameDroppedCallback(std::function<void(FramePacketPtr)> callback) {
+    mFrameDroppedCallback = std::move(callback);
+}
+
+void PipelineExecutor::setErrorCallback(std::function<void(EntityId, const std::string&)> callback) {
+    mErrorCallback = std::move(callback);
+}
+
+void PipelineExecutor::setContext(std::shared_ptr<PipelineContext> context) {
+    if (mContext && mContext != context) {
+        mContext->setCPUThreadPool(nullptr);
+    }
+    mContext = std::move(context);
+    if (mContext) {
+        mContext->setCPUThreadPool(mCPUPool.get());
+    }
+}
+
+void PipelineExecutor::recordInputDrops(uint64_t count) {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    mStats.droppedFrames += count;
+    mStats.inputDroppedFrames += count;
+}
+
+// =============================================================================
+// 代理分辨率
+// =============================================================================
+
+void PipelineExecutor::setProxyRenderScale(float scale) {
+    if (!(scale > 0.0f)) {
+        PIPELINE_LOGW("Invalid proxy render scale %f, using full resolution", scale);
+        scale = 1.0f;
+    }
+    mProxyRenderScale.store(std::min(scale, 1.0f), std::memory_order_relaxed);
+}
+
+void PipelineExecutor::computeOutputDemand(const CompiledPlan& plan, FrameExecutionState& frame) {
+    const size_t n = plan.size();
+    frame.outputDemand.assign(n, ~uint64_t(0));
+    
+    // 消费者索引大于生产者，逆序遍历时消费者的输出需求已确定
+    std::vector<uint8_t> slotDemand(plan.outputSlotCount(), 0);
+    for (size_t i = n; i-- > 0;) {
+        const uint32_t base = plan.outputOffsets[i];
+        const uint32_t end = plan.outputOffsets[i + 1];
+        uint64_t mask = ~uint64_t(0);
+        for (uint32_t slot = base; slot < end; ++slot) {
+            bool demanded = false;
+            for (uint32_t c = plan.slotConsumerOffsets[slot]; c < plan.slotConsumerOffsets[slot + 1]; ++c) {
+                const auto& consumer = plan.slotConsumers[c];
+                const auto& target = plan.entities[consumer.entity];
+                if (!target->isEnabled()) {
+                    // 直通：输入端口 k 原样流向输出端口 k
+                    uint32_t forwarded = plan.outputOffsets[consumer.entity] + consumer.port;
+                    demanded = demanded ||
+                        (forwarded < plan.outputOffsets[consumer.entity + 1] && slotDemand[forwarded]);
+                } else if (target->wantsInput(consumer.port)) {
+                    // 不提前退出：每个端口每帧恰好询问一次
+                    demanded = true;
+                }
+            }
+            slotDemand[slot] = demanded ? 1 : 0;
+            if (!demanded && slot - base < 64) {
+                mask &= ~(uint64_t(1) << (slot - base));
+            }
+        }
+        frame.outputDemand[i] = mask;
+    }
+}
+
+void PipelineExecutor::requestFullResolution(uint32_t frameCount) {
+    mFullResolutionRequests.fetch_add(frameCount, std::memory_order_acq_rel);
+}
+
+float PipelineExecutor::selectRenderScale(const CompiledPlan& plan) {
+    const float proxyScale = mProxyRenderScale.load(std::memory_order_relaxed);
+    if (proxyScale >= 1.0f) {
+        return 1.0f;
+    }
+    
+    // 按需申请的全分辨率帧：每帧消耗一次
+    uint32_t requests = mFullResolutionRequests.load(std::memory_order_acquire);
+    while (requests > 0 &&
+           !mFullResolutionRequests.compare_exchange_weak(requests, requests - 1,
+                                                          std::memory_order_acq_rel)) {
+    }
+    if (requests > 0) {
+        return 1.0f;
+    }
+    
+    for (const auto& entity : plan.entities) {
+        if (entity->isEnabled() && entity->requiresFullResolution()) {
+            return 1.0f;
+        }
+    }
+    mProxyFrames.fetch_add(1, std::memory_order_relaxed);
+    return proxyScale;
+}
+
+// =============================================================================
+// 内部方法
+// =============================================================================
+
+bool PipelineExecutor::createTaskQueues() {
+    auto& factory = task::TaskQueueFactory::GetInstance();
+    
+    // GPU串行队列（独占线程，保证OpenGL上下文安全）；共用上下文时沿用外部队列
+    if (mSharedGPUQueue) {
+        mGPUQueue = mSharedGPUQueue;
+    } else {
+        mGPUQueue = factory.createSerialTaskQueue(
+            mConfig.gpuQueueLabel,
+            task::WorkThreadPriority::WTP_High,
+            true  // 独占线程
+        );
+    }
     
     // CPU并行队列
     mCPUQueue = factory.createConcurrencyTaskQueue(
@@ -294,29 +938,188 @@ bool PipelineExecutor::createTaskQueues() {
         false  // 共享线程
     );
     
+    // 工作窃取线程池：承接异步任务链中的CPUParallel任务
+    // （同步 processFrame 的层级并行仍使用 TaskQueue 并发队列）
+    if (mConfig.useWorkStealingCPUPool) {
+        WorkStealingPoolConfig poolConfig;
+        poolConfig.label = mConfig.cpuQueueLabel;
+        poolConfig.threadCount = mConfig.cpuThreadCount;
+        poolConfig.pinToBigCores = mConfig.pinCPUWorkersToBigCores;
+        mCPUPool = std::make_unique<WorkStealingThreadPool>(poolConfig);
+        if (!mCPUPool->start()) {
+            PIPELINE_LOGW("Failed to start work-stealing CPU pool, falling back to TaskQueue");
+            mCPUPool.reset();
+        }
+    }
+    
     return mGPUQueue && mCPUQueue && mIOQueue;
 }
 
-void PipelineExecutor::updateExecutionPlan() {
-    mExecutionLevels = mGraph->getExecutionLevels();
-    mLastGraphVersion = mGraph->getVersion();
+void PipelineExecutor::configureGpuCommands() {
+    const bool recording = mConfig.enableCommandRecording;
+    const bool tracking = mConfig.enableStateTracking;
+    runOnGPUQueue([recording, tracking]() {
+        auto& commands = GpuCommandContext::current();
+        commands.setStateTrackingEnabled(tracking);
+        if (commands.setRecordingEnabled(recording) != recording) {
+            PIPELINE_LOGI("Frame command recording unavailable, GPU passes are submitted individually");
+        }
+    });
+}
+
+void PipelineExecutor::prepareGpuCommands(const CompiledPlan& plan, uint32_t index) {
+    if (plan.directGpuAccess[index]) {
+        // 显示/编码/输入上传等直接使用渲染上下文：之前录制的命令须先提交，之后的绑定状态不可信
+        GpuCommandContext::current().commit();
+    }
+}
+
+void PipelineExecutor::commitFrameCommands() {
+    if (!mConfig.enableCommandRecording && !mConfig.enableStateTracking) {
+        return;
+    }
+    // GPU队列串行：提交排在本帧最后一个GPU任务之后；
+    // 不录制时只让状态在帧边界失效，帧间被释放重建的对象不会因地址复用被误判为已绑定
+    postToGPUQueue([]() { GpuCommandContext::current().commit(); });
 }
 
-void PipelineExecutor::executeEntity(EntityId entityId, FramePacketPtr frameContext) {
-    auto entity = mGraph->getEntity(entityId);
-    if (!entity) {
-        PIPELINE_LOGW("Entity %llu not found", entityId);
+void PipelineExecutor::createTransferQueue() {
+    if (!mConfig.enableTransferQueue || mTransferQueue) {
+        return;
+    }
+    if (!mTransferBinding.attach) {
+        PIPELINE_LOGW("Transfer queue requested without a shared context, transfers stay on the GPU queue");
         return;
     }
     
-    // 获取对应的队列
-    auto queue = getQueueForEntity(entityId);
+    // 独占线程：共享上下文创建后常驻在该线程上
+    auto queue = task::TaskQueueFactory::GetInstance().createSerialTaskQueue(
+        mConfig.transferQueueLabel,
+        task::WorkThreadPriority::WTP_High,
+        true
+    );
     if (!queue) {
-        queue = mGPUQueue; // 默认使用GPU队列
+        return;
+    }
+    
+    bool attached = false;
+    queue->sync([this, &attached]() { attached = mTransferBinding.attach(); });
+    if (!attached) {
+        PIPELINE_LOGW("Failed to bind the transfer context, transfers stay on the GPU queue");
+        return;
+    }
+    mTransferQueue = std::move(queue);
+    PIPELINE_LOGI("Transfer queue started: %s", mConfig.transferQueueLabel.c_str());
+}
+
+void PipelineExecutor::destroyTransferQueue() {
+    if (!mTransferQueue) {
+        return;
+    }
+    if (mContext) {
+        mContext->setTransferPoster(nullptr);
+    }
+    // 同步执行：之前投递的上传/读回先于解绑完成
+    if (mTransferBinding.detach) {
+        mTransferQueue->sync([this]() { mTransferBinding.detach(); });
+    }
+    mTransferQueue.reset();
+}
+
+void PipelineExecutor::updateExecutionPlan() {
+    std::atomic_store(&mCompiledPlan, compilePlan(*mGraph));
+}
+
+void PipelineExecutor::setInputEntityId(EntityId entityId) {
+    std::lock_guard<std::mutex> lock(mFrameStateMutex);
+    if (mInputEntityId == entityId) {
+        return;
+    }
+    const bool switching = mInputEntityId != InvalidEntityId;
+    mInputEntityId = entityId;
+    if (switching) {
+        std::atomic_store(&mCompiledPlan, std::shared_ptr<const CompiledPlan>());
+        std::atomic_store(&mPreparedPlan, std::shared_ptr<const CompiledPlan>());
+    }
+}
+
+std::shared_ptr<const CompiledPlan> PipelineExecutor::acquireCompiledPlan() {
+    auto plan = std::atomic_load(&mCompiledPlan);
+    if (!plan || plan->graphVersion != mGraph->getVersion()) {
+        updateExecutionPlan();
+        plan = std::atomic_load(&mCompiledPlan);
+        PIPELINE_LOGI("Graph changed, updated execution plan");
+    }
+    return plan;
+}
+
+void PipelineExecutor::setPlanPreparer(PlanPreparer preparer) {
+    std::lock_guard<std::mutex> lock(mPlanPreparerMutex);
+    mPlanPreparer = std::move(preparer);
+}
+
+void PipelineExecutor::schedulePlanPreparation() {
+    if (!mIOQueue || mPlanPreparing.exchange(true)) {
+        return;
+    }
+    std::weak_ptr<PipelineExecutor> weakSelf = weak_from_this();
+    mIOQueue->async([weakSelf]() {
+        if (auto self = weakSelf.lock()) {
+            self->preparePlan();
+        }
+    });
+}
+
+void PipelineExecutor::preparePlan() {
+    // 快照在图锁内一次复制，编译期间实时图可以继续编辑
+    std::shared_ptr<PipelineGraph> snapshot = mGraph->clone();
+    auto plan = compilePlan(*snapshot);
+    
+    PlanPreparer preparer;
+    {
+        std::lock_guard<std::mutex> lock(mPlanPreparerMutex);
+        preparer = mPlanPreparer;
+    }
+    if (!preparer || !mGPUQueue) {
+        publishPreparedPlan(std::move(plan));
+        return;
     }
     
+    // 着色器与FBO须在GL线程创建；作为普通任务插在帧任务之间，不阻塞帧的开始
+    std::weak_ptr<PipelineExecutor> weakSelf = weak_from_this();
+    mGPUQueue->async([weakSelf, snapshot, plan, preparer]() {
+        auto self = weakSelf.lock();
+        if (!self) {
+            return;
+        }
+        if (self->mRunning.load()) {
+            TraceScope trace("preparePlan", "gpu");
+            preparer(*snapshot);
+        }
+        self->publishPreparedPlan(plan);
+    });
+}
+
+void PipelineExecutor::publishPreparedPlan(std::shared_ptr<const CompiledPlan> plan) {
+    PIPELINE_LOGD("Prepared execution plan for graph version %llu", plan->graphVersion);
+    std::atomic_store(&mPreparedPlan, std::move(plan));
+    // 准备期间图又有编辑时版本对不上，下一次开帧会重新发起
+    mPlanPreparing.store(false);
+}
+
+std::shared_ptr<const CompiledPlan> PipelineExecutor::getCompiledPlan() const {
+    return std::atomic_load(&mCompiledPlan);
+}
+
+void PipelineExecutor::executeEntity(const CompiledPlan& plan, uint32_t index, FrameArena* arena) {
+    const auto& entity = plan.entities[index];
+    task::TaskQueue* queue = plan.queues[index];
+    
     // 同步执行（在对应队列中）
-    queue->sync([this, entity, &frameContext]() {
+    queue->sync([this, &plan, index, &entity, arena]() {
+        FrameArenaScope arenaScope(arena);
+        prepareGpuCommands(plan, index);
+        applyNegotiatedFormats(plan, index);
         bool success = entity->execute(*mContext);
         if (!success && entity->hasError()) {
             onEntityError(entity->getId(), "Entity execution failed");
@@ -324,38 +1127,100 @@ void PipelineExecutor::executeEntity(EntityId entityId, FramePacketPtr frameCont
     });
 }
 
-void PipelineExecutor::executeLevel(const std::vector<EntityId>& level,
-                                    FramePacketPtr frameContext,
-                                    std::shared_ptr<task::TaskGroup> group) {
-    for (EntityId id : level) {
-        auto entity = mGraph->getEntity(id);
-        if (!entity) {
-            continue;
+void PipelineExecutor::executeDataflow(const CompiledPlan& plan, FrameArena* arena) {
+    const size_t count = plan.size();
+    if (count == 0) {
+        return;
+    }
+    
+    // 同步路径没有帧级延迟模型，按各Entity的平均实测耗时估算关键路径
+    std::vector<uint64_t> ranks(count);
+    for (size_t i = 0; i < count; ++i) {
+        ranks[i] = plan.entities[i]->getAverageProcessDuration();
+    }
+    if (mConfig.enableCriticalPathPriority) {
+        accumulateCriticalRanks(plan, ranks);
+    }
+    
+    // 各Entity完成后只递减其后继的计数，归零即投递；等待所有Entity结束后返回
+    struct DataflowState {
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::vector<int32_t> pending;
+        size_t remaining = 0;
+    } state;
+    state.pending.assign(plan.upstreamCounts.begin(), plan.upstreamCounts.end());
+    state.remaining = count;
+    
+    std::function<void(std::vector<uint32_t>&)> dispatch;
+    dispatch = [&](std::vector<uint32_t>& ready) {
+        // 同一串行队列按投递顺序执行：剩余链最长的先投递
+        std::sort(ready.begin(), ready.end(), [&ranks](uint32_t a, uint32_t b) {
+            return ranks[a] > ranks[b];
+        });
+        for (uint32_t index : ready) {
+            ProcessEntity* entity = plan.entities[index].get();
+            plan.queues[index]->async(std::make_shared<task::TaskOperator>(
+                [&, entity, index](const std::shared_ptr<task::TaskOperator>&) {
+                    if (mRunning.load()) {
+                        FrameArenaScope arenaScope(arena);
+                        prepareGpuCommands(plan, index);
+                        applyNegotiatedFormats(plan, index);
+                        bool success = entity->execute(*mContext);
+                        if (!success && entity->hasError()) {
+                            onEntityError(entity->getId(), "Entity execution failed");
+                        }
+                    }
+                    
+                    std::vector<uint32_t> next;
+                    bool done = false;
+                    {
+                        std::lock_guard<std::mutex> lock(state.mutex);
+                        for (uint32_t k = plan.successorOffsets[index]; k < plan.successorOffsets[index + 1]; ++k) {
+                            if (--state.pending[plan.successors[k]] == 0) {
+                                next.push_back(plan.successors[k]);
+                            }
+                        }
+                        done = --state.remaining == 0;
+                        if (done) {
+                            // 持锁通知：等待方醒来前本任务不再访问 state
+                            state.finished.notify_all();
+                        }
+                    }
+                    if (!next.empty()) {
+                        dispatch(next);
+                    }
+                }));
+        }
+    };
+    
+    std::vector<uint32_t> sources;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (state.pending[i] == 0) {
+            sources.push_back(i);
         }
-        
-        auto queue = getQueueForEntity(id);
-        
-        // 异步执行
-        group->asyncQueue(
-            std::make_shared<task::TaskOperator>([this, entity, &frameContext](
-                const std::shared_ptr<task::TaskOperator>&) {
-                bool success = entity->execute(*mContext);
-                if (!success && entity->hasError()) {
-                    onEntityError(entity->getId(), "Entity execution failed");
-                }
-            }),
-            queue
-        );
     }
+    dispatch(sources);
+    
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&state] { return state.remaining == 0; });
 }
 
-std::shared_ptr<task::TaskQueue> PipelineExecutor::getQueueForEntity(EntityId entityId) const {
-    auto entity = mGraph->getEntity(entityId);
-    if (!entity) {
-        return mGPUQueue;
+void PipelineExecutor::updateCriticalRanks(const CompiledPlan& plan, LatencyModel& model) {
+    thread_local std::vector<uint64_t> tRanks;
+    tRanks.resize(plan.size());
+    for (size_t i = 0; i < plan.size(); ++i) {
+        tRanks[i] = model.stageTimeUs[i].load(std::memory_order_relaxed);
     }
-    
-    switch (entity->getExecutionQueue()) {
+    accumulateCriticalRanks(plan, tRanks);
+    for (size_t i = 0; i < plan.size(); ++i) {
+        model.criticalRankUs[i].store(tRanks[i], std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<task::TaskQueue> PipelineExecutor::getQueueForEntity(
+    const ProcessEntity& entity) const {
+    switch (entity.getExecutionQueue()) {
         case ExecutionQueue::GPU:
             return mGPUQueue;
         case ExecutionQueue::CPUParallel:
@@ -384,6 +1249,10 @@ void PipelineExecutor::onFrameComplete(FramePacketPtr frameContext) {
 }
 
 void PipelineExecutor::updateStats(uint64_t frameTime) {
+    if (mProfilingEnabled.load(std::memory_order_relaxed)) {
+        mFrameTimeHistogram.record(frameTime);
+    }
+    
     std::lock_guard<std::mutex> lock(mStatsMutex);
     
     mStats.totalFrames++;
@@ -413,6 +1282,11 @@ bool PipelineExecutor::shouldSkipFrame() const {
 // 异步任务链实现 (新增)
 // =============================================================================
 
+uint32_t PipelineExecutor::getInFlightFrameCount() const {
+    std::lock_guard<std::mutex> lock(mFrameStateMutex);
+    return static_cast<uint32_t>(mInFlightFrames.size());
+}
+
 bool PipelineExecutor::submitEntityTask(EntityId entityId, 
                                         std::shared_ptr<void> contextData) {
     if (!mRunning.load()) {
@@ -420,14 +1294,48 @@ bool PipelineExecutor::submitEntityTask(EntityId entityId,
         return false;
     }
     
-    auto entity = mGraph->getEntity(entityId);
-    if (!entity || !entity->isEnabled()) {
-        PIPELINE_LOGW("Entity %llu not found or disabled", entityId);
+    auto frame = std::static_pointer_cast<FrameExecutionState>(contextData);
+    if (frame) {
+        uint32_t index = frame->plan->findIndex(entityId);
+        if (index == CompiledPlan::kInvalidSlot) {
+            PIPELINE_LOGW("Entity %llu not in frame execution plan", entityId);
+            return false;
+        }
+        return submitFrameTask(index, frame);
+    }
+    
+    // 未指定帧：仅InputEntity可开启新帧
+    if (entityId != mInputEntityId) {
+        PIPELINE_LOGW("Entity %llu submitted without frame state", entityId);
+        return false;
+    }
+    
+    ReadyList ready;
+    bool begun = false;
+    {
+        std::lock_guard<std::mutex> lock(mFrameStateMutex);
+        begun = tryBeginFrameLocked(ready);
+    }
+    
+    if (!begun) {
+        PIPELINE_LOGD("In-flight frame limit reached, input entity %llu not submitted", entityId);
+        return false;
+    }
+    
+    dispatchReady(ready);
+    return true;
+}
+
+bool PipelineExecutor::submitFrameTask(uint32_t index, const FrameStatePtr& frame) {
+    if (!mRunning.load()) {
         return false;
     }
     
+    const CompiledPlan& plan = *frame->plan;
+    EntityId entityId = plan.entityIds[index];
+    
     // 获取对应的任务队列
-    auto queue = getQueueForEntity(entityId);
+    task::TaskQueue* queue = plan.queues[index];
     if (!queue) {
         PIPELINE_LOGE("No queue found for entity %llu", entityId);
         return false;
@@ -437,174 +1345,1331 @@ bool PipelineExecutor::submitEntityTask(EntityId entityId,
     // 当 PipelineExecutor 被销毁后，weak_ptr 会失效，回调会安全退出
     auto weakSelf = std::weak_ptr<PipelineExecutor>(shared_from_this());
     
-    auto taskOp = std::make_shared<task::TaskOperator>(
-        [weakSelf, entityId, contextData](const std::shared_ptr<task::TaskOperator>&) {
-            // 尝试获取 shared_ptr
+    if (frame->readyTimes) {
+        frame->readyTimes[index] = PipelineTrace::now();
+    }
+    if (PipelineTrace::isEnabled()) {
+        PipelineTrace::instant("submit",
+                               kQueueTraceCategories[static_cast<size_t>(plan.queueTypes[index])],
+                               entityId, frame->frameId);
+    }
+    
+    auto task = [weakSelf, index, frame]() {
+        // 尝试获取 shared_ptr
+        auto self = weakSelf.lock();
+        if (!self) {
+            // PipelineExecutor 已被销毁，安全退出
+            return;
+        }
+        
+        // 再次检查运行状态
+        if (!self->mRunning.load()) {
+            return;
+        }
+        
+        self->executeEntityTask(index, frame);
+    };
+    
+    if (mConfig.enablePriorityLanes) {
+        // 任务入列，底层队列只执行出队跳板，由跳板选择当前最高优先级的任务
+        ExecutionQueue queueType = plan.queueTypes[index];
+        enqueueLaneTask(queueType, plan.lanes[index], std::move(task));
+        auto trampoline = [weakSelf, queueType]() {
             auto self = weakSelf.lock();
             if (!self) {
-                // PipelineExecutor 已被销毁，安全退出
                 return;
             }
-            
-            // 再次检查运行状态
-            if (!self->mRunning.load()) {
-                return;
+            if (auto next = self->popLaneTask(queueType)) {
+                next();
             }
-            
-            self->executeEntityTask(entityId, contextData);
+        };
+        if (!(mCPUPool && queueType == ExecutionQueue::CPUParallel && mCPUPool->submit(trampoline))) {
+            queue->async(std::make_shared<task::TaskOperator>(
+                [trampoline](const std::shared_ptr<task::TaskOperator>&) { trampoline(); }));
         }
-    );
+        PIPELINE_LOGD("Submitted task for entity %llu (frame %llu) to lane %d",
+                      entityId, frame->frameId, static_cast<int>(plan.lanes[index]));
+        return true;
+    }
+    
+    // CPUParallel 任务优先投递到工作窃取线程池（后继倾向于在同一工作线程执行）
+    if (mCPUPool && plan.queueTypes[index] == ExecutionQueue::CPUParallel &&
+        mCPUPool->submit(task)) {
+        PIPELINE_LOGD("Submitted task for entity %llu (frame %llu) to CPU pool",
+                      entityId, frame->frameId);
+        return true;
+    }
     
-    queue->async(taskOp);
-    PIPELINE_LOGD("Submitted task for entity %llu to queue", entityId);
+    queue->async(std::make_shared<task::TaskOperator>(
+        [task](const std::shared_ptr<task::TaskOperator>&) { task(); }));
+    PIPELINE_LOGD("Submitted task for entity %llu (frame %llu) to queue",
+                  entityId, frame->frameId);
     return true;
 }
 
-void PipelineExecutor::executeEntityTask(EntityId entityId, 
-                                         std::shared_ptr<void> contextData) {
-    auto entity = mGraph->getEntity(entityId);
-    if (!entity) {
-        PIPELINE_LOGW("Entity %llu not found in executeEntityTask", entityId);
-        return;
-    }
-    
-    PIPELINE_LOGD("Executing entity %llu (%s)", entityId, entity->getName().c_str());
-    
-    // 执行Entity
-    bool success = entity->execute(*mContext);
+void PipelineExecutor::enqueueLaneTask(ExecutionQueue queue, ExecutionLane lane,
+                                       std::function<void()> task) {
+    LaneScheduler& scheduler = mLaneSchedulers[static_cast<size_t>(queue)];
+    size_t laneIndex = std::min(static_cast<size_t>(lane), kExecutionLaneCount - 1);
+    std::lock_guard<std::mutex> lock(scheduler.mutex);
+    scheduler.pending[laneIndex].push_back(std::move(task));
+}
+
+std::function<void()> PipelineExecutor::popLaneTask(ExecutionQueue queue) {
+    LaneScheduler& scheduler = mLaneSchedulers[static_cast<size_t>(queue)];
+    std::lock_guard<std::mutex> lock(scheduler.mutex);
     
-    if (!success) {
-        // 如果是MergeEntity且返回false
-        // 说明正在等待其他路,不算错误
-        if (entity->getType() == EntityType::Composite) {
-            PIPELINE_LOGD("MergeEntity %llu waiting for other paths", entityId);
-            return;  // 不投递下游任务,等待下次被触发
+    // 取最高优先级的非空通道；被越过的低优先级通道累计次数，超过上限时改为执行它
+    size_t chosen = kExecutionLaneCount;
+    for (size_t lane = 0; lane < kExecutionLaneCount; ++lane) {
+        if (scheduler.pending[lane].empty()) {
+            continue;
+        }
+        if (chosen == kExecutionLaneCount) {
+            chosen = lane;
+        } else if (++scheduler.bypassed[lane] > mConfig.laneStarvationLimit) {
+            chosen = lane;
+            break;
+        }
+    }
+    if (chosen == kExecutionLaneCount) {
+        return nullptr;
+    }
+    
+    scheduler.bypassed[chosen] = 0;
+    std::function<void()> task = std::move(scheduler.pending[chosen].front());
+    scheduler.pending[chosen].pop_front();
+    return task;
+}
+
+void PipelineExecutor::clearLaneTasks() {
+    for (auto& scheduler : mLaneSchedulers) {
+        std::lock_guard<std::mutex> lock(scheduler.mutex);
+        for (auto& pending : scheduler.pending) {
+            pending.clear();
+        }
+        for (auto& bypassed : scheduler.bypassed) {
+            bypassed = 0;
+        }
+    }
+}
+
+void PipelineExecutor::executeEntityTask(uint32_t index, const FrameStatePtr& frame) {
+    // 工作线程内复用的缓冲：稳态下不产生分配（取出后再归还，重入时退化为新缓冲）
+    thread_local ReadyList tReadyCache;
+    thread_local std::vector<FramePacketPtr> tInputCache;
+    ReadyList ready = std::move(tReadyCache);
+    std::vector<FramePacketPtr> inputs = std::move(tInputCache);
+    ready.clear();
+    
+    const CompiledPlan& plan = *frame->plan;
+    EntityId entityId = plan.entityIds[index];
+    ProcessEntity& entity = *plan.entities[index];
+    
+    PIPELINE_LOGD("Executing entity %llu (%s) for frame %llu",
+                  entityId, entity.getName().c_str(), frame->frameId);
+    
+    // 执行Entity（输入取自本帧上游的输出，不受其他在途帧影响）
+    gatherFrameInputs(index, *frame, inputs);
+    uint32_t base = plan.outputOffsets[index];
+    size_t slots = plan.outputOffsets[index + 1] - base;
+    
+    // 编译后才被禁用（新计划换入前）的Entity同样按端口直通，不中断本帧；
+    // 可降级Entity在启动时的资源加载完成前同样直通
+    bool bypassed = index != frame->inputIndex &&
+        (!entity.isEnabled() ||
+         (entity.isOptional() && (frame->degraded.load(std::memory_order_relaxed) ||
+                                  !entity.areResourcesReady())));
+    // 旁路分支仍在处理更早的帧（或本帧其旁路上游已跳过）时直接跳过，消费者沿用最近一次结果；
+    // 只看自身状态，同一帧里其他空闲的旁路分支照常执行
+    bool sideSkipped = plan.sideBranch[index] &&
+        (((frame->sideBranchSkips[index / 64].load(std::memory_order_acquire) >> (index % 64)) & 1) != 0 ||
+         plan.sideBranchBusy[index].exchange(1, std::memory_order_acq_rel) != 0);
+    const ShaderFusionChain* fusion = plan.fusion[index].get();
+    bool fusedMember = fusion && fusion->headIndex != index;
+    bool success = true;
+    if (sideSkipped) {
+        // 旁路分支的直接后继都属于旁路分支：在释放依赖前标记，后继据此跳过
+        for (uint32_t k = plan.successorOffsets[index]; k < plan.successorOffsets[index + 1]; ++k) {
+            uint32_t successor = plan.successors[k];
+            frame->sideBranchSkips[successor / 64].fetch_or(uint64_t{1} << (successor % 64),
+                                                            std::memory_order_release);
+        }
+        PIPELINE_LOGD("Skipped busy side-branch entity %llu for frame %llu",
+                      entityId, frame->frameId);
+    } else if (bypassed) {
+        // 降级或已禁用：跳过执行，输入按端口顺序直通到输出
+        for (size_t k = 0; k < slots && k < inputs.size(); ++k) {
+            frame->outputs[base + k] = inputs[k];
+        }
+        PIPELINE_LOGD("Bypassed entity %llu for frame %llu", entityId, frame->frameId);
+    } else if (fusedMember) {
+        // 已由链首在同一次绘制中完成，链首的结果直通到全部输出
+        FramePacketPtr result = firstConnectedInput(inputs);
+        for (size_t k = 0; k < slots; ++k) {
+            frame->outputs[base + k] = result;
+        }
+    } else {
+        FrameArenaScope arenaScope(frame->arena.get());
+        prepareGpuCommands(plan, index);
+        if (!frame->outputDemand.empty()) {
+            entity.setOutputDemand(frame->outputDemand[index]);
+        }
+        applyNegotiatedFormats(plan, index);
+        int64_t execStartNs = PipelineTrace::now();
+        if (fusion) {
+            fusion->members[0]->setActiveFusion(fusion);
+        }
+        // 融合链首需要在本次调用内完成整条链，不挂起
+        success = fusion ? entity.execute(*mContext, inputs) : entity.executeAsync(*mContext, inputs);
+        if (fusion) {
+            fusion->members[0]->setActiveFusion(nullptr);
         }
+        int64_t execNs = PipelineTrace::now() - execStartNs;
+        auto elapsed = static_cast<uint64_t>(execNs / 1000);
+        recordEntityProfile(*frame, index, execStartNs, elapsed);
         
+        if (PipelineTrace::isEnabled()) {
+            ExecutionQueue queue = plan.queueTypes[index];
+            PipelineTrace::setThreadNameIfUnset(
+                queue == ExecutionQueue::GPU ? mConfig.gpuQueueLabel.c_str() :
+                queue == ExecutionQueue::IO ? mConfig.ioQueueLabel.c_str() :
+                mConfig.cpuQueueLabel.c_str());
+            PipelineTrace::complete("execute", kQueueTraceCategories[static_cast<size_t>(queue)],
+                                    execStartNs, execNs, entityId, frame->frameId);
+        }
+        if (success && frame->latency) {
+            // 同一Entity按帧序串行执行，EMA 只有一个写者
+            auto& stageTime = frame->latency->stageTimeUs[index];
+            uint64_t previous = stageTime.load(std::memory_order_relaxed);
+            stageTime.store(previous == 0 ? elapsed : (previous * 7 + elapsed) / 8,
+                            std::memory_order_relaxed);
+        }
+    }
+    inputs.clear();
+    
+    if (success && !sideSkipped && !bypassed && !fusedMember && entity.hasPendingAwait()) {
+        // 等待GPU栅栏/读回/子任务期间让出队列线程，续体完成后再收尾（剖析与阶段耗时只计首段）
+        suspendEntityTask(index, frame, entity.takePendingAwait());
+    } else {
+        completeEntityTask(index, frame, success, !bypassed && !fusedMember, sideSkipped, ready);
+    }
+    
+    tReadyCache = std::move(ready);
+    tInputCache = std::move(inputs);
+}
+
+void PipelineExecutor::completeEntityTask(uint32_t index, const FrameStatePtr& frame, bool success,
+                                          bool executed, bool sideSkipped, ReadyList& ready) {
+    const CompiledPlan& plan = *frame->plan;
+    EntityId entityId = plan.entityIds[index];
+    ProcessEntity& entity = *plan.entities[index];
+    uint32_t base = plan.outputOffsets[index];
+    size_t slots = plan.outputOffsets[index + 1] - base;
+    
+    if (sideSkipped) {
+        // 未执行，无输出
+    } else if (success && executed) {
+        // 记录本帧输出（同一Entity按帧序串行执行，此时端口内容属于本帧）
+        const auto& ports = entity.getOutputPorts();
+        for (size_t k = 0; k < slots && k < ports.size(); ++k) {
+            frame->outputs[base + k] = ports[k]->getPacket();
+        }
+        entity.releasePortPackets();
+    } else if (success) {
+        // 已直通（降级或融合），输出已写入
+    } else if (entity.getType() == EntityType::Composite) {
+        // 如果是MergeEntity且返回false
+        // 说明正在等待其他路,不算错误,本帧不再向下游传播
+        PIPELINE_LOGD("MergeEntity %llu waiting for other paths", entityId);
+    } else {
         PIPELINE_LOGE("Entity %llu execution failed", entityId);
         onEntityError(entityId, "Entity execution failed");
+    }
+    
+    if (success && !sideSkipped) {
+        for (uint32_t k = plan.deferredOffsets[index]; k < plan.deferredOffsets[index + 1]; ++k) {
+            const auto& target = plan.deferredInputs[k];
+            if (frame->outputs[target.slot]) {
+                plan.entities[target.consumer]->onDeferredInput(target.port, frame->outputs[target.slot]);
+            }
+        }
+    }
+    if (plan.sideBranch[index] && !sideSkipped) {
+        // 端口内容已取走，下一帧可以进入
+        plan.sideBranchBusy[index].store(0, std::memory_order_release);
+    }
+    
+    // InputEntity产出数据后：按延迟预算决定本帧去留，并开启下一帧
+    if (success && index == frame->inputIndex) {
+        frame->inputReadyTime = std::chrono::steady_clock::now();
+        // 源帧为全分辨率像素，下游GPU Entity据本帧比例决定渲染尺寸
+        for (size_t k = 0; k < slots; ++k) {
+            if (const auto& packet = frame->outputs[base + k]) {
+                packet->setRenderScale(frame->renderScale);
+            }
+        }
+        if (mConfig.latencyBudgetMs > 0 && !applyLatencyBudget(frame)) {
+            frame->aborted.store(true, std::memory_order_release);
+        }
+        
+        std::lock_guard<std::mutex> lock(mFrameStateMutex);
+        tryBeginFrameLocked(ready);
+    }
+    
+    finishFrameEntity(frame, index, success, ready);
+    dispatchReady(ready);
+}
+
+void PipelineExecutor::suspendEntityTask(uint32_t index, const FrameStatePtr& frame,
+                                         EntityAwaitPtr await) {
+    // std::function 需要可拷贝，等待对象改由共享指针持有
+    std::shared_ptr<EntityAwait> pending(std::move(await));
+    auto weakSelf = std::weak_ptr<PipelineExecutor>(shared_from_this());
+    
+    auto resume = [weakSelf, index, frame, pending]() {
+        auto self = weakSelf.lock();
+        if (!self || !self->mRunning.load()) {
+            return;
+        }
+        self->postToExecutionQueue(pending->resumeQueue, [weakSelf, index, frame, pending]() {
+            auto self = weakSelf.lock();
+            if (!self || !self->mRunning.load()) {
+                return;
+            }
+            self->resumeEntityTask(index, frame, *pending);
+        });
+    };
+    
+    PIPELINE_LOGD("Suspended entity %llu for frame %llu (await kind %d)",
+                  frame->plan->entityIds[index], frame->frameId, static_cast<int>(pending->kind));
+    
+    switch (pending->kind) {
+        case EntityAwait::Kind::Fence:
+            if (!pending->fence || pending->fence->isSignaled()) {
+                resume();
+            } else {
+                enqueueFenceWait(pending->fence, std::move(resume));
+            }
+            break;
+        case EntityAwait::Kind::Readback:
+            if (!pending->readback) {
+                resume();
+            } else {
+                // 读回完成时回调会被取走，不会与请求互相持有
+                pending->readback->whenReady(std::move(resume));
+            }
+            break;
+        case EntityAwait::Kind::Task:
+            postToExecutionQueue(ExecutionQueue::CPUParallel, [pending, resume]() {
+                if (pending->task) {
+                    pending->task();
+                    pending->task = nullptr;
+                }
+                resume();
+            });
+            break;
+    }
+}
+
+void PipelineExecutor::resumeEntityTask(uint32_t index, const FrameStatePtr& frame, EntityAwait& await) {
+    const CompiledPlan& plan = *frame->plan;
+    ProcessEntity& entity = *plan.entities[index];
+    
+    bool success = false;
+    {
+        FrameArenaScope arenaScope(frame->arena.get());
+        if (await.resumeQueue == ExecutionQueue::GPU) {
+            prepareGpuCommands(plan, index);
+        }
+        success = entity.resumeAwait(await, *mContext);
+    }
+    
+    if (success && entity.hasPendingAwait()) {
+        suspendEntityTask(index, frame, entity.takePendingAwait());
         return;
     }
     
-    // 记录完成状态
+    ReadyList ready;
+    completeEntityTask(index, frame, success, true, false, ready);
+}
+
+void PipelineExecutor::postToExecutionQueue(ExecutionQueue queue, std::function<void()> task) {
+    switch (queue) {
+        case ExecutionQueue::GPU:
+            postToGPUQueue(std::move(task));
+            return;
+        case ExecutionQueue::IO:
+            postToIOQueue(std::move(task));
+            return;
+        case ExecutionQueue::CPUParallel:
+            if (mCPUPool && mCPUPool->submit(task)) {
+                return;
+            }
+            if (mCPUQueue) {
+                mCPUQueue->async(std::move(task));
+                return;
+            }
+            task();
+            return;
+    }
+}
+
+// =============================================================================
+// 栅栏等待
+// =============================================================================
+
+void PipelineExecutor::enqueueFenceWait(GpuFencePtr fence, std::function<void()> onSignaled) {
+    std::lock_guard<std::mutex> lock(mFenceWaitMutex);
+    if (mFenceWaitStopping) {
+        return;
+    }
+    mFenceWaits.emplace_back(std::move(fence), std::move(onSignaled));
+    if (!mFenceWaitThread.joinable()) {
+        mFenceWaitThread = std::thread([this]() { fenceWaitLoop(); });
+    }
+    mFenceWaitCondition.notify_one();
+}
+
+void PipelineExecutor::fenceWaitLoop() {
+    // 都未signal时在最早登记的栅栏上等一个时间片，再重新扫描（后登记的可能先完成）
+    constexpr int64_t kWaitSliceMs = 1;
+    std::vector<std::function<void()>> signaled;
+    std::unique_lock<std::mutex> lock(mFenceWaitMutex);
+    while (true) {
+        mFenceWaitCondition.wait(lock, [this]() { return mFenceWaitStopping || !mFenceWaits.empty(); });
+        if (mFenceWaitStopping) {
+            break;
+        }
+        
+        for (auto it = mFenceWaits.begin(); it != mFenceWaits.end();) {
+            if (it->first->isSignaled()) {
+                signaled.push_back(std::move(it->second));
+                it = mFenceWaits.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        
+        if (signaled.empty()) {
+            GpuFencePtr oldest = mFenceWaits.front().first;
+            lock.unlock();
+            oldest->wait(kWaitSliceMs);
+            lock.lock();
+            continue;
+        }
+        
+        lock.unlock();
+        for (auto& callback : signaled) {
+            callback();
+        }
+        signaled.clear();
+        lock.lock();
+    }
+    mFenceWaits.clear();
+}
+
+void PipelineExecutor::stopFenceWaiter() {
     {
-        std::lock_guard<std::mutex> lock(mFrameStateMutex);
-        if (mCurrentFrameState) {
-            std::lock_guard<std::mutex> stateLock(mCurrentFrameState->mutex);
-            mCurrentFrameState->completedEntities.insert(entityId);
-            PIPELINE_LOGD("Entity %llu completed, total completed: %zu", 
-                         entityId, mCurrentFrameState->completedEntities.size());
+        std::lock_guard<std::mutex> lock(mFenceWaitMutex);
+        if (!mFenceWaitThread.joinable()) {
+            return;
         }
+        mFenceWaitStopping = true;
     }
+    mFenceWaitCondition.notify_all();
+    mFenceWaitThread.join();
     
-    // 投递下游任务
-    submitDownstreamTasks(entityId);
+    std::lock_guard<std::mutex> lock(mFenceWaitMutex);
+    mFenceWaitThread = std::thread();
+    mFenceWaitStopping = false;
+}
+
+std::shared_ptr<const CompiledPlan> PipelineExecutor::compilePlan(const PipelineGraph& graph) const {
+    auto plan = std::make_shared<CompiledPlan>();
+    // 先取版本再取拓扑：编译期间若图被修改，版本不匹配会触发下一次重新编译
+    plan->graphVersion = graph.getVersion();
+    auto order = graph.getTopologicalOrder();
+    if (order.empty() && graph.getEntityCount() > 0) {
+        PIPELINE_LOGW("Graph has a cycle, execution plan is empty");
+    }
     
-    // 检查是否Pipeline完成
-    if (isPipelineCompleted(entityId)) {
-        PIPELINE_LOGI("Pipeline completed for frame");
-        onFrameComplete(nullptr);  // TODO: 构造FramePacket传递给回调
-        restartPipelineLoop();
+    // 禁用的单入单出Entity整体剔除：不占执行层级、不分配输出，消费者直接接到其上游。
+    // 记录其唯一的入边，绑定输入和计算依赖时沿入边向上追溯
+    std::unordered_map<EntityId, Connection> spliced;
+    for (EntityId id : order) {
+        auto entity = graph.getEntity(id);
+        if (!entity || entity->isEnabled() || id == mInputEntityId ||
+            entity->getInputPortCount() != 1 || entity->getOutputPortCount() != 1 ||
+            entity->isInputDeferred(0)) {
+            continue;
+        }
+        auto incoming = graph.getIncomingConnections(id);
+        if (incoming.size() == 1) {
+            spliced.emplace(id, incoming.front());
+        }
+    }
+    auto resolveSource = [&spliced](Connection connection) {
+        for (auto it = spliced.find(connection.srcEntity); it != spliced.end();
+             it = spliced.find(connection.srcEntity)) {
+            connection.srcEntity = it->second.srcEntity;
+            connection.srcPort = it->second.srcPort;
+        }
+        return connection;
+    };
+    
+    // Entity指针；编译期间被移除的Entity（指针为空）从计划中剔除
+    plan->entityIds.reserve(order.size());
+    plan->entities.reserve(order.size());
+    for (EntityId id : order) {
+        if (spliced.count(id)) {
+            plan->splicedEntities.push_back(id);
+            continue;
+        }
+        auto entity = graph.getEntity(id);
+        if (entity) {
+            plan->indexOf[id] = static_cast<uint32_t>(plan->entityIds.size());
+            plan->entityIds.push_back(id);
+            plan->entities.push_back(std::move(entity));
+        }
+    }
+    
+    const size_t n = plan->entities.size();
+    plan->queues.reserve(n);
+    for (const auto& entity : plan->entities) {
+        plan->queues.push_back(getQueueForEntity(*entity).get());
+        plan->queueTypes.push_back(entity->getExecutionQueue());
+        const bool onGPU = entity->getExecutionQueue() == ExecutionQueue::GPU;
+        plan->directGpuAccess.push_back(onGPU && !dynamic_cast<GPUEntity*>(entity.get()) ? 1 : 0);
+        plan->gpuEntityCount += onGPU ? 1 : 0;
+    }
+    
+    // 输出槽位
+    plan->outputOffsets.resize(n + 1);
+    plan->outputOffsets[0] = 0;
+    for (size_t i = 0; i < n; ++i) {
+        plan->outputOffsets[i + 1] = plan->outputOffsets[i] +
+            static_cast<uint32_t>(plan->entities[i]->getOutputPortCount());
+    }
+    
+    // 输入端口绑定（来源Entity索引 + 来源输出端口 -> 输出槽位）
+    // 延迟输入同时记录来源：只经延迟输入相连的上游不构成依赖。
+    // 连接取自图的边表而不是端口：图可能是编辑中途的快照，端口状态随实时图变化
+    plan->inputOffsets.resize(n + 1);
+    plan->inputOffsets[0] = 0;
+    std::vector<std::vector<CompiledPlan::DeferredInput>> deferredLists(n);
+    std::vector<std::vector<uint32_t>> deferredSources(n);
+    std::vector<std::vector<uint32_t>> directSources(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& ports = plan->entities[i]->getInputPorts();
+        const auto incoming = graph.getIncomingConnections(plan->entityIds[i]);
+        for (size_t p = 0; p < ports.size(); ++p) {
+            const auto& port = ports[p];
+            uint32_t slot = CompiledPlan::kInvalidSlot;
+            uint32_t src = CompiledPlan::kInvalidSlot;
+            Connection connection;
+            for (const auto& candidate : incoming) {
+                if (candidate.dstPort == port->getName()) {
+                    connection = resolveSource(candidate);
+                    src = plan->findIndex(connection.srcEntity);
+                    break;
+                }
+            }
+            if (src != CompiledPlan::kInvalidSlot) {
+                const auto& sourcePorts = plan->entities[src]->getOutputPorts();
+                for (size_t k = 0; k < sourcePorts.size(); ++k) {
+                    if (sourcePorts[k]->getName() == connection.srcPort) {
+                        slot = plan->outputOffsets[src] + static_cast<uint32_t>(k);
+                        break;
+                    }
+                }
+            }
+            bool deferred = plan->entities[i]->isInputDeferred(p);
+            if (src != CompiledPlan::kInvalidSlot) {
+                (deferred ? deferredSources[i] : directSources[i]).push_back(src);
+            }
+            if (deferred && slot != CompiledPlan::kInvalidSlot) {
+                deferredLists[src].push_back({slot, static_cast<uint32_t>(i), static_cast<uint32_t>(p)});
+            }
+            plan->inputSlots.push_back(slot);
+            plan->inputDeferred.push_back(deferred ? 1 : 0);
+        }
+        plan->inputOffsets[i + 1] = static_cast<uint32_t>(plan->inputSlots.size());
+    }
+    
+    plan->deferredOffsets.resize(n + 1);
+    plan->deferredOffsets[0] = 0;
+    for (size_t i = 0; i < n; ++i) {
+        plan->deferredOffsets[i + 1] = plan->deferredOffsets[i] +
+            static_cast<uint32_t>(deferredLists[i].size());
+        plan->deferredInputs.insert(plan->deferredInputs.end(),
+                                    deferredLists[i].begin(), deferredLists[i].end());
+    }
+    
+    // 上游计数与后继列表来自同一组边，保证递减次数与计数一致
+    std::vector<std::vector<uint32_t>> successorLists(n);
+    plan->upstreamCounts.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& direct = directSources[i];
+        const auto& deferred = deferredSources[i];
+        std::vector<uint32_t> seen;
+        for (EntityId upstreamId : graph.getUpstreamEntities(plan->entityIds[i])) {
+            for (auto it = spliced.find(upstreamId); it != spliced.end(); it = spliced.find(upstreamId)) {
+                upstreamId = it->second.srcEntity;
+            }
+            uint32_t up = plan->findIndex(upstreamId);
+            if (up == CompiledPlan::kInvalidSlot ||
+                std::find(seen.begin(), seen.end(), up) != seen.end()) {
+                continue;
+            }
+            seen.push_back(up);
+            if (std::find(deferred.begin(), deferred.end(), up) != deferred.end() &&
+                std::find(direct.begin(), direct.end(), up) == direct.end()) {
+                continue;
+            }
+            plan->upstreamCounts[i]++;
+            successorLists[up].push_back(static_cast<uint32_t>(i));
+        }
     }
+    
+    // 旁路分支（逆拓扑序）：有上游、至少一条延迟输出，且直接后继都属于旁路分支
+    plan->sideBranch.assign(n, 0);
+    plan->sideBranchBusy = std::make_unique<std::atomic<uint8_t>[]>(n);
+    for (size_t i = n; i-- > 0;) {
+        plan->sideBranchBusy[i].store(0, std::memory_order_relaxed);
+        bool reachesDeferred = plan->deferredOffsets[i + 1] != plan->deferredOffsets[i];
+        bool allSide = true;
+        for (uint32_t successor : successorLists[i]) {
+            reachesDeferred = reachesDeferred || plan->sideBranch[successor];
+            allSide = allSide && plan->sideBranch[successor];
+        }
+        if (plan->upstreamCounts[i] > 0 && reachesDeferred && allSide &&
+            plan->entityIds[i] != mInputEntityId) {
+            plan->sideBranch[i] = 1;
+        }
+    }
+    
+    plan->successorOffsets.resize(n + 1);
+    plan->successorOffsets[0] = 0;
+    for (size_t i = 0; i < n; ++i) {
+        plan->successorOffsets[i + 1] = plan->successorOffsets[i] +
+            static_cast<uint32_t>(successorLists[i].size());
+        plan->successors.insert(plan->successors.end(),
+                                successorLists[i].begin(), successorLists[i].end());
+    }
+    
+    // 调度通道：逆拓扑序解析继承，取下游分支中优先级最高的通道
+    plan->lanes.assign(n, ExecutionLane::Normal);
+    for (size_t i = n; i-- > 0;) {
+        ExecutionLane lane = plan->entities[i]->getExecutionLane();
+        if (lane == ExecutionLane::Inherit) {
+            lane = successorLists[i].empty() && !plan->sideBranch[i]
+                ? ExecutionLane::Normal : ExecutionLane::Throughput;
+            for (uint32_t successor : successorLists[i]) {
+                lane = std::min(lane, plan->lanes[successor]);
+            }
+        }
+        plan->lanes[i] = lane;
+    }
+    
+    // 执行层级（供同步 processFrame 使用）
+    plan->levelOffsets.push_back(0);
+    for (const auto& level : graph.getExecutionLevels()) {
+        for (EntityId id : level) {
+            uint32_t index = plan->findIndex(id);
+            if (index != CompiledPlan::kInvalidSlot) {
+                plan->levelEntities.push_back(index);
+            }
+        }
+        if (plan->levelEntities.size() > plan->levelOffsets.back()) {
+            plan->levelOffsets.push_back(static_cast<uint32_t>(plan->levelEntities.size()));
+        }
+    }
+    
+    // 输出槽位生命周期：[产出层级, 最后消费层级]
+    const size_t slotCount = plan->outputSlotCount();
+    std::vector<uint32_t> entityLevel(n, 0);
+    for (uint32_t level = 0; level < plan->levelCount(); ++level) {
+        for (uint32_t k = plan->levelOffsets[level]; k < plan->levelOffsets[level + 1]; ++k) {
+            entityLevel[plan->levelEntities[k]] = level;
+        }
+    }
+    std::vector<uint32_t> slotFirstLevel(slotCount, 0);
+    plan->slotLastLevel.assign(slotCount, 0);
+    plan->slotConsumerCounts.assign(slotCount, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (uint32_t k = plan->outputOffsets[i]; k < plan->outputOffsets[i + 1]; ++k) {
+            slotFirstLevel[k] = entityLevel[i];
+            plan->slotLastLevel[k] = entityLevel[i];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        for (uint32_t k = plan->inputOffsets[i]; k < plan->inputOffsets[i + 1]; ++k) {
+            uint32_t slot = plan->inputSlots[k];
+            if (slot != CompiledPlan::kInvalidSlot) {
+                plan->slotConsumerCounts[slot]++;
+                plan->slotLastLevel[slot] = std::max(plan->slotLastLevel[slot], entityLevel[i]);
+            }
+        }
+    }
+    
+    // 槽位 -> 消费者（按槽位聚合的反向输入表）
+    plan->slotConsumerOffsets.assign(slotCount + 1, 0);
+    for (uint32_t slot : plan->inputSlots) {
+        if (slot != CompiledPlan::kInvalidSlot) {
+            plan->slotConsumerOffsets[slot + 1]++;
+        }
+    }
+    for (size_t slot = 0; slot < slotCount; ++slot) {
+        plan->slotConsumerOffsets[slot + 1] += plan->slotConsumerOffsets[slot];
+    }
+    plan->slotConsumers.resize(plan->slotConsumerOffsets[slotCount]);
+    std::vector<uint32_t> consumerFill(plan->slotConsumerOffsets.begin(), plan->slotConsumerOffsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        for (uint32_t k = plan->inputOffsets[i]; k < plan->inputOffsets[i + 1]; ++k) {
+            uint32_t slot = plan->inputSlots[k];
+            if (slot != CompiledPlan::kInvalidSlot) {
+                plan->slotConsumers[consumerFill[slot]++] = {
+                    static_cast<uint32_t>(i), k - plan->inputOffsets[i]};
+            }
+        }
+    }
+    
+    for (uint32_t level = 0; level < plan->levelCount(); ++level) {
+        uint32_t live = 0;
+        for (size_t slot = 0; slot < slotCount; ++slot) {
+            if (slotFirstLevel[slot] <= level && level <= plan->slotLastLevel[slot]) {
+                ++live;
+            }
+        }
+        plan->peakLiveSlots = std::max(plan->peakLiveSlots, live);
+    }
+    
+    if (mConfig.enableFormatNegotiation) {
+        negotiateFormats(*plan);
+    }
+    
+    compileShaderFusion(*plan, successorLists);
+    PIPELINE_LOGD("Compiled plan: %zu entities (%zu spliced), %zu output slots, peak %u live",
+                  n, plan->splicedEntities.size(), slotCount, plan->peakLiveSlots);
+    
+    return plan;
 }
 
-void PipelineExecutor::submitDownstreamTasks(EntityId entityId) {
-    auto downstreams = mGraph->getDownstreamEntities(entityId);
+void PipelineExecutor::negotiateFormats(CompiledPlan& plan) {
+    const size_t n = plan.size();
+    plan.negotiatedFormats.assign(n, 0);
     
-    PIPELINE_LOGD("Entity %llu has %zu downstream entities", entityId, downstreams.size());
+    // strict：含运行期被禁用而直通时的下游；direct：只看直接消费者
+    std::vector<PixelFormatSet> strictAccepted(plan.outputSlotCount(), kAnyPixelFormat);
+    for (size_t i = n; i-- > 0;) {
+        const auto& entity = plan.entities[i];
+        const uint32_t base = plan.outputOffsets[i];
+        uint64_t packed = 0;
+        for (uint32_t slot = base; slot < plan.outputOffsets[i + 1]; ++slot) {
+            PixelFormatSet strict = kAnyPixelFormat;
+            PixelFormatSet direct = kAnyPixelFormat;
+            const bool consumed = plan.slotConsumerOffsets[slot] != plan.slotConsumerOffsets[slot + 1];
+            for (uint32_t c = plan.slotConsumerOffsets[slot]; c < plan.slotConsumerOffsets[slot + 1]; ++c) {
+                const auto& consumer = plan.slotConsumers[c];
+                PixelFormatSet accepted = plan.entities[consumer.entity]->getAcceptedInputFormats(consumer.port);
+                direct &= accepted;
+                // 消费者被禁用时输入端口 k 直通到输出端口 k，那一侧的消费者也读到这个格式
+                uint32_t forwarded = plan.outputOffsets[consumer.entity] + consumer.port;
+                if (forwarded < plan.outputOffsets[consumer.entity + 1]) {
+                    accepted &= strictAccepted[forwarded];
+                }
+                strict &= accepted;
+            }
+            strictAccepted[slot] = strict;
+            
+            const size_t port = slot - base;
+            if (!consumed || port >= 8) {
+                continue;
+            }
+            const auto candidates = entity->getOutputFormatCandidates(port);
+            if (candidates.empty()) {
+                continue;
+            }
+            PixelFormat chosen = PixelFormat::Unknown;
+            for (PixelFormatSet required : {strict, direct}) {
+                for (PixelFormat format : candidates) {
+                    if (containsPixelFormat(required, format)) {
+                        chosen = format;
+                        break;
+                    }
+                }
+                if (chosen != PixelFormat::Unknown) {
+                    break;
+                }
+            }
+            if (chosen == PixelFormat::Unknown) {
+                PIPELINE_LOGW("No format accepted by all consumers of %s port %zu, using its default",
+                              entity->getName().c_str(), port);
+                continue;
+            }
+            packed |= static_cast<uint64_t>(chosen) << (port * 8);
+            PIPELINE_LOGD("Negotiated format %d for %s port %zu",
+                          static_cast<int>(chosen), entity->getName().c_str(), port);
+        }
+        plan.negotiatedFormats[i] = packed;
+    }
+}
+
+void PipelineExecutor::compileShaderFusion(
+    CompiledPlan& plan, const std::vector<std::vector<uint32_t>>& successorLists) const {
+    static std::atomic<uint64_t> sNextChainId{1};
+    
+    const size_t n = plan.size();
+    plan.fusion.assign(n, nullptr);
+    if (!mConfig.enableShaderFusion) {
+        return;
+    }
+    
+    // 候选：GPU队列上提供逐像素片段、不参与降级或旁路调度的GPUEntity
+    std::vector<GPUEntity*> candidates(n, nullptr);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& entity = plan.entities[i];
+        if (entity->getType() != EntityType::GPU || plan.queueTypes[i] != ExecutionQueue::GPU ||
+            entity->isOptional() || plan.sideBranch[i] || plan.entityIds[i] == mInputEntityId) {
+            continue;
+        }
+        auto* gpu = dynamic_cast<GPUEntity*>(entity.get());
+        if (gpu && gpu->isFusionCandidate()) {
+            candidates[i] = gpu;
+        }
+    }
     
-    for (EntityId downstreamId : downstreams) {
-        auto downstream = mGraph->getEntity(downstreamId);
-        if (!downstream) {
+    std::vector<std::shared_ptr<ShaderFusionChain>> chains(n);
+    size_t fusedCount = 0;
+    for (size_t i = 0; i < n; ++i) {
+        // 成员不能改变尺寸：融合后按链首的输出尺寸绘制
+        GPUEntity* member = candidates[i];
+        if (!member || plan.upstreamCounts[i] != 1 ||
+            member->getOutputWidth() != 0 || member->getOutputHeight() != 0) {
             continue;
         }
         
-        // 如果下游是MergeEntity
-        if (downstream->getType() == EntityType::Composite) {
-            // 检查是否所有上游都已完成
-            if (!areAllDependenciesReady(downstreamId)) {
-                PIPELINE_LOGD("MergeEntity %llu dependencies not ready, skipping", downstreamId);
-                continue;  // 上游未全部完成,不投递
+        // 唯一的直接输入
+        uint32_t source = CompiledPlan::kInvalidSlot;
+        size_t connected = 0;
+        for (uint32_t k = plan.inputOffsets[i]; k < plan.inputOffsets[i + 1]; ++k) {
+            if (plan.inputSlots[k] != CompiledPlan::kInvalidSlot) {
+                source = plan.inputDeferred[k] ? CompiledPlan::kInvalidSlot : plan.inputSlots[k];
+                ++connected;
             }
         }
+        if (connected != 1 || source == CompiledPlan::kInvalidSlot) {
+            continue;
+        }
         
-        // 检查依赖
-        if (areAllDependenciesReady(downstreamId)) {
-            PIPELINE_LOGD("Submitting downstream task for entity %llu", downstreamId);
-            submitEntityTask(downstreamId);
-        } else {
-            PIPELINE_LOGD("Entity %llu dependencies not ready", downstreamId);
+        // 上游的输出只流向本Entity，中间结果才可以省去
+        auto producer = static_cast<uint32_t>(
+            std::upper_bound(plan.outputOffsets.begin(), plan.outputOffsets.end(), source) -
+            plan.outputOffsets.begin() - 1);
+        if (!candidates[producer] || successorLists[producer].size() != 1 ||
+            plan.deferredOffsets[producer + 1] != plan.deferredOffsets[producer]) {
+            continue;
+        }
+        int32_t consumers = 0;
+        for (uint32_t k = plan.outputOffsets[producer]; k < plan.outputOffsets[producer + 1]; ++k) {
+            consumers += plan.slotConsumerCounts[k];
+        }
+        if (consumers != 1) {
+            continue;
+        }
+        
+        auto chain = chains[producer];
+        if (!chain) {
+            chain = std::make_shared<ShaderFusionChain>();
+            chain->id = sNextChainId.fetch_add(1, std::memory_order_relaxed);
+            chain->headIndex = producer;
+            chain->members.push_back(candidates[producer]);
+            chains[producer] = chain;
         }
+        chain->members.push_back(member);
+        chains[i] = chain;
+        ++fusedCount;
+    }
+    
+    for (size_t i = 0; i < n; ++i) {
+        plan.fusion[i] = chains[i];
+    }
+    if (fusedCount > 0) {
+        PIPELINE_LOGI("Shader fusion: %zu GPU passes folded into their chain heads", fusedCount);
     }
 }
 
-bool PipelineExecutor::areAllDependenciesReady(EntityId entityId) {
-    auto upstreams = mGraph->getUpstreamEntities(entityId);
+bool PipelineExecutor::tryBeginFrameLocked(ReadyList& ready) {
+    if (!mRunning.load() || mInputEntityId == InvalidEntityId) {
+        return false;
+    }
     
-    std::lock_guard<std::mutex> lock(mFrameStateMutex);
-    if (!mCurrentFrameState) {
+    uint32_t maxFrames = std::max<uint32_t>(1, mConfig.maxConcurrentFrames);
+    if (mInFlightFrames.size() >= maxFrames) {
         return false;
     }
     
-    std::lock_guard<std::mutex> stateLock(mCurrentFrameState->mutex);
-    for (EntityId upstreamId : upstreams) {
-        if (mCurrentFrameState->completedEntities.find(upstreamId) == 
-            mCurrentFrameState->completedEntities.end()) {
-            return false;  // 有上游未完成
+    // 图变化：旧计划的在途帧全部结束后再切换
+    auto plan = std::atomic_load(&mCompiledPlan);
+    const uint64_t graphVersion = mGraph->getVersion();
+    if (!plan || plan->graphVersion != graphVersion) {
+        auto prepared = std::atomic_load(&mPreparedPlan);
+        if (prepared && prepared->graphVersion == graphVersion) {
+            // 已编译并预热，切换只需等旧计划的在途帧结束
+            if (!mInFlightFrames.empty()) {
+                return false;
+            }
+            std::atomic_store(&mCompiledPlan, prepared);
+            std::atomic_store(&mPreparedPlan, std::shared_ptr<const CompiledPlan>());
+            plan = std::move(prepared);
+            PIPELINE_LOGI("Swapped to execution plan for graph version %llu", graphVersion);
+        } else if (plan && mConfig.enableAsyncPlanSwap) {
+            // 准备期间旧计划照常出帧：执行只按计划内的槽位取数据，实时图的编辑不影响它
+            schedulePlanPreparation();
+        } else {
+            if (!mInFlightFrames.empty()) {
+                return false;
+            }
+            plan = compilePlan(*mGraph);
+            std::atomic_store(&mCompiledPlan, plan);
+        }
+    }
+    
+    uint32_t inputIndex = plan->findIndex(mInputEntityId);
+    if (inputIndex == CompiledPlan::kInvalidSlot) {
+        PIPELINE_LOGW("InputEntity %llu not in execution plan", mInputEntityId);
+        return false;
+    }
+    
+    const size_t count = plan->size();
+    auto frame = std::make_shared<FrameExecutionState>();
+    frame->plan = plan;
+    frame->inputIndex = inputIndex;
+    frame->pendingCounts = std::make_unique<std::atomic<int32_t>[]>(count);
+    frame->handoffFlags = std::make_unique<std::atomic<uint8_t>[]>(count);
+    frame->sideBranchSkips = std::make_unique<std::atomic<uint64_t>[]>((count + 63) / 64);
+    for (size_t word = 0; word < (count + 63) / 64; ++word) {
+        frame->sideBranchSkips[word].store(0, std::memory_order_relaxed);
+    }
+    frame->remainingEntities.store(static_cast<uint32_t>(count));
+    frame->remainingGPUEntities.store(plan->gpuEntityCount);
+    frame->outputs.resize(plan->outputSlotCount());
+    frame->slotRefs = std::make_unique<std::atomic<int32_t>[]>(plan->outputSlotCount());
+    for (size_t slot = 0; slot < plan->outputSlotCount(); ++slot) {
+        // 产出者自身持有一个引用，结束时释放（InputEntity的输出保留到帧结束，供丢帧回调使用）
+        frame->slotRefs[slot].store(plan->slotConsumerCounts[slot] + 1, std::memory_order_relaxed);
+    }
+    if (mFrameArenaPool) {
+        frame->arena = mFrameArenaPool->acquire();
+    }
+    frame->frameId = mNextFrameSeq++;
+    frame->startTime = std::chrono::steady_clock::now();
+    frame->renderScale = selectRenderScale(*plan);
+    if (mConfig.enableLazyOutputs) {
+        // 帧序内询问：各消费者的帧间节奏（如隔帧检测）与实际执行顺序一致
+        computeOutputDemand(*plan, *frame);
+    }
+    
+    if (!mLatencyModel || mLatencyModel->graphVersion != plan->graphVersion) {
+        mLatencyModel = std::make_shared<LatencyModel>(*plan);
+        bindEntityProfiles(*plan, *mLatencyModel);
+    }
+    frame->latency = mLatencyModel;
+    if (mConfig.enableCriticalPathPriority) {
+        // 每帧开始时按最新耗时EMA刷新一次，本帧内的就绪任务据此排序
+        updateCriticalRanks(*plan, *mLatencyModel);
+    }
+    if (mProfilingEnabled.load(std::memory_order_relaxed)) {
+        frame->readyTimes = std::make_unique<int64_t[]>(count);
+    }
+    
+    FrameStatePtr prev = mInFlightFrames.empty() ? nullptr : mInFlightFrames.back();
+    const int32_t orderDependency = prev ? 1 : 0;
+    for (size_t i = 0; i < count; ++i) {
+        // 旁路分支不与前一帧交接，由 sideBranchBusy 保证同一Entity串行
+        frame->pendingCounts[i].store(
+            plan->upstreamCounts[i] + (plan->sideBranch[i] ? 0 : orderDependency),
+            std::memory_order_relaxed);
+        frame->handoffFlags[i].store(0, std::memory_order_relaxed);
+    }
+    
+    mInFlightFrames.push_back(frame);
+    mPendingFrames.fetch_add(1);
+    
+    if (prev) {
+        // 先发布下一帧指针，再与前一帧逐个交接
+        prev->nextFrame = frame;
+        for (size_t i = 0; i < count; ++i) {
+            if (plan->sideBranch[i]) {
+                continue;
+            }
+            if (prev->handoffFlags[i].exchange(1, std::memory_order_acq_rel) == 1) {
+                releaseDependency(frame, static_cast<uint32_t>(i), ready);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            if (plan->upstreamCounts[i] == 0) {
+                ready.emplace_back(frame, static_cast<uint32_t>(i));
+            }
         }
     }
     return true;
 }
 
-bool PipelineExecutor::isPipelineCompleted(EntityId entityId) {
-    // 检查是否是sink entity（没有下游）
-    auto downstreams = mGraph->getDownstreamEntities(entityId);
-    if (!downstreams.empty()) {
-        return false;  // 还有下游,未完成
+void PipelineExecutor::releaseFrameInputs(uint32_t index, FrameExecutionState& frame) {
+    const CompiledPlan& plan = *frame.plan;
+    auto release = [&frame](uint32_t slot) {
+        if (frame.slotRefs[slot].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            frame.outputs[slot].reset();
+        }
+    };
+    
+    for (uint32_t i = plan.inputOffsets[index]; i < plan.inputOffsets[index + 1]; ++i) {
+        uint32_t slot = plan.inputSlots[i];
+        if (slot != CompiledPlan::kInvalidSlot) {
+            release(slot);
+        }
+    }
+    if (index != frame.inputIndex) {
+        for (uint32_t slot = plan.outputOffsets[index]; slot < plan.outputOffsets[index + 1]; ++slot) {
+            release(slot);
+        }
     }
+}
+
+void PipelineExecutor::gatherFrameInputs(uint32_t index, const FrameExecutionState& frame,
+                                         std::vector<FramePacketPtr>& inputs) {
+    const CompiledPlan& plan = *frame.plan;
+    uint32_t begin = plan.inputOffsets[index];
+    uint32_t end = plan.inputOffsets[index + 1];
     
-    // 检查所有Entity是否都已完成
-    std::lock_guard<std::mutex> lock(mFrameStateMutex);
-    if (!mCurrentFrameState) {
-        return false;
+    inputs.clear();
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t slot = plan.inputSlots[i];
+        // 延迟输入的来源可能仍在执行，不读取其槽位
+        if (slot == CompiledPlan::kInvalidSlot || plan.inputDeferred[i]) {
+            inputs.emplace_back();
+        } else {
+            inputs.push_back(frame.outputs[slot]);
+        }
+    }
+}
+
+PipelineExecutor::LatencyModel::LatencyModel(const CompiledPlan& plan)
+    : graphVersion(plan.graphVersion)
+    , stageTimeUs(std::make_unique<std::atomic<uint64_t>[]>(plan.size()))
+    , criticalRankUs(std::make_unique<std::atomic<uint64_t>[]>(plan.size()))
+{
+    for (size_t i = 0; i < plan.size(); ++i) {
+        stageTimeUs[i].store(0, std::memory_order_relaxed);
+        criticalRankUs[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void PipelineExecutor::bindEntityProfiles(const CompiledPlan& plan, LatencyModel& model) {
+    std::lock_guard<std::mutex> lock(mProfileMutex);
+    model.profiles.assign(plan.size(), nullptr);
+    for (uint32_t i = 0; i < plan.size(); ++i) {
+        auto& profile = mEntityProfiles[plan.entityIds[i]];
+        if (!profile) {
+            profile = std::make_unique<EntityProfile>();
+            profile->entityId = plan.entityIds[i];
+        }
+        profile->name = plan.entities[i]->getName();
+        profile->queue = plan.queueTypes[i];
+        profile->order = i;
+        model.profiles[i] = profile.get();
+        PipelineTrace::setEntityName(plan.entityIds[i], profile->name);
     }
+}
+
+void PipelineExecutor::recordEntityProfile(const FrameExecutionState& frame, uint32_t index,
+                                           int64_t startNs, uint64_t wallUs) {
+    ExecutionQueue queue = frame.plan->queueTypes[index];
+    mQueueTimeUs[static_cast<size_t>(queue)].fetch_add(wallUs, std::memory_order_relaxed);
     
-    auto allEntities = mGraph->getAllEntities();
-    std::lock_guard<std::mutex> stateLock(mCurrentFrameState->mutex);
+    // readyTimes 仅在启用剖析时分配
+    if (!frame.readyTimes || !frame.latency) {
+        return;
+    }
+    EntityProfile* profile = frame.latency->profiles[index];
+    if (!profile) {
+        return;
+    }
     
-    for (auto& entity : allEntities) {
-        EntityId id = entity->getId();
-        if (entity->isEnabled() && 
-            mCurrentFrameState->completedEntities.find(id) == 
-            mCurrentFrameState->completedEntities.end()) {
-            return false;  // 有Entity未完成
-        }
+    int64_t waitNs = startNs - frame.readyTimes[index];
+    profile->wallTime.record(wallUs);
+    profile->queueWait.record(waitNs > 0 ? static_cast<uint64_t>(waitNs / 1000) : 0);
+    if (queue == ExecutionQueue::GPU) {
+        profile->gpuTime.record(wallUs);
     }
+}
+
+uint64_t PipelineExecutor::estimateCriticalPathUs(const CompiledPlan& plan,
+                                                  const LatencyModel& model,
+                                                  uint32_t inputIndex, bool skipOptional) {
+    // 计划按拓扑序排列，一次前向遍历即可得到最长路径
+    thread_local std::vector<uint64_t> tStartTimes;
+    tStartTimes.assign(plan.size(), 0);
     
-    return true;
+    uint64_t longest = 0;
+    for (uint32_t i = 0; i < plan.size(); ++i) {
+        uint64_t cost = 0;
+        if (i != inputIndex && !(skipOptional && plan.entities[i]->isOptional())) {
+            cost = model.stageTimeUs[i].load(std::memory_order_relaxed);
+        }
+        uint64_t finish = tStartTimes[i] + cost;
+        longest = std::max(longest, finish);
+        for (uint32_t k = plan.successorOffsets[i]; k < plan.successorOffsets[i + 1]; ++k) {
+            uint32_t successor = plan.successors[k];
+            tStartTimes[successor] = std::max(tStartTimes[successor], finish);
+        }
+    }
+    return longest;
 }
 
-void PipelineExecutor::restartPipelineLoop() {
-    PIPELINE_LOGI("Restarting pipeline loop");
+bool PipelineExecutor::applyLatencyBudget(const FrameStatePtr& frame) {
+    if (!frame->latency) {
+        return true;
+    }
+    
+    const CompiledPlan& plan = *frame->plan;
+    LatencyModel& model = *frame->latency;
+    const uint64_t budgetUs = static_cast<uint64_t>(mConfig.latencyBudgetMs) * 1000;
+    
+    uint64_t critical = estimateCriticalPathUs(plan, model, frame->inputIndex, false);
+    uint64_t predicted = std::max(critical, model.postInputLatencyUs.load(std::memory_order_relaxed));
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mStats.lastPredictedLatency = predicted;
+    }
+    
+    if (predicted <= budgetUs) {
+        model.consecutiveDrops.store(0, std::memory_order_relaxed);
+        return true;
+    }
     
-    // 更新统计
+    // 降级：跳过可降级Entity节省的关键路径耗时能否补足
+    if (mConfig.enableDegradation) {
+        uint64_t saved = critical - estimateCriticalPathUs(plan, model, frame->inputIndex, true);
+        if (saved > 0 && predicted - std::min(predicted, saved) <= budgetUs) {
+            frame->degradeSavingsUs = saved;
+            frame->degraded.store(true, std::memory_order_relaxed);
+            model.consecutiveDrops.store(0, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            mStats.degradedFrames++;
+            PipelineTrace::instant("degrade", "frame", 0, frame->frameId, predicted);
+            PIPELINE_LOGD("Frame %llu degraded: predicted %llu us, budget %llu us",
+                          frame->frameId, predicted, budgetUs);
+            return true;
+        }
+    }
+    
+    // 连续丢帧达到上限：强制执行（尽量降级），避免画面冻结
+    if (model.consecutiveDrops.load(std::memory_order_relaxed) >= mConfig.maxConsecutiveDeadlineDrops) {
+        model.consecutiveDrops.store(0, std::memory_order_relaxed);
+        if (mConfig.enableDegradation) {
+            frame->degradeSavingsUs =
+                critical - estimateCriticalPathUs(plan, model, frame->inputIndex, true);
+            frame->degraded.store(frame->degradeSavingsUs > 0, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    
+    model.consecutiveDrops.fetch_add(1, std::memory_order_relaxed);
     {
         std::lock_guard<std::mutex> lock(mStatsMutex);
-        mStats.totalFrames++;
+        mStats.deadlineDroppedFrames++;
+    }
+    PipelineTrace::instant("deadlineDrop", "frame", 0, frame->frameId, predicted);
+    PIPELINE_LOGD("Frame %llu dropped: predicted %llu us exceeds budget %llu us",
+                  frame->frameId, predicted, budgetUs);
+    return false;
+}
+
+void PipelineExecutor::releaseDependency(const FrameStatePtr& frame, uint32_t index,
+                                         ReadyList& ready) {
+    if (frame->pendingCounts[index].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ready.emplace_back(frame, index);
+    }
+}
+
+void PipelineExecutor::submitDownstreamTasks(const FrameStatePtr& frame, uint32_t index,
+                                             ReadyList& ready) {
+    const CompiledPlan& plan = *frame->plan;
+    
+    // 与下一帧交接：下一帧已创建则由本方递减其计数
+    if (!plan.sideBranch[index] &&
+        frame->handoffFlags[index].exchange(1, std::memory_order_acq_rel) == 1) {
+        if (frame->nextFrame) {
+            releaseDependency(frame->nextFrame, index, ready);
+        }
+    }
+    
+    for (uint32_t k = plan.successorOffsets[index]; k < plan.successorOffsets[index + 1]; ++k) {
+        releaseDependency(frame, plan.successors[k], ready);
+    }
+}
+
+void PipelineExecutor::finishFrameEntity(const FrameStatePtr& frame, uint32_t index,
+                                         bool success, ReadyList& ready) {
+    if (!success) {
+        frame->aborted.store(true, std::memory_order_release);
+    } else if (index == frame->inputIndex) {
+        frame->inputSucceeded.store(true, std::memory_order_release);
+    }
+    
+    // 跳过/放弃的GPU Entity同样计数，帧命令不会因为丢帧而滞留
+    if (frame->plan->queueTypes[index] == ExecutionQueue::GPU &&
+        frame->remainingGPUEntities.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        commitFrameCommands();
+    }
+    
+    // 先于下游调度释放：下游读取输入时本Entity对上游槽位的引用已不再需要
+    releaseFrameInputs(index, *frame);
+    submitDownstreamTasks(frame, index, ready);
+    
+    if (frame->remainingEntities.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        onFrameFinished(frame, ready);
+    }
+}
+
+void PipelineExecutor::dispatchReady(ReadyList& ready) {
+    if (mConfig.enableCriticalPathPriority && ready.size() > 1) {
+        // 从尾部出队：较早的帧排在后面，同一帧内剩余关键路径越长越靠后
+        std::sort(ready.begin(), ready.end(), [](const auto& a, const auto& b) {
+            if (a.first->frameId != b.first->frameId) {
+                return a.first->frameId > b.first->frameId;
+            }
+            const LatencyModel* model = a.first->latency.get();
+            if (!model) {
+                return false;
+            }
+            return model->criticalRankUs[a.second].load(std::memory_order_relaxed) <
+                   model->criticalRankUs[b.second].load(std::memory_order_relaxed);
+        });
+    }
+    
+    while (!ready.empty()) {
+        auto [frame, index] = ready.back();
+        ready.pop_back();
+        
+        // 已放弃的帧不再执行，直接跳过以推进依赖与帧序
+        if (frame->aborted.load(std::memory_order_acquire)) {
+            finishFrameEntity(frame, index, false, ready);
+            continue;
+        }
+        
+        if (!submitFrameTask(index, frame)) {
+            finishFrameEntity(frame, index, false, ready);
+        }
     }
+}
+
+void PipelineExecutor::onFrameFinished(const FrameStatePtr& frame, ReadyList& ready) {
+    bool dropped = frame->aborted.load(std::memory_order_acquire);
+    bool inputSucceeded = frame->inputSucceeded.load(std::memory_order_acquire);
     
     {
         std::lock_guard<std::mutex> lock(mFrameStateMutex);
-        mCurrentFrameState = std::make_shared<FrameExecutionState>();
-        mCurrentFrameState->frameId = mStats.totalFrames;
+        auto it = std::find(mInFlightFrames.begin(), mInFlightFrames.end(), frame);
+        if (it == mInFlightFrames.end()) {
+            // 帧已被清理（例如执行器停止）
+            return;
+        }
+        mInFlightFrames.erase(it);
+        
+        // InputEntity未产出数据（超时/已停止）时不自动开启新帧，避免停止后空转
+        if (inputSucceeded) {
+            tryBeginFrameLocked(ready);
+        }
     }
+    // 锁外递减：排空回调可能重入执行器
+    finishPendingFrame();
     
-    if (mInputEntityId != InvalidEntityId) {
-        PIPELINE_LOGD("Resubmitting InputEntity %llu", mInputEntityId);
-        submitEntityTask(mInputEntityId);
-    } else {
-        PIPELINE_LOGW("InputEntity ID not set, cannot restart loop");
+    if (!dropped) {
+        auto now = std::chrono::steady_clock::now();
+        if (frame->latency) {
+            // 降级帧加回节省的耗时，使模型反映完整执行的延迟，负载下降后可恢复
+            auto postInput = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                now - frame->inputReadyTime).count()) + frame->degradeSavingsUs;
+            auto& ema = frame->latency->postInputLatencyUs;
+            uint64_t previous = ema.load(std::memory_order_relaxed);
+            ema.store(previous == 0 ? postInput : (previous * 7 + postInput) / 8,
+                      std::memory_order_relaxed);
+        }
+        
+        auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            now - frame->startTime).count();
+        updateStats(static_cast<uint64_t>(frameTime));
+        if (PipelineTrace::isEnabled()) {
+            int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                frame->startTime.time_since_epoch()).count();
+            PipelineTrace::complete("frame", "frame", startNs, PipelineTrace::now() - startNs,
+                                    0, frame->frameId);
+        }
+        PIPELINE_LOGD("Pipeline completed for frame %llu", frame->frameId);
+        onFrameComplete(nullptr);  // TODO: 构造FramePacket传递给回调
+        return;
+    }
+    
+    if (inputSucceeded) {
+        {
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            mStats.droppedFrames++;
+        }
+        PipelineTrace::instant("drop", "frame", 0, frame->frameId);
+        PIPELINE_LOGD("Dropped frame %llu", frame->frameId);
+        if (mFrameDroppedCallback) {
+            const CompiledPlan& plan = *frame->plan;
+            uint32_t slot = plan.outputOffsets[frame->inputIndex];
+            bool hasOutput = slot < plan.outputOffsets[frame->inputIndex + 1];
+            mFrameDroppedCallback(hasOutput ? frame->outputs[slot] : nullptr);
+        }
+    }
+}
+
+void PipelineExecutor::clearInFlightFrames() {
+    uint32_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mFrameStateMutex);
+        count = static_cast<uint32_t>(mInFlightFrames.size());
+        mInFlightFrames.clear();
+    }
+    finishPendingFrame(count);
+}
+
+void PipelineExecutor::submitDownstreamTasks(EntityId entityId) {
+    PIPELINE_LOGW("submitDownstreamTasks(%llu) is deprecated, downstream tasks are "
+                  "driven by per-frame dependency counters", entityId);
+}
+
+bool PipelineExecutor::isPipelineCompleted(EntityId entityId) {
+    // 检查是否是sink entity（没有下游）
+    auto downstreams = mGraph->getDownstreamEntities(entityId);
+    if (!downstreams.empty()) {
+        return false;  // 还有下游,未完成
+    }
+    
+    std::lock_guard<std::mutex> lock(mFrameStateMutex);
+    return mInFlightFrames.empty();
+}
+
+void PipelineExecutor::restartPipelineLoop() {
+    ReadyList ready;
+    bool begun = false;
+    {
+        std::lock_guard<std::mutex> lock(mFrameStateMutex);
+        begun = tryBeginFrameLocked(ready);
+    }
+    
+    if (!begun) {
+        PIPELINE_LOGD("Cannot restart pipeline loop: frame limit reached");
+        return;
     }
+    dispatchReady(ready);
 }
 
 } // namespace pipeline
@@ -43,6 +43,11 @@ EntityId PipelineGraph::addEntity(ProcessEntityPtr entity) {
     mOutgoingEdges[id] = {};
     mIncomingEdges[id] = {};
     
+    // 孤立节点放在拓扑序末尾，层级为0
+    mOrderIndex[id] = mOrder.size();
+    mOrder.push_back(id);
+    mLevels[id] = 0;
+    
     invalidateCache();
     ++mVersion;
     
@@ -59,6 +64,12 @@ bool PipelineGraph::removeEntity(EntityId entityId) {
         return false;
     }
     
+    // 下游层级可能降低，删边前先记下
+    std::vector<EntityId> successors;
+    for (const auto& conn : mOutgoingEdges[entityId]) {
+        successors.push_back(conn.dstEntity);
+    }
+    
     // 断开所有连接
     mOutgoingEdges.erase(entityId);
     mIncomingEdges.erase(entityId);
@@ -84,6 +95,19 @@ bool PipelineGraph::removeEntity(EntityId entityId) {
     
     mEntities.erase(it);
     
+    // 删除节点不会破坏其余节点的相对顺序，只留空位
+    auto orderIt = mOrderIndex.find(entityId);
+    if (orderIt != mOrderIndex.end()) {
+        mOrder[orderIt->second] = InvalidEntityId;
+        mOrderIndex.erase(orderIt);
+        ++mOrderHoles;
+    }
+    mLevels.erase(entityId);
+    if (mOrderHoles > mOrder.size() / 2) {
+        compactOrderLocked();
+    }
+    propagateLevelsLocked(successors);
+    
     invalidateCache();
     ++mVersion;
     
@@ -182,6 +206,13 @@ bool PipelineGraph::connect(EntityId srcId, const std::string& srcPort,
         }
     }
     
+    // 增量维护拓扑序；会成环的连接在改动边表和端口之前拒绝
+    if (!reorderForEdgeLocked(srcId, dstId)) {
+        PIPELINE_LOGW("Connecting %s to %s would create a cycle",
+                      srcIt->second->getName().c_str(), dstIt->second->getName().c_str());
+        return false;
+    }
+    
     // 创建连接
     Connection conn;
     conn.srcEntity = srcId;
@@ -196,6 +227,8 @@ bool PipelineGraph::connect(EntityId srcId, const std::string& srcPort,
     outPort->addConnection(inPort);
     inPort->setSource(srcId, srcPort);
     
+    propagateLevelsLocked({dstId});
+    
     invalidateCache();
     ++mVersion;
     
@@ -283,6 +316,9 @@ bool PipelineGraph::disconnect(EntityId srcId, const std::string& srcPort,
         }
     }
     
+    // 删边不会破坏拓扑序，只需向下游更新层级
+    propagateLevelsLocked({dstId});
+    
     invalidateCache();
     ++mVersion;
     
@@ -332,6 +368,7 @@ bool PipelineGraph::disconnectAll(EntityId srcId, EntityId dstId) {
     }
     
     if (removed) {
+        propagateLevelsLocked({dstId});
         invalidateCache();
         ++mVersion;
     }
@@ -342,6 +379,11 @@ bool PipelineGraph::disconnectAll(EntityId srcId, EntityId dstId) {
 void PipelineGraph::disconnectEntity(EntityId entityId) {
     std::lock_guard<std::mutex> lock(mMutex);
     
+    std::vector<EntityId> affected{entityId};
+    for (const auto& conn : mOutgoingEdges[entityId]) {
+        affected.push_back(conn.dstEntity);
+    }
+    
     // 清除出边
     mOutgoingEdges[entityId].clear();
     
@@ -367,6 +409,8 @@ void PipelineGraph::disconnectEntity(EntityId entityId) {
             edges.end());
     }
     
+    propagateLevelsLocked(affected);
+    
     invalidateCache();
     ++mVersion;
 }
@@ -439,42 +483,20 @@ ValidationResult PipelineGraph::validate() const {
 bool PipelineGraph::hasCycle() const {
     std::lock_guard<std::mutex> lock(mMutex);
     
-    std::unordered_set<EntityId> visited;
-    std::unordered_set<EntityId> recursionStack;
-    
-    for (const auto& [id, entity] : mEntities) {
-        if (hasCycleDFS(id, visited, recursionStack)) {
-            return true;
+    // connect 拒绝成环的边，正常情况下总是无环；这里只校验每条边都从拓扑序的前面指向后面
+    for (const auto& [srcId, edges] : mOutgoingEdges) {
+        auto srcIt = mOrderIndex.find(srcId);
+        if (srcIt == mOrderIndex.end()) {
+            continue;
         }
-    }
-    
-    return false;
-}
-
-bool PipelineGraph::hasCycleDFS(EntityId node,
-                                std::unordered_set<EntityId>& visited,
-                                std::unordered_set<EntityId>& recursionStack) const {
-    if (recursionStack.find(node) != recursionStack.end()) {
-        return true; // 发现环
-    }
-    
-    if (visited.find(node) != visited.end()) {
-        return false; // 已访问过
-    }
-    
-    visited.insert(node);
-    recursionStack.insert(node);
-    
-    auto it = mOutgoingEdges.find(node);
-    if (it != mOutgoingEdges.end()) {
-        for (const auto& conn : it->second) {
-            if (hasCycleDFS(conn.dstEntity, visited, recursionStack)) {
+        for (const auto& conn : edges) {
+            auto dstIt = mOrderIndex.find(conn.dstEntity);
+            if (dstIt != mOrderIndex.end() && dstIt->second <= srcIt->second) {
                 return true;
             }
         }
     }
     
-    recursionStack.erase(node);
     return false;
 }
 
@@ -639,11 +661,33 @@ void PipelineGraph::clear() {
     mEntities.clear();
     mOutgoingEdges.clear();
     mIncomingEdges.clear();
+    mOrder.clear();
+    mOrderIndex.clear();
+    mOrderHoles = 0;
+    mLevels.clear();
     
     invalidateCache();
     ++mVersion;
 }
 
+std::unique_ptr<PipelineGraph> PipelineGraph::clone() const {
+    auto copy = std::make_unique<PipelineGraph>();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    copy->mEntities = mEntities;
+    copy->mOutgoingEdges = mOutgoingEdges;
+    copy->mIncomingEdges = mIncomingEdges;
+    copy->mOrder = mOrder;
+    copy->mOrderIndex = mOrderIndex;
+    copy->mOrderHoles = mOrderHoles;
+    copy->mLevels = mLevels;
+
+    // 端口连接保存在共享的Entity上，这里只复制边表；版本沿用源图，便于判断快照是否过期
+    copy->mVersion.store(mVersion.load());
+    copy->mTopologyCacheValid = false;
+    return copy;
+}
+
 std::string PipelineGraph::exportToDot() const {
     std::lock_guard<std::mutex> lock(mMutex);
     
@@ -719,112 +763,159 @@ void PipelineGraph::invalidateCache() {
 }
 
 void PipelineGraph::updateTopologyCache() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    
     if (mTopologyCacheValid) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    // Kahn算法进行拓扑排序
-    topologicalSort(mTopologicalOrderCache);
+    // 拓扑序与层级都已增量维护，这里只去掉空位并按层分组
+    mTopologicalOrderCache.clear();
+    mTopologicalOrderCache.reserve(mEntities.size());
+    uint32_t maxLevel = 0;
+    for (EntityId id : mOrder) {
+        if (id != InvalidEntityId) {
+            mTopologicalOrderCache.push_back(id);
+            maxLevel = std::max(maxLevel, mLevels.at(id));
+        }
+    }
     
-    // 计算执行层级
-    computeExecutionLevels();
+    mExecutionLevelsCache.clear();
+    if (!mTopologicalOrderCache.empty()) {
+        mExecutionLevelsCache.resize(maxLevel + 1);
+        for (EntityId id : mTopologicalOrderCache) {
+            mExecutionLevelsCache[mLevels.at(id)].push_back(id);
+        }
+    }
     
     mTopologyCacheValid = true;
 }
 
-bool PipelineGraph::topologicalSort(std::vector<EntityId>& result) const {
-    result.clear();
-    
-    // 计算入度
-    std::unordered_map<EntityId, size_t> inDegree;
-    for (const auto& [id, entity] : mEntities) {
-        inDegree[id] = 0;
+bool PipelineGraph::reorderForEdgeLocked(EntityId srcId, EntityId dstId) {
+    if (srcId == dstId) {
+        return false;
     }
     
-    for (const auto& [srcId, edges] : mOutgoingEdges) {
-        for (const auto& conn : edges) {
-            inDegree[conn.dstEntity]++;
-        }
+    const size_t lower = mOrderIndex[dstId];
+    const size_t upper = mOrderIndex[srcId];
+    if (upper < lower) {
+        return true; // 已满足拓扑序
     }
     
-    // 将入度为0的节点加入队列
-    std::queue<EntityId> queue;
-    for (const auto& [id, degree] : inDegree) {
-        if (degree == 0) {
-            queue.push(id);
+    // 前向：dst 可达、位置在 src 之前的节点；途中遇到 src 说明新边成环
+    std::vector<EntityId> forward;
+    std::unordered_set<EntityId> visited{dstId};
+    std::vector<EntityId> stack{dstId};
+    while (!stack.empty()) {
+        EntityId id = stack.back();
+        stack.pop_back();
+        forward.push_back(id);
+        for (const auto& conn : mOutgoingEdges[id]) {
+            if (conn.dstEntity == srcId) {
+                return false;
+            }
+            if (mOrderIndex[conn.dstEntity] < upper && visited.insert(conn.dstEntity).second) {
+                stack.push_back(conn.dstEntity);
+            }
         }
     }
     
-    // BFS
-    while (!queue.empty()) {
-        EntityId node = queue.front();
-        queue.pop();
-        result.push_back(node);
-        
-        auto it = mOutgoingEdges.find(node);
-        if (it != mOutgoingEdges.end()) {
-            for (const auto& conn : it->second) {
-                if (--inDegree[conn.dstEntity] == 0) {
-                    queue.push(conn.dstEntity);
-                }
+    // 后向：可达 src、位置在 dst 之后的节点（无环时与前向集合不相交）
+    std::vector<EntityId> backward;
+    visited.insert(srcId);
+    stack.push_back(srcId);
+    while (!stack.empty()) {
+        EntityId id = stack.back();
+        stack.pop_back();
+        backward.push_back(id);
+        for (const auto& conn : mIncomingEdges[id]) {
+            if (mOrderIndex[conn.srcEntity] > lower && visited.insert(conn.srcEntity).second) {
+                stack.push_back(conn.srcEntity);
             }
         }
     }
     
-    return result.size() == mEntities.size();
-}
-
-void PipelineGraph::computeExecutionLevels() const {
-    mExecutionLevelsCache.clear();
+    // 两组节点各自保持原相对顺序，占用的位置合并后先放后向组、再放前向组
+    auto byOrder = [this](EntityId a, EntityId b) {
+        return mOrderIndex[a] < mOrderIndex[b];
+    };
+    std::sort(backward.begin(), backward.end(), byOrder);
+    std::sort(forward.begin(), forward.end(), byOrder);
     
-    if (mEntities.empty()) {
-        return;
+    std::vector<size_t> slots;
+    slots.reserve(backward.size() + forward.size());
+    for (EntityId id : backward) {
+        slots.push_back(mOrderIndex[id]);
     }
+    for (EntityId id : forward) {
+        slots.push_back(mOrderIndex[id]);
+    }
+    std::sort(slots.begin(), slots.end());
     
-    // 计算每个节点的层级（最长路径长度）
-    std::unordered_map<EntityId, int> levels;
-    
-    // 初始化入度为0的节点层级为0
-    for (const auto& [id, entity] : mEntities) {
-        auto inEdges = mIncomingEdges.find(id);
-        if (inEdges == mIncomingEdges.end() || inEdges->second.empty()) {
-            levels[id] = 0;
-        } else {
-            levels[id] = -1; // 未计算
+    size_t slot = 0;
+    for (const auto* group : {&backward, &forward}) {
+        for (EntityId id : *group) {
+            mOrder[slots[slot]] = id;
+            mOrderIndex[id] = slots[slot];
+            ++slot;
         }
     }
+    return true;
+}
+
+void PipelineGraph::propagateLevelsLocked(const std::vector<EntityId>& seeds) {
+    // 按拓扑位置从前往后处理：出队时前驱层级都已确定，每个节点最多重算一次
+    using Pending = std::pair<size_t, EntityId>;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+    std::unordered_set<EntityId> queued;
     
-    // 按拓扑顺序计算层级
-    for (EntityId id : mTopologicalOrderCache) {
-        if (levels[id] == -1) {
-            int maxPredLevel = -1;
-            auto inEdges = mIncomingEdges.find(id);
-            if (inEdges != mIncomingEdges.end()) {
-                // 找到入度最大节点的 level， 在此基础上 + 1
-                for (const auto& conn : inEdges->second) {
-                    maxPredLevel = std::max(maxPredLevel, levels[conn.srcEntity]);
-                }
-            }
-            levels[id] = maxPredLevel + 1;
+    auto enqueue = [&](EntityId id) {
+        auto it = mOrderIndex.find(id);
+        if (it != mOrderIndex.end() && queued.insert(id).second) {
+            pending.emplace(it->second, id);
         }
+    };
+    for (EntityId id : seeds) {
+        enqueue(id);
     }
     
-    // 按层级分组
-    int maxLevel = 0;
-    for (const auto& [id, level] : levels) {
-        maxLevel = std::max(maxLevel, level);
+    while (!pending.empty()) {
+        EntityId id = pending.top().second;
+        pending.pop();
+        
+        uint32_t level = 0;
+        for (const auto& conn : mIncomingEdges[id]) {
+            level = std::max(level, mLevels[conn.srcEntity] + 1);
+        }
+        
+        uint32_t& current = mLevels[id];
+        if (current == level) {
+            continue; // 层级未变，下游不受影响
+        }
+        current = level;
+        for (const auto& conn : mOutgoingEdges[id]) {
+            enqueue(conn.dstEntity);
+        }
     }
-    
-    mExecutionLevelsCache.resize(maxLevel + 1);
-    for (const auto& [id, level] : levels) {
-        mExecutionLevelsCache[level].push_back(id);
+}
+
+void PipelineGraph::compactOrderLocked() {
+    size_t next = 0;
+    for (EntityId id : mOrder) {
+        if (id != InvalidEntityId) {
+            mOrder[next] = id;
+            mOrderIndex[id] = next;
+            ++next;
+        }
     }
+    mOrder.resize(next);
+    mOrderHoles = 0;
 }
 
 void PipelineGraph::markDirty() {
+    std::lock_guard<std::mutex> lock(mMutex);
     invalidateCache();
+    ++mVersion;
 }
 
 } // namespace pipeline
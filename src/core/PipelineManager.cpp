@@ -6,26 +6,56 @@
 #include "pipeline/core/PipelineManager.h"
 #include "pipeline/pool/TexturePool.h"
 #include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/pool/ShaderProgramCache.h"
+#include "pipeline/pool/GpuResourceRegistry.h"
+#include "pipeline/pool/ResourceHub.h"
+#include "pipeline/data/AsyncReadback.h"
 #include "pipeline/output/OutputEntity.h"
 #include "pipeline/output/DisplaySurface.h"
 #include "pipeline/input/InputEntity.h"
 #include "pipeline/entity/GPUEntity.h"
+#include "pipeline/entity/CPUEntity.h"
 #include "pipeline/entity/MergeEntity.h"
 #include "pipeline/platform/PlatformContext.h"
 #include "pipeline/utils/PipelineLog.h"
+#include <algorithm>
+#include <future>
+#include <unordered_map>
 
 // 平台特定头文件
 #if defined(__APPLE__)
 #include "pipeline/input/ios/PixelBufferInputStrategy.h"
 #include "pipeline/output/ios/iOSMetalSurface.h"
+#include "pipeline/output/ios/iOSVideoToolboxEncoder.h"
 #endif
 #if defined(__ANDROID__)
 #include "pipeline/input/android/OESTextureInputStrategy.h"
+#include "pipeline/output/android/AndroidEGLSurface.h"
+#include "pipeline/output/android/AndroidMediaCodecEncoder.h"
 #endif
 
 
 namespace pipeline {
 
+// =============================================================================
+// 拍照会话
+// =============================================================================
+
+struct PipelineManager::CaptureSession {
+    uint64_t graphVersion = 0;
+    std::unique_ptr<PipelineGraph> graph;           // 图快照（Entity与预览共享）
+    std::shared_ptr<TexturePool> texturePool;       // 全分辨率纹理单独成池，不挤占预览的桶
+    std::shared_ptr<PipelineContext> context;
+    std::shared_ptr<PipelineExecutor> executor;     // 只编译计划、内联执行，不创建队列
+};
+
+struct PipelineManager::CaptureJob {
+    std::shared_ptr<CaptureSession> session;
+    std::vector<FramePacketPtr> frames;
+    CaptureCallback callback;
+    size_t next = 0;                                // 仅在GPU队列读写
+};
+
 // =============================================================================
 // 静态创建方法
 // =============================================================================
@@ -85,13 +115,34 @@ bool PipelineManager::initialize() {
         return false;
     }
     
+    if (!getConfig().shaderCacheDirectory.empty()) {
+        ShaderProgramCache::instance().setDiskCacheDirectory(getConfig().shaderCacheDirectory);
+    }
+    
     // 创建执行器
     ExecutorConfig execConfig;
     execConfig.maxConcurrentFrames = getConfig().maxConcurrentFrames;
     execConfig.enableParallelExecution = getConfig().enableParallelExecution;
     execConfig.enableFrameSkipping = getConfig().enableFrameSkipping;
+    execConfig.cpuThreadCount = getConfig().cpuThreadCount;
+    execConfig.useWorkStealingCPUPool = getConfig().enableWorkStealing;
+    execConfig.pinCPUWorkersToBigCores = getConfig().pinCPUWorkersToBigCores;
+    execConfig.enablePriorityLanes = getConfig().enablePriorityLanes;
+    execConfig.enableShaderFusion = getConfig().enableShaderFusion;
+    execConfig.enableCommandRecording = getConfig().enableCommandRecording;
+    execConfig.enableStateTracking = getConfig().enableStateTracking;
+    execConfig.enableLazyOutputs = getConfig().enableLazyOutputs;
+    execConfig.enableFormatNegotiation = getConfig().enableFormatNegotiation;
+    execConfig.enableProfiling = getConfig().enableProfiling;
+    execConfig.enableTracing = getConfig().enableTracing;
+    execConfig.proxyRenderScale = getConfig().previewRenderScale;
+    execConfig.enableTransferQueue = getConfig().enableTransferQueue;
     
     mExecutor = std::make_shared<PipelineExecutor>(mGraph.get(), execConfig);
+    mExecutor->setTransferContextBinding(mTransferBinding);
+    if (mResourceLease) {
+        mExecutor->setSharedGPUQueue(mResourceLease->getGPUQueue());
+    }
     
     mContext->setTexturePool(mTexturePool);
     mContext->setFramePacketPool(mFramePacketPool);
@@ -104,10 +155,34 @@ bool PipelineManager::initialize() {
     }
     
     // 设置回调
-    mExecutor->setFrameCompleteCallback(mFrameCompleteCallback);
+    installFrameCompleteCallback();
     mExecutor->setFrameDroppedCallback(mFrameDroppedCallback);
     mExecutor->setErrorCallback(mErrorCallback);
     
+    // 图编辑后的新计划在切换前按快照预热（GPU队列调用）
+    std::weak_ptr<PipelineManager> weakSelf = weak_from_this();
+    mExecutor->setPlanPreparer([weakSelf](const PipelineGraph& snapshot) {
+        if (auto self = weakSelf.lock()) {
+            self->warmupGraph(snapshot);
+        }
+    });
+    
+    // CPU消费者等待读回时，经发起读回的队列（GPU或传输队列）立即收取结果
+    if (mReadbackService) {
+        std::weak_ptr<PipelineExecutor> weakExecutor = mExecutor;
+        mReadbackService->setGPUTaskPoster([weakExecutor](std::function<void()> task) {
+            if (auto executor = weakExecutor.lock()) {
+                if (executor->hasTransferQueue()) {
+                    executor->postToTransferQueue(std::move(task));
+                } else {
+                    executor->postToGPUQueue(std::move(task));
+                }
+            }
+        });
+    }
+    
+    registerMetricCollectors();
+    
     setState(PipelineState::Initialized);
     PIPELINE_LOGI("PipelineManager initialized");
     return true;
@@ -140,22 +215,45 @@ bool PipelineManager::start() {
         return false;
     }
     
+    mStartTimeUs.store(QualityController::nowUs());
+    mFirstFrameReported.store(false, std::memory_order_release);
+    
+    if (getConfig().enableStagedStartup && mExecutor) {
+        // 预热与资源加载并行，只等必需路径；可降级节点在后台就绪后加入
+        if (!runStagedStartup()) {
+            PIPELINE_LOGE("Staged startup failed");
+            return false;
+        }
+    } else {
+        // 图在 initialize() 之后才搭建完成时，在首帧前按最终的图补充预热
+        initializeGPUResources();
+        if (!loadEntityResources()) {
+            return false;
+        }
+    }
+    
     // 异步任务链: 启动InputEntity的processing loop
     auto inputEntity = getInputEntity();
     if (inputEntity) {
-        inputEntity->setExecutor(mExecutor.get());
-        inputEntity->startProcessingLoop();
-        
-        // 设置PipelineExecutor的InputEntity ID
+        // 设置PipelineExecutor的InputEntity ID（需在投递首帧之前）
         if (mExecutor) {
             mExecutor->setInputEntityId(inputEntity->getId());
         }
         
+        inputEntity->setExecutor(mExecutor.get());
+        inputEntity->startProcessingLoop();
+        
         PIPELINE_LOGI("Started InputEntity processing loop, entityId: %d", inputEntity->getId());
     } else {
         PIPELINE_LOGW("No InputEntity found, pipeline may not receive input data");
     }
     
+    // 从属输入只开始接收数据，帧由主输入驱动
+    for (auto& source : mInputSources) {
+        source->setExecutor(mExecutor.get());
+        source->startProcessingLoop();
+    }
+    
     // 设置所有Entity的Executor引用
     auto allEntities = mGraph->getAllEntities();
     for (auto& entity : allEntities) {
@@ -193,6 +291,9 @@ void PipelineManager::stop() {
             inputEntity->stopProcessingLoop();
             PIPELINE_LOGI("Stopped InputEntity processing loop, entityId: %d", inputEntity->getId());
         }
+        for (auto& source : mInputSources) {
+            source->stopProcessingLoop();
+        }
         
         // 等待所有帧完成
         if (mExecutor) {
@@ -206,6 +307,23 @@ void PipelineManager::stop() {
 
 void PipelineManager::destroy() {
     stop();
+    disableAdaptiveQuality();
+    
+    // 周期推送线程可能正在采集，移除后才能释放执行器与资源池
+    mMetrics.removeCollector(mMetricsCollectorId);
+    mMetricsCollectorId = MetricsRegistry::kInvalidCollectorId;
+    
+    // 释放读回暂存资源（GL对象须在GPU线程释放）
+    if (mReadbackService) {
+        auto service = mReadbackService;
+        if (mExecutor) {
+            mExecutor->runOnGPUQueue([service]() { service->shutdown(); });
+        } else {
+            service->shutdown();
+        }
+        mContext->setReadbackService(nullptr);
+        mReadbackService.reset();
+    }
     
     // 销毁执行器
     if (mExecutor) {
@@ -213,6 +331,19 @@ void PipelineManager::destroy() {
         mExecutor.reset();
     }
     
+    {
+        std::lock_guard<std::mutex> lock(mCaptureMutex);
+        if (mCaptureSession) {
+            mCaptureSession->texturePool->clear();
+            mCaptureSession.reset();
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mStartupMutex);
+        mDeferredWarmupGraph.reset();
+    }
+    
     // 清空图
     if (mGraph) {
         mGraph->clear();
@@ -222,8 +353,23 @@ void PipelineManager::destroy() {
     if (mFramePacketPool) {
         mFramePacketPool->clear();
     }
-    if (mTexturePool) {
-        mTexturePool->clear();
+    
+    if (mResourceLease) {
+        // 共享资源仍可能被同一上下文的其他管线使用，由最后一个租约释放
+        mContext->setTexturePool(nullptr);
+        mContext->setGpuResourceRegistry(nullptr);
+        mTexturePool.reset();
+        mGpuResources.reset();
+        mResourceLease.reset();
+    } else {
+        // 程序随上下文失效，不能留给下一个管线
+        ShaderProgramCache::instance().purge(mRenderContext);
+        if (mGpuResources) {
+            mGpuResources->clear();
+        }
+        if (mTexturePool) {
+            mTexturePool->clear();
+        }
     }
     
     setState(PipelineState::Created);
@@ -247,7 +393,25 @@ EntityId PipelineManager::addEntity(ProcessEntityPtr entity) {
         }
     }
 
-    return mGraph->addEntity(entity);
+    EntityId entityId = mGraph->addEntity(entity);
+    
+    // 输入未自带帧率上限时沿用管线级上限
+    if (entityId != InvalidEntityId && mFrameRateLimit > 0.0f &&
+        entity->getType() == EntityType::Input) {
+        auto inputEntity = std::dynamic_pointer_cast<input::InputEntity>(entity);
+        if (inputEntity && inputEntity->getFrameRateLimit() <= 0.0f) {
+            inputEntity->setFrameRateLimit(mFrameRateLimit);
+        }
+    }
+    
+    // 已应用过质量参数时，新加入的Entity同步到当前档位
+    if (entityId != InvalidEntityId) {
+        std::lock_guard<std::mutex> lock(mQualityMutex);
+        if (mQualitySettings) {
+            entity->onQualityChanged(*mQualitySettings);
+        }
+    }
+    return entityId;
 }
 
 bool PipelineManager::removeEntity(EntityId entityId) {
@@ -264,6 +428,11 @@ bool PipelineManager::removeEntity(EntityId entityId) {
         mOutputEntityId = InvalidEntityId;
         PIPELINE_LOGI("Removing output entity, entityId: %d", entityId);
     }
+    mInputSources.erase(std::remove_if(mInputSources.begin(), mInputSources.end(),
+                                       [entityId](const std::shared_ptr<input::InputEntity>& source) {
+                                           return source->getId() == entityId;
+                                       }),
+                        mInputSources.end());
     
     return mGraph->removeEntity(entityId);
 }
@@ -289,6 +458,20 @@ std::vector<ProcessEntityPtr> PipelineManager::getAllEntities() const {
     return mGraph->getAllEntities();
 }
 
+bool PipelineManager::setEntityEnabled(EntityId entityId, bool enabled) {
+    auto entity = getEntity(entityId);
+    if (!entity) {
+        return false;
+    }
+    if (entity->isEnabled() == enabled) {
+        return true;
+    }
+    entity->setEnabled(enabled);
+    // 拓扑不变但计划要重新编译
+    mGraph->markDirty();
+    return true;
+}
+
 // =============================================================================
 // 连接管理
 // =============================================================================
@@ -352,6 +535,14 @@ bool PipelineManager::processFrameAsync(FramePacketPtr input,
     return false;
 }
 
+size_t PipelineManager::processFrames(const std::vector<FramePacketPtr>& inputs) {
+    if (!mExecutor || mState != PipelineState::Running) {
+        PIPELINE_LOGW("Pipeline is not running");
+        return 0;
+    }
+    return mExecutor->processFrames(inputs);
+}
+
 bool PipelineManager::flush(int64_t timeoutMs) {
     if (!mExecutor) {
         return true;
@@ -359,6 +550,132 @@ bool PipelineManager::flush(int64_t timeoutMs) {
     return mExecutor->flush(timeoutMs);
 }
 
+void PipelineManager::requestFullResolution(uint32_t frameCount) {
+    if (mExecutor) {
+        mExecutor->requestFullResolution(frameCount);
+    }
+}
+
+// =============================================================================
+// 拍照
+// =============================================================================
+
+std::shared_ptr<PipelineManager::CaptureSession> PipelineManager::acquireCaptureSession() {
+    std::lock_guard<std::mutex> lock(mCaptureMutex);
+    const uint64_t version = mGraph->getVersion();
+    if (mCaptureSession && mCaptureSession->graphVersion == version) {
+        return mCaptureSession;
+    }
+    
+    auto session = std::make_shared<CaptureSession>();
+    session->graphVersion = version;
+    session->graph = mGraph->clone();
+    
+    // 拍照不频繁，桶只留一份
+    TexturePoolConfig textureConfig;
+    textureConfig.maxTexturesPerBucket = 1;
+    textureConfig.maxTotalTextures = getConfig().texturePoolSize;
+    textureConfig.maxBytes = getConfig().texturePoolMaxBytes;
+    session->texturePool = std::make_shared<TexturePool>(mRenderContext, textureConfig);
+    
+    session->context = std::make_shared<PipelineContext>();
+    session->context->setRenderContext(mRenderContext);
+    session->context->setConfig(getConfig());
+    session->context->setTexturePool(session->texturePool);
+    session->context->setFramePacketPool(mFramePacketPool);
+    session->context->setReadbackService(mReadbackService);
+    session->context->setGpuResourceRegistry(mGpuResources);
+    
+    ExecutorConfig execConfig;
+    execConfig.enableFrameSkipping = false;
+    execConfig.enableParallelExecution = false;
+    execConfig.enableShaderFusion = false;
+    execConfig.frameArenaSize = 0;
+    session->executor = std::make_shared<PipelineExecutor>(session->graph.get(), execConfig);
+    session->executor->setContext(session->context);
+    
+    // 旧会话由在途任务持有，完成后随之释放
+    mCaptureSession = session;
+    return session;
+}
+
+bool PipelineManager::capture(const std::vector<FramePacketPtr>& frames, CaptureCallback callback) {
+    if (!mExecutor || mState != PipelineState::Running) {
+        PIPELINE_LOGW("Pipeline is not running");
+        return false;
+    }
+    if (frames.empty() || !callback) {
+        return false;
+    }
+    
+    auto job = std::make_shared<CaptureJob>();
+    job->session = acquireCaptureSession();
+    job->frames = frames;
+    job->callback = std::move(callback);
+    
+    // 显式输出尺寸按预览输入配置写死，借渲染比例按拍照尺寸等比放大
+    auto* inputEntity = getInputEntity();
+    const uint32_t liveWidth = inputEntity ? inputEntity->getInputConfig().width : 0;
+    for (const auto& frame : job->frames) {
+        if (!frame || liveWidth == 0 || frame->getWidth() == liveWidth) {
+            continue;
+        }
+        float scale = static_cast<float>(frame->getWidth()) / static_cast<float>(liveWidth);
+        frame->setRenderScale(scale);
+        frame->setPixelScale(scale);
+    }
+    
+    PIPELINE_LOGI("Capture requested: %zu frame(s)", job->frames.size());
+    scheduleCaptureFrame(mExecutor, std::move(job));
+    return true;
+}
+
+void PipelineManager::scheduleCaptureFrame(std::weak_ptr<PipelineExecutor> preview,
+                                           std::shared_ptr<CaptureJob> job) {
+    auto executor = preview.lock();
+    if (!executor) {
+        return;
+    }
+    
+    // 预览在途帧排空后再占用GPU线程；内联执行期间新到的预览帧在队列中等待一帧的时间
+    executor->flushAsync([preview, job](bool) {
+        auto executor = preview.lock();
+        if (!executor) {
+            return;
+        }
+        executor->postToGPUQueue([preview, job]() {
+            const size_t index = job->next++;
+            FramePacketPtr frame = std::move(job->frames[index]);
+            FramePacketPtr result = job->session->executor->processFrameInline(frame);
+            if (!result) {
+                PIPELINE_LOGW("Capture frame %zu failed", index);
+            }
+            
+            auto executor = preview.lock();
+            if (!executor) {
+                return;
+            }
+            executor->postToIOQueue([job, index, result]() {
+                job->callback(index, result);
+            });
+            if (job->next < job->frames.size()) {
+                scheduleCaptureFrame(preview, job);
+            }
+        });
+    });
+}
+
+void PipelineManager::flushAsync(std::function<void(bool)> callback) {
+    if (!callback) {
+        return;
+    }
+    if (!mExecutor) {
+        callback(true);
+        return;
+    }
+    mExecutor->flushAsync(std::move(callback));
+}
+
 // =============================================================================
 // 输入输出快捷接口
 // =============================================================================
@@ -465,6 +782,12 @@ int32_t PipelineManager::setupDisplayOutput(void* surface, uint32_t width, uint3
     // 4. 设置尺寸
     displaySurface->setSize(width, height);
     
+    // 按 VSync 网格安排上屏，三缓冲让下一帧渲染与当前帧扫描输出重叠
+    auto pacer = std::make_shared<output::FramePacer>();
+    pacer->attachVsyncSource(output::createPlatformVsyncSource());
+    displaySurface->setFramePacer(pacer);
+    displaySurface->setMaxFramesInFlight(3);
+    
     // 5. 创建 DisplayOutputTarget
     int32_t targetId = mNextTargetId.fetch_add(1);
     auto displayTarget = std::make_shared<output::DisplayOutputTarget>(
@@ -481,11 +804,49 @@ int32_t PipelineManager::setupDisplayOutput(void* surface, uint32_t width, uint3
     
     // 8. 记录
     mOutputTargets[targetId] = displayTarget;
+    updateDisplayPresentation();
     
     PIPELINE_LOGI("Display output configured, target ID: %d", targetId);
     return targetId;
 }
 
+void PipelineManager::updateDisplayPresentation() {
+    auto outputEntity = dynamic_cast<output::OutputEntity*>(getOutputEntity());
+    if (!outputEntity) {
+        return;
+    }
+    
+    std::vector<output::DisplayOutputTarget*> displays;
+    for (const auto& entry : mOutputTargets) {
+        if (entry.second->getType() == output::OutputTargetType::Display) {
+            displays.push_back(static_cast<output::DisplayOutputTarget*>(entry.second.get()));
+        }
+    }
+    
+    if (displays.size() < 2) {
+        for (auto* display : displays) {
+            display->setLatestFrameSource(nullptr, nullptr);
+        }
+        outputEntity->setLatestFramePublishing(false);
+        return;
+    }
+    
+    // 图按输入节奏运行一次，各屏只做一次缩放绘制
+    outputEntity->setLatestFramePublishing(true);
+    auto cache = outputEntity->getLatestFrameCache();
+    std::weak_ptr<PipelineExecutor> weakExecutor = mExecutor;
+    auto gpuPoster = [weakExecutor](std::function<void()> task) {
+        if (auto executor = weakExecutor.lock()) {
+            executor->postToGPUQueue(std::move(task));
+        }
+    };
+    for (auto* display : displays) {
+        if (!display->isPullingLatestFrame()) {
+            display->setLatestFrameSource(cache, gpuPoster);
+        }
+    }
+}
+
 // =============================================================================
 // 输入配置
 // =============================================================================
@@ -512,6 +873,88 @@ EntityId PipelineManager::setupInput(const input::InputConfig& config) {
     return inputId;
 }
 
+EntityId PipelineManager::addInputSource(const input::InputConfig& config, const std::string& name) {
+    if (!mGraph) {
+        return InvalidEntityId;
+    }
+    
+    auto source = std::make_shared<input::InputEntity>(name);
+    source->setRenderContext(mRenderContext);
+    source->configure(config);
+    source->setClockRole(input::InputClockRole::Follower);
+    
+    EntityId sourceId = addEntity(source);
+    if (sourceId == InvalidEntityId) {
+        return InvalidEntityId;
+    }
+    mInputSources.push_back(source);
+    
+    if (mState == PipelineState::Running || mState == PipelineState::Paused) {
+        source->setExecutor(mExecutor.get());
+        source->startProcessingLoop();
+    }
+    
+    PIPELINE_LOGI("Input source '%s' added as follower, entity ID: %d", name.c_str(), sourceId);
+    return sourceId;
+}
+
+bool PipelineManager::setMasterInput(EntityId entityId) {
+    if (mInputEntity && mInputEntity->getId() == entityId) {
+        return true;
+    }
+    
+    auto it = std::find_if(mInputSources.begin(), mInputSources.end(),
+                           [entityId](const std::shared_ptr<input::InputEntity>& source) {
+                               return source->getId() == entityId;
+                           });
+    if (it == mInputSources.end()) {
+        PIPELINE_LOGW("Entity %d is not an input source of this pipeline", entityId);
+        return false;
+    }
+    
+    // 先降级旧主输入：其等待中的处理任务被唤醒并沿用上一帧返回，不再续投新帧
+    if (mInputEntity) {
+        mInputEntity->setClockRole(input::InputClockRole::Follower);
+    }
+    std::swap(mInputEntity, *it);
+    if (!*it) {
+        mInputSources.erase(it);
+    }
+    
+    mInputEntity->setClockRole(input::InputClockRole::Master);
+    setInputEntity(entityId);
+    if (mExecutor) {
+        mExecutor->setInputEntityId(entityId);
+    }
+    
+    if (mState == PipelineState::Running || mState == PipelineState::Paused) {
+        mInputEntity->startProcessingLoop();
+    }
+    
+    PIPELINE_LOGI("Master clock switched to input entity %d", entityId);
+    return true;
+}
+
+void PipelineManager::setFrameRateLimit(float fps) {
+    mFrameRateLimit = fps > 0.0f ? fps : 0.0f;
+    if (mInputEntity) {
+        mInputEntity->setFrameRateLimit(mFrameRateLimit);
+    }
+    for (auto& source : mInputSources) {
+        source->setFrameRateLimit(mFrameRateLimit);
+    }
+    PIPELINE_LOGI("Input frame rate limit: %.1f fps", mFrameRateLimit);
+}
+
+bool PipelineManager::setCropRect(const RoiRect& rect) {
+    if (!mInputEntity) {
+        PIPELINE_LOGW("setCropRect: no input configured");
+        return false;
+    }
+    mInputEntity->setCropRect(rect);
+    return true;
+}
+
 #if defined(__APPLE__)
 EntityId PipelineManager::setupPixelBufferInput(uint32_t width, uint32_t height, void* metalManager, bool enableCPUOutput) {
     if (mInputEntity) {
@@ -671,7 +1114,8 @@ EntityId PipelineManager::setupYUVInput(uint32_t width, uint32_t height) {
 int32_t PipelineManager::setupCallbackOutput(
     std::function<void(const uint8_t*, size_t, uint32_t, uint32_t, 
                       output::OutputFormat, int64_t)> callback,
-    output::OutputFormat dataFormat) {
+    output::OutputFormat dataFormat,
+    uint32_t width, uint32_t height) {
     
     auto outputEntity = dynamic_cast<output::OutputEntity*>(getOutputEntity());
     if (!outputEntity) {
@@ -686,6 +1130,7 @@ int32_t PipelineManager::setupCallbackOutput(
     
     // 设置回调
     callbackTarget->setCPUCallback(std::move(callback));
+    callbackTarget->setCPUOutputFormat(dataFormat, width, height);
     
     // 添加到 OutputEntity
     outputEntity->addTarget(callbackTarget);
@@ -699,17 +1144,189 @@ int32_t PipelineManager::setupCallbackOutput(
 }
 
 int32_t PipelineManager::setupEncoderOutput(void* encoderSurface, output::EncoderType encoderType) {
+    output::EncoderConfig config;
+    config.type = encoderType;
+    return setupEncoderOutput(encoderSurface, config, nullptr);
+}
+
+int32_t PipelineManager::setupEncoderOutput(void* encoderSurface, const output::EncoderConfig& config,
+                                            void* platformManager) {
+    if (!encoderSurface) {
+        PIPELINE_LOGE("Invalid encoder surface");
+        return -1;
+    }
+    
+    auto outputEntity = dynamic_cast<output::OutputEntity*>(getOutputEntity());
+    if (!outputEntity) {
+        PIPELINE_LOGE("No OutputEntity available");
+        return -1;
+    }
+    
+    if (config.width == 0 || config.height == 0) {
+        PIPELINE_LOGE("Encoder size not specified");
+        return -1;
+    }
+    const output::EncoderConfig& encoderConfig = config;
+    
+    // 1. 创建编码器输入表面
+    output::DisplaySurfacePtr encoderSurfacePtr;
+#if defined(__APPLE__)
+    auto metalSurface = std::make_shared<output::ios::iOSMetalSurface>();
+    if (platformManager) {
+        metalSurface->setMetalContextManager(static_cast<IOSMetalContextManager*>(platformManager));
+    } else {
+        PIPELINE_LOGW("No MetalContextManager provided, encoder surface may fail to initialize");
+    }
+    if (!metalSurface->attachToPixelBufferAdaptor(encoderSurface,
+                                                  encoderConfig.width, encoderConfig.height)) {
+        PIPELINE_LOGE("Failed to attach encoder surface to pixel buffer adaptor");
+        return -1;
+    }
+    encoderSurfacePtr = metalSurface;
+#elif defined(__ANDROID__)
+    auto eglSurface = std::make_shared<output::android::AndroidEGLSurface>();
+    if (platformManager) {
+        eglSurface->setEGLContextManager(static_cast<AndroidEGLContextManager*>(platformManager));
+    } else {
+        PIPELINE_LOGW("No EGLContextManager provided, encoder surface may fail to initialize");
+    }
+    // MediaCodec 输入 Surface 要求可录制的 EGL 配置
+    eglSurface->setRecordable(true);
+    if (!eglSurface->attachToWindow(encoderSurface)) {
+        PIPELINE_LOGE("Failed to attach encoder surface to window");
+        return -1;
+    }
+    encoderSurfacePtr = eglSurface;
+#else
+    (void)platformManager;
+    PIPELINE_LOGE("Platform not supported");
+    return -1;
+#endif
+    
+    // 2. 初始化并设置尺寸
+    if (!encoderSurfacePtr->initialize(mRenderContext)) {
+        PIPELINE_LOGE("Failed to initialize encoder surface");
+        return -1;
+    }
+    encoderSurfacePtr->setSize(encoderConfig.width, encoderConfig.height);
+    
+    // 3. 创建 EncoderOutputTarget 并添加到 OutputEntity
+    int32_t targetId = mNextTargetId.fetch_add(1);
+    auto encoderTarget = std::make_shared<output::EncoderOutputTarget>(
+        "encoder_" + std::to_string(targetId), encoderConfig);
+    encoderTarget->setEncoderSurface(encoderSurfacePtr);
+    outputEntity->addTarget(encoderTarget);
+    
+    mOutputTargets[targetId] = encoderTarget;
+    
+    PIPELINE_LOGI("Encoder output configured, target ID: %d, %ux%u@%u, type: %d",
+                  targetId, encoderConfig.width, encoderConfig.height,
+                  encoderConfig.frameRate, static_cast<int>(encoderConfig.type));
+    return targetId;
+}
+
+int32_t PipelineManager::setupFileOutput(const std::string& filePath,
+                                         const output::EncoderConfig& config,
+                                         void* platformManager,
+                                         const output::Mp4WriterConfig& writerConfig) {
+    if (filePath.empty()) {
+        PIPELINE_LOGE("Invalid file path");
+        return -1;
+    }
+    if (config.width == 0 || config.height == 0) {
+        PIPELINE_LOGE("Encoder size not specified");
+        return -1;
+    }
+    
     auto outputEntity = dynamic_cast<output::OutputEntity*>(getOutputEntity());
     if (!outputEntity) {
         PIPELINE_LOGE("No OutputEntity available");
         return -1;
     }
     
-    // TODO: 实现编码器输出
-    (void)encoderSurface;
-    (void)encoderType;
-    PIPELINE_LOGW("setupEncoderOutput not yet implemented");
+    // 1. 创建硬件编码器及其输入表面
+    output::DisplaySurfacePtr encoderSurface;
+    output::EncodedSampleSourcePtr sampleSource;
+#if defined(__APPLE__)
+    auto encoder = std::make_shared<output::ios::iOSVideoToolboxEncoder>();
+    if (!encoder->initialize(config)) {
+        PIPELINE_LOGE("Failed to create VideoToolbox encoder");
+        return -1;
+    }
+    auto metalSurface = std::make_shared<output::ios::iOSMetalSurface>();
+    if (platformManager) {
+        metalSurface->setMetalContextManager(static_cast<IOSMetalContextManager*>(platformManager));
+    }
+    std::weak_ptr<output::ios::iOSVideoToolboxEncoder> weakEncoder = encoder;
+    if (!metalSurface->attachToPixelBufferPool(
+            encoder->getPixelBufferPool(), config.width, config.height,
+            [weakEncoder](void* pixelBuffer, int64_t timestampUs) {
+                if (auto strongEncoder = weakEncoder.lock()) {
+                    strongEncoder->encode(pixelBuffer, timestampUs);
+                }
+            })) {
+        PIPELINE_LOGE("Failed to attach encoder surface to pixel buffer pool");
+        return -1;
+    }
+    encoderSurface = metalSurface;
+    sampleSource = encoder;
+#elif defined(__ANDROID__)
+    auto encoder = std::make_shared<output::android::AndroidMediaCodecEncoder>();
+    if (!encoder->initialize(config)) {
+        PIPELINE_LOGE("Failed to create MediaCodec encoder");
+        return -1;
+    }
+    auto eglSurface = std::make_shared<output::android::AndroidEGLSurface>();
+    if (platformManager) {
+        eglSurface->setEGLContextManager(static_cast<AndroidEGLContextManager*>(platformManager));
+    }
+    eglSurface->setRecordable(true);
+    if (!eglSurface->attachToWindow(encoder->getInputSurface())) {
+        PIPELINE_LOGE("Failed to attach encoder surface to window");
+        return -1;
+    }
+    encoderSurface = eglSurface;
+    sampleSource = encoder;
+#else
+    (void)platformManager;
+    (void)writerConfig;
+    PIPELINE_LOGE("Platform not supported");
     return -1;
+#endif
+    
+    if (!encoderSurface->initialize(mRenderContext)) {
+        PIPELINE_LOGE("Failed to initialize encoder surface");
+        return -1;
+    }
+    encoderSurface->setSize(config.width, config.height);
+    
+    // 2. 渲染端 + 封装端组成文件目标，封装投递到IO队列
+    int32_t targetId = mNextTargetId.fetch_add(1);
+    const std::string name = "file_" + std::to_string(targetId);
+    auto renderTarget = std::make_shared<output::EncoderOutputTarget>(name + "_encoder", config);
+    renderTarget->setEncoderSurface(encoderSurface);
+    
+    auto fileTarget = std::make_shared<output::FileOutputTarget>(name, filePath, config, writerConfig);
+    fileTarget->setEncoder(renderTarget, sampleSource);
+    std::weak_ptr<PipelineExecutor> weakExecutor = mExecutor;
+    fileTarget->setIOTaskPoster([weakExecutor](std::function<void()> task) {
+        if (auto executor = weakExecutor.lock()) {
+            executor->postToIOQueue(std::move(task));
+        } else {
+            task();
+        }
+    });
+    if (!fileTarget->initialize()) {
+        PIPELINE_LOGE("Failed to create output file %s", filePath.c_str());
+        return -1;
+    }
+    
+    // 3. 添加到 OutputEntity
+    outputEntity->addTarget(fileTarget);
+    mOutputTargets[targetId] = fileTarget;
+    
+    PIPELINE_LOGI("File output configured, target ID: %d, path: %s", targetId, filePath.c_str());
+    return targetId;
 }
 
 bool PipelineManager::removeOutputTarget(int32_t targetId) {
@@ -726,6 +1343,7 @@ bool PipelineManager::removeOutputTarget(int32_t targetId) {
     }
     
     mOutputTargets.erase(it);
+    updateDisplayPresentation();
     PIPELINE_LOGI("Output target %d removed", targetId);
     return true;
 }
@@ -779,9 +1397,36 @@ std::shared_ptr<PipelineContext> PipelineManager::getContext() const {
 
 void PipelineManager::setFrameCompleteCallback(std::function<void(FramePacketPtr)> callback) {
     mFrameCompleteCallback = std::move(callback);
-    if (mExecutor) {
-        mExecutor->setFrameCompleteCallback(mFrameCompleteCallback);
+    installFrameCompleteCallback();
+}
+
+void PipelineManager::setFirstFrameCallback(std::function<void(int64_t startupUs)> callback) {
+    std::lock_guard<std::mutex> lock(mStartupMutex);
+    mFirstFrameCallback = std::move(callback);
+}
+
+void PipelineManager::installFrameCompleteCallback() {
+    if (!mExecutor) {
+        return;
     }
+    
+    // 首帧检测只读一个原子标志；开启自适应质量时再评估负载
+    QualityControllerPtr controller = getQualityController();
+    std::weak_ptr<PipelineManager> weakSelf = weak_from_this();
+    auto userCallback = mFrameCompleteCallback;
+    mExecutor->setFrameCompleteCallback([weakSelf, controller, userCallback](FramePacketPtr packet) {
+        auto self = weakSelf.lock();
+        if (self && !self->mFirstFrameReported.load(std::memory_order_acquire)) {
+            self->reportFirstFrame();
+        }
+        if (controller && self && self->mExecutor &&
+            controller->evaluate(self->mExecutor->getStats(), QualityController::nowUs())) {
+            self->applyQualitySettings(controller->getSettings());
+        }
+        if (userCallback) {
+            userCallback(std::move(packet));
+        }
+    });
 }
 
 void PipelineManager::setFrameDroppedCallback(std::function<void(FramePacketPtr)> callback) {
@@ -802,6 +1447,169 @@ void PipelineManager::setStateCallback(std::function<void(PipelineState)> callba
     mStateCallback = std::move(callback);
 }
 
+// =============================================================================
+// 内存管理
+// =============================================================================
+
+size_t PipelineManager::onMemoryPressure(MemoryPressureLevel level) {
+    const bool releaseAll = level != MemoryPressureLevel::Low;
+    size_t textureBytes = 0;
+    size_t bufferBytes = 0;
+    size_t packetBytes = 0;
+    size_t arenaBytes = 0;
+    
+    std::shared_ptr<TexturePool> captureTextures;
+    {
+        std::lock_guard<std::mutex> lock(mCaptureMutex);
+        if (mCaptureSession) {
+            captureTextures = mCaptureSession->texturePool;
+        }
+    }
+    
+    // 纹理：GL资源须在GPU线程释放
+    if (mTexturePool) {
+        auto releaseTextures = [this, releaseAll, &textureBytes, &captureTextures]() {
+            if (captureTextures) {
+                // 拍照纹理只在拍照时才用，任何等级都整池释放
+                textureBytes += captureTextures->trim(0);
+            }
+            if (releaseAll) {
+                textureBytes += mTexturePool->trim(0);
+                // 已删除节点遗留的管线状态一并释放（仍被节点引用的保留）
+                if (mGpuResources) {
+                    mGpuResources->trim();
+                }
+            } else {
+                size_t before = mTexturePool->getMemoryUsage();
+                mTexturePool->cleanup();
+                size_t after = mTexturePool->getMemoryUsage();
+                textureBytes += before > after ? before - after : 0;
+            }
+        };
+        if (mExecutor) {
+            mExecutor->runOnGPUQueue(releaseTextures);
+        } else {
+            releaseTextures();
+        }
+    }
+    
+    bufferBytes = releaseAll ? BufferPool::shared().trim(0)
+                             : BufferPool::shared().trimIdle(std::chrono::milliseconds(1000));
+    
+    if (releaseAll) {
+        if (mFramePacketPool) {
+            packetBytes = mFramePacketPool->trim(0) * sizeof(FramePacket);
+        }
+        if (mExecutor) {
+            arenaBytes = mExecutor->trimIdleMemory();
+        }
+    }
+    
+    // 降级：CPU处理分辨率减半（只降一次，恢复时还原）
+    if (level == MemoryPressureLevel::Critical && getConfig().degradeOnMemoryPressure) {
+        for (const auto& entity : mGraph->getAllEntities()) {
+            auto* cpuEntity = dynamic_cast<CPUEntity*>(entity.get());
+            if (!cpuEntity || mPressureScaleBackup.count(entity->getId())) {
+                continue;
+            }
+            float scale = cpuEntity->getProcessingScale();
+            mPressureScaleBackup[entity->getId()] = scale;
+            cpuEntity->setProcessingScale(std::min(scale, 0.5f));
+        }
+    }
+    
+    size_t total = textureBytes + bufferBytes + packetBytes + arenaBytes;
+    PIPELINE_LOGI("Memory pressure %d: reclaimed %zu bytes (texture %zu, buffer %zu, packet %zu, arena %zu)",
+                  static_cast<int>(level), total, textureBytes, bufferBytes, packetBytes, arenaBytes);
+    return total;
+}
+
+void PipelineManager::recoverFromMemoryPressure() {
+    for (const auto& [id, scale] : mPressureScaleBackup) {
+        auto entity = mGraph->getEntity(id);
+        if (auto* cpuEntity = dynamic_cast<CPUEntity*>(entity.get())) {
+            cpuEntity->setProcessingScale(scale);
+        }
+    }
+    mPressureScaleBackup.clear();
+}
+
+// =============================================================================
+// 自适应质量
+// =============================================================================
+
+void PipelineManager::applyQualitySettings(const QualitySettings& settings) {
+    std::lock_guard<std::mutex> lock(mQualityMutex);
+    mQualitySettings = std::make_unique<QualitySettings>(settings);
+    
+    if (mExecutor) {
+        mExecutor->setProxyRenderScale(getConfig().previewRenderScale * settings.renderScale);
+    }
+    if (mGraph) {
+        for (const auto& entity : mGraph->getAllEntities()) {
+            entity->onQualityChanged(settings);
+        }
+    }
+    PIPELINE_LOGI("Quality settings applied: level %u, render scale %.2f, detection every %u frames",
+                  static_cast<unsigned>(settings.level), settings.renderScale, settings.detectionInterval);
+}
+
+void PipelineManager::enableAdaptiveQuality(QualityLevel ceiling, const QualityControllerConfig& config) {
+    disableAdaptiveQuality();
+    
+    auto controller = std::make_shared<QualityController>(ceiling, config);
+    
+    // 温控回调只持有控制器弱引用，关闭后迟到的回调直接丢弃
+    auto monitor = createPlatformThermalMonitor();
+    std::weak_ptr<QualityController> weakController = controller;
+    if (monitor && !monitor->start([weakController](ThermalState state) {
+            if (auto target = weakController.lock()) {
+                target->onThermalState(state);
+            }
+        })) {
+        monitor.reset();
+    }
+    if (!monitor) {
+        PIPELINE_LOGI("Platform thermal monitor unavailable, relying on frame timing and onThermalStateChanged()");
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mQualityMutex);
+        mQualityController = controller;
+        mThermalMonitor = std::move(monitor);
+    }
+    applyQualitySettings(controller->getSettings());
+    installFrameCompleteCallback();
+}
+
+void PipelineManager::disableAdaptiveQuality() {
+    std::unique_ptr<ThermalMonitor> monitor;
+    {
+        std::lock_guard<std::mutex> lock(mQualityMutex);
+        if (!mQualityController) {
+            return;
+        }
+        mQualityController.reset();
+        monitor = std::move(mThermalMonitor);
+    }
+    // 在锁外停止，平台回调线程不会与这里互相等待
+    if (monitor) {
+        monitor->stop();
+    }
+    installFrameCompleteCallback();
+}
+
+void PipelineManager::onThermalStateChanged(ThermalState state) {
+    if (auto controller = getQualityController()) {
+        controller->onThermalState(state);
+    }
+}
+
+QualityControllerPtr PipelineManager::getQualityController() const {
+    std::lock_guard<std::mutex> lock(mQualityMutex);
+    return mQualityController;
+}
+
 // =============================================================================
 // 统计和调试
 // =============================================================================
@@ -819,6 +1627,84 @@ void PipelineManager::resetStats() {
     }
 }
 
+std::optional<EntityStats> PipelineManager::getEntityStats(EntityId entityId) const {
+    if (!mExecutor) {
+        return std::nullopt;
+    }
+    return mExecutor->getEntityStats(entityId);
+}
+
+ProfilingSnapshot PipelineManager::getProfilingSnapshot() const {
+    if (!mExecutor) {
+        return ProfilingSnapshot();
+    }
+    return mExecutor->getProfilingSnapshot();
+}
+
+void PipelineManager::registerMetricCollectors() {
+    if (mMetricsCollectorId != MetricsRegistry::kInvalidCollectorId) {
+        return;
+    }
+    // destroy() 先移除采集器再释放组件，这里直接捕获 this
+    mMetricsCollectorId = mMetrics.addCollector([this](MetricsSnapshot& snapshot) {
+        if (mExecutor) {
+            ExecutionStats stats = mExecutor->getStats();
+            snapshot.addCounter("executor.frames.total", stats.totalFrames);
+            snapshot.addCounter("executor.frames.dropped", stats.droppedFrames);
+            snapshot.addCounter("executor.frames.dropped.deadline", stats.deadlineDroppedFrames);
+            snapshot.addCounter("executor.frames.dropped.input", stats.inputDroppedFrames);
+            snapshot.addCounter("executor.frames.degraded", stats.degradedFrames);
+            snapshot.addCounter("executor.frames.proxy", stats.proxyFrames);
+            snapshot.addGauge("executor.frame_time_us.avg", static_cast<double>(stats.averageFrameTime));
+            snapshot.addGauge("executor.frame_time_us.peak", static_cast<double>(stats.peakFrameTime));
+            snapshot.addGauge("executor.frame_time_us.last", static_cast<double>(stats.lastFrameTime));
+            snapshot.addGauge("executor.predicted_latency_us", static_cast<double>(stats.lastPredictedLatency));
+            snapshot.addCounter("executor.queue_time_us.gpu", stats.gpuQueueTime);
+            snapshot.addCounter("executor.queue_time_us.cpu", stats.cpuQueueTime);
+            snapshot.addCounter("executor.queue_time_us.io", stats.ioQueueTime);
+            snapshot.addGauge("executor.frames.pending", mExecutor->getPendingFrameCount());
+            snapshot.addGauge("executor.frames.in_flight", mExecutor->getInFlightFrameCount());
+        }
+        
+        if (auto* input = getInputEntity()) {
+            snapshot.addGauge("input.queue_depth", static_cast<double>(input->getPendingInputCount()));
+            snapshot.addCounter("input.frames.dropped", input->getDroppedFrameCount());
+            snapshot.addCounter("input.frames.rate_limited", input->getRateLimitedFrameCount());
+        }
+        
+        if (mFramePacketPool) {
+            snapshot.addGauge("frame_packet_pool.available", static_cast<double>(mFramePacketPool->getAvailableCount()));
+            snapshot.addGauge("frame_packet_pool.in_use", static_cast<double>(mFramePacketPool->getInUseCount()));
+            snapshot.addGauge("frame_packet_pool.created", mFramePacketPool->getCreatedCount());
+            snapshot.addCounter("frame_packet_pool.blocks", mFramePacketPool->getBlockCount());
+            snapshot.addCounter("frame_packet_pool.timeouts", mFramePacketPool->getTimeoutCount());
+        }
+        
+        if (mTexturePool) {
+            snapshot.addGauge("texture_pool.hit_rate", mTexturePool->getHitRate());
+            snapshot.addGauge("texture_pool.in_use", static_cast<double>(mTexturePool->getInUseCount()));
+            snapshot.addGauge("texture_pool.available", static_cast<double>(mTexturePool->getAvailableCount()));
+            snapshot.addGauge("texture_pool.memory_bytes", static_cast<double>(mTexturePool->getMemoryUsage()));
+            snapshot.addCounter("texture_pool.quota_rejects", mTexturePool->getQuotaRejectCount());
+        }
+        
+        if (auto* output = getOutputEntity()) {
+            snapshot.addCounter("output.frames", output->getOutputFrameCount());
+            snapshot.addCounter("output.frames.dropped", output->getDroppedFrameCount());
+            for (const auto& [name, stats] : output->getAllTargetStats()) {
+                const std::string prefix = "output.target." + name;
+                snapshot.addCounter(prefix + ".delivered", stats.delivered);
+                snapshot.addCounter(prefix + ".dropped", stats.dropped);
+                snapshot.addGauge(prefix + ".queue_depth", static_cast<double>(stats.queued));
+                snapshot.addGauge(prefix + ".latency_us.p50", static_cast<double>(stats.latencyUs.p50));
+                snapshot.addGauge(prefix + ".latency_us.p95", static_cast<double>(stats.latencyUs.p95));
+                snapshot.addGauge(prefix + ".latency_us.p99", static_cast<double>(stats.latencyUs.p99));
+                snapshot.addGauge(prefix + ".latency_us.max", static_cast<double>(stats.latencyUs.max));
+            }
+        }
+    });
+}
+
 std::string PipelineManager::exportGraphToDot() const {
     if (!mGraph) {
         return "";
@@ -842,8 +1728,25 @@ bool PipelineManager::createResourcePools() {
     TexturePoolConfig textureConfig;
     textureConfig.maxTexturesPerBucket = 4;
     textureConfig.maxTotalTextures = getConfig().texturePoolSize;
-    
-    mTexturePool = std::make_shared<TexturePool>(mRenderContext, textureConfig);
+    textureConfig.maxBytes = getConfig().texturePoolMaxBytes;
+    
+    mTexturePool.reset();
+    if (getConfig().shareResources && mRenderContext) {
+        // 同一上下文的管线共用纹理池：本管线持有视图，按配额统计在用纹理
+        if (!mResourceLease) {
+            ResourceQuota quota;
+            quota.textureBytes = getConfig().sharedTextureQuotaBytes;
+            mResourceLease = ResourceHub::shared().attach(mRenderContext, getConfig().name,
+                                                          textureConfig, quota, true);
+        }
+        if (mResourceLease) {
+            mTexturePool = mResourceLease->getTexturePool();
+            mGpuResources = mResourceLease->getGpuResources();
+        }
+    }
+    if (!mTexturePool) {
+        mTexturePool = std::make_shared<TexturePool>(mRenderContext, textureConfig);
+    }
     
     // 创建帧包池
     FramePacketPoolConfig packetConfig;
@@ -854,9 +1757,33 @@ bool PipelineManager::createResourcePools() {
     mFramePacketPool = std::make_shared<FramePacketPool>(packetConfig);
     mFramePacketPool->preallocate();
     
+    // 异步读回：暂存资源在首次读回时于GPU线程创建
+    if (getConfig().enableAsyncReadback) {
+        uint32_t ringSize = std::max<uint32_t>(getConfig().readbackRingSize, 1);
+        if (auto backend = AsyncReadbackService::createPlatformBackend(ringSize)) {
+            mReadbackService = std::make_shared<AsyncReadbackService>(std::move(backend), ringSize);
+        } else {
+            PIPELINE_LOGW("Async readback not supported on this platform");
+        }
+    }
+    
+    // GPU共享资源表：图重建（节点重新 prepare）时沿用同一组顶点缓冲和管线状态
+    if (!mGpuResources) {
+        mGpuResources = std::make_shared<GpuResourceRegistry>(mRenderContext);
+    }
+    
+    // CPU帧缓冲使用进程共享的缓冲池，只放宽不收紧（可能有多个管线共用）
+    BufferPoolConfig bufferConfig = BufferPool::shared().getConfig();
+    if (getConfig().bufferPoolSize > bufferConfig.maxBuffersPerClass) {
+        bufferConfig.maxBuffersPerClass = getConfig().bufferPoolSize;
+        BufferPool::shared().setConfig(bufferConfig);
+    }
+    
     // 设置到上下文
     mContext->setTexturePool(mTexturePool);
     mContext->setFramePacketPool(mFramePacketPool);
+    mContext->setReadbackService(mReadbackService);
+    mContext->setGpuResourceRegistry(mGpuResources);
     
     return true;
 }
@@ -870,18 +1797,211 @@ void PipelineManager::setState(PipelineState state) {
     }
 }
 
+// =============================================================================
+// 启动
+// =============================================================================
+
+bool PipelineManager::loadEntityResources() {
+    for (auto& entity : mGraph->getAllEntities()) {
+        if (entity && !entity->loadResources()) {
+            PIPELINE_LOGE("Failed to load resources for entity %llu", entity->getId());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PipelineManager::runStagedStartup() {
+    std::weak_ptr<PipelineManager> weakSelf = weak_from_this();
+    
+    // 着色器编译在GPU队列上执行：必需路径排在首帧任务之前，可降级节点留到首帧完成之后
+    if (mTexturePool && mWarmedGraphVersion != mGraph->getVersion()) {
+        mWarmedGraphVersion = mGraph->getVersion();
+        std::shared_ptr<PipelineGraph> snapshot = mGraph->clone();
+        {
+            std::lock_guard<std::mutex> lock(mStartupMutex);
+            mDeferredWarmupGraph = snapshot;
+        }
+        mExecutor->postToGPUQueue([weakSelf, snapshot]() {
+            if (auto self = weakSelf.lock()) {
+                self->warmupGraph(*snapshot, WarmupScope::Required);
+            }
+        });
+    }
+    
+    // 资源加载在CPU队列上并行：必需Entity先投递，其余随后在后台加载
+    std::vector<ProcessEntityPtr> required;
+    std::vector<ProcessEntityPtr> deferred;
+    for (auto& entity : mGraph->getAllEntities()) {
+        if (!entity) {
+            continue;
+        }
+        entity->markResourcesPending();
+        if (entity->isEnabled() && !entity->isOptional()) {
+            required.push_back(entity);
+        } else {
+            deferred.push_back(entity);
+        }
+    }
+    
+    std::vector<std::future<bool>> results;
+    results.reserve(required.size());
+    for (auto& entity : required) {
+        auto promise = std::make_shared<std::promise<bool>>();
+        results.push_back(promise->get_future());
+        mExecutor->postToCPUQueue([entity, promise]() {
+            promise->set_value(entity->loadResources());
+        });
+    }
+    for (auto& entity : deferred) {
+        mExecutor->postToCPUQueue([entity]() {
+            if (entity->loadResources()) {
+                PIPELINE_LOGI("Entity %s resources ready, joining the pipeline", entity->getName().c_str());
+            } else {
+                PIPELINE_LOGW("Entity %s stays bypassed: resources failed to load", entity->getName().c_str());
+            }
+        });
+    }
+    
+    bool success = true;
+    for (auto& result : results) {
+        success = result.get() && success;
+    }
+    if (success) {
+        PIPELINE_LOGI("Required path ready after %lld us (%zu entities loading in background)",
+                      static_cast<long long>(QualityController::nowUs() - mStartTimeUs.load()),
+                      deferred.size());
+    }
+    return success;
+}
+
+void PipelineManager::reportFirstFrame() {
+    if (mFirstFrameReported.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    int64_t startupUs = QualityController::nowUs() - mStartTimeUs.load();
+    mMetrics.gauge("startup.first_frame_us").set(static_cast<double>(startupUs));
+    PIPELINE_LOGI("First frame ready %lld us after start()", static_cast<long long>(startupUs));
+    
+    std::function<void(int64_t)> callback;
+    std::shared_ptr<PipelineGraph> deferredWarmup;
+    {
+        std::lock_guard<std::mutex> lock(mStartupMutex);
+        callback = mFirstFrameCallback;
+        deferredWarmup = std::move(mDeferredWarmupGraph);
+    }
+    
+    // 必需路径已出帧，可降级节点的着色器在帧间隙编译，不再推迟首帧
+    if (deferredWarmup && mExecutor) {
+        std::weak_ptr<PipelineManager> weakSelf = weak_from_this();
+        mExecutor->postToGPUQueue([weakSelf, deferredWarmup]() {
+            if (auto self = weakSelf.lock()) {
+                self->warmupGraph(*deferredWarmup, WarmupScope::Optional);
+            }
+        });
+    }
+    
+    if (callback) {
+        callback(startupUs);
+    }
+}
+
+// =============================================================================
+// GPU资源预热
+// =============================================================================
+
 bool PipelineManager::initializeGPUResources() {
-    // 预热纹理池（常用尺寸）
-    if (mTexturePool) {
+    if (!mTexturePool || mWarmedGraphVersion == mGraph->getVersion()) {
+        return true;
+    }
+    mWarmedGraphVersion = mGraph->getVersion();
+    warmupGraph(*mGraph);
+    return true;
+}
+
+void PipelineManager::warmupGraph(const PipelineGraph& graph, WarmupScope scope) {
+    // 按拓扑序传播尺寸：源Entity取输入配置，其余取首个上游的输出尺寸
+    uint32_t inputWidth = 0;
+    uint32_t inputHeight = 0;
+    if (auto* inputEntity = getInputEntity()) {
+        inputWidth = inputEntity->getInputConfig().width;
+        inputHeight = inputEntity->getInputConfig().height;
+    }
+    
+    std::unordered_map<EntityId, std::pair<uint32_t, uint32_t>> sizes;
+    std::unordered_map<TextureSpec, uint32_t, TextureSpecHash> demand;
+    for (EntityId id : graph.getTopologicalOrder()) {
+        auto entity = graph.getEntity(id);
+        if (!entity) {
+            continue;
+        }
+        
+        auto size = std::make_pair(inputWidth, inputHeight);
+        auto upstream = graph.getUpstreamEntities(id);
+        if (!upstream.empty()) {
+            auto it = sizes.find(upstream.front());
+            size = it != sizes.end() ? it->second : std::make_pair(0u, 0u);
+        }
+        
+        // 禁用的节点不执行，不为其分配FBO和输出纹理，尺寸原样传给下游
+        if (!entity->isEnabled()) {
+            sizes[id] = size;
+            continue;
+        }
+        
+        if (auto* gpuEntity = dynamic_cast<GPUEntity*>(entity.get())) {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            gpuEntity->resolveOutputSize(size.first, size.second, width, height);
+            bool inScope = scope == WarmupScope::All ||
+                           entity->isOptional() == (scope == WarmupScope::Optional);
+            if (inScope && width > 0 && height > 0) {
+                demand[TextureSpec{width, height, gpuEntity->getEffectiveOutputFormat()}]++;
+            }
+            if (inScope && !gpuEntity->warmupResources(*mContext, width, height)) {
+                PIPELINE_LOGW("Failed to warm up GPU resources for entity %llu", id);
+            }
+            // 直接下游有CPU节点时才需要读回；有不在GPU队列上执行的节点时才需要栅栏
+            bool feedsCPU = false;
+            bool feedsOffQueue = false;
+            for (EntityId downstream : graph.getDownstreamEntities(id)) {
+                auto next = graph.getEntity(downstream);
+                if (!next) {
+                    continue;
+                }
+                feedsCPU = feedsCPU || next->getType() == EntityType::CPU;
+                feedsOffQueue = feedsOffQueue || next->getExecutionQueue() != ExecutionQueue::GPU;
+            }
+            if (mReadbackService) {
+                gpuEntity->setAsyncReadback(feedsCPU);
+            }
+            gpuEntity->setSignalFence(getConfig().enableGpuFences && feedsOffQueue);
+            size = {width, height};
+        }
+        sizes[id] = size;
+    }
+    
+    if (demand.empty()) {
+        if (scope == WarmupScope::Optional) {
+            return;
+        }
+        // 尺寸未知（输入尺寸在首帧才确定）：预热常用尺寸
         std::vector<TextureSpec> specs = {
             {1920, 1080, PixelFormat::RGBA8},
             {1280, 720, PixelFormat::RGBA8},
             {640, 480, PixelFormat::RGBA8}
         };
         mTexturePool->warmup(specs);
+        return;
     }
     
-    return true;
+    // 中间结果用完即归还，同规格的一条链每个在途帧至多同时占用两张
+    uint32_t frames = std::max<uint32_t>(1, getConfig().maxConcurrentFrames);
+    for (const auto& [spec, users] : demand) {
+        uint32_t count = std::min<uint32_t>(users, 2) * frames;
+        mTexturePool->warmup(spec.width, spec.height, spec.format, count);
+        PIPELINE_LOGI("Warmed texture pool: %ux%u x%u", spec.width, spec.height, count);
+    }
 }
 
 } // namespace pipeline
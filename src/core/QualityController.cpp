@@ -0,0 +1,187 @@
+/**
+ * @file QualityController.cpp
+ * @brief QualityController实现
+ */
+
+#include "pipeline/core/QualityController.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace pipeline {
+
+namespace {
+
+// QualityLevel 取值：Low / Medium / High / Ultra
+constexpr uint8_t kLevelLow = 0;
+constexpr uint8_t kLevelMedium = 1;
+constexpr uint8_t kLevelUltra = 3;
+
+const char* kThermalNames[] = {"Nominal", "Fair", "Serious", "Critical"};
+
+} // anonymous namespace
+
+#if !defined(__ANDROID__) && !defined(__APPLE__)
+std::unique_ptr<ThermalMonitor> createPlatformThermalMonitor() {
+    return nullptr;
+}
+#endif
+
+// =============================================================================
+// 档位参数
+// =============================================================================
+
+QualitySettings QualityController::settingsFor(QualityLevel level) {
+    QualitySettings settings;
+    settings.level = std::min(static_cast<uint8_t>(level), kLevelUltra);
+    switch (settings.level) {
+        case kLevelLow:
+            settings.renderScale = 0.5f;
+            settings.blurRadiusScale = 0.5f;
+            settings.detectionInterval = 3;
+            settings.highPrecisionLut = false;
+            break;
+        case kLevelMedium:
+            settings.renderScale = 0.75f;
+            settings.blurRadiusScale = 0.75f;
+            settings.detectionInterval = 2;
+            settings.highPrecisionLut = false;
+            break;
+        default:
+            // High / Ultra：全分辨率、逐帧检测
+            break;
+    }
+    return settings;
+}
+
+// =============================================================================
+// 构造与状态
+// =============================================================================
+
+QualityController::QualityController(QualityLevel ceiling, const QualityControllerConfig& config)
+    : mConfig(config)
+    , mCeiling(std::min(static_cast<uint8_t>(ceiling), kLevelUltra))
+    , mLevel(mCeiling) {
+}
+
+void QualityController::setCeiling(QualityLevel ceiling) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCeiling = std::min(static_cast<uint8_t>(ceiling), kLevelUltra);
+    if (mLevel.load(std::memory_order_relaxed) > mCeiling) {
+        mLevel.store(mCeiling, std::memory_order_relaxed);
+        mPendingApply.store(true, std::memory_order_release);
+    }
+}
+
+void QualityController::onThermalState(ThermalState state) {
+    const ThermalState previous = mThermalState.exchange(state, std::memory_order_relaxed);
+    if (previous != state) {
+        // 上限在每次 evaluate 时检查，升温不等评估窗口即可生效
+        PIPELINE_LOGI("Thermal state %s -> %s",
+                      kThermalNames[static_cast<size_t>(previous)],
+                      kThermalNames[static_cast<size_t>(state)]);
+    }
+}
+
+QualityLevel QualityController::getLevel() const {
+    return static_cast<QualityLevel>(mLevel.load(std::memory_order_relaxed));
+}
+
+int64_t QualityController::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint8_t QualityController::thermalCapLocked() const {
+    switch (mThermalState.load(std::memory_order_relaxed)) {
+        case ThermalState::Critical:
+            return kLevelLow;
+        case ThermalState::Serious:
+            return std::min(mCeiling, kLevelMedium);
+        default:
+            return mCeiling;
+    }
+}
+
+// =============================================================================
+// 评估
+// =============================================================================
+
+bool QualityController::evaluate(const ExecutionStats& stats, int64_t nowUs) {
+    const bool pendingApply = mPendingApply.exchange(false, std::memory_order_acq_rel);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const uint8_t level = mLevel.load(std::memory_order_relaxed);
+    const uint8_t cap = thermalCapLocked();
+
+    // 温控上限低于当前档位：立即降到上限，并重新开始计窗
+    if (level > cap) {
+        mLevel.store(cap, std::memory_order_relaxed);
+        mLastChangeUs = nowUs;
+        mWindowStarted = false;
+        mOverloadedWindows = 0;
+        mHeadroomWindows = 0;
+        PIPELINE_LOGI("Quality capped by thermal state: %u -> %u",
+                      static_cast<unsigned>(level), static_cast<unsigned>(cap));
+        return true;
+    }
+
+    if (!mWindowStarted) {
+        mWindowStarted = true;
+        mWindowStartUs = nowUs;
+        mWindowTotalFrames = stats.totalFrames;
+        mWindowDroppedFrames = stats.droppedFrames;
+        return pendingApply;
+    }
+    if (nowUs - mWindowStartUs < mConfig.evaluationIntervalUs) {
+        return pendingApply;
+    }
+
+    // 一个窗口结束：帧耗时取执行器的滑动平均，丢帧率按窗口内增量计算
+    const uint64_t frames = stats.totalFrames - mWindowTotalFrames;
+    const uint64_t dropped = stats.droppedFrames - mWindowDroppedFrames;
+    const uint64_t offered = frames + dropped;
+    const float dropRatio = offered > 0 ? static_cast<float>(dropped) / static_cast<float>(offered) : 0.0f;
+    const float load = mConfig.frameBudgetUs > 0
+        ? static_cast<float>(stats.averageFrameTime) / static_cast<float>(mConfig.frameBudgetUs)
+        : 0.0f;
+
+    mWindowStartUs = nowUs;
+    mWindowTotalFrames = stats.totalFrames;
+    mWindowDroppedFrames = stats.droppedFrames;
+
+    if (offered == 0) {
+        // 空闲窗口不提供负载信息
+        return pendingApply;
+    }
+
+    const bool overloaded = load > mConfig.downgradeLoad || dropRatio > mConfig.downgradeDropRatio;
+    const bool headroom = load < mConfig.upgradeLoad && dropped == 0;
+    mOverloadedWindows = overloaded ? mOverloadedWindows + 1 : 0;
+    mHeadroomWindows = headroom ? mHeadroomWindows + 1 : 0;
+
+    if (nowUs - mLastChangeUs < mConfig.minDwellUs) {
+        return pendingApply;
+    }
+
+    uint8_t next = level;
+    if (mOverloadedWindows >= mConfig.downgradeWindows && level > kLevelLow) {
+        next = level - 1;
+    } else if (mHeadroomWindows >= mConfig.upgradeWindows && level < cap) {
+        next = level + 1;
+    }
+    if (next == level) {
+        return pendingApply;
+    }
+
+    mLevel.store(next, std::memory_order_relaxed);
+    mLastChangeUs = nowUs;
+    mOverloadedWindows = 0;
+    mHeadroomWindows = 0;
+    PIPELINE_LOGI("Adaptive quality %u -> %u (load %.2f, drop %.3f)",
+                  static_cast<unsigned>(level), static_cast<unsigned>(next), load, dropRatio);
+    return true;
+}
+
+} // namespace pipeline
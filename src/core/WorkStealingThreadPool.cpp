@@ -0,0 +1,365 @@
+/**
+ * @file WorkStealingThreadPool.cpp
+ * @brief WorkStealingThreadPool实现
+ */
+
+#include "pipeline/core/WorkStealingThreadPool.h"
+#include "pipeline/utils/PipelineLog.h"
+#include "pipeline/utils/PipelineTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#include <pthread.h>
+#define PIPELINE_HAS_CPU_AFFINITY 1
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace pipeline {
+
+// =============================================================================
+// 内部状态
+// =============================================================================
+
+struct WorkStealingThreadPool::State {
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> pendingTasks{0};    // 已提交未取出的任务数
+    std::atomic<uint32_t> nextWorker{0};      // 外部提交的轮询游标
+    std::atomic<uint64_t> stealCount{0};
+
+    // 空闲等待
+    std::mutex idleMutex;
+    std::condition_variable idleCond;
+
+    bool popLocal(uint32_t index, Task& task) {
+        auto& worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(uint32_t thief, Task& task) {
+        const size_t count = workers.size();
+        for (size_t k = 1; k < count; ++k) {
+            auto& victim = *workers[(thief + k) % count];
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || victim.tasks.empty()) {
+                continue;
+            }
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stealCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void notifyOne() {
+        // 加锁再通知，避免与等待方的检查交错导致唤醒丢失
+        { std::lock_guard<std::mutex> lock(idleMutex); }
+        idleCond.notify_one();
+    }
+};
+
+namespace {
+
+// 当前线程所属的线程池状态与工作线程索引
+thread_local const void* tCurrentPool = nullptr;
+thread_local uint32_t tWorkerIndex = 0;
+
+#ifdef PIPELINE_HAS_CPU_AFFINITY
+bool pinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    // pid 0 表示调用线程
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+#endif
+
+void setCurrentThreadName(const std::string& name) {
+#if defined(__linux__) || defined(__ANDROID__)
+    // Linux 线程名最长15字符
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(name.c_str());
+#else
+    (void)name;
+#endif
+}
+
+} // namespace
+
+// =============================================================================
+// WorkStealingThreadPool
+// =============================================================================
+
+WorkStealingThreadPool::WorkStealingThreadPool(const WorkStealingPoolConfig& config)
+    : mConfig(config)
+{
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    stop();
+}
+
+bool WorkStealingThreadPool::start() {
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    if (mState && mState->running.load()) {
+        return true;
+    }
+
+    std::vector<int> affinity;
+    if (mConfig.pinToBigCores) {
+#ifdef PIPELINE_HAS_CPU_AFFINITY
+        affinity = detectBigCores();
+        if (affinity.empty()) {
+            PIPELINE_LOGI("WorkStealingThreadPool: no big.LITTLE topology detected, not pinning");
+        }
+#else
+        PIPELINE_LOGW("WorkStealingThreadPool: CPU affinity not supported on this platform");
+#endif
+    }
+
+    uint32_t threadCount = mConfig.threadCount;
+    if (threadCount == 0) {
+        if (!affinity.empty()) {
+            threadCount = static_cast<uint32_t>(affinity.size());
+        } else {
+            // 预留一个核心给GPU线程
+            uint32_t hw = std::thread::hardware_concurrency();
+            threadCount = hw > 1 ? hw - 1 : 1;
+        }
+    }
+
+    auto state = std::make_shared<State>();
+    state->workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        state->workers.push_back(std::make_unique<State::Worker>());
+    }
+    state->running.store(true);
+
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        std::string name = mConfig.label + "." + std::to_string(i);
+        mThreads.emplace_back(&WorkStealingThreadPool::workerLoop, state, i, affinity, name);
+    }
+    mState = std::move(state);
+
+    PIPELINE_LOGI("WorkStealingThreadPool started with %u threads (%zu pinned cores)",
+                  threadCount, affinity.size());
+    return true;
+}
+
+void WorkStealingThreadPool::stop() {
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    if (!mState || !mState->running.load()) {
+        return;
+    }
+
+    mState->running.store(false);
+    {
+        std::lock_guard<std::mutex> idleLock(mState->idleMutex);
+    }
+    mState->idleCond.notify_all();
+
+    for (auto& thread : mThreads) {
+        if (!thread.joinable()) {
+            continue;
+        }
+        if (thread.get_id() == std::this_thread::get_id()) {
+            // 在工作线程内停止（例如最后一个引用在任务中释放），不能 join 自身
+            thread.detach();
+        } else {
+            thread.join();
+        }
+    }
+    mThreads.clear();
+
+    // 丢弃未执行的任务（移出后在工作队列锁外析构，任务捕获的对象可能较重）
+    // mState 保留到下次 start 或析构，使并发的 submit 安全地返回 false
+    std::deque<Task> discarded;
+    for (auto& worker : mState->workers) {
+        std::lock_guard<std::mutex> workerLock(worker->mutex);
+        std::move(worker->tasks.begin(), worker->tasks.end(), std::back_inserter(discarded));
+        worker->tasks.clear();
+    }
+    mState->pendingTasks.store(0);
+    discarded.clear();
+}
+
+bool WorkStealingThreadPool::isRunning() const {
+    auto state = mState;
+    return state && state->running.load();
+}
+
+bool WorkStealingThreadPool::submit(Task task) {
+    State* state = mState.get();
+    if (!state || !state->running.load(std::memory_order_acquire) || !task) {
+        return false;
+    }
+
+    // 工作线程内提交：压入本地队列；外部提交：轮询分配
+    uint32_t index = tCurrentPool == state
+        ? tWorkerIndex
+        : state->nextWorker.fetch_add(1, std::memory_order_relaxed) %
+              static_cast<uint32_t>(state->workers.size());
+    // 先计数再入队：取出方的递减不会早于这里的递增
+    state->pendingTasks.fetch_add(1, std::memory_order_release);
+    {
+        auto& worker = *state->workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    state->notifyOne();
+    return true;
+}
+
+void WorkStealingThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    uint32_t helpers = std::min<uint32_t>(count - 1, getThreadCount());
+    if (helpers == 0 || !isRunning()) {
+        for (uint32_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // 分片由调用方与辅助任务按原子游标领取；辅助任务可能晚于返回才被执行，
+    // 此时游标已耗尽，不会再访问 body
+    struct Shared {
+        std::atomic<uint32_t> next{0};
+        std::atomic<uint32_t> done{0};
+        uint32_t count = 0;
+        const std::function<void(uint32_t)>* body = nullptr;
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        void run() {
+            for (uint32_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = next.fetch_add(1, std::memory_order_relaxed)) {
+                (*body)(i);
+                if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                    { std::lock_guard<std::mutex> lock(mutex); }
+                    cond.notify_all();
+                }
+            }
+        }
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->count = count;
+    shared->body = &body;
+
+    for (uint32_t i = 0; i < helpers; ++i) {
+        if (!submit([shared]() { shared->run(); })) {
+            break;
+        }
+    }
+    shared->run();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->cond.wait(lock, [&shared]() {
+        return shared->done.load(std::memory_order_acquire) == shared->count;
+    });
+}
+
+bool WorkStealingThreadPool::isWorkerThread() const {
+    return tCurrentPool != nullptr && tCurrentPool == mState.get();
+}
+
+uint64_t WorkStealingThreadPool::getStealCount() const {
+    auto state = mState;
+    return state ? state->stealCount.load(std::memory_order_relaxed) : 0;
+}
+
+std::vector<int> WorkStealingThreadPool::detectBigCores() {
+    std::vector<int> bigCores;
+#ifdef PIPELINE_HAS_CPU_AFFINITY
+    std::vector<std::pair<int, long>> freqs;
+    const int cpuCount = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < cpuCount; ++cpu) {
+        char path[128];
+        std::snprintf(path, sizeof(path),
+                      "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+        FILE* file = std::fopen(path, "r");
+        if (!file) {
+            continue;
+        }
+        long freq = 0;
+        if (std::fscanf(file, "%ld", &freq) == 1 && freq > 0) {
+            freqs.emplace_back(cpu, freq);
+        }
+        std::fclose(file);
+    }
+
+    if (freqs.empty()) {
+        return bigCores;
+    }
+
+    auto [minIt, maxIt] = std::minmax_element(freqs.begin(), freqs.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; });
+    if (minIt->second == maxIt->second) {
+        // 对称多核，无需绑定
+        return bigCores;
+    }
+
+    const long maxFreq = maxIt->second;
+    for (const auto& entry : freqs) {
+        if (entry.second == maxFreq) {
+            bigCores.push_back(entry.first);
+        }
+    }
+#endif
+    return bigCores;
+}
+
+void WorkStealingThreadPool::workerLoop(std::shared_ptr<State> state, uint32_t index,
+                                        std::vector<int> affinity, std::string name) {
+    tCurrentPool = state.get();
+    tWorkerIndex = index;
+    setCurrentThreadName(name);
+    PipelineTrace::setThreadName(name);
+
+#ifdef PIPELINE_HAS_CPU_AFFINITY
+    if (!affinity.empty() && !pinCurrentThread(affinity)) {
+        PIPELINE_LOGW("WorkStealingThreadPool: failed to pin worker %u", index);
+    }
+#endif
+
+    while (state->running.load(std::memory_order_acquire)) {
+        Task task;
+        if (state->popLocal(index, task) || state->steal(index, task)) {
+            state->pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(state->idleMutex);
+        state->idleCond.wait(lock, [&state]() {
+            return !state->running.load(std::memory_order_acquire) ||
+                   state->pendingTasks.load(std::memory_order_acquire) > 0;
+        });
+    }
+
+    tCurrentPool = nullptr;
+}
+
+} // namespace pipeline
@@ -0,0 +1,396 @@
+/**
+ * @file AsyncReadback.cpp
+ * @brief AsyncReadbackService实现
+ */
+
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/data/GpuCommandContext.h"
+#include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace pipeline {
+
+// =============================================================================
+// ReadbackRequest
+// =============================================================================
+
+bool ReadbackRequest::wait(uint32_t timeoutMs) {
+    if (!isReady() && mFlush) {
+        mFlush();
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto ready = [this]() { return mState.load(std::memory_order_acquire) != State::Pending; };
+    if (timeoutMs == 0) {
+        mCond.wait(lock, ready);
+    } else if (!mCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+        return false;
+    }
+    return mState.load(std::memory_order_acquire) == State::Ready;
+}
+
+void ReadbackRequest::whenReady(std::function<void()> callback) {
+    if (!callback) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mState.load(std::memory_order_acquire) == State::Pending) {
+            mReadyCallback = std::move(callback);
+            callback = nullptr;
+        }
+    }
+    if (callback) {
+        callback();
+    } else if (mFlush) {
+        mFlush();
+    }
+}
+
+std::shared_ptr<uint8_t> ReadbackRequest::getBuffer() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBuffer;
+}
+
+void ReadbackRequest::complete(std::shared_ptr<uint8_t> buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBuffer = std::move(buffer);
+        mState.store(State::Ready, std::memory_order_release);
+    }
+    mCond.notify_all();
+    notifyReady();
+}
+
+void ReadbackRequest::fail() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mState.store(State::Failed, std::memory_order_release);
+    }
+    mCond.notify_all();
+    notifyReady();
+}
+
+void ReadbackRequest::notifyReady() {
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        callback.swap(mReadyCallback);
+    }
+    if (callback) {
+        callback();
+    }
+}
+
+// =============================================================================
+// AsyncReadbackService
+// =============================================================================
+
+AsyncReadbackService::AsyncReadbackService(std::unique_ptr<ReadbackBackend> backend, uint32_t ringSize)
+    : mBackend(std::move(backend))
+    , mSlots(std::max<uint32_t>(ringSize, 1))
+{
+}
+
+AsyncReadbackService::~AsyncReadbackService() {
+    shutdown();
+}
+
+std::unique_ptr<ReadbackBackend> AsyncReadbackService::createPlatformBackend(uint32_t slotCount) {
+#if defined(__ANDROID__)
+    return createGLESReadbackBackend(slotCount);
+#elif defined(__APPLE__)
+    return createMetalReadbackBackend(slotCount);
+#else
+    (void)slotCount;
+    return nullptr;
+#endif
+}
+
+ReadbackRequestPtr AsyncReadbackService::createRequest(size_t bytes, uint32_t stride) {
+    auto request = std::make_shared<ReadbackRequest>();
+    request->mSize = bytes;
+    request->mStride = stride;
+    std::weak_ptr<AsyncReadbackService> weakSelf = weak_from_this();
+    request->mFlush = [weakSelf]() {
+        if (auto self = weakSelf.lock()) {
+            self->requestFlush();
+        }
+    };
+    return request;
+}
+
+ReadbackRequestPtr AsyncReadbackService::enqueue(lrengine::render::LRTexture& texture,
+                                                 uint32_t width, uint32_t height,
+                                                 PixelFormat format) {
+    if (width == 0 || height == 0) {
+        return nullptr;
+    }
+
+    size_t bytesPerPixel = getPixelFormatBytesPerPixel(format);
+    if (bytesPerPixel == 0) {
+        bytesPerPixel = 4; // 默认RGBA
+    }
+    const uint32_t stride = static_cast<uint32_t>(width * bytesPerPixel);
+    const size_t bytes = static_cast<size_t>(stride) * height;
+
+    auto request = createRequest(bytes, stride);
+    if (!beginRequest(request, texture, nullptr, width, height)) {
+        return nullptr;
+    }
+    return request;
+}
+
+ReadbackRequestPtr AsyncReadbackService::enqueueAfter(std::shared_ptr<lrengine::render::LRTexture> texture,
+                                                      GpuFencePtr fence,
+                                                      uint32_t width, uint32_t height,
+                                                      PixelFormat format) {
+    if (!texture || width == 0 || height == 0) {
+        return nullptr;
+    }
+
+    std::function<void(std::function<void()>)> poster;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mBackend) {
+            return nullptr;
+        }
+        poster = mPoster;
+    }
+    if (!poster) {
+        return enqueue(*texture, width, height, format);
+    }
+
+    size_t bytesPerPixel = getPixelFormatBytesPerPixel(format);
+    if (bytesPerPixel == 0) {
+        bytesPerPixel = 4;
+    }
+    const uint32_t stride = static_cast<uint32_t>(width * bytesPerPixel);
+    auto request = createRequest(static_cast<size_t>(stride) * height, stride);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDeferred.push_back(request);
+    }
+
+    std::weak_ptr<AsyncReadbackService> weakSelf = weak_from_this();
+    poster([weakSelf, request, texture = std::move(texture), fence = std::move(fence), width, height]() {
+        auto self = weakSelf.lock();
+        if (!self) {
+            request->fail();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(self->mMutex);
+            auto it = std::find(self->mDeferred.begin(), self->mDeferred.end(), request);
+            if (it == self->mDeferred.end()) {
+                return;     // 已被 shutdown 标记为失败
+            }
+            self->mDeferred.erase(it);
+        }
+        // 传输上下文的命令流排在渲染之后；不支持GPU端等待时在本线程等待，渲染线程不受影响
+        if (fence) {
+            fence->waitOnGPU();
+        }
+        if (!self->beginRequest(request, *texture, texture, width, height)) {
+            request->fail();
+        }
+    });
+    return request;
+}
+
+bool AsyncReadbackService::beginRequest(const ReadbackRequestPtr& request,
+                                        lrengine::render::LRTexture& texture,
+                                        std::shared_ptr<lrengine::render::LRTexture> keepAlive,
+                                        uint32_t width, uint32_t height) {
+    mGPUThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+    // 源纹理的渲染命令须先提交（Metal 读回在独立队列）；GLES 读回会改动FBO/PBO绑定
+    GpuCommandContext::current().commit();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mBackend) {
+        return false;
+    }
+
+    // 完成回调持有弱引用：服务销毁后迟到的回调直接忽略
+    if (!mCallbackInstalled && mBackend->supportsCompletionCallback()) {
+        std::weak_ptr<AsyncReadbackService> weakSelf = weak_from_this();
+        mBackend->setCompletionCallback([weakSelf](uint32_t slot) {
+            auto self = weakSelf.lock();
+            if (!self) {
+                return;
+            }
+            std::lock_guard<std::mutex> callbackLock(self->mMutex);
+            // 槽位可能已被 waitSlot 收取并复用，只收取当前这次已完成的拷贝
+            if (self->mBackend && slot < self->mSlots.size() &&
+                self->mSlots[slot].busy && self->mBackend->isComplete(slot)) {
+                self->finishSlotLocked(slot);
+            }
+        });
+        mCallbackInstalled = true;
+    }
+
+    // 先收取已完成的槽位，再挑空闲槽位；全忙时等待最早的一次
+    uint32_t freeSlot = std::numeric_limits<uint32_t>::max();
+    uint32_t oldestSlot = 0;
+    uint64_t oldestSequence = std::numeric_limits<uint64_t>::max();
+    for (uint32_t i = 0; i < mSlots.size(); ++i) {
+        if (mSlots[i].busy && mBackend->isComplete(i)) {
+            finishSlotLocked(i);
+        }
+        if (!mSlots[i].busy) {
+            if (freeSlot == std::numeric_limits<uint32_t>::max()) {
+                freeSlot = i;
+            }
+        } else if (mSlots[i].sequence < oldestSequence) {
+            oldestSequence = mSlots[i].sequence;
+            oldestSlot = i;
+        }
+    }
+    if (freeSlot == std::numeric_limits<uint32_t>::max()) {
+        PIPELINE_LOGD("Readback ring full, waiting for slot %u", oldestSlot);
+        waitSlot(lock, oldestSlot);
+        freeSlot = oldestSlot;
+        if (!mBackend) {
+            return false;
+        }
+    }
+
+    if (!mBackend->begin(freeSlot, texture, width, height, request->mStride, request->mSize)) {
+        PIPELINE_LOGW("Readback begin failed (%ux%u)", width, height);
+        return false;
+    }
+
+    Slot& slot = mSlots[freeSlot];
+    slot.request = request;
+    slot.source = std::move(keepAlive);
+    slot.sequence = mNextSequence++;
+    slot.busy = true;
+    return true;
+}
+
+void AsyncReadbackService::poll() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mBackend) {
+        return;
+    }
+    for (uint32_t i = 0; i < mSlots.size(); ++i) {
+        if (mSlots[i].busy && mBackend->isComplete(i)) {
+            finishSlotLocked(i);
+        }
+    }
+}
+
+void AsyncReadbackService::flush() {
+    mFlushPosted.store(false, std::memory_order_release);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        // 按发起顺序收取，先发起的先完成
+        uint32_t oldestSlot = std::numeric_limits<uint32_t>::max();
+        uint64_t oldestSequence = std::numeric_limits<uint64_t>::max();
+        for (uint32_t i = 0; i < mSlots.size(); ++i) {
+            if (mSlots[i].busy && mSlots[i].sequence < oldestSequence) {
+                oldestSequence = mSlots[i].sequence;
+                oldestSlot = i;
+            }
+        }
+        if (!mBackend || oldestSlot == std::numeric_limits<uint32_t>::max()) {
+            return;
+        }
+        waitSlot(lock, oldestSlot);
+    }
+}
+
+void AsyncReadbackService::setGPUTaskPoster(std::function<void(std::function<void()>)> poster) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPoster = std::move(poster);
+}
+
+void AsyncReadbackService::shutdown() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& slot : mSlots) {
+        if (slot.busy) {
+            slot.request->fail();
+            slot.request.reset();
+            slot.source.reset();
+            slot.busy = false;
+        }
+    }
+    for (auto& request : mDeferred) {
+        request->fail();
+    }
+    mDeferred.clear();
+    if (mBackend) {
+        mBackend->release();
+        mBackend.reset();
+    }
+    mPoster = nullptr;
+}
+
+size_t AsyncReadbackService::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<size_t>(std::count_if(mSlots.begin(), mSlots.end(),
+                                             [](const Slot& slot) { return slot.busy; }));
+}
+
+void AsyncReadbackService::finishSlotLocked(uint32_t slot) {
+    Slot& entry = mSlots[slot];
+    if (!entry.busy) {
+        return;
+    }
+
+    ReadbackRequestPtr request = std::move(entry.request);
+    entry.source.reset();
+    entry.busy = false;
+
+    // 结果缓冲取自共享缓冲池，最后一个引用释放时归还
+    auto buffer = BufferPool::shared().acquire(request->mSize);
+    if (buffer && mBackend->read(slot, buffer.get(), request->mSize)) {
+        request->complete(std::move(buffer));
+    } else {
+        PIPELINE_LOGW("Readback copy failed for slot %u", slot);
+        request->fail();
+    }
+}
+
+void AsyncReadbackService::waitSlot(std::unique_lock<std::mutex>& lock, uint32_t slot) {
+    ReadbackBackend* backend = mBackend.get();
+    lock.unlock();
+    backend->waitComplete(slot);
+    lock.lock();
+
+    // 完成回调可能已在等待期间收取了该槽位
+    if (mBackend && mSlots[slot].busy) {
+        finishSlotLocked(slot);
+    }
+}
+
+void AsyncReadbackService::requestFlush() {
+    if (std::this_thread::get_id() == mGPUThread.load(std::memory_order_relaxed)) {
+        flush();
+        return;
+    }
+
+    std::function<void(std::function<void()>)> poster;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        poster = mPoster;
+    }
+    // 未设置投递器时只能等待GPU线程的下一次 poll
+    if (!poster || mFlushPosted.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    std::weak_ptr<AsyncReadbackService> weakSelf = weak_from_this();
+    poster([weakSelf]() {
+        if (auto self = weakSelf.lock()) {
+            self->flush();
+        }
+    });
+}
+
+} // namespace pipeline
@@ -0,0 +1,61 @@
+/**
+ * @file ExternalImage.cpp
+ * @brief ExternalImage 辅助函数实现
+ */
+
+#include "pipeline/data/ExternalImage.h"
+
+namespace pipeline {
+
+void getYUVToRGBMatrix(YUVColorSpace colorSpace, bool fullRange, float matrix[12]) {
+    float kr = 0.2126f;
+    float kb = 0.0722f;
+    switch (colorSpace) {
+        case YUVColorSpace::BT601:
+            kr = 0.299f;
+            kb = 0.114f;
+            break;
+        case YUVColorSpace::BT709:
+            break;
+        case YUVColorSpace::BT2020:
+            kr = 0.2627f;
+            kb = 0.0593f;
+            break;
+    }
+    const float kg = 1.0f - kr - kb;
+
+    // video range：Y 占 [16, 235]，Cb/Cr 占 [16, 240]
+    const float yScale = fullRange ? 1.0f : 255.0f / 219.0f;
+    const float cScale = fullRange ? 1.0f : 255.0f / 224.0f;
+    const float yOffset = fullRange ? 0.0f : 16.0f / 255.0f;
+    const float cOffset = 128.0f / 255.0f;
+
+    const float crToR = 2.0f * (1.0f - kr) * cScale;
+    const float cbToG = -2.0f * kb * (1.0f - kb) / kg * cScale;
+    const float crToG = -2.0f * kr * (1.0f - kr) / kg * cScale;
+    const float cbToB = 2.0f * (1.0f - kb) * cScale;
+    const float yBias = -yScale * yOffset;
+
+    const float rows[3][3] = {
+        {yScale, 0.0f,  crToR},
+        {yScale, cbToG, crToG},
+        {yScale, cbToB, 0.0f},
+    };
+    for (int r = 0; r < 3; ++r) {
+        matrix[r * 4 + 0] = rows[r][0];
+        matrix[r * 4 + 1] = rows[r][1];
+        matrix[r * 4 + 2] = rows[r][2];
+        matrix[r * 4 + 3] = yBias - (rows[r][1] + rows[r][2]) * cOffset;
+    }
+}
+
+PixelFormat getExternalImagePixelFormat(ExternalImageFormat format) {
+    switch (format) {
+        case ExternalImageFormat::BGRA:     return PixelFormat::BGRA8;
+        case ExternalImageFormat::NV12:     return PixelFormat::NV12;
+        case ExternalImageFormat::External: return PixelFormat::OES;
+    }
+    return PixelFormat::Unknown;
+}
+
+} // namespace pipeline
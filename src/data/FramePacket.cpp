@@ -4,10 +4,27 @@
  */
 
 #include "pipeline/data/FramePacket.h"
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/data/ExternalImage.h"
+#include "pipeline/data/GpuFence.h"
 #include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/utils/PipelineLog.h"
 
 namespace pipeline {
 
+namespace {
+
+// 异步读回的最长等待：超时后退化为同步读取，避免GPU线程停转时永久阻塞
+constexpr uint32_t kReadbackWaitTimeoutMs = 500;
+
+std::atomic<uint64_t> sContentGeneration{0};
+
+} // namespace
+
+uint64_t FramePacket::nextContentGeneration() {
+    return sContentGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 FramePacket::FramePacket(uint64_t frameId)
     : mFrameId(frameId)
     , mTimestamp(0)
@@ -23,19 +40,39 @@ FramePacket::~FramePacket() = default;
 
 void FramePacket::setTexture(std::shared_ptr<lrengine::render::LRTexture> texture) {
     mTexture = std::move(texture);
+    mContentGeneration = nextContentGeneration();
     // 清除CPU缓冲，因为纹理已更新
     mCpuBuffer.reset();
     mCpuBufferSize = 0;
+    mPendingReadback.reset();
 }
 
 void FramePacket::setPlanarTexture(std::shared_ptr<lrengine::render::LRPlanarTexture> texture) {
     mPlanarTexture = std::move(texture);
+    mContentGeneration = nextContentGeneration();
     // 清除CPU缓冲，因为纹理已更新
     mCpuBuffer.reset();
     mCpuBufferSize = 0;
 }
 
+void FramePacket::setExternalImage(std::shared_ptr<const ExternalImage> image) {
+    mExternalImage = std::move(image);
+    mContentGeneration = nextContentGeneration();
+    mCpuBuffer.reset();
+    mCpuBufferSize = 0;
+}
+
 const uint8_t* FramePacket::getCpuBuffer() {
+    if (!mCpuBuffer && mPendingReadback) {
+        auto request = std::move(mPendingReadback);
+        if (request->wait(kReadbackWaitTimeoutMs)) {
+            mCpuBuffer = request->getBuffer();
+            mCpuBufferSize = mCpuBuffer ? request->getSize() : 0;
+        } else {
+            PIPELINE_LOGW("Async readback unavailable for frame %llu, reading synchronously",
+                          static_cast<unsigned long long>(mFrameId));
+        }
+    }
     if (!mCpuBuffer && mTexture) {
         loadCpuBufferFromTexture();
     }
@@ -51,12 +88,19 @@ void FramePacket::setCpuBuffer(const uint8_t* data, size_t size, bool takeOwners
         );
         mCpuBufferSize = size;
     } else if (data && size > 0) {
-        // 复制数据
-        uint8_t* buffer = new uint8_t[size];
-        std::memcpy(buffer, data, size);
-        mCpuBuffer = std::shared_ptr<uint8_t>(buffer, [](uint8_t* p) { delete[] p; });
+        // 复制数据（缓冲取自共享缓冲池，最后一个引用释放时归还）
+        auto buffer = BufferPool::shared().acquire(size);
+        std::memcpy(buffer.get(), data, size);
+        mCpuBuffer = std::move(buffer);
         mCpuBufferSize = size;
     }
+    mContentGeneration = nextContentGeneration();
+}
+
+void FramePacket::setCpuBuffer(std::shared_ptr<uint8_t> buffer, size_t size) {
+    mCpuBufferSize = buffer ? size : 0;
+    mCpuBuffer = std::move(buffer);
+    mContentGeneration = nextContentGeneration();
 }
 
 void FramePacket::clearCpuBuffer() {
@@ -87,15 +131,18 @@ void FramePacket::removeMetadata(const std::string& key) {
 }
 
 void FramePacket::clearMetadata() {
-    std::lock_guard<std::mutex> lock(mMetadataMutex);
-    mMetadata.clear();
+    {
+        std::lock_guard<std::mutex> lock(mMetadataMutex);
+        mMetadata.clear();
+    }
+    mTypedMetadata.clear();
 }
 
 // =============================================================================
 // GPU同步
 // =============================================================================
 
-void FramePacket::setGpuFence(std::shared_ptr<lrengine::render::LRFence> fence) {
+void FramePacket::setGpuFence(std::shared_ptr<GpuFence> fence) {
     mGpuFence = std::move(fence);
 }
 
@@ -103,17 +150,11 @@ bool FramePacket::waitGpu(int64_t timeoutMs) {
     if (!mGpuFence) {
         return true;
     }
-    
-    // 这里需要调用LRFence的等待方法
-    // 具体实现取决于LREngine的Fence接口
-    // mGpuFence->Wait(timeoutMs);
-    return true;
+    return mGpuFence->wait(timeoutMs);
 }
 
 void FramePacket::signalGpu() {
-    if (mGpuFence) {
-        // mGpuFence->Signal();
-    }
+    mGpuFence = GpuFence::insert();
 }
 
 // =============================================================================
@@ -125,16 +166,9 @@ void FramePacket::retain() {
 }
 
 int32_t FramePacket::release() {
+    // 池中帧包由 FramePacketPool 的回收删除器在最后一个 shared_ptr 释放时归还，
+    // 这里只维护手动引用计数
     int32_t count = mRefCount.fetch_sub(1, std::memory_order_acq_rel);
-    if (count == 1) {
-        // 引用计数降为0，归还到池
-        if (mPool) {
-            reset();
-            // 注意：这里需要通过shared_from_this获取智能指针
-            // 但由于我们在析构路径上，这可能有问题
-            // 实际使用时应该通过FramePacketPool的自动释放机制处理
-        }
-    }
     return count - 1;
 }
 
@@ -146,12 +180,25 @@ void FramePacket::reset() {
     mFrameId = 0;
     mTimestamp = 0;
     mSequenceNumber = 0;
+    mContentGeneration = 0;
+    mRenderScale = 1.0f;
+    mPixelScale = 1.0f;
+    mPayloadElided = false;
+    mRoi = RoiRect();
     
     // 保留纹理引用但清除CPU缓冲
     mTexture.reset();
     mPlanarTexture.reset();
+    mExternalImage.reset();
     mCpuBuffer.reset();
     mCpuBufferSize = 0;
+    mPendingReadback.reset();
+    
+    // 清除尺寸与格式（复用时 setSize 依赖 mStride 为 0 重新计算步长）
+    mWidth = 0;
+    mHeight = 0;
+    mStride = 0;
+    mFormat = PixelFormat::Unknown;
     
     // 清除元数据
     clearMetadata();
@@ -168,10 +215,21 @@ FramePacketPtr FramePacket::clone() const {
     
     packet->mTimestamp = mTimestamp;
     packet->mSequenceNumber = mSequenceNumber;
+    packet->mContentGeneration = mContentGeneration;
+    packet->mRenderScale = mRenderScale;
+    packet->mPixelScale = mPixelScale;
+    packet->mPayloadElided = mPayloadElided;
+    packet->mRoi = mRoi;
     
     // 浅拷贝纹理（共享同一个纹理）
     packet->mTexture = mTexture;
     packet->mPlanarTexture = mPlanarTexture;
+    packet->mExternalImage = mExternalImage;
+    
+    // 共享CPU缓冲（只读，不复制）
+    packet->mCpuBuffer = mCpuBuffer;
+    packet->mCpuBufferSize = mCpuBufferSize;
+    packet->mPendingReadback = mPendingReadback;
     
     packet->mWidth = mWidth;
     packet->mHeight = mHeight;
@@ -183,8 +241,10 @@ FramePacketPtr FramePacket::clone() const {
         std::lock_guard<std::mutex> lock(mMetadataMutex);
         packet->mMetadata = mMetadata;
     }
+    packet->mTypedMetadata.copyFrom(mTypedMetadata);
     
-    // GPU Fence不复制（每个packet有自己的同步）
+    // 共享GPU栅栏（克隆与原帧引用同一次GPU产出）
+    packet->mGpuFence = mGpuFence;
     
     return packet;
 }
@@ -206,15 +266,14 @@ void FramePacket::loadCpuBufferFromTexture() {
     
     size_t bufferSize = mWidth * mHeight * bytesPerPixel;
     
-    // 分配缓冲区（使用 delete[] 删除器）
-    uint8_t* buffer = new uint8_t[bufferSize];
-    mCpuBuffer = std::shared_ptr<uint8_t>(buffer, [](uint8_t* p) { delete[] p; });
+    // 分配缓冲区（取自共享缓冲池）
+    mCpuBuffer = BufferPool::shared().acquire(bufferSize);
     mCpuBufferSize = bufferSize;
     
     // 从纹理读取数据
     // 这里需要调用LRTexture的读取方法
     // 具体实现取决于LREngine的纹理接口
-    // mTexture->ReadPixels(buffer, bufferSize);
+    // mTexture->ReadPixels(mCpuBuffer.get(), bufferSize);
 }
 
 } // namespace pipeline
@@ -0,0 +1,164 @@
+/**
+ * @file GpuCommandContext.cpp
+ * @brief GpuCommandContext实现
+ */
+
+#include "pipeline/data/GpuCommandContext.h"
+#include "pipeline/utils/PipelineLog.h"
+
+namespace pipeline {
+
+namespace {
+
+// 失效状态的哨兵：与任何对象地址（包括 nullptr 表示的解绑）都不相等
+const char kUnknownTag = 0;
+const void* const kUnknown = &kUnknownTag;
+
+std::unique_ptr<CommandBufferBackend> createPlatformBackend() {
+#if defined(__APPLE__)
+    return createMetalCommandBufferBackend();
+#else
+    // GLES 的命令流由驱动按上下文顺序提交，没有可合并的显式提交
+    return nullptr;
+#endif
+}
+
+} // anonymous namespace
+
+GpuCommandContext& GpuCommandContext::current() {
+    thread_local GpuCommandContext context;
+    return context;
+}
+
+GpuCommandContext::GpuCommandContext() {
+    invalidateState();
+}
+
+GpuCommandContext::~GpuCommandContext() {
+    // 线程退出时仍未提交的命令不能丢
+    commit();
+}
+
+// =============================================================================
+// 帧级录制
+// =============================================================================
+
+bool GpuCommandContext::setRecordingEnabled(bool enabled) {
+    if (!enabled) {
+        commit();
+        mRecording = false;
+        return false;
+    }
+    if (!mBackend) {
+        mBackend = createPlatformBackend();
+        if (!mBackend) {
+            PIPELINE_LOGD("Frame command recording not supported on this platform");
+            return false;
+        }
+    }
+    mRecording = true;
+    return true;
+}
+
+void* GpuCommandContext::beginPass() {
+    ++mStats.passes;
+    if (!isRecording()) {
+        return nullptr;
+    }
+    if (!mOpenBuffer) {
+        mOpenBuffer = mBackend->begin();
+        if (!mOpenBuffer) {
+            PIPELINE_LOGW("Failed to begin frame command buffer, pass is submitted on its own");
+            return nullptr;
+        }
+    }
+    // 每个通道是新的渲染编码器，编码器之间不继承任何绑定
+    invalidateState();
+    return mOpenBuffer;
+}
+
+bool GpuCommandContext::commit() {
+    invalidateState();
+    if (!mOpenBuffer) {
+        return false;
+    }
+    mBackend->commit(mOpenBuffer);
+    mOpenBuffer = nullptr;
+    ++mStats.commits;
+    return true;
+}
+
+// =============================================================================
+// 状态跟踪
+// =============================================================================
+
+void GpuCommandContext::setStateTrackingEnabled(bool enabled) {
+    mTracking = enabled;
+    invalidateState();
+}
+
+bool GpuCommandContext::track(const void*& slot, const void* value) {
+    if (mTracking && slot == value) {
+        ++mStats.bindsSkipped;
+        return false;
+    }
+    slot = value;
+    ++mStats.bindsIssued;
+    return true;
+}
+
+bool GpuCommandContext::bindFrameBuffer(const void* frameBuffer) {
+    return track(mFrameBuffer, frameBuffer);
+}
+
+bool GpuCommandContext::setViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    const std::array<uint32_t, 4> viewport{x, y, width, height};
+    if (mTracking && mViewportValid && mViewport == viewport) {
+        ++mStats.bindsSkipped;
+        return false;
+    }
+    mViewport = viewport;
+    mViewportValid = true;
+    ++mStats.bindsIssued;
+    return true;
+}
+
+bool GpuCommandContext::bindPipelineState(const void* pipelineState) {
+    // 管线状态包含程序，换入新状态后单独记录的程序不再可信
+    if (!track(mPipelineState, pipelineState)) {
+        return false;
+    }
+    mProgram = kUnknown;
+    return true;
+}
+
+bool GpuCommandContext::bindProgram(const void* program) {
+    if (!track(mProgram, program)) {
+        return false;
+    }
+    mPipelineState = kUnknown;
+    return true;
+}
+
+bool GpuCommandContext::bindVertexBuffer(const void* vertexBuffer) {
+    return track(mVertexBuffer, vertexBuffer);
+}
+
+bool GpuCommandContext::bindTexture(uint32_t unit, const void* texture) {
+    if (unit >= kMaxTrackedTextureUnits) {
+        ++mStats.bindsIssued;
+        return true;
+    }
+    return track(mTextures[unit], texture);
+}
+
+void GpuCommandContext::invalidateState() {
+    mFrameBuffer = kUnknown;
+    mPipelineState = kUnknown;
+    mProgram = kUnknown;
+    mVertexBuffer = kUnknown;
+    mTextures.fill(kUnknown);
+    mViewportValid = false;
+}
+
+} // namespace pipeline
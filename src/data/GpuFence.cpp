@@ -0,0 +1,23 @@
+/**
+ * @file GpuFence.cpp
+ * @brief GpuFence平台分派
+ */
+
+#include "pipeline/data/GpuFence.h"
+#include "pipeline/data/GpuCommandContext.h"
+
+namespace pipeline {
+
+std::shared_ptr<GpuFence> GpuFence::insert() {
+#if defined(__ANDROID__)
+    return createEGLSyncFence();
+#elif defined(__APPLE__)
+    // 栅栏在独立队列上 signal，录制中的帧命令必须先提交才会排在它前面
+    GpuCommandContext::current().commit();
+    return createMetalSharedEventFence();
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace pipeline
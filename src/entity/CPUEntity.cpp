@@ -6,9 +6,22 @@
 #include "pipeline/entity/CPUEntity.h"
 #include "pipeline/core/PipelineConfig.h"
 #include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/utils/FrameArena.h"
+#include "pipeline/simd/PixelKernels.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <atomic>
+#include <cstring>
 
 namespace pipeline {
 
+namespace {
+
+// 等待上游GPU栅栏的上限，超时仍继续读取（与旧的无同步行为一致）
+constexpr int64_t kGpuFenceTimeoutMs = 100;
+
+} // namespace
+
 CPUEntity::CPUEntity(const std::string& name)
     : ProcessEntity(name)
 {
@@ -27,6 +40,12 @@ void CPUEntity::setProcessingScale(float scale) {
     mProcessingScale = std::max(0.1f, std::min(1.0f, scale));
 }
 
+void CPUEntity::setTiledProcessing(bool enabled, uint32_t haloRows, uint32_t minBandRows) {
+    mTiledProcessing = enabled;
+    mTileHaloRows = haloRows;
+    mTileMinBandRows = std::max(1u, minBandRows);
+}
+
 // =============================================================================
 // 执行流程
 // =============================================================================
@@ -71,10 +90,39 @@ bool CPUEntity::process(const std::vector<FramePacketPtr>& inputs,
         if (scaledBuffer) {
             processData = scaledBuffer.get();
             processStride = processWidth * getPixelFormatBytesPerPixel(format);
-            mScaledBuffer = scaledBuffer;
         }
     }
     
+    // 分块模式：行带并行处理，结果写入新的CPU缓冲
+    if (mTiledProcessing) {
+        FramePacketPtr output = processTiled(input, processData, processWidth, processHeight,
+                                             processStride, format, context);
+        if (!output) {
+            return false;
+        }
+        onProcessComplete(input, output);
+        outputs.push_back(output);
+        return true;
+    }
+    
+    // ROI子区视图：指针移到区域左上角，行跨度不变（多平面格式无法这样切分，整帧处理）
+    mRoiOffsetX = 0;
+    mRoiOffsetY = 0;
+    size_t bytesPerPixel = getPixelFormatBytesPerPixel(format);
+    uint32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    if (isRoiLimited() && input->hasRoi() && bytesPerPixel > 0 &&
+        !containsPixelFormat(kYUVPixelFormats, format) &&
+        input->getRoi().toPixels(processWidth, processHeight, x0, y0, x1, y1)) {
+        if (processStride == 0) {
+            processStride = static_cast<uint32_t>(processWidth * bytesPerPixel);
+        }
+        processData += static_cast<size_t>(y0) * processStride + x0 * bytesPerPixel;
+        processWidth = x1 - x0;
+        processHeight = y1 - y0;
+        mRoiOffsetX = x0;
+        mRoiOffsetY = y0;
+    }
+    
     // 准备元数据容器
     std::unordered_map<std::string, std::any> metadata;
     
@@ -99,27 +147,22 @@ bool CPUEntity::process(const std::vector<FramePacketPtr>& inputs,
         output = input->clone();
     } else {
         // 创建新的输出
-        auto packetPool = context.getFramePacketPool();
-        if (packetPool) {
-            output = packetPool->acquire();
-        } else {
-            output = std::make_shared<FramePacket>(input->getFrameId());
-        }
-        
-        if (!output) {
-            return false;
-        }
-        
+        output = context.acquireFramePacket();
         output->setFrameId(input->getFrameId());
         output->setTimestamp(input->getTimestamp());
         output->setSize(input->getWidth(), input->getHeight());
         output->setFormat(input->getFormat());
+        output->setRenderScale(input->getRenderScale());
+        output->setPixelScale(input->getPixelScale());
+        output->setRoi(input->getRoi());
         
         if (mWriteBackTexture) {
             // 需要将CPU数据写回纹理（暂不实现）
             output->setTexture(input->getTexture());
         } else {
             output->setTexture(input->getTexture());
+            // 纹理原样转发，沿用上游代号，下游GPU节点仍可判定输入未变
+            output->setContentGeneration(input->getContentGeneration());
         }
     }
     
@@ -139,11 +182,102 @@ bool CPUEntity::process(const std::vector<FramePacketPtr>& inputs,
 // 辅助方法
 // =============================================================================
 
+FramePacketPtr CPUEntity::processTiled(FramePacketPtr input, const uint8_t* data,
+                                       uint32_t width, uint32_t height, uint32_t stride,
+                                       PixelFormat format, PipelineContext& context) {
+    size_t bytesPerPixel = getPixelFormatBytesPerPixel(format);
+    if (bytesPerPixel == 0) {
+        bytesPerPixel = 4;
+    }
+    uint32_t srcStride = stride > 0 ? stride : static_cast<uint32_t>(width * bytesPerPixel);
+    uint32_t dstStride = static_cast<uint32_t>(width * bytesPerPixel);
+    size_t dstSize = static_cast<size_t>(dstStride) * height;
+    
+    // 输出随数据包流出本帧，从共享缓冲池分配（不能使用帧内存区）
+    std::shared_ptr<uint8_t> buffer = BufferPool::shared().acquire(dstSize);
+    if (!buffer) {
+        return nullptr;
+    }
+    
+    // 只改写ROI覆盖的行：其余行按原样拷贝，行带只切分区域内的行
+    uint32_t rowBegin = 0;
+    uint32_t rowEnd = height;
+    uint32_t x0 = 0, x1 = 0;
+    if (isRoiLimited() && input->hasRoi() &&
+        input->getRoi().toPixels(width, height, x0, rowBegin, x1, rowEnd)) {
+        auto copyRows = [&](uint32_t begin, uint32_t end) {
+            for (uint32_t row = begin; row < end; ++row) {
+                std::memcpy(buffer.get() + static_cast<size_t>(row) * dstStride,
+                            data + static_cast<size_t>(row) * srcStride, dstStride);
+            }
+        };
+        copyRows(0, rowBegin);
+        copyRows(rowEnd, height);
+    } else {
+        rowBegin = 0;
+        rowEnd = height;
+    }
+    
+    uint32_t bandRows = mTileMinBandRows;
+    uint32_t bandCount = (rowEnd - rowBegin + bandRows - 1) / bandRows;
+    std::atomic<bool> success{true};
+    
+    context.parallelFor(bandCount, [&](uint32_t band) {
+        CPUTile tile;
+        tile.src = data;
+        tile.dst = buffer.get();
+        tile.width = width;
+        tile.height = height;
+        tile.srcStride = srcStride;
+        tile.dstStride = dstStride;
+        tile.format = format;
+        tile.rowBegin = rowBegin + band * bandRows;
+        tile.rowEnd = std::min(rowEnd, tile.rowBegin + bandRows);
+        tile.haloTop = std::min(mTileHaloRows, tile.rowBegin);
+        tile.haloBottom = std::min(mTileHaloRows, height - tile.rowEnd);
+        tile.index = band;
+        if (!processTileOnCPU(tile)) {
+            success.store(false, std::memory_order_relaxed);
+        }
+    });
+    
+    if (!success.load()) {
+        PIPELINE_LOGE("CPUEntity %s: tiled processing failed", getName().c_str());
+        return nullptr;
+    }
+    
+    FramePacketPtr output = context.acquireFramePacket();
+    output->setFrameId(input->getFrameId());
+    output->setTimestamp(input->getTimestamp());
+    output->setSize(width, height);
+    output->setFormat(format);
+    output->setRenderScale(input->getRenderScale());
+    output->setPixelScale(input->getPixelScale());
+    output->setRoi(input->getRoi());
+    output->setCpuBuffer(std::move(buffer), dstSize);
+    return output;
+}
+
+PixelFormatSet CPUEntity::getDefaultAcceptedInputFormats(size_t port) const {
+    PixelFormat required = getRequiredFormat();
+    if (required != PixelFormat::Unknown) {
+        return pixelFormatBit(required);
+    }
+    // 读回按单平面逐行拷贝，多平面与外部纹理读不回来
+    return kAnyPixelFormat & ~kYUVPixelFormats & ~pixelFormatBit(PixelFormat::OES);
+}
+
 bool CPUEntity::ensureCpuBuffer(FramePacketPtr packet) {
     if (!packet) {
         return false;
     }
     
+    // 需要从纹理取数据时，先等生产本帧的GPU工作完成（只等这一帧，不阻塞整条GPU队列）
+    if (!packet->getCpuBufferNoLoad() && !packet->waitGpu(kGpuFenceTimeoutMs)) {
+        PIPELINE_LOGW("GPU fence wait timed out for frame %llu",
+                      static_cast<unsigned long long>(packet->getFrameId()));
+    }
+    
     // 尝试获取CPU缓冲（会触发懒加载）
     const uint8_t* buffer = packet->getCpuBuffer();
     return buffer != nullptr;
@@ -165,50 +299,25 @@ std::shared_ptr<uint8_t> CPUEntity::scaleImage(const uint8_t* src,
     
     size_t dstSize = dstWidth * dstHeight * bytesPerPixel;
     
-    // 检查是否可以复用缓冲
-    if (mScaledBufferSize < dstSize) {
-        uint8_t* buffer = new uint8_t[dstSize];
-        mScaledBuffer = std::shared_ptr<uint8_t>(buffer, [](uint8_t* p) { delete[] p; });
-        mScaledBufferSize = dstSize;
-    }
-    
-    uint8_t* dst = mScaledBuffer.get();
-    
-    // 简单的双线性插值缩放
-    float xRatio = static_cast<float>(srcWidth) / dstWidth;
-    float yRatio = static_cast<float>(srcHeight) / dstHeight;
-    
-    for (uint32_t y = 0; y < dstHeight; ++y) {
-        for (uint32_t x = 0; x < dstWidth; ++x) {
-            float srcX = x * xRatio;
-            float srcY = y * yRatio;
-            
-            uint32_t x0 = static_cast<uint32_t>(srcX);
-            uint32_t y0 = static_cast<uint32_t>(srcY);
-            uint32_t x1 = std::min(x0 + 1, srcWidth - 1);
-            uint32_t y1 = std::min(y0 + 1, srcHeight - 1);
-            
-            float xFrac = srcX - x0;
-            float yFrac = srcY - y0;
-            
-            size_t dstOffset = (y * dstWidth + x) * bytesPerPixel;
-            
-            for (size_t c = 0; c < bytesPerPixel; ++c) {
-                float v00 = src[(y0 * srcWidth + x0) * bytesPerPixel + c];
-                float v01 = src[(y0 * srcWidth + x1) * bytesPerPixel + c];
-                float v10 = src[(y1 * srcWidth + x0) * bytesPerPixel + c];
-                float v11 = src[(y1 * srcWidth + x1) * bytesPerPixel + c];
-                
-                float v0 = v00 * (1 - xFrac) + v01 * xFrac;
-                float v1 = v10 * (1 - xFrac) + v11 * xFrac;
-                float v = v0 * (1 - yFrac) + v1 * yFrac;
-                
-                dst[dstOffset + c] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, v)));
-            }
+    // 帧内执行时从帧内存区分配（本帧结束时回收，返回值不持有所有权），否则复用成员缓冲
+    std::shared_ptr<uint8_t> scaled;
+    if (FrameArena* arena = FrameArena::current()) {
+        scaled = std::shared_ptr<uint8_t>(std::shared_ptr<uint8_t>(), arena->allocateArray<uint8_t>(dstSize));
+    } else {
+        if (mScaledBufferSize < dstSize) {
+            mScaledBuffer = BufferPool::shared().acquire(dstSize);
+            mScaledBufferSize = BufferPool::getAllocationSize(dstSize);
         }
+        scaled = mScaledBuffer;
+    }
+    
+    uint32_t channels = static_cast<uint32_t>(bytesPerPixel);
+    if (!simd::scale(src, srcWidth * channels, srcWidth, srcHeight,
+                     scaled.get(), dstWidth * channels, dstWidth, dstHeight, channels)) {
+        return nullptr;
     }
     
-    return mScaledBuffer;
+    return scaled;
 }
 
 } // namespace pipeline
@@ -0,0 +1,115 @@
+/**
+ * @file ClockSyncEntity.cpp
+ * @brief ClockSyncEntity 实现
+ */
+
+#include "pipeline/entity/ClockSyncEntity.h"
+#include "pipeline/data/FramePacket.h"
+#include "pipeline/input/ClockDomain.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace pipeline {
+
+ClockSyncEntity::ClockSyncEntity(const std::string& name, size_t inputCount)
+    : ProcessEntity(name)
+    , mHistories(std::max<size_t>(inputCount, 1))
+    , mLastSkewUs(new std::atomic<int64_t>[std::max<size_t>(inputCount, 1)]) {
+    for (size_t i = 0; i < mHistories.size(); ++i) {
+        addInputPort("input" + std::to_string(i));
+        addOutputPort("output" + std::to_string(i));
+        mLastSkewUs[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+ClockSyncEntity::~ClockSyncEntity() = default;
+
+int64_t ClockSyncEntity::getLastSkewUs(size_t port) const {
+    if (port >= mHistories.size()) {
+        return 0;
+    }
+    return mLastSkewUs[port].load(std::memory_order_relaxed);
+}
+
+int64_t ClockSyncEntity::hostTimeOf(const FramePacket& packet) {
+    if (const auto* stamp = packet.getMetadata(input::kSourceClockKey)) {
+        return stamp->hostTimeUs;
+    }
+    return static_cast<int64_t>(packet.getTimestamp());
+}
+
+// =============================================================================
+// 处理
+// =============================================================================
+
+bool ClockSyncEntity::process(const std::vector<FramePacketPtr>& inputs,
+                              std::vector<FramePacketPtr>& outputs,
+                              PipelineContext& context) {
+    (void)context;
+    
+    const size_t count = mHistories.size();
+    if (inputs.empty() || !inputs[0]) {
+        PIPELINE_LOGW("ClockSyncEntity '%s': master input missing", getName().c_str());
+        return false;
+    }
+    
+    const FramePacketPtr& master = inputs[0];
+    const int64_t masterHostUs = hostTimeOf(*master);
+    
+    outputs.assign(count, nullptr);
+    outputs[0] = master;
+    
+    for (size_t port = 1; port < count; ++port) {
+        if (port < inputs.size()) {
+            recordFollower(port, inputs[port]);
+        }
+        int64_t skewUs = 0;
+        outputs[port] = pickNearest(port, masterHostUs, skewUs);
+        mLastSkewUs[port].store(skewUs, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ClockSyncEntity::finalize(PipelineContext& context) {
+    (void)context;
+    for (auto& history : mHistories) {
+        history.clear();
+    }
+}
+
+void ClockSyncEntity::recordFollower(size_t port, const FramePacketPtr& packet) {
+    if (!packet) {
+        return;
+    }
+    auto& history = mHistories[port];
+    // 从属路没有新帧时上游沿用同一个包
+    if (!history.empty() && history.back() == packet) {
+        return;
+    }
+    history.push_back(packet);
+    if (history.size() > kHistoryDepth) {
+        history.pop_front();
+    }
+}
+
+FramePacketPtr ClockSyncEntity::pickNearest(size_t port, int64_t masterHostUs,
+                                            int64_t& skewUs) const {
+    const auto& history = mHistories[port];
+    FramePacketPtr best;
+    int64_t bestDistance = 0;
+    for (const auto& packet : history) {
+        const int64_t skew = hostTimeOf(*packet) - masterHostUs;
+        const int64_t distance = std::llabs(skew);
+        if (!best || distance < bestDistance) {
+            best = packet;
+            bestDistance = distance;
+            skewUs = skew;
+        }
+    }
+    return best;
+}
+
+} // namespace pipeline
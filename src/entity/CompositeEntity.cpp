@@ -8,9 +8,11 @@
 #include "pipeline/data/FramePort.h"
 #include "pipeline/pool/TexturePool.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/utils/PipelineLog.h"
 
 #include "lrengine/core/LRTexture.h"
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <cmath>
 
@@ -208,6 +210,64 @@ void main() {
 }
 )";
 
+// 实例化图层合成（GLSL ES 3.00）：一个单位四边形按实例展开到各图层的目标矩形
+const char* kLayerVertexShader = R"(#version 300 es
+layout(location = 0) in vec2 aCorner;       // 单位四边形 (0,0)-(1,1)
+layout(location = 1) in vec4 aDstRect;      // 每实例：输出位置
+layout(location = 2) in vec4 aSrcRect;      // 每实例：采样区域
+layout(location = 3) in vec2 aAlphaSlot;    // 每实例：透明度、纹理单元
+
+out vec2 vTexCoord;
+out float vAlpha;
+flat out int vSlot;
+
+void main() {
+    vec2 pos = aDstRect.xy + aCorner * aDstRect.zw;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+    vTexCoord = aSrcRect.xy + aCorner * aSrcRect.zw;
+    vAlpha = aAlphaSlot.x;
+    vSlot = int(aAlphaSlot.y + 0.5);
+}
+)";
+
+// 纹理单元数固定为 kMaxLayerTextureUnits，按常量下标分支采样（同一图层内分支一致）
+const char* kLayerFragmentShader = R"(#version 300 es
+precision mediump float;
+
+in vec2 vTexCoord;
+in float vAlpha;
+flat in int vSlot;
+out vec4 fragColor;
+
+uniform sampler2D uLayer0;
+uniform sampler2D uLayer1;
+uniform sampler2D uLayer2;
+uniform sampler2D uLayer3;
+uniform sampler2D uLayer4;
+uniform sampler2D uLayer5;
+uniform sampler2D uLayer6;
+uniform sampler2D uLayer7;
+
+void main() {
+    vec4 color;
+    if (vSlot == 0) color = texture(uLayer0, vTexCoord);
+    else if (vSlot == 1) color = texture(uLayer1, vTexCoord);
+    else if (vSlot == 2) color = texture(uLayer2, vTexCoord);
+    else if (vSlot == 3) color = texture(uLayer3, vTexCoord);
+    else if (vSlot == 4) color = texture(uLayer4, vTexCoord);
+    else if (vSlot == 5) color = texture(uLayer5, vTexCoord);
+    else if (vSlot == 6) color = texture(uLayer6, vTexCoord);
+    else color = texture(uLayer7, vTexCoord);
+    fragColor = vec4(color.rgb, color.a * vAlpha);
+}
+)";
+
+bool rectContains(const float* outer, const float* inner) {
+    return outer[0] <= inner[0] && outer[1] <= inner[1] &&
+           outer[0] + outer[2] >= inner[0] + inner[2] &&
+           outer[1] + outer[3] >= inner[1] + inner[3];
+}
+
 } // anonymous namespace
 
 // =============================================================================
@@ -218,6 +278,9 @@ CompositeEntity::CompositeEntity(const std::string& name, size_t inputCount)
     : GPUEntity(name) {
     // 初始化输入配置
     mInputConfigs.resize(inputCount);
+    mParamBlock.update([inputCount](CompositeParams& params) {
+        params.inputs.resize(inputCount);
+    });
     
     // 创建多个输入端口
     for (size_t i = 0; i < inputCount; ++i) {
@@ -238,18 +301,74 @@ CompositeEntity::~CompositeEntity() = default;
 // =============================================================================
 
 void CompositeEntity::setBlendMode(BlendMode mode) {
-    mBlendMode = mode;
-    mNeedsShaderUpdate = true;
+    mParamBlock.update([mode](CompositeParams& params) { params.blendMode = mode; });
+}
+
+BlendMode CompositeEntity::getBlendMode() const {
+    return mParamBlock.read([](const CompositeParams& params) { return params.blendMode; });
 }
 
 void CompositeEntity::setLayout(CompositeLayout layout) {
-    mLayout = layout;
-    calculateUVTransforms();
-    mNeedsShaderUpdate = true;
+    mParamBlock.update([layout](CompositeParams& params) { params.layout = layout; });
+}
+
+CompositeLayout CompositeEntity::getLayout() const {
+    return mParamBlock.read([](const CompositeParams& params) { return params.layout; });
 }
 
 void CompositeEntity::setPipConfig(const PipConfig& config) {
-    mPipConfig = config;
+    mParamBlock.update([&config](CompositeParams& params) { params.pip = config; });
+}
+
+PipConfig CompositeEntity::getPipConfig() const {
+    return mParamBlock.read([](const CompositeParams& params) { return params.pip; });
+}
+
+void CompositeEntity::markInputDirty(size_t inputIndex, const float newRect[4]) {
+    // 只有 Layers 布局下图层的影响范围就是其目标矩形（旧位置需要还原），其他布局整帧重绘
+    if (mLayout == CompositeLayout::Layers && inputIndex < mInputConfigs.size()) {
+        markParametersDirty(mInputConfigs[inputIndex].rect);
+        markParametersDirty(newRect);
+    } else {
+        markParametersDirty();
+    }
+}
+
+void CompositeEntity::latchParameters() {
+    if (!mParamBlock.acquire()) {
+        return;
+    }
+    const CompositeParams& params = mParamBlock.current();
+    
+    bool shaderChanged = params.blendMode != mBlendMode || params.layout != mLayout ||
+                         params.inputs.size() != mInputConfigs.size();
+    if (shaderChanged || std::memcmp(&params.pip, &mPipConfig, sizeof(PipConfig)) != 0) {
+        markParametersDirty();
+    } else {
+        for (size_t i = 0; i < params.inputs.size(); ++i) {
+            const InputConfig& next = params.inputs[i];
+            const InputConfig& prev = mInputConfigs[i];
+            if (std::memcmp(next.transform, prev.transform, sizeof(next.transform)) != 0) {
+                markParametersDirty();
+                break;
+            }
+            if (next.alpha != prev.alpha || next.visible != prev.visible ||
+                next.zOrder != prev.zOrder || next.opaque != prev.opaque ||
+                std::memcmp(next.rect, prev.rect, sizeof(next.rect)) != 0 ||
+                std::memcmp(next.sourceRect, prev.sourceRect, sizeof(next.sourceRect)) != 0) {
+                markInputDirty(i, next.rect);
+            }
+        }
+    }
+    
+    mBlendMode = params.blendMode;
+    mLayout = params.layout;
+    mPipConfig = params.pip;
+    mInputConfigs = params.inputs;
+    calculateUVTransforms();
+    if (shaderChanged) {
+        mNeedsShaderUpdate = true;
+    }
 }
 
 // =============================================================================
@@ -257,41 +376,82 @@ void CompositeEntity::setPipConfig(const PipConfig& config) {
 // =============================================================================
 
 void CompositeEntity::setInputAlpha(size_t inputIndex, float alpha) {
-    if (inputIndex < mInputConfigs.size()) {
-        mInputConfigs[inputIndex].alpha = std::clamp(alpha, 0.0f, 1.0f);
-    }
+    mParamBlock.update([inputIndex, alpha](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            params.inputs[inputIndex].alpha = std::clamp(alpha, 0.0f, 1.0f);
+        }
+    });
 }
 
 float CompositeEntity::getInputAlpha(size_t inputIndex) const {
-    if (inputIndex < mInputConfigs.size()) {
-        return mInputConfigs[inputIndex].alpha;
-    }
-    return 1.0f;
+    return mParamBlock.read([inputIndex](const CompositeParams& params) {
+        return inputIndex < params.inputs.size() ? params.inputs[inputIndex].alpha : 1.0f;
+    });
 }
 
 void CompositeEntity::setInputTransform(size_t inputIndex, const float* transform) {
-    if (inputIndex < mInputConfigs.size() && transform != nullptr) {
-        std::memcpy(mInputConfigs[inputIndex].transform, transform, 16 * sizeof(float));
+    if (transform == nullptr) {
+        return;
     }
+    mParamBlock.update([inputIndex, transform](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            std::memcpy(params.inputs[inputIndex].transform, transform, 16 * sizeof(float));
+        }
+    });
 }
 
 void CompositeEntity::setInputVisible(size_t inputIndex, bool visible) {
-    if (inputIndex < mInputConfigs.size()) {
-        mInputConfigs[inputIndex].visible = visible;
-    }
+    mParamBlock.update([inputIndex, visible](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            params.inputs[inputIndex].visible = visible;
+        }
+    });
 }
 
 bool CompositeEntity::isInputVisible(size_t inputIndex) const {
-    if (inputIndex < mInputConfigs.size()) {
-        return mInputConfigs[inputIndex].visible;
-    }
-    return false;
+    return mParamBlock.read([inputIndex](const CompositeParams& params) {
+        return inputIndex < params.inputs.size() && params.inputs[inputIndex].visible;
+    });
 }
 
 void CompositeEntity::setInputZOrder(size_t inputIndex, int32_t zOrder) {
-    if (inputIndex < mInputConfigs.size()) {
-        mInputConfigs[inputIndex].zOrder = zOrder;
-    }
+    mParamBlock.update([inputIndex, zOrder](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            params.inputs[inputIndex].zOrder = zOrder;
+        }
+    });
+}
+
+void CompositeEntity::setInputRect(size_t inputIndex, float x, float y, float width, float height) {
+    mParamBlock.update([=](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            float* rect = params.inputs[inputIndex].rect;
+            rect[0] = x;
+            rect[1] = y;
+            rect[2] = std::max(0.0f, width);
+            rect[3] = std::max(0.0f, height);
+        }
+    });
+}
+
+void CompositeEntity::setInputSourceRect(size_t inputIndex, float x, float y, float width, float height) {
+    mParamBlock.update([=](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            float* rect = params.inputs[inputIndex].sourceRect;
+            rect[0] = x;
+            rect[1] = y;
+            rect[2] = width;
+            rect[3] = height;
+        }
+    });
+}
+
+void CompositeEntity::setInputOpaque(size_t inputIndex, bool opaque) {
+    mParamBlock.update([inputIndex, opaque](CompositeParams& params) {
+        if (inputIndex < params.inputs.size()) {
+            params.inputs[inputIndex].opaque = opaque;
+        }
+    });
 }
 
 // =============================================================================
@@ -299,17 +459,39 @@ void CompositeEntity::setInputZOrder(size_t inputIndex, int32_t zOrder) {
 // =============================================================================
 
 size_t CompositeEntity::addInput() {
-    size_t index = mInputConfigs.size();
-    mInputConfigs.push_back(InputConfig{});
+    size_t index = 0;
+    mParamBlock.update([&index](CompositeParams& params) {
+        index = params.inputs.size();
+        params.inputs.push_back(InputConfig{});
+    });
     addInputPort("input" + std::to_string(index));
     return index;
 }
 
+size_t CompositeEntity::getInputCount() const {
+    return mParamBlock.read([](const CompositeParams& params) { return params.inputs.size(); });
+}
+
 // =============================================================================
 // Shader设置
 // =============================================================================
 
 bool CompositeEntity::setupShader() {
+    if (mLayout == CompositeLayout::Layers) {
+        // 图层数只影响实例数据，着色器固定
+        if (mBlendMode != BlendMode::Normal) {
+            // 图层间用固定管线 Alpha 混合；其余混合模式需读取下层颜色，请改用模板布局
+            PIPELINE_LOGW("CompositeEntity %s: Layers layout only supports Normal blending",
+                          getName().c_str());
+        }
+        mVertexShaderSource = kLayerVertexShader;
+        mFragmentShaderSource = kLayerFragmentShader;
+        mShaderProgram = acquireShaderProgram(mVertexShaderSource, mFragmentShaderSource);
+        setRasterBlend(RasterBlend::Alpha);
+        return true;
+    }
+    setRasterBlend(RasterBlend::None);
+    
     // 生成着色器源码
     std::string fragmentSource = generateBlendShader();
     
@@ -317,9 +499,8 @@ bool CompositeEntity::setupShader() {
     mVertexShaderSource = kCompositeVertexShader;
     mFragmentShaderSource = fragmentSource;
     
-    // TODO: 使用LREngine创建着色器程序
-    // mShaderProgram = mRenderContext->createShaderProgram(
-    //     mVertexShaderSource, mFragmentShaderSource);
+    // 输入数量/混合模式变化后生成的源码若与之前相同，直接复用已编译的程序
+    mShaderProgram = acquireShaderProgram(mVertexShaderSource, mFragmentShaderSource);
     
     // 缓存Uniform位置
     // mBlendModeLocation = mShaderProgram->getUniformLocation("uBlendMode");
@@ -410,6 +591,10 @@ void CompositeEntity::calculateUVTransforms() {
             }
             break;
             
+        case CompositeLayout::Layers:
+            // 图层使用各自的 rect / sourceRect
+            break;
+            
         case CompositeLayout::PictureInPicture:
             // 画中画：主画面全屏，副画面小窗
             if (mInputConfigs.size() >= 2) {
@@ -463,6 +648,10 @@ bool CompositeEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
         }
     }
     
+    if (mLayout == CompositeLayout::Layers) {
+        return processLayers(inputs);
+    }
+    
     // TODO: 实际的GPU合成渲染
     // 1. 绑定FBO
     // mFrameBuffer->bind();
@@ -520,4 +709,142 @@ bool CompositeEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
     return true;
 }
 
+// =============================================================================
+// 实例化图层合成
+// =============================================================================
+
+size_t CompositeEntity::buildLayerBatches(const std::vector<FramePacketPtr>& inputs) {
+    mLayerOrder.clear();
+    mLayerInstances.clear();
+    mLayerBatches.clear();
+    mLayersCoverOutput = false;
+    
+    const size_t count = std::min(inputs.size(), mInputConfigs.size());
+    for (size_t i = 0; i < count; ++i) {
+        const InputConfig& config = mInputConfigs[i];
+        const float* rect = config.rect;
+        const bool onScreen = rect[2] > 0.0f && rect[3] > 0.0f &&
+                              rect[0] < 1.0f && rect[1] < 1.0f &&
+                              rect[0] + rect[2] > 0.0f && rect[1] + rect[3] > 0.0f;
+        if (config.visible && config.alpha > 0.0f && onScreen &&
+            inputs[i] && inputs[i]->getTexture()) {
+            mLayerOrder.push_back(i);
+        }
+    }
+    
+    // Z序从低到高；相同Z序保持输入顺序
+    std::stable_sort(mLayerOrder.begin(), mLayerOrder.end(), [this](size_t a, size_t b) {
+        return mInputConfigs[a].zOrder < mInputConfigs[b].zOrder;
+    });
+    
+    // 自顶向下剔除被上层不透明图层完全覆盖的图层；遇到覆盖全屏的不透明层即停止
+    static const float kFullRect[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    std::vector<const float*> occluders;
+    size_t firstDrawn = 0;
+    for (size_t pos = mLayerOrder.size(); pos-- > 0;) {
+        const InputConfig& config = mInputConfigs[mLayerOrder[pos]];
+        bool hidden = false;
+        for (const float* occluder : occluders) {
+            if (rectContains(occluder, config.rect)) {
+                hidden = true;
+                break;
+            }
+        }
+        if (hidden) {
+            mLayerOrder[pos] = SIZE_MAX;
+            continue;
+        }
+        if (config.opaque && config.alpha >= 1.0f) {
+            occluders.push_back(config.rect);
+            if (rectContains(config.rect, kFullRect)) {
+                mLayersCoverOutput = true;
+                firstDrawn = pos;
+                break;
+            }
+        }
+    }
+    for (size_t pos = 0; pos < firstDrawn; ++pos) {
+        mLayerOrder[pos] = SIZE_MAX;
+    }
+    
+    // 按绘制顺序生成实例；纹理单元用满时开始新批次，同一纹理（图集）复用单元
+    for (size_t index : mLayerOrder) {
+        if (index == SIZE_MAX) {
+            continue;
+        }
+        const InputConfig& config = mInputConfigs[index];
+        lrengine::render::LRTexture* texture = inputs[index]->getTexture().get();
+        
+        if (mLayerBatches.empty() ||
+            (mLayerBatches.back().textures.size() >= kMaxLayerTextureUnits &&
+             std::find(mLayerBatches.back().textures.begin(), mLayerBatches.back().textures.end(),
+                       texture) == mLayerBatches.back().textures.end())) {
+            LayerBatch batch;
+            batch.firstInstance = static_cast<uint32_t>(mLayerInstances.size());
+            mLayerBatches.push_back(std::move(batch));
+        }
+        LayerBatch& batch = mLayerBatches.back();
+        auto slot = std::find(batch.textures.begin(), batch.textures.end(), texture);
+        if (slot == batch.textures.end()) {
+            batch.textures.push_back(texture);
+            slot = batch.textures.end() - 1;
+        }
+        
+        LayerInstance instance;
+        std::memcpy(instance.dstRect, config.rect, sizeof(instance.dstRect));
+        std::memcpy(instance.srcRect, config.sourceRect, sizeof(instance.srcRect));
+        instance.alpha = config.alpha;
+        instance.textureSlot = static_cast<float>(slot - batch.textures.begin());
+        mLayerInstances.push_back(instance);
+        ++batch.instanceCount;
+    }
+    
+    return mLayerInstances.size();
+}
+
+bool CompositeEntity::processLayers(const std::vector<FramePacketPtr>& inputs) {
+    buildLayerBatches(inputs);
+    
+    // 只有贴纸/图层移动时，清屏与绘制都限制在新旧位置的并集内
+    uint32_t scissor[4] = {0, 0, 0, 0};
+    const bool scissored = getRenderScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+    (void)scissored;
+    
+    // 混合写在共享的管线状态里，同格式的其他 Layers 节点复用同一个对象
+    ensurePipelineState();
+    
+    // 实例化绘制尚未接入渲染后端，批次与脏区已就绪，提交部分保留如下
+    if (!mLayersDrawWarned) {
+        mLayersDrawWarned = true;
+        PIPELINE_LOGW("CompositeEntity %s: instanced Layers draw is not available in this build, "
+                      "%zu layers in %zu batches not drawn", getName().c_str(),
+                      mLayerInstances.size(), mLayerBatches.size());
+    }
+    // mFrameBuffer->bind();
+    // glViewport(0, 0, mOutputWidth, mOutputHeight);
+    // if (scissored) {
+    //     glEnable(GL_SCISSOR_TEST);
+    //     glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+    // }
+    // if (!mLayersCoverOutput) {
+    //     glClearColor(0, 0, 0, 0);
+    //     glClear(GL_COLOR_BUFFER_BIT);
+    // }
+    // mRenderContext->SetPipelineState(mPipelineState.get());
+    // mInstanceBuffer->upload(mLayerInstances.data(), mLayerInstances.size() * sizeof(LayerInstance));
+    // for (const auto& batch : mLayerBatches) {
+    //     for (size_t unit = 0; unit < batch.textures.size(); ++unit) {
+    //         mRenderContext->SetTexture(batch.textures[unit], unit);
+    //         mShaderProgram->setUniform("uLayer" + std::to_string(unit), (int)unit);
+    //     }
+    //     // 实例属性偏移到本批次起点（glVertexAttribDivisor = 1）
+    //     bindInstanceAttributes(batch.firstInstance * sizeof(LayerInstance));
+    //     glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.instanceCount);
+    // }
+    // glDisable(GL_SCISSOR_TEST);
+    // mFrameBuffer->unbind();
+    
+    return true;
+}
+
 } // namespace pipeline
@@ -5,8 +5,19 @@
 
 #include "pipeline/entity/GPUEntity.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/data/GpuCommandContext.h"
 #include "pipeline/pool/TexturePool.h"
 #include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/pool/ShaderProgramCache.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __ANDROID__
+#include <GLES3/gl31.h>
+#endif
 
 // LREngine头文件（实际使用时需要包含）
  #include "lrengine/core/LRRenderContext.h"
@@ -97,10 +108,80 @@ bool GPUEntity::loadShaderFromFile(const std::string& vertexPath,
 void GPUEntity::setOutputSize(uint32_t width, uint32_t height) {
     mOutputWidth = width;
     mOutputHeight = height;
+    markParametersDirty();
 }
 
 void GPUEntity::setOutputFormat(PixelFormat format) {
     mOutputFormat = format;
+    markParametersDirty();
+}
+
+PixelFormat GPUEntity::getEffectiveOutputFormat() const {
+    PixelFormat negotiated = getNegotiatedOutputFormat(0);
+    return negotiated != PixelFormat::Unknown ? negotiated : mOutputFormat;
+}
+
+std::vector<PixelFormat> GPUEntity::getOutputFormatCandidates(size_t port) const {
+    if (port != 0) {
+        return {};
+    }
+    // 配置的格式优先；下游要求更高精度时依次尝试同带宽的 RGB10A2 与半浮点
+    std::vector<PixelFormat> candidates{mOutputFormat};
+    for (PixelFormat format : {PixelFormat::RGB10A2, PixelFormat::RGBA16F,
+                               PixelFormat::RGBA32F, PixelFormat::RGBA8}) {
+        if (format != mOutputFormat) {
+            candidates.push_back(format);
+        }
+    }
+    return candidates;
+}
+
+PixelFormatSet GPUEntity::getDefaultAcceptedInputFormats(size_t port) const {
+    // 着色器按普通纹理采样，多平面 YUV 与 OES 须在上游转换
+    return kRGBPixelFormats;
+}
+
+void GPUEntity::resolveOutputSize(uint32_t inputWidth, uint32_t inputHeight,
+                                  uint32_t& width, uint32_t& height) const {
+    width = mOutputWidth > 0 ? mOutputWidth : inputWidth;
+    height = mOutputHeight > 0 ? mOutputHeight : inputHeight;
+}
+
+void GPUEntity::resolveOutputSize(const FramePacket& input,
+                                  uint32_t& width, uint32_t& height) const {
+    const float renderScale = input.getRenderScale();
+    const float pixelScale = input.getPixelScale();
+    if (renderScale == pixelScale && (renderScale == 1.0f || (mOutputWidth == 0 && mOutputHeight == 0))) {
+        // 全分辨率，或沿用已按本帧比例渲染的输入尺寸
+        resolveOutputSize(input.getWidth(), input.getHeight(), width, height);
+        return;
+    }
+    
+    auto scaled = [](uint32_t explicitSize, uint32_t inputSize, float inputScale, float scale) {
+        float full = explicitSize > 0 ? static_cast<float>(explicitSize)
+                                      : static_cast<float>(inputSize) / std::max(inputScale, 1e-3f);
+        return std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(full * scale)));
+    };
+    width = scaled(mOutputWidth, input.getWidth(), pixelScale, renderScale);
+    height = scaled(mOutputHeight, input.getHeight(), pixelScale, renderScale);
+}
+
+bool GPUEntity::warmupResources(PipelineContext& context, uint32_t width, uint32_t height) {
+    if (!prepare(context)) {
+        return false;
+    }
+    if (width == 0 || height == 0) {
+        return true;
+    }
+    if (!ensureFrameBuffer(width, height)) {
+        return false;
+    }
+    
+    // 池化的输出纹理立即归还，留给首帧使用
+    if (mOutputFromPool) {
+        mOutputTexture.reset();
+    }
+    return true;
 }
 
 // =============================================================================
@@ -115,6 +196,9 @@ bool GPUEntity::prepare(PipelineContext& context) {
     if (!mRenderContext) {
         return false;
     }
+    mTexturePool = context.getTexturePool();
+    mGpuResources = context.getGpuResourceRegistry();
+    mFrameFormat = getEffectiveOutputFormat();
     
     // 确保着色器已创建
     if (mShaderNeedsRebuild || !mShaderProgram) {
@@ -123,6 +207,16 @@ bool GPUEntity::prepare(PipelineContext& context) {
         }
         mShaderNeedsRebuild = false;
     }
+    ensurePipelineState();
+    
+    // 计算路径：能力只查询一次，内核编译失败时回退到片段路径
+    if (mComputeSupport < 0) {
+        mComputeSupport = isComputeSupported(mRenderContext) ? 1 : 0;
+    }
+    if (isComputeActive() && !ensureComputeProgram()) {
+        PIPELINE_LOGW("GPUEntity %s: compute kernel unavailable, using fragment path",
+                      getName().c_str());
+    }
     
     // 确保全屏顶点缓冲已创建
     if (!mFullscreenQuad) {
@@ -143,43 +237,106 @@ bool GPUEntity::process(const std::vector<FramePacketPtr>& inputs,
     
     auto input = inputs[0];
     
-    // 确定输出尺寸
-    uint32_t outWidth = mOutputWidth > 0 ? mOutputWidth : input->getWidth();
-    uint32_t outHeight = mOutputHeight > 0 ? mOutputHeight : input->getHeight();
+    // 确定输出尺寸（代理分辨率帧按渲染比例缩小）
+    uint32_t outWidth = 0;
+    uint32_t outHeight = 0;
+    resolveOutputSize(*input, outWidth, outHeight);
+    mRenderScale = input->getRenderScale();
     
-    // 确保FrameBuffer已创建
-    if (!ensureFrameBuffer(outWidth, outHeight)) {
-        return false;
-    }
-    
-    // 创建输出FramePacket
-    auto texturePool = context.getTexturePool();
-    auto packetPool = context.getFramePacketPool();
-    
-    FramePacketPtr output;
-    if (packetPool) {
-        output = packetPool->acquire();
-    } else {
-        output = std::make_shared<FramePacket>(input->getFrameId());
+    // 输入与参数未变：沿用上一帧输出；仅局部参数变化：在保留的纹理上重绘脏区
+    if (!mReuseUnchangedOutput && mCachedOutputTexture) {
+        resetOutputCache();         // 已关闭复用：保留的纹理归还纹理池
     }
+    bool partial = false;
+    const bool reuse = mReuseUnchangedOutput && !mActiveFusion &&
+                       canReuseOutput(inputs, outWidth, outHeight, partial);
     
-    if (!output) {
+    if (reuse) {
+        // 保留的纹理由缓存持有；有纹理池时本帧交给输出帧包后不再额外持有
+        mOutputTexture = mCachedOutputTexture;
+        mOutputFromPool = !mTexturePool.expired();
+        if (partial) {
+            // mFrameBuffer->AttachColorTexture(mOutputTexture.get(), 0);
+        }
+    } else if (!ensureFrameBuffer(outWidth, outHeight)) {
         return false;
     }
     
+    // 创建输出FramePacket
+    FramePacketPtr output = context.acquireFramePacket();
+    
     // 复制基本信息
     output->setFrameId(input->getFrameId());
     output->setTimestamp(input->getTimestamp());
     output->setSize(outWidth, outHeight);
-    output->setFormat(mOutputFormat);
+    output->setFormat(mFrameFormat);
+    output->setRenderScale(mRenderScale);
+    output->setPixelScale(mRenderScale);
+    output->setRoi(input->getRoi());
     
-    // 执行GPU处理
-    if (!processGPU(inputs, output)) {
-        return false;
+    if (reuse && !partial) {
+        mReusedFrames.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // 执行GPU处理（链首一次绘制整条融合链）
+        mScissorActive = partial ||
+                         (!reuse && !mActiveFusion && beginRoiRender(*input, outWidth, outHeight));
+        bool rendered = false;
+        if (mActiveFusion) {
+            rendered = processFusedGPU(*mActiveFusion, inputs, output);
+        } else if (isComputeActive() && ensureComputeProgram()) {
+            rendered = processGPUCompute(inputs, output);
+        } else {
+            rendered = processGPU(inputs, output);
+        }
+        mScissorActive = false;
+        if (!rendered) {
+            if (partial) {
+                // 保留的纹理可能只写了一部分，下一帧整帧重绘
+                resetOutputCache();
+            }
+            return false;
+        }
+        if (partial) {
+            mPartialRenders.fetch_add(1, std::memory_order_relaxed);
+        }
     }
     
-    // 设置输出纹理
+    // 设置输出纹理（池化纹理的所有权交给输出帧包）
     output->setTexture(mOutputTexture);
+    if (reuse && !partial) {
+        output->setContentGeneration(mCachedGeneration);
+    } else if (mReuseUnchangedOutput && !mActiveFusion) {
+        mCachedGeneration = output->getContentGeneration();
+        updateOutputCache(inputs);
+    }
+    
+    // 跨队列消费者据此等待本帧的GPU工作
+    if (mSignalFence) {
+        output->signalGpu();
+    }
+    
+    // 异步读回：有传输队列时GPU队列只插入栅栏，拷贝在传输上下文发起；
+    // 否则在GPU队列上发起，与后续帧的渲染重叠
+    if (mAsyncReadback && mOutputTexture) {
+        if (auto readback = context.getReadbackService()) {
+            GpuFencePtr fence;
+            if (context.hasTransferQueue()) {
+                fence = output->getGpuFence() ? output->getGpuFence() : GpuFence::insert();
+            }
+            if (fence) {
+                output->setPendingReadback(
+                    readback->enqueueAfter(mOutputTexture, fence, outWidth, outHeight, mFrameFormat));
+            } else {
+                readback->poll();
+                output->setPendingReadback(
+                    readback->enqueue(*mOutputTexture, outWidth, outHeight, mFrameFormat));
+            }
+        }
+    }
+    
+    if (mOutputFromPool) {
+        mOutputTexture.reset();
+    }
     
     outputs.push_back(output);
     return true;
@@ -189,6 +346,288 @@ void GPUEntity::finalize(PipelineContext& context) {
     // 清理临时资源（如果需要）
 }
 
+// =============================================================================
+// 批处理
+// =============================================================================
+
+void GPUEntity::beginBatch(PipelineContext& context, size_t frameCount) {
+    mInBatch = frameCount > 1;
+    mBatchBound = false;
+}
+
+void GPUEntity::endBatch(PipelineContext& context) {
+    if (mBatchBound) {
+        // mRenderContext->EndRenderPass();
+    }
+    mInBatch = false;
+    mBatchBound = false;
+}
+
+// =============================================================================
+// 着色器融合
+// =============================================================================
+
+bool GPUEntity::isFusionCandidate() const {
+    // 计算内核不是逐像素片段，不能并入融合绘制
+    if (mAsyncReadback || mSignalFence || isComputeActive()) {
+        return false;
+    }
+    PixelShaderSnippet snippet;
+    return getPixelSnippet(snippet);
+}
+
+void GPUEntity::invalidateShader() {
+    mNeedsShaderUpdate = true;
+    mShaderRevision.fetch_add(1, std::memory_order_acq_rel);
+    markParametersDirty();
+}
+
+bool GPUEntity::ensureFusedProgram(const ShaderFusionChain& chain) {
+    // 链身份 + 各成员的片段版本与启用状态，任一变化即重建
+    uint64_t key = chain.id;
+    for (const GPUEntity* member : chain.members) {
+        key = (key ^ (member->getShaderRevision() << 1 | (member->isEnabled() ? 1 : 0))) *
+              1099511628211ull;
+    }
+    if (mFusedProgram && key == mFusedProgramKey) {
+        return true;
+    }
+    
+    std::vector<PixelShaderSnippet> snippets;
+    std::vector<std::string> prefixes;
+    mFusedStageEnabled.assign(chain.members.size(), 0);
+    for (size_t i = 0; i < chain.members.size(); ++i) {
+        GPUEntity* member = chain.members[i];
+        if (!member->isEnabled()) {
+            continue;
+        }
+        PixelShaderSnippet snippet;
+        if (!member->getPixelSnippet(snippet)) {
+            PIPELINE_LOGE("Fused entity %s no longer provides a pixel snippet",
+                          member->getName().c_str());
+            return false;
+        }
+        // 成员不经过自己的 prepare()，额外资源（LUT等）沿用链首的渲染上下文创建
+        if (!member->mRenderContext) {
+            member->mRenderContext = mRenderContext;
+        }
+        snippets.push_back(std::move(snippet));
+        prefixes.push_back(getFusionPrefix(i));
+        mFusedStageEnabled[i] = 1;
+    }
+    
+    mFusedFragmentSource = buildFusedFragmentShader(snippets, prefixes);
+    mFusedProgram = acquireShaderProgram(sDefaultVertexShader, mFusedFragmentSource);
+    
+    mFusedProgramKey = key;
+    PIPELINE_LOGD("Built fused shader for %s: %zu stages", getName().c_str(), snippets.size());
+    return mFusedProgram != nullptr;
+}
+
+bool GPUEntity::processFusedGPU(const ShaderFusionChain& chain,
+                                const std::vector<FramePacketPtr>& inputs,
+                                FramePacketPtr output) {
+    if (!mRenderContext || !mFrameBuffer || !ensureFusedProgram(chain)) {
+        return false;
+    }
+    
+    // 融合程序与单独绘制的管线状态不同，逐帧绑定
+    GpuCommandContext& commands = GpuCommandContext::current();
+    void* commandBuffer = commands.beginPass();
+    (void)commandBuffer;
+    if (commands.bindFrameBuffer(mFrameBuffer.get())) {
+        // mRenderContext->BeginRenderPass(mFrameBuffer.get(), commandBuffer);
+    }
+    if (commands.setViewport(0, 0, output->getWidth(), output->getHeight())) {
+        // mRenderContext->SetViewport(0, 0, output->getWidth(), output->getHeight());
+    }
+    if (commands.bindProgram(mFusedProgram.get())) {
+        // mRenderContext->SetShaderProgram(mFusedProgram.get());
+    }
+    mBatchBound = false;
+    
+    bindInputTextures(inputs, 0);
+    
+    uint32_t textureUnit = static_cast<uint32_t>(inputs.size());
+    for (size_t i = 0; i < chain.members.size(); ++i) {
+        if (i < mFusedStageEnabled.size() && mFusedStageEnabled[i]) {
+            // 成员不单独执行，参数在链首绘制时锁存
+            if (i > 0) {
+                chain.members[i]->latchParameters();
+            }
+            chain.members[i]->setSnippetUniforms(mFusedProgram.get(), getFusionPrefix(i), textureUnit);
+        }
+    }
+    
+    drawFullscreenQuad();
+    
+    unbindInputTextures(textureUnit, 0);
+    // mRenderContext->EndRenderPass();
+    
+    return true;
+}
+
+// =============================================================================
+// 输出复用
+// =============================================================================
+
+void GPUEntity::setReuseUnchangedOutput(bool enabled) {
+    mReuseUnchangedOutput = enabled;
+    // 开关切换在GPU队列之外进行：只让缓存失效，纹理由下一帧绘制时替换
+    markParametersDirty();
+}
+
+void GPUEntity::markParametersDirty() {
+    {
+        std::lock_guard<std::mutex> lock(mDirtyMutex);
+        mDirtyFull = true;
+    }
+    mParameterVersion.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void GPUEntity::markParametersDirty(const float rect[4]) {
+    if (!rect || rect[2] <= 0.0f || rect[3] <= 0.0f) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mDirtyMutex);
+        if (mDirtyRect[2] <= 0.0f || mDirtyRect[3] <= 0.0f) {
+            std::copy(rect, rect + 4, mDirtyRect);
+        } else {
+            float x0 = std::min(mDirtyRect[0], rect[0]);
+            float y0 = std::min(mDirtyRect[1], rect[1]);
+            float x1 = std::max(mDirtyRect[0] + mDirtyRect[2], rect[0] + rect[2]);
+            float y1 = std::max(mDirtyRect[1] + mDirtyRect[3], rect[1] + rect[3]);
+            mDirtyRect[0] = x0;
+            mDirtyRect[1] = y0;
+            mDirtyRect[2] = x1 - x0;
+            mDirtyRect[3] = y1 - y0;
+        }
+    }
+    mParameterVersion.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool GPUEntity::getRenderScissor(uint32_t& x, uint32_t& y,
+                                 uint32_t& width, uint32_t& height) const {
+    if (!mScissorActive) {
+        return false;
+    }
+    x = mScissor[0];
+    y = mScissor[1];
+    width = mScissor[2];
+    height = mScissor[3];
+    return true;
+}
+
+void GPUEntity::onParameterChanged(const std::string& key) {
+    markParametersDirty();
+}
+
+bool GPUEntity::canReuseOutput(const std::vector<FramePacketPtr>& inputs,
+                               uint32_t width, uint32_t height, bool& partial) {
+    partial = false;
+    if (!mCachedOutputTexture || width != mCachedWidth || height != mCachedHeight ||
+        mFrameFormat != mCachedFormat || inputs.size() != mCachedInputGenerations.size()) {
+        return false;
+    }
+    
+    // 代号为0的输入来源未知（如未经 setTexture 写入），不能判定未变
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        uint64_t generation = inputs[i] ? inputs[i]->getContentGeneration() : 0;
+        if (generation == 0 || generation != mCachedInputGenerations[i]) {
+            return false;
+        }
+    }
+    
+    if (mParameterVersion.load(std::memory_order_acquire) == mCachedParameterVersion) {
+        return true;
+    }
+    
+    float rect[4];
+    {
+        std::lock_guard<std::mutex> lock(mDirtyMutex);
+        if (mDirtyFull) {
+            return false;
+        }
+        std::copy(mDirtyRect, mDirtyRect + 4, rect);
+    }
+    if (rect[2] <= 0.0f || rect[3] <= 0.0f) {
+        return false;
+    }
+    
+    // 下游仍持有上一帧输出（如显示端尚未释放）时不能原地改写
+    long holders = mCachedOutputTexture.use_count() -
+                   (mOutputTexture == mCachedOutputTexture ? 1 : 0);
+    if (holders > 1) {
+        return false;
+    }
+    
+    // 归一化脏区向外取整到像素
+    auto toPixel = [](float v, uint32_t extent, bool roundUp) {
+        float scaled = std::clamp(v, 0.0f, 1.0f) * static_cast<float>(extent);
+        return static_cast<uint32_t>(roundUp ? std::ceil(scaled) : std::floor(scaled));
+    };
+    uint32_t x0 = toPixel(rect[0], width, false);
+    uint32_t y0 = toPixel(rect[1], height, false);
+    uint32_t x1 = toPixel(rect[0] + rect[2], width, true);
+    uint32_t y1 = toPixel(rect[1] + rect[3], height, true);
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    mScissor[0] = x0;
+    mScissor[1] = y0;
+    mScissor[2] = x1 - x0;
+    mScissor[3] = y1 - y0;
+    partial = true;
+    return true;
+}
+
+bool GPUEntity::beginRoiRender(const FramePacket& input, uint32_t width, uint32_t height) {
+    if (!isRoiLimited() || !input.hasRoi() || !input.getTexture() || !mOutputTexture) {
+        return false;
+    }
+    
+    uint32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    if (!input.getRoi().toPixels(width, height, x0, y0, x1, y1)) {
+        return false;               // 区域在画面外：按整帧处理，不留未定义像素
+    }
+    
+    // ROI外沿用输入像素（尺寸不同时按代理比例缩放拷贝）
+    // mRenderContext->BlitTexture(input.getTexture().get(), mOutputTexture.get());
+    
+    mScissor[0] = x0;
+    mScissor[1] = y0;
+    mScissor[2] = x1 - x0;
+    mScissor[3] = y1 - y0;
+    mRoiRenders.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void GPUEntity::updateOutputCache(const std::vector<FramePacketPtr>& inputs) {
+    mCachedOutputTexture = mOutputTexture;
+    mCachedInputGenerations.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        mCachedInputGenerations[i] = inputs[i] ? inputs[i]->getContentGeneration() : 0;
+    }
+    mCachedWidth = mFrameBufferWidth;
+    mCachedHeight = mFrameBufferHeight;
+    mCachedFormat = mFrameFormat;
+    
+    // 先读版本再清脏区：绘制期间到达的修改留给下一帧
+    std::lock_guard<std::mutex> lock(mDirtyMutex);
+    mCachedParameterVersion = mParameterVersion.load(std::memory_order_acquire);
+    mDirtyFull = false;
+    mDirtyRect[0] = mDirtyRect[1] = mDirtyRect[2] = mDirtyRect[3] = 0.0f;
+}
+
+void GPUEntity::resetOutputCache() {
+    mCachedOutputTexture.reset();
+    mCachedInputGenerations.clear();
+    mCachedGeneration = 0;
+    mCachedWidth = 0;
+    mCachedHeight = 0;
+}
+
 // =============================================================================
 // 子类实现
 // =============================================================================
@@ -198,43 +637,82 @@ bool GPUEntity::setupShader() {
         return false;
     }
     
-    // 使用LREngine创建着色器程序
-    // 这里需要根据LREngine的实际API来实现
-    /*
-    // 创建顶点着色器
-    lrengine::render::ShaderDescriptor vsDesc;
-    vsDesc.stage = lrengine::render::ShaderStage::Vertex;
-    vsDesc.source = mVertexShaderSource.c_str();
-    auto vs = mRenderContext->CreateShader(vsDesc);
-    
-    // 创建片段着色器
-    lrengine::render::ShaderDescriptor fsDesc;
-    fsDesc.stage = lrengine::render::ShaderStage::Fragment;
-    fsDesc.source = mFragmentShaderSource.c_str();
-    auto fs = mRenderContext->CreateShader(fsDesc);
-    
-    // 创建着色器程序
-    mShaderProgram = std::shared_ptr<lrengine::render::LRShaderProgram>(
-        mRenderContext->CreateShaderProgram(vs, fs));
-    */
+    mShaderProgram = acquireShaderProgram(mVertexShaderSource, mFragmentShaderSource);
     
     return true;
 }
 
+std::shared_ptr<lrengine::render::LRShaderProgram> GPUEntity::acquireShaderProgram(
+    const std::string& vertexSource, const std::string& fragmentSource) {
+    if (!mRenderContext) {
+        return nullptr;
+    }
+    
+    auto* renderContext = mRenderContext;
+    return ShaderProgramCache::instance().acquire(
+        renderContext, vertexSource, fragmentSource,
+        [renderContext, &vertexSource, &fragmentSource]() -> ShaderProgramPtr {
+            // 使用LREngine创建着色器程序
+            // 这里需要根据LREngine的实际API来实现
+            /*
+            // 创建顶点着色器
+            lrengine::render::ShaderDescriptor vsDesc;
+            vsDesc.stage = lrengine::render::ShaderStage::Vertex;
+            vsDesc.source = vertexSource.c_str();
+            auto vs = renderContext->CreateShader(vsDesc);
+            
+            // 创建片段着色器
+            lrengine::render::ShaderDescriptor fsDesc;
+            fsDesc.stage = lrengine::render::ShaderStage::Fragment;
+            fsDesc.source = fragmentSource.c_str();
+            auto fs = renderContext->CreateShader(fsDesc);
+            
+            // 创建着色器程序
+            return ShaderProgramPtr(renderContext->CreateShaderProgram(vs, fs));
+            */
+            return nullptr;
+        });
+}
+
 bool GPUEntity::processGPU(const std::vector<FramePacketPtr>& inputs, 
                           FramePacketPtr output) {
     if (!mRenderContext || !mShaderProgram || !mFrameBuffer) {
         return false;
     }
     
-    // 开始渲染到FBO
-    // mRenderContext->BeginRenderPass(mFrameBuffer.get());
-    
-    // 设置视口
-    // mRenderContext->SetViewport(0, 0, output->getWidth(), output->getHeight());
+    // 批内尺寸不变时沿用首帧的FBO/视口/着色器绑定
+    bool rebind = !mBatchBound || mBoundWidth != output->getWidth() ||
+                  mBoundHeight != output->getHeight();
+    if (rebind) {
+        // 开始渲染到FBO（录制模式下编码进本帧共用的命令缓冲，帧末统一提交）
+        GpuCommandContext& commands = GpuCommandContext::current();
+        void* commandBuffer = commands.beginPass();
+        (void)commandBuffer;
+        if (commands.bindFrameBuffer(mFrameBuffer.get())) {
+            // mRenderContext->BeginRenderPass(mFrameBuffer.get(), commandBuffer);
+        }
+        
+        // 设置视口
+        if (commands.setViewport(0, 0, output->getWidth(), output->getHeight())) {
+            // mRenderContext->SetViewport(0, 0, output->getWidth(), output->getHeight());
+        }
+        
+        // 绑定着色器（程序或输出格式可能在 prepare 之后变化）
+        ensurePipelineState();
+        if (commands.bindPipelineState(mPipelineState.get())) {
+            // mRenderContext->SetPipelineState(mPipelineState.get());
+        }
+        
+        mBatchBound = mInBatch;
+        mBoundWidth = output->getWidth();
+        mBoundHeight = output->getHeight();
+    }
     
-    // 绑定着色器
-    // mRenderContext->SetPipelineState(mPipelineState.get());
+    // 局部重绘：只写脏区，其余像素保留上一帧结果
+    uint32_t scissorX = 0, scissorY = 0, scissorW = 0, scissorH = 0;
+    if (getRenderScissor(scissorX, scissorY, scissorW, scissorH)) {
+        // mRenderContext->SetScissor(scissorX, scissorY, scissorW, scissorH);
+    }
     
     // 绑定输入纹理
     bindInputTextures(inputs, 0);
@@ -250,8 +728,14 @@ bool GPUEntity::processGPU(const std::vector<FramePacketPtr>& inputs,
     // 解绑纹理
     unbindInputTextures(inputs.size(), 0);
     
-    // 结束渲染
-    // mRenderContext->EndRenderPass();
+    if (scissorW > 0) {
+        // mRenderContext->DisableScissor();
+    }
+    
+    // 结束渲染（批内保持绑定，由endBatch结束）
+    if (!mBatchBound) {
+        // mRenderContext->EndRenderPass();
+    }
     
     return true;
 }
@@ -261,10 +745,31 @@ bool GPUEntity::ensureFrameBuffer(uint32_t width, uint32_t height) {
         return false;
     }
     
-    // 检查是否需要重建
-    if (mOutputTexture && mFrameBuffer) {
-        // 这里需要检查尺寸是否匹配
-        // 暂时假设需要重建
+    bool sizeChanged = mFrameBufferWidth != width || mFrameBufferHeight != height;
+    
+    // 输出纹理每帧取自纹理池，FBO保留并重新挂接颜色纹理
+    if (auto texture = acquireTransientTexture(width, height, mFrameFormat)) {
+        mOutputTexture = std::move(texture);
+        mOutputFromPool = true;
+        /*
+        if (!mFrameBuffer || sizeChanged) {
+            lrengine::render::FrameBufferDescriptor fbDesc;
+            fbDesc.width = width;
+            fbDesc.height = height;
+            mFrameBuffer = std::shared_ptr<lrengine::render::LRFrameBuffer>(
+                mRenderContext->CreateFrameBuffer(fbDesc));
+        }
+        mFrameBuffer->AttachColorTexture(mOutputTexture.get(), 0);
+        */
+        mFrameBufferWidth = width;
+        mFrameBufferHeight = height;
+        return true;
+    }
+    mOutputFromPool = false;
+    
+    // 无纹理池：尺寸不变时沿用常驻的输出纹理
+    if (mOutputTexture && mFrameBuffer && !sizeChanged) {
+        return true;
     }
     
     // 创建输出纹理
@@ -273,7 +778,7 @@ bool GPUEntity::ensureFrameBuffer(uint32_t width, uint32_t height) {
     lrengine::render::TextureDescriptor texDesc;
     texDesc.width = width;
     texDesc.height = height;
-    texDesc.format = convertPixelFormat(mOutputFormat);
+    texDesc.format = convertPixelFormat(mFrameFormat);
     texDesc.mipLevels = 1;
     
     mOutputTexture = std::shared_ptr<lrengine::render::LRTexture>(
@@ -290,15 +795,208 @@ bool GPUEntity::ensureFrameBuffer(uint32_t width, uint32_t height) {
     // 附加颜色纹理
     mFrameBuffer->AttachColorTexture(mOutputTexture.get(), 0);
     */
+    mFrameBufferWidth = width;
+    mFrameBufferHeight = height;
     
     return true;
 }
 
+// =============================================================================
+// 计算着色器
+// =============================================================================
+
+bool GPUEntity::isComputeActive() const {
+    return mComputePreferred && !mComputeShaderSource.empty() && mComputeSupport == 1 &&
+           isImageStoreFormat(mFrameFormat);
+}
+
+bool GPUEntity::isComputeSupported(lrengine::render::LRRenderContext* context) {
+    if (!context) {
+        return false;
+    }
+#if defined(__APPLE__)
+    return true;                    // Metal 总有计算管线
+#elif defined(__ANDROID__)
+    // GLES 3.1 起提供计算着色器与 image load/store
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    return major > 3 || (major == 3 && minor >= 1);
+#else
+    // return context->GetDeviceCapabilities().computeShader;
+    return false;
+#endif
+}
+
+bool GPUEntity::isImageStoreFormat(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGBA8:
+        case PixelFormat::RGBA16F:
+        case PixelFormat::RGBA32F:
+        case PixelFormat::R8:
+            return true;
+        default:
+            // RGB8 / BGRA8 / YUV / OES 在 GLES 中没有对应的图像格式限定符
+            return false;
+    }
+}
+
+void GPUEntity::setComputeShaderSource(const std::string& source,
+                                       uint32_t localSizeX, uint32_t localSizeY) {
+    mComputeShaderSource = source;
+    mComputeLocalSize[0] = std::max<uint32_t>(1, localSizeX);
+    mComputeLocalSize[1] = std::max<uint32_t>(1, localSizeY);
+    mComputeNeedsRebuild = true;
+    markParametersDirty();
+}
+
+bool GPUEntity::ensureComputeProgram() {
+    if (mComputeProgram && !mComputeNeedsRebuild) {
+        return true;
+    }
+    mComputeProgram = acquireComputeProgram(mComputeShaderSource);
+    mComputeNeedsRebuild = false;
+    return mComputeProgram != nullptr;
+}
+
+std::shared_ptr<lrengine::render::LRShaderProgram> GPUEntity::acquireComputeProgram(
+    const std::string& computeSource) {
+    if (!mRenderContext || computeSource.empty()) {
+        return nullptr;
+    }
+    
+    // 缓存键为 (顶点, 片段) 源码：顶点位置放阶段标记，计算程序不会与片段程序混用
+    static const std::string kComputeStageTag = "#stage compute";
+    auto* renderContext = mRenderContext;
+    return ShaderProgramCache::instance().acquire(
+        renderContext, kComputeStageTag, computeSource,
+        [renderContext, &computeSource]() -> ShaderProgramPtr {
+            /*
+            lrengine::render::ShaderDescriptor csDesc;
+            csDesc.stage = lrengine::render::ShaderStage::Compute;
+            csDesc.source = computeSource.c_str();
+            auto cs = renderContext->CreateShader(csDesc);
+            
+            auto program = renderContext->CreateComputeProgram(cs);
+            return ShaderProgramPtr(program);
+            */
+            (void)renderContext;
+            (void)computeSource;
+            return nullptr;
+        });
+}
+
+bool GPUEntity::processGPUCompute(const std::vector<FramePacketPtr>& inputs,
+                                  FramePacketPtr output) {
+    if (!mRenderContext || !mComputeProgram || !mOutputTexture) {
+        return false;
+    }
+    
+    // 计算调度不在渲染通道内，批内保持的FBO绑定需先结束
+    if (mBatchBound) {
+        // mRenderContext->EndRenderPass();
+        mBatchBound = false;
+    }
+    
+    // 计算编码器同样录制进本帧命令缓冲；离开渲染通道后FBO绑定不再可信
+    GpuCommandContext& commands = GpuCommandContext::current();
+    void* commandBuffer = commands.beginPass();
+    (void)commandBuffer;
+    commands.bindFrameBuffer(nullptr);
+    if (commands.bindProgram(mComputeProgram.get())) {
+        // mRenderContext->SetComputeProgram(mComputeProgram.get());
+    }
+    bindInputTextures(inputs, 0);
+    bindImageTexture(mOutputTexture, 0, ImageAccess::WriteOnly, mFrameFormat);
+    if (!inputs.empty() && inputs[0]) {
+        setComputeUniforms(inputs[0].get());
+    }
+    
+    // 局部重绘只调度裁剪矩形覆盖的工作组
+    uint32_t originX = 0, originY = 0;
+    uint32_t width = output->getWidth();
+    uint32_t height = output->getHeight();
+    getRenderScissor(originX, originY, width, height);
+    // mComputeProgram->setUniform("uOrigin", static_cast<int>(originX), static_cast<int>(originY));
+    // mComputeProgram->setUniform("uOutputSize", static_cast<int>(output->getWidth()),
+    //                             static_cast<int>(output->getHeight()));
+    (void)originX;
+    (void)originY;
+    
+    dispatchCompute(getDispatchGroupCount(width, mComputeLocalSize[0]),
+                    getDispatchGroupCount(height, mComputeLocalSize[1]));
+    
+    // 下游按纹理采样读取本节点输出
+    computeBarrier();
+    unbindInputTextures(inputs.size(), 0);
+    return true;
+}
+
+void GPUEntity::bindImageTexture(const std::shared_ptr<lrengine::render::LRTexture>& texture,
+                                 uint32_t unit, ImageAccess access, PixelFormat format) {
+    if (!texture || !isImageStoreFormat(format)) {
+        return;
+    }
+    (void)unit;
+    (void)access;
+    // mRenderContext->SetImageTexture(texture.get(), unit, 0,
+    //                                 toLRImageAccess(access), toLRPixelFormat(format));
+}
+
+void GPUEntity::dispatchCompute(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    if (!mRenderContext || groupsX == 0 || groupsY == 0 || groupsZ == 0) {
+        return;
+    }
+    // mRenderContext->DispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+void GPUEntity::computeBarrier() {
+    // GLES: glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT)
+    // Metal: 同一命令缓冲内的编码器切换自动同步
+    // mRenderContext->MemoryBarrier(lrengine::render::BarrierFlags::ImageAndTexture);
+}
+
+std::shared_ptr<lrengine::render::LRTexture> GPUEntity::acquireTransientTexture(
+    uint32_t width, uint32_t height, PixelFormat format) {
+    auto pool = mTexturePool.lock();
+    if (!pool) {
+        return nullptr;
+    }
+    return pool->acquireAutoRelease(width, height, format);
+}
+
+bool GPUEntity::ensurePipelineState() {
+    if (!mShaderProgram) {
+        return false;
+    }
+    if (mPipelineState && mPipelineStateProgram == mShaderProgram.get() &&
+        mPipelineStateBlend == mRasterBlend && mPipelineStateFormat == mFrameFormat) {
+        return true;
+    }
+    
+    auto registry = mGpuResources.lock();
+    if (!registry) {
+        return false;
+    }
+    mPipelineState = registry->acquirePipelineState(mShaderProgram, mRasterBlend, mFrameFormat);
+    mPipelineStateProgram = mShaderProgram.get();
+    mPipelineStateBlend = mRasterBlend;
+    mPipelineStateFormat = mFrameFormat;
+    return mPipelineState != nullptr;
+}
+
 bool GPUEntity::createFullscreenQuad() {
     if (!mRenderContext) {
         return false;
     }
     
+    // 同一管线的节点共用一个四边形，图重建时不再逐节点创建
+    if (auto registry = mGpuResources.lock()) {
+        mFullscreenQuad = registry->acquireFullscreenQuad();
+        return true;
+    }
+    
     // 全屏四边形顶点数据
     // Position (x, y), TexCoord (u, v)
     static const float vertices[] = {
@@ -328,8 +1026,10 @@ void GPUEntity::drawFullscreenQuad() {
         return;
     }
     
-    // 绑定顶点缓冲
-    // mRenderContext->SetVertexBuffer(mFullscreenQuad.get(), 0);
+    // 绑定顶点缓冲（各节点共用同一个四边形，连续绘制时只绑定一次）
+    if (GpuCommandContext::current().bindVertexBuffer(mFullscreenQuad.get())) {
+        // mRenderContext->SetVertexBuffer(mFullscreenQuad.get(), 0);
+    }
     
     // 绘制三角形条带（4个顶点）
     // mRenderContext->Draw(0, 4);
@@ -337,15 +1037,25 @@ void GPUEntity::drawFullscreenQuad() {
 
 void GPUEntity::bindInputTextures(const std::vector<FramePacketPtr>& inputs, 
                                  uint32_t startSlot) {
+    GpuCommandContext& commands = GpuCommandContext::current();
     for (size_t i = 0; i < inputs.size(); ++i) {
         if (inputs[i] && inputs[i]->getTexture()) {
-            // mRenderContext->SetTexture(inputs[i]->getTexture().get(), startSlot + i);
+            const auto unit = static_cast<uint32_t>(startSlot + i);
+            if (commands.bindTexture(unit, inputs[i]->getTexture().get())) {
+                // mRenderContext->SetTexture(inputs[i]->getTexture().get(), unit);
+            }
         }
     }
 }
 
 void GPUEntity::unbindInputTextures(size_t count, uint32_t startSlot) {
+    // 跟踪状态时保留绑定：下游节点多半采样同一纹理，解绑再绑定只是驱动开销
+    GpuCommandContext& commands = GpuCommandContext::current();
+    if (commands.isStateTrackingEnabled()) {
+        return;
+    }
     for (size_t i = 0; i < count; ++i) {
+        commands.bindTexture(static_cast<uint32_t>(startSlot + i), nullptr);
         // mRenderContext->SetTexture(nullptr, startSlot + i);
     }
 }
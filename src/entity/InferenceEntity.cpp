@@ -0,0 +1,546 @@
+/**
+ * @file InferenceEntity.cpp
+ * @brief InferenceEntity实现 - 模型加载、张量预处理与分批推理
+ */
+
+#include "pipeline/entity/InferenceEntity.h"
+#include "pipeline/core/QualityController.h"
+#include "pipeline/utils/HalfFloat.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+namespace pipeline {
+
+namespace {
+
+const char* delegateName(InferenceDelegate delegate) {
+    switch (delegate) {
+        case InferenceDelegate::CPU:    return "CPU";
+        case InferenceDelegate::GPU:    return "GPU";
+        case InferenceDelegate::NNAPI:  return "NNAPI";
+        case InferenceDelegate::CoreML: return "CoreML";
+    }
+    return "Unknown";
+}
+
+template<typename T>
+T quantize(float value, const TensorDesc& desc, float lo, float hi) {
+    float scale = desc.scale != 0.0f ? desc.scale : 1.0f;
+    float q = std::round(value / scale) + static_cast<float>(desc.zeroPoint);
+    return static_cast<T>(std::clamp(q, lo, hi));
+}
+
+/**
+ * @brief 最近邻采样一个区域并经查找表写入张量
+ *
+ * 查找表已包含归一化与类型转换，每个元素只有一次查表与一次写入。
+ */
+template<typename T>
+void sampleRegion(const uint8_t* rgba, uint32_t stride,
+                  const int32_t* columns, const int32_t* rows,
+                  int32_t outWidth, int32_t outHeight, int32_t channels,
+                  TensorLayout layout, const TensorPreprocess& preprocess,
+                  const T* lut, T* dst) {
+    const size_t planeSize = static_cast<size_t>(outWidth) * outHeight;
+    const int32_t red = preprocess.swapRB ? 2 : 0;
+    const int32_t blue = preprocess.swapRB ? 0 : 2;
+
+    for (int32_t oy = 0; oy < outHeight; ++oy) {
+        const uint8_t* row = rgba + static_cast<size_t>(rows[oy]) * stride;
+        for (int32_t ox = 0; ox < outWidth; ++ox) {
+            const uint8_t* px = row + columns[ox] * 4;
+            size_t pixel = static_cast<size_t>(oy) * outWidth + ox;
+
+            if (channels == 1) {
+                uint32_t luma = (77u * px[0] + 150u * px[1] + 29u * px[2]) >> 8;
+                dst[pixel] = lut[luma];
+                continue;
+            }
+
+            T r = lut[0 * 256 + px[red]];
+            T g = lut[1 * 256 + px[1]];
+            T b = lut[2 * 256 + px[blue]];
+            if (layout == TensorLayout::NHWC) {
+                T* out = dst + pixel * 3;
+                out[0] = r;
+                out[1] = g;
+                out[2] = b;
+            } else {
+                dst[pixel] = r;
+                dst[planeSize + pixel] = g;
+                dst[2 * planeSize + pixel] = b;
+            }
+        }
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// 张量
+// =============================================================================
+
+size_t getTensorDataTypeSize(TensorDataType type) {
+    switch (type) {
+        case TensorDataType::Float32: return 4;
+        case TensorDataType::Float16: return 2;
+        case TensorDataType::Int8:
+        case TensorDataType::UInt8:   return 1;
+    }
+    return 0;
+}
+
+size_t TensorDesc::elementCount() const {
+    if (shape.empty()) {
+        return 0;
+    }
+    size_t count = 1;
+    for (int32_t dim : shape) {
+        count *= static_cast<size_t>(std::max(dim, 0));
+    }
+    return count;
+}
+
+int32_t TensorDesc::height() const {
+    if (shape.size() != 4) {
+        return 0;
+    }
+    return layout == TensorLayout::NHWC ? shape[1] : shape[2];
+}
+
+int32_t TensorDesc::width() const {
+    if (shape.size() != 4) {
+        return 0;
+    }
+    return layout == TensorLayout::NHWC ? shape[2] : shape[3];
+}
+
+int32_t TensorDesc::channels() const {
+    if (shape.size() != 4) {
+        return 0;
+    }
+    return layout == TensorLayout::NHWC ? shape[3] : shape[1];
+}
+
+float Tensor::valueAt(size_t index) const {
+    switch (desc.dataType) {
+        case TensorDataType::Float32:
+            return as<float>()[index];
+        case TensorDataType::Float16:
+            return halfToFloat(as<uint16_t>()[index]);
+        case TensorDataType::Int8:
+            return (static_cast<float>(as<int8_t>()[index]) - desc.zeroPoint) * desc.scale;
+        case TensorDataType::UInt8:
+            return (static_cast<float>(as<uint8_t>()[index]) - desc.zeroPoint) * desc.scale;
+    }
+    return 0.0f;
+}
+
+size_t Tensor::itemElementCount() const {
+    int32_t batch = std::max(desc.batch(), 1);
+    return desc.elementCount() / static_cast<size_t>(batch);
+}
+
+// =============================================================================
+// 后端注册表
+// =============================================================================
+
+InferenceBackendRegistry& InferenceBackendRegistry::instance() {
+    static InferenceBackendRegistry registry;
+    return registry;
+}
+
+void InferenceBackendRegistry::registerBackend(const std::string& name, Factory factory) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& entry : mFactories) {
+        if (entry.first == name) {
+            entry.second = std::move(factory);
+            return;
+        }
+    }
+    mFactories.emplace_back(name, std::move(factory));
+}
+
+InferenceBackendPtr InferenceBackendRegistry::create(const std::string& name) const {
+    Factory factory;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& entry : mFactories) {
+            if (entry.first == name) {
+                factory = entry.second;
+                break;
+            }
+        }
+    }
+    return factory ? factory() : nullptr;
+}
+
+bool InferenceBackendRegistry::hasBackend(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& entry : mFactories) {
+        if (entry.first == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// =============================================================================
+// InferenceEntity
+// =============================================================================
+
+InferenceEntity::InferenceEntity(const std::string& name)
+    : CPUEntity(name)
+{
+}
+
+InferenceEntity::~InferenceEntity() = default;
+
+void InferenceEntity::setModel(const std::string& backendName, const std::string& modelPath,
+                               const InferenceOptions& options) {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    bool unchanged = mModelLoaded && mBackendName == backendName && mModelPath == modelPath &&
+                     mOptions.delegate == options.delegate &&
+                     mOptions.numThreads == options.numThreads &&
+                     mOptions.maxBatchSize == options.maxBatchSize &&
+                     mOptions.allowFp16 == options.allowFp16;
+    if (unchanged) {
+        return;
+    }
+    mBackendName = backendName;
+    mModelPath = modelPath;
+    mOptions = options;
+    mBackend.reset();
+    mModelLoaded = false;
+    mLoadFailed = false;
+}
+
+void InferenceEntity::setModel(InferenceBackendPtr backend, const std::string& modelPath,
+                               const InferenceOptions& options) {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    mBackendName.clear();
+    mModelPath = modelPath;
+    mOptions = options;
+    mBackend = std::move(backend);
+    mModelLoaded = false;
+    mLoadFailed = false;
+}
+
+bool InferenceEntity::loadModel() {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    return ensureModelLoaded();
+}
+
+bool InferenceEntity::isModelLoaded() const {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    return mModelLoaded;
+}
+
+void InferenceEntity::setPreprocess(const TensorPreprocess& preprocess) {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    mPreprocess = preprocess;
+    mLutDirty = true;
+}
+
+std::vector<TensorDesc> InferenceEntity::getInputDescs() const {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    std::vector<TensorDesc> descs;
+    for (const auto& tensor : mInputs) {
+        descs.push_back(tensor.desc);
+    }
+    return descs;
+}
+
+std::vector<TensorDesc> InferenceEntity::getOutputDescs() const {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    std::vector<TensorDesc> descs;
+    for (const auto& tensor : mOutputs) {
+        descs.push_back(tensor.desc);
+    }
+    return descs;
+}
+
+bool InferenceEntity::ensureModelLoaded() {
+    if (mModelLoaded) {
+        return true;
+    }
+    if (mLoadFailed) {
+        return false;
+    }
+
+    if (!mBackend && !mBackendName.empty()) {
+        mBackend = InferenceBackendRegistry::instance().create(mBackendName);
+        if (!mBackend) {
+            PIPELINE_LOGE("Inference backend '%s' is not registered", mBackendName.c_str());
+        }
+    }
+    if (!mBackend || !mBackend->load(mModelPath, mOptions)) {
+        PIPELINE_LOGE("Failed to load model %s for %s", mModelPath.c_str(), getName().c_str());
+        mLoadFailed = true;
+        return false;
+    }
+
+    // 张量按模型的最大批大小一次分配，之后每帧只写入数据
+    mInputs.clear();
+    mOutputs.clear();
+    for (auto& desc : mBackend->getInputDescs()) {
+        Tensor tensor;
+        tensor.storage.resize(desc.byteSize());
+        tensor.desc = std::move(desc);
+        mInputs.push_back(std::move(tensor));
+    }
+    for (auto& desc : mBackend->getOutputDescs()) {
+        Tensor tensor;
+        tensor.storage.resize(desc.byteSize());
+        tensor.desc = std::move(desc);
+        mOutputs.push_back(std::move(tensor));
+    }
+    if (mInputs.empty()) {
+        PIPELINE_LOGE("Model %s has no inputs", mModelPath.c_str());
+        mLoadFailed = true;
+        return false;
+    }
+
+    int32_t modelBatch = std::max(mInputs[0].desc.batch(), 1);
+    mBatchCapacity = std::clamp<uint32_t>(mOptions.maxBatchSize, 1, static_cast<uint32_t>(modelBatch));
+    mLutDirty = true;
+    mModelLoaded = true;
+
+    InferenceDelegate active = mBackend->getActiveDelegate();
+    if (active != mOptions.delegate) {
+        PIPELINE_LOGW("%s: %s delegate unavailable, running on %s", mBackend->getName(),
+                      delegateName(mOptions.delegate), delegateName(active));
+    }
+    PIPELINE_LOGI("Loaded model %s (%s, %s, batch %u)", mModelPath.c_str(), mBackend->getName(),
+                  delegateName(active), mBatchCapacity);
+
+    onModelLoaded();
+    return true;
+}
+
+void InferenceEntity::rebuildLut(const TensorDesc& desc) {
+    size_t elementSize = getTensorDataTypeSize(desc.dataType);
+    mLut.resize(3 * 256 * elementSize);
+
+    for (int c = 0; c < 3; ++c) {
+        float stddev = mPreprocess.stddev[c] != 0.0f ? mPreprocess.stddev[c] : 1.0f;
+        for (int p = 0; p < 256; ++p) {
+            float value = (static_cast<float>(p) - mPreprocess.mean[c]) / stddev;
+            size_t index = static_cast<size_t>(c) * 256 + p;
+            switch (desc.dataType) {
+                case TensorDataType::Float32:
+                    reinterpret_cast<float*>(mLut.data())[index] = value;
+                    break;
+                case TensorDataType::Float16:
+                    reinterpret_cast<uint16_t*>(mLut.data())[index] = floatToHalf(value);
+                    break;
+                case TensorDataType::Int8:
+                    reinterpret_cast<int8_t*>(mLut.data())[index] =
+                        quantize<int8_t>(value, desc, -128.0f, 127.0f);
+                    break;
+                case TensorDataType::UInt8:
+                    mLut[index] = quantize<uint8_t>(value, desc, 0.0f, 255.0f);
+                    break;
+            }
+        }
+    }
+    mLutDirty = false;
+}
+
+bool InferenceEntity::fillImageTensor(Tensor& tensor, size_t batchIndex,
+                                      const uint8_t* rgba, uint32_t width, uint32_t height,
+                                      uint32_t stride, const InferenceRegion& region) {
+    const TensorDesc& desc = tensor.desc;
+    int32_t outWidth = desc.width();
+    int32_t outHeight = desc.height();
+    int32_t channels = desc.channels();
+    if (outWidth <= 0 || outHeight <= 0 || (channels != 1 && channels != 3) ||
+        batchIndex >= static_cast<size_t>(std::max(desc.batch(), 1))) {
+        PIPELINE_LOGE("Unsupported image tensor %s", desc.name.c_str());
+        return false;
+    }
+    if (mLutDirty) {
+        rebuildLut(desc);
+    }
+
+    // 源坐标映射：张量像素中心落到区域内的最近源像素（区域已截断到图像内）
+    float x0 = std::clamp(region.x, 0.0f, static_cast<float>(width - 1));
+    float y0 = std::clamp(region.y, 0.0f, static_cast<float>(height - 1));
+    float regionWidth = std::clamp(region.width, 1.0f, static_cast<float>(width) - x0);
+    float regionHeight = std::clamp(region.height, 1.0f, static_cast<float>(height) - y0);
+    float scaleX = regionWidth / outWidth;
+    float scaleY = regionHeight / outHeight;
+
+    mColumnMap.resize(static_cast<size_t>(outWidth) + outHeight);
+    int32_t* columns = mColumnMap.data();
+    int32_t* rows = columns + outWidth;
+    for (int32_t ox = 0; ox < outWidth; ++ox) {
+        columns[ox] = std::min(static_cast<int32_t>(x0 + (ox + 0.5f) * scaleX),
+                               static_cast<int32_t>(width) - 1);
+    }
+    for (int32_t oy = 0; oy < outHeight; ++oy) {
+        rows[oy] = std::min(static_cast<int32_t>(y0 + (oy + 0.5f) * scaleY),
+                            static_cast<int32_t>(height) - 1);
+    }
+
+    size_t itemOffset = batchIndex * tensor.itemElementCount();
+    switch (desc.dataType) {
+        case TensorDataType::Float32:
+            sampleRegion(rgba, stride, columns, rows, outWidth, outHeight, channels, desc.layout,
+                         mPreprocess, reinterpret_cast<const float*>(mLut.data()),
+                         tensor.as<float>() + itemOffset);
+            break;
+        case TensorDataType::Float16:
+            sampleRegion(rgba, stride, columns, rows, outWidth, outHeight, channels, desc.layout,
+                         mPreprocess, reinterpret_cast<const uint16_t*>(mLut.data()),
+                         tensor.as<uint16_t>() + itemOffset);
+            break;
+        case TensorDataType::Int8:
+            sampleRegion(rgba, stride, columns, rows, outWidth, outHeight, channels, desc.layout,
+                         mPreprocess, reinterpret_cast<const int8_t*>(mLut.data()),
+                         tensor.as<int8_t>() + itemOffset);
+            break;
+        case TensorDataType::UInt8:
+            sampleRegion(rgba, stride, columns, rows, outWidth, outHeight, channels, desc.layout,
+                         mPreprocess, mLut.data(), tensor.as<uint8_t>() + itemOffset);
+            break;
+    }
+    return true;
+}
+
+void InferenceEntity::collectRegions(uint32_t width, uint32_t height,
+                                     std::vector<InferenceRegion>& regions) {
+    InferenceRegion full;
+    full.width = static_cast<float>(width);
+    full.height = static_cast<float>(height);
+    regions.push_back(full);
+}
+
+bool InferenceEntity::processOnCPU(const uint8_t* data,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   uint32_t stride,
+                                   PixelFormat format,
+                                   std::unordered_map<std::string, std::any>& metadata) {
+    std::lock_guard<std::mutex> lock(mModelMutex);
+    if (!ensureModelLoaded()) {
+        // 模型不可用：透传本帧，不中断管线
+        return true;
+    }
+    if (getPixelFormatBytesPerPixel(format) != 4 || width == 0 || height == 0) {
+        PIPELINE_LOGE("%s requires a 4-channel input", getName().c_str());
+        return false;
+    }
+
+    // 降档后隔帧推理：中间帧沿用上次结果，下游仍能读到检测元数据
+    const uint32_t interval = mInferenceInterval.load(std::memory_order_relaxed);
+    if (interval > 1 && mFramesSinceInference > 0 && mFramesSinceInference < interval) {
+        ++mFramesSinceInference;
+        for (const auto& entry : mLastResults) {
+            metadata.insert(entry);
+        }
+        return true;
+    }
+
+    mRegions.clear();
+    collectRegions(width, height, mRegions);
+    if (mRegions.empty()) {
+        mFramesSinceInference = 0;
+        mLastResults.clear();
+        return true;
+    }
+
+    std::unordered_set<std::string> upstreamKeys;
+    if (interval > 1) {
+        for (const auto& entry : metadata) {
+            upstreamKeys.insert(entry.first);
+        }
+    }
+
+    uint32_t rowStride = stride > 0 ? stride : width * 4;
+    Tensor& imageTensor = mInputs[0];
+    uint64_t inferenceUs = 0;
+
+    for (size_t begin = 0; begin < mRegions.size(); begin += mBatchCapacity) {
+        size_t count = std::min<size_t>(mBatchCapacity, mRegions.size() - begin);
+        for (size_t b = 0; b < count; ++b) {
+            if (!fillImageTensor(imageTensor, b, data, width, height, rowStride,
+                                 mRegions[begin + b])) {
+                return false;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (!mBackend->run(mInputs, mOutputs, static_cast<uint32_t>(count))) {
+            PIPELINE_LOGE("%s inference failed", getName().c_str());
+            return false;
+        }
+        inferenceUs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        if (!postprocess(mOutputs, begin, count, mRegions, metadata)) {
+            return false;
+        }
+    }
+
+    mLastInferenceTimeUs = inferenceUs;
+
+    mFramesSinceInference = 1;
+    mLastResults.clear();
+    if (interval > 1) {
+        for (const auto& entry : metadata) {
+            if (!upstreamKeys.count(entry.first)) {
+                mLastResults.insert(entry);
+            }
+        }
+    }
+    return true;
+}
+
+bool InferenceEntity::process(const std::vector<FramePacketPtr>& inputs,
+                              std::vector<FramePacketPtr>& outputs,
+                              PipelineContext& context) {
+    if (inputs.empty() || !inputs[0] || !inputs[0]->isPayloadElided()) {
+        return CPUEntity::process(inputs, outputs, context);
+    }
+
+    // 本帧像素已按 wantsInput 省略：与间隔内的中间帧相同，沿用上次结果
+    const FramePacketPtr& input = inputs[0];
+    FramePacketPtr output = input->clone();
+    {
+        std::lock_guard<std::mutex> lock(mModelMutex);
+        // 计数为0（上次无区域）时保持，下一帧有像素即重新推理
+        if (mFramesSinceInference > 0) {
+            ++mFramesSinceInference;
+        }
+        for (const auto& [key, value] : mLastResults) {
+            output->setMetadata(key, value);
+        }
+    }
+    onProcessComplete(input, output);
+    outputs.push_back(output);
+    return true;
+}
+
+bool InferenceEntity::wantsInput(size_t port) {
+    // 与 processOnCPU 的隔帧节奏对齐：每 interval 帧要一次像素。
+    // 帧被丢弃时两边会错开，中间帧收到的像素按原逻辑跳过，至多晚一个间隔重新对齐
+    const uint32_t interval = mInferenceInterval.load(std::memory_order_relaxed);
+    const uint32_t phase = mDemandPhase.fetch_add(1, std::memory_order_relaxed);
+    return interval <= 1 || phase % interval == 0;
+}
+
+void InferenceEntity::setInferenceInterval(uint32_t interval) {
+    mInferenceInterval.store(std::max<uint32_t>(interval, 1), std::memory_order_relaxed);
+}
+
+void InferenceEntity::onQualityChanged(const QualitySettings& settings) {
+    setInferenceInterval(settings.detectionInterval);
+}
+
+} // namespace pipeline
@@ -6,9 +6,21 @@
 #include "pipeline/entity/MergeEntity.h"
 #include "pipeline/data/FramePacket.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
 
 namespace pipeline {
 
+namespace {
+
+// 输入端口索引（与 initializePorts 的添加顺序一致）
+constexpr size_t kGPUInputPortIndex = 0;
+constexpr size_t kCPUInputPortIndex = 1;
+
+} // namespace
+
 // =============================================================================
 // 构造与析构
 // =============================================================================
@@ -70,6 +82,10 @@ void MergeEntity::configure(const MergeConfig& config) {
             case MergeStrategy::Latest:
                 syncConfig.policy = input::SyncPolicy::DropOld;
                 break;
+            case MergeStrategy::LatestSideData:
+                // 不经同步器，CPU 结果由执行器延迟投递
+                syncConfig.policy = input::SyncPolicy::GPUFirst;
+                break;
         }
         
         syncConfig.maxWaitTimeMs = config.maxWaitTimeMs;
@@ -83,6 +99,24 @@ void MergeEntity::setMergeCallback(MergeCallback callback) {
     mMergeCallback = std::move(callback);
 }
 
+bool MergeEntity::isInputDeferred(size_t port) const {
+    std::lock_guard<std::mutex> lock(mMergeMutex);
+    return port == kCPUInputPortIndex && mConfig.strategy == MergeStrategy::LatestSideData;
+}
+
+void MergeEntity::onDeferredInput(size_t port, FramePacketPtr packet) {
+    if (port != kCPUInputPortIndex || !packet) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mMergeMutex);
+    // 跳帧后 CPU 分支可能乱序完成，只保留时间戳最新的结果
+    if (!mLatestCPUResult || packet->getTimestamp() >= mLatestCPUResult->getTimestamp()) {
+        mLatestCPUResult = std::move(packet);
+    }
+    ++mCPUFrameCount;
+}
+
 // =============================================================================
 // ProcessEntity 生命周期
 // =============================================================================
@@ -92,39 +126,53 @@ bool MergeEntity::prepare(PipelineContext& context) {
     if (mSynchronizer) {
         mSynchronizer->reset();
     }
+    std::lock_guard<std::mutex> lock(mMergeMutex);
+    mLatestCPUResult.reset();
     return true;
 }
 
 bool MergeEntity::process(const std::vector<FramePacketPtr>& inputs,
                           std::vector<FramePacketPtr>& outputs,
                           PipelineContext& context) {
-    // 🔥 关键设计: MergeEntity不直接等待
-    // 而是检查FrameSynchronizer是否有已同步的帧
-    
-    if (!mSynchronizer) {
-        return false;
+    MergedFrame merged;
+    bool sideData = false;
+    {
+        std::lock_guard<std::mutex> lock(mMergeMutex);
+        sideData = mConfig.strategy == MergeStrategy::LatestSideData;
     }
     
-    // 尝试获取已同步的帧 (非阻塞)
-    auto syncedFrame = mSynchronizer->tryGetSyncedFrame();
-    
-    if (!syncedFrame) {
-        // 没有已同步的帧,说明还在等待其他路
-        // 🔥 关键: 返回false,不生成输出
-        // PipelineExecutor会知道此Entity未完成,不投递下游任务
-        return false;
+    if (sideData) {
+        if (!mergeLatestSideData(inputs, merged)) {
+            return false;
+        }
+    } else {
+        // 🔥 关键设计: MergeEntity不直接等待
+        // 而是检查FrameSynchronizer是否有已同步的帧
+        
+        if (!mSynchronizer) {
+            return false;
+        }
+        
+        // 尝试获取已同步的帧 (非阻塞)
+        auto syncedFrame = mSynchronizer->tryGetSyncedFrame();
+        
+        if (!syncedFrame) {
+            // 没有已同步的帧,说明还在等待其他路
+            // 🔥 关键: 返回false,不生成输出
+            // PipelineExecutor会知道此Entity未完成,不投递下游任务
+            return false;
+        }
+        
+        // 有已同步的帧,创建合并输出
+        merged.gpuResult = syncedFrame->gpuFrame;
+        merged.cpuResult = syncedFrame->cpuFrame;
+        merged.timestamp = syncedFrame->timestamp;
+        merged.hasGPU = syncedFrame->hasGPU;
+        merged.hasCPU = syncedFrame->hasCPU;
     }
     
-    // 有已同步的帧,创建合并输出
-    MergedFrame merged;
-    merged.gpuResult = syncedFrame->gpuFrame;
-    merged.cpuResult = syncedFrame->cpuFrame;
-    merged.timestamp = syncedFrame->timestamp;
-    merged.hasGPU = syncedFrame->hasGPU;
-    merged.hasCPU = syncedFrame->hasCPU;
-    
     // 创建合并后的输出包
-    auto outputPacket = createMergedPacket(merged);
+    auto outputPacket = createMergedPacket(merged, context);
     if (outputPacket) {
         outputs.push_back(outputPacket);
         
@@ -187,36 +235,118 @@ void MergeEntity::processCPUInput(FramePacketPtr packet) {
     mSynchronizer->pushCPUFrame(packet, timestamp);
 }
 
-FramePacketPtr MergeEntity::createMergedPacket(const MergedFrame& frame) {
-    auto packet = std::make_shared<FramePacket>();
+bool MergeEntity::mergeLatestSideData(const std::vector<FramePacketPtr>& inputs,
+                                      MergedFrame& merged) {
+    FramePacketPtr gpu = inputs.size() > kGPUInputPortIndex ? inputs[kGPUInputPortIndex] : nullptr;
+    if (!gpu) {
+        return false;
+    }
+    
+    // 批处理/同步路径下 CPU 端口仍按帧送达，与延迟投递同样处理
+    FramePacketPtr cpu = inputs.size() > kCPUInputPortIndex ? inputs[kCPUInputPortIndex] : nullptr;
+    int64_t maxAgeUs = -1;
+    {
+        std::lock_guard<std::mutex> lock(mMergeMutex);
+        if (cpu && (!mLatestCPUResult || cpu->getTimestamp() >= mLatestCPUResult->getTimestamp())) {
+            mLatestCPUResult = cpu;
+        }
+        cpu = mLatestCPUResult;
+        maxAgeUs = mConfig.maxSideDataAgeUs;
+    }
+    ++mGPUFrameCount;
+    
+    merged.gpuResult = gpu;
+    merged.timestamp = gpu->getTimestamp();
+    merged.hasGPU = true;
+    
+    if (cpu) {
+        int64_t ageUs = std::max<int64_t>(0, gpu->getTimestamp() - cpu->getTimestamp());
+        if (maxAgeUs < 0 || ageUs <= maxAgeUs) {
+            merged.cpuResult = cpu;
+            merged.hasCPU = true;
+            merged.cpuAgeUs = ageUs;
+            merged.cpuAgeFrames = gpu->getFrameId() > cpu->getFrameId()
+                ? gpu->getFrameId() - cpu->getFrameId() : 0;
+        } else {
+            ++mDroppedFrameCount;
+        }
+    }
+    return true;
+}
+
+FramePacketPtr MergeEntity::createMergedPacket(const MergedFrame& frame, PipelineContext& context) {
+    // 优先取池化包：最后一个引用释放时归还，稳态下合并不产生分配
+    FramePacketPtr packet;
+    if (auto pool = context.getFramePacketPool()) {
+        packet = pool->tryAcquire();
+    }
+    if (!packet) {
+        packet = std::make_shared<FramePacket>();
+    }
     packet->setTimestamp(frame.timestamp);
     
-    // 优先使用 GPU 结果的纹理
+    // 优先使用 GPU 结果的纹理（共享引用）
     if (frame.hasGPU && frame.gpuResult) {
-        packet->setTexture(frame.gpuResult->getTexture());
-        packet->setSize(frame.gpuResult->getWidth(), frame.gpuResult->getHeight());
-        packet->setFormat(frame.gpuResult->getFormat());
+        const FramePacket& gpu = *frame.gpuResult;
+        packet->setFrameId(gpu.getFrameId());
+        packet->setSequenceNumber(gpu.getSequenceNumber());
+        packet->setFormat(gpu.getFormat());
+        packet->setStride(gpu.getStride());
+        packet->setSize(gpu.getWidth(), gpu.getHeight());
+        packet->setRenderScale(gpu.getRenderScale());
+        packet->setPixelScale(gpu.getPixelScale());
+        packet->setRoi(gpu.getRoi());
+        packet->setTexture(gpu.getTexture());
+        packet->setPlanarTexture(gpu.getPlanarTexture());
+        packet->setExternalImage(gpu.getExternalImage());
+        // 下游与 GPU 产出者同步，而不是等合并本身
+        packet->setGpuFence(gpu.getGpuFence());
+        packet->setContentGeneration(gpu.getContentGeneration());
+        if (mConfig.copyGPUData) {
+            // 纹理拷贝需经 LREngine blit，接入前仍共享纹理
+            if (!mCopyGPUWarned) {
+                mCopyGPUWarned = true;
+                PIPELINE_LOGW("MergeEntity %s: copyGPUData is not supported yet, sharing the GPU texture",
+                              getName().c_str());
+            }
+            /*
+            packet->setTexture(context.getTexturePool()->copyTexture(*gpu.getTexture()));
+            */
+        }
+        packet->setMetadata(kMergedGPUSourceKey, frame.gpuResult);
     }
     
     // 合并 CPU 数据
     if (frame.hasCPU && frame.cpuResult) {
-        const uint8_t* cpuData = frame.cpuResult->getCpuBufferNoLoad();
-        if (cpuData && mConfig.copyCPUData) {
-            // 复制 CPU 数据到输出包
-            // packet->setCpuBuffer(cpuData, size);
+        const FramePacket& cpu = *frame.cpuResult;
+        if (mConfig.copyCPUData) {
+            // 生产者会改写复用的缓冲：复制到共享缓冲池
+            packet->setCpuBuffer(cpu.getCpuBufferNoLoad(), cpu.getCpuBufferSize(), false);
+        } else if (auto buffer = cpu.getCpuBufferHandle()) {
+            packet->setCpuBuffer(std::move(buffer), cpu.getCpuBufferSize());
         }
         
         // 如果没有 GPU 数据，使用 CPU 数据的尺寸
         if (!frame.hasGPU) {
-            packet->setSize(frame.cpuResult->getWidth(), frame.cpuResult->getHeight());
-            packet->setFormat(frame.cpuResult->getFormat());
+            packet->setFrameId(cpu.getFrameId());
+            packet->setFormat(cpu.getFormat());
+            packet->setStride(cpu.getStride());
+            packet->setSize(cpu.getWidth(), cpu.getHeight());
+            packet->setRenderScale(cpu.getRenderScale());
+            packet->setPixelScale(cpu.getPixelScale());
+            packet->setRoi(cpu.getRoi());
         }
+        packet->setMetadata(kMergedCPUSourceKey, frame.cpuResult);
     }
     
     // 添加元数据标记
     packet->setMetadata("merged", true);
     packet->setMetadata("hasGPU", frame.hasGPU);
     packet->setMetadata("hasCPU", frame.hasCPU);
+    if (frame.hasCPU) {
+        packet->setMetadata("cpuAgeUs", frame.cpuAgeUs);
+        packet->setMetadata("cpuAgeFrames", frame.cpuAgeFrames);
+    }
     
     return packet;
 }
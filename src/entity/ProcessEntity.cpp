@@ -5,6 +5,7 @@
 
 #include "pipeline/entity/ProcessEntity.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/utils/PipelineLog.h"
 #include <chrono>
 #include <algorithm>
 
@@ -95,6 +96,28 @@ OutputPort* ProcessEntity::getOutputPort(const std::string& name) const {
     return nullptr;
 }
 
+// =============================================================================
+// 格式协商
+// =============================================================================
+
+PixelFormatSet ProcessEntity::getAcceptedInputFormats(size_t port) const {
+    {
+        std::lock_guard<std::mutex> lock(mPortsMutex);
+        if (port < mAcceptedInputFormats.size() && mAcceptedInputFormats[port] != 0) {
+            return mAcceptedInputFormats[port];
+        }
+    }
+    return getDefaultAcceptedInputFormats(port);
+}
+
+void ProcessEntity::setAcceptedInputFormats(size_t port, PixelFormatSet formats) {
+    std::lock_guard<std::mutex> lock(mPortsMutex);
+    if (port >= mAcceptedInputFormats.size()) {
+        mAcceptedInputFormats.resize(port + 1, 0);
+    }
+    mAcceptedInputFormats[port] = formats;
+}
+
 // =============================================================================
 // 依赖管理
 // =============================================================================
@@ -136,6 +159,20 @@ bool ProcessEntity::waitInputsReady(int64_t timeoutMs) {
     return true;
 }
 
+bool ProcessEntity::areBoundInputsReady(const std::vector<FramePacketPtr>& inputs) const {
+    std::lock_guard<std::mutex> lock(mPortsMutex);
+    
+    for (size_t i = 0; i < mInputPorts.size(); ++i) {
+        if (!mInputPorts[i]->isConnected()) {
+            continue;
+        }
+        if (i >= inputs.size() || !inputs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 size_t ProcessEntity::getPendingInputCount() const {
     std::lock_guard<std::mutex> lock(mPortsMutex);
     
@@ -153,6 +190,22 @@ size_t ProcessEntity::getPendingInputCount() const {
 // =============================================================================
 
 bool ProcessEntity::execute(PipelineContext& context) {
+    return executeInternal(context, nullptr);
+}
+
+bool ProcessEntity::execute(PipelineContext& context,
+                            const std::vector<FramePacketPtr>& inputs) {
+    return executeInternal(context, &inputs);
+}
+
+bool ProcessEntity::executeAsync(PipelineContext& context,
+                                 const std::vector<FramePacketPtr>& inputs) {
+    return executeInternal(context, &inputs, true);
+}
+
+bool ProcessEntity::executeInternal(PipelineContext& context,
+                                    const std::vector<FramePacketPtr>* boundInputs,
+                                    bool allowSuspend) {
     // 检查是否启用
     if (!mEnabled.load()) {
         setState(EntityState::Completed);
@@ -167,13 +220,19 @@ bool ProcessEntity::execute(PipelineContext& context) {
     
     // 🔥 异步任务链兼容: 不阻塞等待输入
     // InputPort的数据应该在上游Entity完成时已经ready
-    if (!areInputsReady()) {
+    bool inputsReady = boundInputs ? areBoundInputsReady(*boundInputs) : areInputsReady();
+    if (!inputsReady) {
         setState(EntityState::Blocked);
         return false;  // 输入未就绪，返回false
     }
     
-    // 准备阶段
+    // 准备阶段（运行中才加入图的Entity未经启动加载，首次执行时同步加载资源）
     setState(EntityState::Ready);
+    if (!mResourcesLoaded.load(std::memory_order_acquire) && !loadResources()) {
+        setError("Resource load failed");
+        return false;
+    }
+    latchParameters();
     if (!prepare(context)) {
         setError("Prepare failed");
         return false;
@@ -184,10 +243,16 @@ bool ProcessEntity::execute(PipelineContext& context) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
     // 🔥 Step 1: 从InputPort收集输入
-    auto inputs = collectInputs();
+    // 执行器绑定的输入直接引用，不再拷贝
+    std::vector<FramePacketPtr> collected;
+    if (!boundInputs) {
+        collected = collectInputs();
+    }
+    const auto& inputs = boundInputs ? *boundInputs : collected;
     std::vector<FramePacketPtr> outputs;
     
     // 🔥 Step 2: 调用子类的process
+    mPendingAwait.reset();
     bool success = process(inputs, outputs, context);
     
     auto endTime = std::chrono::high_resolution_clock::now();
@@ -195,15 +260,61 @@ bool ProcessEntity::execute(PipelineContext& context) {
         endTime - startTime).count();
     
     // 更新统计
-    mLastProcessDuration.store(duration);
-    mTotalProcessDuration.fetch_add(duration);
-    mProcessCount.fetch_add(1);
+    recordProcessDuration(duration, true);
     
     if (!success) {
+        mPendingAwait.reset();
         setError("Process failed");
         return false;
     }
     
+    if (mPendingAwait) {
+        if (allowSuspend) {
+            // 由调用方在等待完成后继续，状态保持Processing
+            return true;
+        }
+        // 同步路径：在当前线程依次等待并执行续体
+        while (mPendingAwait) {
+            EntityAwaitPtr await = std::move(mPendingAwait);
+            await->waitBlocking();
+            outputs.clear();
+            auto stepStart = std::chrono::high_resolution_clock::now();
+            success = await->continuation && await->continuation(outputs, context);
+            recordProcessDuration(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - stepStart).count(), false);
+            if (!success) {
+                mPendingAwait.reset();
+                setError("Continuation failed");
+                return false;
+            }
+        }
+    }
+    
+    completeExecution(outputs, context);
+    return true;
+}
+
+bool ProcessEntity::resumeAwait(EntityAwait& await, PipelineContext& context) {
+    std::vector<FramePacketPtr> outputs;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    bool success = await.continuation && await.continuation(outputs, context);
+    recordProcessDuration(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime).count(), false);
+    
+    if (!success) {
+        mPendingAwait.reset();
+        setError("Continuation failed");
+        return false;
+    }
+    if (mPendingAwait) {
+        return true;
+    }
+    
+    completeExecution(outputs, context);
+    return true;
+}
+
+void ProcessEntity::completeExecution(std::vector<FramePacketPtr>& outputs, PipelineContext& context) {
     // 🔥 Step 3: 将输出写入OutputPort
     {
         std::lock_guard<std::mutex> lock(mPortsMutex);
@@ -219,7 +330,80 @@ bool ProcessEntity::execute(PipelineContext& context) {
     sendOutputs();
     
     setState(EntityState::Completed);
-    return true;
+}
+
+// =============================================================================
+// 异步等待
+// =============================================================================
+
+void ProcessEntity::awaitFence(GpuFencePtr fence, EntityContinuation next) {
+    awaitFence(std::move(fence), std::move(next), getExecutionQueue());
+}
+
+void ProcessEntity::awaitFence(GpuFencePtr fence, EntityContinuation next, ExecutionQueue resumeOn) {
+    auto await = std::make_unique<EntityAwait>();
+    await->kind = EntityAwait::Kind::Fence;
+    await->fence = std::move(fence);
+    await->resumeQueue = resumeOn;
+    await->continuation = std::move(next);
+    registerAwait(std::move(await));
+}
+
+void ProcessEntity::awaitReadback(ReadbackRequestPtr request, EntityContinuation next) {
+    awaitReadback(std::move(request), std::move(next), getExecutionQueue());
+}
+
+void ProcessEntity::awaitReadback(ReadbackRequestPtr request, EntityContinuation next,
+                                  ExecutionQueue resumeOn) {
+    auto await = std::make_unique<EntityAwait>();
+    await->kind = EntityAwait::Kind::Readback;
+    await->readback = std::move(request);
+    await->resumeQueue = resumeOn;
+    await->continuation = std::move(next);
+    registerAwait(std::move(await));
+}
+
+void ProcessEntity::awaitTask(std::function<void()> task, EntityContinuation next) {
+    awaitTask(std::move(task), std::move(next), getExecutionQueue());
+}
+
+void ProcessEntity::awaitTask(std::function<void()> task, EntityContinuation next,
+                              ExecutionQueue resumeOn) {
+    auto await = std::make_unique<EntityAwait>();
+    await->kind = EntityAwait::Kind::Task;
+    await->task = std::move(task);
+    await->resumeQueue = resumeOn;
+    await->continuation = std::move(next);
+    registerAwait(std::move(await));
+}
+
+void ProcessEntity::registerAwait(EntityAwaitPtr await) {
+    if (mPendingAwait) {
+        PIPELINE_LOGE("Entity %s registered a second await in one step, previous one dropped",
+                      mName.c_str());
+    }
+    mPendingAwait = std::move(await);
+}
+
+void EntityAwait::waitBlocking() {
+    switch (kind) {
+        case Kind::Fence:
+            if (fence) {
+                fence->wait(-1);
+            }
+            break;
+        case Kind::Readback:
+            if (readback) {
+                readback->wait();
+            }
+            break;
+        case Kind::Task:
+            if (task) {
+                task();
+                task = nullptr;
+            }
+            break;
+    }
 }
 
 void ProcessEntity::cancel() {
@@ -247,6 +431,8 @@ void ProcessEntity::resetForNextFrame() {
 void ProcessEntity::configure(const EntityConfig& config) {
     setName(config.name);
     setEnabled(config.enabled);
+    setOptional(config.optional);
+    setExecutionLane(config.lane);
     
     std::lock_guard<std::mutex> lock(mParamsMutex);
     for (const auto& [key, value] : config.params) {
@@ -255,6 +441,39 @@ void ProcessEntity::configure(const EntityConfig& config) {
     }
 }
 
+// =============================================================================
+// 资源加载
+// =============================================================================
+
+bool ProcessEntity::loadResources() {
+    // 后台加载与首次执行可能同时到达，后到者等待先到者加载完成
+    std::lock_guard<std::mutex> lock(mResourceLoadMutex);
+    if (mResourcesLoaded.load(std::memory_order_acquire)) {
+        mResourcesReady.store(true, std::memory_order_release);
+        return true;
+    }
+    
+    [[maybe_unused]] auto startTime = std::chrono::steady_clock::now();
+    bool success = onLoadResources();
+    
+    if (!success) {
+        PIPELINE_LOGE("Entity %s failed to load resources", mName.c_str());
+        return false;
+    }
+    mResourcesLoaded.store(true, std::memory_order_release);
+    mResourcesReady.store(true, std::memory_order_release);
+    PIPELINE_LOGD("Entity %s loaded resources in %lld ms", mName.c_str(),
+                  static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - startTime).count()));
+    return true;
+}
+
+void ProcessEntity::markResourcesPending() {
+    if (!mResourcesLoaded.load(std::memory_order_acquire)) {
+        mResourcesReady.store(false, std::memory_order_release);
+    }
+}
+
 // =============================================================================
 // 统计
 // =============================================================================
@@ -267,6 +486,16 @@ uint64_t ProcessEntity::getAverageProcessDuration() const {
     return mTotalProcessDuration.load() / count;
 }
 
+void ProcessEntity::recordProcessDuration(int64_t durationUs, bool newExecution) {
+    if (newExecution) {
+        mLastProcessDuration.store(durationUs);
+        mProcessCount.fetch_add(1);
+    } else {
+        mLastProcessDuration.fetch_add(durationUs);
+    }
+    mTotalProcessDuration.fetch_add(durationUs);
+}
+
 void ProcessEntity::resetStatistics() {
     mLastProcessDuration.store(0);
     mTotalProcessDuration.store(0);
@@ -323,6 +552,17 @@ std::vector<FramePacketPtr> ProcessEntity::collectInputs() const {
     return inputs;
 }
 
+void ProcessEntity::releasePortPackets() {
+    std::lock_guard<std::mutex> lock(mPortsMutex);
+    
+    for (auto& port : mInputPorts) {
+        port->setPacket(nullptr);
+    }
+    for (auto& port : mOutputPorts) {
+        port->setPacket(nullptr);
+    }
+}
+
 void ProcessEntity::sendOutputs() {
     std::lock_guard<std::mutex> lock(mPortsMutex);
     
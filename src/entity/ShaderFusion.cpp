@@ -0,0 +1,63 @@
+/**
+ * @file ShaderFusion.cpp
+ * @brief 着色器融合实现
+ */
+
+#include "pipeline/entity/ShaderFusion.h"
+
+namespace pipeline {
+
+namespace {
+
+void appendWithPrefix(std::string& out, const std::string& source, const std::string& prefix) {
+    for (char c : source) {
+        if (c == '$') {
+            out += prefix;
+        } else {
+            out += c;
+        }
+    }
+}
+
+} // anonymous namespace
+
+std::string getFusionPrefix(size_t memberIndex) {
+    return "f" + std::to_string(memberIndex) + "_";
+}
+
+std::string buildFusedFragmentShader(const std::vector<PixelShaderSnippet>& snippets,
+                                     const std::vector<std::string>& prefixes) {
+    std::string source;
+    source.reserve(1024 + snippets.size() * 1024);
+    source +=
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "\n"
+        "in vec2 vTexCoord;\n"
+        "out vec4 fragColor;\n"
+        "\n"
+        "uniform sampler2D uTexture;\n";
+
+    for (size_t i = 0; i < snippets.size() && i < prefixes.size(); ++i) {
+        const std::string& prefix = prefixes[i];
+        source += "\n// ---- stage " + std::to_string(i) + " ----\n";
+        appendWithPrefix(source, snippets[i].declarations, prefix);
+        source += "\nvec4 " + prefix + "apply(vec4 color, vec2 uv) {\n";
+        appendWithPrefix(source, snippets[i].body, prefix);
+        source += "\n}\n";
+    }
+
+    source +=
+        "\n"
+        "void main() {\n"
+        "    vec4 color = texture(uTexture, vTexCoord);\n";
+    for (size_t i = 0; i < snippets.size() && i < prefixes.size(); ++i) {
+        source += "    color = " + prefixes[i] + "apply(color, vTexCoord);\n";
+    }
+    source +=
+        "    fragColor = color;\n"
+        "}\n";
+    return source;
+}
+
+} // namespace pipeline
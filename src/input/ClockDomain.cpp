@@ -0,0 +1,38 @@
+/**
+ * @file ClockDomain.cpp
+ * @brief ClockDomain 实现
+ */
+
+#include "pipeline/input/ClockDomain.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace pipeline {
+namespace input {
+
+void ClockDomain::observe(int64_t sourceUs, int64_t hostUs) {
+    mOffsets[mNext] = hostUs - sourceUs;
+    mNext = (mNext + 1) % kWindowSize;
+    mCount = std::min(mCount + 1, kWindowSize);
+    
+    // 延迟只会让差值变大，窗口最小值最接近真实偏移
+    int64_t offset = *std::min_element(mOffsets.begin(), mOffsets.begin() + mCount);
+    mOffsetUs.store(offset, std::memory_order_relaxed);
+    mCalibrated.store(true, std::memory_order_release);
+}
+
+void ClockDomain::reset() {
+    mCount = 0;
+    mNext = 0;
+    mOffsetUs.store(0, std::memory_order_relaxed);
+    mCalibrated.store(false, std::memory_order_release);
+}
+
+int64_t ClockDomain::hostNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace input
+} // namespace pipeline
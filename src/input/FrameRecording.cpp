@@ -0,0 +1,763 @@
+/**
+ * @file FrameRecording.cpp
+ * @brief FrameRecorder / FrameRecordingReader / FrameReplayer 实现
+ */
+
+#include "pipeline/input/FrameRecording.h"
+#include "pipeline/input/ClockDomain.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pipeline {
+namespace input {
+
+namespace {
+
+constexpr char kMagic[4] = {'P', 'L', 'R', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kGrowStep = 64u << 20;     // 映射按 64MB 扩展，避免逐帧 ftruncate
+
+enum RecordType : uint32_t {
+    kRecordEnd = 0,             // 未写入的映射区（进程异常退出时文件末尾为零）
+    kRecordFrame = 1,
+    kRecordParameter = 2
+};
+
+enum ValueType : uint8_t {
+    kValueBool = 1,
+    kValueInt32,
+    kValueUInt32,
+    kValueInt64,
+    kValueUInt64,
+    kValueFloat,
+    kValueDouble,
+    kValueString
+};
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint8_t format;
+    uint8_t dataType;
+    uint8_t queueMode;
+    uint8_t reserved0;
+    uint32_t queueCapacity;
+    float maxFrameRate;
+    uint32_t reserved1;
+};
+
+struct RecordHeader {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t payloadSize;
+};
+
+constexpr uint32_t kMaxPlanes = 3;
+
+struct FrameHeader {
+    int64_t timestamp;
+    int64_t hostTimeUs;
+    uint32_t width;
+    uint32_t height;
+    uint8_t format;
+    uint8_t planeCount;
+    uint16_t reserved0;
+    uint32_t rowBytes[kMaxPlanes];
+    uint32_t rows[kMaxPlanes];
+    uint32_t reserved1;
+};
+
+struct ParameterHeader {
+    uint16_t entityLength;
+    uint16_t keyLength;
+    uint8_t valueType;
+    uint8_t reserved[3];
+    uint64_t frameIndex;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "record alignment");
+static_assert(sizeof(RecordHeader) % 8 == 0, "record alignment");
+static_assert(sizeof(FrameHeader) % 8 == 0, "record alignment");
+static_assert(sizeof(ParameterHeader) % 8 == 0, "record alignment");
+
+size_t alignRecord(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+/**
+ * @brief 一个平面的源数据
+ */
+struct PlaneView {
+    const uint8_t* data = nullptr;
+    uint32_t stride = 0;
+    uint32_t rowBytes = 0;
+    uint32_t rows = 0;
+};
+
+/**
+ * @brief 按格式拆出平面（未给出平面指针的 YUV 视为各平面紧密排列在 data 中）
+ * @return 平面数，不支持的格式或缺数据返回 0
+ */
+uint32_t describePlanes(const CPUInputData& cpu, PlaneView planes[kMaxPlanes]) {
+    const uint32_t width = cpu.width;
+    const uint32_t height = cpu.height;
+    const uint32_t chromaWidth = (width + 1) / 2;
+    const uint32_t chromaHeight = (height + 1) / 2;
+    if (width == 0 || height == 0) {
+        return 0;
+    }
+
+    switch (cpu.format) {
+        case InputFormat::RGBA:
+        case InputFormat::BGRA:
+        case InputFormat::RGB: {
+            const uint32_t bpp = cpu.format == InputFormat::RGB ? 3 : 4;
+            if (!cpu.data) {
+                return 0;
+            }
+            planes[0] = {cpu.data, cpu.stride > 0 ? cpu.stride : width * bpp, width * bpp, height};
+            return 1;
+        }
+        case InputFormat::YUV420: {
+            const uint8_t* y = cpu.planeY ? cpu.planeY : cpu.data;
+            if (!y) {
+                return 0;
+            }
+            const size_t lumaSize = static_cast<size_t>(width) * height;
+            const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+            const uint8_t* u = cpu.planeY ? cpu.planeU : y + lumaSize;
+            const uint8_t* v = cpu.planeY ? cpu.planeV : y + lumaSize + chromaSize;
+            if (!u || !v) {
+                return 0;
+            }
+            planes[0] = {y, cpu.strideY > 0 ? cpu.strideY : width, width, height};
+            planes[1] = {u, cpu.strideU > 0 ? cpu.strideU : chromaWidth, chromaWidth, chromaHeight};
+            planes[2] = {v, cpu.strideV > 0 ? cpu.strideV : chromaWidth, chromaWidth, chromaHeight};
+            return 3;
+        }
+        case InputFormat::NV12:
+        case InputFormat::NV21: {
+            const uint8_t* y = cpu.planeY ? cpu.planeY : cpu.data;
+            if (!y) {
+                return 0;
+            }
+            const uint8_t* uv = cpu.planeY ? cpu.planeU : y + static_cast<size_t>(width) * height;
+            if (!uv) {
+                return 0;
+            }
+            planes[0] = {y, cpu.strideY > 0 ? cpu.strideY : width, width, height};
+            planes[1] = {uv, cpu.strideU > 0 ? cpu.strideU : chromaWidth * 2, chromaWidth * 2, chromaHeight};
+            return 2;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 把参数值编码为 (类型, 字节)；不支持的类型返回 false
+ */
+bool encodeValue(const std::any& value, uint8_t& type, std::vector<uint8_t>& bytes) {
+    auto store = [&bytes](const void* data, size_t size) {
+        const auto* begin = static_cast<const uint8_t*>(data);
+        bytes.assign(begin, begin + size);
+    };
+    if (const auto* v = std::any_cast<bool>(&value)) {
+        uint8_t b = *v ? 1 : 0;
+        type = kValueBool;
+        store(&b, 1);
+    } else if (const auto* v = std::any_cast<int32_t>(&value)) {
+        type = kValueInt32;
+        store(v, sizeof(*v));
+    } else if (const auto* v = std::any_cast<uint32_t>(&value)) {
+        type = kValueUInt32;
+        store(v, sizeof(*v));
+    } else if (const auto* v = std::any_cast<int64_t>(&value)) {
+        type = kValueInt64;
+        store(v, sizeof(*v));
+    } else if (const auto* v = std::any_cast<uint64_t>(&value)) {
+        type = kValueUInt64;
+        store(v, sizeof(*v));
+    } else if (const auto* v = std::any_cast<float>(&value)) {
+        type = kValueFloat;
+        store(v, sizeof(*v));
+    } else if (const auto* v = std::any_cast<double>(&value)) {
+        type = kValueDouble;
+        store(v, sizeof(*v));
+    } else if (const auto* v = std::any_cast<std::string>(&value)) {
+        type = kValueString;
+        store(v->data(), v->size());
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+std::any decodeScalar(const uint8_t* data, size_t size) {
+    T value{};
+    if (size != sizeof(T)) {
+        return {};
+    }
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+std::any decodeValue(uint8_t type, const uint8_t* data, size_t size) {
+    switch (type) {
+        case kValueBool:   return size == 1 ? std::any(data[0] != 0) : std::any();
+        case kValueInt32:  return decodeScalar<int32_t>(data, size);
+        case kValueUInt32: return decodeScalar<uint32_t>(data, size);
+        case kValueInt64:  return decodeScalar<int64_t>(data, size);
+        case kValueUInt64: return decodeScalar<uint64_t>(data, size);
+        case kValueFloat:  return decodeScalar<float>(data, size);
+        case kValueDouble: return decodeScalar<double>(data, size);
+        case kValueString: return std::string(reinterpret_cast<const char*>(data), size);
+        default:           return {};
+    }
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// FrameRecorder
+// =============================================================================
+
+/**
+ * @brief 追加写入的映射文件（POSIX 按步长扩展映射；其他平台退化为顺序写）
+ */
+struct FrameRecorder::Writer {
+    ~Writer() {
+        finish();
+    }
+
+    bool open(const std::string& path) {
+#if !defined(_WIN32)
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        return fd >= 0 && reserve(kGrowStep);
+#else
+        file.open(path, std::ios::binary | std::ios::trunc);
+        return static_cast<bool>(file);
+#endif
+    }
+
+    bool write(const void* data, size_t size) {
+        if (size == 0) {
+            return true;
+        }
+#if !defined(_WIN32)
+        if (!reserve(used + size)) {
+            return false;
+        }
+        std::memcpy(static_cast<uint8_t*>(mapped) + used, data, size);
+#else
+        if (!file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size))) {
+            return false;
+        }
+#endif
+        used += size;
+        return true;
+    }
+
+    void finish() {
+#if !defined(_WIN32)
+        if (mapped) {
+            munmap(mapped, capacity);
+            mapped = nullptr;
+        }
+        if (fd >= 0) {
+            // 去掉映射预留的尾部
+            if (ftruncate(fd, static_cast<off_t>(used)) != 0) {
+                PIPELINE_LOGW("FrameRecorder: failed to trim recording to %zu bytes", used);
+            }
+            ::close(fd);
+            fd = -1;
+        }
+#else
+        if (file.is_open()) {
+            file.close();
+        }
+#endif
+    }
+
+#if !defined(_WIN32)
+    bool reserve(size_t bytes) {
+        if (bytes <= capacity) {
+            return true;
+        }
+        size_t newCapacity = std::max(capacity * 2, (bytes + kGrowStep - 1) / kGrowStep * kGrowStep);
+        if (mapped) {
+            munmap(mapped, capacity);
+            mapped = nullptr;
+        }
+        if (ftruncate(fd, static_cast<off_t>(newCapacity)) != 0) {
+            PIPELINE_LOGE("FrameRecorder: failed to grow recording to %zu bytes", newCapacity);
+            capacity = 0;
+            return false;
+        }
+        void* ptr = mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            PIPELINE_LOGE("FrameRecorder: failed to map recording");
+            capacity = 0;
+            return false;
+        }
+        mapped = ptr;
+        capacity = newCapacity;
+        return true;
+    }
+
+    int fd = -1;
+    void* mapped = nullptr;
+    size_t capacity = 0;
+#else
+    std::ofstream file;
+#endif
+    size_t used = 0;
+};
+
+FrameRecorder::FrameRecorder() = default;
+
+FrameRecorder::~FrameRecorder() {
+    close();
+}
+
+bool FrameRecorder::open(const std::string& path, const InputConfig& config) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWriter.reset();
+    mFrameCount = 0;
+    mSkippedFrames = 0;
+
+    auto writer = std::make_unique<Writer>();
+    if (!writer->open(path)) {
+        PIPELINE_LOGE("FrameRecorder: failed to create %s", path.c_str());
+        return false;
+    }
+
+    FileHeader header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = config.width;
+    header.height = config.height;
+    header.format = static_cast<uint8_t>(config.format);
+    header.dataType = static_cast<uint8_t>(config.dataType);
+    header.queueMode = static_cast<uint8_t>(config.queueMode);
+    header.queueCapacity = config.queueCapacity;
+    header.maxFrameRate = config.maxFrameRate;
+    if (!writer->write(&header, sizeof(header))) {
+        return false;
+    }
+
+    mWriter = std::move(writer);
+    PIPELINE_LOGI("FrameRecorder: recording input to %s", path.c_str());
+    return true;
+}
+
+void FrameRecorder::close() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mWriter) {
+        mWriter->finish();
+        PIPELINE_LOGI("FrameRecorder: recorded %llu frames (%zu bytes)",
+                      static_cast<unsigned long long>(mFrameCount), mWriter->used);
+        mWriter.reset();
+    }
+}
+
+bool FrameRecorder::isOpen() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWriter != nullptr;
+}
+
+bool FrameRecorder::appendRecord(uint32_t type, const std::vector<std::pair<const void*, size_t>>& parts) {
+    RecordHeader header {};
+    header.type = type;
+    for (const auto& part : parts) {
+        header.payloadSize += part.second;
+    }
+    static const uint8_t kPadding[8] = {};
+    const size_t padding = alignRecord(header.payloadSize) - header.payloadSize;
+
+    bool ok = mWriter->write(&header, sizeof(header));
+    for (const auto& part : parts) {
+        ok = ok && mWriter->write(part.first, part.second);
+    }
+    ok = ok && mWriter->write(kPadding, padding);
+    if (!ok) {
+        // 写入失败后文件已不完整：停止录制，已写入的完整记录仍可回放
+        PIPELINE_LOGE("FrameRecorder: write failed, recording stopped");
+        mWriter->finish();
+        mWriter.reset();
+    }
+    return ok;
+}
+
+bool FrameRecorder::recordFrame(const InputData& data) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mWriter) {
+        return false;
+    }
+
+    PlaneView planes[kMaxPlanes];
+    const uint32_t planeCount = data.dataType == InputDataType::GPUTexture
+        ? 0 : describePlanes(data.cpu, planes);
+    if (planeCount == 0) {
+        if (mSkippedFrames++ == 0) {
+            PIPELINE_LOGW("FrameRecorder: only CPU frames can be recorded, skipping");
+        }
+        return false;
+    }
+
+    FrameHeader header {};
+    header.timestamp = data.cpu.timestamp;
+    header.hostTimeUs = data.hostTimeUs > 0 ? data.hostTimeUs : ClockDomain::hostNowUs();
+    header.width = data.cpu.width;
+    header.height = data.cpu.height;
+    header.format = static_cast<uint8_t>(data.cpu.format);
+    header.planeCount = static_cast<uint8_t>(planeCount);
+
+    // 各平面逐行写入；行跨度等于行宽时整块写入
+    std::vector<std::pair<const void*, size_t>> parts;
+    parts.emplace_back(&header, sizeof(header));
+    for (uint32_t p = 0; p < planeCount; ++p) {
+        const PlaneView& plane = planes[p];
+        header.rowBytes[p] = plane.rowBytes;
+        header.rows[p] = plane.rows;
+        if (plane.stride == plane.rowBytes) {
+            parts.emplace_back(plane.data, static_cast<size_t>(plane.rowBytes) * plane.rows);
+        } else {
+            for (uint32_t row = 0; row < plane.rows; ++row) {
+                parts.emplace_back(plane.data + static_cast<size_t>(row) * plane.stride, plane.rowBytes);
+            }
+        }
+    }
+
+    if (!appendRecord(kRecordFrame, parts)) {
+        return false;
+    }
+    ++mFrameCount;
+    return true;
+}
+
+bool FrameRecorder::recordParameter(const std::string& entityName, const std::string& key,
+                                    const std::any& value) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mWriter) {
+        return false;
+    }
+
+    ParameterHeader header {};
+    std::vector<uint8_t> bytes;
+    if (!encodeValue(value, header.valueType, bytes)) {
+        PIPELINE_LOGD("FrameRecorder: parameter %s.%s has an unsupported type, not recorded",
+                      entityName.c_str(), key.c_str());
+        return false;
+    }
+    if (entityName.size() > UINT16_MAX || key.size() > UINT16_MAX) {
+        return false;
+    }
+    header.entityLength = static_cast<uint16_t>(entityName.size());
+    header.keyLength = static_cast<uint16_t>(key.size());
+    header.frameIndex = mFrameCount;
+
+    return appendRecord(kRecordParameter, {
+        {&header, sizeof(header)},
+        {entityName.data(), entityName.size()},
+        {key.data(), key.size()},
+        {bytes.data(), bytes.size()},
+    });
+}
+
+uint64_t FrameRecorder::getFrameCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFrameCount;
+}
+
+uint64_t FrameRecorder::getSkippedFrameCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSkippedFrames;
+}
+
+uint64_t FrameRecorder::getBytesWritten() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWriter ? mWriter->used : 0;
+}
+
+// =============================================================================
+// FrameRecordingReader
+// =============================================================================
+
+/**
+ * @brief 只读映射（读取器与在途帧共同持有）
+ */
+struct FrameRecordingReader::Mapping {
+    ~Mapping() {
+#if !defined(_WIN32)
+        if (mapped) {
+            munmap(mapped, size);
+        }
+#endif
+    }
+
+    bool open(const std::string& path) {
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        madvise(ptr, size, MADV_SEQUENTIAL);
+        mapped = ptr;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(buffer.data()),
+                                           static_cast<std::streamsize>(buffer.size())));
+#endif
+    }
+
+    const uint8_t* data() const {
+        return mapped ? static_cast<const uint8_t*>(mapped) : buffer.data();
+    }
+    size_t bytes() const { return mapped ? size : buffer.size(); }
+
+    void* mapped = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> buffer;
+};
+
+FrameRecordingReader::~FrameRecordingReader() {
+    close();
+}
+
+bool FrameRecordingReader::open(const std::string& path) {
+    close();
+
+    auto mapping = std::make_shared<Mapping>();
+    if (!mapping->open(path)) {
+        PIPELINE_LOGE("FrameRecordingReader: failed to map %s", path.c_str());
+        return false;
+    }
+
+    const uint8_t* base = mapping->data();
+    const size_t size = mapping->bytes();
+    FileHeader header {};
+    if (size < sizeof(header)) {
+        PIPELINE_LOGE("FrameRecordingReader: %s is not a recording", path.c_str());
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        PIPELINE_LOGE("FrameRecordingReader: %s has an unknown format or version", path.c_str());
+        return false;
+    }
+
+    mConfig = InputConfig();
+    mConfig.width = header.width;
+    mConfig.height = header.height;
+    mConfig.format = static_cast<InputFormat>(header.format);
+    mConfig.dataType = static_cast<InputDataType>(header.dataType);
+    mConfig.queueMode = static_cast<InputQueueMode>(header.queueMode);
+    mConfig.queueCapacity = header.queueCapacity;
+    mConfig.maxFrameRate = header.maxFrameRate;
+
+    // 建立索引：遇到零记录（未写满的映射区）或截断的记录即停止
+    size_t offset = sizeof(header);
+    while (offset + sizeof(RecordHeader) <= size) {
+        RecordHeader record {};
+        std::memcpy(&record, base + offset, sizeof(record));
+        const size_t payload = offset + sizeof(record);
+        if (record.type == kRecordEnd || record.payloadSize > size - payload) {
+            break;
+        }
+        if (record.type == kRecordFrame && record.payloadSize >= sizeof(FrameHeader)) {
+            mFrames.push_back(payload);
+        } else if (record.type == kRecordParameter && record.payloadSize >= sizeof(ParameterHeader)) {
+            ParameterHeader param {};
+            std::memcpy(&param, base + payload, sizeof(param));
+            const size_t strings = sizeof(param) + param.entityLength + param.keyLength;
+            if (strings <= record.payloadSize) {
+                const char* text = reinterpret_cast<const char*>(base + payload + sizeof(param));
+                RecordedParameter parameter;
+                parameter.frameIndex = param.frameIndex;
+                parameter.entityName.assign(text, param.entityLength);
+                parameter.key.assign(text + param.entityLength, param.keyLength);
+                parameter.value = decodeValue(param.valueType, base + payload + strings,
+                                              record.payloadSize - strings);
+                if (parameter.value.has_value()) {
+                    mParameters.push_back(std::move(parameter));
+                }
+            }
+        }
+        offset = payload + alignRecord(record.payloadSize);
+    }
+
+    mMapping = std::move(mapping);
+    PIPELINE_LOGI("FrameRecordingReader: opened %s (%zu frames, %zu parameter changes)",
+                  path.c_str(), mFrames.size(), mParameters.size());
+    return true;
+}
+
+void FrameRecordingReader::close() {
+    mMapping.reset();
+    mFrames.clear();
+    mParameters.clear();
+}
+
+bool FrameRecordingReader::readFrame(uint64_t index, InputData& frame) const {
+    if (!mMapping || index >= mFrames.size()) {
+        return false;
+    }
+
+    const uint8_t* payload = mMapping->data() + mFrames[index];
+    FrameHeader header {};
+    std::memcpy(&header, payload, sizeof(header));
+    if (header.planeCount == 0 || header.planeCount > kMaxPlanes) {
+        return false;
+    }
+
+    const uint8_t* planes[kMaxPlanes] = {};
+    const uint8_t* cursor = payload + sizeof(header);
+    size_t total = 0;
+    for (uint32_t p = 0; p < header.planeCount; ++p) {
+        planes[p] = cursor;
+        size_t planeSize = static_cast<size_t>(header.rowBytes[p]) * header.rows[p];
+        cursor += planeSize;
+        total += planeSize;
+    }
+
+    CPUInputData cpu;
+    cpu.data = planes[0];
+    cpu.dataSize = total;
+    cpu.width = header.width;
+    cpu.height = header.height;
+    cpu.format = static_cast<InputFormat>(header.format);
+    cpu.timestamp = header.timestamp;
+    if (header.planeCount == 1) {
+        cpu.stride = header.rowBytes[0];
+    } else {
+        cpu.planeY = planes[0];
+        cpu.planeU = planes[1];
+        cpu.planeV = planes[2];
+        cpu.strideY = header.rowBytes[0];
+        cpu.strideU = header.rowBytes[1];
+        cpu.strideV = header.rowBytes[2];
+    }
+
+    frame = InputData();
+    frame.cpu = cpu;
+    frame.dataType = InputDataType::CPUBuffer;
+    frame.hostTimeUs = header.hostTimeUs;
+    frame.platformBufferHolder = mMapping;
+    return true;
+}
+
+// =============================================================================
+// FrameReplayer
+// =============================================================================
+
+bool FrameReplayer::waitForQueueSpace(const InputEntity& input) const {
+    const InputConfig& config = input.getInputConfig();
+    const size_t limit = config.queueMode == InputQueueMode::LatestOnly
+        ? 1 : std::max<size_t>(config.queueCapacity, 1);
+    while (input.getPendingInputCount() >= limit) {
+        if (mStopRequested.load(std::memory_order_acquire) || !input.isProcessingLoopRunning()) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return !mStopRequested.load(std::memory_order_acquire);
+}
+
+uint64_t FrameReplayer::replay(InputEntity& input, const ReplayOptions& options) {
+    mStopRequested.store(false, std::memory_order_release);
+    const uint64_t frameCount = mReader.getFrameCount();
+    InputData first;
+    InputData last;
+    if (frameCount == 0 || !mReader.readFrame(0, first) || !mReader.readFrame(frameCount - 1, last)) {
+        PIPELINE_LOGW("FrameReplayer: nothing to replay");
+        return 0;
+    }
+
+    // 多轮回放时后一轮的时间戳顺延：录制时长加一个平均帧间隔
+    const int64_t span = last.cpu.timestamp - first.cpu.timestamp;
+    const int64_t step = frameCount > 1 ? span / static_cast<int64_t>(frameCount - 1) : 33333;
+    const int64_t loopStride = span + std::max<int64_t>(step, 1);
+    const auto& parameters = mReader.getParameters();
+
+    uint64_t submitted = 0;
+    for (uint32_t loop = 0; loop < std::max<uint32_t>(options.loops, 1); ++loop) {
+        const auto start = std::chrono::steady_clock::now();
+        size_t nextParameter = 0;
+        auto applyParameters = [&](uint64_t frameIndex) {
+            for (; nextParameter < parameters.size() &&
+                   parameters[nextParameter].frameIndex <= frameIndex; ++nextParameter) {
+                if (options.onParameter) {
+                    options.onParameter(parameters[nextParameter]);
+                }
+            }
+        };
+
+        for (uint64_t i = 0; i < frameCount; ++i) {
+            if (mStopRequested.load(std::memory_order_acquire)) {
+                return submitted;
+            }
+            applyParameters(i);
+
+            InputData frame;
+            if (!mReader.readFrame(i, frame)) {
+                continue;
+            }
+            if (options.speed == ReplaySpeed::Original) {
+                std::this_thread::sleep_until(
+                    start + std::chrono::microseconds(frame.hostTimeUs - first.hostTimeUs));
+            } else if (options.lossless && !waitForQueueSpace(input)) {
+                return submitted;
+            }
+
+            frame.cpu.timestamp += static_cast<int64_t>(loop) * loopStride;
+            frame.hostTimeUs = 0;   // 提交时间由 InputEntity 重新记录
+            if (input.submitData(frame)) {
+                ++submitted;
+            }
+        }
+        // 最后一帧之后的修改
+        applyParameters(UINT64_MAX);
+    }
+
+    PIPELINE_LOGI("FrameReplayer: submitted %llu of %llu frames",
+                  static_cast<unsigned long long>(submitted),
+                  static_cast<unsigned long long>(frameCount * std::max<uint32_t>(options.loops, 1)));
+    return submitted;
+}
+
+} // namespace input
+} // namespace pipeline
@@ -6,9 +6,79 @@
 #include "pipeline/input/FrameSynchronizer.h"
 #include "pipeline/data/FramePacket.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 namespace pipeline {
 namespace input {
 
+// =============================================================================
+// TimestampRing
+// =============================================================================
+
+bool FrameSynchronizer::TimestampRing::insert(PendingFrame frame, size_t capacity) {
+    capacity = std::max<size_t>(1, std::min(capacity, kRingCapacity));
+    bool dropped = false;
+    while (mCount >= capacity) {
+        take(0);
+        dropped = true;
+    }
+    
+    // 从队尾向前找插入点，乱序到达时后移较新的帧
+    size_t pos = mCount;
+    while (pos > 0 && at(pos - 1).timestamp > frame.timestamp) {
+        at(pos) = std::move(at(pos - 1));
+        --pos;
+    }
+    at(pos) = std::move(frame);
+    ++mCount;
+    return dropped;
+}
+
+size_t FrameSynchronizer::TimestampRing::findNearest(int64_t timestamp, int64_t tolerance) const {
+    size_t best = kNotFound;
+    int64_t bestDiff = tolerance;
+    for (size_t i = 0; i < mCount; ++i) {
+        int64_t ts = at(i).timestamp;
+        if (ts > timestamp + tolerance) {
+            break; // 有序，之后只会更远
+        }
+        int64_t diff = std::abs(ts - timestamp);
+        if (diff <= bestDiff) {
+            best = i;
+            bestDiff = diff;
+        }
+    }
+    return best;
+}
+
+FrameSynchronizer::PendingFrame FrameSynchronizer::TimestampRing::take(size_t i) {
+    PendingFrame frame = std::move(at(i));
+    // 移动较近的一端，取最旧帧时只需前移 head
+    if (i < mCount / 2) {
+        for (size_t k = i; k > 0; --k) {
+            at(k) = std::move(at(k - 1));
+        }
+        at(0) = PendingFrame();
+        mHead = (mHead + 1) % kRingCapacity;
+    } else {
+        for (size_t k = i; k + 1 < mCount; ++k) {
+            at(k) = std::move(at(k + 1));
+        }
+        at(mCount - 1) = PendingFrame();
+    }
+    --mCount;
+    return frame;
+}
+
+void FrameSynchronizer::TimestampRing::clear() {
+    for (auto& slot : mSlots) {
+        slot = PendingFrame();
+    }
+    mHead = 0;
+    mCount = 0;
+}
+
 // =============================================================================
 // 构造与析构
 // =============================================================================
@@ -29,8 +99,9 @@ void FrameSynchronizer::configure(const FrameSyncConfig& config) {
 }
 
 void FrameSynchronizer::setCallback(SyncCallback callback) {
+    auto shared = callback ? std::make_shared<SyncCallback>(std::move(callback)) : nullptr;
     std::lock_guard<std::mutex> lock(mMutex);
-    mCallback = std::move(callback);
+    mCallback = std::move(shared);
 }
 
 // =============================================================================
@@ -38,63 +109,37 @@ void FrameSynchronizer::setCallback(SyncCallback callback) {
 // =============================================================================
 
 void FrameSynchronizer::pushGPUFrame(FramePacketPtr frame, int64_t timestamp) {
-    if (!frame || !mConfig.enableGPU) {
+    if (!frame) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    ++mTotalGPUFrames;
-    
-    // 查找或创建匹配的时间戳记录
-    int64_t matchedTs = findMatchingTimestamp(timestamp);
-    if (matchedTs == 0) {
-        matchedTs = timestamp;
-    }
-    
-    auto& pending = mPendingFrames[matchedTs];
-    pending.gpuFrame = frame;
-    pending.hasGPU = true;
-    pending.timestamp = matchedTs;
-    if (pending.arrivalTime.time_since_epoch().count() == 0) {
-        pending.arrivalTime = std::chrono::steady_clock::now();
+    EmitList emitted;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mConfig.enableGPU) {
+            return;
+        }
+        ++mTotalGPUFrames;
+        pushLocked(kGPU, std::move(frame), timestamp, emitted);
     }
-    
-    // 清理旧帧
-    cleanupOldFrames();
-    
-    // 尝试完成同步
-    tryComplete(matchedTs);
+    dispatchCallbacks(emitted);
 }
 
 void FrameSynchronizer::pushCPUFrame(FramePacketPtr frame, int64_t timestamp) {
-    if (!frame || !mConfig.enableCPU) {
+    if (!frame) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    ++mTotalCPUFrames;
-    
-    // 查找或创建匹配的时间戳记录
-    int64_t matchedTs = findMatchingTimestamp(timestamp);
-    if (matchedTs == 0) {
-        matchedTs = timestamp;
-    }
-    
-    auto& pending = mPendingFrames[matchedTs];
-    pending.cpuFrame = frame;
-    pending.hasCPU = true;
-    pending.timestamp = matchedTs;
-    if (pending.arrivalTime.time_since_epoch().count() == 0) {
-        pending.arrivalTime = std::chrono::steady_clock::now();
+    EmitList emitted;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mConfig.enableCPU) {
+            return;
+        }
+        ++mTotalCPUFrames;
+        pushLocked(kCPU, std::move(frame), timestamp, emitted);
     }
-    
-    // 清理旧帧
-    cleanupOldFrames();
-    
-    // 尝试完成同步
-    tryComplete(matchedTs);
+    dispatchCallbacks(emitted);
 }
 
 // =============================================================================
@@ -102,51 +147,54 @@ void FrameSynchronizer::pushCPUFrame(FramePacketPtr frame, int64_t timestamp) {
 // =============================================================================
 
 SyncedFramePtr FrameSynchronizer::tryGetSyncedFrame() {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    // 先检查超时
-    checkTimeouts();
-    
-    if (mSyncedFrames.empty()) {
+    // 无帧可取且没有未配对帧时不必加锁
+    if (mSyncedCount.load(std::memory_order_acquire) == 0 &&
+        mPendingCounts[kGPU].load(std::memory_order_relaxed) == 0 &&
+        mPendingCounts[kCPU].load(std::memory_order_relaxed) == 0) {
         return nullptr;
     }
     
-    auto frame = mSyncedFrames.front();
-    mSyncedFrames.pop();
+    EmitList emitted;
+    SyncedFramePtr frame;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        checkTimeouts(emitted);
+        if (!mSyncedFrames.empty()) {
+            frame = std::move(mSyncedFrames.front());
+            mSyncedFrames.pop();
+            mSyncedCount.store(mSyncedFrames.size(), std::memory_order_release);
+        }
+    }
+    dispatchCallbacks(emitted);
     return frame;
 }
 
 SyncedFramePtr FrameSynchronizer::waitSyncedFrame(int64_t timeoutMs) {
-    std::unique_lock<std::mutex> lock(mMutex);
-    
-    // 先检查是否已有可用帧
-    checkTimeouts();
-    if (!mSyncedFrames.empty()) {
-        auto frame = mSyncedFrames.front();
-        mSyncedFrames.pop();
-        return frame;
-    }
-    
-    // 等待新帧
-    if (timeoutMs < 0) {
-        mSyncedCond.wait(lock, [this] { return !mSyncedFrames.empty(); });
-    } else {
-        if (!mSyncedCond.wait_for(lock, std::chrono::milliseconds(timeoutMs),
-                                   [this] { return !mSyncedFrames.empty(); })) {
-            // 超时，检查是否可以强制输出
-            checkTimeouts();
-            if (mSyncedFrames.empty()) {
-                return nullptr;
+    EmitList emitted;
+    SyncedFramePtr frame;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        
+        // 先检查是否已有可用帧
+        checkTimeouts(emitted);
+        if (mSyncedFrames.empty()) {
+            // 等待新帧
+            if (timeoutMs < 0) {
+                mSyncedCond.wait(lock, [this] { return !mSyncedFrames.empty(); });
+            } else if (!mSyncedCond.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                             [this] { return !mSyncedFrames.empty(); })) {
+                // 超时，检查是否可以强制输出
+                checkTimeouts(emitted);
             }
         }
+        
+        if (!mSyncedFrames.empty()) {
+            frame = std::move(mSyncedFrames.front());
+            mSyncedFrames.pop();
+            mSyncedCount.store(mSyncedFrames.size(), std::memory_order_release);
+        }
     }
-    
-    if (mSyncedFrames.empty()) {
-        return nullptr;
-    }
-    
-    auto frame = mSyncedFrames.front();
-    mSyncedFrames.pop();
+    dispatchCallbacks(emitted);
     return frame;
 }
 
@@ -155,35 +203,19 @@ SyncedFramePtr FrameSynchronizer::waitSyncedFrame(int64_t timeoutMs) {
 // =============================================================================
 
 size_t FrameSynchronizer::getPendingGPUCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    size_t count = 0;
-    for (const auto& [ts, frame] : mPendingFrames) {
-        if (frame.hasGPU && !frame.hasCPU) {
-            ++count;
-        }
-    }
-    return count;
+    return mPendingCounts[kGPU].load(std::memory_order_relaxed);
 }
 
 size_t FrameSynchronizer::getPendingCPUCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    size_t count = 0;
-    for (const auto& [ts, frame] : mPendingFrames) {
-        if (frame.hasCPU && !frame.hasGPU) {
-            ++count;
-        }
-    }
-    return count;
+    return mPendingCounts[kCPU].load(std::memory_order_relaxed);
 }
 
 size_t FrameSynchronizer::getSyncedCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mSyncedFrames.size();
+    return mSyncedCount.load(std::memory_order_acquire);
 }
 
 bool FrameSynchronizer::hasSyncedFrame() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return !mSyncedFrames.empty();
+    return mSyncedCount.load(std::memory_order_acquire) > 0;
 }
 
 // =============================================================================
@@ -192,18 +224,19 @@ bool FrameSynchronizer::hasSyncedFrame() const {
 
 void FrameSynchronizer::clear() {
     std::lock_guard<std::mutex> lock(mMutex);
-    mPendingFrames.clear();
+    for (auto& ring : mRings) {
+        ring.clear();
+    }
     while (!mSyncedFrames.empty()) {
         mSyncedFrames.pop();
     }
+    mSyncedCount.store(0, std::memory_order_release);
+    updatePendingCountsLocked();
 }
 
 void FrameSynchronizer::reset() {
+    clear();
     std::lock_guard<std::mutex> lock(mMutex);
-    mPendingFrames.clear();
-    while (!mSyncedFrames.empty()) {
-        mSyncedFrames.pop();
-    }
     mTotalGPUFrames = 0;
     mTotalCPUFrames = 0;
     mTotalSyncedFrames = 0;
@@ -211,135 +244,131 @@ void FrameSynchronizer::reset() {
 }
 
 void FrameSynchronizer::flush() {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    // 强制输出所有待同步帧
-    for (auto& [ts, frame] : mPendingFrames) {
-        emitSyncedFrame(frame);
+    EmitList emitted;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        
+        // 强制输出所有未配对帧，两路按时间戳交错
+        auto& gpu = mRings[kGPU];
+        auto& cpu = mRings[kCPU];
+        while (!gpu.empty() || !cpu.empty()) {
+            bool takeGPU = cpu.empty() || (!gpu.empty() && gpu.at(0).timestamp <= cpu.at(0).timestamp);
+            Stream stream = takeGPU ? kGPU : kCPU;
+            emitSyncedFrame(stream, mRings[stream].take(0), nullptr, emitted);
+        }
+        updatePendingCountsLocked();
     }
-    mPendingFrames.clear();
+    dispatchCallbacks(emitted);
 }
 
 // =============================================================================
 // 内部方法
 // =============================================================================
 
-int64_t FrameSynchronizer::findMatchingTimestamp(int64_t timestamp) {
-    // 在容差范围内查找匹配的时间戳
-    for (const auto& [ts, frame] : mPendingFrames) {
-        int64_t diff = std::abs(ts - timestamp);
-        if (diff <= mConfig.timestampToleranceUs) {
-            return ts;
-        }
+void FrameSynchronizer::pushLocked(Stream stream, FramePacketPtr frame, int64_t timestamp,
+                                   EmitList& emitted) {
+    PendingFrame pending;
+    pending.frame = std::move(frame);
+    pending.timestamp = timestamp;
+    pending.arrivalTime = std::chrono::steady_clock::now();
+    
+    // 对侧已有容差内的帧：直接配对输出
+    Stream other = stream == kGPU ? kCPU : kGPU;
+    size_t match = mRings[other].findNearest(timestamp, mConfig.timestampToleranceUs);
+    if (match != TimestampRing::kNotFound) {
+        PendingFrame matched = mRings[other].take(match);
+        emitSyncedFrame(stream, std::move(pending), &matched, emitted);
+    } else if (completesAlone(stream)) {
+        emitSyncedFrame(stream, std::move(pending), nullptr, emitted);
+    } else if (mRings[stream].insert(std::move(pending), mConfig.maxPendingFrames)) {
+        ++mDroppedFrames;
     }
-    return 0; // 未找到匹配
+    
+    updatePendingCountsLocked();
 }
 
-void FrameSynchronizer::tryComplete(int64_t timestamp) {
-    auto it = mPendingFrames.find(timestamp);
-    if (it == mPendingFrames.end()) {
-        return;
-    }
-    
-    const auto& frame = it->second;
-    bool canComplete = false;
-    
+bool FrameSynchronizer::completesAlone(Stream stream) const {
     switch (mConfig.policy) {
         case SyncPolicy::WaitBoth:
-            // 需要两路都完成
-            if (mConfig.enableGPU && mConfig.enableCPU) {
-                canComplete = frame.hasGPU && frame.hasCPU;
-            } else if (mConfig.enableGPU) {
-                canComplete = frame.hasGPU;
-            } else if (mConfig.enableCPU) {
-                canComplete = frame.hasCPU;
-            }
-            break;
-            
+            // 对侧未启用时单路即完整
+            return stream == kGPU ? !mConfig.enableCPU : !mConfig.enableGPU;
         case SyncPolicy::GPUFirst:
-            // GPU 到达即可完成（CPU 可选）
-            canComplete = frame.hasGPU;
-            break;
-            
+            return stream == kGPU;
         case SyncPolicy::CPUFirst:
-            // CPU 到达即可完成（GPU 可选）
-            canComplete = frame.hasCPU;
-            break;
-            
+            return stream == kCPU;
         case SyncPolicy::DropOld:
-            // 只保留最新，立即完成
-            canComplete = frame.hasGPU || frame.hasCPU;
-            break;
-    }
-    
-    if (canComplete) {
-        emitSyncedFrame(frame);
-        mPendingFrames.erase(it);
+            return true;
     }
+    return false;
 }
 
-void FrameSynchronizer::checkTimeouts() {
+void FrameSynchronizer::checkTimeouts(EmitList& emitted) {
     auto now = std::chrono::steady_clock::now();
     auto maxWait = std::chrono::milliseconds(mConfig.maxWaitTimeMs);
     
-    std::vector<int64_t> timedOutTs;
-    
-    for (auto& [ts, frame] : mPendingFrames) {
-        auto elapsed = now - frame.arrivalTime;
-        if (elapsed >= maxWait) {
-            timedOutTs.push_back(ts);
-        }
-    }
-    
-    // 处理超时帧
-    for (int64_t ts : timedOutTs) {
-        auto it = mPendingFrames.find(ts);
-        if (it != mPendingFrames.end()) {
+    // 环按时间戳排序，与到达顺序基本一致：最旧的帧未超时即可停止
+    bool changed = false;
+    for (size_t s = 0; s < kStreamCount; ++s) {
+        auto& ring = mRings[s];
+        while (!ring.empty() && now - ring.at(0).arrivalTime >= maxWait) {
             // 超时后强制输出（即使不完整）
-            emitSyncedFrame(it->second);
-            mPendingFrames.erase(it);
+            emitSyncedFrame(static_cast<Stream>(s), ring.take(0), nullptr, emitted);
+            changed = true;
         }
     }
-}
-
-void FrameSynchronizer::cleanupOldFrames() {
-    // 如果待同步帧过多，丢弃最旧的
-    while (mPendingFrames.size() > mConfig.maxPendingFrames) {
-        // 找到最旧的帧
-        int64_t oldestTs = INT64_MAX;
-        for (const auto& [ts, frame] : mPendingFrames) {
-            if (ts < oldestTs) {
-                oldestTs = ts;
-            }
-        }
-        
-        if (oldestTs != INT64_MAX) {
-            auto it = mPendingFrames.find(oldestTs);
-            if (it != mPendingFrames.end()) {
-                ++mDroppedFrames;
-                mPendingFrames.erase(it);
-            }
-        }
+    if (changed) {
+        updatePendingCountsLocked();
     }
 }
 
-void FrameSynchronizer::emitSyncedFrame(const PendingFrame& frame) {
+void FrameSynchronizer::emitSyncedFrame(Stream stream, PendingFrame&& frame,
+                                        PendingFrame* matched, EmitList& emitted) {
     auto synced = std::make_shared<SyncedFrame>();
-    synced->gpuFrame = frame.gpuFrame;
-    synced->cpuFrame = frame.cpuFrame;
-    synced->timestamp = frame.timestamp;
-    synced->hasGPU = frame.hasGPU;
-    synced->hasCPU = frame.hasCPU;
+    PendingFrame* gpu = stream == kGPU ? &frame : matched;
+    PendingFrame* cpu = stream == kCPU ? &frame : matched;
+    if (gpu) {
+        synced->gpuFrame = std::move(gpu->frame);
+        synced->hasGPU = true;
+    }
+    if (cpu) {
+        synced->cpuFrame = std::move(cpu->frame);
+        synced->hasCPU = true;
+    }
+    // 配对时沿用先到一方的时间戳，与旧的按时间戳建档行为一致
+    synced->timestamp = matched ? matched->timestamp : frame.timestamp;
     
     ++mTotalSyncedFrames;
     
     // 添加到队列
     mSyncedFrames.push(synced);
+    mSyncedCount.store(mSyncedFrames.size(), std::memory_order_release);
     mSyncedCond.notify_one();
     
-    // 触发回调
     if (mCallback) {
-        mCallback(synced);
+        emitted.push_back(std::move(synced));
+    }
+}
+
+void FrameSynchronizer::dispatchCallbacks(const EmitList& emitted) {
+    if (emitted.empty()) {
+        return;
+    }
+    std::shared_ptr<SyncCallback> callback;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        callback = mCallback;
+    }
+    if (!callback) {
+        return;
+    }
+    for (const auto& frame : emitted) {
+        (*callback)(frame);
+    }
+}
+
+void FrameSynchronizer::updatePendingCountsLocked() {
+    for (size_t s = 0; s < kStreamCount; ++s) {
+        mPendingCounts[s].store(mRings[s].size(), std::memory_order_relaxed);
     }
 }
 
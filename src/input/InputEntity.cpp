@@ -4,12 +4,16 @@
  */
 
 #include "pipeline/input/InputEntity.h"
+#include "pipeline/input/FrameRecording.h"
 #include "pipeline/data/FramePacket.h"
 #include "pipeline/core/PipelineConfig.h"
 #include "pipeline/core/PipelineExecutor.h"
+#include "pipeline/pool/FramePacketPool.h"
 #include "pipeline/utils/PipelineLog.h"
+#include "pipeline/simd/PixelKernels.h"
 #include "lrengine/core/LRPlanarTexture.h"
 
+#include <algorithm>
 #include <chrono>
 
 // libyuv 头文件
@@ -18,12 +22,49 @@
 namespace pipeline {
 namespace input {
 
+namespace {
+
+bool isYUVFormat(InputFormat format) {
+    return format == InputFormat::NV12 || format == InputFormat::NV21 ||
+           format == InputFormat::YUV420;
+}
+
+// 多平面纹理对应的像素格式（非YUV输入没有多平面形式）
+PixelFormat toPlanarPixelFormat(InputFormat format) {
+    switch (format) {
+        case InputFormat::NV12: return PixelFormat::NV12;
+        case InputFormat::NV21: return PixelFormat::NV21;
+        case InputFormat::YUV420: return PixelFormat::YUV420;
+        default: return PixelFormat::Unknown;
+    }
+}
+
+// 解析输出尺寸：宽高均为 0 时使用输入尺寸，只给出一边时按宽高比推算
+void resolveCPUOutputSize(const CPUOutputSpec& spec, uint32_t srcWidth, uint32_t srcHeight,
+                          uint32_t& dstWidth, uint32_t& dstHeight) {
+    dstWidth = spec.width;
+    dstHeight = spec.height;
+    if (dstWidth == 0 && dstHeight == 0) {
+        dstWidth = srcWidth;
+        dstHeight = srcHeight;
+    } else if (dstWidth == 0) {
+        dstWidth = static_cast<uint32_t>(static_cast<uint64_t>(srcWidth) * dstHeight / std::max(srcHeight, 1u));
+    } else if (dstHeight == 0) {
+        dstHeight = static_cast<uint32_t>(static_cast<uint64_t>(srcHeight) * dstWidth / std::max(srcWidth, 1u));
+    }
+    dstWidth = std::max(dstWidth, 1u);
+    dstHeight = std::max(dstHeight, 1u);
+}
+
+} // namespace
+
 // =============================================================================
 // 构造与析构
 // =============================================================================
 
 InputEntity::InputEntity(const std::string& name)
-    : ProcessEntity(name) {
+    : ProcessEntity(name)
+    , mInputQueue(std::make_unique<SPSCQueue<InputData>>(mConfig.queueCapacity)) {
     initializePorts();
 }
 
@@ -38,6 +79,12 @@ InputEntity::~InputEntity() {
 // 端口初始化
 // =============================================================================
 
+namespace {
+// 输出端口索引（与 initializePorts 的添加顺序一致）
+constexpr size_t kGPUOutputIndex = 0;
+constexpr size_t kCPUOutputIndex = 1;
+} // anonymous namespace
+
 void InputEntity::initializePorts() {
     // InputEntity 没有输入端口，只有输出端口
     addOutputPort(GPU_OUTPUT_PORT);
@@ -52,11 +99,86 @@ void InputEntity::configure(const InputConfig& config) {
     // 配置通常在初始化阶段调用，不需要锁保护
     mConfig = config;
     
-    // 根据配置预分配 CPU 缓冲区
+    // 队列仅在启动处理循环前重建（SPSC 队列不支持并发替换）
+    if (!mTaskRunning.load() && mInputQueue->capacity() != std::max(config.queueCapacity, 1u)) {
+        mInputQueue = std::make_unique<SPSCQueue<InputData>>(config.queueCapacity);
+    }
+    
+    // 根据配置确定 CPU 缓冲区容量（每帧从缓冲池分配）
     if (config.enableDualOutput || config.dataType == InputDataType::CPUBuffer) {
-        size_t bufferSize = config.width * config.height * 4; // RGBA
-        mCPUOutputBuffer.resize(bufferSize);
+        size_t bufferSize = static_cast<size_t>(config.width) * config.height * 4; // RGBA
+        mCPUBufferCapacity = bufferSize;
     }
+    
+    setCPUOutputSpec(config.cpuOutput);
+    setClockRole(config.clockRole);
+    setFrameRateLimit(config.maxFrameRate);
+}
+
+void InputEntity::setFrameRateLimit(float fps) {
+    const int64_t intervalUs = fps > 0.0f ? static_cast<int64_t>(1000000.0f / fps) : 0;
+    mFrameIntervalUs.store(intervalUs, std::memory_order_relaxed);
+}
+
+float InputEntity::getFrameRateLimit() const {
+    const int64_t intervalUs = mFrameIntervalUs.load(std::memory_order_relaxed);
+    return intervalUs > 0 ? 1000000.0f / static_cast<float>(intervalUs) : 0.0f;
+}
+
+void InputEntity::setCropRect(const RoiRect& rect) {
+    mCropRect.publish(rect);
+}
+
+RoiRect InputEntity::getCropRect() const {
+    return mCropRect.read([](const RoiRect& rect) { return rect; });
+}
+
+void InputEntity::latchParameters() {
+    mCropRect.acquire();
+}
+
+bool InputEntity::rateLimited(int64_t timestampUs) {
+    const int64_t intervalUs = mFrameIntervalUs.load(std::memory_order_relaxed);
+    if (intervalUs != mActiveIntervalUs) {
+        // 上限变化：从下一帧重新对齐
+        mActiveIntervalUs = intervalUs;
+        mRateAnchored = false;
+    }
+    if (intervalUs <= 0) {
+        return false;
+    }
+    
+    // 允许提前 1/4 间隔到达，60fps 源抽成 30fps 时抖动不会造成连续两帧被抽掉
+    const int64_t toleranceUs = intervalUs / 4;
+    if (mRateAnchored && timestampUs + toleranceUs < mNextDueUs &&
+        timestampUs + intervalUs * 2 > mNextDueUs) {
+        mRateLimitedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // 按理想网格推进，不随单帧抖动漂移；停顿、跳变（含时间戳回退）后以本帧重新对齐
+    if (!mRateAnchored || timestampUs - mNextDueUs >= intervalUs ||
+        timestampUs + intervalUs * 2 <= mNextDueUs) {
+        mNextDueUs = timestampUs + intervalUs;
+    } else {
+        mNextDueUs += intervalUs;
+    }
+    mRateAnchored = true;
+    return false;
+}
+
+void InputEntity::setCPUOutputSpec(const CPUOutputSpec& spec) {
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    mCPUOutputSpec = spec;
+}
+
+void InputEntity::setClockRole(InputClockRole role) {
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        mClockRole.store(role, std::memory_order_release);
+    }
+    // 降为从属：正在等待的处理任务不再等新帧
+    mDataAvailableCV.notify_all();
 }
 
 void InputEntity::setRenderContext(lrengine::render::LRRenderContext* context) {
@@ -95,31 +217,95 @@ bool InputEntity::submitGPUData(const GPUInputData& data) {
 }
 
 bool InputEntity::submitData(const InputData& data) {
-    {
-        std::unique_lock<std::mutex> lock(mQueueMutex);
-        
-        // 检查任务是否正在运行
-        if (!mTaskRunning.load()) {
-            PIPELINE_LOGW("Submit data while task not running");
-            return false;
-        }
-        
-        // 检查队列是否满
-        if (mInputQueue.size() >= mMaxQueueSize) {
-            if (mDropOldestOnFull) {
-                mInputQueue.pop();  // 丢弃最旧帧
-            } else {
-                // 丢弃新帧
-                return false;
+    // 检查任务是否正在运行
+    if (!mTaskRunning.load(std::memory_order_acquire)) {
+        PIPELINE_LOGW("Submit data while task not running");
+        return false;
+    }
+    
+    // 在提交线程记录收到时间并更新时钟偏移（时间戳为 0 的输入直接以收到时间为准）
+    const int64_t hostTimeUs = ClockDomain::hostNowUs();
+    int64_t sourceTs = data.dataType == InputDataType::GPUTexture ? data.gpu.timestamp : data.cpu.timestamp;
+    if (sourceTs > 0) {
+        mClockDomain.observe(sourceTs, hostTimeUs);
+    }
+    
+    if (auto recorder = std::atomic_load(&mRecorder)) {
+        InputData recorded = data;
+        recorded.hostTimeUs = hostTimeUs;
+        recorder->recordFrame(recorded);
+    }
+    
+    // 超出帧率上限的帧在入队前抽掉，后续转换、上传与分配都不会发生
+    if (rateLimited(sourceTs > 0 ? sourceTs : hostTimeUs)) {
+        return true;
+    }
+    
+    InputData stamped = data;
+    stamped.hostTimeUs = hostTimeUs;
+    
+    // 有传输队列时所有帧都经传输线程入队，SPSC 队列始终只有一个生产线程
+    if (shouldUploadOnTransfer()) {
+        std::weak_ptr<ProcessEntity> weakSelf = weak_from_this();
+        mExecutor->postToTransferQueue([weakSelf, frame = std::move(stamped)]() mutable {
+            auto self = weakSelf.lock();
+            if (!self) {
+                return;
+            }
+            auto* entity = static_cast<InputEntity*>(self.get());
+            if (!entity->mTaskRunning.load(std::memory_order_acquire)) {
+                return;
             }
+            entity->uploadOnTransfer(frame);
+            entity->enqueueInput(std::move(frame));
+        });
+        return true;
+    }
+    
+    return enqueueInput(std::move(stamped));
+}
+
+bool InputEntity::shouldUploadOnTransfer() const {
+    // 传输队列只做多平面上传，下游要求 RGB 时在处理线程上传并转换
+    return mExecutor && mExecutor->hasTransferQueue() &&
+           mStrategy && mStrategy->supportsTransferUpload() && allowsPlanarGPUOutput();
+}
+
+void InputEntity::uploadOnTransfer(InputData& data) {
+    // 平台 buffer 与外部纹理走零拷贝/直通路径，只有内存帧值得提前上传
+    if (data.dataType != InputDataType::CPUBuffer || !isGPUOutputEnabled()) {
+        return;
+    }
+    std::shared_ptr<lrengine::render::LRPlanarTexture> texture;
+    if (!mStrategy->processToGPUPlanar(data, texture) || !texture) {
+        return;
+    }
+    data.uploadedTexture = std::move(texture);
+    data.uploadFence = GpuFence::insert();
+}
+
+bool InputEntity::enqueueInput(InputData&& stamped) {
+    bool accepted = true;
+    if (mConfig.queueMode == InputQueueMode::LatestOnly) {
+        // 只保留最新帧：未被处理的旧帧被覆盖
+        if (mInputMailbox.publish(std::move(stamped))) {
+            mDroppedFrameCount.fetch_add(1, std::memory_order_relaxed);
         }
-        mInputQueue.push(data);
+    } else if (!mInputQueue->tryPush(std::move(stamped))) {
+        // 队列满：丢弃新帧
+        mDroppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        accepted = false;
     }
     
-    // 在锁外通知，避免不必要的唤醒竞争
-    mDataAvailableCV.notify_one();
+    // 与处理线程的 mWaitingForData 写入配对：要么对方在等待前看到新数据，
+    // 要么这里看到等待标志并唤醒；处理线程忙时不加锁
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (accepted && mWaitingForData.load(std::memory_order_relaxed)) {
+        { std::lock_guard<std::mutex> lock(mQueueMutex); }
+        mDataAvailableCV.notify_one();
+    }
     
-    return true;
+    return accepted;
 }
 
 // =============================================================================
@@ -244,6 +430,60 @@ bool InputEntity::isCPUOutputEnabled() const {
            mConfig.dataType == InputDataType::Both;
 }
 
+bool InputEntity::producesGPUOutput() const {
+    return isGPUOutputEnabled() && isOutputDemanded(kGPUOutputIndex);
+}
+
+bool InputEntity::producesCPUOutput() const {
+    return isCPUOutputEnabled() && isOutputDemanded(kCPUOutputIndex);
+}
+
+std::vector<PixelFormat> InputEntity::getOutputFormatCandidates(size_t port) const {
+    if (port != kGPUOutputIndex || !isYUVFormat(mConfig.format)) {
+        return {};
+    }
+    return {toPlanarPixelFormat(mConfig.format), PixelFormat::RGBA8};
+}
+
+bool InputEntity::allowsPlanarGPUOutput() const {
+    PixelFormat negotiated = getNegotiatedOutputFormat(kGPUOutputIndex);
+    return negotiated == PixelFormat::Unknown || containsPixelFormat(kYUVPixelFormats, negotiated);
+}
+
+size_t InputEntity::getPendingInputCount() const {
+    if (mConfig.queueMode == InputQueueMode::LatestOnly) {
+        return mInputMailbox.hasValue() ? 1 : 0;
+    }
+    return mInputQueue ? mInputQueue->sizeApprox() : 0;
+}
+
+// =============================================================================
+// 录制
+// =============================================================================
+
+bool InputEntity::startRecording(const std::string& path) {
+    auto recorder = std::make_shared<FrameRecorder>();
+    if (!recorder->open(path, mConfig)) {
+        return false;
+    }
+    // 旧录制器在最后一个提交中的帧写完后随引用释放关闭
+    std::atomic_store(&mRecorder, std::move(recorder));
+    return true;
+}
+
+void InputEntity::stopRecording() {
+    if (auto recorder = std::atomic_exchange(&mRecorder, std::shared_ptr<FrameRecorder>())) {
+        recorder->close();
+    }
+}
+
+void InputEntity::recordParameterChange(const std::string& entityName, const std::string& key,
+                                        const std::any& value) {
+    if (auto recorder = std::atomic_load(&mRecorder)) {
+        recorder->recordParameter(entityName, key, value);
+    }
+}
+
 // =============================================================================
 // ProcessEntity 生命周期
 // =============================================================================
@@ -262,28 +502,48 @@ bool InputEntity::process(const std::vector<FramePacketPtr>& inputs,
                           std::vector<FramePacketPtr>& outputs,
                           PipelineContext& context) {
     InputData inputData;
+    bool follower = false;
     
     {
         std::unique_lock<std::mutex> lock(mQueueMutex);
+        mActiveCPUOutputSpec = mCPUOutputSpec;
+        follower = mClockRole.load(std::memory_order_acquire) == InputClockRole::Follower;
         
-        // 快速路径：队列非空，直接处理
-        if (!mInputQueue.empty()) {
-            inputData = mInputQueue.front();
-            mInputQueue.pop();
-        } else if (!mTaskRunning.load()) {
-            // 任务已停止，直接返回
-            return false;
-        } else {
+        if (follower) {
+            // 从属输入不等待：只取最新一帧，积压的旧帧直接丢弃，慢相机不拖住主时钟
+            bool fresh = popInput(inputData);
+            InputData newer;
+            while (fresh && popInput(newer)) {
+                inputData = std::move(newer);
+                mDroppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!fresh) {
+                return reuseLastOutputs(outputs);
+            }
+        } else if (!popInput(inputData)) {
+            // 快速路径（队列非空）之外：等待数据
+            if (!mTaskRunning.load()) {
+                // 任务已停止，直接返回
+                return false;
+            }
+            
             // 等待数据，使用超时机制防止永久阻塞
-            mWaitingForData.store(true);
+            mWaitingForData.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
             
             // 设置超时等待（最多等待 5 秒）
             constexpr auto kWaitTimeout = std::chrono::seconds(5);
-            bool notified = mDataAvailableCV.wait_for(lock, kWaitTimeout, [this] { 
-                return !mInputQueue.empty() || !mTaskRunning.load(); 
+            bool received = false;
+            bool notified = mDataAvailableCV.wait_for(lock, kWaitTimeout, [this, &inputData, &received] {
+                if (!mTaskRunning.load() ||
+                    mClockRole.load(std::memory_order_acquire) == InputClockRole::Follower) {
+                    return true;
+                }
+                received = popInput(inputData);
+                return received;
             });
             
-            mWaitingForData.store(false);
+            mWaitingForData.store(false, std::memory_order_relaxed);
             
             // 检查任务是否被取消
             if (!mTaskRunning.load()) {
@@ -298,18 +558,15 @@ bool InputEntity::process(const std::vector<FramePacketPtr>& inputs,
                 return false;
             }
             
-            // 再次检查队列（可能在等待期间有其他线程消费）
-            if (mInputQueue.empty()) {
-                PIPELINE_LOGW("Input queue is empty after wait");
-                return false;
+            // 等待期间被降为从属（切换主时钟）：本帧沿用上一帧
+            if (!received) {
+                return reuseLastOutputs(outputs);
             }
-            
-            // 出队
-            inputData = mInputQueue.front();
-            mInputQueue.pop();
         }
     }
     
+    reportDroppedFrames();
+    
     // 处理数据
     if (!processInputData(inputData)) {
         return false;
@@ -320,10 +577,17 @@ bool InputEntity::process(const std::vector<FramePacketPtr>& inputs,
                         ? inputData.gpu.timestamp 
                         : inputData.cpu.timestamp;
     
-    // 创建输出数据包
+    // 创建输出数据包（无人读取的输出仍占位，端口上的帧序与时间戳保持连续）
     if (isGPUOutputEnabled()) {
-        auto gpuPacket = createGPUOutputPacket(timestamp);
+        const bool produced = producesGPUOutput();
+        auto gpuPacket = produced ? createGPUOutputPacket(context, timestamp)
+                                  : createElidedPacket(context, timestamp);
         if (gpuPacket) {
+            stampClock(gpuPacket, inputData, timestamp);
+            gpuPacket->setRoi(mCropRect.current());
+            if (follower && produced) {
+                mLastGPUPacket = gpuPacket;
+            }
             outputs.push_back(gpuPacket);
             
             // 发送到 GPU 输出端口
@@ -335,8 +599,15 @@ bool InputEntity::process(const std::vector<FramePacketPtr>& inputs,
     }
     
     if (isCPUOutputEnabled()) {
-        auto cpuPacket = createCPUOutputPacket(timestamp);
+        const bool produced = producesCPUOutput();
+        auto cpuPacket = produced ? createCPUOutputPacket(context, timestamp)
+                                  : createElidedPacket(context, timestamp);
         if (cpuPacket) {
+            stampClock(cpuPacket, inputData, timestamp);
+            cpuPacket->setRoi(mCropRect.current());
+            if (follower && produced) {
+                mLastCPUPacket = cpuPacket;
+            }
             outputs.push_back(cpuPacket);
             
             // 发送到 CPU 输出端口
@@ -351,6 +622,33 @@ bool InputEntity::process(const std::vector<FramePacketPtr>& inputs,
     return true;
 }
 
+bool InputEntity::reuseLastOutputs(std::vector<FramePacketPtr>& outputs) {
+    // 尚无任何一帧时输出为空，下游按未连接处理；返回true以免主时钟的帧被放弃
+    if (isGPUOutputEnabled() && mLastGPUPacket) {
+        outputs.push_back(mLastGPUPacket);
+        if (auto* gpuPort = getOutputPort(GPU_OUTPUT_PORT)) {
+            gpuPort->setPacket(mLastGPUPacket);
+        }
+    }
+    if (isCPUOutputEnabled() && mLastCPUPacket) {
+        outputs.push_back(mLastCPUPacket);
+        if (auto* cpuPort = getOutputPort(CPU_OUTPUT_PORT)) {
+            cpuPort->setPacket(mLastCPUPacket);
+        }
+    }
+    return true;
+}
+
+void InputEntity::stampClock(const FramePacketPtr& packet, const InputData& data,
+                             int64_t timestamp) const {
+    SourceClockStamp stamp;
+    stamp.source = getId();
+    stamp.sourceTimestampUs = timestamp;
+    stamp.hostTimeUs = (timestamp > 0 && mClockDomain.isCalibrated())
+        ? mClockDomain.toHostUs(timestamp) : data.hostTimeUs;
+    packet->setMetadata(kSourceClockKey, stamp);
+}
+
 void InputEntity::finalize(PipelineContext& context) {
     // 发送输出到下游
     sendOutputs();
@@ -361,9 +659,41 @@ void InputEntity::finalize(PipelineContext& context) {
 // =============================================================================
 
 bool InputEntity::processInputData(const InputData& data) {
+    // 上一帧的输出已交给FramePacket，本帧重新选择
+    mCPUOutputBuffer.reset();
+    mCPUOutputSize = 0;
+    mCPUOutputWidth = 0;
+    mCPUOutputHeight = 0;
+    mCPUOutputFormat = PixelFormat::Unknown;
+    mGPUOutputExternalImage.reset();
+    
+    const CPUOutputSpec& spec = mActiveCPUOutputSpec;
+    // 按需产出：本帧无人读取的输出跳过上传/转换
+    const bool gpuOutput = producesGPUOutput();
+    const bool cpuOutput = producesCPUOutput();
+    
     // 使用策略处理（如果有）
     if (mStrategy) {
-        if (isGPUOutputEnabled()) {
+        bool imported = gpuOutput && mConfig.zeroCopyGPUImport &&
+                        mStrategy->processToGPUExternal(data, mGPUOutputExternalImage);
+        const bool planar = allowsPlanarGPUOutput();
+        if (gpuOutput && !imported && !planar) {
+            // 协商为 RGB：下游不接受多平面纹理，在上传时转换
+            mGPUOutputPlanarTexture.reset();
+            if (!mStrategy->processToGPU(data, mGPUOutputTexture)) {
+                return false;
+            }
+        } else if (gpuOutput && data.uploadedTexture) {
+            // 传输线程已上传：在 GPU 上等待上传完成，不阻塞 CPU
+            if (data.uploadFence) {
+                data.uploadFence->waitOnGPU();
+            }
+            mGPUOutputPlanarTexture = data.uploadedTexture;
+        } else if (gpuOutput && data.dataType == InputDataType::CPUBuffer &&
+                   shouldUploadOnTransfer()) {
+            // 传输线程上传失败：不在这里重试，避免两个线程同时进入策略的 GPU 路径
+            return false;
+        } else if (gpuOutput && !imported) {
             if (!mStrategy->processToGPUPlanar(data, mGPUOutputPlanarTexture)) {
                 if (!mStrategy->processToGPU(data, mGPUOutputTexture)) {
                     return false;
@@ -371,18 +701,28 @@ bool InputEntity::processInputData(const InputData& data) {
             }
         }
         
-        if (isCPUOutputEnabled()) {
-            size_t outputSize = mCPUOutputBuffer.size();
-            if (!mStrategy->processToCPU(data, mCPUOutputBuffer.data(), outputSize,
-                                         mConfig.width, mConfig.height)) {
+        if (cpuOutput) {
+            // 策略按输出规格的尺寸直接输出 RGBA
+            uint32_t targetWidth = mConfig.width;
+            uint32_t targetHeight = mConfig.height;
+            if (!spec.isDefault()) {
+                resolveCPUOutputSize(spec, mConfig.width, mConfig.height, targetWidth, targetHeight);
+            }
+            
+            size_t capacity = (mCPUBufferCapacity > 0 && spec.isDefault())
+                ? mCPUBufferCapacity : static_cast<size_t>(targetWidth) * targetHeight * 4;
+            size_t outputSize = capacity;
+            uint8_t* buffer = acquireCPUOutputBuffer(capacity);
+            if (!mStrategy->processToCPU(data, buffer, outputSize,
+                                         targetWidth, targetHeight)) {
                 // processToCPU 会更新 outputSize 为需要的大小
-                if (outputSize > mCPUOutputBuffer.size()) {
+                if (outputSize > capacity) {
                     PIPELINE_LOGD("Resizing CPU output buffer: %zu -> %zu", 
-                                 mCPUOutputBuffer.size(), outputSize);
-                    mCPUOutputBuffer.resize(outputSize);
+                                 capacity, outputSize);
+                    buffer = acquireCPUOutputBuffer(outputSize);
                     // 重试
-                    if (!mStrategy->processToCPU(data, mCPUOutputBuffer.data(), outputSize,
-                                                 mConfig.width, mConfig.height)) {
+                    if (!mStrategy->processToCPU(data, buffer, outputSize,
+                                                 targetWidth, targetHeight)) {
                         PIPELINE_LOGE("processToCPU failed after buffer resize");
                         return false;
                     }
@@ -391,14 +731,34 @@ bool InputEntity::processInputData(const InputData& data) {
                     return false;
                 }
             }
+            mCPUOutputSize = outputSize;
+            
+            if (!spec.isDefault()) {
+                mCPUOutputWidth = targetWidth;
+                mCPUOutputHeight = targetHeight;
+                mCPUOutputFormat = PixelFormat::RGBA8;
+                
+                size_t pixels = static_cast<size_t>(targetWidth) * targetHeight;
+                if (spec.format == CPUOutputFormat::Gray && outputSize == pixels * 4) {
+                    std::shared_ptr<uint8_t> rgba = mCPUOutputBuffer;
+                    simd::rgbaToGray(rgba.get(), targetWidth * 4,
+                                     acquireCPUOutputBuffer(pixels), targetWidth,
+                                     targetWidth, targetHeight);
+                    mCPUOutputFormat = PixelFormat::R8;
+                }
+            }
         }
         return true;
     }
     
-    // 默认处理：格式转换
-    if (data.dataType == InputDataType::CPUBuffer) {
-        if (isGPUOutputEnabled() && isCPUOutputEnabled()) {
-            if (!convertToRGBA(data.cpu, mCPUOutputBuffer.data())) {
+    // 默认处理：格式转换（已是连续RGBA且可持有时直接借用，不转换不复制）
+    if (data.dataType == InputDataType::CPUBuffer && cpuOutput) {
+        if (!spec.isDefault()) {
+            return produceScaledCPUOutput(data.cpu, spec);
+        }
+        if (!borrowCPUInput(data)) {
+            size_t size = static_cast<size_t>(data.cpu.width) * data.cpu.height * 4;
+            if (!convertToRGBA(data.cpu, acquireCPUOutputBuffer(size))) {
                 return false;
             }
         }
@@ -407,15 +767,70 @@ bool InputEntity::processInputData(const InputData& data) {
     return true;
 }
 
-FramePacketPtr InputEntity::createGPUOutputPacket(int64_t timestamp) {
-    auto packet = std::make_shared<FramePacket>();
+bool InputEntity::popInput(InputData& data) {
+    if (mConfig.queueMode == InputQueueMode::LatestOnly) {
+        return mInputMailbox.tryTake(data);
+    }
+    return mInputQueue->tryPop(data);
+}
+
+void InputEntity::reportDroppedFrames() {
+    uint64_t dropped = mDroppedFrameCount.load(std::memory_order_relaxed);
+    if (dropped == mReportedDropCount) {
+        return;
+    }
+    if (mExecutor) {
+        mExecutor->recordInputDrops(dropped - mReportedDropCount);
+    }
+    mReportedDropCount = dropped;
+}
+
+uint8_t* InputEntity::acquireCPUOutputBuffer(size_t size) {
+    // 缓冲在下游全部释放后自动归还到池，不会被改写
+    mCPUOutputBuffer = BufferPool::shared().acquire(size);
+    mCPUOutputSize = size;
+    return mCPUOutputBuffer.get();
+}
+
+uint8_t* InputEntity::acquireScratchBuffer(size_t size) {
+    if (mScratchCapacity < size) {
+        mScratchBuffer = BufferPool::shared().acquire(size);
+        mScratchCapacity = BufferPool::getAllocationSize(size);
+    }
+    return mScratchBuffer.get();
+}
+
+bool InputEntity::borrowCPUInput(const InputData& data) {
+    const CPUInputData& cpu = data.cpu;
+    uint32_t rowBytes = cpu.width * 4;
+    if (!data.platformBufferHolder || !cpu.data || cpu.format != InputFormat::RGBA ||
+        (cpu.stride != 0 && cpu.stride != rowBytes)) {
+        return false;
+    }
+    
+    // 别名指针：指向输入数据，同时持有平台buffer，直到最后一个FramePacket释放
+    mCPUOutputBuffer = std::shared_ptr<uint8_t>(data.platformBufferHolder,
+                                                const_cast<uint8_t*>(cpu.data));
+    mCPUOutputSize = static_cast<size_t>(rowBytes) * cpu.height;
+    return true;
+}
+
+FramePacketPtr InputEntity::createGPUOutputPacket(PipelineContext& context, int64_t timestamp) {
+    auto packet = context.acquireFramePacket();
     packet->setTimestamp(timestamp);
     packet->setFormat(PixelFormat::RGBA8);
     packet->setSize(mConfig.width, mConfig.height);
     
-    // 🔥 优先使用多平面纹理
-    if (mGPUOutputPlanarTexture) {
+    // 零拷贝导入的外部图像优先，其次多平面纹理
+    if (mGPUOutputExternalImage) {
+        packet->setExternalImage(mGPUOutputExternalImage);
+        packet->setFormat(getExternalImagePixelFormat(mGPUOutputExternalImage->format));
+        packet->setSize(mGPUOutputExternalImage->width, mGPUOutputExternalImage->height);
+    } else if (mGPUOutputPlanarTexture) {
         packet->setPlanarTexture(mGPUOutputPlanarTexture);
+        if (isYUVFormat(mConfig.format)) {
+            packet->setFormat(toPlanarPixelFormat(mConfig.format));
+        }
     } else if (mGPUOutputTexture) {
         packet->setTexture(mGPUOutputTexture);
     }
@@ -423,33 +838,166 @@ FramePacketPtr InputEntity::createGPUOutputPacket(int64_t timestamp) {
     return packet;
 }
 
-FramePacketPtr InputEntity::createCPUOutputPacket(int64_t timestamp) {
-    auto packet = std::make_shared<FramePacket>();
+FramePacketPtr InputEntity::createCPUOutputPacket(PipelineContext& context, int64_t timestamp) {
+    auto packet = context.acquireFramePacket();
     packet->setTimestamp(timestamp);
     packet->setSize(mConfig.width, mConfig.height);
     
-    // 设置像素格式（根据配置）
-    switch (mConfig.format) {
-        case InputFormat::YUV420:
-        case InputFormat::NV12:
-        case InputFormat::NV21:
-            packet->setFormat(PixelFormat::YUV420);
-            break;
-        default:
-            packet->setFormat(PixelFormat::RGBA8);
-            break;
+    if (mCPUOutputWidth > 0) {
+        // 按输出规格生成的缩小/灰度输出
+        packet->setSize(mCPUOutputWidth, mCPUOutputHeight);
+        packet->setFormat(mCPUOutputFormat);
+    } else {
+        // 设置像素格式（根据配置）
+        switch (mConfig.format) {
+            case InputFormat::YUV420:
+            case InputFormat::NV12:
+            case InputFormat::NV21:
+                packet->setFormat(PixelFormat::YUV420);
+                break;
+            default:
+                packet->setFormat(PixelFormat::RGBA8);
+                break;
+        }
     }
     
-    // 设置 CPU 数据
-    // 注意：mCPUOutputBuffer 是 InputEntity 的成员，其生命周期由 InputEntity 管理
-    // takeOwnership = false 表示不接管所有权，FramePacket 会复制数据到自己的缓冲区
-    if (!mCPUOutputBuffer.empty()) {
-        packet->setCpuBuffer(mCPUOutputBuffer.data(), mCPUOutputBuffer.size(), false);
+    // 设置 CPU 数据：共享本帧输出缓冲，不复制（缓冲在下游释放前不会被复用）
+    if (mCPUOutputBuffer) {
+        packet->setCpuBuffer(mCPUOutputBuffer, mCPUOutputSize);
     }
     
     return packet;
 }
 
+FramePacketPtr InputEntity::createElidedPacket(PipelineContext& context, int64_t timestamp) {
+    auto packet = context.acquireFramePacket();
+    packet->setTimestamp(timestamp);
+    packet->setSize(mConfig.width, mConfig.height);
+    packet->setFormat(PixelFormat::RGBA8);
+    packet->setPayloadElided(true);
+    return packet;
+}
+
+// =============================================================================
+// 按规格输出
+// =============================================================================
+
+bool InputEntity::produceScaledCPUOutput(const CPUInputData& input, const CPUOutputSpec& spec) {
+    if ((!input.data && !input.planeY) || input.width == 0 || input.height == 0) {
+        return false;
+    }
+    
+    uint32_t width = input.width;
+    uint32_t height = input.height;
+    uint32_t dstWidth = 0;
+    uint32_t dstHeight = 0;
+    resolveCPUOutputSize(spec, width, height, dstWidth, dstHeight);
+    size_t dstPixels = static_cast<size_t>(dstWidth) * dstHeight;
+    
+    // 缩小到一半以下时用盒式平均，避免检测输入出现混叠
+    simd::ScaleFilter filter = (width >= dstWidth * 2 || height >= dstHeight * 2)
+        ? simd::ScaleFilter::Box : simd::ScaleFilter::Bilinear;
+    
+    bool ok = true;
+    if (spec.format == CPUOutputFormat::Gray && isYUVFormat(input.format)) {
+        // 亮度直接取自 Y 平面：只读 Y、只写目标尺寸
+        uint32_t strideY = input.strideY ? input.strideY : width;
+        ok = simd::scale(input.planeY, strideY, width, height,
+                         acquireCPUOutputBuffer(dstPixels), dstWidth, dstWidth, dstHeight,
+                         1, filter);
+        mCPUOutputFormat = PixelFormat::R8;
+    } else if (isYUVFormat(input.format)) {
+        // 先在 YUV 域缩小（每像素 1.5 字节），再对小图做一次颜色转换
+        uint32_t chromaWidth = (width + 1) / 2;
+        uint32_t chromaHeight = (height + 1) / 2;
+        uint32_t dstChromaWidth = (dstWidth + 1) / 2;
+        uint32_t dstChromaHeight = (dstHeight + 1) / 2;
+        size_t chromaPixels = static_cast<size_t>(dstChromaWidth) * dstChromaHeight;
+        
+        uint8_t* scratch = acquireScratchBuffer(dstPixels + chromaPixels * 2);
+        CPUInputData scaled;
+        scaled.width = dstWidth;
+        scaled.height = dstHeight;
+        scaled.format = input.format;
+        scaled.data = scratch;
+        scaled.planeY = scratch;
+        scaled.strideY = dstWidth;
+        scaled.planeU = scratch + dstPixels;
+        
+        ok = simd::scale(input.planeY, input.strideY ? input.strideY : width, width, height,
+                         scratch, dstWidth, dstWidth, dstHeight, 1, filter);
+        if (input.format == InputFormat::YUV420) {
+            scaled.strideU = dstChromaWidth;
+            scaled.planeV = scaled.planeU + chromaPixels;
+            scaled.strideV = dstChromaWidth;
+            ok = ok && simd::scale(input.planeU, input.strideU ? input.strideU : chromaWidth,
+                                   chromaWidth, chromaHeight,
+                                   const_cast<uint8_t*>(scaled.planeU), scaled.strideU,
+                                   dstChromaWidth, dstChromaHeight, 1, filter);
+            ok = ok && simd::scale(input.planeV, input.strideV ? input.strideV : chromaWidth,
+                                   chromaWidth, chromaHeight,
+                                   const_cast<uint8_t*>(scaled.planeV), scaled.strideV,
+                                   dstChromaWidth, dstChromaHeight, 1, filter);
+        } else {
+            // UV/VU 交织平面按双通道缩放，通道顺序保持不变
+            scaled.strideU = dstChromaWidth * 2;
+            ok = ok && simd::scale(input.planeU, input.strideU ? input.strideU : chromaWidth * 2,
+                                   chromaWidth, chromaHeight,
+                                   const_cast<uint8_t*>(scaled.planeU), scaled.strideU,
+                                   dstChromaWidth, dstChromaHeight, 2, filter);
+        }
+        ok = ok && convertToRGBA(scaled, acquireCPUOutputBuffer(dstPixels * 4));
+        mCPUOutputFormat = PixelFormat::RGBA8;
+    } else {
+        // 像素格式输入：RGB 需先补齐为四通道，RGBA/BGRA 直接在源数据上缩放
+        const uint8_t* rgba = input.data;
+        uint32_t rgbaStride = input.stride ? input.stride : width * 4;
+        if (input.format == InputFormat::RGB) {
+            uint8_t* expanded = acquireScratchBuffer(static_cast<size_t>(width) * height * 4 + dstPixels * 4);
+            ok = convertToRGBA(input, expanded);
+            rgba = expanded;
+            rgbaStride = width * 4;
+        } else if (input.format != InputFormat::RGBA && input.format != InputFormat::BGRA) {
+            return false;
+        }
+        
+        bool gray = spec.format == CPUOutputFormat::Gray;
+        uint8_t* scaled = nullptr;
+        if (!gray) {
+            scaled = acquireCPUOutputBuffer(dstPixels * 4);
+        } else if (input.format == InputFormat::RGB) {
+            scaled = mScratchBuffer.get() + static_cast<size_t>(width) * height * 4;
+        } else {
+            scaled = acquireScratchBuffer(dstPixels * 4);
+        }
+        ok = ok && simd::scale(rgba, rgbaStride, width, height,
+                               scaled, dstWidth * 4, dstWidth, dstHeight, 4, filter);
+        if (ok && input.format == InputFormat::BGRA) {
+            libyuv::ARGBToABGR(scaled, dstWidth * 4, scaled, dstWidth * 4, dstWidth, dstHeight);
+        }
+        if (gray) {
+            simd::rgbaToGray(scaled, dstWidth * 4,
+                             acquireCPUOutputBuffer(dstPixels), dstWidth,
+                             dstWidth, dstHeight);
+            mCPUOutputFormat = PixelFormat::R8;
+        } else {
+            mCPUOutputFormat = PixelFormat::RGBA8;
+        }
+    }
+    
+    if (!ok) {
+        PIPELINE_LOGE("Failed to produce CPU output %ux%u from %ux%u input",
+                      dstWidth, dstHeight, width, height);
+        mCPUOutputBuffer.reset();
+        mCPUOutputSize = 0;
+        mCPUOutputFormat = PixelFormat::Unknown;
+        return false;
+    }
+    mCPUOutputWidth = dstWidth;
+    mCPUOutputHeight = dstHeight;
+    return true;
+}
+
 // =============================================================================
 // 格式转换
 // =============================================================================
@@ -592,8 +1140,8 @@ void InputEntity::startProcessingLoop() {
     // 先设置运行状态，再投递任务
     mTaskRunning.store(true);
     
-    // 将process任务投递到TaskQueue (通过PipelineExecutor)
-    if (mExecutor) {
+    // 从属输入由主时钟开启的帧顺带执行，不单独开启新帧
+    if (mExecutor && getClockRole() == InputClockRole::Master) {
         mExecutor->submitEntityTask(this->getId());
     }
     PIPELINE_LOGI("InputEntity processing loop started");
@@ -0,0 +1,253 @@
+/**
+ * @file RawBufferInputStrategy.cpp
+ * @brief RawBufferInputStrategy实现
+ */
+
+#include "pipeline/input/RawBufferInputStrategy.h"
+#include "pipeline/simd/PixelKernels.h"
+#include "pipeline/utils/PipelineLog.h"
+#include "lrengine/core/LRRenderContext.h"
+#include "lrengine/core/LRPlanarTexture.h"
+
+#include <algorithm>
+
+#include "libyuv.h"
+
+namespace pipeline {
+namespace input {
+
+namespace {
+
+bool isYUVFormat(InputFormat format) {
+    return format == InputFormat::YUV420 || format == InputFormat::NV12 || format == InputFormat::NV21;
+}
+
+lrengine::render::PlanarFormat toPlanarFormat(InputFormat format) {
+    switch (format) {
+        case InputFormat::YUV420: return lrengine::render::PlanarFormat::YUV420P;
+        case InputFormat::NV12:   return lrengine::render::PlanarFormat::NV12;
+        case InputFormat::NV21:   return lrengine::render::PlanarFormat::NV21;
+        default:                  return lrengine::render::PlanarFormat::RGBA;
+    }
+}
+
+} // anonymous namespace
+
+RawBufferInputStrategy::RawBufferInputStrategy() = default;
+
+RawBufferInputStrategy::~RawBufferInputStrategy() {
+    release();
+}
+
+bool RawBufferInputStrategy::initialize(lrengine::render::LRRenderContext* context) {
+    mRenderContext = context;
+    mInitialized = true;
+    return true;
+}
+
+void RawBufferInputStrategy::release() {
+    mTextures.clear();
+    mScratch.clear();
+    mScratch.shrink_to_fit();
+    mUploadScratch.clear();
+    mUploadScratch.shrink_to_fit();
+    mRenderContext = nullptr;
+    mInitialized = false;
+}
+
+// =============================================================================
+// GPU 路径
+// =============================================================================
+
+std::shared_ptr<lrengine::render::LRPlanarTexture> RawBufferInputStrategy::acquireTexture(
+    uint32_t width, uint32_t height, InputFormat format) {
+
+    // 只被本策略持有的纹理没有在途帧包在读，可以直接覆盖
+    for (auto& entry : mTextures) {
+        if (entry.texture && entry.texture.use_count() == 1 &&
+            entry.width == width && entry.height == height && entry.format == format) {
+            return entry.texture;
+        }
+    }
+
+    // 规格变化后旧纹理不再使用，空闲时先回收
+    mTextures.erase(std::remove_if(mTextures.begin(), mTextures.end(),
+                                   [&](const UploadTexture& entry) {
+                                       return entry.texture.use_count() == 1 &&
+                                              (entry.width != width || entry.height != height ||
+                                               entry.format != format);
+                                   }),
+                    mTextures.end());
+    if (mTextures.size() >= kMaxTextures) {
+        PIPELINE_LOGW("RawBufferInputStrategy: all %zu upload textures are in flight", mTextures.size());
+        return nullptr;
+    }
+
+    lrengine::render::PlanarTextureDescriptor desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = toPlanarFormat(format);
+    desc.debugName = "RawBufferInput";
+
+    auto* rawTexture = mRenderContext->CreatePlanarTexture(desc);
+    if (!rawTexture) {
+        PIPELINE_LOGE("RawBufferInputStrategy: failed to create %ux%u upload texture", width, height);
+        return nullptr;
+    }
+
+    UploadTexture entry;
+    entry.texture = std::shared_ptr<lrengine::render::LRPlanarTexture>(rawTexture);
+    entry.width = width;
+    entry.height = height;
+    entry.format = format;
+    mTextures.push_back(entry);
+    return entry.texture;
+}
+
+bool RawBufferInputStrategy::processToGPUPlanar(const InputData& input,
+                                                std::shared_ptr<lrengine::render::LRPlanarTexture>& outputTexture) {
+    if (!mInitialized || !mRenderContext) {
+        PIPELINE_LOGE("RawBufferInputStrategy not initialized");
+        return false;
+    }
+
+    const CPUInputData& cpu = input.cpu;
+    if (cpu.width == 0 || cpu.height == 0 || (!cpu.data && !cpu.planeY)) {
+        return false;
+    }
+
+    // YUV 按平面原样上传；RGB/BGRA 没有对应的平面格式，先转为 RGBA
+    const InputFormat uploadFormat = isYUVFormat(cpu.format) ? cpu.format : InputFormat::RGBA;
+    auto texture = acquireTexture(cpu.width, cpu.height, uploadFormat);
+    if (!texture) {
+        return false;
+    }
+
+    const uint8_t* rgba = cpu.data;
+    uint32_t rgbaStride = cpu.stride != 0 ? cpu.stride : cpu.width * 4;
+    if (!isYUVFormat(cpu.format) && cpu.format != InputFormat::RGBA) {
+        // 同尺寸转换不经过 mScratch，CPU 路径在处理线程并发执行也互不干扰
+        mUploadScratch.resize(static_cast<size_t>(cpu.width) * cpu.height * 4);
+        if (!convertToRGBA(cpu, mUploadScratch.data(), cpu.width, cpu.height)) {
+            return false;
+        }
+        rgba = mUploadScratch.data();
+        rgbaStride = cpu.width * 4;
+    }
+
+    // TODO: 使用LREngine按平面上传
+    // if (uploadFormat == InputFormat::RGBA) {
+    //     texture->UpdatePlane(0, rgba, rgbaStride);
+    // } else {
+    //     texture->UpdatePlane(0, cpu.planeY, cpu.strideY);
+    //     texture->UpdatePlane(1, cpu.planeU, cpu.strideU);
+    //     if (cpu.format == InputFormat::YUV420) {
+    //         texture->UpdatePlane(2, cpu.planeV, cpu.strideV);
+    //     }
+    // }
+    (void)rgba;
+    (void)rgbaStride;
+
+    outputTexture = std::move(texture);
+    return true;
+}
+
+// =============================================================================
+// CPU 路径
+// =============================================================================
+
+bool RawBufferInputStrategy::convertToRGBA(const CPUInputData& input, uint8_t* output,
+                                           uint32_t width, uint32_t height) {
+    const uint32_t srcStride = input.stride != 0 ? input.stride : input.width * 4;
+    const uint32_t dstStride = width * 4;
+    const bool sameSize = width == input.width && height == input.height;
+
+    // 需要缩放时先在中间缓冲得到全尺寸 RGBA（RGBA 输入直接缩放，不经中间缓冲）
+    uint8_t* fullSize = output;
+    uint32_t fullStride = dstStride;
+    if (!sameSize && input.format != InputFormat::RGBA) {
+        mScratch.resize(static_cast<size_t>(input.width) * input.height * 4);
+        fullSize = mScratch.data();
+        fullStride = input.width * 4;
+    }
+
+    const int w = static_cast<int>(input.width);
+    const int h = static_cast<int>(input.height);
+    bool converted = true;
+    switch (input.format) {
+        case InputFormat::RGBA:
+            if (!sameSize) {
+                return simd::scale(input.data, srcStride, input.width, input.height,
+                                   output, dstStride, width, height, 4,
+                                   width * 2 < input.width ? simd::ScaleFilter::Box
+                                                           : simd::ScaleFilter::Bilinear);
+            }
+            libyuv::ARGBCopy(input.data, static_cast<int>(srcStride),
+                             output, static_cast<int>(dstStride), w, h);
+            return true;
+        case InputFormat::BGRA:
+            libyuv::ARGBToABGR(input.data, static_cast<int>(srcStride),
+                               fullSize, static_cast<int>(fullStride), w, h);
+            break;
+        case InputFormat::RGB:
+            // libyuv 的 ARGB 在内存中为 BGRA，再原地交换 R/B 得到 RGBA
+            libyuv::RAWToARGB(input.data, static_cast<int>(input.stride != 0 ? input.stride : input.width * 3),
+                              fullSize, static_cast<int>(fullStride), w, h);
+            libyuv::ARGBToABGR(fullSize, static_cast<int>(fullStride),
+                               fullSize, static_cast<int>(fullStride), w, h);
+            break;
+        case InputFormat::NV12:
+            converted = simd::nv12ToRgba(input.planeY, input.strideY, input.planeU, input.strideU,
+                                         fullSize, fullStride, input.width, input.height);
+            break;
+        case InputFormat::NV21:
+            libyuv::NV21ToABGR(input.planeY, static_cast<int>(input.strideY),
+                               input.planeU, static_cast<int>(input.strideU),
+                               fullSize, static_cast<int>(fullStride), w, h);
+            break;
+        case InputFormat::YUV420:
+            converted = simd::i420ToRgba(input.planeY, input.strideY, input.planeU, input.strideU,
+                                         input.planeV, input.strideV,
+                                         fullSize, fullStride, input.width, input.height);
+            break;
+        default:
+            PIPELINE_LOGE("RawBufferInputStrategy: unsupported input format %d",
+                          static_cast<int>(input.format));
+            return false;
+    }
+
+    if (!converted || sameSize) {
+        return converted;
+    }
+    return simd::scale(fullSize, fullStride, input.width, input.height,
+                       output, dstStride, width, height, 4,
+                       width * 2 < input.width ? simd::ScaleFilter::Box : simd::ScaleFilter::Bilinear);
+}
+
+bool RawBufferInputStrategy::processToCPU(const InputData& input,
+                                          uint8_t* outputBuffer,
+                                          size_t& outputSize,
+                                          uint32_t targetWidth,
+                                          uint32_t targetHeight) {
+    const CPUInputData& cpu = input.cpu;
+    if (cpu.width == 0 || cpu.height == 0 || (!cpu.data && !cpu.planeY)) {
+        return false;
+    }
+
+    const uint32_t width = targetWidth > 0 ? targetWidth : cpu.width;
+    const uint32_t height = targetHeight > 0 ? targetHeight : cpu.height;
+    const size_t required = static_cast<size_t>(width) * height * 4;
+    if (!outputBuffer || outputSize < required) {
+        outputSize = required;
+        return false;
+    }
+
+    if (!convertToRGBA(cpu, outputBuffer, width, height)) {
+        return false;
+    }
+    outputSize = required;
+    return true;
+}
+
+} // namespace input
+} // namespace pipeline
@@ -0,0 +1,190 @@
+/**
+ * @file RawVideoFileReader.cpp
+ * @brief RawVideoFileReader 实现
+ */
+
+#include "pipeline/input/RawVideoFileReader.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <fstream>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pipeline {
+namespace input {
+
+/**
+ * @brief 文件映射（由读取器与在途帧共同持有，最后一个引用释放时 munmap）
+ */
+struct RawVideoFileReader::Mapping {
+    ~Mapping() {
+#if !defined(_WIN32)
+        if (mapped) {
+            munmap(mapped, size);
+        }
+#endif
+    }
+
+    bool open(const std::string& path) {
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        // 逐帧顺序读取，预读能明显减少缺页等待
+        madvise(ptr, size, MADV_SEQUENTIAL);
+        mapped = ptr;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(buffer.data()),
+                                           static_cast<std::streamsize>(buffer.size())));
+#endif
+    }
+
+    const uint8_t* data() const {
+        return mapped ? static_cast<const uint8_t*>(mapped) : buffer.data();
+    }
+    size_t bytes() const { return mapped ? size : buffer.size(); }
+
+    void* mapped = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> buffer;
+};
+
+RawVideoFileReader::~RawVideoFileReader() {
+    close();
+}
+
+size_t RawVideoFileReader::frameSizeFor(InputFormat format, uint32_t width, uint32_t height) {
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const size_t chroma = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    switch (format) {
+        case InputFormat::RGBA:
+        case InputFormat::BGRA:   return pixels * 4;
+        case InputFormat::RGB:    return pixels * 3;
+        case InputFormat::YUV420:
+        case InputFormat::NV12:
+        case InputFormat::NV21:   return pixels + chroma * 2;
+        default:                  return 0;
+    }
+}
+
+bool RawVideoFileReader::open(const std::string& path, InputFormat format,
+                              uint32_t width, uint32_t height, float fps) {
+    close();
+
+    const size_t frameSize = frameSizeFor(format, width, height);
+    if (frameSize == 0 || width == 0 || height == 0) {
+        PIPELINE_LOGE("RawVideoFileReader: unsupported format %d or size %ux%u",
+                      static_cast<int>(format), width, height);
+        return false;
+    }
+
+    auto mapping = std::make_shared<Mapping>();
+    if (!mapping->open(path)) {
+        PIPELINE_LOGE("RawVideoFileReader: failed to map %s", path.c_str());
+        return false;
+    }
+    if (mapping->bytes() < frameSize) {
+        PIPELINE_LOGE("RawVideoFileReader: %s is smaller than one %ux%u frame", path.c_str(), width, height);
+        return false;
+    }
+
+    mMapping = std::move(mapping);
+    mFormat = format;
+    mWidth = width;
+    mHeight = height;
+    mFps = fps > 0.0f ? fps : 30.0f;
+    mFrameSize = frameSize;
+    mFrameCount = mMapping->bytes() / frameSize;
+
+    PIPELINE_LOGI("RawVideoFileReader: opened %s (%llu frames of %ux%u)",
+                  path.c_str(), static_cast<unsigned long long>(mFrameCount), width, height);
+    return true;
+}
+
+void RawVideoFileReader::close() {
+    // 映射由在途帧共同持有，这里只放弃读取器自身的引用
+    mMapping.reset();
+    mFrameSize = 0;
+    mFrameCount = 0;
+}
+
+bool RawVideoFileReader::readFrame(uint64_t index, InputData& frame) const {
+    if (!mMapping || index >= mFrameCount) {
+        return false;
+    }
+
+    const uint8_t* base = mMapping->data() + index * mFrameSize;
+    const uint32_t chromaWidth = (mWidth + 1) / 2;
+    const size_t lumaSize = static_cast<size_t>(mWidth) * mHeight;
+    const size_t chromaSize = static_cast<size_t>(chromaWidth) * ((mHeight + 1) / 2);
+
+    CPUInputData cpu;
+    cpu.data = base;
+    cpu.dataSize = mFrameSize;
+    cpu.width = mWidth;
+    cpu.height = mHeight;
+    cpu.format = mFormat;
+    cpu.timestamp = static_cast<int64_t>(static_cast<double>(index) * 1000000.0 / mFps);
+
+    switch (mFormat) {
+        case InputFormat::RGBA:
+        case InputFormat::BGRA:
+            cpu.stride = mWidth * 4;
+            break;
+        case InputFormat::RGB:
+            cpu.stride = mWidth * 3;
+            break;
+        case InputFormat::YUV420:
+            cpu.planeY = base;
+            cpu.planeU = base + lumaSize;
+            cpu.planeV = base + lumaSize + chromaSize;
+            cpu.strideY = mWidth;
+            cpu.strideU = chromaWidth;
+            cpu.strideV = chromaWidth;
+            break;
+        case InputFormat::NV12:
+        case InputFormat::NV21:
+            cpu.planeY = base;
+            cpu.planeU = base + lumaSize;
+            cpu.strideY = mWidth;
+            cpu.strideU = chromaWidth * 2;
+            break;
+        default:
+            return false;
+    }
+
+    frame = InputData();
+    frame.cpu = cpu;
+    frame.dataType = InputDataType::CPUBuffer;
+    frame.platformBufferHolder = mMapping;
+    return true;
+}
+
+} // namespace input
+} // namespace pipeline
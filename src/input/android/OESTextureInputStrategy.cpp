@@ -8,6 +8,9 @@
 #include "pipeline/input/android/OESTextureInputStrategy.h"
 #include "pipeline/utils/PipelineLog.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace pipeline {
 namespace input {
 namespace android {
@@ -109,6 +112,44 @@ bool OESTextureInputStrategy::processToGPU(const InputData& input,
     return true;
 }
 
+bool OESTextureInputStrategy::processToGPUExternal(const InputData& input,
+                                                    ExternalImagePtr& outputImage) {
+    if (!mInitialized) {
+        return false;
+    }
+    
+    // AHardwareBuffer（ImageReader 等）：EGLImage 导入
+    if (input.platformBuffer) {
+        if (!mEGLManager) {
+            return false;
+        }
+        outputImage = mEGLManager->importHardwareBuffer(
+            static_cast<AHardwareBuffer*>(input.platformBuffer));
+        return outputImage != nullptr;
+    }
+    
+    // SurfaceTexture：直接交出 OES 纹理与变换矩阵，省去 convertOESToTexture2D 的整帧绘制
+    const auto& gpu = input.gpu;
+    if (!gpu.isOESTexture || gpu.textureId == 0) {
+        return false;
+    }
+    
+    auto image = std::make_shared<ExternalImage>();
+    image->format = ExternalImageFormat::External;
+    image->width = gpu.width;
+    image->height = gpu.height;
+    image->glTarget = GL_TEXTURE_EXTERNAL_OES;
+    image->planeCount = 1;
+    image->planes[0].handle = reinterpret_cast<void*>(static_cast<uintptr_t>(gpu.textureId));
+    image->planes[0].width = gpu.width;
+    image->planes[0].height = gpu.height;
+    std::copy(std::begin(gpu.transformMatrix), std::end(gpu.transformMatrix), image->transform);
+    image->holder = input.platformBufferHolder;
+    
+    outputImage = std::move(image);
+    return true;
+}
+
 bool OESTextureInputStrategy::processToCPU(const InputData& input,
                                             uint8_t* outputBuffer,
                                             size_t& outputSize,
@@ -114,6 +114,24 @@ bool PixelBufferInputStrategy::processToGPUPlanar(const InputData& input,
     return outputTexture != nullptr;
 }
 
+bool PixelBufferInputStrategy::processToGPUExternal(const InputData& input,
+                                                     ExternalImagePtr& outputImage) {
+    if (!mInitialized || !mMetalManager || !mUseTextureCache) {
+        return false;
+    }
+    
+    CVPixelBufferRef pixelBuffer = input.platformBuffer
+        ? static_cast<CVPixelBufferRef>(input.platformBuffer)
+        : mCurrentPixelBuffer;
+    if (!pixelBuffer) {
+        return false;
+    }
+    
+    // 格式不支持时回退到 processToGPUPlanar
+    outputImage = mMetalManager->importPixelBuffer(pixelBuffer);
+    return outputImage != nullptr;
+}
+
 bool PixelBufferInputStrategy::processToCPU(const InputData& input,
                                              uint8_t* outputBuffer,
                                              size_t& outputSize,
@@ -0,0 +1,187 @@
+/**
+ * @file FramePacer.cpp
+ * @brief FramePacer实现
+ */
+
+#include "pipeline/output/FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace pipeline {
+namespace output {
+
+namespace {
+
+constexpr int64_t kMinPeriodNs = 4000000;       // 250Hz
+constexpr int64_t kMaxPeriodNs = 50000000;      // 20Hz
+constexpr int64_t kContentJumpUs = 1000000;     // 内容时间跳变超过 1 秒视为 seek/暂停
+
+} // anonymous namespace
+
+#if !defined(__ANDROID__) && !defined(__APPLE__)
+std::unique_ptr<VsyncSource> createPlatformVsyncSource() {
+    return nullptr;
+}
+#endif
+
+FramePacer::FramePacer() = default;
+
+FramePacer::~FramePacer() {
+    // 先停来源，回调不会在析构过程中进入
+    std::unique_ptr<VsyncSource> source;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        source = std::move(mSource);
+    }
+    if (source) {
+        source->stop();
+    }
+}
+
+void FramePacer::attachVsyncSource(std::unique_ptr<VsyncSource> source) {
+    std::unique_ptr<VsyncSource> previous;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        previous = std::move(mSource);
+    }
+    if (previous) {
+        previous->stop();
+    }
+    if (!source) {
+        return;
+    }
+    // 回调在平台线程触发，不能持有 mMutex 调用 start
+    if (source->start([this](int64_t vsyncTimeNs, int64_t periodNs) {
+            onVsync(vsyncTimeNs, periodNs);
+        })) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mSource = std::move(source);
+    }
+}
+
+bool FramePacer::hasVsyncSource() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSource != nullptr;
+}
+
+void FramePacer::setVsyncListener(VsyncListener listener) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mListener = listener ? std::make_shared<VsyncListener>(std::move(listener)) : nullptr;
+}
+
+void FramePacer::onVsync(int64_t vsyncTimeNs, int64_t periodNs) {
+    std::shared_ptr<VsyncListener> listener;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        recordVsyncLocked(vsyncTimeNs, periodNs);
+        listener = mListener;
+    }
+    if (listener) {
+        (*listener)(vsyncTimeNs);
+    }
+}
+
+void FramePacer::recordVsyncLocked(int64_t vsyncTimeNs, int64_t periodNs) {
+    if (periodNs >= kMinPeriodNs && periodNs <= kMaxPeriodNs) {
+        mPeriodNs = periodNs;
+        mPeriodFromPlatform = true;
+    } else if (!mPeriodFromPlatform && mLastVsyncNs > 0) {
+        const int64_t delta = vsyncTimeNs - mLastVsyncNs;
+        if (delta >= kMinPeriodNs && delta <= kMaxPeriodNs) {
+            if (delta < mPeriodNs * 3 / 4) {
+                mPeriodNs = delta;                          // 刷新率提高（如 60 -> 120Hz）
+            } else if (delta < mPeriodNs * 3 / 2) {
+                mPeriodNs = (mPeriodNs * 7 + delta) / 8;    // 跳过的 VSync 不参与估算
+            }
+        }
+    }
+    mLastVsyncNs = vsyncTimeNs;
+    mStats.vsyncPeriodNs = mPeriodNs;
+}
+
+int64_t FramePacer::nextVsyncAtOrAfter(int64_t earliestNs) const {
+    const double steps = std::ceil(static_cast<double>(earliestNs - mLastVsyncNs) /
+                                   static_cast<double>(mPeriodNs));
+    return mLastVsyncNs + static_cast<int64_t>(steps) * mPeriodNs;
+}
+
+int64_t FramePacer::schedule(int64_t contentTimestampUs, int64_t nowNs) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const int64_t period = mPeriodNs;
+
+    // 至少留 1/4 周期给GPU完成本帧；同一 VSync 只上屏一帧
+    int64_t minTarget = nextVsyncAtOrAfter(nowNs + period / 4);
+    if (mLastTargetNs > 0) {
+        minTarget = std::max(minTarget, mLastTargetNs + period);
+    }
+
+    int64_t target = minTarget;
+    if (contentTimestampUs > 0) {
+        const bool jumped = contentTimestampUs <= mLastContentUs ||
+                            contentTimestampUs - mLastContentUs > kContentJumpUs;
+        if (!mAnchored || jumped) {
+            if (mAnchored) {
+                ++mStats.reanchors;
+            }
+            mAnchored = true;
+            mAnchorContentUs = contentTimestampUs;
+            mAnchorPresentNs = minTarget;
+        }
+
+        const int64_t ideal = mAnchorPresentNs + (contentTimestampUs - mAnchorContentUs) * 1000;
+        const double steps = std::round(static_cast<double>(ideal - mLastVsyncNs) /
+                                        static_cast<double>(period));
+        target = mLastVsyncNs + static_cast<int64_t>(steps) * period;
+
+        if (target < minTarget) {
+            ++mStats.late;
+            // 持续落后（渲染慢于内容）时重新对齐，否则延迟会越积越大
+            if (minTarget - ideal > 2 * period) {
+                ++mStats.reanchors;
+                mAnchorContentUs = contentTimestampUs;
+                mAnchorPresentNs = minTarget;
+            }
+            target = minTarget;
+        } else if (target > minTarget + 3 * period) {
+            // 生产快于内容时钟：不把帧压在合成器里，回到最小延迟
+            ++mStats.reanchors;
+            mAnchorContentUs = contentTimestampUs;
+            mAnchorPresentNs = minTarget;
+            target = minTarget;
+        }
+        mLastContentUs = contentTimestampUs;
+    }
+
+    mLastTargetNs = target;
+    ++mStats.scheduled;
+    return target;
+}
+
+void FramePacer::reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mAnchored = false;
+    mLastContentUs = 0;
+    mLastTargetNs = 0;
+}
+
+int64_t FramePacer::getVsyncPeriodNs() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPeriodNs;
+}
+
+FramePacingStats FramePacer::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    FramePacingStats stats = mStats;
+    stats.vsyncPeriodNs = mPeriodNs;
+    return stats;
+}
+
+int64_t FramePacer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace output
+} // namespace pipeline
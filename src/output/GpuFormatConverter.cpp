@@ -0,0 +1,268 @@
+/**
+ * @file GpuFormatConverter.cpp
+ * @brief GpuFormatConverter实现
+ */
+
+#include "pipeline/output/GpuFormatConverter.h"
+#include "pipeline/core/PipelineConfig.h"
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/pool/GpuResourceRegistry.h"
+#include "pipeline/pool/ShaderProgramCache.h"
+#include "pipeline/pool/TexturePool.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include "lrengine/core/LRRenderContext.h"
+#include "lrengine/core/LRTexture.h"
+#include "lrengine/core/LRFrameBuffer.h"
+#include "lrengine/core/LRPipelineState.h"
+
+namespace pipeline {
+namespace output {
+
+namespace {
+
+// 在途读回上限：消费者长时间不取时新帧直接跳过转换
+constexpr size_t kMaxInFlight = 4;
+
+const char* kConvertVertexShader = R"(
+#version 300 es
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexCoord;
+
+void main() {
+    gl_Position = vec4(aPosition, 0.0, 1.0);
+}
+)";
+
+// 每个输出 texel 对应目标缓冲中连续的 4 个字节，按字节偏移决定落在哪个平面；
+// 行号与源纹理 v 坐标同向，与 RGBA 读回的行序一致
+const char* kConvertFragmentShader = R"(
+#version 300 es
+precision highp float;
+precision highp int;
+
+out vec4 fragColor;
+
+uniform sampler2D uTexture;
+uniform ivec2 uSize;        // 目标宽高
+uniform int uLayout;        // 0 = I420, 1 = NV12, 2 = NV21
+
+const vec4 kY = vec4( 0.2568,  0.5041,  0.0979,  16.0 / 255.0);
+const vec4 kU = vec4(-0.1482, -0.2910,  0.4392, 128.0 / 255.0);
+const vec4 kV = vec4( 0.4392, -0.3678, -0.0714, 128.0 / 255.0);
+
+vec3 sampleRGB(int index, int planeWidth, vec2 planeSize) {
+    vec2 pixel = vec2(float(index % planeWidth), float(index / planeWidth));
+    return texture(uTexture, (pixel + 0.5) / planeSize).rgb;
+}
+
+float byteAt(int offset) {
+    int lumaSize = uSize.x * uSize.y;
+    if (offset < lumaSize) {
+        return dot(sampleRGB(offset, uSize.x, vec2(uSize)), kY.xyz) + kY.w;
+    }
+    // 色度半分辨率：采样点在 2x2 亮度块中心，双线性即为四点平均
+    int chromaWidth = uSize.x / 2;
+    vec2 chromaSize = vec2(uSize / 2);
+    offset -= lumaSize;
+    if (uLayout == 0) {
+        int planeSize = lumaSize / 4;
+        bool isU = offset < planeSize;
+        vec3 rgb = sampleRGB(isU ? offset : offset - planeSize, chromaWidth, chromaSize);
+        vec4 coeff = isU ? kU : kV;
+        return dot(rgb, coeff.xyz) + coeff.w;
+    }
+    vec3 rgb = sampleRGB(offset / 2, chromaWidth, chromaSize);
+    bool isU = (offset % 2 == 0) == (uLayout == 1);
+    vec4 coeff = isU ? kU : kV;
+    return dot(rgb, coeff.xyz) + coeff.w;
+}
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    int base = texel.y * uSize.x + texel.x * 4;
+    fragColor = vec4(byteAt(base), byteAt(base + 1), byteAt(base + 2), byteAt(base + 3));
+}
+)";
+
+int toLayout(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::NV12: return 1;
+        case OutputFormat::NV21: return 2;
+        default:                 return 0;
+    }
+}
+
+} // anonymous namespace
+
+GpuFormatConverter::GpuFormatConverter(OutputFormat format, uint32_t width, uint32_t height)
+    : mFormat(format)
+    , mRequestWidth(width)
+    , mRequestHeight(height) {
+}
+
+GpuFormatConverter::~GpuFormatConverter() {
+    release();
+}
+
+bool GpuFormatConverter::isSupported(OutputFormat format) {
+    return format == OutputFormat::YUV420 || format == OutputFormat::NV12 ||
+           format == OutputFormat::NV21;
+}
+
+size_t GpuFormatConverter::getConvertedSize(OutputFormat format, uint32_t width, uint32_t height) {
+    if (!isSupported(format)) {
+        return 0;
+    }
+    return static_cast<size_t>(width) * height * 3 / 2;
+}
+
+void GpuFormatConverter::resolveSize(uint32_t requestWidth, uint32_t requestHeight,
+                                     uint32_t sourceWidth, uint32_t sourceHeight,
+                                     uint32_t& width, uint32_t& height) {
+    width = requestWidth > 0 ? requestWidth : sourceWidth;
+    height = requestHeight > 0 ? requestHeight : sourceHeight;
+    // 每个 texel 打包 4 个亮度字节，色度平面需按整行排布
+    width &= ~3u;
+    height &= ~3u;
+}
+
+std::shared_ptr<ReadbackRequest> GpuFormatConverter::convert(
+    lrengine::render::LRTexture& source, uint32_t sourceWidth, uint32_t sourceHeight,
+    PipelineContext& context, uint32_t& outWidth, uint32_t& outHeight) {
+
+    resolveSize(mRequestWidth, mRequestHeight, sourceWidth, sourceHeight, outWidth, outHeight);
+    if (outWidth == 0 || outHeight == 0) {
+        return nullptr;
+    }
+
+    auto readback = context.getReadbackService();
+    auto pool = context.getTexturePool();
+    if (!readback || !pool || !ensureResources(context)) {
+        return nullptr;
+    }
+
+    recyclePackedTextures();
+    if (mInFlight.size() >= kMaxInFlight) {
+        PIPELINE_LOGD("Format conversion backlog full, frame skipped");
+        return nullptr;
+    }
+
+    const uint32_t packedWidth = outWidth / 4;
+    const uint32_t packedHeight = outHeight * 3 / 2;
+    auto packed = pool->acquireAutoRelease(packedWidth, packedHeight, PixelFormat::RGBA8);
+    if (!packed) {
+        return nullptr;
+    }
+
+    // 绘制打包纹理（源按目标尺寸双线性缩放）
+    const int layout = toLayout(mFormat);
+    /*
+    mFrameBuffer->AttachColorTexture(packed.get(), 0);
+    mRenderContext->BeginRenderPass(mFrameBuffer.get());
+    mRenderContext->SetViewport(0, 0, packedWidth, packedHeight);
+    mRenderContext->SetPipelineState(mPipelineState.get());
+
+    source.Bind(0);
+    mSampler->Bind(0);
+    mProgram->SetUniform("uTexture", 0);
+    mProgram->SetUniform("uSize", static_cast<int>(outWidth), static_cast<int>(outHeight));
+    mProgram->SetUniform("uLayout", layout);
+
+    mRenderContext->SetVertexBuffer(mQuad.get());
+    mRenderContext->Draw(lrengine::render::PrimitiveType::TriangleStrip, 0, 4);
+    mRenderContext->EndRenderPass();
+    */
+    (void)source;
+    (void)layout;
+
+    // 有传输队列时打包纹理的拷贝排在传输上下文上，等待本次绘制的栅栏
+    GpuFencePtr fence = context.hasTransferQueue() ? GpuFence::insert() : nullptr;
+    ReadbackRequestPtr request;
+    if (fence) {
+        request = readback->enqueueAfter(packed, fence, packedWidth, packedHeight, PixelFormat::RGBA8);
+    } else {
+        readback->poll();
+        request = readback->enqueue(*packed, packedWidth, packedHeight, PixelFormat::RGBA8);
+    }
+    if (request) {
+        mInFlight.push_back({request, std::move(packed)});
+    }
+    return request;
+}
+
+void GpuFormatConverter::release() {
+    mInFlight.clear();
+    mFrameBuffer.reset();
+    mSampler.reset();
+    mQuad.reset();
+    mPipelineState.reset();
+    mProgram.reset();
+    mRenderContext = nullptr;
+}
+
+bool GpuFormatConverter::ensureResources(PipelineContext& context) {
+    auto* renderContext = context.getRenderContext();
+    if (!renderContext) {
+        return false;
+    }
+    if (renderContext != mRenderContext) {
+        release();
+        mRenderContext = renderContext;
+    }
+    if (mProgram && mPipelineState && mFrameBuffer) {
+        return true;
+    }
+
+    // 所有转换器共用一个程序，平面布局由 uLayout 区分
+    const std::string vertexSource = kConvertVertexShader;
+    const std::string fragmentSource = kConvertFragmentShader;
+    mProgram = ShaderProgramCache::instance().acquire(
+        renderContext, vertexSource, fragmentSource,
+        [renderContext, &vertexSource, &fragmentSource]() -> ShaderProgramPtr {
+            /*
+            lrengine::render::ShaderDescriptor vsDesc;
+            vsDesc.stage = lrengine::render::ShaderStage::Vertex;
+            vsDesc.source = vertexSource.c_str();
+            auto vs = renderContext->CreateShader(vsDesc);
+
+            lrengine::render::ShaderDescriptor fsDesc;
+            fsDesc.stage = lrengine::render::ShaderStage::Fragment;
+            fsDesc.source = fragmentSource.c_str();
+            auto fs = renderContext->CreateShader(fsDesc);
+
+            return ShaderProgramPtr(renderContext->CreateShaderProgram(vs, fs));
+            */
+            (void)renderContext;
+            return nullptr;
+        });
+    if (!mProgram) {
+        PIPELINE_LOGW("Format conversion shader unavailable");
+        return false;
+    }
+
+    if (auto registry = context.getGpuResourceRegistry()) {
+        mQuad = registry->acquireFullscreenQuad();
+        mSampler = registry->acquireSampler(SamplerFilter::Linear, SamplerWrap::ClampToEdge);
+        mPipelineState = registry->acquirePipelineState(mProgram, RasterBlend::None, PixelFormat::RGBA8);
+    }
+    if (!mPipelineState) {
+        return false;
+    }
+
+    /*
+    lrengine::render::FrameBufferDescriptor fbDesc;
+    mFrameBuffer = std::shared_ptr<lrengine::render::LRFrameBuffer>(
+        renderContext->CreateFrameBuffer(fbDesc));
+    */
+    return mFrameBuffer != nullptr;
+}
+
+void GpuFormatConverter::recyclePackedTextures() {
+    while (!mInFlight.empty() && mInFlight.front().request->isReady()) {
+        mInFlight.pop_front();
+    }
+}
+
+} // namespace output
+} // namespace pipeline
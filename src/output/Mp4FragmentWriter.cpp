@@ -0,0 +1,760 @@
+/**
+ * @file Mp4FragmentWriter.cpp
+ * @brief Mp4FragmentWriter实现
+ */
+
+#include "pipeline/output/Mp4FragmentWriter.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pipeline {
+namespace output {
+
+namespace {
+
+constexpr size_t kWriteAlignment = 4096;
+constexpr int64_t kDefaultFrameDurationUs = 33333;
+
+// 样本标志（ISO/IEC 14496-12 8.8.3.1）
+constexpr uint32_t kSyncSampleFlags = 0x02000000;       // sample_depends_on = 2
+constexpr uint32_t kNonSyncSampleFlags = 0x01010000;    // sample_depends_on = 1, is_non_sync
+
+// trun：data_offset + 每样本时长/大小/标志
+constexpr uint32_t kTrunFlags = 0x000001 | 0x000100 | 0x000200 | 0x000400;
+// tfhd：以 moof 起始为数据基址
+constexpr uint32_t kTfhdDefaultBaseIsMoof = 0x020000;
+
+const uint32_t kUnityMatrix[9] = {
+    0x00010000, 0, 0,
+    0, 0x00010000, 0,
+    0, 0, 0x40000000
+};
+
+/**
+ * @brief 大端盒子写入辅助
+ */
+class BoxWriter {
+public:
+    explicit BoxWriter(std::vector<uint8_t>& out) : mOut(out) {}
+
+    void u8(uint32_t v) { mOut.push_back(static_cast<uint8_t>(v)); }
+    void u16(uint32_t v) { u8(v >> 8); u8(v); }
+    void u24(uint32_t v) { u8(v >> 16); u16(v); }
+    void u32(uint32_t v) { u16(v >> 16); u16(v); }
+    void u64(uint64_t v) { u32(static_cast<uint32_t>(v >> 32)); u32(static_cast<uint32_t>(v)); }
+    void fourcc(const char* type) { bytes(reinterpret_cast<const uint8_t*>(type), 4); }
+    void zeros(size_t count) { mOut.insert(mOut.end(), count, 0); }
+    void bytes(const uint8_t* data, size_t size) { mOut.insert(mOut.end(), data, data + size); }
+
+    size_t begin(const char* type) {
+        size_t pos = mOut.size();
+        u32(0);
+        fourcc(type);
+        return pos;
+    }
+
+    size_t beginFull(const char* type, uint8_t version, uint32_t flags) {
+        size_t pos = begin(type);
+        u8(version);
+        u24(flags);
+        return pos;
+    }
+
+    void end(size_t pos) { patch32(pos, static_cast<uint32_t>(mOut.size() - pos)); }
+
+    void patch32(size_t pos, uint32_t v) {
+        mOut[pos] = static_cast<uint8_t>(v >> 24);
+        mOut[pos + 1] = static_cast<uint8_t>(v >> 16);
+        mOut[pos + 2] = static_cast<uint8_t>(v >> 8);
+        mOut[pos + 3] = static_cast<uint8_t>(v);
+    }
+
+    size_t size() const { return mOut.size(); }
+
+private:
+    std::vector<uint8_t>& mOut;
+};
+
+// 查找下一个起始码（00 00 01 或 00 00 00 01）
+size_t findStartCode(const uint8_t* data, size_t size, size_t from, size_t& codeLength) {
+    for (size_t i = from; i + 3 <= size; ++i) {
+        if (data[i] != 0 || data[i + 1] != 0) {
+            continue;
+        }
+        if (data[i + 2] == 1) {
+            codeLength = 3;
+            return i;
+        }
+        if (i + 4 <= size && data[i + 2] == 0 && data[i + 3] == 1) {
+            codeLength = 4;
+            return i;
+        }
+    }
+    codeLength = 0;
+    return size;
+}
+
+template <typename Func>
+void forEachNal(const uint8_t* data, size_t size, Func&& func) {
+    size_t codeLength = 0;
+    size_t start = findStartCode(data, size, 0, codeLength);
+    if (start == size) {
+        // 无起始码：整段视为一个 NAL
+        if (size > 0) {
+            func(data, size);
+        }
+        return;
+    }
+    while (start < size) {
+        size_t nalBegin = start + codeLength;
+        size_t nextLength = 0;
+        size_t next = findStartCode(data, size, nalBegin, nextLength);
+        size_t nalEnd = next;
+        while (nalEnd > nalBegin && data[nalEnd - 1] == 0) {
+            --nalEnd;       // trailing_zero_8bits
+        }
+        if (nalEnd > nalBegin) {
+            func(data + nalBegin, nalEnd - nalBegin);
+        }
+        start = next;
+        codeLength = nextLength;
+    }
+}
+
+// 去除防竞争字节（00 00 03），只处理前 maxBytes 个输出字节
+std::vector<uint8_t> unescapeRbsp(const uint8_t* data, size_t size, size_t maxBytes) {
+    std::vector<uint8_t> rbsp;
+    rbsp.reserve(std::min(size, maxBytes));
+    size_t zeros = 0;
+    for (size_t i = 0; i < size && rbsp.size() < maxBytes; ++i) {
+        if (zeros >= 2 && data[i] == 3) {
+            zeros = 0;
+            continue;
+        }
+        zeros = data[i] == 0 ? zeros + 1 : 0;
+        rbsp.push_back(data[i]);
+    }
+    return rbsp;
+}
+
+void writeParameterSets(BoxWriter& writer, const std::vector<std::vector<uint8_t>>& sets) {
+    for (const auto& set : sets) {
+        writer.u16(static_cast<uint32_t>(set.size()));
+        writer.bytes(set.data(), set.size());
+    }
+}
+
+bool buildAvcConfig(const uint8_t* annexB, size_t size, std::vector<uint8_t>& record) {
+    std::vector<std::vector<uint8_t>> sps;
+    std::vector<std::vector<uint8_t>> pps;
+    forEachNal(annexB, size, [&](const uint8_t* nal, size_t length) {
+        const uint8_t type = nal[0] & 0x1F;
+        if (type == 7 && length >= 4) {
+            sps.emplace_back(nal, nal + length);
+        } else if (type == 8) {
+            pps.emplace_back(nal, nal + length);
+        }
+    });
+    if (sps.empty() || pps.empty()) {
+        return false;
+    }
+
+    record.clear();
+    BoxWriter writer(record);
+    const uint8_t profile = sps[0][1];
+    writer.u8(1);                       // configurationVersion
+    writer.u8(profile);
+    writer.u8(sps[0][2]);               // profile_compatibility
+    writer.u8(sps[0][3]);               // AVCLevelIndication
+    writer.u8(0xFC | 3);                // lengthSizeMinusOne = 3
+    writer.u8(0xE0 | static_cast<uint32_t>(sps.size()));
+    writeParameterSets(writer, sps);
+    writer.u8(static_cast<uint32_t>(pps.size()));
+    writeParameterSets(writer, pps);
+    if (profile == 100 || profile == 110 || profile == 122 || profile == 144) {
+        // High 系列扩展字段：硬件编码器输出 4:2:0 8bit
+        writer.u8(0xFC | 1);            // chroma_format_idc
+        writer.u8(0xF8);                // bit_depth_luma_minus8
+        writer.u8(0xF8);                // bit_depth_chroma_minus8
+        writer.u8(0);                   // numOfSequenceParameterSetExt
+    }
+    return true;
+}
+
+bool buildHevcConfig(const uint8_t* annexB, size_t size, std::vector<uint8_t>& record) {
+    std::vector<std::vector<uint8_t>> vps;
+    std::vector<std::vector<uint8_t>> sps;
+    std::vector<std::vector<uint8_t>> pps;
+    forEachNal(annexB, size, [&](const uint8_t* nal, size_t length) {
+        if (length < 3) {
+            return;
+        }
+        const uint8_t type = (nal[0] >> 1) & 0x3F;
+        if (type == 32) {
+            vps.emplace_back(nal, nal + length);
+        } else if (type == 33) {
+            sps.emplace_back(nal, nal + length);
+        } else if (type == 34) {
+            pps.emplace_back(nal, nal + length);
+        }
+    });
+    if (vps.empty() || sps.empty() || pps.empty()) {
+        return false;
+    }
+
+    // SPS：2字节 NAL 头 + vps_id/max_sub_layers/nesting 1字节 + general profile_tier_level 12字节
+    std::vector<uint8_t> rbsp = unescapeRbsp(sps[0].data() + 2, sps[0].size() - 2, 13);
+    if (rbsp.size() < 13) {
+        return false;
+    }
+    const uint32_t numTemporalLayers = ((rbsp[0] >> 1) & 0x07) + 1;
+    const uint32_t temporalIdNested = rbsp[0] & 0x01;
+
+    record.clear();
+    BoxWriter writer(record);
+    writer.u8(1);                       // configurationVersion
+    writer.bytes(rbsp.data() + 1, 12);  // profile space/tier/idc, 兼容标志, 约束标志, level
+    writer.u16(0xF000);                 // min_spatial_segmentation_idc
+    writer.u8(0xFC);                    // parallelismType
+    writer.u8(0xFC | 1);                // chroma_format_idc（4:2:0）
+    writer.u8(0xF8);                    // bit_depth_luma_minus8
+    writer.u8(0xF8);                    // bit_depth_chroma_minus8
+    writer.u16(0);                      // avgFrameRate
+    writer.u8((numTemporalLayers << 3) | (temporalIdNested << 2) | 3);
+    writer.u8(3);                       // numOfArrays
+
+    const std::pair<uint8_t, const std::vector<std::vector<uint8_t>>*> arrays[] = {
+        {32, &vps}, {33, &sps}, {34, &pps}
+    };
+    for (const auto& array : arrays) {
+        writer.u8(0x80 | array.first);  // array_completeness = 1
+        writer.u16(static_cast<uint32_t>(array.second->size()));
+        writeParameterSets(writer, *array.second);
+    }
+    return true;
+}
+
+bool pwriteAll(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            PIPELINE_LOGE("pwrite failed: %s", std::strerror(errno));
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// 打开与关闭
+// =============================================================================
+
+Mp4FragmentWriter::~Mp4FragmentWriter() {
+    if (isOpen()) {
+        close();
+    }
+    std::free(mBuffer);
+}
+
+bool Mp4FragmentWriter::open(const std::string& path, EncoderType type, uint32_t width,
+                             uint32_t height, const Mp4WriterConfig& config) {
+    if (isOpen()) {
+        PIPELINE_LOGW("Mp4FragmentWriter already open: %s", mPath.c_str());
+        return false;
+    }
+    if (type != EncoderType::H264 && type != EncoderType::H265) {
+        PIPELINE_LOGE("Unsupported codec for MP4 output: %d", static_cast<int>(type));
+        return false;
+    }
+    if (width == 0 || height == 0 || config.timescale == 0) {
+        return false;
+    }
+
+    mConfig = config;
+    mConfig.writeBufferSize = std::max(
+        (config.writeBufferSize + kWriteAlignment - 1) / kWriteAlignment * kWriteAlignment,
+        kWriteAlignment);
+    std::free(mBuffer);
+    mBuffer = nullptr;
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, kWriteAlignment, mConfig.writeBufferSize) != 0) {
+        PIPELINE_LOGE("Failed to allocate MP4 write buffer");
+        return false;
+    }
+    mBuffer = static_cast<uint8_t*>(buffer);
+
+    mFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (mFd < 0) {
+        PIPELINE_LOGE("Failed to create %s: %s", path.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    mPath = path;
+    mType = type;
+    mWidth = width;
+    mHeight = height;
+    mDecoderConfig.clear();
+    mHeaderWritten = false;
+    mPending.clear();
+    mFragmentData.clear();
+    mFragmentData.reserve(std::min<size_t>(mConfig.maxFragmentBytes, 4u << 20));
+    mFirstPtsUs = -1;
+    mLastPtsUs = -1;
+    mLastDurationUs = 0;
+    mSequence = 0;
+    mRandomAccess.clear();
+    mBufferUsed = 0;
+    mFileOffset = 0;
+    mStats = Mp4WriterStats();
+
+    PIPELINE_LOGI("MP4 writer opened: %s (%ux%u)", path.c_str(), width, height);
+    return true;
+}
+
+bool Mp4FragmentWriter::close() {
+    if (!isOpen()) {
+        return false;
+    }
+
+    bool success = true;
+    if (mHeaderWritten) {
+        success = (mPending.empty() || writeFragment(-1)) && writeIndex();
+    } else {
+        PIPELINE_LOGW("MP4 closed before codec config arrived, %s is empty", mPath.c_str());
+    }
+    success = flushBuffer() && success;
+    success = syncFile() && success;
+
+    ::close(mFd);
+    mFd = -1;
+
+    PIPELINE_LOGI("MP4 writer closed: %s, %llu samples in %llu fragments, %.2fs",
+                  mPath.c_str(),
+                  static_cast<unsigned long long>(mStats.samples),
+                  static_cast<unsigned long long>(mStats.fragments),
+                  mStats.durationUs / 1e6);
+    return success;
+}
+
+// =============================================================================
+// 样本写入
+// =============================================================================
+
+bool Mp4FragmentWriter::writeSample(const EncodedSample& sample) {
+    if (!isOpen() || !sample.data || sample.size == 0) {
+        return false;
+    }
+
+    if (sample.codecConfig) {
+        if (mHeaderWritten) {
+            // 单个样本描述：录制中途改分辨率/参数集需要重新开文件
+            if (mDecoderConfig.size() != sample.size ||
+                std::memcmp(mDecoderConfig.data(), sample.data, sample.size) != 0) {
+                PIPELINE_LOGW("Codec config changed mid-stream, ignored");
+            }
+            return true;
+        }
+        mDecoderConfig.assign(sample.data, sample.data + sample.size);
+        return writeHeader();
+    }
+
+    // 文件必须从关键帧开始；时间戳回退的样本无法表示（不支持 B 帧）
+    if (!mHeaderWritten || (mStats.samples == 0 && !sample.keyFrame) ||
+        sample.ptsUs <= mLastPtsUs) {
+        ++mStats.droppedSamples;
+        return false;
+    }
+
+    if (!mPending.empty()) {
+        const bool durationReached =
+            sample.keyFrame && sample.ptsUs - mPending.front().ptsUs >= mConfig.fragmentDurationUs;
+        const bool sizeReached = mFragmentData.size() + sample.size > mConfig.maxFragmentBytes;
+        if ((durationReached || sizeReached) && !writeFragment(sample.ptsUs)) {
+            return false;
+        }
+    }
+
+    if (mLastPtsUs >= 0) {
+        mLastDurationUs = sample.ptsUs - mLastPtsUs;
+    }
+    if (mFirstPtsUs < 0) {
+        mFirstPtsUs = sample.ptsUs;
+    }
+
+    PendingSample pending;
+    pending.offset = mFragmentData.size();
+    pending.size = static_cast<uint32_t>(sample.size);
+    pending.ptsUs = sample.ptsUs;
+    pending.keyFrame = sample.keyFrame;
+    mPending.push_back(pending);
+    mFragmentData.insert(mFragmentData.end(), sample.data, sample.data + sample.size);
+
+    mLastPtsUs = sample.ptsUs;
+    ++mStats.samples;
+    mStats.durationUs = mLastPtsUs - mFirstPtsUs;
+    return true;
+}
+
+bool Mp4FragmentWriter::flushFragment() {
+    if (!isOpen()) {
+        return false;
+    }
+    if (mPending.empty()) {
+        return true;
+    }
+    return writeFragment(-1);
+}
+
+uint64_t Mp4FragmentWriter::toTrackTime(int64_t us) const {
+    // 由绝对时间换算，逐帧累加时长不会产生漂移
+    const int64_t relative = std::max<int64_t>(us - mFirstPtsUs, 0);
+    return static_cast<uint64_t>(relative) * mConfig.timescale / 1000000;
+}
+
+// =============================================================================
+// 盒子
+// =============================================================================
+
+bool Mp4FragmentWriter::writeHeader() {
+    std::vector<uint8_t> header;
+    header.reserve(1024 + mDecoderConfig.size());
+    BoxWriter w(header);
+
+    size_t ftyp = w.begin("ftyp");
+    w.fourcc("iso5");
+    w.u32(512);
+    w.fourcc("iso5");
+    w.fourcc("iso6");
+    w.fourcc("mp41");
+    w.fourcc("isom");
+    w.end(ftyp);
+
+    size_t moov = w.begin("moov");
+    {
+        size_t mvhd = w.beginFull("mvhd", 0, 0);
+        w.u32(0);                       // creation_time
+        w.u32(0);                       // modification_time
+        w.u32(1000);                    // timescale
+        w.u32(0);                       // duration（分片文件由 mfra/分片决定）
+        w.u32(0x00010000);              // rate
+        w.u16(0x0100);                  // volume
+        w.zeros(10);
+        for (uint32_t m : kUnityMatrix) {
+            w.u32(m);
+        }
+        w.zeros(24);                    // pre_defined
+        w.u32(2);                       // next_track_ID
+        w.end(mvhd);
+
+        size_t trak = w.begin("trak");
+        {
+            size_t tkhd = w.beginFull("tkhd", 0, 0x000003);   // enabled | in_movie
+            w.u32(0);
+            w.u32(0);
+            w.u32(1);                   // track_ID
+            w.u32(0);
+            w.u32(0);                   // duration
+            w.zeros(8);
+            w.u16(0);                   // layer
+            w.u16(0);                   // alternate_group
+            w.u16(0);                   // volume
+            w.u16(0);
+            for (uint32_t m : kUnityMatrix) {
+                w.u32(m);
+            }
+            w.u32(mWidth << 16);
+            w.u32(mHeight << 16);
+            w.end(tkhd);
+
+            size_t mdia = w.begin("mdia");
+            {
+                size_t mdhd = w.beginFull("mdhd", 0, 0);
+                w.u32(0);
+                w.u32(0);
+                w.u32(mConfig.timescale);
+                w.u32(0);
+                w.u16(0x55C4);          // language = "und"
+                w.u16(0);
+                w.end(mdhd);
+
+                size_t hdlr = w.beginFull("hdlr", 0, 0);
+                w.u32(0);
+                w.fourcc("vide");
+                w.zeros(12);
+                static const char kHandlerName[] = "VideoHandler";
+                w.bytes(reinterpret_cast<const uint8_t*>(kHandlerName), sizeof(kHandlerName));
+                w.end(hdlr);
+
+                size_t minf = w.begin("minf");
+                {
+                    size_t vmhd = w.beginFull("vmhd", 0, 1);
+                    w.zeros(8);         // graphicsmode + opcolor
+                    w.end(vmhd);
+
+                    size_t dinf = w.begin("dinf");
+                    size_t dref = w.beginFull("dref", 0, 0);
+                    w.u32(1);
+                    size_t url = w.beginFull("url ", 0, 1);    // 数据在本文件内
+                    w.end(url);
+                    w.end(dref);
+                    w.end(dinf);
+
+                    size_t stbl = w.begin("stbl");
+                    {
+                        size_t stsd = w.beginFull("stsd", 0, 0);
+                        w.u32(1);
+                        size_t entry = w.begin(mType == EncoderType::H265 ? "hvc1" : "avc1");
+                        w.zeros(6);
+                        w.u16(1);       // data_reference_index
+                        w.zeros(16);    // pre_defined / reserved
+                        w.u16(mWidth);
+                        w.u16(mHeight);
+                        w.u32(0x00480000);  // 72 dpi
+                        w.u32(0x00480000);
+                        w.u32(0);
+                        w.u16(1);       // frame_count
+                        w.zeros(32);    // compressorname
+                        w.u16(0x0018);  // depth
+                        w.u16(0xFFFF);  // pre_defined = -1
+                        size_t config = w.begin(mType == EncoderType::H265 ? "hvcC" : "avcC");
+                        w.bytes(mDecoderConfig.data(), mDecoderConfig.size());
+                        w.end(config);
+                        w.end(entry);
+                        w.end(stsd);
+
+                        // 样本表为空，样本全部在分片中
+                        const char* emptyTables[] = {"stts", "stsc", "stco"};
+                        for (const char* table : emptyTables) {
+                            size_t box = w.beginFull(table, 0, 0);
+                            w.u32(0);
+                            w.end(box);
+                        }
+                        size_t stsz = w.beginFull("stsz", 0, 0);
+                        w.u32(0);
+                        w.u32(0);
+                        w.end(stsz);
+                    }
+                    w.end(stbl);
+                }
+                w.end(minf);
+            }
+            w.end(mdia);
+        }
+        w.end(trak);
+
+        size_t mvex = w.begin("mvex");
+        size_t trex = w.beginFull("trex", 0, 0);
+        w.u32(1);                       // track_ID
+        w.u32(1);                       // default_sample_description_index
+        w.u32(0);
+        w.u32(0);
+        w.u32(0);
+        w.end(trex);
+        w.end(mvex);
+    }
+    w.end(moov);
+
+    if (!append(header.data(), header.size())) {
+        return false;
+    }
+    mHeaderWritten = true;
+    return true;
+}
+
+bool Mp4FragmentWriter::writeFragment(int64_t nextPtsUs) {
+    if (mPending.empty()) {
+        return true;
+    }
+    if (nextPtsUs <= mLastPtsUs) {
+        nextPtsUs = mLastPtsUs + (mLastDurationUs > 0 ? mLastDurationUs : kDefaultFrameDurationUs);
+    }
+
+    const uint64_t moofOffset = mFileOffset + mBufferUsed;
+    const uint64_t baseTime = toTrackTime(mPending.front().ptsUs);
+
+    std::vector<uint8_t> moofData;
+    moofData.reserve(128 + mPending.size() * 12);
+    BoxWriter w(moofData);
+
+    size_t moof = w.begin("moof");
+    size_t mfhd = w.beginFull("mfhd", 0, 0);
+    w.u32(++mSequence);
+    w.end(mfhd);
+
+    size_t traf = w.begin("traf");
+    size_t tfhd = w.beginFull("tfhd", 0, kTfhdDefaultBaseIsMoof);
+    w.u32(1);
+    w.end(tfhd);
+
+    size_t tfdt = w.beginFull("tfdt", 1, 0);
+    w.u64(baseTime);
+    w.end(tfdt);
+
+    size_t trun = w.beginFull("trun", 0, kTrunFlags);
+    w.u32(static_cast<uint32_t>(mPending.size()));
+    const size_t dataOffsetPos = w.size();
+    w.u32(0);                           // data_offset，写完 moof 后回填
+    for (size_t i = 0; i < mPending.size(); ++i) {
+        const int64_t endPts = i + 1 < mPending.size() ? mPending[i + 1].ptsUs : nextPtsUs;
+        const uint64_t duration = toTrackTime(endPts) - toTrackTime(mPending[i].ptsUs);
+        w.u32(static_cast<uint32_t>(duration));
+        w.u32(mPending[i].size);
+        w.u32(mPending[i].keyFrame ? kSyncSampleFlags : kNonSyncSampleFlags);
+    }
+    w.end(trun);
+    w.end(traf);
+    w.end(moof);
+
+    const size_t moofSize = moofData.size();
+    w.patch32(dataOffsetPos, static_cast<uint32_t>(moofSize + 8));
+
+    // mdat 头追加在 moof 之后，分片数据一起写出
+    const uint32_t mdatSize = static_cast<uint32_t>(8 + mFragmentData.size());
+    w.u32(mdatSize);
+    w.fourcc("mdat");
+
+    if (!append(moofData.data(), moofData.size()) ||
+        !append(mFragmentData.data(), mFragmentData.size())) {
+        return false;
+    }
+
+    if (mPending.front().keyFrame) {
+        mRandomAccess.push_back({baseTime, moofOffset});
+    }
+    ++mStats.fragments;
+
+    mPending.clear();
+    mFragmentData.clear();
+
+    // 分片完整落盘后才算可恢复
+    if (!flushBuffer()) {
+        return false;
+    }
+    return !mConfig.syncOnFragment || syncFile();
+}
+
+bool Mp4FragmentWriter::writeIndex() {
+    std::vector<uint8_t> index;
+    index.reserve(64 + mRandomAccess.size() * 19);
+    BoxWriter w(index);
+
+    size_t mfra = w.begin("mfra");
+    size_t tfra = w.beginFull("tfra", 1, 0);
+    w.u32(1);                           // track_ID
+    w.u32(0);                           // traf/trun/sample 编号各 1 字节
+    w.u32(static_cast<uint32_t>(mRandomAccess.size()));
+    for (const auto& entry : mRandomAccess) {
+        w.u64(entry.time);
+        w.u64(entry.moofOffset);
+        w.u8(1);
+        w.u8(1);
+        w.u8(1);
+    }
+    w.end(tfra);
+
+    size_t mfro = w.beginFull("mfro", 0, 0);
+    w.u32(static_cast<uint32_t>(index.size() + 4));
+    w.end(mfro);
+    w.end(mfra);
+
+    return append(index.data(), index.size());
+}
+
+// =============================================================================
+// 缓冲写
+// =============================================================================
+
+bool Mp4FragmentWriter::append(const uint8_t* data, size_t size) {
+    if (size >= mConfig.writeBufferSize) {
+        // 大块（关键帧为主）不经过缓冲
+        if (!flushBuffer() || !pwriteAll(mFd, data, size, mFileOffset)) {
+            return false;
+        }
+        mFileOffset += size;
+        mStats.bytesWritten += size;
+        return true;
+    }
+    while (size > 0) {
+        const size_t chunk = std::min(size, mConfig.writeBufferSize - mBufferUsed);
+        std::memcpy(mBuffer + mBufferUsed, data, chunk);
+        mBufferUsed += chunk;
+        data += chunk;
+        size -= chunk;
+        if (mBufferUsed == mConfig.writeBufferSize && !flushBuffer()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Mp4FragmentWriter::flushBuffer() {
+    if (mBufferUsed == 0) {
+        return true;
+    }
+    if (!pwriteAll(mFd, mBuffer, mBufferUsed, mFileOffset)) {
+        return false;
+    }
+    mFileOffset += mBufferUsed;
+    mStats.bytesWritten += mBufferUsed;
+    mBufferUsed = 0;
+    return true;
+}
+
+bool Mp4FragmentWriter::syncFile() {
+#if defined(__APPLE__)
+    const int result = ::fsync(mFd);
+#else
+    const int result = ::fdatasync(mFd);
+#endif
+    if (result != 0) {
+        PIPELINE_LOGW("Failed to sync %s: %s", mPath.c_str(), std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// 码流转换
+// =============================================================================
+
+void Mp4FragmentWriter::annexBToLengthPrefixed(const uint8_t* data, size_t size,
+                                               std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(size + 16);
+    BoxWriter writer(out);
+    forEachNal(data, size, [&](const uint8_t* nal, size_t length) {
+        writer.u32(static_cast<uint32_t>(length));
+        writer.bytes(nal, length);
+    });
+}
+
+bool Mp4FragmentWriter::buildDecoderConfig(EncoderType type, const uint8_t* annexB, size_t size,
+                                           std::vector<uint8_t>& record) {
+    if (!annexB || size == 0) {
+        return false;
+    }
+    switch (type) {
+        case EncoderType::H264: return buildAvcConfig(annexB, size, record);
+        case EncoderType::H265: return buildHevcConfig(annexB, size, record);
+        default:                return false;
+    }
+}
+
+} // namespace output
+} // namespace pipeline
@@ -6,18 +6,76 @@
 #include "pipeline/output/OutputEntity.h"
 #include "pipeline/data/FramePacket.h"
 #include "pipeline/core/PipelineConfig.h"
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/utils/PipelineLog.h"
 #include "lrengine/core/LRPlanarTexture.h"
 #include "lrengine/core/LRRenderContext.h"
 #include "lrengine/core/LRTexture.h"
 #include "lrengine/core/LRTypes.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
 namespace pipeline {
 namespace output {
 
+namespace {
+
+// 交付输出前等待GPU栅栏的上限
+constexpr int64_t kGpuFenceTimeoutMs = 100;
+
+// 回调目标等待转换读回的上限
+constexpr uint32_t kConvertedReadbackTimeoutMs = 200;
+
+} // namespace
+
+// =============================================================================
+// LatestFrameCache 实现
+// =============================================================================
+
+void LatestFrameCache::publish(const OutputData& data) {
+    OutputData frame = data;
+    frame.converted.clear();        // 回调专用的读回不随显示帧保留
+    
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFrame = std::move(frame);
+    ++mGeneration;
+}
+
+bool LatestFrameCache::acquireNewer(uint64_t& generation, OutputData& data) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mGeneration == generation || (!mFrame.hasGpuData() && !mFrame.hasCpuData())) {
+        return false;
+    }
+    data = mFrame;
+    generation = mGeneration;
+    return true;
+}
+
+void LatestFrameCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFrame = OutputData();
+}
+
 // =============================================================================
 // DisplayOutputTarget 实现
 // =============================================================================
 
+// 拉取模式状态：owner 只在持有 mutex 且 active 时访问
+struct DisplayOutputTarget::PullState {
+    std::mutex mutex;
+    bool active = true;
+    DisplayOutputTarget* owner = nullptr;
+    LatestFrameCachePtr cache;
+    TaskPoster poster;
+    FramePacerPtr pacer;
+    std::atomic<bool> presentPending{false};    // 合并同一 GPU 周期内的多次 VSync
+    uint64_t presentedGeneration = 0;
+};
+
 DisplayOutputTarget::DisplayOutputTarget(const std::string& name)
     : mName(name) {
 }
@@ -26,6 +84,58 @@ DisplayOutputTarget::~DisplayOutputTarget() {
     release();
 }
 
+void DisplayOutputTarget::setLatestFrameSource(LatestFrameCachePtr cache, TaskPoster gpuPoster) {
+    stopPulling();
+    
+    FramePacerPtr pacer = mSurface ? mSurface->getFramePacer() : nullptr;
+    if (!cache || !gpuPoster || !pacer || !pacer->hasVsyncSource()) {
+        return;
+    }
+    
+    auto state = std::make_shared<PullState>();
+    state->owner = this;
+    state->cache = std::move(cache);
+    state->poster = std::move(gpuPoster);
+    state->pacer = pacer;
+    
+    std::weak_ptr<PullState> weakState = state;
+    pacer->setVsyncListener([weakState](int64_t) {
+        auto pull = weakState.lock();
+        if (!pull || pull->presentPending.exchange(true)) {
+            return;
+        }
+        pull->poster([pull]() {
+            pull->presentPending.store(false);
+            std::lock_guard<std::mutex> lock(pull->mutex);
+            if (!pull->active) {
+                return;
+            }
+            OutputData frame;
+            if (pull->cache->acquireNewer(pull->presentedGeneration, frame)) {
+                pull->owner->renderFrame(frame, 0);
+            }
+        });
+    });
+    mPull = std::move(state);
+    PIPELINE_LOGI("Display %s presents latest frame on its own vsync", mName.c_str());
+}
+
+bool DisplayOutputTarget::isPullingLatestFrame() const {
+    return mPull != nullptr;
+}
+
+void DisplayOutputTarget::stopPulling() {
+    if (!mPull) {
+        return;
+    }
+    mPull->pacer->setVsyncListener(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(mPull->mutex);
+        mPull->active = false;
+    }
+    mPull.reset();
+}
+
 bool DisplayOutputTarget::initialize() {
     if (!mSurface) {
         return false;
@@ -34,6 +144,7 @@ bool DisplayOutputTarget::initialize() {
 }
 
 void DisplayOutputTarget::release() {
+    stopPulling();
     mCpuDataPlanarTexture.reset();
     if (mSurface) {
         mSurface->release();
@@ -86,6 +197,14 @@ std::shared_ptr<lrengine::render::LRPlanarTexture> DisplayOutputTarget::getOrCre
 }
 
 bool DisplayOutputTarget::output(const OutputData& data) {
+    // 拉取模式：帧已由 OutputEntity 发布到共享缓存，由本屏 VSync 驱动绘制
+    if (mPull) {
+        return true;
+    }
+    return renderFrame(data, data.timestamp);
+}
+
+bool DisplayOutputTarget::renderFrame(const OutputData& data, int64_t contentTimestampUs) {
     if (!mSurface || !mSurface->isReady()) {
         return false;
     }
@@ -95,6 +214,9 @@ bool DisplayOutputTarget::output(const OutputData& data) {
         return false;
     }
     
+    // 内容时间戳交给帧节奏控制器，endFrame 时换算成目标 VSync
+    mSurface->setFrameTimestamp(contentTimestampUs);
+    
     bool renderSuccess = false;
     
     // 优先使用 GPU 纹理数据
@@ -178,8 +300,34 @@ CallbackOutputTarget::~CallbackOutputTarget() = default;
 bool CallbackOutputTarget::output(const OutputData& data) {
     bool success = true;
     
-    // CPU 回调
-    if (mCpuCallback && data.cpuData) {
+    // GPU 已转换的帧：在本目标线程等待读回，GPU队列不阻塞
+    bool delivered = false;
+    OutputFormat format = OutputFormat::RGBA;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    if (mCpuCallback && getConversionRequest(format, width, height)) {
+        for (const auto& converted : data.converted) {
+            if (converted.format != format || converted.requestWidth != width ||
+                converted.requestHeight != height || !converted.readback) {
+                continue;
+            }
+            if (converted.readback->wait(kConvertedReadbackTimeoutMs)) {
+                auto buffer = converted.readback->getBuffer();
+                mCpuCallback(buffer.get(),
+                             GpuFormatConverter::getConvertedSize(format, converted.width, converted.height),
+                             converted.width, converted.height,
+                             format, data.timestamp);
+                delivered = true;
+            } else {
+                PIPELINE_LOGW("Converted readback timed out for frame %llu",
+                              static_cast<unsigned long long>(data.frameId));
+            }
+            break;
+        }
+    }
+    
+    // CPU 回调（未转换时交付原始 RGBA）
+    if (mCpuCallback && !delivered && data.cpuData) {
         mCpuCallback(data.cpuData, data.cpuDataSize,
                      data.width, data.height,
                      data.format, data.timestamp);
@@ -202,6 +350,422 @@ void CallbackOutputTarget::setGPUCallback(GPUOutputCallback callback) {
     mGpuCallback = std::move(callback);
 }
 
+void CallbackOutputTarget::setCPUOutputFormat(OutputFormat format, uint32_t width, uint32_t height) {
+    std::lock_guard<std::mutex> lock(mFormatMutex);
+    mCpuFormat = format;
+    mCpuWidth = width;
+    mCpuHeight = height;
+}
+
+bool CallbackOutputTarget::getConversionRequest(OutputFormat& format, uint32_t& width,
+                                                uint32_t& height) const {
+    std::lock_guard<std::mutex> lock(mFormatMutex);
+    if (!GpuFormatConverter::isSupported(mCpuFormat)) {
+        return false;
+    }
+    format = mCpuFormat;
+    width = mCpuWidth;
+    height = mCpuHeight;
+    return true;
+}
+
+// =============================================================================
+// EncoderOutputTarget 实现
+// =============================================================================
+
+EncoderOutputTarget::EncoderOutputTarget(const std::string& name, const EncoderConfig& config)
+    : mName(name)
+    , mConfig(config) {
+    // 编码表面与管线共用渲染上下文，只能在GPU队列上绘制
+    OutputDispatchConfig dispatch;
+    dispatch.affinity = OutputAffinity::Inline;
+    setDispatchConfig(dispatch);
+    
+    mDisplayConfig.fillMode = DisplayFillMode::AspectFit;
+}
+
+EncoderOutputTarget::~EncoderOutputTarget() {
+    release();
+}
+
+bool EncoderOutputTarget::initialize() {
+    if (!mSurface) {
+        return false;
+    }
+    mLastTimestamp = -1;
+    return mSurface->isReady();
+}
+
+void EncoderOutputTarget::release() {
+    if (mSurface) {
+        mSurface->release();
+    }
+}
+
+bool EncoderOutputTarget::isReady() const {
+    return mSurface && mSurface->isReady();
+}
+
+void EncoderOutputTarget::setEncoderSurface(DisplaySurfacePtr surface) {
+    mSurface = std::move(surface);
+    if (mSurface) {
+        // 编码表面不跟随屏幕刷新，交换缓冲不应等待 VSync
+        mSurface->setVSyncEnabled(false);
+        mSurface->setDisplayConfig(mDisplayConfig);
+    }
+}
+
+bool EncoderOutputTarget::output(const OutputData& data) {
+    if (!mSurface || !mSurface->isReady()) {
+        return false;
+    }
+    
+    if (!data.planarTexture) {
+        if (!mWarnedCpuInput) {
+            PIPELINE_LOGW("Encoder target %s requires GPU texture input, frame skipped",
+                          mName.c_str());
+            mWarnedCpuInput = true;
+        }
+        return false;
+    }
+    
+    // 编码器要求时间戳严格递增，重复或回退的帧直接丢弃
+    if (data.timestamp <= mLastTimestamp) {
+        return false;
+    }
+    
+    // 按编码帧率限流：输入高于目标帧率时丢掉间隔不足的帧（留 1/4 帧间隔的抖动余量）
+    if (mConfig.frameRate > 0 && mLastTimestamp >= 0) {
+        const int64_t minInterval = 1000000 / static_cast<int64_t>(mConfig.frameRate);
+        if (data.timestamp - mLastTimestamp < minInterval - minInterval / 4) {
+            return false;
+        }
+    }
+    
+    auto planeTexture = data.planarTexture->GetPlaneTexture(0);
+    if (!planeTexture) {
+        return false;
+    }
+    
+    if (!mSurface->beginFrame()) {
+        return false;
+    }
+    
+    mSurface->setPresentationTime(data.timestamp);
+    
+    auto texturePtr = std::shared_ptr<lrengine::render::LRTexture>(
+        planeTexture, [](lrengine::render::LRTexture*) {});
+    bool renderSuccess = mSurface->renderTexture(texturePtr, mDisplayConfig);
+    
+    if (!mSurface->endFrame() || !renderSuccess) {
+        return false;
+    }
+    
+    mLastTimestamp = data.timestamp;
+    ++mEncodedFrames;
+    return true;
+}
+
+// =============================================================================
+// FileOutputTarget 实现
+// =============================================================================
+
+/**
+ * @brief 封装状态：只在IO队列上访问 writer 与 source
+ */
+struct FileOutputTarget::MuxState {
+    Mp4FragmentWriter writer;
+    EncodedSampleSourcePtr source;
+    std::atomic<bool> drainScheduled{false};
+    std::atomic<bool> failed{false};
+    std::atomic<bool> finished{false};
+    
+    mutable std::mutex statsMutex;
+    Mp4WriterStats stats;
+    
+    void write(const EncodedSample& sample) {
+        if (failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const uint64_t dropped = writer.getStats().droppedSamples;
+        if (!writer.writeSample(sample) && writer.getStats().droppedSamples == dropped) {
+            // 丢样本之外的失败只可能是写文件出错（磁盘满等），停止录制
+            PIPELINE_LOGE("MP4 write failed, recording stopped");
+            failed.store(true, std::memory_order_relaxed);
+        }
+    }
+    
+    void publishStats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = writer.getStats();
+    }
+};
+
+FileOutputTarget::FileOutputTarget(const std::string& name, const std::string& filePath,
+                                   const EncoderConfig& config, const Mp4WriterConfig& writerConfig)
+    : mName(name)
+    , mFilePath(filePath)
+    , mConfig(config)
+    , mWriterConfig(writerConfig)
+    , mMux(std::make_shared<MuxState>()) {
+    // 渲染进编码表面同样需要管线渲染上下文，封装另行投递到IO队列
+    OutputDispatchConfig dispatch;
+    dispatch.affinity = OutputAffinity::Inline;
+    setDispatchConfig(dispatch);
+}
+
+FileOutputTarget::~FileOutputTarget() {
+    release();
+}
+
+bool FileOutputTarget::initialize() {
+    if (!mRenderTarget || !mMux->source) {
+        PIPELINE_LOGE("File target %s has no encoder", mName.c_str());
+        return false;
+    }
+    if (mMux->writer.isOpen()) {
+        return !mMux->failed.load();
+    }
+    if (mMux->finished) {
+        return false;
+    }
+    return mMux->writer.open(mFilePath, mConfig.type, mConfig.width, mConfig.height, mWriterConfig);
+}
+
+void FileOutputTarget::release() {
+    if (!mMux || mMux->finished) {
+        return;
+    }
+    
+    // 先等最后的帧提交到编码器，再结束输入
+    if (mRenderTarget) {
+        if (auto surface = mRenderTarget->getEncoderSurface()) {
+            surface->waitGPU();
+        }
+        mRenderTarget->release();
+    }
+    
+    auto mux = mMux;
+    mux->finished.store(true);
+    post([mux]() {
+        if (mux->source) {
+            mux->source->finish([&mux](const EncodedSample& sample) { mux->write(sample); }, 1000);
+        }
+        if (mux->writer.isOpen()) {
+            mux->writer.close();
+        }
+        mux->publishStats();
+        mux->source.reset();
+    });
+}
+
+bool FileOutputTarget::output(const OutputData& data) {
+    if (!isReady()) {
+        return false;
+    }
+    if (!mRenderTarget->output(data)) {
+        return false;
+    }
+    scheduleDrain();
+    return true;
+}
+
+bool FileOutputTarget::isReady() const {
+    return mRenderTarget && mRenderTarget->isReady() && !mMux->finished &&
+           mMux->writer.isOpen() && !mMux->failed.load(std::memory_order_relaxed);
+}
+
+void FileOutputTarget::setEncoder(std::shared_ptr<EncoderOutputTarget> renderTarget,
+                                  EncodedSampleSourcePtr source) {
+    mRenderTarget = std::move(renderTarget);
+    mMux->source = std::move(source);
+}
+
+void FileOutputTarget::setIOTaskPoster(TaskPoster poster) {
+    mPoster = std::move(poster);
+}
+
+Mp4WriterStats FileOutputTarget::getWriterStats() const {
+    std::lock_guard<std::mutex> lock(mMux->statsMutex);
+    return mMux->stats;
+}
+
+void FileOutputTarget::post(std::function<void()> task) {
+    if (mPoster) {
+        mPoster(std::move(task));
+    } else {
+        task();
+    }
+}
+
+void FileOutputTarget::scheduleDrain() {
+    // IO队列上最多一个待执行的取样任务，队列忙时合并
+    if (mMux->drainScheduled.exchange(true)) {
+        return;
+    }
+    auto mux = mMux;
+    post([mux]() {
+        mux->drainScheduled.store(false);
+        if (mux->finished || !mux->source) {
+            return;
+        }
+        if (mux->source->drain([&mux](const EncodedSample& sample) { mux->write(sample); }) > 0) {
+            mux->publishStats();
+        }
+    });
+}
+
+// =============================================================================
+// OutputEntity::TargetQueue
+// =============================================================================
+
+/**
+ * @brief 单个目标的分发通道
+ *
+ * Worker 目标在独占线程上调用 output()，帧在有界队列中等待；
+ * 慢目标只会在自己的队列里丢帧，不会拖慢显示或管线循环。
+ */
+class OutputEntity::TargetQueue {
+public:
+    TargetQueue(OutputTargetPtr target, const OutputDispatchConfig& config, size_t capacity)
+        : mTarget(std::move(target))
+        , mConfig(config)
+        , mCapacity(std::max<size_t>(capacity, 1)) {
+        if (mConfig.affinity == OutputAffinity::Worker) {
+            mThread = std::thread([this]() { run(); });
+        }
+    }
+    
+    ~TargetQueue() {
+        stop();
+    }
+    
+    bool isInline() const { return mConfig.affinity == OutputAffinity::Inline; }
+    
+    /**
+     * @brief 同步交付（Inline 目标）
+     */
+    void deliver(const OutputData& data) {
+        deliver(data, std::chrono::steady_clock::now());
+    }
+    
+    /**
+     * @brief 入队（Worker 目标）
+     * @return 丢弃的帧数（0或1）
+     */
+    uint32_t push(const OutputData& data) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mStopping) {
+            return 0;
+        }
+        uint32_t dropped = 0;
+        if (mQueue.size() >= mCapacity) {
+            switch (mConfig.dropPolicy) {
+                case OutputDropPolicy::DropOldest:
+                    mQueue.pop_front();
+                    dropped = 1;
+                    break;
+                case OutputDropPolicy::DropNewest:
+                    mDropped.fetch_add(1, std::memory_order_relaxed);
+                    return 1;
+                case OutputDropPolicy::Block:
+                    if (!mNotFull.wait_for(lock, std::chrono::milliseconds(mConfig.blockTimeoutMs),
+                                           [this]() { return mStopping || mQueue.size() < mCapacity; }) ||
+                        mStopping) {
+                        mDropped.fetch_add(1, std::memory_order_relaxed);
+                        return 1;
+                    }
+                    break;
+            }
+        }
+        mQueue.push_back({data, std::chrono::steady_clock::now()});
+        lock.unlock();
+        mNotEmpty.notify_one();
+        if (dropped) {
+            mDropped.fetch_add(dropped, std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+    
+    /**
+     * @brief 停止工作线程（正在执行的 output() 完成后返回，未交付的帧丢弃）
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopping) {
+                return;
+            }
+            mStopping = true;
+            mQueue.clear();
+        }
+        mNotEmpty.notify_all();
+        mNotFull.notify_all();
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+    }
+    
+    OutputTargetStats getStats() const {
+        OutputTargetStats stats;
+        stats.delivered = mDelivered.load(std::memory_order_relaxed);
+        stats.dropped = mDropped.load(std::memory_order_relaxed);
+        stats.latencyUs = mLatency.getSummary();
+        std::lock_guard<std::mutex> lock(mMutex);
+        stats.queued = mQueue.size();
+        return stats;
+    }
+    
+private:
+    struct PendingFrame {
+        OutputData data;
+        std::chrono::steady_clock::time_point dispatchTime;
+    };
+    
+    // 延迟从分发开始计到 output() 返回，Worker 目标包含排队时间
+    void deliver(const OutputData& data, std::chrono::steady_clock::time_point dispatchTime) {
+        if (!mTarget->isReady()) {
+            return;
+        }
+        mTarget->output(data);
+        mDelivered.fetch_add(1, std::memory_order_relaxed);
+        mLatency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - dispatchTime).count()));
+    }
+    
+    void run() {
+        while (true) {
+            PendingFrame frame;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mNotEmpty.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+                if (mStopping) {
+                    return;
+                }
+                frame = std::move(mQueue.front());
+                mQueue.pop_front();
+            }
+            mNotFull.notify_one();
+            deliver(frame.data, frame.dispatchTime);
+        }
+    }
+    
+    OutputTargetPtr mTarget;
+    OutputDispatchConfig mConfig;
+    size_t mCapacity;
+    
+    mutable std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::deque<PendingFrame> mQueue;
+    bool mStopping = false;
+    std::thread mThread;
+    
+    std::atomic<uint64_t> mDelivered{0};
+    std::atomic<uint64_t> mDropped{0};
+    LatencyHistogram mLatency;
+};
+
 // =============================================================================
 // OutputEntity 实现
 // =============================================================================
@@ -284,6 +848,8 @@ void OutputEntity::removeTarget(const std::string& name) {
     
     if (it != mTargets.end()) {
         for (auto removeIt = it; removeIt != mTargets.end(); ++removeIt) {
+            // 先等工作线程退出，release() 时不会有并发的 output()
+            stopTargetQueueLocked(removeIt->get());
             (*removeIt)->release();
         }
         mTargets.erase(it, mTargets.end());
@@ -305,6 +871,7 @@ void OutputEntity::clearTargets() {
     std::lock_guard<std::mutex> lock(mTargetsMutex);
     
     for (auto& t : mTargets) {
+        stopTargetQueueLocked(t.get());
         t->release();
     }
     mTargets.clear();
@@ -312,6 +879,56 @@ void OutputEntity::clearTargets() {
     mCallbackTarget.reset();
 }
 
+void OutputEntity::stopTargetQueueLocked(const OutputTarget* target) {
+    auto it = mTargetQueues.find(target);
+    if (it == mTargetQueues.end()) {
+        return;
+    }
+    // 分发中的帧可能仍持有通道引用：stop 后其 push 直接返回
+    it->second->stop();
+    mTargetQueues.erase(it);
+}
+
+std::vector<std::pair<std::string, OutputTargetStats>> OutputEntity::getAllTargetStats() const {
+    std::vector<std::pair<std::string, OutputTargetStats>> result;
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    result.reserve(mTargets.size());
+    for (const auto& t : mTargets) {
+        auto it = mTargetQueues.find(t.get());
+        result.emplace_back(t->getName(), it != mTargetQueues.end() ? it->second->getStats() : OutputTargetStats{});
+    }
+    return result;
+}
+
+OutputTargetStats OutputEntity::getTargetStats(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    for (const auto& t : mTargets) {
+        if (t->getName() == name) {
+            auto it = mTargetQueues.find(t.get());
+            return it != mTargetQueues.end() ? it->second->getStats() : OutputTargetStats{};
+        }
+    }
+    return OutputTargetStats{};
+}
+
+bool OutputEntity::requiresFullResolution() const {
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    for (const auto& target : mTargets) {
+        if (!target->isEnabled()) {
+            continue;
+        }
+        switch (target->getType()) {
+            case OutputTargetType::Encoder:
+            case OutputTargetType::File:
+            case OutputTargetType::Stream:
+                return true;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
 // =============================================================================
 // 便捷方法
 // =============================================================================
@@ -367,7 +984,7 @@ bool OutputEntity::process(const std::vector<FramePacketPtr>& inputs,
     // 处理输入
     for (const auto& packet : inputs) {
         if (packet) {
-            processOutput(packet);
+            processOutput(packet, context);
         }
     }
     return true;
@@ -381,7 +998,7 @@ void OutputEntity::finalize(PipelineContext& context) {
 // 内部方法
 // =============================================================================
 
-bool OutputEntity::processOutput(FramePacketPtr packet) {
+bool OutputEntity::processOutput(FramePacketPtr packet, PipelineContext& context) {
     if (!packet) {
         return false;
     }
@@ -392,6 +1009,13 @@ bool OutputEntity::processOutput(FramePacketPtr packet) {
     data.height = packet->getHeight();
     data.timestamp = packet->getTimestamp();
     data.frameId = packet->getFrameId();
+    data.source = packet;
+    
+    // 输出目标可能在其他上下文/线程使用纹理（编码器、回调），交付前等本帧GPU产出完成
+    if (!packet->waitGpu(kGpuFenceTimeoutMs)) {
+        PIPELINE_LOGW("GPU fence wait timed out for output frame %llu",
+                      static_cast<unsigned long long>(packet->getFrameId()));
+    }
     
     // GPU 数据（统一使用 planarTexture）
     data.planarTexture = packet->getPlanarTexture();
@@ -408,6 +1032,14 @@ bool OutputEntity::processOutput(FramePacketPtr packet) {
         data.cpuDataSize = stride * data.height;
     }
     
+    // 请求 YUV 的回调：GPU 上转换，只读回转换后的数据
+    convertForTargets(packet, data, context);
+    
+    // 多显示：每帧只发布一次，各屏按自己的 VSync 取用
+    if (mPublishLatestFrame.load(std::memory_order_acquire)) {
+        mLatestFrame->publish(data);
+    }
+    
     // 分发到所有目标
     dispatchToTargets(data);
     
@@ -415,14 +1047,120 @@ bool OutputEntity::processOutput(FramePacketPtr packet) {
     return true;
 }
 
-void OutputEntity::dispatchToTargets(const OutputData& data) {
-    std::lock_guard<std::mutex> lock(mTargetsMutex);
+void OutputEntity::setLatestFramePublishing(bool enabled) {
+    mPublishLatestFrame.store(enabled, std::memory_order_release);
+    if (!enabled) {
+        mLatestFrame->clear();
+    }
+}
+
+void OutputEntity::convertForTargets(const FramePacketPtr& packet, OutputData& data,
+                                     PipelineContext& context) {
+    // 收集本帧的转换请求（相同格式与尺寸的目标共用一次转换）
+    struct Request {
+        OutputFormat format;
+        uint32_t width;
+        uint32_t height;
+    };
+    std::vector<Request> requests;
+    {
+        std::lock_guard<std::mutex> lock(mTargetsMutex);
+        for (const auto& target : mTargets) {
+            if (!target->isEnabled() || target->getType() != OutputTargetType::Callback) {
+                continue;
+            }
+            auto* callback = static_cast<CallbackOutputTarget*>(target.get());
+            Request request;
+            if (!callback->getConversionRequest(request.format, request.width, request.height)) {
+                continue;
+            }
+            bool duplicate = false;
+            for (const auto& existing : requests) {
+                duplicate = duplicate || (existing.format == request.format &&
+                                          existing.width == request.width &&
+                                          existing.height == request.height);
+            }
+            if (!duplicate) {
+                requests.push_back(request);
+            }
+        }
+    }
     
-    for (auto& target : mTargets) {
-        if (target->isEnabled() && target->isReady()) {
-            if (!target->output(data)) {
-                // 输出失败，记录但继续
+    // 不再被请求的转换器释放（在GPU队列上，纹理可安全归还）
+    mConverters.erase(std::remove_if(mConverters.begin(), mConverters.end(),
+        [&requests](const std::unique_ptr<GpuFormatConverter>& converter) {
+            for (const auto& request : requests) {
+                if (converter->matches(request.format, request.width, request.height)) {
+                    return false;
+                }
             }
+            return true;
+        }), mConverters.end());
+    
+    auto texture = packet->getTexture();
+    if (requests.empty() || !texture) {
+        return;
+    }
+    
+    for (const auto& request : requests) {
+        GpuFormatConverter* converter = nullptr;
+        for (auto& existing : mConverters) {
+            if (existing->matches(request.format, request.width, request.height)) {
+                converter = existing.get();
+                break;
+            }
+        }
+        if (!converter) {
+            mConverters.push_back(std::make_unique<GpuFormatConverter>(
+                request.format, request.width, request.height));
+            converter = mConverters.back().get();
+        }
+        
+        ConvertedFrame converted;
+        converted.format = request.format;
+        converted.requestWidth = request.width;
+        converted.requestHeight = request.height;
+        converted.readback = converter->convert(*texture, data.width, data.height, context,
+                                                converted.width, converted.height);
+        if (converted.readback) {
+            data.converted.push_back(std::move(converted));
+        }
+    }
+}
+
+void OutputEntity::dispatchToTargets(const OutputData& data) {
+    // 锁内只取通道快照，目标的 output() 在锁外执行，增删目标不必等慢目标
+    std::vector<std::shared_ptr<TargetQueue>> channels;
+    {
+        std::lock_guard<std::mutex> lock(mTargetsMutex);
+        channels.reserve(mTargets.size());
+        for (auto& target : mTargets) {
+            if (!target->isEnabled()) {
+                continue;
+            }
+            auto& channel = mTargetQueues[target.get()];
+            if (!channel) {
+                // 首帧时按目标的分发配置创建；关闭异步输出时全部同步调用
+                OutputDispatchConfig dispatch = target->getDispatchConfig();
+                if (!mConfig.asyncOutput) {
+                    dispatch.affinity = OutputAffinity::Inline;
+                }
+                size_t capacity = dispatch.queueSize > 0 ? dispatch.queueSize : mConfig.outputQueueSize;
+                channel = std::make_shared<TargetQueue>(target, dispatch, capacity);
+            }
+            channels.push_back(channel);
+        }
+    }
+    
+    // 先入队 Worker 目标，再同步交付 Inline 目标（显示），两者并行进行
+    for (auto& channel : channels) {
+        if (!channel->isInline()) {
+            mDroppedFrameCount.fetch_add(channel->push(data), std::memory_order_relaxed);
+        }
+    }
+    for (auto& channel : channels) {
+        if (channel->isInline()) {
+            channel->deliver(data);
         }
     }
 }
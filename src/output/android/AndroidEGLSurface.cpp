@@ -8,6 +8,8 @@
 #include "pipeline/output/android/AndroidEGLSurface.h"
 #include "pipeline/utils/PipelineLog.h"
 
+#include <EGL/eglext.h>
+
 namespace pipeline {
 namespace output {
 namespace android {
@@ -52,6 +54,19 @@ static const float SCREEN_QUAD[] = {
      1.0f,  1.0f,  1.0f, 1.0f,
 };
 
+#ifndef EGL_RECORDABLE_ANDROID
+#define EGL_RECORDABLE_ANDROID 0x3142
+#endif
+
+// eglPresentationTimeANDROID 属于扩展，运行时取函数指针
+using PresentationTimeFunc = EGLBoolean (*)(EGLDisplay, EGLSurface, EGLnsecsANDROID);
+
+static PresentationTimeFunc getPresentationTimeFunc() {
+    static PresentationTimeFunc sFunc = reinterpret_cast<PresentationTimeFunc>(
+        eglGetProcAddress("eglPresentationTimeANDROID"));
+    return sFunc;
+}
+
 // =============================================================================
 // 构造与析构
 // =============================================================================
@@ -193,6 +208,9 @@ bool AndroidEGLSurface::beginFrame() {
         }
     }
     
+    // 三缓冲：GPU 落后太多时在此等待，而不是在 eglSwapBuffers 里阻塞
+    waitForFrameSlot();
+    
     // 清屏
     glClearColor(mDisplayConfig.backgroundColor[0],
                  mDisplayConfig.backgroundColor[1],
@@ -226,6 +244,24 @@ bool AndroidEGLSurface::endFrame() {
         return false;
     }
     
+    // 编码器表面：交换前写入本帧时间戳，MediaCodec 以此作为样本 PTS；
+    // 显示表面：写入帧节奏给出的目标上屏时间，由 SurfaceFlinger 在该 VSync 锁存
+    int64_t presentTimeNs = mPresentationTimeNs;
+    if (presentTimeNs < 0) {
+        presentTimeNs = takePacedPresentTimeNs();
+    }
+    if (presentTimeNs >= 0) {
+        if (auto presentationTime = getPresentationTimeFunc()) {
+            presentationTime(mEGLDisplay, mEGLSurface, presentTimeNs);
+        }
+        mPresentationTimeNs = -1;
+    }
+    
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (fence) {
+        mFrameFences.push_back(fence);
+    }
+    
     // 交换缓冲区
     if (!eglSwapBuffers(mEGLDisplay, mEGLSurface)) {
         EGLint error = eglGetError();
@@ -242,6 +278,14 @@ bool AndroidEGLSurface::endFrame() {
     return true;
 }
 
+bool AndroidEGLSurface::setPresentationTime(int64_t timestampUs) {
+    if (!getPresentationTimeFunc()) {
+        return false;
+    }
+    mPresentationTimeNs = timestampUs * 1000;
+    return true;
+}
+
 void AndroidEGLSurface::waitGPU() {
     glFinish();
 }
@@ -281,6 +325,7 @@ bool AndroidEGLSurface::createEGLWindowSurface() {
         EGL_ALPHA_SIZE, 8,
         EGL_DEPTH_SIZE, 0,
         EGL_STENCIL_SIZE, 0,
+        EGL_RECORDABLE_ANDROID, mRecordable ? EGL_TRUE : EGL_DONT_CARE,
         EGL_NONE
     };
     
@@ -310,6 +355,27 @@ bool AndroidEGLSurface::createEGLWindowSurface() {
     return true;
 }
 
+void AndroidEGLSurface::waitForFrameSlot() {
+    // 围栏已隐含 flush（交换缓冲时提交），这里只需等待
+    constexpr GLuint64 kFenceTimeoutNs = 100000000;     // 100ms，防止驱动异常时卡死GPU队列
+    while (mFrameFences.size() >= mMaxFramesInFlight) {
+        GLsync oldest = mFrameFences.front();
+        mFrameFences.pop_front();
+        GLenum result = glClientWaitSync(oldest, 0, kFenceTimeoutNs);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            PIPELINE_LOGW("Frame fence wait timed out");
+        }
+        glDeleteSync(oldest);
+    }
+}
+
+void AndroidEGLSurface::clearFrameFences() {
+    for (GLsync fence : mFrameFences) {
+        glDeleteSync(fence);
+    }
+    mFrameFences.clear();
+}
+
 void AndroidEGLSurface::destroyEGLSurface() {
     if (mEGLSurface != EGL_NO_SURFACE) {
         eglDestroySurface(mEGLDisplay, mEGLSurface);
@@ -390,6 +456,8 @@ bool AndroidEGLSurface::initializeRenderResources() {
 }
 
 void AndroidEGLSurface::cleanupRenderResources() {
+    clearFrameFences();
+    
     if (mDisplayShaderProgram != 0) {
         glDeleteProgram(mDisplayShaderProgram);
         mDisplayShaderProgram = 0;
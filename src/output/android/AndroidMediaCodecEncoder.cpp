@@ -0,0 +1,198 @@
+/**
+ * @file AndroidMediaCodecEncoder.cpp
+ * @brief AndroidMediaCodecEncoder 实现
+ */
+
+#ifdef __ANDROID__
+
+#include "pipeline/output/android/AndroidMediaCodecEncoder.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <media/NdkMediaFormat.h>
+
+#include <chrono>
+
+namespace pipeline {
+namespace output {
+namespace android {
+
+namespace {
+
+// MediaCodecInfo.CodecCapabilities.COLOR_FormatSurface
+constexpr int32_t kColorFormatSurface = 0x7F000789;
+
+// MediaCodec.BUFFER_FLAG_*
+constexpr uint32_t kBufferFlagKeyFrame = 1;
+constexpr uint32_t kBufferFlagCodecConfig = 2;
+constexpr uint32_t kBufferFlagEndOfStream = 4;
+
+// MediaCodecInfo.CodecProfileLevel.AVCProfile*
+int32_t toAvcProfile(const std::string& profile) {
+    if (profile == "baseline") return 0x01;
+    if (profile == "main")     return 0x02;
+    if (profile == "high")     return 0x08;
+    return 0;
+}
+
+} // anonymous namespace
+
+AndroidMediaCodecEncoder::~AndroidMediaCodecEncoder() {
+    release();
+}
+
+bool AndroidMediaCodecEncoder::initialize(const EncoderConfig& config) {
+    if (mCodec) {
+        return true;
+    }
+    if (config.type != EncoderType::H264 && config.type != EncoderType::H265) {
+        PIPELINE_LOGE("MediaCodec encoder supports H.264/H.265 only");
+        return false;
+    }
+    if (config.width == 0 || config.height == 0) {
+        return false;
+    }
+
+    const char* mime = config.type == EncoderType::H265 ? "video/hevc" : "video/avc";
+    mCodec = AMediaCodec_createEncoderByType(mime);
+    if (!mCodec) {
+        PIPELINE_LOGE("No hardware encoder for %s", mime);
+        return false;
+    }
+
+    AMediaFormat* format = AMediaFormat_new();
+    AMediaFormat_setString(format, AMEDIAFORMAT_KEY_MIME, mime);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_WIDTH, static_cast<int32_t>(config.width));
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_HEIGHT, static_cast<int32_t>(config.height));
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_COLOR_FORMAT, kColorFormatSurface);
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_BIT_RATE, static_cast<int32_t>(config.bitrate));
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_FRAME_RATE,
+                          static_cast<int32_t>(config.frameRate > 0 ? config.frameRate : 30));
+    AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_I_FRAME_INTERVAL,
+                          static_cast<int32_t>(config.keyFrameInterval));
+    // MP4 写入器按显示顺序写样本，不能有 B 帧
+    AMediaFormat_setInt32(format, "max-bframes", 0);
+    if (config.type == EncoderType::H264) {
+        const int32_t profile = toAvcProfile(config.profile);
+        if (profile != 0) {
+            AMediaFormat_setInt32(format, "profile", profile);
+        }
+    }
+
+    media_status_t status = AMediaCodec_configure(mCodec, format, nullptr, nullptr,
+                                                  AMEDIACODEC_CONFIGURE_FLAG_ENCODE);
+    AMediaFormat_delete(format);
+    if (status != AMEDIA_OK) {
+        PIPELINE_LOGE("MediaCodec configure failed: %d", status);
+        release();
+        return false;
+    }
+
+    status = AMediaCodec_createInputSurface(mCodec, &mInputSurface);
+    if (status != AMEDIA_OK || !mInputSurface) {
+        PIPELINE_LOGE("MediaCodec createInputSurface failed: %d", status);
+        release();
+        return false;
+    }
+
+    status = AMediaCodec_start(mCodec);
+    if (status != AMEDIA_OK) {
+        PIPELINE_LOGE("MediaCodec start failed: %d", status);
+        release();
+        return false;
+    }
+
+    mType = config.type;
+    mEndOfStream = false;
+    PIPELINE_LOGI("MediaCodec encoder started: %s %ux%u, %u bps",
+                  mime, config.width, config.height, config.bitrate);
+    return true;
+}
+
+void AndroidMediaCodecEncoder::release() {
+    if (mCodec) {
+        AMediaCodec_stop(mCodec);
+        AMediaCodec_delete(mCodec);
+        mCodec = nullptr;
+    }
+    if (mInputSurface) {
+        ANativeWindow_release(mInputSurface);
+        mInputSurface = nullptr;
+    }
+}
+
+size_t AndroidMediaCodecEncoder::drain(const SampleSink& sink) {
+    size_t count = 0;
+    while (mCodec && !mEndOfStream && drainOne(sink, 0)) {
+        ++count;
+    }
+    return count;
+}
+
+void AndroidMediaCodecEncoder::finish(const SampleSink& sink, int64_t timeoutMs) {
+    if (!mCodec) {
+        return;
+    }
+    if (!mEndOfStream) {
+        AMediaCodec_signalEndOfInputStream(mCodec);
+    }
+
+    // 等编码器把缓存的帧全部吐出（带 EOS 标志的缓冲为最后一个）
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!mEndOfStream && std::chrono::steady_clock::now() < deadline) {
+        drainOne(sink, 10000);
+    }
+    if (!mEndOfStream) {
+        PIPELINE_LOGW("MediaCodec did not reach end of stream in %lld ms",
+                      static_cast<long long>(timeoutMs));
+    }
+    release();
+}
+
+bool AndroidMediaCodecEncoder::drainOne(const SampleSink& sink, int64_t timeoutUs) {
+    AMediaCodecBufferInfo info;
+    ssize_t index = AMediaCodec_dequeueOutputBuffer(mCodec, &info, timeoutUs);
+    if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED ||
+        index == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+        return true;        // 参数集随后以 CODEC_CONFIG 缓冲给出
+    }
+    if (index < 0) {
+        return false;
+    }
+
+    size_t capacity = 0;
+    uint8_t* buffer = AMediaCodec_getOutputBuffer(mCodec, static_cast<size_t>(index), &capacity);
+    const uint32_t flags = info.flags;
+    if (buffer && info.size > 0 && info.offset + info.size <= static_cast<int32_t>(capacity)) {
+        const uint8_t* data = buffer + info.offset;
+        EncodedSample sample;
+        sample.ptsUs = info.presentationTimeUs;
+        if (flags & kBufferFlagCodecConfig) {
+            if (Mp4FragmentWriter::buildDecoderConfig(mType, data, info.size, mScratch)) {
+                sample.codecConfig = true;
+                sample.data = mScratch.data();
+                sample.size = mScratch.size();
+                sink(sample);
+            } else {
+                PIPELINE_LOGW("Incomplete codec config from MediaCodec");
+            }
+        } else {
+            Mp4FragmentWriter::annexBToLengthPrefixed(data, info.size, mScratch);
+            sample.keyFrame = (flags & kBufferFlagKeyFrame) != 0;
+            sample.data = mScratch.data();
+            sample.size = mScratch.size();
+            sink(sample);
+        }
+    }
+
+    AMediaCodec_releaseOutputBuffer(mCodec, static_cast<size_t>(index), false);
+    if (flags & kBufferFlagEndOfStream) {
+        mEndOfStream = true;
+    }
+    return true;
+}
+
+} // namespace android
+} // namespace output
+} // namespace pipeline
+
+#endif // __ANDROID__
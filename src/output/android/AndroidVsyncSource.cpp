@@ -0,0 +1,157 @@
+/**
+ * @file AndroidVsyncSource.cpp
+ * @brief Android 平台 VSync 来源（AChoreographer）
+ *
+ * Choreographer 只在带 ALooper 的线程上回调，这里单独起一个 looper 线程，
+ * 避免依赖应用主线程。frameTimeNanos 为 CLOCK_MONOTONIC，与 FramePacer::nowNs 同一时钟。
+ */
+
+#ifdef __ANDROID__
+
+#include "pipeline/output/FramePacer.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <android/choreographer.h>
+#include <android/looper.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+namespace pipeline {
+namespace output {
+
+namespace {
+
+class AndroidChoreographerVsyncSource : public VsyncSource {
+public:
+    ~AndroidChoreographerVsyncSource() override {
+        stop();
+    }
+
+    bool start(VsyncCallback callback) override {
+        if (mThread.joinable()) {
+            return false;
+        }
+        mCallback = std::move(callback);
+        mRunning = true;
+        mStarted = false;
+        mChoreographer = nullptr;
+
+        mThread = std::thread([this]() { threadLoop(); });
+
+        // 等 looper 线程拿到 Choreographer，失败时由 start 直接报告
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStartCond.wait(lock, [this]() { return mStarted; });
+        if (!mChoreographer) {
+            lock.unlock();
+            mThread.join();
+            mRunning = false;
+            return false;
+        }
+        return true;
+    }
+
+    void stop() override {
+        if (!mThread.joinable()) {
+            return;
+        }
+        mRunning = false;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mLooper) {
+                ALooper_wake(mLooper);
+            }
+        }
+        mThread.join();
+    }
+
+private:
+    void threadLoop() {
+        ALooper* looper = ALooper_prepare(0);
+        AChoreographer* choreographer = AChoreographer_getInstance();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (choreographer) {
+                ALooper_acquire(looper);
+                mLooper = looper;
+                mChoreographer = choreographer;
+            }
+            mStarted = true;
+        }
+        mStartCond.notify_all();
+        if (!choreographer) {
+            PIPELINE_LOGW("AChoreographer unavailable, frame pacing uses estimated vsync");
+            return;
+        }
+
+#if __ANDROID_API__ >= 30
+        AChoreographer_registerRefreshRateCallback(choreographer, onRefreshRateChanged, this);
+#endif
+        postFrameCallback();
+
+        while (mRunning) {
+            ALooper_pollOnce(-1, nullptr, nullptr, nullptr);
+        }
+
+#if __ANDROID_API__ >= 30
+        AChoreographer_unregisterRefreshRateCallback(choreographer, onRefreshRateChanged, this);
+#endif
+        std::lock_guard<std::mutex> lock(mMutex);
+        ALooper_release(mLooper);
+        mLooper = nullptr;
+        mChoreographer = nullptr;
+    }
+
+    void postFrameCallback() {
+#if __ANDROID_API__ >= 29
+        AChoreographer_postFrameCallback64(mChoreographer, onFrame64, this);
+#else
+        AChoreographer_postFrameCallback(mChoreographer, onFrame, this);
+#endif
+    }
+
+    void handleFrame(int64_t frameTimeNanos) {
+        if (!mRunning) {
+            return;
+        }
+        // 平台周期由刷新率回调给出；未知时传 0 让 FramePacer 自行估算
+        mCallback(frameTimeNanos, mPeriodNs.load());
+        postFrameCallback();
+    }
+
+    static void onFrame64(int64_t frameTimeNanos, void* data) {
+        static_cast<AndroidChoreographerVsyncSource*>(data)->handleFrame(frameTimeNanos);
+    }
+
+    static void onFrame(long frameTimeNanos, void* data) {
+        static_cast<AndroidChoreographerVsyncSource*>(data)->handleFrame(
+            static_cast<int64_t>(frameTimeNanos));
+    }
+
+    static void onRefreshRateChanged(int64_t vsyncPeriodNanos, void* data) {
+        static_cast<AndroidChoreographerVsyncSource*>(data)->mPeriodNs = vsyncPeriodNanos;
+    }
+
+    VsyncCallback mCallback;
+    std::thread mThread;
+    std::atomic<bool> mRunning{false};
+    std::atomic<int64_t> mPeriodNs{0};
+
+    std::mutex mMutex;
+    std::condition_variable mStartCond;
+    bool mStarted = false;
+    ALooper* mLooper = nullptr;
+    AChoreographer* mChoreographer = nullptr;
+};
+
+} // anonymous namespace
+
+std::unique_ptr<VsyncSource> createPlatformVsyncSource() {
+    return std::unique_ptr<VsyncSource>(new AndroidChoreographerVsyncSource());
+}
+
+} // namespace output
+} // namespace pipeline
+
+#endif // __ANDROID__
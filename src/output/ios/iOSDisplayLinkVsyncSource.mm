@@ -0,0 +1,133 @@
+/**
+ * @file iOSDisplayLinkVsyncSource.mm
+ * @brief iOS 平台 VSync 来源（CADisplayLink）
+ *
+ * CADisplayLink 挂在主线程 run loop 上；回调里的 timestamp 是 CACurrentMediaTime 时基，
+ * 这里换算成 FramePacer::nowNs 的单调时钟后再交给 FramePacer。
+ * macOS 没有 CADisplayLink（14 之前），返回 nullptr，由 FramePacer 使用默认周期。
+ */
+
+#if defined(__APPLE__)
+
+#import "pipeline/output/FramePacer.h"
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+#include <TargetConditionals.h>
+
+#if TARGET_OS_IPHONE
+
+namespace {
+
+// 回调状态，display link 的 target 与 C++ 对象共同持有
+struct DisplayLinkState {
+    std::mutex mutex;
+    pipeline::output::VsyncSource::VsyncCallback callback;
+};
+
+} // anonymous namespace
+
+@interface PipelineDisplayLinkProxy : NSObject
+- (instancetype)initWithState:(std::shared_ptr<DisplayLinkState>)state;
+- (void)onDisplayLink:(CADisplayLink*)link;
+@end
+
+@implementation PipelineDisplayLinkProxy {
+    std::shared_ptr<DisplayLinkState> _state;
+}
+
+- (instancetype)initWithState:(std::shared_ptr<DisplayLinkState>)state {
+    if (self = [super init]) {
+        _state = std::move(state);
+    }
+    return self;
+}
+
+- (void)onDisplayLink:(CADisplayLink*)link {
+    const int64_t nowNs = pipeline::output::FramePacer::nowNs();
+    const CFTimeInterval sinceVsync = CACurrentMediaTime() - link.timestamp;
+    const int64_t vsyncNs = nowNs - static_cast<int64_t>(sinceVsync * 1e9);
+    const int64_t periodNs = static_cast<int64_t>((link.targetTimestamp - link.timestamp) * 1e9);
+
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    if (_state->callback) {
+        _state->callback(vsyncNs, periodNs);
+    }
+}
+
+@end
+
+namespace pipeline {
+namespace output {
+
+namespace {
+
+class iOSDisplayLinkVsyncSource : public VsyncSource {
+public:
+    ~iOSDisplayLinkVsyncSource() override {
+        stop();
+    }
+
+    bool start(VsyncCallback callback) override {
+        if (mLink) {
+            return false;
+        }
+        mState = std::make_shared<DisplayLinkState>();
+        mState->callback = std::move(callback);
+
+        PipelineDisplayLinkProxy* proxy = [[PipelineDisplayLinkProxy alloc] initWithState:mState];
+        CADisplayLink* link = [CADisplayLink displayLinkWithTarget:proxy
+                                                          selector:@selector(onDisplayLink:)];
+        mLink = (__bridge_retained void*)link;
+
+        // run loop 必须是主线程的；使用 CommonModes 保证滚动时也能收到回调
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [link addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+        });
+        return true;
+    }
+
+    void stop() override {
+        if (!mLink) {
+            return;
+        }
+        // 先断开回调，返回后不会再进入 FramePacer；link 本身在主线程失效
+        {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            mState->callback = nullptr;
+        }
+        CADisplayLink* link = (__bridge_transfer CADisplayLink*)mLink;
+        mLink = nullptr;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [link invalidate];
+        });
+    }
+
+private:
+    void* mLink = nullptr;      // CADisplayLink*
+    std::shared_ptr<DisplayLinkState> mState;
+};
+
+} // anonymous namespace
+
+std::unique_ptr<VsyncSource> createPlatformVsyncSource() {
+    return std::unique_ptr<VsyncSource>(new iOSDisplayLinkVsyncSource());
+}
+
+} // namespace output
+} // namespace pipeline
+
+#else
+
+namespace pipeline {
+namespace output {
+
+std::unique_ptr<VsyncSource> createPlatformVsyncSource() {
+    return nullptr;
+}
+
+} // namespace output
+} // namespace pipeline
+
+#endif // TARGET_OS_IPHONE
+
+#endif // defined(__APPLE__)
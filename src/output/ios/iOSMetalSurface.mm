@@ -8,14 +8,46 @@
 #import "pipeline/output/ios/iOSMetalSurface.h"
 #import "pipeline/utils/PipelineLog.h"
 #import "lrengine/core/LRTexture.h"
+#import <AVFoundation/AVFoundation.h>
+#import <CoreVideo/CoreVideo.h>
 #import <Metal/Metal.h>
 #import <QuartzCore/CAMetalLayer.h>
 #import <simd/simd.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 namespace pipeline {
 namespace output {
 namespace ios {
 
+// 在途帧计数：beginFrame 占用，command buffer 完成回调归还
+struct iOSMetalSurface::InFlightLimiter {
+    std::mutex mutex;
+    std::condition_variable cond;
+    uint32_t count = 0;
+    
+    bool acquire(uint32_t limit, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cond.wait_for(lock, timeout, [&] { return count < limit; })) {
+            return false;
+        }
+        ++count;
+        return true;
+    }
+    
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count > 0) {
+                --count;
+            }
+        }
+        cond.notify_one();
+    }
+};
+
 // Metal Shader 源码
 static NSString* const DISPLAY_SHADER_SOURCE = @R"(
 #include <metal_stdlib>
@@ -63,7 +95,8 @@ static const Vertex SCREEN_VERTICES[] = {
 // 构造与析构
 // =============================================================================
 
-iOSMetalSurface::iOSMetalSurface() {
+iOSMetalSurface::iOSMetalSurface()
+    : mInFlight(std::make_shared<InFlightLimiter>()) {
     mPixelFormat = MTLPixelFormatBGRA8Unorm;
 }
 
@@ -120,6 +153,20 @@ void iOSMetalSurface::release() {
         mCommandQueue = nullptr;
     }
     
+    if (mTextureCache) {
+        CFRelease(mTextureCache);
+        mTextureCache = nullptr;
+    }
+    if (mPixelBufferAdaptor) {
+        CFRelease(mPixelBufferAdaptor);
+        mPixelBufferAdaptor = nullptr;
+    }
+    if (mPixelBufferPool) {
+        CVPixelBufferPoolRelease((CVPixelBufferPoolRef)mPixelBufferPool);
+        mPixelBufferPool = nullptr;
+    }
+    mPixelBufferHandler = nullptr;
+    
     mMetalLayer = nullptr;
     mDevice = nullptr;
     mState = SurfaceState::Uninitialized;
@@ -186,12 +233,21 @@ bool iOSMetalSurface::beginFrame() {
         return false;
     }
     
-    if (!mMetalLayer) {
+    // GPU 落后超过在途上限时在这里短暂等待；超时则本帧放弃，不拖住GPU队列
+    if (!mInFlight->acquire(mMaxFramesInFlight, std::chrono::milliseconds(50))) {
+        PIPELINE_LOGW("Too many frames in flight, frame skipped");
         return false;
     }
     
-    // 获取下一个 drawable
-    if (!acquireNextDrawable()) {
+    // 获取本帧渲染目标：屏幕 drawable 或编码器像素缓冲
+    bool acquired = false;
+    if (mMetalLayer) {
+        acquired = acquireNextDrawable();
+    } else if (mPixelBufferAdaptor || mPixelBufferPool) {
+        acquired = acquireNextPixelBuffer();
+    }
+    if (!acquired) {
+        mInFlight->release();
         return false;
     }
     
@@ -210,16 +266,24 @@ bool iOSMetalSurface::renderTexture(std::shared_ptr<lrengine::render::LRTexture>
         return false;
     }
     
-    if (!texture || !mCurrentDrawable || !mCurrentCommandBuffer) {
+    if (!texture || !mCurrentCommandBuffer || (!mCurrentDrawable && !mCurrentPixelTexture)) {
         return false;
     }
     
-    id<CAMetalDrawable> drawable = (__bridge id<CAMetalDrawable>)mCurrentDrawable;
     id<MTLCommandBuffer> cmdBuffer = (__bridge id<MTLCommandBuffer>)mCurrentCommandBuffer;
+    id<MTLTexture> targetTexture = nil;
+    if (mCurrentDrawable) {
+        targetTexture = ((__bridge id<CAMetalDrawable>)mCurrentDrawable).texture;
+    } else {
+        targetTexture = CVMetalTextureGetTexture((CVMetalTextureRef)mCurrentPixelTexture);
+    }
+    if (!targetTexture) {
+        return false;
+    }
     
     // 创建渲染通道描述符
     MTLRenderPassDescriptor* passDesc = [MTLRenderPassDescriptor renderPassDescriptor];
-    passDesc.colorAttachments[0].texture = drawable.texture;
+    passDesc.colorAttachments[0].texture = targetTexture;
     passDesc.colorAttachments[0].loadAction = MTLLoadActionClear;
     passDesc.colorAttachments[0].storeAction = MTLStoreActionStore;
     passDesc.colorAttachments[0].clearColor = MTLClearColorMake(
@@ -281,27 +345,91 @@ bool iOSMetalSurface::endFrame() {
         return false;
     }
     
-    if (!mCurrentDrawable || !mCurrentCommandBuffer) {
+    if (!mCurrentCommandBuffer || (!mCurrentDrawable && !mCurrentPixelBuffer)) {
+        mInFlight->release();
         return false;
     }
     
-    id<CAMetalDrawable> drawable = (__bridge id<CAMetalDrawable>)mCurrentDrawable;
     id<MTLCommandBuffer> cmdBuffer = (__bridge id<MTLCommandBuffer>)mCurrentCommandBuffer;
     
-    // 呈现
-    [cmdBuffer presentDrawable:drawable];
-    [cmdBuffer commit];
+    // 每个完成回调都要归还在途名额
+    std::shared_ptr<InFlightLimiter> inFlight = mInFlight;
+    
+    if (mCurrentDrawable) {
+        // 呈现：启用帧节奏时按目标 VSync 上屏，否则尽快上屏
+        id<CAMetalDrawable> drawable = (__bridge id<CAMetalDrawable>)mCurrentDrawable;
+        const int64_t presentTimeNs = takePacedPresentTimeNs();
+        if (presentTimeNs >= 0) {
+            // 目标时间换算到 CACurrentMediaTime 时基
+            const CFTimeInterval delay =
+                static_cast<double>(presentTimeNs - FramePacer::nowNs()) / 1e9;
+            [cmdBuffer presentDrawable:drawable atTime:CACurrentMediaTime() + delay];
+        } else {
+            [cmdBuffer presentDrawable:drawable];
+        }
+        [cmdBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            (void)buffer;
+            inFlight->release();
+        }];
+        [cmdBuffer commit];
+        CFRelease(mCurrentDrawable);
+        mCurrentDrawable = nullptr;
+    } else if (mPixelBufferHandler) {
+        // 池模式：GPU 写完后交给编码会话
+        PixelBufferHandler handler = mPixelBufferHandler;
+        CVPixelBufferRef pixelBuffer = (CVPixelBufferRef)CFRetain(mCurrentPixelBuffer);
+        CVMetalTextureRef pixelTexture = (CVMetalTextureRef)CFRetain(mCurrentPixelTexture);
+        const int64_t timestampUs = mPresentationTimeUs;
+        [cmdBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            if (buffer.status == MTLCommandBufferStatusCompleted) {
+                handler(pixelBuffer, timestampUs);
+            }
+            CFRelease(pixelTexture);
+            CFRelease(pixelBuffer);
+            inFlight->release();
+        }];
+        [cmdBuffer commit];
+        releaseCurrentPixelBuffer();
+    } else {
+        // 编码输出：GPU 写完后在完成回调里追加，渲染线程不等待
+        AVAssetWriterInputPixelBufferAdaptor* adaptor =
+            (__bridge AVAssetWriterInputPixelBufferAdaptor*)mPixelBufferAdaptor;
+        CVPixelBufferRef pixelBuffer = (CVPixelBufferRef)CFRetain(mCurrentPixelBuffer);
+        CVMetalTextureRef pixelTexture = (CVMetalTextureRef)CFRetain(mCurrentPixelTexture);
+        CMTime time = CMTimeMake(mPresentationTimeUs, 1000000);
+        [cmdBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            if (buffer.status == MTLCommandBufferStatusCompleted &&
+                adaptor.assetWriterInput.isReadyForMoreMediaData) {
+                if (![adaptor appendPixelBuffer:pixelBuffer withPresentationTime:time]) {
+                    PIPELINE_LOGW("Failed to append pixel buffer to asset writer");
+                }
+            } else {
+                PIPELINE_LOGW("Asset writer not ready, encoder frame dropped");
+            }
+            CFRelease(pixelTexture);     // 纹理先于缓冲释放
+            CFRelease(pixelBuffer);
+            inFlight->release();
+        }];
+        [cmdBuffer commit];
+        releaseCurrentPixelBuffer();
+    }
     
     // 释放当前帧资源
     CFRelease(mCurrentCommandBuffer);
-    CFRelease(mCurrentDrawable);
     mCurrentCommandBuffer = nullptr;
-    mCurrentDrawable = nullptr;
     
     mState = SurfaceState::Ready;
     return true;
 }
 
+bool iOSMetalSurface::setPresentationTime(int64_t timestampUs) {
+    if (!mPixelBufferAdaptor && !mPixelBufferPool) {
+        return false;
+    }
+    mPresentationTimeUs = timestampUs;
+    return true;
+}
+
 void iOSMetalSurface::waitGPU() {
     if (mCurrentCommandBuffer) {
         id<MTLCommandBuffer> cmdBuffer = (__bridge id<MTLCommandBuffer>)mCurrentCommandBuffer;
@@ -318,6 +446,16 @@ void iOSMetalSurface::setVSyncEnabled(bool enabled) {
     }
 }
 
+void iOSMetalSurface::setMaxFramesInFlight(uint32_t count) {
+    DisplaySurface::setMaxFramesInFlight(count);
+    
+    if (mMetalLayer) {
+        // CAMetalLayer 只接受 2 或 3
+        CAMetalLayer* layer = (__bridge CAMetalLayer*)mMetalLayer;
+        layer.maximumDrawableCount = mMaxFramesInFlight < 3 ? 2 : 3;
+    }
+}
+
 // =============================================================================
 // iOS 特定接口
 // =============================================================================
@@ -326,6 +464,42 @@ void iOSMetalSurface::setMetalContextManager(IOSMetalContextManager* manager) {
     mMetalManager = manager;
 }
 
+bool iOSMetalSurface::attachToPixelBufferAdaptor(void* adaptor, uint32_t width, uint32_t height) {
+    if (!adaptor || width == 0 || height == 0) {
+        return false;
+    }
+    if (mPixelBufferAdaptor) {
+        CFRelease(mPixelBufferAdaptor);
+    }
+    mPixelBufferAdaptor = (void*)CFRetain(adaptor);
+    mMetalLayer = nullptr;
+    mWidth = width;
+    mHeight = height;
+    mScaleFactor = 1.0f;
+    
+    PIPELINE_LOGI("Attached to pixel buffer adaptor: %ux%u", width, height);
+    return true;
+}
+
+bool iOSMetalSurface::attachToPixelBufferPool(void* pool, uint32_t width, uint32_t height,
+                                              PixelBufferHandler handler) {
+    if (!pool || !handler || width == 0 || height == 0) {
+        return false;
+    }
+    if (mPixelBufferPool) {
+        CVPixelBufferPoolRelease((CVPixelBufferPoolRef)mPixelBufferPool);
+    }
+    mPixelBufferPool = CVPixelBufferPoolRetain((CVPixelBufferPoolRef)pool);
+    mPixelBufferHandler = std::move(handler);
+    mMetalLayer = nullptr;
+    mWidth = width;
+    mHeight = height;
+    mScaleFactor = 1.0f;
+    
+    PIPELINE_LOGI("Attached to pixel buffer pool: %ux%u", width, height);
+    return true;
+}
+
 void iOSMetalSurface::setColorSpace(void* colorSpace) {
     mColorSpace = colorSpace;
     
@@ -351,6 +525,7 @@ bool iOSMetalSurface::configureMetalLayer() {
     layer.pixelFormat = (MTLPixelFormat)mPixelFormat;
     layer.framebufferOnly = YES;
     layer.displaySyncEnabled = mVSyncEnabled;
+    layer.maximumDrawableCount = mMaxFramesInFlight < 3 ? 2 : 3;
     
     if (mColorSpace) {
         layer.colorspace = (__bridge CGColorSpaceRef)mColorSpace;
@@ -376,6 +551,63 @@ bool iOSMetalSurface::acquireNextDrawable() {
     return true;
 }
 
+bool iOSMetalSurface::acquireNextPixelBuffer() {
+    // adaptor 的池在 AVAssetWriter startWriting 之后才可用
+    CVPixelBufferPoolRef pool = (CVPixelBufferPoolRef)mPixelBufferPool;
+    if (!pool && mPixelBufferAdaptor) {
+        AVAssetWriterInputPixelBufferAdaptor* adaptor =
+            (__bridge AVAssetWriterInputPixelBufferAdaptor*)mPixelBufferAdaptor;
+        pool = adaptor.pixelBufferPool;
+    }
+    if (!pool) {
+        PIPELINE_LOGW("Pixel buffer pool not ready");
+        return false;
+    }
+    
+    if (!mTextureCache) {
+        CVMetalTextureCacheRef cache = nullptr;
+        if (CVMetalTextureCacheCreate(kCFAllocatorDefault, nullptr,
+                                      (__bridge id<MTLDevice>)mDevice, nullptr, &cache) != kCVReturnSuccess) {
+            PIPELINE_LOGE("Failed to create CVMetalTextureCache");
+            return false;
+        }
+        mTextureCache = cache;
+    }
+    
+    CVPixelBufferRef pixelBuffer = nullptr;
+    if (CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, pool, &pixelBuffer) != kCVReturnSuccess) {
+        PIPELINE_LOGW("Pixel buffer pool exhausted, encoder frame dropped");
+        return false;
+    }
+    
+    CVMetalTextureRef pixelTexture = nullptr;
+    CVReturn result = CVMetalTextureCacheCreateTextureFromImage(
+        kCFAllocatorDefault, (CVMetalTextureCacheRef)mTextureCache, pixelBuffer, nullptr,
+        (MTLPixelFormat)mPixelFormat,
+        CVPixelBufferGetWidth(pixelBuffer), CVPixelBufferGetHeight(pixelBuffer),
+        0, &pixelTexture);
+    if (result != kCVReturnSuccess) {
+        PIPELINE_LOGE("Failed to wrap pixel buffer as Metal texture: %d", result);
+        CFRelease(pixelBuffer);
+        return false;
+    }
+    
+    mCurrentPixelBuffer = pixelBuffer;
+    mCurrentPixelTexture = pixelTexture;
+    return true;
+}
+
+void iOSMetalSurface::releaseCurrentPixelBuffer() {
+    if (mCurrentPixelTexture) {
+        CFRelease(mCurrentPixelTexture);
+        mCurrentPixelTexture = nullptr;
+    }
+    if (mCurrentPixelBuffer) {
+        CFRelease(mCurrentPixelBuffer);
+        mCurrentPixelBuffer = nullptr;
+    }
+}
+
 bool iOSMetalSurface::createRenderPipeline() {
     if (!mDevice) {
         return false;
@@ -456,6 +688,8 @@ void iOSMetalSurface::cleanupResources() {
         mCurrentDrawable = nullptr;
     }
     
+    releaseCurrentPixelBuffer();
+    
     if (mRenderPipelineState) {
         CFRelease(mRenderPipelineState);
         mRenderPipelineState = nullptr;
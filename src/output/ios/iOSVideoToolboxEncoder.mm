@@ -0,0 +1,228 @@
+/**
+ * @file iOSVideoToolboxEncoder.mm
+ * @brief iOSVideoToolboxEncoder 实现
+ */
+
+#if defined(__APPLE__)
+
+#import "pipeline/output/ios/iOSVideoToolboxEncoder.h"
+#import "pipeline/utils/PipelineLog.h"
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+#import <VideoToolbox/VideoToolbox.h>
+
+namespace pipeline {
+namespace output {
+namespace ios {
+
+static void compressionOutputCallback(void* refcon, void* sourceFrameRefcon, OSStatus status,
+                                      VTEncodeInfoFlags infoFlags, CMSampleBufferRef sampleBuffer) {
+    (void)sourceFrameRefcon;
+    (void)infoFlags;
+    static_cast<iOSVideoToolboxEncoder*>(refcon)->onEncoded(status, sampleBuffer);
+}
+
+static void setSessionNumber(VTCompressionSessionRef session, CFStringRef key, int32_t value) {
+    CFNumberRef number = CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &value);
+    VTSessionSetProperty(session, key, number);
+    CFRelease(number);
+}
+
+iOSVideoToolboxEncoder::~iOSVideoToolboxEncoder() {
+    release();
+}
+
+bool iOSVideoToolboxEncoder::initialize(const EncoderConfig& config) {
+    if (mSession) {
+        return true;
+    }
+    if (config.type != EncoderType::H264 && config.type != EncoderType::H265) {
+        PIPELINE_LOGE("VideoToolbox encoder supports H.264/H.265 only");
+        return false;
+    }
+    if (config.width == 0 || config.height == 0) {
+        return false;
+    }
+
+    // 输入池与 iOSMetalSurface 默认格式一致：BGRA、可被 Metal 直接渲染
+    NSDictionary* sourceAttributes = @{
+        (id)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_32BGRA),
+        (id)kCVPixelBufferWidthKey: @(config.width),
+        (id)kCVPixelBufferHeightKey: @(config.height),
+        (id)kCVPixelBufferMetalCompatibilityKey: @YES,
+        (id)kCVPixelBufferIOSurfacePropertiesKey: @{}
+    };
+
+    const CMVideoCodecType codec = config.type == EncoderType::H265 ?
+        kCMVideoCodecType_HEVC : kCMVideoCodecType_H264;
+    VTCompressionSessionRef session = nullptr;
+    OSStatus status = VTCompressionSessionCreate(
+        kCFAllocatorDefault,
+        static_cast<int32_t>(config.width), static_cast<int32_t>(config.height),
+        codec, nullptr, (__bridge CFDictionaryRef)sourceAttributes, nullptr,
+        compressionOutputCallback, this, &session);
+    if (status != noErr || !session) {
+        PIPELINE_LOGE("VTCompressionSessionCreate failed: %d", static_cast<int>(status));
+        return false;
+    }
+
+    const int32_t frameRate = static_cast<int32_t>(config.frameRate > 0 ? config.frameRate : 30);
+    VTSessionSetProperty(session, kVTCompressionPropertyKey_RealTime, kCFBooleanTrue);
+    // MP4 写入器按显示顺序写样本，关闭帧重排（无 B 帧）
+    VTSessionSetProperty(session, kVTCompressionPropertyKey_AllowFrameReordering, kCFBooleanFalse);
+    setSessionNumber(session, kVTCompressionPropertyKey_AverageBitRate,
+                     static_cast<int32_t>(config.bitrate));
+    setSessionNumber(session, kVTCompressionPropertyKey_ExpectedFrameRate, frameRate);
+    setSessionNumber(session, kVTCompressionPropertyKey_MaxKeyFrameIntervalDuration,
+                     static_cast<int32_t>(config.keyFrameInterval));
+    if (config.type == EncoderType::H264) {
+        CFStringRef profile = kVTProfileLevel_H264_High_AutoLevel;
+        if (config.profile == "baseline") {
+            profile = kVTProfileLevel_H264_Baseline_AutoLevel;
+        } else if (config.profile == "main") {
+            profile = kVTProfileLevel_H264_Main_AutoLevel;
+        }
+        VTSessionSetProperty(session, kVTCompressionPropertyKey_ProfileLevel, profile);
+    } else {
+        VTSessionSetProperty(session, kVTCompressionPropertyKey_ProfileLevel,
+                             kVTProfileLevel_HEVC_Main_AutoLevel);
+    }
+    VTCompressionSessionPrepareToEncodeFrames(session);
+
+    mSession = session;
+    mType = config.type;
+    mConfigQueued = false;
+    mMaxQueued = static_cast<size_t>(frameRate) * 4;
+    PIPELINE_LOGI("VideoToolbox encoder started: %ux%u, %u bps",
+                  config.width, config.height, config.bitrate);
+    return true;
+}
+
+void iOSVideoToolboxEncoder::release() {
+    if (!mSession) {
+        return;
+    }
+    VTCompressionSessionRef session = (VTCompressionSessionRef)mSession;
+    VTCompressionSessionInvalidate(session);
+    CFRelease(session);
+    mSession = nullptr;
+}
+
+void* iOSVideoToolboxEncoder::getPixelBufferPool() const {
+    if (!mSession) {
+        return nullptr;
+    }
+    return VTCompressionSessionGetPixelBufferPool((VTCompressionSessionRef)mSession);
+}
+
+bool iOSVideoToolboxEncoder::encode(void* pixelBuffer, int64_t timestampUs) {
+    if (!mSession || !pixelBuffer) {
+        return false;
+    }
+    OSStatus status = VTCompressionSessionEncodeFrame(
+        (VTCompressionSessionRef)mSession, (CVImageBufferRef)pixelBuffer,
+        CMTimeMake(timestampUs, 1000000), kCMTimeInvalid, nullptr, nullptr, nullptr);
+    if (status != noErr) {
+        PIPELINE_LOGW("VTCompressionSessionEncodeFrame failed: %d", static_cast<int>(status));
+        return false;
+    }
+    return true;
+}
+
+void iOSVideoToolboxEncoder::onEncoded(int32_t status, void* sampleBuffer) {
+    CMSampleBufferRef buffer = (CMSampleBufferRef)sampleBuffer;
+    if (status != noErr || !buffer || !CMSampleBufferDataIsReady(buffer)) {
+        return;
+    }
+
+    QueuedSample config;
+    if (!mConfigQueued) {
+        // 解码配置记录直接取自格式描述的 avcC/hvcC 扩展
+        CMFormatDescriptionRef format = CMSampleBufferGetFormatDescription(buffer);
+        CFDictionaryRef atoms = (CFDictionaryRef)CMFormatDescriptionGetExtension(
+            format, kCMFormatDescriptionExtension_SampleDescriptionExtensionAtoms);
+        CFDataRef record = atoms ? (CFDataRef)CFDictionaryGetValue(
+            atoms, mType == EncoderType::H265 ? CFSTR("hvcC") : CFSTR("avcC")) : nullptr;
+        if (!record) {
+            PIPELINE_LOGW("Encoded sample has no decoder config");
+            return;
+        }
+        const uint8_t* bytes = CFDataGetBytePtr(record);
+        config.data.assign(bytes, bytes + CFDataGetLength(record));
+        config.codecConfig = true;
+        mConfigQueued = true;
+    }
+
+    QueuedSample sample;
+    CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(buffer, false);
+    sample.keyFrame = true;
+    if (attachments && CFArrayGetCount(attachments) > 0) {
+        CFDictionaryRef attachment = (CFDictionaryRef)CFArrayGetValueAtIndex(attachments, 0);
+        sample.keyFrame = !CFDictionaryContainsKey(attachment, kCMSampleAttachmentKey_NotSync);
+    }
+    const CMTime pts = CMSampleBufferGetPresentationTimeStamp(buffer);
+    sample.ptsUs = CMTimeConvertScale(pts, 1000000, kCMTimeRoundingMethod_Default).value;
+
+    // VideoToolbox 输出即 4 字节长度前缀 NAL
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(buffer);
+    const size_t length = CMBlockBufferGetDataLength(block);
+    sample.data.resize(length);
+    if (CMBlockBufferCopyDataBytes(block, 0, length, sample.data.data()) != kCMBlockBufferNoErr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (config.codecConfig) {
+        mQueue.push_back(std::move(config));
+    }
+    if (mWaitKeyFrame && !sample.keyFrame) {
+        ++mDropped;
+        return;
+    }
+    if (mQueue.size() >= mMaxQueued) {
+        ++mDropped;
+        mWaitKeyFrame = true;
+        PIPELINE_LOGW("Encoded sample queue full, dropping until next key frame");
+        return;
+    }
+    mWaitKeyFrame = false;
+    mQueue.push_back(std::move(sample));
+}
+
+size_t iOSVideoToolboxEncoder::drain(const SampleSink& sink) {
+    std::deque<QueuedSample> pending;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        pending.swap(mQueue);
+    }
+    for (const auto& queued : pending) {
+        EncodedSample sample;
+        sample.data = queued.data.data();
+        sample.size = queued.data.size();
+        sample.ptsUs = queued.ptsUs;
+        sample.keyFrame = queued.keyFrame;
+        sample.codecConfig = queued.codecConfig;
+        sink(sample);
+    }
+    return pending.size();
+}
+
+void iOSVideoToolboxEncoder::finish(const SampleSink& sink, int64_t timeoutMs) {
+    (void)timeoutMs;    // CompleteFrames 同步等待已提交的帧全部输出
+    if (mSession) {
+        VTCompressionSessionCompleteFrames((VTCompressionSessionRef)mSession, kCMTimeInvalid);
+    }
+    drain(sink);
+    release();
+
+    if (mDropped > 0) {
+        PIPELINE_LOGW("VideoToolbox encoder dropped %llu samples",
+                      static_cast<unsigned long long>(mDropped));
+    }
+}
+
+} // namespace ios
+} // namespace output
+} // namespace pipeline
+
+#endif // defined(__APPLE__)
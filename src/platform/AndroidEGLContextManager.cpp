@@ -6,6 +6,7 @@
 #ifdef __ANDROID__
 
 #include "pipeline/platform/PlatformContext.h"
+#include "pipeline/data/ExternalImage.h"
 #include <android/log.h>
 
 #define LOG_TAG "AndroidEGLContextManager"
@@ -15,6 +16,11 @@
 
 namespace pipeline {
 
+namespace {
+// 导入缓存上限：相机 buffer 池通常 4~8 个
+constexpr size_t kMaxImportCacheSize = 8;
+} // namespace
+
 // =============================================================================
 // AndroidEGLContextManager 实现
 // =============================================================================
@@ -213,6 +219,69 @@ bool AndroidEGLContextManager::releaseCurrent() {
     return true;
 }
 
+// =============================================================================
+// 传输上下文
+// =============================================================================
+
+bool AndroidEGLContextManager::createTransferContext() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    
+    if (!mInitialized) {
+        LOGE("Not initialized");
+        return false;
+    }
+    if (mTransferContext != EGL_NO_CONTEXT) {
+        return true;
+    }
+    
+    // 上下文不能同时在两个线程生效，传输线程需要自己的 Surface
+    const EGLint pbufferAttribs[] = {
+        EGL_WIDTH, 1,
+        EGL_HEIGHT, 1,
+        EGL_NONE
+    };
+    mTransferSurface = eglCreatePbufferSurface(mDisplay, mConfig, pbufferAttribs);
+    if (mTransferSurface == EGL_NO_SURFACE) {
+        LOGE("eglCreatePbufferSurface (transfer) failed: 0x%x", eglGetError());
+        return false;
+    }
+    
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 3,
+        EGL_NONE
+    };
+    mTransferContext = eglCreateContext(mDisplay, mConfig, mContext, contextAttribs);
+    if (mTransferContext == EGL_NO_CONTEXT) {
+        LOGE("eglCreateContext (transfer) failed: 0x%x", eglGetError());
+        eglDestroySurface(mDisplay, mTransferSurface);
+        mTransferSurface = EGL_NO_SURFACE;
+        return false;
+    }
+    
+    LOGI("Created transfer context: %p (share group of %p)", mTransferContext, mContext);
+    return true;
+}
+
+bool AndroidEGLContextManager::makeTransferCurrent() {
+    if (mTransferContext == EGL_NO_CONTEXT) {
+        LOGE("Transfer context not created");
+        return false;
+    }
+    
+    if (!eglMakeCurrent(mDisplay, mTransferSurface, mTransferSurface, mTransferContext)) {
+        LOGE("eglMakeCurrent (transfer) failed: 0x%x", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+bool AndroidEGLContextManager::releaseTransferCurrent() {
+    if (eglGetCurrentContext() != mTransferContext || mTransferContext == EGL_NO_CONTEXT) {
+        return false;
+    }
+    return eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) == EGL_TRUE;
+}
+
 bool AndroidEGLContextManager::isCurrent() const {
     if (!mInitialized) {
         return false;
@@ -221,7 +290,137 @@ bool AndroidEGLContextManager::isCurrent() const {
     return eglGetCurrentContext() == mContext;
 }
 
+// =============================================================================
+// AHardwareBuffer 零拷贝导入
+// =============================================================================
+
+bool AndroidEGLContextManager::loadImportExtensions() {
+    if (mImportExtensionsLoaded) {
+        return mCreateImage != nullptr;
+    }
+    mImportExtensionsLoaded = true;
+    
+    mGetNativeClientBuffer = reinterpret_cast<PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC>(
+        eglGetProcAddress("eglGetNativeClientBufferANDROID"));
+    mCreateImage = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(
+        eglGetProcAddress("eglCreateImageKHR"));
+    mDestroyImage = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(
+        eglGetProcAddress("eglDestroyImageKHR"));
+    mImageTargetTexture = reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+        eglGetProcAddress("glEGLImageTargetTexture2DOES"));
+    
+    if (!mGetNativeClientBuffer || !mCreateImage || !mDestroyImage || !mImageTargetTexture) {
+        LOGE("AHardwareBuffer import extensions not available");
+        mCreateImage = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void AndroidEGLContextManager::releaseImportedBuffer(const ImportedBuffer& entry) {
+    if (entry.texture != 0) {
+        glDeleteTextures(1, &entry.texture);
+    }
+    if (entry.image != EGL_NO_IMAGE_KHR && mDestroyImage) {
+        mDestroyImage(mDisplay, entry.image);
+    }
+    if (entry.buffer) {
+        AHardwareBuffer_release(entry.buffer);
+    }
+}
+
+std::shared_ptr<const ExternalImage> AndroidEGLContextManager::importHardwareBuffer(
+    AHardwareBuffer* buffer) {
+    
+    if (!buffer) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(mMutex);
+    
+    if (!mInitialized || !loadImportExtensions()) {
+        return nullptr;
+    }
+    
+    AHardwareBuffer_Desc desc = {};
+    AHardwareBuffer_describe(buffer, &desc);
+    
+    std::shared_ptr<ImportedBuffer> entry;
+    for (const auto& cached : mImportCache) {
+        if (cached->buffer == buffer) {
+            entry = cached;
+            break;
+        }
+    }
+    
+    if (!entry) {
+        EGLClientBuffer clientBuffer = mGetNativeClientBuffer(buffer);
+        const EGLint attribs[] = {
+            EGL_IMAGE_PRESERVED_KHR, EGL_TRUE,
+            EGL_NONE
+        };
+        EGLImageKHR image = mCreateImage(mDisplay, EGL_NO_CONTEXT,
+                                         EGL_NATIVE_BUFFER_ANDROID, clientBuffer, attribs);
+        if (image == EGL_NO_IMAGE_KHR) {
+            LOGE("eglCreateImageKHR failed: 0x%x", eglGetError());
+            return nullptr;
+        }
+        
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture);
+        glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        mImageTargetTexture(GL_TEXTURE_EXTERNAL_OES, static_cast<GLeglImageOES>(image));
+        glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
+        
+        // 缓存期间持有 buffer 引用，避免指针被复用
+        AHardwareBuffer_acquire(buffer);
+        entry = std::make_shared<ImportedBuffer>();
+        entry->buffer = buffer;
+        entry->image = image;
+        entry->texture = texture;
+        
+        // 淘汰最早导入且已无数据包引用的项
+        if (mImportCache.size() >= kMaxImportCacheSize) {
+            for (auto it = mImportCache.begin(); it != mImportCache.end(); ++it) {
+                if (it->use_count() == 1) {
+                    releaseImportedBuffer(**it);
+                    mImportCache.erase(it);
+                    break;
+                }
+            }
+        }
+        mImportCache.push_back(entry);
+        LOGD("Imported AHardwareBuffer %p -> texture %u (%ux%u)", buffer, texture, desc.width, desc.height);
+    }
+    
+    auto image = std::make_shared<ExternalImage>();
+    image->format = ExternalImageFormat::External;
+    image->width = desc.width;
+    image->height = desc.height;
+    image->glTarget = GL_TEXTURE_EXTERNAL_OES;
+    image->planeCount = 1;
+    image->planes[0].handle = reinterpret_cast<void*>(static_cast<uintptr_t>(entry->texture));
+    image->planes[0].width = desc.width;
+    image->planes[0].height = desc.height;
+    image->holder = entry;
+    return image;
+}
+
+void AndroidEGLContextManager::clearImportCache() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& entry : mImportCache) {
+        releaseImportedBuffer(*entry);
+    }
+    mImportCache.clear();
+}
+
 void AndroidEGLContextManager::destroy() {
+    clearImportCache();
+    
     std::lock_guard<std::mutex> lock(mMutex);
     
     if (!mInitialized) {
@@ -234,6 +433,16 @@ void AndroidEGLContextManager::destroy() {
     if (mDisplay != EGL_NO_DISPLAY) {
         eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
         
+        // 传输上下文若仍在传输线程生效，EGL 会推迟到其解绑后再真正销毁
+        if (mTransferContext != EGL_NO_CONTEXT) {
+            eglDestroyContext(mDisplay, mTransferContext);
+            mTransferContext = EGL_NO_CONTEXT;
+        }
+        if (mTransferSurface != EGL_NO_SURFACE) {
+            eglDestroySurface(mDisplay, mTransferSurface);
+            mTransferSurface = EGL_NO_SURFACE;
+        }
+        
         if (mContext != EGL_NO_CONTEXT) {
             eglDestroyContext(mDisplay, mContext);
             mContext = EGL_NO_CONTEXT;
@@ -0,0 +1,108 @@
+/**
+ * @file AndroidThermalMonitor.cpp
+ * @brief Android 平台温控监听（AThermal，对应 PowerManager.getCurrentThermalStatus）
+ *
+ * NDK 的 AThermal 接口自 API 30 起提供；更低版本返回 nullptr，
+ * 由应用层经 PowerManager.OnThermalStatusChangedListener 调用 onThermalStateChanged 转发。
+ */
+
+#ifdef __ANDROID__
+
+#include "pipeline/core/QualityController.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <android/api-level.h>
+
+#if __ANDROID_API__ >= 30
+#include <android/thermal.h>
+#endif
+
+namespace pipeline {
+
+#if __ANDROID_API__ >= 30
+
+namespace {
+
+ThermalState toThermalState(AThermalStatus status) {
+    switch (status) {
+        case ATHERMAL_STATUS_LIGHT:
+        case ATHERMAL_STATUS_MODERATE:
+            return ThermalState::Fair;
+        case ATHERMAL_STATUS_SEVERE:
+            return ThermalState::Serious;
+        case ATHERMAL_STATUS_CRITICAL:
+        case ATHERMAL_STATUS_EMERGENCY:
+        case ATHERMAL_STATUS_SHUTDOWN:
+            return ThermalState::Critical;
+        default:
+            return ThermalState::Nominal;
+    }
+}
+
+class AndroidThermalMonitor : public ThermalMonitor {
+public:
+    ~AndroidThermalMonitor() override {
+        stop();
+    }
+
+    bool start(ThermalCallback callback) override {
+        if (mManager) {
+            return false;
+        }
+        mManager = AThermal_acquireManager();
+        if (!mManager) {
+            PIPELINE_LOGW("AThermal manager unavailable");
+            return false;
+        }
+        mCallback = std::move(callback);
+
+        // 注册时系统会立即回调一次当前状态
+        if (AThermal_registerThermalStatusListener(mManager, &AndroidThermalMonitor::onStatus, this) != 0) {
+            AThermal_releaseManager(mManager);
+            mManager = nullptr;
+            mCallback = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void stop() override {
+        if (!mManager) {
+            return;
+        }
+        // 注销在系统侧与回调互斥，返回后不会再进入
+        AThermal_unregisterThermalStatusListener(mManager, &AndroidThermalMonitor::onStatus, this);
+        AThermal_releaseManager(mManager);
+        mManager = nullptr;
+        mCallback = nullptr;
+    }
+
+private:
+    static void onStatus(void* data, AThermalStatus status) {
+        auto* self = static_cast<AndroidThermalMonitor*>(data);
+        if (self->mCallback) {
+            self->mCallback(toThermalState(status));
+        }
+    }
+
+    AThermalManager* mManager = nullptr;
+    ThermalCallback mCallback;
+};
+
+} // anonymous namespace
+
+std::unique_ptr<ThermalMonitor> createPlatformThermalMonitor() {
+    return std::unique_ptr<ThermalMonitor>(new AndroidThermalMonitor());
+}
+
+#else
+
+std::unique_ptr<ThermalMonitor> createPlatformThermalMonitor() {
+    return nullptr;
+}
+
+#endif // __ANDROID_API__ >= 30
+
+} // namespace pipeline
+
+#endif // __ANDROID__
@@ -0,0 +1,119 @@
+/**
+ * @file EGLSyncFence.cpp
+ * @brief GpuFence 的 EGL 实现（EGL_KHR_fence_sync / EGL_KHR_wait_sync）
+ *
+ * EGL 同步对象属于 display，可被同一 display 下的任意线程与上下文等待。
+ */
+
+#ifdef __ANDROID__
+
+#include "pipeline/data/GpuFence.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+
+namespace pipeline {
+
+namespace {
+
+struct EGLSyncFunctions {
+    PFNEGLCREATESYNCKHRPROC createSync = nullptr;
+    PFNEGLDESTROYSYNCKHRPROC destroySync = nullptr;
+    PFNEGLCLIENTWAITSYNCKHRPROC clientWaitSync = nullptr;
+    PFNEGLGETSYNCATTRIBKHRPROC getSyncAttrib = nullptr;
+    PFNEGLWAITSYNCKHRPROC waitSync = nullptr;     // 可选（EGL_KHR_wait_sync）
+
+    bool available() const {
+        return createSync && destroySync && clientWaitSync && getSyncAttrib;
+    }
+};
+
+const EGLSyncFunctions& syncFunctions() {
+    static const EGLSyncFunctions functions = []() {
+        EGLSyncFunctions f;
+        f.createSync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+        f.destroySync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+        f.clientWaitSync = reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(eglGetProcAddress("eglClientWaitSyncKHR"));
+        f.getSyncAttrib = reinterpret_cast<PFNEGLGETSYNCATTRIBKHRPROC>(eglGetProcAddress("eglGetSyncAttribKHR"));
+        f.waitSync = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(eglGetProcAddress("eglWaitSyncKHR"));
+        if (!f.available()) {
+            PIPELINE_LOGW("EGL_KHR_fence_sync not available, GPU fences disabled");
+        }
+        return f;
+    }();
+    return functions;
+}
+
+class EGLSyncFence : public GpuFence {
+public:
+    EGLSyncFence(EGLDisplay display, EGLSyncKHR sync)
+        : mDisplay(display)
+        , mSync(sync)
+    {
+    }
+
+    ~EGLSyncFence() override {
+        syncFunctions().destroySync(mDisplay, mSync);
+    }
+
+    bool wait(int64_t timeoutMs) override {
+        EGLTimeKHR timeout = timeoutMs < 0
+            ? EGL_FOREVER_KHR
+            : static_cast<EGLTimeKHR>(timeoutMs) * 1000000ull;
+        // 生产者已 glFlush，这里不再需要 EGL_SYNC_FLUSH_COMMANDS_BIT_KHR（也不能刷新别的上下文）
+        EGLint result = syncFunctions().clientWaitSync(mDisplay, mSync, 0, timeout);
+        if (result == EGL_FALSE) {
+            PIPELINE_LOGE("eglClientWaitSyncKHR failed: 0x%x", eglGetError());
+            return false;
+        }
+        return result == EGL_CONDITION_SATISFIED_KHR;
+    }
+
+    bool isSignaled() const override {
+        EGLint status = EGL_UNSIGNALED_KHR;
+        syncFunctions().getSyncAttrib(mDisplay, mSync, EGL_SYNC_STATUS_KHR, &status);
+        return status == EGL_SIGNALED_KHR;
+    }
+
+    void waitOnGPU() override {
+        if (syncFunctions().waitSync) {
+            syncFunctions().waitSync(mDisplay, mSync, 0);
+        } else {
+            wait(-1);
+        }
+    }
+
+private:
+    EGLDisplay mDisplay;
+    EGLSyncKHR mSync;
+};
+
+} // namespace
+
+GpuFencePtr createEGLSyncFence() {
+    const auto& functions = syncFunctions();
+    if (!functions.available()) {
+        return nullptr;
+    }
+
+    EGLDisplay display = eglGetCurrentDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        return nullptr;
+    }
+
+    EGLSyncKHR sync = functions.createSync(display, EGL_SYNC_FENCE_KHR, nullptr);
+    if (sync == EGL_NO_SYNC_KHR) {
+        PIPELINE_LOGE("eglCreateSyncKHR failed: 0x%x", eglGetError());
+        return nullptr;
+    }
+
+    // 提交栅栏，否则其他线程/上下文的等待可能永不返回
+    glFlush();
+    return std::make_shared<EGLSyncFence>(display, sync);
+}
+
+} // namespace pipeline
+
+#endif // __ANDROID__
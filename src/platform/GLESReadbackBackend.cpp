@@ -0,0 +1,165 @@
+/**
+ * @file GLESReadbackBackend.cpp
+ * @brief GLES 异步读回后端 - PBO 环 + glFenceSync
+ *
+ * glReadPixels 写入绑定的 GL_PIXEL_PACK_BUFFER 时立即返回，拷贝由驱动异步完成；
+ * 同步对象 signal 后 glMapBufferRange 不再阻塞。
+ */
+
+#ifdef __ANDROID__
+
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/utils/PipelineLog.h"
+#include "lrengine/core/LRTexture.h"
+
+#include <GLES3/gl3.h>
+#include <cstring>
+#include <vector>
+
+namespace pipeline {
+
+namespace {
+
+class GLESReadbackBackend : public ReadbackBackend {
+public:
+    explicit GLESReadbackBackend(uint32_t slotCount)
+        : mSlots(slotCount > 0 ? slotCount : 1)
+    {
+    }
+
+    ~GLESReadbackBackend() override = default;
+
+    bool begin(uint32_t slot, lrengine::render::LRTexture& texture,
+               uint32_t width, uint32_t height, uint32_t stride, size_t bytes) override {
+        // 仅支持紧密排列的 RGBA8
+        if (slot >= mSlots.size() || stride != width * 4) {
+            return false;
+        }
+        Slot& entry = mSlots[slot];
+
+        // 纹理原生句柄在 GLES 后端中携带 GL 纹理名
+        auto textureId = static_cast<GLuint>(
+            reinterpret_cast<uintptr_t>(texture.GetNativeHandle().ptr));
+        if (textureId == 0) {
+            return false;
+        }
+
+        if (mFramebuffer == 0) {
+            glGenFramebuffers(1, &mFramebuffer);
+        }
+        if (entry.pbo == 0) {
+            glGenBuffers(1, &entry.pbo);
+        }
+        if (entry.capacity < bytes) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, entry.pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+            entry.capacity = bytes;
+        }
+
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, mFramebuffer);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, textureId, 0);
+        if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+            PIPELINE_LOGE("Readback framebuffer incomplete (texture %u)", textureId);
+            return false;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, entry.pbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+
+        if (entry.fence) {
+            glDeleteSync(entry.fence);
+        }
+        entry.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // 确保 fence 提交到GPU，否则其他线程的等待可能永不返回
+        glFlush();
+        return entry.fence != nullptr;
+    }
+
+    bool isComplete(uint32_t slot) override {
+        if (slot >= mSlots.size() || !mSlots[slot].fence) {
+            return false;
+        }
+        GLint status = GL_UNSIGNALED;
+        glGetSynciv(mSlots[slot].fence, GL_SYNC_STATUS, 1, nullptr, &status);
+        return status == GL_SIGNALED;
+    }
+
+    void waitComplete(uint32_t slot) override {
+        if (slot >= mSlots.size() || !mSlots[slot].fence) {
+            return;
+        }
+        glClientWaitSync(mSlots[slot].fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+
+    bool read(uint32_t slot, uint8_t* dst, size_t bytes) override {
+        if (slot >= mSlots.size() || !dst) {
+            return false;
+        }
+        Slot& entry = mSlots[slot];
+        if (entry.pbo == 0 || entry.capacity < bytes) {
+            return false;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, entry.pbo);
+        void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                        static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+        bool ok = mapped != nullptr;
+        if (ok) {
+            std::memcpy(dst, mapped, bytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (entry.fence) {
+            glDeleteSync(entry.fence);
+            entry.fence = nullptr;
+        }
+        return ok;
+    }
+
+    void release() override {
+        for (auto& entry : mSlots) {
+            if (entry.fence) {
+                glDeleteSync(entry.fence);
+                entry.fence = nullptr;
+            }
+            if (entry.pbo != 0) {
+                glDeleteBuffers(1, &entry.pbo);
+                entry.pbo = 0;
+            }
+            entry.capacity = 0;
+        }
+        if (mFramebuffer != 0) {
+            glDeleteFramebuffers(1, &mFramebuffer);
+            mFramebuffer = 0;
+        }
+    }
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        size_t capacity = 0;
+    };
+
+    std::vector<Slot> mSlots;
+    GLuint mFramebuffer = 0;
+};
+
+} // namespace
+
+std::unique_ptr<ReadbackBackend> createGLESReadbackBackend(uint32_t slotCount) {
+    return std::make_unique<GLESReadbackBackend>(slotCount);
+}
+
+} // namespace pipeline
+
+#endif // __ANDROID__
@@ -0,0 +1,462 @@
+/**
+ * @file HeadlessEGLContextManager.cpp
+ * @brief Linux 无窗口 EGL 上下文管理器实现
+ */
+
+#if defined(PIPELINE_HEADLESS_EGL)
+
+#include "pipeline/platform/PlatformContext.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(PIPELINE_HAS_GBM)
+#include <fcntl.h>
+#include <gbm.h>
+#include <unistd.h>
+#endif
+
+namespace pipeline {
+
+namespace {
+
+// 同一显示可能被多个管理器共用（同一 GPU 上的多路并行渲染），
+// eglTerminate 会使该显示上所有上下文失效，因此按引用计数初始化/终止
+std::mutex s_displayMutex;
+std::unordered_map<EGLDisplay, int32_t> s_displayRefs;
+
+bool retainDisplay(EGLDisplay display) {
+    std::lock_guard<std::mutex> lock(s_displayMutex);
+    int32_t& refs = s_displayRefs[display];
+    if (refs == 0) {
+        EGLint major = 0;
+        EGLint minor = 0;
+        if (!eglInitialize(display, &major, &minor)) {
+            PIPELINE_LOGE("eglInitialize failed: 0x%x", eglGetError());
+            s_displayRefs.erase(display);
+            return false;
+        }
+        PIPELINE_LOGI("EGL display %p initialized: version %d.%d", display, major, minor);
+    }
+    ++refs;
+    return true;
+}
+
+void releaseDisplay(EGLDisplay display) {
+    std::lock_guard<std::mutex> lock(s_displayMutex);
+    auto it = s_displayRefs.find(display);
+    if (it == s_displayRefs.end()) {
+        return;
+    }
+    if (--it->second == 0) {
+        eglTerminate(display);
+        s_displayRefs.erase(it);
+    }
+}
+
+bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions || !name) {
+        return false;
+    }
+    const size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        const bool startOk = p == extensions || p[-1] == ' ';
+        const bool endOk = p[length] == ' ' || p[length] == '\0';
+        if (startOk && endOk) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* clientExtensions() {
+    // 不支持 EGL_EXT_client_extensions 时返回 nullptr（并产生一个可忽略的 EGL 错误）
+    return eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+}
+
+const char* kBackendNames[] = {"Auto", "Device", "GBM", "Surfaceless", "Default"};
+
+} // anonymous namespace
+
+// =============================================================================
+// 构造与销毁
+// =============================================================================
+
+HeadlessEGLContextManager::HeadlessEGLContextManager() = default;
+
+HeadlessEGLContextManager::~HeadlessEGLContextManager() {
+    destroy();
+}
+
+int32_t HeadlessEGLContextManager::queryDeviceCount() {
+    if (!hasExtension(clientExtensions(), "EGL_EXT_device_enumeration")) {
+        return 0;
+    }
+    auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+        eglGetProcAddress("eglQueryDevicesEXT"));
+    EGLint count = 0;
+    if (!queryDevices || !queryDevices(0, nullptr, &count)) {
+        return 0;
+    }
+    return count;
+}
+
+// =============================================================================
+// 显示选择
+// =============================================================================
+
+bool HeadlessEGLContextManager::openPlatformDisplay(EGLenum platform, void* nativeDisplay) {
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (!getPlatformDisplay) {
+        return false;
+    }
+    EGLDisplay display = getPlatformDisplay(platform, nativeDisplay, nullptr);
+    if (display == EGL_NO_DISPLAY || !retainDisplay(display)) {
+        return false;
+    }
+    mDisplay = display;
+    return true;
+}
+
+bool HeadlessEGLContextManager::openDeviceDisplay(int32_t deviceIndex) {
+    const char* extensions = clientExtensions();
+    if (!hasExtension(extensions, "EGL_EXT_platform_device") ||
+        !hasExtension(extensions, "EGL_EXT_device_enumeration")) {
+        return false;
+    }
+
+    auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+        eglGetProcAddress("eglQueryDevicesEXT"));
+    EGLint count = 0;
+    if (!queryDevices || !queryDevices(0, nullptr, &count) || count <= 0) {
+        return false;
+    }
+    std::vector<EGLDeviceEXT> devices(static_cast<size_t>(count));
+    if (!queryDevices(count, devices.data(), &count) || deviceIndex < 0 || deviceIndex >= count) {
+        PIPELINE_LOGW("EGL device %d not available (%d devices)", deviceIndex, count);
+        return false;
+    }
+    return openPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[static_cast<size_t>(deviceIndex)]);
+}
+
+bool HeadlessEGLContextManager::openGBMDisplay(const Config& config) {
+#if defined(PIPELINE_HAS_GBM)
+    if (!hasExtension(clientExtensions(), "EGL_KHR_platform_gbm") &&
+        !hasExtension(clientExtensions(), "EGL_MESA_platform_gbm")) {
+        return false;
+    }
+
+    std::string node = config.renderNode
+        ? config.renderNode
+        : "/dev/dri/renderD" + std::to_string(128 + config.deviceIndex);
+    mDrmFd = ::open(node.c_str(), O_RDWR | O_CLOEXEC);
+    if (mDrmFd < 0) {
+        PIPELINE_LOGW("Failed to open render node %s", node.c_str());
+        return false;
+    }
+    mGbmDevice = gbm_create_device(mDrmFd);
+    if (!mGbmDevice) {
+        ::close(mDrmFd);
+        mDrmFd = -1;
+        return false;
+    }
+    if (!openPlatformDisplay(EGL_PLATFORM_GBM_KHR, mGbmDevice)) {
+        gbm_device_destroy(static_cast<gbm_device*>(mGbmDevice));
+        mGbmDevice = nullptr;
+        ::close(mDrmFd);
+        mDrmFd = -1;
+        return false;
+    }
+    return true;
+#else
+    (void)config;
+    return false;
+#endif
+}
+
+bool HeadlessEGLContextManager::openDisplay(const Config& config) {
+    using Backend = DisplayBackend;
+    const Backend order[] = {Backend::Device, Backend::GBM, Backend::Surfaceless, Backend::Default};
+
+    for (Backend candidate : order) {
+        if (config.backend != Backend::Auto && config.backend != candidate) {
+            continue;
+        }
+
+        bool opened = false;
+        switch (candidate) {
+            case Backend::Device:
+                opened = openDeviceDisplay(config.deviceIndex);
+                break;
+            case Backend::GBM:
+                opened = openGBMDisplay(config);
+                break;
+            case Backend::Surfaceless:
+                opened = hasExtension(clientExtensions(), "EGL_MESA_platform_surfaceless") &&
+                         openPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY);
+                break;
+            case Backend::Default: {
+                EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+                opened = display != EGL_NO_DISPLAY && retainDisplay(display);
+                if (opened) {
+                    mDisplay = display;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (opened) {
+            mActiveBackend = candidate;
+            PIPELINE_LOGI("Headless EGL display opened via %s backend",
+                          kBackendNames[static_cast<size_t>(candidate)]);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HeadlessEGLContextManager::closeDisplay() {
+    if (mDisplay != EGL_NO_DISPLAY) {
+        releaseDisplay(mDisplay);
+        mDisplay = EGL_NO_DISPLAY;
+    }
+#if defined(PIPELINE_HAS_GBM)
+    if (mGbmDevice) {
+        gbm_device_destroy(static_cast<gbm_device*>(mGbmDevice));
+        mGbmDevice = nullptr;
+    }
+    if (mDrmFd >= 0) {
+        ::close(mDrmFd);
+        mDrmFd = -1;
+    }
+#endif
+}
+
+// =============================================================================
+// 上下文
+// =============================================================================
+
+bool HeadlessEGLContextManager::initialize(const Config& config) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mInitialized) {
+        PIPELINE_LOGD("HeadlessEGLContextManager already initialized");
+        return true;
+    }
+
+    mSettings = config;
+    if (!openDisplay(config)) {
+        PIPELINE_LOGE("No headless EGL display available");
+        return false;
+    }
+
+    if (!eglBindAPI(config.desktopGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API)) {
+        PIPELINE_LOGE("eglBindAPI failed: 0x%x", eglGetError());
+        closeDisplay();
+        return false;
+    }
+
+    const bool surfaceless = hasExtension(eglQueryString(mDisplay, EGL_EXTENSIONS),
+                                          "EGL_KHR_surfaceless_context");
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, config.desktopGL ? EGL_OPENGL_BIT : EGL_OPENGL_ES3_BIT,
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(mDisplay, configAttribs, &mConfig, 1, &numConfigs) || numConfigs == 0) {
+        PIPELINE_LOGE("eglChooseConfig failed: 0x%x", eglGetError());
+        closeDisplay();
+        return false;
+    }
+
+    if (!surfaceless) {
+        const EGLint pbufferAttribs[] = {
+            EGL_WIDTH, config.pbufferWidth,
+            EGL_HEIGHT, config.pbufferHeight,
+            EGL_NONE
+        };
+        mSurface = eglCreatePbufferSurface(mDisplay, mConfig, pbufferAttribs);
+        if (mSurface == EGL_NO_SURFACE) {
+            PIPELINE_LOGE("eglCreatePbufferSurface failed: 0x%x", eglGetError());
+            closeDisplay();
+            return false;
+        }
+    }
+
+    std::vector<EGLint> contextAttribs = {
+        EGL_CONTEXT_MAJOR_VERSION, config.glMajorVersion,
+        EGL_CONTEXT_MINOR_VERSION, config.desktopGL ? config.glMinorVersion : 0,
+    };
+    if (config.desktopGL) {
+        contextAttribs.push_back(EGL_CONTEXT_OPENGL_PROFILE_MASK);
+        contextAttribs.push_back(EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT);
+    }
+    if (config.enableDebug) {
+        contextAttribs.push_back(EGL_CONTEXT_OPENGL_DEBUG);
+        contextAttribs.push_back(EGL_TRUE);
+    }
+    contextAttribs.push_back(EGL_NONE);
+
+    mContext = eglCreateContext(mDisplay, mConfig, config.sharedContext, contextAttribs.data());
+    if (mContext == EGL_NO_CONTEXT) {
+        PIPELINE_LOGE("eglCreateContext failed: 0x%x", eglGetError());
+        if (mSurface != EGL_NO_SURFACE) {
+            eglDestroySurface(mDisplay, mSurface);
+            mSurface = EGL_NO_SURFACE;
+        }
+        closeDisplay();
+        return false;
+    }
+
+    mInitialized = true;
+    PIPELINE_LOGI("Headless EGL context created (%s %d.%d, %s)",
+                  config.desktopGL ? "OpenGL" : "OpenGL ES",
+                  config.glMajorVersion, config.desktopGL ? config.glMinorVersion : 0,
+                  surfaceless ? "surfaceless" : "pbuffer");
+    return true;
+}
+
+EGLContext HeadlessEGLContextManager::createSharedContext(EGLContext sourceContext) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mInitialized) {
+        PIPELINE_LOGE("HeadlessEGLContextManager not initialized");
+        return EGL_NO_CONTEXT;
+    }
+
+    // eglBindAPI 是线程状态，创建线程可能不是初始化线程
+    eglBindAPI(mSettings.desktopGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API);
+
+    std::vector<EGLint> contextAttribs = {
+        EGL_CONTEXT_MAJOR_VERSION, mSettings.glMajorVersion,
+        EGL_CONTEXT_MINOR_VERSION, mSettings.desktopGL ? mSettings.glMinorVersion : 0,
+    };
+    if (mSettings.desktopGL) {
+        contextAttribs.push_back(EGL_CONTEXT_OPENGL_PROFILE_MASK);
+        contextAttribs.push_back(EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT);
+    }
+    contextAttribs.push_back(EGL_NONE);
+
+    EGLContext shared = eglCreateContext(mDisplay, mConfig,
+                                         sourceContext != EGL_NO_CONTEXT ? sourceContext : mContext,
+                                         contextAttribs.data());
+    if (shared == EGL_NO_CONTEXT) {
+        PIPELINE_LOGE("eglCreateContext (shared) failed: 0x%x", eglGetError());
+    }
+    return shared;
+}
+
+bool HeadlessEGLContextManager::makeCurrent() {
+    if (!mInitialized) {
+        PIPELINE_LOGE("HeadlessEGLContextManager not initialized");
+        return false;
+    }
+    if (!eglMakeCurrent(mDisplay, mSurface, mSurface, mContext)) {
+        PIPELINE_LOGE("eglMakeCurrent failed: 0x%x", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessEGLContextManager::releaseCurrent() {
+    if (!mInitialized) {
+        return false;
+    }
+    if (!eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT)) {
+        PIPELINE_LOGE("eglMakeCurrent (release) failed: 0x%x", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessEGLContextManager::isCurrent() const {
+    return mInitialized && eglGetCurrentContext() == mContext;
+}
+
+bool HeadlessEGLContextManager::createTransferContext() {
+    if (mTransferContext != EGL_NO_CONTEXT) {
+        return true;
+    }
+    EGLContext context = createSharedContext(EGL_NO_CONTEXT);
+    if (context == EGL_NO_CONTEXT) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    // 主上下文用 PBuffer 时传输上下文也需要自己的一份（同一 Surface 不能在两个线程同时绑定）
+    if (mSurface != EGL_NO_SURFACE) {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        mTransferSurface = eglCreatePbufferSurface(mDisplay, mConfig, pbufferAttribs);
+        if (mTransferSurface == EGL_NO_SURFACE) {
+            PIPELINE_LOGE("eglCreatePbufferSurface (transfer) failed: 0x%x", eglGetError());
+            eglDestroyContext(mDisplay, context);
+            return false;
+        }
+    }
+    mTransferContext = context;
+    return true;
+}
+
+bool HeadlessEGLContextManager::makeTransferCurrent() {
+    if (mTransferContext == EGL_NO_CONTEXT) {
+        PIPELINE_LOGE("Transfer context not created");
+        return false;
+    }
+    eglBindAPI(mSettings.desktopGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API);
+    if (!eglMakeCurrent(mDisplay, mTransferSurface, mTransferSurface, mTransferContext)) {
+        PIPELINE_LOGE("eglMakeCurrent (transfer) failed: 0x%x", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessEGLContextManager::releaseTransferCurrent() {
+    if (mTransferContext == EGL_NO_CONTEXT || eglGetCurrentContext() != mTransferContext) {
+        return false;
+    }
+    return eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) == EGL_TRUE;
+}
+
+void HeadlessEGLContextManager::destroy() {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mDisplay != EGL_NO_DISPLAY) {
+        if (eglGetCurrentContext() == mContext) {
+            eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+        if (mTransferContext != EGL_NO_CONTEXT) {
+            eglDestroyContext(mDisplay, mTransferContext);
+        }
+        if (mTransferSurface != EGL_NO_SURFACE) {
+            eglDestroySurface(mDisplay, mTransferSurface);
+        }
+        if (mContext != EGL_NO_CONTEXT) {
+            eglDestroyContext(mDisplay, mContext);
+        }
+        if (mSurface != EGL_NO_SURFACE) {
+            eglDestroySurface(mDisplay, mSurface);
+        }
+    }
+    mTransferContext = EGL_NO_CONTEXT;
+    mTransferSurface = EGL_NO_SURFACE;
+    mContext = EGL_NO_CONTEXT;
+    mSurface = EGL_NO_SURFACE;
+    mConfig = nullptr;
+    closeDisplay();
+    mInitialized = false;
+}
+
+} // namespace pipeline
+
+#endif // PIPELINE_HEADLESS_EGL
@@ -8,12 +8,15 @@
 #import <Foundation/Foundation.h>
 #import <Metal/Metal.h>
 #import <CoreVideo/CoreVideo.h>
+#import <simd/simd.h>
 
 #include "pipeline/platform/PlatformContext.h"
+#include "pipeline/data/ExternalImage.h"
 #include "pipeline/utils/PipelineLog.h"
 #include "lrengine/utils/ImageBuffer.h"
 #include "lrengine/core/LRPlanarTexture.h"
 #include "lrengine/core/LRRenderContext.h"
+#include <algorithm>
 #include <iostream>
 
 namespace pipeline {
@@ -252,12 +255,263 @@ std::shared_ptr<lrengine::render::LRPlanarTexture> IOSMetalContextManager::creat
     }
 }
 
+namespace {
+
+// 导入图像的资源持有者：CVMetalTexture 释放前其 MTLTexture 才保持有效
+struct PixelBufferImport {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    CVMetalTextureRef planes[ExternalImage::kMaxPlanes] = {};
+    
+    ~PixelBufferImport() {
+        for (CVMetalTextureRef plane : planes) {
+            if (plane) {
+                CFRelease(plane);
+            }
+        }
+        if (pixelBuffer) {
+            CVPixelBufferRelease(pixelBuffer);
+        }
+    }
+};
+
+} // namespace
+
+std::shared_ptr<const ExternalImage> IOSMetalContextManager::importPixelBuffer(
+    CVPixelBufferRef pixelBuffer) {
+    
+    if (!mInitialized || !mTextureCache || !pixelBuffer) {
+        return nullptr;
+    }
+    
+    OSType pixelFormat = CVPixelBufferGetPixelFormatType(pixelBuffer);
+    
+    auto image = std::make_shared<ExternalImage>();
+    image->width = static_cast<uint32_t>(CVPixelBufferGetWidth(pixelBuffer));
+    image->height = static_cast<uint32_t>(CVPixelBufferGetHeight(pixelBuffer));
+    
+    MTLPixelFormat planeFormats[ExternalImage::kMaxPlanes] = {};
+    if (pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange ||
+        pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange) {
+        // 色彩标准与 createTextureFromPixelBuffer 保持一致
+        bool fullRange = (pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange);
+        image->format = ExternalImageFormat::NV12;
+        image->colorSpace = fullRange ? YUVColorSpace::BT601 : YUVColorSpace::BT709;
+        image->fullRange = fullRange;
+        image->planeCount = 2;
+        planeFormats[0] = MTLPixelFormatR8Unorm;
+        planeFormats[1] = MTLPixelFormatRG8Unorm;
+    } else if (pixelFormat == kCVPixelFormatType_32BGRA) {
+        image->format = ExternalImageFormat::BGRA;
+        image->planeCount = 1;
+        planeFormats[0] = MTLPixelFormatBGRA8Unorm;
+    } else {
+        PIPELINE_LOGD("importPixelBuffer: unsupported format 0x%x", pixelFormat);
+        return nullptr;
+    }
+    
+    auto holder = std::make_shared<PixelBufferImport>();
+    holder->pixelBuffer = CVPixelBufferRetain(pixelBuffer);
+    
+    std::lock_guard<std::mutex> lock(mMutex);
+    
+    auto cache = static_cast<CVMetalTextureCacheRef>(mTextureCache);
+    for (uint32_t i = 0; i < image->planeCount; ++i) {
+        size_t planeWidth = image->planeCount > 1 ? CVPixelBufferGetWidthOfPlane(pixelBuffer, i)
+                                                  : CVPixelBufferGetWidth(pixelBuffer);
+        size_t planeHeight = image->planeCount > 1 ? CVPixelBufferGetHeightOfPlane(pixelBuffer, i)
+                                                   : CVPixelBufferGetHeight(pixelBuffer);
+        
+        CVReturn status = CVMetalTextureCacheCreateTextureFromImage(
+            kCFAllocatorDefault, cache, pixelBuffer, nullptr,
+            planeFormats[i], planeWidth, planeHeight, i, &holder->planes[i]);
+        
+        if (status != kCVReturnSuccess || !holder->planes[i]) {
+            PIPELINE_LOGE("CVMetalTextureCacheCreateTextureFromImage failed (plane %u): %d", i, status);
+            return nullptr;
+        }
+        
+        image->planes[i].handle = (__bridge void*)CVMetalTextureGetTexture(holder->planes[i]);
+        image->planes[i].width = static_cast<uint32_t>(planeWidth);
+        image->planes[i].height = static_cast<uint32_t>(planeHeight);
+    }
+    
+    image->holder = std::move(holder);
+    return image;
+}
+
+namespace {
+
+// 输出池同时在外的缓冲上限（编码/回调通常持有 2-3 个）
+constexpr int kPooledPixelBufferLimit = 6;
+
+// RGBA → BGRA / NV12 转换着色器；采样按目标像素中心取双线性，尺寸不同时顺带缩放。
+// 源纹理通道顺序与 iOSMetalSurface 显示着色器一致（BGRA 数据存于 RGBA 纹理，采样后交换）。
+NSString* const kConvertShaderSource = @R"(
+#include <metal_stdlib>
+using namespace metal;
+
+constexpr sampler kLinear(coord::normalized, address::clamp_to_edge, filter::linear);
+
+struct ConvertParams {
+    float4 yCoeff;      // rgb 权重 + 偏移
+    float4 cbCoeff;
+    float4 crCoeff;
+};
+
+static float3 fetchRGB(texture2d<float, access::sample> src, uint2 gid, uint2 size) {
+    float2 uv = (float2(gid) + 0.5) / float2(size);
+    return src.sample(kLinear, uv).bgr;
+}
+
+kernel void convertToBGRA(texture2d<float, access::sample> src [[texture(0)]],
+                          texture2d<float, access::write> dst [[texture(1)]],
+                          uint2 gid [[thread_position_in_grid]]) {
+    uint2 size = uint2(dst.get_width(), dst.get_height());
+    if (gid.x >= size.x || gid.y >= size.y) {
+        return;
+    }
+    dst.write(float4(fetchRGB(src, gid, size), 1.0), gid);
+}
+
+kernel void convertToLuma(texture2d<float, access::sample> src [[texture(0)]],
+                          texture2d<float, access::write> dst [[texture(1)]],
+                          constant ConvertParams& params [[buffer(0)]],
+                          uint2 gid [[thread_position_in_grid]]) {
+    uint2 size = uint2(dst.get_width(), dst.get_height());
+    if (gid.x >= size.x || gid.y >= size.y) {
+        return;
+    }
+    float3 rgb = fetchRGB(src, gid, size);
+    dst.write(float4(dot(rgb, params.yCoeff.xyz) + params.yCoeff.w), gid);
+}
+
+// 色度平面半分辨率：采样点落在 2x2 亮度块中心，双线性即为四点平均
+kernel void convertToChroma(texture2d<float, access::sample> src [[texture(0)]],
+                            texture2d<float, access::write> dst [[texture(1)]],
+                            constant ConvertParams& params [[buffer(0)]],
+                            uint2 gid [[thread_position_in_grid]]) {
+    uint2 size = uint2(dst.get_width(), dst.get_height());
+    if (gid.x >= size.x || gid.y >= size.y) {
+        return;
+    }
+    float3 rgb = fetchRGB(src, gid, size);
+    float cb = dot(rgb, params.cbCoeff.xyz) + params.cbCoeff.w;
+    float cr = dot(rgb, params.crCoeff.xyz) + params.crCoeff.w;
+    dst.write(float4(cb, cr, 0.0, 0.0), gid);
+}
+)";
+
+// 与 ConvertParams 布局一致
+struct ConvertParams {
+    simd_float4 yCoeff;
+    simd_float4 cbCoeff;
+    simd_float4 crCoeff;
+};
+
+// 色彩标准与 importPixelBuffer 的约定相同：Full Range 按 BT.601，Video Range 按 BT.709
+ConvertParams makeConvertParams(bool fullRange) {
+    ConvertParams params;
+    if (fullRange) {
+        params.yCoeff  = simd_make_float4( 0.299000f,  0.587000f,  0.114000f, 0.0f);
+        params.cbCoeff = simd_make_float4(-0.168736f, -0.331264f,  0.500000f, 0.5f);
+        params.crCoeff = simd_make_float4( 0.500000f, -0.418688f, -0.081312f, 0.5f);
+    } else {
+        const float ys = 219.0f / 255.0f;
+        const float cs = 224.0f / 255.0f;
+        params.yCoeff  = simd_make_float4( 0.2126f * ys,  0.7152f * ys,  0.0722f * ys, 16.0f / 255.0f);
+        params.cbCoeff = simd_make_float4(-0.1146f * cs, -0.3854f * cs,  0.5000f * cs, 0.5f);
+        params.crCoeff = simd_make_float4( 0.5000f * cs, -0.4542f * cs, -0.0458f * cs, 0.5f);
+    }
+    return params;
+}
+
+void dispatchConvert(id<MTLComputeCommandEncoder> encoder, id<MTLComputePipelineState> pipeline,
+                     id<MTLTexture> dst) {
+    [encoder setComputePipelineState:pipeline];
+    [encoder setTexture:dst atIndex:1];
+    const NSUInteger w = pipeline.threadExecutionWidth;
+    const NSUInteger h = std::max<NSUInteger>(1, pipeline.maxTotalThreadsPerThreadgroup / w);
+    MTLSize group = MTLSizeMake(w, h, 1);
+    MTLSize groups = MTLSizeMake((dst.width + w - 1) / w, (dst.height + h - 1) / h, 1);
+    [encoder dispatchThreadgroups:groups threadsPerThreadgroup:group];
+}
+
+// 在途的目标平面纹理，GPU 完成前必须保持
+struct PixelBufferTarget {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    CVMetalTextureRef planes[2] = {};
+    
+    ~PixelBufferTarget() {
+        for (CVMetalTextureRef plane : planes) {
+            if (plane) {
+                CFRelease(plane);
+            }
+        }
+        if (pixelBuffer) {
+            CVPixelBufferRelease(pixelBuffer);
+        }
+    }
+};
+
+} // namespace
+
 bool IOSMetalContextManager::copyTextureToPixelBuffer(
     std::shared_ptr<lrengine::render::LRPlanarTexture> texture,
     CVPixelBufferRef pixelBuffer) {
     
-    if (!mInitialized) {
-        PIPELINE_LOGE("Not initialized");
+    return encodeTextureToPixelBuffer(texture, pixelBuffer, nullptr, true);
+}
+
+bool IOSMetalContextManager::copyTextureToPixelBufferAsync(
+    std::shared_ptr<lrengine::render::LRPlanarTexture> texture,
+    CVPixelBufferRef pixelBuffer,
+    PixelBufferCompletion completion) {
+    
+    return encodeTextureToPixelBuffer(texture, pixelBuffer, std::move(completion), false);
+}
+
+bool IOSMetalContextManager::copyTextureToPooledPixelBuffer(
+    std::shared_ptr<lrengine::render::LRPlanarTexture> texture,
+    uint32_t width, uint32_t height, OSType pixelFormat,
+    PixelBufferCompletion completion) {
+    
+    if (!mInitialized || !texture) {
+        return false;
+    }
+    
+    if (width == 0 || height == 0) {
+        auto* plane = texture->GetPlaneTexture(0);
+        id<MTLTexture> source = plane ? (__bridge id<MTLTexture>)plane->GetNativeHandle().ptr : nil;
+        if (!source) {
+            return false;
+        }
+        width = static_cast<uint32_t>(source.width);
+        height = static_cast<uint32_t>(source.height);
+    }
+    
+    CVPixelBufferRef pixelBuffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        pixelBuffer = createPooledPixelBuffer(width, height, pixelFormat);
+    }
+    if (!pixelBuffer) {
+        return false;
+    }
+    
+    // 在途期间由转换持有引用，这里释放池分配的那一份
+    bool submitted = encodeTextureToPixelBuffer(texture, pixelBuffer, std::move(completion), false);
+    CVPixelBufferRelease(pixelBuffer);
+    return submitted;
+}
+
+bool IOSMetalContextManager::encodeTextureToPixelBuffer(
+    const std::shared_ptr<lrengine::render::LRPlanarTexture>& texture,
+    CVPixelBufferRef pixelBuffer,
+    PixelBufferCompletion completion,
+    bool waitUntilCompleted) {
+    
+    if (!mInitialized || !mTextureCache) {
+        PIPELINE_LOGE("Not initialized or texture cache not available");
         return false;
     }
     
@@ -266,15 +520,210 @@ bool IOSMetalContextManager::copyTextureToPixelBuffer(
         return false;
     }
     
-    // TODO: 实现纹理到 CVPixelBuffer 的拷贝
-    // 这需要：
-    // 1. 获取 LRTexture 底层的 Metal 纹理
-    // 2. 使用 Metal Blit 命令编码器或 Metal Performance Shaders
-    // 3. 将纹理内容拷贝到 CVPixelBuffer
+    auto* plane = texture->GetPlaneTexture(0);
+    id<MTLTexture> source = plane ? (__bridge id<MTLTexture>)plane->GetNativeHandle().ptr : nil;
+    if (!source) {
+        PIPELINE_LOGE("copyTextureToPixelBuffer: source has no Metal texture");
+        return false;
+    }
+    
+    const OSType pixelFormat = CVPixelBufferGetPixelFormatType(pixelBuffer);
+    const bool isBGRA = (pixelFormat == kCVPixelFormatType_32BGRA);
+    const bool isNV12 = (pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange ||
+                         pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange);
+    if (!isBGRA && !isNV12) {
+        PIPELINE_LOGE("copyTextureToPixelBuffer: unsupported format 0x%x", pixelFormat);
+        return false;
+    }
+    
+    auto target = std::make_shared<PixelBufferTarget>();
+    target->pixelBuffer = CVPixelBufferRetain(pixelBuffer);
+    
+    std::unique_lock<std::mutex> lock(mMutex);
+    
+    if (!ensureConversionPipelines()) {
+        return false;
+    }
+    
+    // 目标平面直接映射为可写 Metal 纹理，GPU 写入即写入 IOSurface
+    NSDictionary* textureAttributes = @{
+        (id)kCVMetalTextureUsage: @(MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite)
+    };
+    const MTLPixelFormat planeFormats[2] = {
+        isBGRA ? MTLPixelFormatBGRA8Unorm : MTLPixelFormatR8Unorm,
+        MTLPixelFormatRG8Unorm
+    };
+    const size_t planeCount = isNV12 ? 2 : 1;
+    auto cache = static_cast<CVMetalTextureCacheRef>(mTextureCache);
+    for (size_t i = 0; i < planeCount; ++i) {
+        size_t planeWidth = isNV12 ? CVPixelBufferGetWidthOfPlane(pixelBuffer, i)
+                                   : CVPixelBufferGetWidth(pixelBuffer);
+        size_t planeHeight = isNV12 ? CVPixelBufferGetHeightOfPlane(pixelBuffer, i)
+                                    : CVPixelBufferGetHeight(pixelBuffer);
+        CVReturn status = CVMetalTextureCacheCreateTextureFromImage(
+            kCFAllocatorDefault, cache, pixelBuffer, (__bridge CFDictionaryRef)textureAttributes,
+            planeFormats[i], planeWidth, planeHeight, i, &target->planes[i]);
+        if (status != kCVReturnSuccess || !target->planes[i]) {
+            PIPELINE_LOGE("Failed to map pixel buffer plane %zu: %d", i, status);
+            return false;
+        }
+    }
+    
+    // 独立命令队列：依赖 LREngine 已提交产生 source 的命令缓冲（同设备按提交顺序调度）
+    id<MTLCommandQueue> queue = (__bridge id<MTLCommandQueue>)mCommandQueue;
+    id<MTLCommandBuffer> cmdBuffer = [queue commandBuffer];
+    id<MTLComputeCommandEncoder> encoder = [cmdBuffer computeCommandEncoder];
+    [encoder setTexture:source atIndex:0];
     
-    PIPELINE_LOGD("copyTextureToPixelBuffer not yet fully implemented");
+    if (isBGRA) {
+        dispatchConvert(encoder, (__bridge id<MTLComputePipelineState>)mBGRAPipeline,
+                        CVMetalTextureGetTexture(target->planes[0]));
+    } else {
+        const ConvertParams params = makeConvertParams(
+            pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange);
+        [encoder setBytes:&params length:sizeof(params) atIndex:0];
+        dispatchConvert(encoder, (__bridge id<MTLComputePipelineState>)mLumaPipeline,
+                        CVMetalTextureGetTexture(target->planes[0]));
+        dispatchConvert(encoder, (__bridge id<MTLComputePipelineState>)mChromaPipeline,
+                        CVMetalTextureGetTexture(target->planes[1]));
+    }
+    [encoder endEncoding];
+    
+    if (completion) {
+        [cmdBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            const bool success = (buffer.status == MTLCommandBufferStatusCompleted);
+            if (!success) {
+                PIPELINE_LOGW("Texture to pixel buffer conversion failed");
+            }
+            completion(target->pixelBuffer, success);
+        }];
+    } else {
+        [cmdBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            (void)buffer;
+            (void)target;       // 仅延长平面纹理的生命周期
+        }];
+    }
+    [cmdBuffer commit];
+    lock.unlock();
     
-    return false;
+    if (waitUntilCompleted) {
+        [cmdBuffer waitUntilCompleted];
+        return cmdBuffer.status == MTLCommandBufferStatusCompleted;
+    }
+    return true;
+}
+
+bool IOSMetalContextManager::ensureTransferQueueLocked() {
+    if (mCommandQueue) {
+        return true;
+    }
+    id<MTLDevice> device = (__bridge id<MTLDevice>)mMetalDevice;
+    id<MTLCommandQueue> queue = [device newCommandQueue];
+    if (!queue) {
+        PIPELINE_LOGE("Failed to create transfer command queue");
+        return false;
+    }
+    queue.label = @"Pipeline.Transfer";
+    mCommandQueue = (__bridge_retained void*)queue;
+    return true;
+}
+
+void* IOSMetalContextManager::getTransferCommandQueue() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mInitialized || !ensureTransferQueueLocked()) {
+        return nullptr;
+    }
+    return mCommandQueue;
+}
+
+bool IOSMetalContextManager::ensureConversionPipelines() {
+    if (mBGRAPipeline && mLumaPipeline && mChromaPipeline) {
+        return true;
+    }
+    
+    id<MTLDevice> device = (__bridge id<MTLDevice>)mMetalDevice;
+    if (!ensureTransferQueueLocked()) {
+        return false;
+    }
+    
+    NSError* error = nil;
+    id<MTLLibrary> library = [device newLibraryWithSource:kConvertShaderSource options:nil error:&error];
+    if (!library) {
+        PIPELINE_LOGE("Failed to compile conversion shaders: %s",
+                      [[error localizedDescription] UTF8String]);
+        return false;
+    }
+    
+    NSString* const names[3] = {@"convertToBGRA", @"convertToLuma", @"convertToChroma"};
+    void** slots[3] = {&mBGRAPipeline, &mLumaPipeline, &mChromaPipeline};
+    for (int i = 0; i < 3; ++i) {
+        if (*slots[i]) {
+            continue;
+        }
+        id<MTLFunction> function = [library newFunctionWithName:names[i]];
+        id<MTLComputePipelineState> pipeline =
+            function ? [device newComputePipelineStateWithFunction:function error:&error] : nil;
+        if (!pipeline) {
+            PIPELINE_LOGE("Failed to create compute pipeline %s", [names[i] UTF8String]);
+            return false;
+        }
+        *slots[i] = (__bridge_retained void*)pipeline;
+    }
+    
+    PIPELINE_LOGI("Texture to pixel buffer conversion pipelines ready");
+    return true;
+}
+
+CVPixelBufferRef IOSMetalContextManager::createPooledPixelBuffer(
+    uint32_t width, uint32_t height, OSType pixelFormat) {
+    
+    if (!mPixelBufferPool || mPoolWidth != width || mPoolHeight != height ||
+        mPoolFormat != pixelFormat) {
+        if (mPixelBufferPool) {
+            CVPixelBufferPoolRelease(mPixelBufferPool);
+            mPixelBufferPool = nullptr;
+        }
+        
+        NSDictionary* bufferAttributes = @{
+            (id)kCVPixelBufferPixelFormatTypeKey: @(pixelFormat),
+            (id)kCVPixelBufferWidthKey: @(width),
+            (id)kCVPixelBufferHeightKey: @(height),
+            (id)kCVPixelBufferMetalCompatibilityKey: @YES,
+            (id)kCVPixelBufferIOSurfacePropertiesKey: @{}
+        };
+        NSDictionary* poolAttributes = @{
+            (id)kCVPixelBufferPoolMinimumBufferCountKey: @3
+        };
+        CVReturn status = CVPixelBufferPoolCreate(
+            kCFAllocatorDefault, (__bridge CFDictionaryRef)poolAttributes,
+            (__bridge CFDictionaryRef)bufferAttributes, &mPixelBufferPool);
+        if (status != kCVReturnSuccess || !mPixelBufferPool) {
+            PIPELINE_LOGE("CVPixelBufferPoolCreate failed: %d", status);
+            mPixelBufferPool = nullptr;
+            return nullptr;
+        }
+        mPoolWidth = width;
+        mPoolHeight = height;
+        mPoolFormat = pixelFormat;
+        PIPELINE_LOGI("Created output pixel buffer pool: %ux%u, format 0x%x", width, height, pixelFormat);
+    }
+    
+    // 分配上限：下游长时间不归还时直接失败，而不是无限增长
+    NSDictionary* auxAttributes = @{
+        (id)kCVPixelBufferPoolAllocationThresholdKey: @(kPooledPixelBufferLimit)
+    };
+    CVPixelBufferRef pixelBuffer = nullptr;
+    CVReturn status = CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(
+        kCFAllocatorDefault, mPixelBufferPool, (__bridge CFDictionaryRef)auxAttributes, &pixelBuffer);
+    if (status == kCVReturnWouldExceedAllocationThreshold) {
+        PIPELINE_LOGW("Output pixel buffer pool exhausted, frame dropped");
+        return nullptr;
+    }
+    if (status != kCVReturnSuccess) {
+        PIPELINE_LOGE("CVPixelBufferPoolCreatePixelBuffer failed: %d", status);
+        return nullptr;
+    }
+    return pixelBuffer;
 }
 
 void IOSMetalContextManager::flushTextureCache() {
@@ -296,6 +745,18 @@ void IOSMetalContextManager::destroy() {
     
     PIPELINE_LOGI("Destroying IOSMetalContextManager");
     
+    // 释放格式转换资源
+    if (mPixelBufferPool) {
+        CVPixelBufferPoolRelease(mPixelBufferPool);
+        mPixelBufferPool = nullptr;
+    }
+    for (void** object : {&mBGRAPipeline, &mLumaPipeline, &mChromaPipeline, &mCommandQueue}) {
+        if (*object) {
+            CFRelease(*object);
+            *object = nullptr;
+        }
+    }
+    
     // 释放纹理缓存
     if (mTextureCache) {
         CFRelease(static_cast<CVMetalTextureCacheRef>(mTextureCache));
@@ -0,0 +1,101 @@
+/**
+ * @file IOSThermalMonitor.mm
+ * @brief iOS/macOS 平台温控监听（NSProcessInfo.thermalState）
+ *
+ * 状态变化经 NSProcessInfoThermalStateDidChangeNotification 通知，回调在发出通知的线程触发。
+ */
+
+#if defined(__APPLE__)
+
+#import "pipeline/core/QualityController.h"
+#import <Foundation/Foundation.h>
+
+#include <mutex>
+
+namespace pipeline {
+
+namespace {
+
+ThermalState toThermalState(NSProcessInfoThermalState state) {
+    switch (state) {
+        case NSProcessInfoThermalStateFair:
+            return ThermalState::Fair;
+        case NSProcessInfoThermalStateSerious:
+            return ThermalState::Serious;
+        case NSProcessInfoThermalStateCritical:
+            return ThermalState::Critical;
+        default:
+            return ThermalState::Nominal;
+    }
+}
+
+// 回调状态，通知 block 与 C++ 对象共同持有
+struct ThermalObserverState {
+    std::mutex mutex;
+    ThermalMonitor::ThermalCallback callback;
+
+    void dispatch() {
+        ThermalState state = toThermalState([NSProcessInfo processInfo].thermalState);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (callback) {
+            callback(state);
+        }
+    }
+};
+
+class IOSThermalMonitor : public ThermalMonitor {
+public:
+    ~IOSThermalMonitor() override {
+        stop();
+    }
+
+    bool start(ThermalCallback callback) override {
+        if (mObserver) {
+            return false;
+        }
+        mState = std::make_shared<ThermalObserverState>();
+        mState->callback = std::move(callback);
+
+        std::shared_ptr<ThermalObserverState> state = mState;
+        id observer = [[NSNotificationCenter defaultCenter]
+            addObserverForName:NSProcessInfoThermalStateDidChangeNotification
+                        object:nil
+                         queue:nil
+                    usingBlock:^(NSNotification* note) {
+                        (void)note;
+                        state->dispatch();
+                    }];
+        mObserver = (__bridge_retained void*)observer;
+
+        // 通知只在变化时发出，先报告一次当前状态
+        mState->dispatch();
+        return true;
+    }
+
+    void stop() override {
+        if (!mObserver) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            mState->callback = nullptr;
+        }
+        id observer = (__bridge_transfer id)mObserver;
+        mObserver = nullptr;
+        [[NSNotificationCenter defaultCenter] removeObserver:observer];
+    }
+
+private:
+    void* mObserver = nullptr;      // 通知中心返回的观察者
+    std::shared_ptr<ThermalObserverState> mState;
+};
+
+} // anonymous namespace
+
+std::unique_ptr<ThermalMonitor> createPlatformThermalMonitor() {
+    return std::unique_ptr<ThermalMonitor>(new IOSThermalMonitor());
+}
+
+} // namespace pipeline
+
+#endif // defined(__APPLE__)
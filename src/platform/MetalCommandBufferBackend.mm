@@ -0,0 +1,65 @@
+/**
+ * @file MetalCommandBufferBackend.mm
+ * @brief 帧级命令缓冲的 Metal 实现
+ *
+ * 命令缓冲在首个渲染通道时从专用队列取出，句柄以 __bridge_retained 交给 GpuCommandContext，
+ * 提交时再转回 ARC 管理。渲染上下文需把各通道的编码器建在该命令缓冲上
+ * （LREngine 暴露外部命令缓冲接口后接入，见 GPUEntity::processGPU）。
+ */
+
+#if defined(__APPLE__)
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include "pipeline/data/GpuCommandContext.h"
+#include "pipeline/utils/PipelineLog.h"
+
+namespace pipeline {
+
+namespace {
+
+class MetalCommandBufferBackend : public CommandBufferBackend {
+public:
+    explicit MetalCommandBufferBackend(id<MTLCommandQueue> queue)
+        : mQueue(queue)
+    {
+    }
+
+    void* begin() override {
+        id<MTLCommandBuffer> cmdBuffer = [mQueue commandBuffer];
+        if (!cmdBuffer) {
+            return nullptr;
+        }
+        cmdBuffer.label = @"Pipeline.Frame";
+        return (__bridge_retained void*)cmdBuffer;
+    }
+
+    void commit(void* commandBuffer) override {
+        if (!commandBuffer) {
+            return;
+        }
+        id<MTLCommandBuffer> cmdBuffer = (__bridge_transfer id<MTLCommandBuffer>)commandBuffer;
+        [cmdBuffer commit];
+    }
+
+private:
+    id<MTLCommandQueue> mQueue;
+};
+
+} // namespace
+
+std::unique_ptr<CommandBufferBackend> createMetalCommandBufferBackend() {
+    id<MTLDevice> device = MTLCreateSystemDefaultDevice();
+    id<MTLCommandQueue> queue = device ? [device newCommandQueue] : nil;
+    if (!queue) {
+        PIPELINE_LOGW("Failed to create Metal command queue for frame recording");
+        return nullptr;
+    }
+    queue.label = @"Pipeline.Frame";
+    return std::make_unique<MetalCommandBufferBackend>(queue);
+}
+
+} // namespace pipeline
+
+#endif // __APPLE__
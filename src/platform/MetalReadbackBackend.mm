@@ -0,0 +1,149 @@
+/**
+ * @file MetalReadbackBackend.mm
+ * @brief Metal 异步读回后端 - blit 到共享存储 MTLBuffer
+ *
+ * 每个槽位一个 StorageModeShared 的 MTLBuffer，blit 编码后立即提交；
+ * command buffer 完成时经 completion handler 通知服务收取。
+ */
+
+#if defined(__APPLE__)
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include "pipeline/data/AsyncReadback.h"
+#include "pipeline/utils/PipelineLog.h"
+#include "lrengine/core/LRTexture.h"
+
+#include <cstring>
+#include <vector>
+
+namespace pipeline {
+
+namespace {
+
+class MetalReadbackBackend : public ReadbackBackend {
+public:
+    explicit MetalReadbackBackend(uint32_t slotCount)
+        : mSlots(slotCount > 0 ? slotCount : 1)
+    {
+    }
+
+    ~MetalReadbackBackend() override {
+        release();
+    }
+
+    bool begin(uint32_t slot, lrengine::render::LRTexture& texture,
+               uint32_t width, uint32_t height, uint32_t stride, size_t bytes) override {
+        if (slot >= mSlots.size()) {
+            return false;
+        }
+
+        auto handle = texture.GetNativeHandle();
+        id<MTLTexture> mtlTexture = (__bridge id<MTLTexture>)handle.ptr;
+        if (!mtlTexture) {
+            return false;
+        }
+
+        // 设备与命令队列取自首个纹理，避免依赖渲染上下文内部结构
+        if (!mQueue) {
+            mQueue = [mtlTexture.device newCommandQueue];
+            if (!mQueue) {
+                PIPELINE_LOGE("Failed to create readback command queue");
+                return false;
+            }
+        }
+
+        Slot& entry = mSlots[slot];
+        if (!entry.buffer || entry.buffer.length < bytes) {
+            entry.buffer = [mtlTexture.device newBufferWithLength:bytes
+                                                          options:MTLResourceStorageModeShared];
+            if (!entry.buffer) {
+                PIPELINE_LOGE("Failed to allocate readback buffer (%zu bytes)", bytes);
+                return false;
+            }
+        }
+
+        id<MTLCommandBuffer> cmdBuffer = [mQueue commandBuffer];
+        id<MTLBlitCommandEncoder> blit = [cmdBuffer blitCommandEncoder];
+        [blit copyFromTexture:mtlTexture
+                  sourceSlice:0
+                  sourceLevel:0
+                 sourceOrigin:MTLOriginMake(0, 0, 0)
+                   sourceSize:MTLSizeMake(width, height, 1)
+                     toBuffer:entry.buffer
+            destinationOffset:0
+       destinationBytesPerRow:stride
+     destinationBytesPerImage:bytes];
+        [blit endEncoding];
+
+        // handler 只捕获回调副本，后端先于 command buffer 销毁也安全
+        auto callback = mCompletionCallback;
+        if (callback) {
+            [cmdBuffer addCompletedHandler:^(id<MTLCommandBuffer>) {
+                callback(slot);
+            }];
+        }
+        [cmdBuffer commit];
+        entry.commandBuffer = cmdBuffer;
+        return true;
+    }
+
+    bool isComplete(uint32_t slot) override {
+        if (slot >= mSlots.size() || !mSlots[slot].commandBuffer) {
+            return false;
+        }
+        MTLCommandBufferStatus status = mSlots[slot].commandBuffer.status;
+        return status == MTLCommandBufferStatusCompleted || status == MTLCommandBufferStatusError;
+    }
+
+    void waitComplete(uint32_t slot) override {
+        if (slot >= mSlots.size() || !mSlots[slot].commandBuffer) {
+            return;
+        }
+        [mSlots[slot].commandBuffer waitUntilCompleted];
+    }
+
+    bool read(uint32_t slot, uint8_t* dst, size_t bytes) override {
+        if (slot >= mSlots.size() || !dst) {
+            return false;
+        }
+        Slot& entry = mSlots[slot];
+        bool ok = entry.buffer && entry.buffer.length >= bytes && entry.commandBuffer &&
+                  entry.commandBuffer.status == MTLCommandBufferStatusCompleted;
+        if (ok) {
+            std::memcpy(dst, entry.buffer.contents, bytes);
+        }
+        entry.commandBuffer = nil;
+        return ok;
+    }
+
+    void release() override {
+        for (auto& entry : mSlots) {
+            entry.commandBuffer = nil;
+            entry.buffer = nil;
+        }
+        mQueue = nil;
+    }
+
+    bool supportsCompletionCallback() const override { return true; }
+
+private:
+    struct Slot {
+        id<MTLBuffer> buffer = nil;
+        id<MTLCommandBuffer> commandBuffer = nil;
+    };
+
+    std::vector<Slot> mSlots;
+    id<MTLCommandQueue> mQueue = nil;
+};
+
+} // namespace
+
+std::unique_ptr<ReadbackBackend> createMetalReadbackBackend(uint32_t slotCount) {
+    return std::make_unique<MetalReadbackBackend>(slotCount);
+}
+
+} // namespace pipeline
+
+#endif // __APPLE__
@@ -0,0 +1,106 @@
+/**
+ * @file MetalSharedEventFence.mm
+ * @brief GpuFence 的 Metal 实现（MTLSharedEvent）
+ *
+ * 栅栏经专用命令队列编码 encodeSignalEvent 并提交。Metal 不保证跨队列的执行顺序，
+ * 这里依赖 LREngine 在返回前已提交本帧的渲染 command buffer（同设备按提交顺序调度）；
+ * 若渲染上下文后续暴露其命令缓冲，应改为直接编码到其中。
+ * CPU 等待通过 MTLSharedEventListener 回调唤醒，不轮询。
+ */
+
+#if defined(__APPLE__)
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include "pipeline/data/GpuFence.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <mutex>
+
+namespace pipeline {
+
+namespace {
+
+struct MetalFenceState {
+    id<MTLDevice> device = nil;
+    id<MTLCommandQueue> queue = nil;
+    id<MTLSharedEvent> event = nil;
+    MTLSharedEventListener* listener = nil;
+    uint64_t nextValue = 0;
+    std::mutex mutex;
+};
+
+MetalFenceState& fenceState() {
+    static MetalFenceState state;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        state.device = MTLCreateSystemDefaultDevice();
+        if (state.device) {
+            state.queue = [state.device newCommandQueue];
+            state.event = [state.device newSharedEvent];
+            state.listener = [[MTLSharedEventListener alloc] init];
+        }
+        if (!state.queue || !state.event) {
+            PIPELINE_LOGW("MTLSharedEvent not available, GPU fences disabled");
+        }
+    });
+    return state;
+}
+
+class MetalSharedEventFence : public GpuFence {
+public:
+    MetalSharedEventFence(id<MTLSharedEvent> event, uint64_t value)
+        : mEvent(event)
+        , mValue(value)
+    {
+    }
+
+    bool wait(int64_t timeoutMs) override {
+        if (isSignaled()) {
+            return true;
+        }
+        dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+        [mEvent notifyListener:fenceState().listener
+                       atValue:mValue
+                         block:^(id<MTLSharedEvent>, uint64_t) {
+            dispatch_semaphore_signal(semaphore);
+        }];
+        dispatch_time_t deadline = timeoutMs < 0
+            ? DISPATCH_TIME_FOREVER
+            : dispatch_time(DISPATCH_TIME_NOW, timeoutMs * NSEC_PER_MSEC);
+        return dispatch_semaphore_wait(semaphore, deadline) == 0;
+    }
+
+    bool isSignaled() const override {
+        return mEvent.signaledValue >= mValue;
+    }
+
+private:
+    id<MTLSharedEvent> mEvent;
+    uint64_t mValue;
+};
+
+} // namespace
+
+GpuFencePtr createMetalSharedEventFence() {
+    auto& state = fenceState();
+    if (!state.queue || !state.event) {
+        return nullptr;
+    }
+
+    uint64_t value = 0;
+    id<MTLCommandBuffer> cmdBuffer = nil;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        value = ++state.nextValue;
+        cmdBuffer = [state.queue commandBuffer];
+        [cmdBuffer encodeSignalEvent:state.event value:value];
+        [cmdBuffer commit];
+    }
+    return std::make_shared<MetalSharedEventFence>(state.event, value);
+}
+
+} // namespace pipeline
+
+#endif // __APPLE__
@@ -91,6 +91,17 @@ bool PlatformContext::initialize(const PlatformContextConfig& config) {
     }
 #endif
     
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mPlatformType == PlatformType::Linux) {
+        mGraphicsAPI = config.headlessConfig.desktopGL ? GraphicsAPI::OpenGL : GraphicsAPI::OpenGLES;
+        mHeadlessEGLManager = std::make_unique<HeadlessEGLContextManager>();
+        success = mHeadlessEGLManager->initialize(config.headlessConfig);
+        if (!success) {
+            LOGE("Failed to initialize HeadlessEGLContextManager");
+        }
+    }
+#endif
+    
     if (!success) {
         LOGE("Platform initialization failed for platform type: %d", (int)mPlatformType);
         return false;
@@ -114,6 +125,12 @@ bool PlatformContext::makeCurrent() {
     }
 #endif
     
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mHeadlessEGLManager) {
+        return mHeadlessEGLManager->makeCurrent();
+    }
+#endif
+    
     // iOS Metal 不需要显式的 makeCurrent
     return true;
 }
@@ -129,6 +146,80 @@ bool PlatformContext::releaseCurrent() {
     }
 #endif
     
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mHeadlessEGLManager) {
+        return mHeadlessEGLManager->releaseCurrent();
+    }
+#endif
+    
+    return true;
+}
+
+bool PlatformContext::createTransferContext() {
+    if (!mInitialized) {
+        LOGE("PlatformContext not initialized");
+        return false;
+    }
+    
+#ifdef __ANDROID__
+    if (mAndroidEGLManager) {
+        return mAndroidEGLManager->createTransferContext();
+    }
+#endif
+    
+#if defined(PIPELINE_PLATFORM_IOS) || defined(PIPELINE_PLATFORM_MACOS)
+    if (mIOSMetalManager) {
+        return mIOSMetalManager->getTransferCommandQueue() != nullptr;
+    }
+#endif
+    
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mHeadlessEGLManager) {
+        return mHeadlessEGLManager->createTransferContext();
+    }
+#endif
+    
+    return false;
+}
+
+bool PlatformContext::makeTransferCurrent() {
+    if (!mInitialized) {
+        return false;
+    }
+    
+#ifdef __ANDROID__
+    if (mAndroidEGLManager) {
+        return mAndroidEGLManager->makeTransferCurrent();
+    }
+#endif
+    
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mHeadlessEGLManager) {
+        return mHeadlessEGLManager->makeTransferCurrent();
+    }
+#endif
+    
+    // Metal 命令队列不绑定线程
+    return true;
+}
+
+bool PlatformContext::releaseTransferCurrent() {
+    if (!mInitialized) {
+        return false;
+    }
+    
+#ifdef __ANDROID__
+    if (mAndroidEGLManager) {
+        return mAndroidEGLManager->releaseTransferCurrent();
+    }
+#endif
+    
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mHeadlessEGLManager) {
+        return mHeadlessEGLManager->releaseTransferCurrent();
+    }
+#endif
+    
     return true;
 }
 
@@ -153,6 +244,13 @@ void PlatformContext::destroy() {
     }
 #endif
     
+#if defined(PIPELINE_HEADLESS_EGL)
+    if (mHeadlessEGLManager) {
+        mHeadlessEGLManager->destroy();
+        mHeadlessEGLManager.reset();
+    }
+#endif
+    
     mInitialized = false;
 }
 
@@ -4,131 +4,248 @@
  */
 
 #include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/utils/MPMCQueue.h"
+#include "pipeline/utils/PipelineTrace.h"
 #include <algorithm>
-#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <new>
 
 namespace pipeline {
 
 // =============================================================================
-// FramePacketPool
+// FramePacketPoolCore
 // =============================================================================
 
-FramePacketPool::FramePacketPool(const FramePacketPoolConfig& config)
-    : mConfig(config)
-{
-}
-
-FramePacketPool::~FramePacketPool() {
-    mShutdown.store(true);
-    clear();
-}
+namespace detail {
 
-FramePacketPtr FramePacketPool::acquire() {
-    std::unique_lock<std::mutex> lock(mMutex);
+/**
+ * @brief 帧包池共享状态
+ *
+ * 由池与所有在外帧包的删除器/控制块分配器共同持有，池销毁后仍可安全归还。
+ */
+struct FramePacketPoolCore {
+    // shared_ptr 控制块缓存的块大小（超过则直接分配）
+    static constexpr size_t kControlBlockSize = 128;
+    
+    explicit FramePacketPoolCore(uint32_t capacity)
+        : freePackets(std::max<size_t>(capacity * 2, 16))
+        , freeBlocks(std::max<size_t>(capacity * 2, 16))
+        , capacity(capacity) {}
+    
+    ~FramePacketPoolCore() {
+        FramePacket* packet = nullptr;
+        while (freePackets.tryPop(packet)) {
+            delete packet;
+        }
+        void* block = nullptr;
+        while (freeBlocks.tryPop(block)) {
+            ::operator delete(block);
+        }
+    }
+    
+    MPMCQueue<FramePacket*> freePackets;    // 空闲帧包
+    MPMCQueue<void*> freeBlocks;            // 空闲控制块
     
-    mTotalAllocations.fetch_add(1);
+    std::atomic<uint32_t> capacity;
+    std::atomic<uint32_t> totalCreated{0};
+    std::atomic<uint32_t> inUseCount{0};
+    std::atomic<uint32_t> waiters{0};       // 阻塞等待空闲帧包的线程数
+    std::atomic<uint64_t> totalReleases{0};
+    std::atomic<bool> shutdown{false};
     
-    // 尝试从池中获取
-    if (!mAvailable.empty()) {
-        FramePacketPtr packet = std::move(mAvailable.front());
-        mAvailable.pop();
-        mInUseCount.fetch_add(1);
+    // 仅用于阻塞等待与全部归还通知
+    std::mutex mutex;
+    std::condition_variable availableCondition;
+    std::condition_variable releasedCondition;
+    
+    /**
+     * @brief 归还帧包（回收删除器调用）
+     */
+    void recycle(FramePacket* packet) {
+        packet->reset();
+        packet->setPool(nullptr);
+        totalReleases.fetch_add(1, std::memory_order_relaxed);
         
-        // 重置帧ID
-        packet->setFrameId(mNextFrameId.fetch_add(1));
-        return packet;
+        // 池已销毁、容量已缩小或队列已满时直接释放
+        bool keep = !shutdown.load(std::memory_order_acquire) &&
+                    totalCreated.load(std::memory_order_relaxed) <= capacity.load(std::memory_order_relaxed) &&
+                    freePackets.tryPush(packet);
+        if (!keep) {
+            delete packet;
+            totalCreated.fetch_sub(1, std::memory_order_relaxed);
+        }
+        
+        bool allReleased = inUseCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        // 与等待方的 waiters 递增配对：要么对方看到归还的帧包，要么这里看到等待者
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0 || allReleased) {
+            // 加锁后通知，等待方在锁内检查条件，不会丢失唤醒
+            std::lock_guard<std::mutex> lock(mutex);
+            availableCondition.notify_one();
+            if (allReleased) {
+                releasedCondition.notify_all();
+            }
+        }
     }
     
-    // 池为空，检查是否可以创建新的
-    if (mTotalCreated.load() < mConfig.capacity) {
-        mInUseCount.fetch_add(1);
-        return createPacket();
+    void* allocateBlock(size_t size) {
+        void* block = nullptr;
+        if (size <= kControlBlockSize && freeBlocks.tryPop(block)) {
+            return block;
+        }
+        return ::operator new(std::max(size, kControlBlockSize));
     }
     
-    // 池满，等待或返回空
-    if (!mConfig.blockOnEmpty) {
-        return nullptr;
+    void deallocateBlock(void* block, size_t size) {
+        if (size > kControlBlockSize || !freeBlocks.tryPush(block)) {
+            ::operator delete(block);
+        }
+    }
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::FramePacketPoolCore;
+
+/**
+ * @brief 回收删除器：最后一个引用释放时归还帧包
+ */
+struct PacketRecycler {
+    std::shared_ptr<FramePacketPoolCore> core;
+    
+    void operator()(FramePacket* packet) const {
+        core->recycle(packet);
     }
+};
+
+/**
+ * @brief 控制块分配器：控制块从池内缓存分配，取出帧包不触发堆分配
+ */
+template <typename T>
+struct ControlBlockAllocator {
+    using value_type = T;
     
-    mBlockCount.fetch_add(1);
+    explicit ControlBlockAllocator(std::shared_ptr<FramePacketPoolCore> c) : core(std::move(c)) {}
     
-    bool success = mCondition.wait_for(lock, 
-        std::chrono::milliseconds(mConfig.blockTimeoutMs),
-        [this] { return !mAvailable.empty() || mShutdown.load(); });
+    template <typename U>
+    ControlBlockAllocator(const ControlBlockAllocator<U>& other) : core(other.core) {}
     
-    if (!success || mShutdown.load() || mAvailable.empty()) {
-        mTimeoutCount.fetch_add(1);
-        return nullptr;
+    T* allocate(size_t n) {
+        return static_cast<T*>(core->allocateBlock(n * sizeof(T)));
     }
     
-    FramePacketPtr packet = std::move(mAvailable.front());
-    mAvailable.pop();
-    mInUseCount.fetch_add(1);
+    void deallocate(T* p, size_t n) {
+        core->deallocateBlock(p, n * sizeof(T));
+    }
     
-    packet->setFrameId(mNextFrameId.fetch_add(1));
-    return packet;
-}
-
-FramePacketPtr FramePacketPool::tryAcquire() {
-    std::lock_guard<std::mutex> lock(mMutex);
+    template <typename U>
+    bool operator==(const ControlBlockAllocator<U>& other) const { return core == other.core; }
     
-    mTotalAllocations.fetch_add(1);
+    template <typename U>
+    bool operator!=(const ControlBlockAllocator<U>& other) const { return core != other.core; }
     
-    if (!mAvailable.empty()) {
-        FramePacketPtr packet = std::move(mAvailable.front());
-        mAvailable.pop();
-        mInUseCount.fetch_add(1);
-        
-        packet->setFrameId(mNextFrameId.fetch_add(1));
+    std::shared_ptr<FramePacketPoolCore> core;
+};
+
+} // namespace
+
+// =============================================================================
+// FramePacketPool
+// =============================================================================
+
+FramePacketPool::FramePacketPool(const FramePacketPoolConfig& config)
+    : mConfig(config)
+    , mCore(std::make_shared<FramePacketPoolCore>(config.capacity))
+{
+}
+
+FramePacketPool::~FramePacketPool() {
+    {
+        std::lock_guard<std::mutex> lock(mCore->mutex);
+        mCore->shutdown.store(true, std::memory_order_release);
+    }
+    mCore->availableCondition.notify_all();
+    clear();
+}
+
+FramePacket* FramePacketPool::takePacket() {
+    FramePacket* packet = nullptr;
+    if (mCore->freePackets.tryPop(packet)) {
         return packet;
     }
     
-    // 池为空，检查是否可以创建新的
-    if (mTotalCreated.load() < mConfig.capacity) {
-        mInUseCount.fetch_add(1);
-        return createPacket();
+    // 池为空，在容量内创建新的
+    uint32_t created = mCore->totalCreated.load(std::memory_order_relaxed);
+    while (created < mCore->capacity.load(std::memory_order_relaxed)) {
+        if (mCore->totalCreated.compare_exchange_weak(created, created + 1,
+                                                      std::memory_order_relaxed)) {
+            return new FramePacket();
+        }
     }
-    
     return nullptr;
 }
 
-void FramePacketPool::release(FramePacketPtr packet) {
-    if (!packet) return;
+FramePacketPtr FramePacketPool::wrapPacket(FramePacket* packet) {
+    mCore->inUseCount.fetch_add(1, std::memory_order_relaxed);
+    packet->setFrameId(mNextFrameId.fetch_add(1, std::memory_order_relaxed));
+    packet->setPool(this);
+    return FramePacketPtr(packet, PacketRecycler{mCore},
+                          ControlBlockAllocator<FramePacket>(mCore));
+}
+
+FramePacketPtr FramePacketPool::acquire() {
+    mTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+    
+    if (FramePacket* packet = takePacket()) {
+        return wrapPacket(packet);
+    }
     
-    mTotalReleases.fetch_add(1);
-    mInUseCount.fetch_sub(1);
+    // 池满，等待或返回空
+    if (!mConfig.blockOnEmpty) {
+        return nullptr;
+    }
     
-    // 重置并放回池中
-    resetPacket(packet);
+    mBlockCount.fetch_add(1, std::memory_order_relaxed);
+    TraceScope trace("FramePacketPool.acquireBlocked", "pool");
     
+    FramePacket* packet = nullptr;
+    mCore->waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
     {
-        std::lock_guard<std::mutex> lock(mMutex);
-        
-        // 检查是否超出容量
-        if (mAvailable.size() < mConfig.capacity) {
-            mAvailable.push(std::move(packet));
-        }
-        // 否则让packet自然销毁
+        std::unique_lock<std::mutex> lock(mCore->mutex);
+        mCore->availableCondition.wait_for(lock,
+            std::chrono::milliseconds(mConfig.blockTimeoutMs),
+            [this, &packet] {
+                packet = takePacket();
+                return packet != nullptr || mCore->shutdown.load(std::memory_order_acquire);
+            });
     }
+    mCore->waiters.fetch_sub(1, std::memory_order_relaxed);
     
-    mCondition.notify_one();
-}
-
-FramePacketPtr FramePacketPool::acquireAutoRelease() {
-    FramePacketPtr packet = acquire();
     if (!packet) {
+        mTimeoutCount.fetch_add(1, std::memory_order_relaxed);
         return nullptr;
     }
+    return wrapPacket(packet);
+}
+
+FramePacketPtr FramePacketPool::tryAcquire() {
+    mTotalAllocations.fetch_add(1, std::memory_order_relaxed);
     
-    // 创建带自定义删除器的智能指针
-    std::weak_ptr<FramePacketPool> weakPool = shared_from_this();
-    
-    return FramePacketPtr(packet.get(), 
-        [weakPool, originalPacket = packet](FramePacket*) mutable {
-            if (auto pool = weakPool.lock()) {
-                pool->release(originalPacket);
-            }
-        });
+    FramePacket* packet = takePacket();
+    return packet ? wrapPacket(packet) : nullptr;
+}
+
+void FramePacketPool::release(FramePacketPtr packet) {
+    // 放弃调用方的引用；若为最后一个引用，删除器将其归还
+    packet.reset();
+}
+
+FramePacketPtr FramePacketPool::acquireAutoRelease() {
+    return acquire();
 }
 
 void FramePacketPool::preallocate(uint32_t count) {
@@ -136,149 +253,502 @@ void FramePacketPool::preallocate(uint32_t count) {
         count = mConfig.capacity;
     }
     
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    while (mTotalCreated.load() < count && mTotalCreated.load() < mConfig.capacity) {
-        mAvailable.push(createPacket());
+    count = std::min(count, mCore->capacity.load(std::memory_order_relaxed));
+    uint32_t created = mCore->totalCreated.load(std::memory_order_relaxed);
+    while (created < count) {
+        if (!mCore->totalCreated.compare_exchange_weak(created, created + 1,
+                                                       std::memory_order_relaxed)) {
+            continue;
+        }
+        auto* packet = new FramePacket();
+        if (!mCore->freePackets.tryPush(packet)) {
+            delete packet;
+            mCore->totalCreated.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        created = mCore->totalCreated.load(std::memory_order_relaxed);
     }
 }
 
 void FramePacketPool::clear() {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    while (!mAvailable.empty()) {
-        mAvailable.pop();
+    trim(0);
+}
+
+size_t FramePacketPool::trim(size_t keepCount) {
+    size_t released = 0;
+    FramePacket* packet = nullptr;
+    while (mCore->freePackets.sizeApprox() > keepCount && mCore->freePackets.tryPop(packet)) {
+        delete packet;
+        mCore->totalCreated.fetch_sub(1, std::memory_order_relaxed);
+        ++released;
     }
-    
-    mTotalCreated.store(0);
+    return released;
 }
 
 bool FramePacketPool::waitAllReleased(int64_t timeoutMs) {
-    auto startTime = std::chrono::steady_clock::now();
-    
-    while (mInUseCount.load() > 0) {
-        if (timeoutMs >= 0) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - startTime).count();
-            if (elapsed >= timeoutMs) {
-                return false;
-            }
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+    std::unique_lock<std::mutex> lock(mCore->mutex);
+    auto released = [this] { return mCore->inUseCount.load(std::memory_order_acquire) == 0; };
     
-    return true;
+    if (timeoutMs < 0) {
+        mCore->releasedCondition.wait(lock, released);
+        return true;
+    }
+    return mCore->releasedCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), released);
 }
 
 size_t FramePacketPool::getAvailableCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mAvailable.size();
+    return mCore->freePackets.sizeApprox();
 }
 
 size_t FramePacketPool::getInUseCount() const {
-    return mInUseCount.load();
+    return mCore->inUseCount.load(std::memory_order_relaxed);
 }
 
 bool FramePacketPool::isEmpty() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mAvailable.empty();
+    return getAvailableCount() == 0;
 }
 
 bool FramePacketPool::isFull() const {
-    return mInUseCount.load() == 0 && getAvailableCount() == mConfig.capacity;
+    return getInUseCount() == 0 && getAvailableCount() == mConfig.capacity;
 }
 
 void FramePacketPool::setCapacity(uint32_t capacity) {
-    std::lock_guard<std::mutex> lock(mMutex);
     mConfig.capacity = capacity;
+    mCore->capacity.store(capacity, std::memory_order_relaxed);
+    
+    // 缩容：释放超出容量的空闲帧包，使用中的在归还时释放
+    FramePacket* packet = nullptr;
+    while (mCore->totalCreated.load(std::memory_order_relaxed) > capacity &&
+           mCore->freePackets.tryPop(packet)) {
+        delete packet;
+        mCore->totalCreated.fetch_sub(1, std::memory_order_relaxed);
+    }
 }
 
 void FramePacketPool::setBackpressureEnabled(bool enabled) {
     mConfig.enableBackpressure = enabled;
 }
 
+uint64_t FramePacketPool::getTotalReleases() const {
+    return mCore->totalReleases.load(std::memory_order_relaxed);
+}
+
+uint32_t FramePacketPool::getCreatedCount() const {
+    return mCore->totalCreated.load(std::memory_order_relaxed);
+}
+
 void FramePacketPool::resetStats() {
     mTotalAllocations.store(0);
-    mTotalReleases.store(0);
+    mCore->totalReleases.store(0);
     mBlockCount.store(0);
     mTimeoutCount.store(0);
 }
 
-FramePacketPtr FramePacketPool::createPacket() {
-    auto packet = std::make_shared<FramePacket>(mNextFrameId.fetch_add(1));
-    packet->setPool(this);
-    mTotalCreated.fetch_add(1);
-    return packet;
+// =============================================================================
+// BufferPoolCore
+// =============================================================================
+
+namespace detail {
+
+/**
+ * @brief 缓冲池共享状态
+ *
+ * 由池与所有在外缓冲的回收删除器共同持有，池销毁后仍可安全归还。
+ */
+struct BufferPoolCore {
+    // 尺寸级：kMinClassSize 为第 0 级，此后每个 2 的幂分 kSubClasses 级
+    static constexpr uint32_t kMinClassBits = 8;
+    static constexpr uint32_t kSubClassBits = 2;
+    static constexpr uint32_t kSubClasses = 1u << kSubClassBits;
+    static constexpr uint32_t kClassCount = (64 - kMinClassBits) * kSubClasses + 1;
+    static_assert((size_t(1) << kMinClassBits) == BufferPool::kMinClassSize, "class size mismatch");
+    
+    struct FreeBuffer {
+        uint8_t* data;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+    
+    explicit BufferPoolCore(const BufferPoolConfig& cfg)
+        : config(cfg)
+        , freeLists(kClassCount)
+        , maxPooledBytes(cfg.maxPooledBytes) {}
+    
+    ~BufferPoolCore() {
+        for (auto& list : freeLists) {
+            for (auto& buffer : list) {
+                freeBuffer(buffer.data);
+            }
+        }
+    }
+    
+    static uint32_t highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+        uint32_t bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+    
+    static uint32_t classIndex(size_t size) {
+        if (size <= BufferPool::kMinClassSize) {
+            return 0;
+        }
+        uint64_t value = static_cast<uint64_t>(size) - 1;
+        uint32_t msb = highestBit(value);
+        uint32_t shift = msb - kSubClassBits;
+        uint32_t sub = static_cast<uint32_t>(value >> shift) & (kSubClasses - 1);
+        return (msb - kMinClassBits) * kSubClasses + sub + 1;
+    }
+    
+    static size_t classSize(uint32_t index) {
+        if (index == 0) {
+            return BufferPool::kMinClassSize;
+        }
+        uint32_t group = (index - 1) / kSubClasses;
+        size_t sub = (index - 1) % kSubClasses;
+        size_t base = BufferPool::kMinClassSize << group;
+        return base + (sub + 1) * (base >> kSubClassBits);
+    }
+    
+    static uint8_t* allocateBuffer(size_t size) {
+        return static_cast<uint8_t*>(::operator new(size, std::align_val_t(BufferPool::kAlignment)));
+    }
+    
+    static void freeBuffer(uint8_t* data) {
+        ::operator delete(data, std::align_val_t(BufferPool::kAlignment));
+    }
+    
+    mutable std::mutex mutex;
+    BufferPoolConfig config;                        // mutex 保护
+    std::vector<std::vector<FreeBuffer>> freeLists; // mutex 保护，每级按归还时间排序
+    
+    std::atomic<size_t> maxPooledBytes;             // config.maxPooledBytes 的无锁副本
+    std::atomic<size_t> pooledBytes{0};             // 共享空闲链表
+    std::atomic<size_t> threadCachedBytes{0};       // 各线程缓存（trimShared 无法触及）
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> epoch{0};                 // trim/clear 递增，使线程缓存失效
+    std::atomic<bool> shutdown{false};
+    
+    /**
+     * @brief 从共享空闲链表取缓冲（取最近归还的，缓存更热）
+     */
+    uint8_t* popShared(uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& list = freeLists[index];
+        if (list.empty()) {
+            return nullptr;
+        }
+        uint8_t* data = list.back().data;
+        list.pop_back();
+        pooledBytes.fetch_sub(classSize(index), std::memory_order_relaxed);
+        return data;
+    }
+    
+    /**
+     * @brief 归还到共享空闲链表，超出上限时直接释放
+     */
+    void pushShared(uint8_t* data, uint32_t index) {
+        size_t size = classSize(index);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& list = freeLists[index];
+            if (!shutdown.load(std::memory_order_relaxed) &&
+                list.size() < config.maxBuffersPerClass &&
+                pooledBytes.load(std::memory_order_relaxed) +
+                    threadCachedBytes.load(std::memory_order_relaxed) + size <= config.maxPooledBytes) {
+                list.push_back({data, std::chrono::steady_clock::now()});
+                pooledBytes.fetch_add(size, std::memory_order_relaxed);
+                return;
+            }
+        }
+        freeBuffer(data);
+    }
+    
+    /**
+     * @brief 释放满足条件的空闲缓冲（从最久未用的开始）
+     */
+    template <typename ShouldFree>
+    size_t trimShared(ShouldFree&& shouldFree) {
+        std::vector<uint8_t*> victims;
+        size_t freed = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // 大尺寸级优先，以较少的释放次数回收更多内存
+            for (uint32_t index = kClassCount; index-- > 0;) {
+                auto& list = freeLists[index];
+                size_t size = classSize(index);
+                size_t count = 0;
+                while (count < list.size() && shouldFree(list[count], list.size() - count)) {
+                    victims.push_back(list[count].data);
+                    freed += size;
+                    pooledBytes.fetch_sub(size, std::memory_order_relaxed);
+                    ++count;
+                }
+                list.erase(list.begin(), list.begin() + static_cast<std::ptrdiff_t>(count));
+            }
+            epoch.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (uint8_t* data : victims) {
+            freeBuffer(data);
+        }
+        return freed;
+    }
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::BufferPoolCore;
+
+/**
+ * @brief 线程缓存：保存少量本线程最近归还的小缓冲，同线程再次取用时不加锁
+ * 
+ * 其他线程的 trim/clear 无法释放这里的缓冲，只能等本线程下次归还或退出，
+ * 因此只缓存不超过 kThreadCacheMaxSize 的尺寸级，字节数单独计入 threadCachedBytes。
+ */
+struct ThreadBufferCache {
+    static constexpr size_t kSlots = 2;
+    
+    struct Slot {
+        std::shared_ptr<BufferPoolCore> core;   // 保证归还时池状态仍有效
+        uint8_t* data = nullptr;
+        uint32_t index = 0;
+        uint64_t epoch = 0;
+    };
+    
+    ThreadBufferCache();
+    ~ThreadBufferCache();
+    
+    uint8_t* take(BufferPoolCore* core, uint32_t index) {
+        uint64_t epoch = core->epoch.load(std::memory_order_relaxed);
+        for (auto& slot : slots) {
+            if (slot.data && slot.core.get() == core && slot.index == index && slot.epoch == epoch) {
+                uint8_t* data = slot.data;
+                core->threadCachedBytes.fetch_sub(BufferPoolCore::classSize(index), std::memory_order_relaxed);
+                slot.data = nullptr;
+                slot.core.reset();
+                return data;
+            }
+        }
+        return nullptr;
+    }
+    
+    bool put(const std::shared_ptr<BufferPoolCore>& core, uint8_t* data, uint32_t index) {
+        size_t size = BufferPoolCore::classSize(index);
+        if (size > BufferPool::kThreadCacheMaxSize ||
+            core->pooledBytes.load(std::memory_order_relaxed) +
+                core->threadCachedBytes.load(std::memory_order_relaxed) + size >
+            core->maxPooledBytes.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        Slot* target = nullptr;
+        for (auto& slot : slots) {
+            // 已失效（trim/clear 之后）的缓存缓冲直接释放
+            if (slot.data && slot.core->epoch.load(std::memory_order_relaxed) != slot.epoch) {
+                evict(slot, false);
+            }
+            if (!slot.data && !target) {
+                target = &slot;
+            }
+        }
+        if (!target) {
+            // 轮换：最早放入的槽位退回共享链表
+            target = &slots[next];
+            next = (next + 1) % kSlots;
+            evict(*target, true);
+        }
+        target->core = core;
+        target->data = data;
+        target->index = index;
+        target->epoch = core->epoch.load(std::memory_order_relaxed);
+        core->threadCachedBytes.fetch_add(size, std::memory_order_relaxed);
+        return true;
+    }
+    
+    static void evict(Slot& slot, bool keep) {
+        if (!slot.data) {
+            return;
+        }
+        slot.core->threadCachedBytes.fetch_sub(BufferPoolCore::classSize(slot.index), std::memory_order_relaxed);
+        if (keep) {
+            slot.core->pushShared(slot.data, slot.index);
+        } else {
+            BufferPoolCore::freeBuffer(slot.data);
+        }
+        slot.data = nullptr;
+        slot.core.reset();
+    }
+    
+    Slot slots[kSlots];
+    size_t next = 0;
+};
+
+// 线程退出析构后不再访问线程缓存（其他 thread_local 对象析构时仍可能归还缓冲）
+enum class ThreadCacheState : uint8_t { Uninitialized, Alive, Destroyed };
+thread_local ThreadCacheState tCacheState = ThreadCacheState::Uninitialized;
+
+ThreadBufferCache::ThreadBufferCache() {
+    tCacheState = ThreadCacheState::Alive;
 }
 
-void FramePacketPool::resetPacket(FramePacketPtr packet) {
-    if (packet) {
-        packet->reset();
+ThreadBufferCache::~ThreadBufferCache() {
+    tCacheState = ThreadCacheState::Destroyed;
+    for (auto& slot : slots) {
+        evict(slot, true);
+    }
+}
+
+ThreadBufferCache* threadCache() {
+    if (tCacheState == ThreadCacheState::Destroyed) {
+        return nullptr;
     }
+    thread_local ThreadBufferCache cache;
+    return &cache;
 }
 
+/**
+ * @brief 回收删除器：最后一个引用释放时归还缓冲
+ */
+struct BufferRecycler {
+    std::shared_ptr<BufferPoolCore> core;
+    uint32_t index;
+    
+    void operator()(uint8_t* data) const {
+        core->liveBytes.fetch_sub(BufferPoolCore::classSize(index), std::memory_order_relaxed);
+        if (core->shutdown.load(std::memory_order_acquire)) {
+            BufferPoolCore::freeBuffer(data);
+            return;
+        }
+        ThreadBufferCache* cache = threadCache();
+        if (!cache || !cache->put(core, data, index)) {
+            core->pushShared(data, index);
+        }
+    }
+};
+
+} // namespace
+
 // =============================================================================
 // BufferPool
 // =============================================================================
 
 BufferPool::BufferPool(size_t maxBuffers)
-    : mMaxBuffers(maxBuffers)
+    : BufferPool([maxBuffers] {
+        BufferPoolConfig config;
+        config.maxBuffersPerClass = maxBuffers;
+        return config;
+    }())
+{
+}
+
+BufferPool::BufferPool(const BufferPoolConfig& config)
+    : mCore(std::make_shared<BufferPoolCore>(config))
 {
 }
 
 BufferPool::~BufferPool() {
+    // 在外的缓冲仍持有状态，归还时直接释放
+    mCore->shutdown.store(true, std::memory_order_release);
     clear();
 }
 
-std::shared_ptr<uint8_t> BufferPool::acquire(size_t size) {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    // 查找匹配大小的缓冲区
-    for (auto it = mBuffers.begin(); it != mBuffers.end(); ++it) {
-        if (it->size >= size) {
-            auto buffer = std::move(it->buffer);
-            mTotalMemory.fetch_sub(it->size);
-            mBuffers.erase(it);
-            return buffer;
-        }
-    }
-    
-    // 创建新缓冲区（使用 delete[] 删除器）
-    uint8_t* rawBuffer = new uint8_t[size];
-    return std::shared_ptr<uint8_t>(rawBuffer, [](uint8_t* p) { delete[] p; });
+BufferPool& BufferPool::shared() {
+    // 不析构：静态对象析构期间仍可能有缓冲归还
+    static BufferPool* pool = new BufferPool(BufferPoolConfig());
+    return *pool;
 }
 
-void BufferPool::release(std::shared_ptr<uint8_t> buffer, size_t size) {
-    if (!buffer || size == 0) return;
+std::shared_ptr<uint8_t> BufferPool::acquire(size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
     
-    std::lock_guard<std::mutex> lock(mMutex);
+    uint32_t index = BufferPoolCore::classIndex(size);
+    size_t capacity = BufferPoolCore::classSize(index);
     
-    // 检查是否超出限制
-    if (mBuffers.size() >= mMaxBuffers) {
-        // 移除最旧的缓冲区
-        if (!mBuffers.empty()) {
-            mTotalMemory.fetch_sub(mBuffers.front().size);
-            mBuffers.erase(mBuffers.begin());
-        }
+    uint8_t* data = nullptr;
+    if (ThreadBufferCache* cache = threadCache()) {
+        data = cache->take(mCore.get(), index);
     }
+    if (!data) {
+        data = mCore->popShared(index);
+    }
+    if (data) {
+        mCore->hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        data = BufferPoolCore::allocateBuffer(capacity);
+        mCore->misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    mCore->liveBytes.fetch_add(capacity, std::memory_order_relaxed);
     
-    BufferEntry entry;
-    entry.buffer = std::move(buffer);
-    entry.size = size;
-    entry.lastUsed = std::chrono::steady_clock::now();
-    
-    mBuffers.push_back(std::move(entry));
-    mTotalMemory.fetch_add(size);
+    return std::shared_ptr<uint8_t>(data, BufferRecycler{mCore, index});
+}
+
+void BufferPool::release(std::shared_ptr<uint8_t> buffer, size_t size) {
+    (void)size;
+    // 池内缓冲由回收删除器归还
+    buffer.reset();
 }
 
 void BufferPool::clear() {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mBuffers.clear();
-    mTotalMemory.store(0);
+    trim(0);
+}
+
+size_t BufferPool::trim(size_t targetBytes) {
+    return mCore->trimShared([this, targetBytes](const BufferPoolCore::FreeBuffer&, size_t) {
+        return mCore->pooledBytes.load(std::memory_order_relaxed) > targetBytes;
+    });
+}
+
+size_t BufferPool::trimIdle(std::chrono::milliseconds idleTime) {
+    auto deadline = std::chrono::steady_clock::now() - idleTime;
+    return mCore->trimShared([deadline](const BufferPoolCore::FreeBuffer& buffer, size_t) {
+        return buffer.lastUsed <= deadline;
+    });
+}
+
+void BufferPool::setConfig(const BufferPoolConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(mCore->mutex);
+        mCore->config = config;
+        mCore->maxPooledBytes.store(config.maxPooledBytes, std::memory_order_relaxed);
+    }
+    // 按新上限收缩：每级保留最近归还的 maxBuffersPerClass 个
+    mCore->trimShared([this, config](const BufferPoolCore::FreeBuffer&, size_t remaining) {
+        return remaining > config.maxBuffersPerClass ||
+               mCore->pooledBytes.load(std::memory_order_relaxed) > config.maxPooledBytes;
+    });
+}
+
+BufferPoolConfig BufferPool::getConfig() const {
+    std::lock_guard<std::mutex> lock(mCore->mutex);
+    return mCore->config;
 }
 
 size_t BufferPool::getMemoryUsage() const {
-    return mTotalMemory.load();
+    return mCore->pooledBytes.load(std::memory_order_relaxed) +
+           mCore->threadCachedBytes.load(std::memory_order_relaxed);
+}
+
+BufferPoolStats BufferPool::getStats() const {
+    BufferPoolStats stats;
+    stats.pooledBytes = mCore->pooledBytes.load(std::memory_order_relaxed);
+    stats.threadCachedBytes = mCore->threadCachedBytes.load(std::memory_order_relaxed);
+    stats.liveBytes = mCore->liveBytes.load(std::memory_order_relaxed);
+    stats.hits = mCore->hits.load(std::memory_order_relaxed);
+    stats.misses = mCore->misses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t BufferPool::getAllocationSize(size_t size) {
+    return BufferPoolCore::classSize(BufferPoolCore::classIndex(size));
 }
 
 } // namespace pipeline
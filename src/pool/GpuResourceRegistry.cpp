@@ -0,0 +1,208 @@
+/**
+ * @file GpuResourceRegistry.cpp
+ * @brief GpuResourceRegistry实现
+ */
+
+#include "pipeline/pool/GpuResourceRegistry.h"
+#include "pipeline/utils/PipelineLog.h"
+
+// LREngine头文件
+// #include "lrengine/core/LRRenderContext.h"
+// #include "lrengine/core/LRPipelineState.h"
+// #include "lrengine/core/LRBuffer.h"
+// #include "lrengine/core/LRSampler.h"
+
+namespace pipeline {
+
+GpuResourceRegistry::GpuResourceRegistry(lrengine::render::LRRenderContext* context)
+    : mRenderContext(context) {
+}
+
+GpuResourceRegistry::~GpuResourceRegistry() {
+    clear();
+}
+
+// =============================================================================
+// 获取
+// =============================================================================
+
+GpuResourceRegistry::VertexBufferPtr GpuResourceRegistry::acquireFullscreenQuad() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mFullscreenQuad) {
+        mFullscreenQuad = createFullscreenQuad();
+    }
+    return mFullscreenQuad;
+}
+
+GpuResourceRegistry::PipelineStatePtr GpuResourceRegistry::acquirePipelineState(
+    const ShaderProgramPtr& program, RasterBlend blend, PixelFormat colorFormat) {
+    if (!program) {
+        return nullptr;
+    }
+
+    const PipelineStateKey key{program.get(), blend, colorFormat};
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mPipelineStates.find(key);
+    if (it != mPipelineStates.end()) {
+        mPipelineStateHits.fetch_add(1, std::memory_order_relaxed);
+        return it->second.state;
+    }
+
+    PipelineStatePtr state = createPipelineState(program, blend, colorFormat);
+    if (!state) {
+        return nullptr;
+    }
+    mPipelineStateCreates.fetch_add(1, std::memory_order_relaxed);
+    mPipelineStates.emplace(key, PipelineStateEntry{program, state});
+    return state;
+}
+
+GpuResourceRegistry::SamplerPtr GpuResourceRegistry::acquireSampler(SamplerFilter filter,
+                                                                    SamplerWrap wrap) {
+    const auto key = std::make_pair(filter, wrap);
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mSamplers.find(key);
+    if (it != mSamplers.end()) {
+        return it->second;
+    }
+
+    SamplerPtr sampler = createSampler(filter, wrap);
+    if (!sampler) {
+        return nullptr;
+    }
+    mSamplerCreates.fetch_add(1, std::memory_order_relaxed);
+    mSamplers.emplace(key, sampler);
+    return sampler;
+}
+
+// =============================================================================
+// 释放
+// =============================================================================
+
+size_t GpuResourceRegistry::trim() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t removed = 0;
+    for (auto it = mPipelineStates.begin(); it != mPipelineStates.end();) {
+        // 只剩资源表引用：使用它的节点已销毁或换了程序
+        if (it->second.state.use_count() == 1) {
+            it = mPipelineStates.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+void GpuResourceRegistry::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mPipelineStates.empty() || !mSamplers.empty()) {
+        PIPELINE_LOGD("Releasing %zu pipeline states, %zu samplers",
+                      mPipelineStates.size(), mSamplers.size());
+    }
+    mPipelineStates.clear();
+    mSamplers.clear();
+    mFullscreenQuad.reset();
+}
+
+GpuResourceStats GpuResourceRegistry::getStats() const {
+    GpuResourceStats stats;
+    stats.pipelineStateHits = mPipelineStateHits.load(std::memory_order_relaxed);
+    stats.pipelineStateCreates = mPipelineStateCreates.load(std::memory_order_relaxed);
+    stats.samplerCreates = mSamplerCreates.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mMutex);
+    stats.cachedPipelineStates = mPipelineStates.size();
+    stats.cachedSamplers = mSamplers.size();
+    stats.hasFullscreenQuad = mFullscreenQuad != nullptr;
+    return stats;
+}
+
+// =============================================================================
+// 创建（LREngine）
+// =============================================================================
+
+GpuResourceRegistry::VertexBufferPtr GpuResourceRegistry::createFullscreenQuad() {
+    if (!mRenderContext) {
+        return nullptr;
+    }
+
+    // Position (x, y), TexCoord (u, v)
+    static const float kVertices[] = {
+        -1.0f, -1.0f,  0.0f, 0.0f,  // 左下
+         1.0f, -1.0f,  1.0f, 0.0f,  // 右下
+        -1.0f,  1.0f,  0.0f, 1.0f,  // 左上
+         1.0f,  1.0f,  1.0f, 1.0f,  // 右上
+    };
+    (void)kVertices;
+
+    /*
+    lrengine::render::BufferDescriptor bufDesc;
+    bufDesc.size = sizeof(kVertices);
+    bufDesc.usage = lrengine::render::BufferUsage::Static;
+    bufDesc.type = lrengine::render::BufferType::Vertex;
+    bufDesc.data = kVertices;
+    return VertexBufferPtr(mRenderContext->CreateVertexBuffer(bufDesc));
+    */
+    return nullptr;
+}
+
+GpuResourceRegistry::PipelineStatePtr GpuResourceRegistry::createPipelineState(
+    const ShaderProgramPtr& program, RasterBlend blend, PixelFormat colorFormat) {
+    if (!mRenderContext) {
+        return nullptr;
+    }
+    (void)program;
+    (void)blend;
+    (void)colorFormat;
+
+    /*
+    lrengine::render::PipelineStateDescriptor desc;
+    desc.shaderProgram = program.get();
+    desc.colorFormat = toLRPixelFormat(colorFormat);
+    desc.primitiveType = lrengine::render::PrimitiveType::TriangleStrip;
+    desc.blendState.enabled = blend != RasterBlend::None;
+    switch (blend) {
+        case RasterBlend::Alpha:
+            desc.blendState.srcColorFactor = lrengine::render::BlendFactor::SrcAlpha;
+            desc.blendState.dstColorFactor = lrengine::render::BlendFactor::OneMinusSrcAlpha;
+            desc.blendState.srcAlphaFactor = lrengine::render::BlendFactor::One;
+            desc.blendState.dstAlphaFactor = lrengine::render::BlendFactor::OneMinusSrcAlpha;
+            break;
+        case RasterBlend::Premultiplied:
+            desc.blendState.srcColorFactor = lrengine::render::BlendFactor::One;
+            desc.blendState.dstColorFactor = lrengine::render::BlendFactor::OneMinusSrcAlpha;
+            break;
+        case RasterBlend::Additive:
+            desc.blendState.srcColorFactor = lrengine::render::BlendFactor::One;
+            desc.blendState.dstColorFactor = lrengine::render::BlendFactor::One;
+            break;
+        case RasterBlend::None:
+            break;
+    }
+    return PipelineStatePtr(mRenderContext->CreatePipelineState(desc));
+    */
+    return nullptr;
+}
+
+GpuResourceRegistry::SamplerPtr GpuResourceRegistry::createSampler(SamplerFilter filter,
+                                                                   SamplerWrap wrap) {
+    if (!mRenderContext) {
+        return nullptr;
+    }
+    (void)filter;
+    (void)wrap;
+
+    /*
+    lrengine::render::SamplerDescriptor desc;
+    desc.minFilter = desc.magFilter = filter == SamplerFilter::Linear
+        ? lrengine::render::FilterMode::Linear : lrengine::render::FilterMode::Nearest;
+    desc.wrapS = desc.wrapT = wrap == SamplerWrap::Repeat
+        ? lrengine::render::WrapMode::Repeat
+        : wrap == SamplerWrap::MirroredRepeat ? lrengine::render::WrapMode::MirroredRepeat
+                                              : lrengine::render::WrapMode::ClampToEdge;
+    return SamplerPtr(mRenderContext->CreateSampler(desc));
+    */
+    return nullptr;
+}
+
+} // namespace pipeline
@@ -0,0 +1,154 @@
+/**
+ * @file ResourceHub.cpp
+ * @brief ResourceHub实现
+ */
+
+#include "pipeline/pool/ResourceHub.h"
+#include "pipeline/pool/GpuResourceRegistry.h"
+#include "pipeline/pool/ShaderProgramCache.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include "TaskQueue.h"
+#include "TaskQueueFactory.h"
+
+#include <algorithm>
+
+namespace pipeline {
+
+// =============================================================================
+// ResourceLease
+// =============================================================================
+
+ResourceLease::~ResourceLease() {
+    ResourceHub::shared().detach(this);
+}
+
+ResourceClientStats ResourceLease::getStats() const {
+    ResourceClientStats stats;
+    stats.name = mName;
+    stats.renderContext = mRenderContext;
+    if (mTexturePool) {
+        stats.textureCount = mTexturePool->getInUseCount();
+        stats.textureBytes = mTexturePool->getMemoryUsage();
+        stats.peakTextureBytes = mTexturePool->getPeakMemoryUsage();
+        stats.quotaBytes = mTexturePool->getQuotaBytes();
+        stats.quotaRejects = mTexturePool->getQuotaRejectCount();
+    }
+    return stats;
+}
+
+// =============================================================================
+// ResourceHub
+// =============================================================================
+
+ResourceHub& ResourceHub::shared() {
+    // 不析构：租约可能在静态对象析构期间才释放
+    static ResourceHub* hub = new ResourceHub();
+    return *hub;
+}
+
+ResourceLeasePtr ResourceHub::attach(lrengine::render::LRRenderContext* context,
+                                     const std::string& name,
+                                     const TexturePoolConfig& poolConfig,
+                                     const ResourceQuota& quota,
+                                     bool shareGPUQueue) {
+    if (!context) {
+        PIPELINE_LOGE("ResourceHub: attach without a render context");
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    ContextResources& resources = mContexts[context];
+
+    if (!resources.texturePool) {
+        resources.texturePool = std::make_shared<TexturePool>(context, poolConfig);
+        resources.gpuResources = std::make_shared<GpuResourceRegistry>(context);
+    } else {
+        // 已有管线在用：只放宽，避免后来者收紧别人的池
+        TexturePoolConfig merged = resources.texturePool->getConfig();
+        merged.maxTexturesPerBucket = std::max(merged.maxTexturesPerBucket, poolConfig.maxTexturesPerBucket);
+        merged.maxTotalTextures = std::max(merged.maxTotalTextures, poolConfig.maxTotalTextures);
+        merged.idleTimeoutMs = std::max(merged.idleTimeoutMs, poolConfig.idleTimeoutMs);
+        if (merged.maxBytes > 0) {
+            merged.maxBytes = poolConfig.maxBytes > 0 ? std::max(merged.maxBytes, poolConfig.maxBytes) : 0;
+        }
+        resources.texturePool->setConfig(merged);
+    }
+
+    if (shareGPUQueue && !resources.gpuQueue) {
+        // 与执行器自建的GPU队列相同：独占高优先级线程
+        resources.gpuQueue = task::TaskQueueFactory::GetInstance().createSerialTaskQueue(
+            "Pipeline.GPU.Shared", task::WorkThreadPriority::WTP_High, true);
+        if (!resources.gpuQueue) {
+            PIPELINE_LOGW("ResourceHub: failed to create shared GPU queue, %s keeps its own", name.c_str());
+        }
+    }
+
+    ResourceLeasePtr lease(new ResourceLease());
+    lease->mName = name;
+    lease->mRenderContext = context;
+    lease->mTexturePool = TexturePool::createView(resources.texturePool, quota.textureBytes);
+    lease->mGpuResources = resources.gpuResources;
+    if (shareGPUQueue) {
+        lease->mGPUQueue = resources.gpuQueue;
+    }
+    resources.leases.push_back(lease.get());
+
+    PIPELINE_LOGI("ResourceHub: %s attached (%zu pipeline(s) on context %p)",
+                  name.c_str(), resources.leases.size(), static_cast<void*>(context));
+    return lease;
+}
+
+void ResourceHub::detach(ResourceLease* lease) {
+    ContextResources released;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mContexts.find(lease->mRenderContext);
+        if (it == mContexts.end()) {
+            return;
+        }
+        auto& leases = it->second.leases;
+        leases.erase(std::remove(leases.begin(), leases.end(), lease), leases.end());
+        if (!leases.empty()) {
+            return;
+        }
+        released = std::move(it->second);
+        mContexts.erase(it);
+    }
+
+    // 最后一条管线离开：上下文上的共享对象随之失效，在锁外释放
+    ShaderProgramCache::instance().purge(lease->mRenderContext);
+    if (released.gpuResources) {
+        released.gpuResources->clear();
+    }
+    if (released.texturePool) {
+        released.texturePool->clear();
+    }
+    PIPELINE_LOGI("ResourceHub: released shared resources of context %p",
+                  static_cast<void*>(lease->mRenderContext));
+}
+
+std::vector<ResourceClientStats> ResourceHub::getClientStats() const {
+    std::vector<ResourceClientStats> stats;
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& [context, resources] : mContexts) {
+        for (const ResourceLease* lease : resources.leases) {
+            stats.push_back(lease->getStats());
+        }
+    }
+    return stats;
+}
+
+size_t ResourceHub::getClientCount(lrengine::render::LRRenderContext* context) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mContexts.find(context);
+    return it != mContexts.end() ? it->second.leases.size() : 0;
+}
+
+size_t ResourceHub::getTextureMemoryUsage(lrengine::render::LRRenderContext* context) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mContexts.find(context);
+    return it != mContexts.end() && it->second.texturePool ? it->second.texturePool->getMemoryUsage() : 0;
+}
+
+} // namespace pipeline
@@ -0,0 +1,278 @@
+/**
+ * @file ShaderProgramCache.cpp
+ * @brief ShaderProgramCache实现
+ */
+
+#include "pipeline/pool/ShaderProgramCache.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace pipeline {
+
+namespace {
+
+constexpr uint32_t kBinaryMagic = 0x42505350;   // "PSPB"
+constexpr uint32_t kBinaryVersion = 1;
+constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+// 磁盘文件头：源码哈希用两种种子各算一次，文件名之外再校验一次，避免冲突时加载错误的程序
+struct BinaryHeader {
+    uint32_t magic = kBinaryMagic;
+    uint32_t version = kBinaryVersion;
+    uint64_t sourceHash = 0;
+    uint64_t sourceCheck = 0;
+    uint64_t driverHash = 0;
+    uint64_t payloadSize = 0;
+    uint64_t payloadHash = 0;
+};
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = kFnvOffset) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+uint64_t sourceCheckHash(const std::string& vertexSource, const std::string& fragmentSource) {
+    uint64_t hash = fnv1a(fragmentSource.data(), fragmentSource.size(), kFnvOffset ^ 0x9E3779B97F4A7C15ull);
+    return fnv1a(vertexSource.data(), vertexSource.size(), hash);
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// 单例与配置
+// =============================================================================
+
+ShaderProgramCache& ShaderProgramCache::instance() {
+    static ShaderProgramCache sInstance;
+    return sInstance;
+}
+
+void ShaderProgramCache::setDiskCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mDiskMutex);
+    mDirectory = directory;
+    while (!mDirectory.empty() && (mDirectory.back() == '/' || mDirectory.back() == '\\')) {
+        mDirectory.pop_back();
+    }
+}
+
+void ShaderProgramCache::setBinaryBackend(std::unique_ptr<ProgramBinaryBackend> backend) {
+    std::lock_guard<std::mutex> lock(mDiskMutex);
+    mBackend = std::move(backend);
+    mDriverKeyHash = 0;
+}
+
+uint64_t ShaderProgramCache::hashSource(const std::string& vertexSource,
+                                        const std::string& fragmentSource) {
+    uint64_t hash = fnv1a(vertexSource.data(), vertexSource.size());
+    // 分隔符：避免 ("ab", "c") 与 ("a", "bc") 相同
+    const uint8_t separator = 0xFF;
+    hash = fnv1a(&separator, 1, hash);
+    return fnv1a(fragmentSource.data(), fragmentSource.size(), hash);
+}
+
+// =============================================================================
+// 获取
+// =============================================================================
+
+ShaderProgramPtr ShaderProgramCache::acquire(lrengine::render::LRRenderContext* context,
+                                             const std::string& vertexSource,
+                                             const std::string& fragmentSource,
+                                             const CompileFunc& compile) {
+    const uint64_t hash = hashSource(vertexSource, fragmentSource);
+    const Key key{context, hash};
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto range = mEntries.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.vertexSource == vertexSource &&
+                it->second.fragmentSource == fragmentSource) {
+                mMemoryHits.fetch_add(1, std::memory_order_relaxed);
+                return it->second.program;
+            }
+        }
+    }
+
+    // 编译/加载在锁外进行（耗时且需在GPU线程），竞争插入时保留先到者
+    bool collided = false;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        collided = mEntries.count(key) > 0;
+    }
+    const uint64_t check = sourceCheckHash(vertexSource, fragmentSource);
+    ShaderProgramPtr program;
+    if (!collided) {
+        program = loadFromDisk(context, hash, check);
+        if (program) {
+            mDiskHits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!program) {
+        if (!compile) {
+            return nullptr;
+        }
+        program = compile();
+        if (!program) {
+            return nullptr;
+        }
+        mCompiles.fetch_add(1, std::memory_order_relaxed);
+        if (!collided) {
+            storeToDisk(*program, hash, check);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto range = mEntries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.vertexSource == vertexSource &&
+            it->second.fragmentSource == fragmentSource) {
+            return it->second.program;
+        }
+    }
+    mEntries.emplace(key, Entry{vertexSource, fragmentSource, program});
+    return program;
+}
+
+size_t ShaderProgramCache::purge(lrengine::render::LRRenderContext* context) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t removed = 0;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (!context || it->first.first == context) {
+            it = mEntries.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+size_t ShaderProgramCache::trim() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t removed = 0;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->second.program.use_count() == 1) {
+            it = mEntries.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+ShaderCacheStats ShaderProgramCache::getStats() const {
+    ShaderCacheStats stats;
+    stats.memoryHits = mMemoryHits.load(std::memory_order_relaxed);
+    stats.diskHits = mDiskHits.load(std::memory_order_relaxed);
+    stats.compiles = mCompiles.load(std::memory_order_relaxed);
+    stats.binaryWrites = mBinaryWrites.load(std::memory_order_relaxed);
+    stats.binaryRejects = mBinaryRejects.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mMutex);
+    stats.cachedPrograms = mEntries.size();
+    return stats;
+}
+
+// =============================================================================
+// 磁盘持久化
+// =============================================================================
+
+std::string ShaderProgramCache::binaryPath(uint64_t hash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    return mDirectory + "/" + name;
+}
+
+uint64_t ShaderProgramCache::driverKeyHash() {
+    if (mDriverKeyHash == 0 && mBackend) {
+        std::string driverKey = mBackend->getDriverKey();
+        mDriverKeyHash = fnv1a(driverKey.data(), driverKey.size()) | 1;
+    }
+    return mDriverKeyHash;
+}
+
+ShaderProgramPtr ShaderProgramCache::loadFromDisk(lrengine::render::LRRenderContext* context,
+                                                  uint64_t hash, uint64_t check) {
+    std::lock_guard<std::mutex> lock(mDiskMutex);
+    if (mDirectory.empty() || !mBackend) {
+        return nullptr;
+    }
+
+    const std::string path = binaryPath(hash);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    BinaryHeader header;
+    std::vector<uint8_t> payload;
+    bool valid = static_cast<bool>(file.read(reinterpret_cast<char*>(&header), sizeof(header))) &&
+                 header.magic == kBinaryMagic && header.version == kBinaryVersion &&
+                 header.sourceHash == hash && header.sourceCheck == check &&
+                 header.driverHash == driverKeyHash() &&
+                 header.payloadSize > 0 && header.payloadSize < (64u << 20);
+    if (valid) {
+        payload.resize(static_cast<size_t>(header.payloadSize));
+        valid = static_cast<bool>(file.read(reinterpret_cast<char*>(payload.data()),
+                                            static_cast<std::streamsize>(payload.size()))) &&
+                fnv1a(payload.data(), payload.size()) == header.payloadHash;
+    }
+    file.close();
+
+    ShaderProgramPtr program = valid ? mBackend->loadBinary(context, payload) : nullptr;
+    if (!program) {
+        // 驱动升级、文件损坏：删除后重新编译写入
+        std::remove(path.c_str());
+        mBinaryRejects.fetch_add(1, std::memory_order_relaxed);
+        PIPELINE_LOGD("Discarded stale shader binary %s", path.c_str());
+    }
+    return program;
+}
+
+void ShaderProgramCache::storeToDisk(lrengine::render::LRShaderProgram& program,
+                                     uint64_t hash, uint64_t check) {
+    std::lock_guard<std::mutex> lock(mDiskMutex);
+    if (mDirectory.empty() || !mBackend) {
+        return;
+    }
+
+    std::vector<uint8_t> payload;
+    if (!mBackend->saveBinary(program, payload) || payload.empty()) {
+        return;
+    }
+
+    BinaryHeader header;
+    header.sourceHash = hash;
+    header.sourceCheck = check;
+    header.driverHash = driverKeyHash();
+    header.payloadSize = payload.size();
+    header.payloadHash = fnv1a(payload.data(), payload.size());
+
+    // 先写临时文件再改名：进程中途被杀也不会留下半个文件
+    const std::string path = binaryPath(hash);
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file ||
+            !file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !file.write(reinterpret_cast<const char*>(payload.data()),
+                        static_cast<std::streamsize>(payload.size()))) {
+            PIPELINE_LOGW("Failed to write shader binary %s", tempPath.c_str());
+            std::remove(tempPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return;
+    }
+    mBinaryWrites.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace pipeline
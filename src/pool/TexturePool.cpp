@@ -4,6 +4,9 @@
  */
 
 #include "pipeline/pool/TexturePool.h"
+#include "pipeline/data/GpuCommandContext.h"
+#include "pipeline/utils/PipelineLog.h"
+#include "pipeline/utils/PipelineTrace.h"
 #include <algorithm>
 
 // LREngine头文件
@@ -23,6 +26,21 @@ TexturePool::~TexturePool() {
     clear();
 }
 
+std::shared_ptr<TexturePool> TexturePool::createView(std::shared_ptr<TexturePool> upstream,
+                                                     size_t quotaBytes) {
+    if (!upstream) {
+        return nullptr;
+    }
+    // 视图之上再取视图时直接指向共享池，归还只经过一层转发
+    if (upstream->mUpstream) {
+        upstream = upstream->mUpstream;
+    }
+    auto view = std::make_shared<TexturePool>(upstream->mRenderContext, upstream->getConfig());
+    view->mUpstream = std::move(upstream);
+    view->mQuotaBytes.store(quotaBytes, std::memory_order_relaxed);
+    return view;
+}
+
 // =============================================================================
 // 纹理获取和释放
 // =============================================================================
@@ -35,54 +53,104 @@ std::shared_ptr<lrengine::render::LRTexture> TexturePool::acquire(
 }
 
 std::shared_ptr<lrengine::render::LRTexture> TexturePool::acquire(const TextureSpec& spec) {
-    std::lock_guard<std::mutex> lock(mMutex);
+    if (mUpstream) {
+        return acquireThroughView(spec);
+    }
     
-    // 查找对应的桶
-    auto it = mBuckets.find(spec);
-    if (it != mBuckets.end()) {
-        auto texture = acquireFromBucket(it->second);
+    // victims 先于锁声明，保证淘汰的纹理在解锁后才销毁
+    TextureList victims;
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        trimIdleLocked(now, victims);
+        
+        auto texture = acquireFromBucket(getBucketLocked(spec));
         if (texture) {
-            mHitCount.fetch_add(1);
+            mHitCount.fetch_add(1, std::memory_order_relaxed);
             return texture;
         }
     }
     
-    // 桶中没有可用纹理，创建新的
-    mMissCount.fetch_add(1);
-    return createTexture(spec);
+    // 桶中没有可用纹理，在锁外创建新的
+    mMissCount.fetch_add(1, std::memory_order_relaxed);
+    if (PipelineTrace::isEnabled()) {
+        // value 为 (width << 32) | height
+        PipelineTrace::instant("TexturePool.miss", "pool", 0, 0,
+                               (static_cast<uint64_t>(spec.width) << 32) | spec.height);
+    }
+    std::shared_ptr<lrengine::render::LRTexture> texture;
+    {
+        TraceScope trace("TexturePool.create", "pool");
+        texture = createTexture(spec);
+    }
+    if (!texture) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(mMutex);
+    Bucket& bucket = getBucketLocked(spec);
+    if (mConfig.maxBytes > 0 && mConfig.enableLRU) {
+        // 为新纹理腾出预算；在用纹理不会被淘汰，预算仅可能被在用纹理暂时突破
+        size_t target = mConfig.maxBytes > bucket.textureBytes ? mConfig.maxBytes - bucket.textureBytes : 0;
+        evictLocked(target, victims);
+    }
+    registerTextureLocked(bucket, texture, true, now);
+    return texture;
 }
 
 std::shared_ptr<lrengine::render::LRTexture> TexturePool::acquireFromBucket(Bucket& bucket) {
-    for (auto& entry : bucket.entries) {
-        if (!entry.inUse) {
-            entry.inUse = true;
-            entry.lastUsed = std::chrono::steady_clock::now();
-            return entry.texture;
-        }
+    // 取最近归还的纹理（对驱动缓存最友好）
+    TextureEntry* entry = bucket.freeHead;
+    if (!entry) {
+        return nullptr;
     }
-    return nullptr;
+    removeIdleLocked(entry);
+    entry->inUse = true;
+    entry->lastUsed = std::chrono::steady_clock::now();
+    return entry->texture;
 }
 
 void TexturePool::release(std::shared_ptr<lrengine::render::LRTexture> texture) {
     if (!texture) {
         return;
     }
+    if (mUpstream) {
+        releaseThroughView(std::move(texture));
+        return;
+    }
     
+    TextureList victims;
     std::lock_guard<std::mutex> lock(mMutex);
     
-    // 查找纹理所在的桶
-    for (auto& [spec, bucket] : mBuckets) {
-        for (auto& entry : bucket.entries) {
-            if (entry.texture == texture) {
-                entry.inUse = false;
-                entry.lastUsed = std::chrono::steady_clock::now();
-                mTotalReleased.fetch_add(1);
-                return;
-            }
+    auto it = mEntries.find(texture.get());
+    if (it == mEntries.end() || !it->second->inUse) {
+        // 纹理不在池中，忽略（让其自然销毁）
+        return;
+    }
+    
+    TextureEntry* entry = it->second.get();
+    Bucket& bucket = *entry->bucket;
+    auto now = std::chrono::steady_clock::now();
+    entry->inUse = false;
+    entry->lastUsed = now;
+    mTotalReleased.fetch_add(1, std::memory_order_relaxed);
+    
+    bool keep = bucket.freeCount < mConfig.maxTexturesPerBucket &&
+                mTotalCount.load(std::memory_order_relaxed) <= mConfig.maxTotalTextures;
+    if (keep && mConfig.maxBytes > 0 && mTotalBytes.load(std::memory_order_relaxed) > mConfig.maxBytes) {
+        // 超出预算：先淘汰更久未用的空闲纹理，仍超出则不回收本纹理
+        if (mConfig.enableLRU) {
+            evictLocked(mConfig.maxBytes, victims);
         }
+        keep = mTotalBytes.load(std::memory_order_relaxed) <= mConfig.maxBytes;
     }
     
-    // 纹理不在池中，忽略（让其自然销毁）
+    if (keep) {
+        pushIdleLocked(entry);
+    } else {
+        destroyEntryLocked(entry, victims);
+    }
+    trimIdleLocked(now, victims);
 }
 
 std::shared_ptr<lrengine::render::LRTexture> TexturePool::acquireAutoRelease(
@@ -93,20 +161,89 @@ std::shared_ptr<lrengine::render::LRTexture> TexturePool::acquireAutoRelease(
         return nullptr;
     }
     
-    // 创建自定义删除器，释放时归还到池
-    auto* pool = this;
+    // 创建自定义删除器，释放时归还到池（非 shared_ptr 持有的池沿用裸指针，由调用方保证生命周期）
+    // 视图先于纹理销毁时直接还给共享池，否则共享池中的条目会一直处于在用状态
+    std::weak_ptr<TexturePool> weakPool = weak_from_this();
+    std::weak_ptr<TexturePool> weakUpstream = mUpstream;
+    TexturePool* rawPool = weakPool.expired() ? this : nullptr;
     return std::shared_ptr<lrengine::render::LRTexture>(
         texture.get(),
-        [pool, originalTexture = texture](lrengine::render::LRTexture*) mutable {
-            pool->release(originalTexture);
+        [weakPool, weakUpstream, rawPool, originalTexture = texture](lrengine::render::LRTexture*) mutable {
+            if (rawPool) {
+                rawPool->release(std::move(originalTexture));
+            } else if (auto pool = weakPool.lock()) {
+                pool->release(std::move(originalTexture));
+            } else if (auto upstream = weakUpstream.lock()) {
+                upstream->release(std::move(originalTexture));
+            }
         });
 }
 
+// =============================================================================
+// 视图
+// =============================================================================
+
+std::shared_ptr<lrengine::render::LRTexture> TexturePool::acquireThroughView(const TextureSpec& spec) {
+    const size_t bytes = calculateTextureSize(spec);
+    const size_t quota = mQuotaBytes.load(std::memory_order_relaxed);
+    
+    // 先在锁内预留字节，并发取出时不会一起越过配额
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const size_t used = mTotalBytes.load(std::memory_order_relaxed);
+        if (quota > 0 && used + bytes > quota) {
+            if (mQuotaRejects.fetch_add(1, std::memory_order_relaxed) == 0) {
+                PIPELINE_LOGW("TexturePool view over quota: %zu + %zu > %zu bytes", used, bytes, quota);
+            }
+            return nullptr;
+        }
+        mTotalBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    
+    auto texture = mUpstream->acquire(spec);
+    
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!texture) {
+        mTotalBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        return nullptr;
+    }
+    mViewTextures[texture.get()] = bytes;
+    mTotalCount.fetch_add(1, std::memory_order_relaxed);
+    updatePeakBytes(mTotalBytes.load(std::memory_order_relaxed));
+    return texture;
+}
+
+void TexturePool::releaseThroughView(std::shared_ptr<lrengine::render::LRTexture> texture) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mViewTextures.find(texture.get());
+        if (it == mViewTextures.end()) {
+            // 不是经本视图取出的纹理
+            return;
+        }
+        mTotalBytes.fetch_sub(it->second, std::memory_order_relaxed);
+        mTotalCount.fetch_sub(1, std::memory_order_relaxed);
+        mViewTextures.erase(it);
+    }
+    mTotalReleased.fetch_add(1, std::memory_order_relaxed);
+    mUpstream->release(std::move(texture));
+}
+
+void TexturePool::updatePeakBytes(size_t bytes) {
+    size_t peak = mPeakBytes.load(std::memory_order_relaxed);
+    while (bytes > peak && !mPeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+    }
+}
+
 // =============================================================================
 // 池管理
 // =============================================================================
 
 void TexturePool::warmup(const std::vector<TextureSpec>& specs) {
+    if (mUpstream) {
+        mUpstream->warmup(specs);
+        return;
+    }
     for (const auto& spec : specs) {
         warmup(spec.width, spec.height, spec.format, 2);
     }
@@ -114,74 +251,76 @@ void TexturePool::warmup(const std::vector<TextureSpec>& specs) {
 
 void TexturePool::warmup(uint32_t width, uint32_t height, 
                          PixelFormat format, uint32_t count) {
+    if (mUpstream) {
+        mUpstream->warmup(width, height, format, count);
+        return;
+    }
     std::lock_guard<std::mutex> lock(mMutex);
     
     TextureSpec spec{width, height, format};
-    auto& bucket = mBuckets[spec];
+    Bucket& bucket = getBucketLocked(spec);
+    auto now = std::chrono::steady_clock::now();
     
-    for (uint32_t i = 0; i < count && bucket.entries.size() < mConfig.maxTexturesPerBucket; ++i) {
+    for (uint32_t i = 0; i < count && bucket.totalCount < mConfig.maxTexturesPerBucket; ++i) {
+        if (mTotalCount.load(std::memory_order_relaxed) >= mConfig.maxTotalTextures ||
+            (mConfig.maxBytes > 0 &&
+             mTotalBytes.load(std::memory_order_relaxed) + bucket.textureBytes > mConfig.maxBytes)) {
+            break;
+        }
         auto texture = createTexture(spec);
-        if (texture) {
-            TextureEntry entry;
-            entry.texture = texture;
-            entry.spec = spec;
-            entry.lastUsed = std::chrono::steady_clock::now();
-            entry.inUse = false;
-            bucket.entries.push_back(std::move(entry));
+        if (!texture) {
+            break;
         }
+        registerTextureLocked(bucket, std::move(texture), false, now);
     }
 }
 
 void TexturePool::cleanup() {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    auto now = std::chrono::steady_clock::now();
-    auto timeout = std::chrono::milliseconds(mConfig.idleTimeoutMs);
-    
-    for (auto& [spec, bucket] : mBuckets) {
-        bucket.entries.erase(
-            std::remove_if(bucket.entries.begin(), bucket.entries.end(),
-                [&](const TextureEntry& entry) {
-                    if (entry.inUse) {
-                        return false;
-                    }
-                    auto idle = now - entry.lastUsed;
-                    return idle > timeout;
-                }),
-            bucket.entries.end());
+    if (mUpstream) {
+        mUpstream->cleanup();
+        return;
     }
+    TextureList victims;
+    std::lock_guard<std::mutex> lock(mMutex);
+    trimIdleLocked(std::chrono::steady_clock::now(), victims, true);
 }
 
 void TexturePool::clear() {
+    if (mUpstream) {
+        // 共享池的纹理由其他管线继续使用，视图只在归还时转发
+        return;
+    }
+    
+    // 在用纹理由持有者继续引用，归还时因不在池中而被忽略
+    std::unordered_map<const lrengine::render::LRTexture*, std::unique_ptr<TextureEntry>> entries;
     std::lock_guard<std::mutex> lock(mMutex);
+    entries.swap(mEntries);
     mBuckets.clear();
+    mLruHead = nullptr;
+    mLruTail = nullptr;
+    mTotalCount.store(0, std::memory_order_relaxed);
+    mIdleCount.store(0, std::memory_order_relaxed);
+    mTotalBytes.store(0, std::memory_order_relaxed);
 }
 
 void TexturePool::shrink() {
+    if (mUpstream) {
+        mUpstream->shrink();
+        return;
+    }
+    TextureList victims;
     std::lock_guard<std::mutex> lock(mMutex);
-    
-    // 移除超出限制的纹理（保留最近使用的）
-    for (auto& [spec, bucket] : mBuckets) {
-        if (bucket.entries.size() > mConfig.maxTexturesPerBucket) {
-            // 按最后使用时间排序
-            std::sort(bucket.entries.begin(), bucket.entries.end(),
-                [](const TextureEntry& a, const TextureEntry& b) {
-                    return a.lastUsed > b.lastUsed;
-                });
-            
-            // 移除超出限制的（不在使用中的）
-            while (bucket.entries.size() > mConfig.maxTexturesPerBucket) {
-                auto it = std::find_if(bucket.entries.rbegin(), bucket.entries.rend(),
-                    [](const TextureEntry& e) { return !e.inUse; });
-                
-                if (it != bucket.entries.rend()) {
-                    bucket.entries.erase(std::next(it).base());
-                } else {
-                    break;
-                }
-            }
-        }
+    shrinkLocked(victims);
+}
+
+size_t TexturePool::trim(size_t targetBytes) {
+    if (mUpstream) {
+        // 只有空闲纹理会被淘汰，不影响其他管线在用的纹理
+        return mUpstream->trim(targetBytes);
     }
+    TextureList victims;
+    std::lock_guard<std::mutex> lock(mMutex);
+    return evictLocked(targetBytes, victims);
 }
 
 // =============================================================================
@@ -189,72 +328,40 @@ void TexturePool::shrink() {
 // =============================================================================
 
 size_t TexturePool::getAvailableCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    size_t count = 0;
-    for (const auto& [spec, bucket] : mBuckets) {
-        for (const auto& entry : bucket.entries) {
-            if (!entry.inUse) {
-                ++count;
-            }
-        }
+    if (mUpstream) {
+        return mUpstream->getAvailableCount();
     }
-    return count;
+    return mIdleCount.load(std::memory_order_relaxed);
 }
 
 size_t TexturePool::getAvailableCount(const TextureSpec& spec) const {
+    if (mUpstream) {
+        return mUpstream->getAvailableCount(spec);
+    }
     std::lock_guard<std::mutex> lock(mMutex);
     
     auto it = mBuckets.find(spec);
-    if (it == mBuckets.end()) {
-        return 0;
-    }
-    
-    size_t count = 0;
-    for (const auto& entry : it->second.entries) {
-        if (!entry.inUse) {
-            ++count;
-        }
-    }
-    return count;
+    return it != mBuckets.end() ? it->second->freeCount : 0;
 }
 
 size_t TexturePool::getInUseCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    size_t count = 0;
-    for (const auto& [spec, bucket] : mBuckets) {
-        for (const auto& entry : bucket.entries) {
-            if (entry.inUse) {
-                ++count;
-            }
-        }
-    }
-    return count;
+    size_t total = mTotalCount.load(std::memory_order_relaxed);
+    size_t idle = mIdleCount.load(std::memory_order_relaxed);
+    return total > idle ? total - idle : 0;
 }
 
 size_t TexturePool::getTotalCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    size_t count = 0;
-    for (const auto& [spec, bucket] : mBuckets) {
-        count += bucket.entries.size();
-    }
-    return count;
+    return mTotalCount.load(std::memory_order_relaxed);
 }
 
 size_t TexturePool::getMemoryUsage() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    
-    size_t total = 0;
-    for (const auto& [spec, bucket] : mBuckets) {
-        size_t textureSize = calculateTextureSize(spec);
-        total += textureSize * bucket.entries.size();
-    }
-    return total;
+    return mTotalBytes.load(std::memory_order_relaxed);
 }
 
 float TexturePool::getHitRate() const {
+    if (mUpstream) {
+        return mUpstream->getHitRate();
+    }
     uint64_t hits = mHitCount.load();
     uint64_t misses = mMissCount.load();
     uint64_t total = hits + misses;
@@ -278,9 +385,145 @@ void TexturePool::resetStats() {
 // =============================================================================
 
 void TexturePool::setConfig(const TexturePoolConfig& config) {
+    TextureList victims;
     std::lock_guard<std::mutex> lock(mMutex);
     mConfig = config;
-    shrink();
+    shrinkLocked(victims);
+}
+
+// =============================================================================
+// 链表与淘汰（均在 mMutex 内调用）
+// =============================================================================
+
+TexturePool::Bucket& TexturePool::getBucketLocked(const TextureSpec& spec) {
+    auto& bucket = mBuckets[spec];
+    if (!bucket) {
+        bucket = std::make_unique<Bucket>();
+        bucket->spec = spec;
+        bucket->textureBytes = calculateTextureSize(spec);
+    }
+    return *bucket;
+}
+
+void TexturePool::registerTextureLocked(Bucket& bucket,
+                                        std::shared_ptr<lrengine::render::LRTexture> texture,
+                                        bool inUse,
+                                        std::chrono::steady_clock::time_point now) {
+    auto entry = std::make_unique<TextureEntry>();
+    entry->texture = std::move(texture);
+    entry->bucket = &bucket;
+    entry->lastUsed = now;
+    entry->inUse = inUse;
+    
+    TextureEntry* raw = entry.get();
+    mEntries.emplace(raw->texture.get(), std::move(entry));
+    ++bucket.totalCount;
+    mTotalCount.fetch_add(1, std::memory_order_relaxed);
+    mTotalBytes.fetch_add(bucket.textureBytes, std::memory_order_relaxed);
+    updatePeakBytes(mTotalBytes.load(std::memory_order_relaxed));
+    if (!inUse) {
+        pushIdleLocked(raw);
+    }
+}
+
+void TexturePool::pushIdleLocked(TextureEntry* entry) {
+    Bucket& bucket = *entry->bucket;
+    
+    // 桶空闲链表：头部插入
+    entry->freePrev = nullptr;
+    entry->freeNext = bucket.freeHead;
+    if (bucket.freeHead) {
+        bucket.freeHead->freePrev = entry;
+    } else {
+        bucket.freeTail = entry;
+    }
+    bucket.freeHead = entry;
+    ++bucket.freeCount;
+    
+    // 全局LRU：尾部插入
+    entry->lruNext = nullptr;
+    entry->lruPrev = mLruTail;
+    if (mLruTail) {
+        mLruTail->lruNext = entry;
+    } else {
+        mLruHead = entry;
+    }
+    mLruTail = entry;
+    mIdleCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TexturePool::removeIdleLocked(TextureEntry* entry) {
+    Bucket& bucket = *entry->bucket;
+    
+    (entry->freePrev ? entry->freePrev->freeNext : bucket.freeHead) = entry->freeNext;
+    (entry->freeNext ? entry->freeNext->freePrev : bucket.freeTail) = entry->freePrev;
+    entry->freePrev = entry->freeNext = nullptr;
+    --bucket.freeCount;
+    
+    (entry->lruPrev ? entry->lruPrev->lruNext : mLruHead) = entry->lruNext;
+    (entry->lruNext ? entry->lruNext->lruPrev : mLruTail) = entry->lruPrev;
+    entry->lruPrev = entry->lruNext = nullptr;
+    mIdleCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TexturePool::destroyEntryLocked(TextureEntry* entry, TextureList& victims) {
+    Bucket& bucket = *entry->bucket;
+    --bucket.totalCount;
+    mTotalCount.fetch_sub(1, std::memory_order_relaxed);
+    mTotalBytes.fetch_sub(bucket.textureBytes, std::memory_order_relaxed);
+    
+    auto texture = std::move(entry->texture);
+    mEntries.erase(texture.get());
+    victims.push_back(std::move(texture));
+}
+
+size_t TexturePool::evictLocked(size_t targetBytes, TextureList& victims) {
+    size_t freed = 0;
+    while (mLruHead && mTotalBytes.load(std::memory_order_relaxed) > targetBytes) {
+        TextureEntry* entry = mLruHead;
+        freed += entry->bucket->textureBytes;
+        removeIdleLocked(entry);
+        destroyEntryLocked(entry, victims);
+    }
+    return freed;
+}
+
+void TexturePool::trimIdleLocked(std::chrono::steady_clock::time_point now, TextureList& victims,
+                                 bool force) {
+    if (!force && (mConfig.trimIntervalMs == 0 ||
+                   now - mLastTrimTime < std::chrono::milliseconds(mConfig.trimIntervalMs))) {
+        return;
+    }
+    mLastTrimTime = now;
+    
+    // LRU 头部最久未用，遇到未超时的即可停止
+    auto timeout = std::chrono::milliseconds(mConfig.idleTimeoutMs);
+    while (mLruHead && now - mLruHead->lastUsed > timeout) {
+        TextureEntry* entry = mLruHead;
+        removeIdleLocked(entry);
+        destroyEntryLocked(entry, victims);
+    }
+}
+
+void TexturePool::shrinkLocked(TextureList& victims) {
+    // 每个桶只保留最近使用的 maxTexturesPerBucket 个空闲纹理
+    for (auto& [spec, bucket] : mBuckets) {
+        while (bucket->freeCount > mConfig.maxTexturesPerBucket) {
+            TextureEntry* entry = bucket->freeTail;
+            removeIdleLocked(entry);
+            destroyEntryLocked(entry, victims);
+        }
+    }
+    
+    // 总量与预算
+    while (mLruHead && mTotalCount.load(std::memory_order_relaxed) > mConfig.maxTotalTextures) {
+        TextureEntry* entry = mLruHead;
+        removeIdleLocked(entry);
+        destroyEntryLocked(entry, victims);
+    }
+    if (mConfig.maxBytes > 0) {
+        evictLocked(mConfig.maxBytes, victims);
+    }
 }
 
 // =============================================================================
@@ -294,6 +537,9 @@ std::shared_ptr<lrengine::render::LRTexture> TexturePool::createTexture(const Te
     
     mTotalAllocated.fetch_add(1);
     
+    // 新纹理可能复用刚释放纹理的地址，已跟踪的绑定不再可信
+    GpuCommandContext::current().invalidateState();
+    
     // 使用LREngine创建纹理
     // 这里需要根据LREngine的实际API来实现
     /*
@@ -335,6 +581,8 @@ uint32_t TexturePool::convertPixelFormat(PixelFormat format) const {
             return 3;
         case PixelFormat::RGBA32F:
             return 4;
+        case PixelFormat::RGB10A2:
+            return 5; // lrengine::render::PixelFormat::RGB10A2
         default:
             return 0;
     }
@@ -0,0 +1,372 @@
+/**
+ * @file PixelKernels.cpp
+ * @brief CPU像素内核实现
+ */
+
+#include "pipeline/simd/PixelKernels.h"
+
+#include "libyuv.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define PIPELINE_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PIPELINE_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define PIPELINE_SIMD_AVX2 1
+#endif
+#endif
+
+namespace pipeline {
+namespace simd {
+
+namespace {
+
+std::atomic<bool> sSimdEnabled{true};
+
+// 灰度权重（和为256）
+constexpr uint32_t kGrayR = 77;
+constexpr uint32_t kGrayG = 150;
+constexpr uint32_t kGrayB = 29;
+
+CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#if defined(PIPELINE_SIMD_NEON)
+    features.neon = true;
+#endif
+#if defined(PIPELINE_SIMD_SSE2)
+    features.sse2 = true;
+#endif
+#if defined(PIPELINE_SIMD_AVX2)
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    return features;
+}
+
+// =============================================================================
+// 灰度转换（每行）
+// =============================================================================
+
+using GrayRowFn = uint32_t (*)(const uint8_t* rgba, uint8_t* gray, uint32_t width);
+
+void grayRowScalar(const uint8_t* rgba, uint8_t* gray, uint32_t begin, uint32_t width) {
+    for (uint32_t x = begin; x < width; ++x) {
+        const uint8_t* pixel = rgba + x * 4;
+        gray[x] = static_cast<uint8_t>((kGrayR * pixel[0] + kGrayG * pixel[1] + kGrayB * pixel[2]) >> 8);
+    }
+}
+
+#if defined(PIPELINE_SIMD_NEON)
+
+// 每次16像素：vld4 解交织后 16 位乘加，和不超过 255*256，无溢出
+uint32_t grayRowNeon(const uint8_t* rgba, uint8_t* gray, uint32_t width) {
+    const uint8x8_t wr = vdup_n_u8(kGrayR);
+    const uint8x8_t wg = vdup_n_u8(kGrayG);
+    const uint8x8_t wb = vdup_n_u8(kGrayB);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x4_t px = vld4q_u8(rgba + x * 4);
+        uint16x8_t lo = vmull_u8(vget_low_u8(px.val[0]), wr);
+        lo = vmlal_u8(lo, vget_low_u8(px.val[1]), wg);
+        lo = vmlal_u8(lo, vget_low_u8(px.val[2]), wb);
+        uint16x8_t hi = vmull_u8(vget_high_u8(px.val[0]), wr);
+        hi = vmlal_u8(hi, vget_high_u8(px.val[1]), wg);
+        hi = vmlal_u8(hi, vget_high_u8(px.val[2]), wb);
+        vst1q_u8(gray + x, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+    return x;
+}
+
+#endif
+
+#if defined(PIPELINE_SIMD_SSE2)
+
+// 每像素32位拆成 [R,B] 与 [G,A] 两组16位，madd 后得到 32 位加权和
+inline __m128i grayPixelsSse2(__m128i px, __m128i mask, __m128i wrb, __m128i wga) {
+    __m128i rb = _mm_and_si128(px, mask);
+    __m128i ga = _mm_and_si128(_mm_srli_epi16(px, 8), mask);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(rb, wrb), _mm_madd_epi16(ga, wga));
+    return _mm_srli_epi32(sum, 8);
+}
+
+uint32_t grayRowSse2(const uint8_t* rgba, uint8_t* gray, uint32_t width) {
+    const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+    const __m128i wrb = _mm_set1_epi32(static_cast<int>((kGrayB << 16) | kGrayR));
+    const __m128i wga = _mm_set1_epi32(static_cast<int>(kGrayG));
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i* src = reinterpret_cast<const __m128i*>(rgba + x * 4);
+        __m128i g0 = grayPixelsSse2(_mm_loadu_si128(src + 0), mask, wrb, wga);
+        __m128i g1 = grayPixelsSse2(_mm_loadu_si128(src + 1), mask, wrb, wga);
+        __m128i g2 = grayPixelsSse2(_mm_loadu_si128(src + 2), mask, wrb, wga);
+        __m128i g3 = grayPixelsSse2(_mm_loadu_si128(src + 3), mask, wrb, wga);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(g0, g1), _mm_packs_epi32(g2, g3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + x), packed);
+    }
+    return x;
+}
+
+#endif
+
+#if defined(PIPELINE_SIMD_AVX2)
+
+__attribute__((target("avx2")))
+inline __m256i grayPixelsAvx2(__m256i px, __m256i mask, __m256i wrb, __m256i wga) {
+    __m256i rb = _mm256_and_si256(px, mask);
+    __m256i ga = _mm256_and_si256(_mm256_srli_epi16(px, 8), mask);
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rb, wrb), _mm256_madd_epi16(ga, wga));
+    return _mm256_srli_epi32(sum, 8);
+}
+
+// 每次32像素；pack 按128位通道交错，最后用 permutevar 恢复像素顺序
+__attribute__((target("avx2")))
+uint32_t grayRowAvx2(const uint8_t* rgba, uint8_t* gray, uint32_t width) {
+    const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i wrb = _mm256_set1_epi32(static_cast<int>((kGrayB << 16) | kGrayR));
+    const __m256i wga = _mm256_set1_epi32(static_cast<int>(kGrayG));
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i* src = reinterpret_cast<const __m256i*>(rgba + x * 4);
+        __m256i g0 = grayPixelsAvx2(_mm256_loadu_si256(src + 0), mask, wrb, wga);
+        __m256i g1 = grayPixelsAvx2(_mm256_loadu_si256(src + 1), mask, wrb, wga);
+        __m256i g2 = grayPixelsAvx2(_mm256_loadu_si256(src + 2), mask, wrb, wga);
+        __m256i g3 = grayPixelsAvx2(_mm256_loadu_si256(src + 3), mask, wrb, wga);
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(g0, g1), _mm256_packs_epi32(g2, g3));
+        packed = _mm256_permutevar8x32_epi32(packed, order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gray + x), packed);
+    }
+    return x;
+}
+
+#endif
+
+GrayRowFn selectGrayRow() {
+    const CpuFeatures& features = cpuFeatures();
+    (void)features;
+#if defined(PIPELINE_SIMD_NEON)
+    if (features.neon) return grayRowNeon;
+#endif
+#if defined(PIPELINE_SIMD_AVX2)
+    if (features.avx2) return grayRowAvx2;
+#endif
+#if defined(PIPELINE_SIMD_SSE2)
+    if (features.sse2) return grayRowSse2;
+#endif
+    return nullptr;
+}
+
+// =============================================================================
+// 缩放（标量路径）
+// =============================================================================
+
+void scaleBilinearScalar(const uint8_t* src, uint32_t srcStride, uint32_t srcWidth, uint32_t srcHeight,
+                         uint8_t* dst, uint32_t dstStride, uint32_t dstWidth, uint32_t dstHeight,
+                         uint32_t channels) {
+    float xRatio = static_cast<float>(srcWidth) / dstWidth;
+    float yRatio = static_cast<float>(srcHeight) / dstHeight;
+
+    for (uint32_t y = 0; y < dstHeight; ++y) {
+        float srcY = y * yRatio;
+        uint32_t y0 = std::min(static_cast<uint32_t>(srcY), srcHeight - 1);
+        uint32_t y1 = std::min(y0 + 1, srcHeight - 1);
+        float yFrac = srcY - y0;
+        const uint8_t* row0 = src + static_cast<size_t>(y0) * srcStride;
+        const uint8_t* row1 = src + static_cast<size_t>(y1) * srcStride;
+        uint8_t* dstRow = dst + static_cast<size_t>(y) * dstStride;
+
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            float srcX = x * xRatio;
+            uint32_t x0 = std::min(static_cast<uint32_t>(srcX), srcWidth - 1);
+            uint32_t x1 = std::min(x0 + 1, srcWidth - 1);
+            float xFrac = srcX - x0;
+
+            for (uint32_t c = 0; c < channels; ++c) {
+                float v00 = row0[x0 * channels + c];
+                float v01 = row0[x1 * channels + c];
+                float v10 = row1[x0 * channels + c];
+                float v11 = row1[x1 * channels + c];
+
+                float v0 = v00 * (1 - xFrac) + v01 * xFrac;
+                float v1 = v10 * (1 - xFrac) + v11 * xFrac;
+                float v = v0 * (1 - yFrac) + v1 * yFrac;
+
+                dstRow[x * channels + c] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, v)));
+            }
+        }
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// CPU特性
+// =============================================================================
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+void setSimdEnabled(bool enabled) {
+    sSimdEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// =============================================================================
+// 颜色转换
+// =============================================================================
+
+void rgbaToGray(const uint8_t* rgba, uint32_t rgbaStride,
+                uint8_t* gray, uint32_t grayStride,
+                uint32_t width, uint32_t height) {
+    if (!rgba || !gray) {
+        return;
+    }
+    static const GrayRowFn simdRow = selectGrayRow();
+    GrayRowFn rowFn = sSimdEnabled.load(std::memory_order_relaxed) ? simdRow : nullptr;
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = rgba + static_cast<size_t>(y) * rgbaStride;
+        uint8_t* grayRow = gray + static_cast<size_t>(y) * grayStride;
+        uint32_t done = rowFn ? rowFn(row, grayRow, width) : 0;
+        grayRowScalar(row, grayRow, done, width);
+    }
+}
+
+bool rgbaToI420(const uint8_t* rgba, uint32_t rgbaStride,
+                uint8_t* y, uint32_t yStride,
+                uint8_t* u, uint32_t uStride,
+                uint8_t* v, uint32_t vStride,
+                uint32_t width, uint32_t height) {
+    return libyuv::ABGRToI420(rgba, static_cast<int>(rgbaStride),
+                              y, static_cast<int>(yStride),
+                              u, static_cast<int>(uStride),
+                              v, static_cast<int>(vStride),
+                              static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+bool rgbaToNV12(const uint8_t* rgba, uint32_t rgbaStride,
+                uint8_t* y, uint32_t yStride,
+                uint8_t* uv, uint32_t uvStride,
+                uint32_t width, uint32_t height) {
+    return libyuv::ABGRToNV12(rgba, static_cast<int>(rgbaStride),
+                              y, static_cast<int>(yStride),
+                              uv, static_cast<int>(uvStride),
+                              static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+bool i420ToRgba(const uint8_t* y, uint32_t yStride,
+                const uint8_t* u, uint32_t uStride,
+                const uint8_t* v, uint32_t vStride,
+                uint8_t* rgba, uint32_t rgbaStride,
+                uint32_t width, uint32_t height) {
+    return libyuv::I420ToABGR(y, static_cast<int>(yStride),
+                              u, static_cast<int>(uStride),
+                              v, static_cast<int>(vStride),
+                              rgba, static_cast<int>(rgbaStride),
+                              static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+bool nv12ToRgba(const uint8_t* y, uint32_t yStride,
+                const uint8_t* uv, uint32_t uvStride,
+                uint8_t* rgba, uint32_t rgbaStride,
+                uint32_t width, uint32_t height) {
+    return libyuv::NV12ToABGR(y, static_cast<int>(yStride),
+                              uv, static_cast<int>(uvStride),
+                              rgba, static_cast<int>(rgbaStride),
+                              static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+// =============================================================================
+// 缩放
+// =============================================================================
+
+bool scale(const uint8_t* src, uint32_t srcStride, uint32_t srcWidth, uint32_t srcHeight,
+           uint8_t* dst, uint32_t dstStride, uint32_t dstWidth, uint32_t dstHeight,
+           uint32_t channels, ScaleFilter filter) {
+    if (!src || !dst || srcWidth == 0 || srcHeight == 0 ||
+        dstWidth == 0 || dstHeight == 0 || channels == 0) {
+        return false;
+    }
+
+    libyuv::FilterMode mode = (filter == ScaleFilter::Box) ? libyuv::kFilterBox
+                                                            : libyuv::kFilterBilinear;
+    bool simd = sSimdEnabled.load(std::memory_order_relaxed);
+    if (simd && channels == 4) {
+        return libyuv::ARGBScale(src, static_cast<int>(srcStride),
+                                 static_cast<int>(srcWidth), static_cast<int>(srcHeight),
+                                 dst, static_cast<int>(dstStride),
+                                 static_cast<int>(dstWidth), static_cast<int>(dstHeight),
+                                 mode) == 0;
+    }
+    if (simd && channels == 1) {
+        libyuv::ScalePlane(src, static_cast<int>(srcStride),
+                           static_cast<int>(srcWidth), static_cast<int>(srcHeight),
+                           dst, static_cast<int>(dstStride),
+                           static_cast<int>(dstWidth), static_cast<int>(dstHeight),
+                           mode);
+        return true;
+    }
+
+    // 其他通道数（RGB888 等）：标量双线性，Box 同样按双线性处理
+    scaleBilinearScalar(src, srcStride, srcWidth, srcHeight,
+                        dst, dstStride, dstWidth, dstHeight, channels);
+    return true;
+}
+
+// =============================================================================
+// LUT与混合
+// =============================================================================
+
+bool applyChannelLut(const uint8_t* src, uint32_t srcStride,
+                     uint8_t* dst, uint32_t dstStride,
+                     uint32_t width, uint32_t height,
+                     const uint8_t* table) {
+    if (!src || !dst || !table) {
+        return false;
+    }
+
+    // libyuv 的查表为原地操作，先拷贝到目标
+    if (src != dst &&
+        libyuv::ARGBCopy(src, static_cast<int>(srcStride),
+                         dst, static_cast<int>(dstStride),
+                         static_cast<int>(width), static_cast<int>(height)) != 0) {
+        return false;
+    }
+    return libyuv::ARGBColorTable(dst, static_cast<int>(dstStride), table,
+                                  0, 0, static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+bool premultiplyAlpha(const uint8_t* src, uint32_t srcStride,
+                      uint8_t* dst, uint32_t dstStride,
+                      uint32_t width, uint32_t height) {
+    if (!src || !dst) {
+        return false;
+    }
+    // RGBA 与 libyuv ARGB 的 alpha 同在第4字节，颜色通道逐字节处理，顺序无关
+    return libyuv::ARGBAttenuate(src, static_cast<int>(srcStride),
+                                 dst, static_cast<int>(dstStride),
+                                 static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+bool blendOver(const uint8_t* fg, uint32_t fgStride,
+               const uint8_t* bg, uint32_t bgStride,
+               uint8_t* dst, uint32_t dstStride,
+               uint32_t width, uint32_t height) {
+    if (!fg || !bg || !dst) {
+        return false;
+    }
+    return libyuv::ARGBBlend(fg, static_cast<int>(fgStride),
+                             bg, static_cast<int>(bgStride),
+                             dst, static_cast<int>(dstStride),
+                             static_cast<int>(width), static_cast<int>(height)) == 0;
+}
+
+} // namespace simd
+} // namespace pipeline
@@ -0,0 +1,190 @@
+/**
+ * @file FrameArena.cpp
+ * @brief FrameArena实现
+ */
+
+#include "pipeline/utils/FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace pipeline {
+
+namespace {
+
+thread_local FrameArena* tCurrentArena = nullptr;
+
+void freeChunkData(uint8_t* data) {
+    ::operator delete(data, std::align_val_t(FrameArena::kChunkAlignment));
+}
+
+} // namespace
+
+// =============================================================================
+// FrameArena
+// =============================================================================
+
+FrameArena::FrameArena(size_t initialSize)
+    : mInitialSize(std::max<size_t>(initialSize, kChunkAlignment))
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    addChunkLocked(mInitialSize);
+}
+
+FrameArena::~FrameArena() {
+    for (auto& chunk : mChunks) {
+        freeChunkData(chunk->data);
+    }
+}
+
+FrameArena::Chunk* FrameArena::addChunkLocked(size_t capacity) {
+    auto chunk = std::make_unique<Chunk>();
+    chunk->data = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t(kChunkAlignment)));
+    chunk->capacity = capacity;
+    Chunk* raw = chunk.get();
+    mChunks.push_back(std::move(chunk));
+    mCurrent.store(raw, std::memory_order_release);
+    return raw;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    bytes = std::max<size_t>(bytes, 1);
+    for (;;) {
+        Chunk* chunk = mCurrent.load(std::memory_order_acquire);
+        const auto base = reinterpret_cast<uintptr_t>(chunk->data);
+        size_t used = chunk->used.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t offset = ((base + used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+            size_t end = offset + bytes;
+            if (end > chunk->capacity) {
+                break;
+            }
+            if (chunk->used.compare_exchange_weak(used, end, std::memory_order_relaxed)) {
+                return chunk->data + offset;
+            }
+        }
+
+        // 当前块用尽：追加更大的块（其他线程可能已追加）
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mCurrent.load(std::memory_order_relaxed) == chunk) {
+            addChunkLocked(std::max(chunk->capacity * 2, bytes + alignment));
+        }
+    }
+}
+
+void FrameArena::reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mChunks.size() == 1) {
+        mChunks.front()->used.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    // 合并为一块：容量取上一帧的总用量
+    size_t total = 0;
+    for (auto& chunk : mChunks) {
+        total += std::min(chunk->used.load(std::memory_order_relaxed), chunk->capacity);
+        freeChunkData(chunk->data);
+    }
+    mChunks.clear();
+    addChunkLocked(std::max(mInitialSize, total + total / 4));
+}
+
+size_t FrameArena::shrink() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mChunks.size() == 1 && mChunks.front()->capacity == mInitialSize) {
+        mChunks.front()->used.store(0, std::memory_order_relaxed);
+        return 0;
+    }
+    size_t capacity = 0;
+    for (auto& chunk : mChunks) {
+        capacity += chunk->capacity;
+        freeChunkData(chunk->data);
+    }
+    mChunks.clear();
+    addChunkLocked(mInitialSize);
+    return capacity > mInitialSize ? capacity - mInitialSize : 0;
+}
+
+size_t FrameArena::getBytesUsed() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t total = 0;
+    for (const auto& chunk : mChunks) {
+        total += std::min(chunk->used.load(std::memory_order_relaxed), chunk->capacity);
+    }
+    return total;
+}
+
+size_t FrameArena::getCapacity() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t total = 0;
+    for (const auto& chunk : mChunks) {
+        total += chunk->capacity;
+    }
+    return total;
+}
+
+FrameArena* FrameArena::current() {
+    return tCurrentArena;
+}
+
+// =============================================================================
+// FrameArenaScope
+// =============================================================================
+
+FrameArenaScope::FrameArenaScope(FrameArena* arena)
+    : mPrevious(tCurrentArena)
+{
+    tCurrentArena = arena;
+}
+
+FrameArenaScope::~FrameArenaScope() {
+    tCurrentArena = mPrevious;
+}
+
+// =============================================================================
+// FrameArenaPool
+// =============================================================================
+
+FrameArenaPool::FrameArenaPool(size_t chunkSize, size_t maxArenas)
+    : mCore(std::make_shared<Core>())
+{
+    mCore->chunkSize = chunkSize;
+    mCore->maxArenas = maxArenas;
+}
+
+std::shared_ptr<FrameArena> FrameArenaPool::acquire() {
+    std::unique_ptr<FrameArena> arena;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mutex);
+        if (!mCore->freeArenas.empty()) {
+            arena = std::move(mCore->freeArenas.back());
+            mCore->freeArenas.pop_back();
+        }
+    }
+    if (!arena) {
+        arena = std::make_unique<FrameArena>(mCore->chunkSize);
+    }
+
+    // 最后一个引用释放时本帧已无使用者，reset 后归还
+    std::shared_ptr<Core> core = mCore;
+    return std::shared_ptr<FrameArena>(arena.release(), [core](FrameArena* released) {
+        released->reset();
+        std::lock_guard<std::mutex> lock(core->mutex);
+        if (core->freeArenas.size() < core->maxArenas) {
+            core->freeArenas.emplace_back(released);
+        } else {
+            delete released;
+        }
+    });
+}
+
+size_t FrameArenaPool::shrink() {
+    std::lock_guard<std::mutex> lock(mCore->mutex);
+    size_t freed = 0;
+    for (auto& arena : mCore->freeArenas) {
+        freed += arena->shrink();
+    }
+    return freed;
+}
+
+} // namespace pipeline
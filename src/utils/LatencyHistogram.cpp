@@ -0,0 +1,135 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief LatencyHistogram实现
+ */
+
+#include "pipeline/utils/LatencyHistogram.h"
+#include <algorithm>
+
+namespace pipeline {
+
+namespace {
+
+uint32_t highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+    uint32_t bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : mBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint32_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<uint32_t>(value);
+    }
+    // 最高位决定分组，其后 kSubBucketBits 位决定组内桶
+    uint32_t msb = highestBit(value);
+    uint32_t shift = msb - kSubBucketBits;
+    uint32_t group = shift + 1;
+    uint32_t sub = static_cast<uint32_t>(value >> shift) & (kSubBuckets - 1);
+    return group * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(uint32_t index) {
+    uint32_t group = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    if (group == 0) {
+        return sub;
+    }
+    uint32_t shift = group - 1;
+    // 最后一组上界溢出回绕为 UINT64_MAX
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    mBuckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+    mSum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = mMin.load(std::memory_order_relaxed);
+    while (value < current &&
+           !mMin.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = mMax.load(std::memory_order_relaxed);
+    while (value > current &&
+           !mMax.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : mBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    mCount.store(0, std::memory_order_relaxed);
+    mSum.store(0, std::memory_order_relaxed);
+    mMin.store(UINT64_MAX, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentileFromCounts(const uint64_t* counts, uint64_t total,
+                                                double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+    percentile = std::min(100.0, std::max(0.0, percentile));
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // 桶上界不超过实际最大值
+            return std::min(bucketUpperBound(i), mMax.load(std::memory_order_relaxed));
+        }
+    }
+    return mMax.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = mBuckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    return percentileFromCounts(counts, total, percentile);
+}
+
+HistogramSummary LatencyHistogram::getSummary() const {
+    HistogramSummary summary;
+
+    // 先拷贝桶计数，三个百分位基于同一份快照
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = mBuckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return summary;
+    }
+
+    summary.count = total;
+    summary.min = mMin.load(std::memory_order_relaxed);
+    summary.max = mMax.load(std::memory_order_relaxed);
+    summary.mean = mSum.load(std::memory_order_relaxed) / std::max<uint64_t>(1, mCount.load(std::memory_order_relaxed));
+    summary.p50 = percentileFromCounts(counts, total, 50.0);
+    summary.p95 = percentileFromCounts(counts, total, 95.0);
+    summary.p99 = percentileFromCounts(counts, total, 99.0);
+    return summary;
+}
+
+} // namespace pipeline
@@ -0,0 +1,160 @@
+/**
+ * @file MetricsRegistry.cpp
+ * @brief MetricsRegistry实现
+ */
+
+#include "pipeline/utils/MetricsRegistry.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace pipeline {
+
+namespace {
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const MetricSample* MetricsSnapshot::find(const std::string& name) const {
+    auto it = std::find_if(samples.begin(), samples.end(),
+                           [&name](const MetricSample& sample) { return sample.name == name; });
+    return it != samples.end() ? &*it : nullptr;
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    stopPeriodicPush();
+}
+
+// =============================================================================
+// 自有指标
+// =============================================================================
+
+MetricCounter& MetricsRegistry::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& slot = mCounters[name];
+    if (!slot) {
+        slot = std::make_unique<MetricCounter>();
+    }
+    return *slot;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& slot = mGauges[name];
+    if (!slot) {
+        slot = std::make_unique<MetricGauge>();
+    }
+    return *slot;
+}
+
+// =============================================================================
+// 采集器
+// =============================================================================
+
+MetricsRegistry::CollectorId MetricsRegistry::addCollector(Collector collector) {
+    if (!collector) {
+        return kInvalidCollectorId;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    CollectorId id = mNextCollectorId++;
+    mCollectors.emplace_back(id, std::move(collector));
+    return id;
+}
+
+void MetricsRegistry::removeCollector(CollectorId id) {
+    // 快照在同一把锁下执行采集器，拿到锁即说明没有采集器在运行
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCollectors.erase(std::remove_if(mCollectors.begin(), mCollectors.end(),
+                                     [id](const auto& entry) { return entry.first == id; }),
+                      mCollectors.end());
+}
+
+// =============================================================================
+// 读取
+// =============================================================================
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot snapshot;
+    snapshot.timestampUs = nowUs();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    snapshot.samples.reserve(mCounters.size() + mGauges.size());
+    for (const auto& [name, counter] : mCounters) {
+        snapshot.addCounter(name, counter->get());
+    }
+    for (const auto& [name, gauge] : mGauges) {
+        snapshot.addGauge(name, gauge->get());
+    }
+    for (const auto& entry : mCollectors) {
+        entry.second(snapshot);
+    }
+    return snapshot;
+}
+
+// =============================================================================
+// 周期推送
+// =============================================================================
+
+bool MetricsRegistry::startPeriodicPush(uint32_t intervalMs, PushCallback callback) {
+    if (intervalMs == 0 || !callback) {
+        PIPELINE_LOGW("Metrics push requires a non-zero interval and a callback");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mPushMutex);
+    mPushIntervalMs = intervalMs;
+    mPushCallback = std::move(callback);
+    if (mPushThread.joinable()) {
+        mPushCondition.notify_all();
+        return true;
+    }
+    mPushStopping = false;
+    mPushThread = std::thread([this]() { pushLoop(); });
+    return true;
+}
+
+void MetricsRegistry::stopPeriodicPush() {
+    {
+        std::lock_guard<std::mutex> lock(mPushMutex);
+        if (!mPushThread.joinable()) {
+            return;
+        }
+        mPushStopping = true;
+    }
+    mPushCondition.notify_all();
+    mPushThread.join();
+
+    std::lock_guard<std::mutex> lock(mPushMutex);
+    mPushThread = std::thread();
+    mPushCallback = nullptr;
+}
+
+bool MetricsRegistry::isPushing() const {
+    std::lock_guard<std::mutex> lock(mPushMutex);
+    return mPushThread.joinable() && !mPushStopping;
+}
+
+void MetricsRegistry::pushLoop() {
+    auto next = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mPushMutex);
+    while (!mPushStopping) {
+        next += std::chrono::milliseconds(mPushIntervalMs);
+        if (mPushCondition.wait_until(lock, next, [this]() { return mPushStopping; })) {
+            break;
+        }
+        // 按固定节拍推送；回调过慢时不补推错过的周期
+        next = std::max(next, std::chrono::steady_clock::now() - std::chrono::milliseconds(mPushIntervalMs));
+
+        PushCallback callback = mPushCallback;
+        lock.unlock();
+        callback(snapshot());
+        lock.lock();
+    }
+}
+
+} // namespace pipeline
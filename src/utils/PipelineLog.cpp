@@ -5,14 +5,18 @@
 
 #include "pipeline/utils/PipelineLog.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <thread>
 #include <sstream>
+#include <vector>
 
 #if defined(_WIN32) || defined(_WIN64)
     #define PIPELINE_PLATFORM_WINDOWS 1
@@ -32,6 +36,11 @@
 
 namespace pipeline {
 
+namespace detail {
+std::atomic<bool> g_asyncEnabled{false};
+std::atomic<LogLevel> g_minLevel{LogLevel::Info};
+} // namespace detail
+
 namespace {
 
 // 线程本地格式化缓冲区
@@ -42,7 +51,6 @@ std::mutex s_callback_mutex;
 std::mutex s_file_mutex;
 LogCallback s_log_callback = nullptr;
 std::ofstream s_log_file;
-LogLevel s_min_level = LogLevel::Info;
 bool s_console_enabled = true;
 bool s_color_enabled = true;
 bool s_initialized = false;
@@ -216,12 +224,223 @@ void OutputToFile(const LogEntry& entry, const std::string& formattedTime) {
     }
 }
 
+// 输出一条日志到控制台、文件与回调
+void DispatchEntry(const LogEntry& entry) {
+    std::string formattedTime = FormatTimestamp(entry.timestamp);
+
+    if (s_console_enabled) {
+        OutputToConsole(entry, formattedTime);
+    }
+
+    OutputToFile(entry, formattedTime);
+
+    LogCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(s_callback_mutex);
+        callback = s_log_callback;
+    }
+    if (callback) {
+        callback(entry);
+    }
+}
+
+// ============================================================================
+// 异步模式
+// ============================================================================
+
+/**
+ * @brief 单线程写入、后台线程读出的记录环
+ */
+struct AsyncLogRing {
+    explicit AsyncLogRing(size_t capacity)
+        : records(capacity), mask(capacity - 1), threadId(GetCurrentThreadId()) {}
+
+    std::vector<detail::LogRecord> records;
+    const size_t mask;
+    const uint64_t threadId;
+    alignas(64) std::atomic<size_t> head{0};    // 写入位置（生产者）
+    alignas(64) std::atomic<size_t> tail{0};    // 读出位置（消费者）
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> orphaned{false};          // 所属线程已退出
+};
+
+struct PendingRecord {
+    const detail::LogRecord* record;
+    uint64_t threadId;
+};
+
+constexpr auto kAsyncDrainInterval = std::chrono::milliseconds(20);
+
+std::mutex s_ring_mutex;                         // 保护 s_rings 与新线程登记
+std::vector<std::shared_ptr<AsyncLogRing>> s_rings;
+size_t s_ring_capacity = 1024;
+std::mutex s_drain_mutex;                        // 同一时刻只有一个消费者
+std::mutex s_async_mutex;                        // 保护后台线程启停
+std::condition_variable s_async_cv;
+std::thread s_async_thread;
+bool s_async_stop = false;
+bool s_async_wake = false;
+std::atomic<uint64_t> s_async_dropped_total{0};
+
+/**
+ * @brief 线程本地的缓冲句柄：线程退出时把缓冲交给后台线程回收
+ */
+struct ThreadRingHandle {
+    std::shared_ptr<AsyncLogRing> ring;
+
+    ~ThreadRingHandle() {
+        if (ring) {
+            ring->orphaned.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadRingHandle s_thread_ring;
+
+AsyncLogRing* GetThreadRing() {
+    if (!s_thread_ring.ring) {
+        std::lock_guard<std::mutex> lock(s_ring_mutex);
+        s_thread_ring.ring = std::make_shared<AsyncLogRing>(s_ring_capacity);
+        s_rings.push_back(s_thread_ring.ring);
+    }
+    return s_thread_ring.ring.get();
+}
+
+void WakeAsyncThread() {
+    {
+        std::lock_guard<std::mutex> lock(s_async_mutex);
+        s_async_wake = true;
+    }
+    s_async_cv.notify_one();
+}
+
+// 汇总各线程缓冲中的记录，按时间排序后输出（调用方持有 s_drain_mutex）
+void DrainRingsLocked() {
+    std::vector<std::shared_ptr<AsyncLogRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(s_ring_mutex);
+        rings = s_rings;
+    }
+
+    std::vector<PendingRecord> pending;
+    std::vector<std::pair<AsyncLogRing*, size_t>> consumed;
+    uint64_t dropped = 0;
+    for (auto& ring : rings) {
+        const size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const size_t head = ring->head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i) {
+            pending.push_back({&ring->records[i & ring->mask], ring->threadId});
+        }
+        consumed.emplace_back(ring.get(), head);
+        dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingRecord& a, const PendingRecord& b) {
+        return a.record->timestampUs < b.record->timestampUs;
+    });
+
+    char message[4096];
+    for (const PendingRecord& item : pending) {
+        const detail::LogRecord& record = *item.record;
+        if (record.formatter) {
+            record.formatter(message, sizeof(message), record.format, record.payload);
+        } else {
+            std::memcpy(message, record.payload, detail::kLogRecordPayloadSize);
+            message[detail::kLogRecordPayloadSize - 1] = '\0';
+        }
+
+        LogEntry entry;
+        entry.level = record.level;
+        entry.message = message;
+        entry.file = record.file ? record.file : "";
+        entry.line = record.line;
+        entry.function = record.function ? record.function : "";
+        entry.timestamp = record.timestampUs / 1000;
+        entry.threadId = item.threadId;
+        DispatchEntry(entry);
+    }
+
+    // 输出完成后才归还槽位，记录内容在此之前不会被生产者覆盖
+    for (auto& slot : consumed) {
+        slot.first->tail.store(slot.second, std::memory_order_release);
+    }
+
+    if (dropped > 0) {
+        s_async_dropped_total.fetch_add(dropped, std::memory_order_relaxed);
+        LogEntry entry;
+        entry.level = LogLevel::Warning;
+        entry.message = "Async log buffer full, dropped " + std::to_string(dropped) + " records";
+        entry.line = 0;
+        entry.timestamp = GetTimestampMs();
+        entry.threadId = GetCurrentThreadId();
+        DispatchEntry(entry);
+    }
+
+    // 回收已退出且读空的线程缓冲
+    std::lock_guard<std::mutex> lock(s_ring_mutex);
+    s_rings.erase(std::remove_if(s_rings.begin(), s_rings.end(),
+                                 [](const std::shared_ptr<AsyncLogRing>& ring) {
+                                     return ring->orphaned.load(std::memory_order_acquire) &&
+                                            ring->tail.load(std::memory_order_relaxed) ==
+                                                ring->head.load(std::memory_order_acquire);
+                                 }),
+                  s_rings.end());
+}
+
+void AsyncThreadLoop() {
+    std::unique_lock<std::mutex> lock(s_async_mutex);
+    while (!s_async_stop) {
+        s_async_cv.wait_for(lock, kAsyncDrainInterval, [] { return s_async_stop || s_async_wake; });
+        s_async_wake = false;
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> drainLock(s_drain_mutex);
+            DrainRingsLocked();
+        }
+        lock.lock();
+    }
+}
+
 } // anonymous namespace
 
+namespace detail {
+
+int formatPrintf(char* out, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out, size, format, args);
+    va_end(args);
+    return written;
+}
+
+LogRecord* beginAsyncRecord() {
+    AsyncLogRing* ring = GetThreadRing();
+    const size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) > ring->mask) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    LogRecord* record = &ring->records[head & ring->mask];
+    record->timestampUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    return record;
+}
+
+void commitAsyncRecord(LogRecord* record) {
+    AsyncLogRing* ring = s_thread_ring.ring.get();
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    // 错误级别不等下一个周期，尽快输出
+    if (record->level >= LogLevel::Error) {
+        WakeAsyncThread();
+    }
+}
+
+} // namespace detail
+
 void PipelineLog::initialize() {
     if (s_initialized) return;
     s_initialized = true;
-    s_min_level = LogLevel::Info;
+    detail::g_minLevel.store(LogLevel::Info, std::memory_order_relaxed);
     s_console_enabled = true;
     s_color_enabled = true;
     s_tag = "Pipeline";
@@ -230,6 +449,7 @@ void PipelineLog::initialize() {
 void PipelineLog::shutdown() {
     if (!s_initialized) return;
 
+    disableAsync();
     flush();
     disableFileOutput();
 
@@ -251,7 +471,7 @@ void PipelineLog::logEx(LogLevel level,
                         int32_t line,
                         const char* function) {
     // 快速路径：级别检查
-    if (level < s_min_level || level == LogLevel::Off) return;
+    if (level < detail::g_minLevel.load(std::memory_order_relaxed) || level == LogLevel::Off) return;
 
     // 构建日志条目
     LogEntry entry;
@@ -263,25 +483,7 @@ void PipelineLog::logEx(LogLevel level,
     entry.timestamp = GetTimestampMs();
     entry.threadId = GetCurrentThreadId();
 
-    std::string formattedTime = FormatTimestamp(entry.timestamp);
-
-    // 控制台输出
-    if (s_console_enabled) {
-        OutputToConsole(entry, formattedTime);
-    }
-
-    // 文件输出
-    OutputToFile(entry, formattedTime);
-
-    // 回调
-    LogCallback callback;
-    {
-        std::lock_guard<std::mutex> lock(s_callback_mutex);
-        callback = s_log_callback;
-    }
-    if (callback) {
-        callback(entry);
-    }
+    DispatchEntry(entry);
 }
 
 void PipelineLog::logFormat(LogLevel level,
@@ -291,7 +493,7 @@ void PipelineLog::logFormat(LogLevel level,
                             const char* format,
                             ...) {
     // 快速路径：级别检查
-    if (level < s_min_level || level == LogLevel::Off) return;
+    if (level < detail::g_minLevel.load(std::memory_order_relaxed) || level == LogLevel::Off) return;
 
     va_list args;
     va_start(args, format);
@@ -323,11 +525,11 @@ void PipelineLog::logFormatV(LogLevel level,
 }
 
 void PipelineLog::setMinLevel(LogLevel level) {
-    s_min_level = level;
+    detail::g_minLevel.store(level, std::memory_order_relaxed);
 }
 
 LogLevel PipelineLog::getMinLevel() {
-    return s_min_level;
+    return detail::g_minLevel.load(std::memory_order_relaxed);
 }
 
 void PipelineLog::enableConsoleOutput(bool enable) {
@@ -369,6 +571,11 @@ void PipelineLog::setLogCallback(LogCallback callback) {
 }
 
 void PipelineLog::flush() {
+    {
+        std::lock_guard<std::mutex> drainLock(s_drain_mutex);
+        DrainRingsLocked();
+    }
+
     fflush(stderr);
 
     std::lock_guard<std::mutex> lock(s_file_mutex);
@@ -377,6 +584,55 @@ void PipelineLog::flush() {
     }
 }
 
+void PipelineLog::enableAsync(size_t recordsPerThread) {
+    std::lock_guard<std::mutex> lock(s_async_mutex);
+    if (s_async_thread.joinable()) {
+        return;
+    }
+
+    size_t capacity = 64;
+    while (capacity < recordsPerThread) {
+        capacity <<= 1;
+    }
+    {
+        // 只影响之后首次写日志的线程
+        std::lock_guard<std::mutex> ringLock(s_ring_mutex);
+        s_ring_capacity = capacity;
+    }
+
+    s_async_stop = false;
+    s_async_wake = false;
+    s_async_thread = std::thread(AsyncThreadLoop);
+    detail::g_asyncEnabled.store(true, std::memory_order_release);
+}
+
+void PipelineLog::disableAsync() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(s_async_mutex);
+        if (!s_async_thread.joinable()) {
+            return;
+        }
+        detail::g_asyncEnabled.store(false, std::memory_order_release);
+        s_async_stop = true;
+        thread = std::move(s_async_thread);
+    }
+    s_async_cv.notify_one();
+    thread.join();
+
+    // 关闭前已进入异步路径的记录在这里输出；缓冲保留，之后 flush 也会检查
+    std::lock_guard<std::mutex> drainLock(s_drain_mutex);
+    DrainRingsLocked();
+}
+
+bool PipelineLog::isAsync() {
+    return detail::g_asyncEnabled.load(std::memory_order_acquire);
+}
+
+uint64_t PipelineLog::getAsyncDroppedCount() {
+    return s_async_dropped_total.load(std::memory_order_relaxed);
+}
+
 const char* PipelineLog::getLevelString(LogLevel level) {
     switch (level) {
         case LogLevel::Trace:   return "TRACE";
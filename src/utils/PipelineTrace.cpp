@@ -0,0 +1,286 @@
+/**
+ * @file PipelineTrace.cpp
+ * @brief PipelineTrace实现
+ */
+
+#include "pipeline/utils/PipelineTrace.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace pipeline {
+
+namespace {
+
+/**
+ * @brief 追踪事件（定长，写入时无分配）
+ */
+struct TraceEvent {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    char phase = 'X';
+    int64_t timestampNs = 0;
+    int64_t durationNs = 0;
+    uint64_t entityId = 0;
+    uint64_t frameId = 0;
+    uint64_t value = 0;
+};
+
+/**
+ * @brief 每线程环形缓冲（单写者）
+ */
+struct ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity, uint32_t threadId)
+        : events(capacity), tid(threadId) {}
+
+    std::vector<TraceEvent> events;
+    std::atomic<uint64_t> written{0};
+    uint32_t tid = 0;
+    std::string threadName;      // sRegistryMutex 保护
+};
+
+std::mutex sRegistryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> sBuffers;
+std::unordered_map<uint64_t, std::string> sEntityNames;
+size_t sEventsPerThread = PipelineTrace::kDefaultEventsPerThread;
+
+// 缓冲在线程首次写入事件时创建；此前设置的线程名暂存于 tPendingName
+thread_local ThreadBuffer* tBuffer = nullptr;
+thread_local std::string tPendingName;
+thread_local bool tNamed = false;
+
+ThreadBuffer* currentBuffer() {
+    if (!tBuffer) {
+        std::lock_guard<std::mutex> lock(sRegistryMutex);
+        auto buffer = std::make_shared<ThreadBuffer>(
+            sEventsPerThread, static_cast<uint32_t>(sBuffers.size() + 1));
+        buffer->threadName = tPendingName;
+        tBuffer = buffer.get();
+        sBuffers.push_back(std::move(buffer));
+    }
+    return tBuffer;
+}
+
+void appendEvent(const TraceEvent& event) {
+    ThreadBuffer* buffer = currentBuffer();
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[index % buffer->events.size()] = event;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void appendJsonString(std::string& out, const char* text) {
+    out.push_back('"');
+    for (const char* p = text; p && *p; ++p) {
+        char c = *p;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace
+
+std::atomic<bool> PipelineTrace::sEnabled{false};
+
+// =============================================================================
+// 控制
+// =============================================================================
+
+void PipelineTrace::start(size_t eventsPerThread) {
+    sEnabled.store(false);
+    {
+        std::lock_guard<std::mutex> lock(sRegistryMutex);
+        sEventsPerThread = eventsPerThread > 0 ? eventsPerThread : kDefaultEventsPerThread;
+        for (auto& buffer : sBuffers) {
+            buffer->written.store(0, std::memory_order_relaxed);
+        }
+    }
+    sEnabled.store(true);
+    PIPELINE_LOGI("PipelineTrace started (%zu events per thread)", sEventsPerThread);
+}
+
+void PipelineTrace::stop() {
+    sEnabled.store(false);
+    PIPELINE_LOGI("PipelineTrace stopped (%zu events)", getEventCount());
+}
+
+int64_t PipelineTrace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// =============================================================================
+// 记录
+// =============================================================================
+
+void PipelineTrace::complete(const char* name, const char* category, int64_t startNs,
+                             int64_t durationNs, uint64_t entityId, uint64_t frameId) {
+    if (!isEnabled()) {
+        return;
+    }
+    TraceEvent event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'X';
+    event.timestampNs = startNs;
+    event.durationNs = durationNs;
+    event.entityId = entityId;
+    event.frameId = frameId;
+    appendEvent(event);
+}
+
+void PipelineTrace::instant(const char* name, const char* category, uint64_t entityId,
+                            uint64_t frameId, uint64_t value) {
+    if (!isEnabled()) {
+        return;
+    }
+    TraceEvent event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'i';
+    event.timestampNs = now();
+    event.entityId = entityId;
+    event.frameId = frameId;
+    event.value = value;
+    appendEvent(event);
+}
+
+void PipelineTrace::setEntityName(uint64_t entityId, const std::string& name) {
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    sEntityNames[entityId] = name;
+}
+
+void PipelineTrace::setThreadName(const std::string& name) {
+    tPendingName = name;
+    tNamed = true;
+    if (tBuffer) {
+        std::lock_guard<std::mutex> lock(sRegistryMutex);
+        tBuffer->threadName = name;
+    }
+}
+
+void PipelineTrace::setThreadNameIfUnset(const char* name) {
+    if (!tNamed) {
+        setThreadName(name);
+    }
+}
+
+// =============================================================================
+// 导出
+// =============================================================================
+
+size_t PipelineTrace::getEventCount() {
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    size_t count = 0;
+    for (const auto& buffer : sBuffers) {
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        count += static_cast<size_t>(std::min<uint64_t>(written, buffer->events.size()));
+    }
+    return count;
+}
+
+std::string PipelineTrace::exportChromeTrace() {
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+
+    std::string out;
+    out.reserve(4096);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char number[160];
+
+    for (const auto& buffer : sBuffers) {
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t capacity = buffer->events.size();
+        if (written == 0 && buffer->threadName.empty()) {
+            continue;
+        }
+
+        // 线程名元数据
+        if (!buffer->threadName.empty()) {
+            if (!first) out.push_back(',');
+            first = false;
+            std::snprintf(number, sizeof(number),
+                          "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":",
+                          buffer->tid);
+            out += number;
+            appendJsonString(out, buffer->threadName.c_str());
+            out += "}}";
+        }
+
+        uint64_t begin = written > capacity ? written - capacity : 0;
+        for (uint64_t i = begin; i < written; ++i) {
+            const TraceEvent& event = buffer->events[i % capacity];
+            if (!event.name) {
+                continue;
+            }
+            if (!first) out.push_back(',');
+            first = false;
+
+            // 名称：execute 事件直接使用Entity名称，其余为 "事件名:Entity名称"
+            std::string name = event.name;
+            if (event.entityId != 0) {
+                auto it = sEntityNames.find(event.entityId);
+                if (it != sEntityNames.end()) {
+                    name = std::strcmp(event.name, "execute") == 0
+                        ? it->second : name + ":" + it->second;
+                }
+            }
+
+            out += "{\"name\":";
+            appendJsonString(out, name.c_str());
+            out += ",\"cat\":";
+            appendJsonString(out, event.category ? event.category : "pipeline");
+            std::snprintf(number, sizeof(number),
+                          ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+                          event.phase, buffer->tid, static_cast<double>(event.timestampNs) / 1000.0);
+            out += number;
+            if (event.phase == 'X') {
+                std::snprintf(number, sizeof(number), ",\"dur\":%.3f",
+                              static_cast<double>(event.durationNs) / 1000.0);
+                out += number;
+            } else {
+                out += ",\"s\":\"t\"";
+            }
+            std::snprintf(number, sizeof(number),
+                          ",\"args\":{\"entity\":%" PRIu64 ",\"frame\":%" PRIu64 ",\"value\":%" PRIu64 "}}",
+                          event.entityId, event.frameId, event.value);
+            out += number;
+        }
+    }
+
+    out += "]}";
+    return out;
+}
+
+bool PipelineTrace::writeChromeTrace(const std::string& filepath) {
+    std::ofstream file(filepath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        PIPELINE_LOGE("Failed to open trace file: %s", filepath.c_str());
+        return false;
+    }
+    file << exportChromeTrace();
+    return file.good();
+}
+
+} // namespace pipeline
@@ -0,0 +1,498 @@
+/**
+ * @file pipeline_bench.cpp
+ * @brief Pipeline 性能基准（Google Benchmark）
+ *
+ * 覆盖帧包池、纹理池、图分层、输入格式转换、元数据读写、端到端合成图吞吐，
+ * 以及录制输入的回放（各Entity耗时，用于在同一负载上对比不同构建）。
+ * 运行示例：
+ * @code
+ * ./pipeline_bench --benchmark_filter=Convert --benchmark_repetitions=5
+ * PIPELINE_BENCH_RECORDING=/data/slow_case.plrec ./pipeline_bench --benchmark_filter=Replay
+ * @endcode
+ */
+
+#include "pipeline/core/PipelineConfig.h"
+#include "pipeline/core/PipelineExecutor.h"
+#include "pipeline/core/PipelineGraph.h"
+#include "pipeline/data/FramePacket.h"
+#include "pipeline/entity/ProcessEntity.h"
+#include "pipeline/input/FrameRecording.h"
+#include "pipeline/input/InputEntity.h"
+#include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/pool/TexturePool.h"
+#include "pipeline/utils/PipelineLog.h"
+
+#include <lrengine/core/LRRenderContext.h>
+#include <lrengine/core/LRTypes.h>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pipeline {
+namespace input {
+
+/**
+ * @brief 访问 InputEntity 的私有转换函数（仅基准使用）
+ */
+struct InputEntityBenchAccess {
+    static bool convertToRGBA(InputEntity& entity, const CPUInputData& data, uint8_t* output) {
+        return entity.convertToRGBA(data, output);
+    }
+};
+
+} // namespace input
+} // namespace pipeline
+
+using namespace pipeline;
+
+namespace {
+
+// =============================================================================
+// 公共辅助
+// =============================================================================
+
+/**
+ * @brief 模拟 GPU 节点：只透传输入，测量调度本身的开销
+ */
+class MockGPUEntity : public ProcessEntity {
+public:
+    explicit MockGPUEntity(const std::string& name, size_t inputCount = 1)
+        : ProcessEntity(name) {
+        for (size_t i = 0; i < inputCount; ++i) {
+            addInputPort("input" + std::to_string(i));
+        }
+        addOutputPort("output");
+    }
+
+    EntityType getType() const override { return EntityType::GPU; }
+
+protected:
+    bool process(const std::vector<FramePacketPtr>& inputs,
+                 std::vector<FramePacketPtr>& outputs,
+                 PipelineContext& context) override {
+        (void)context;
+        outputs.assign(1, inputs.empty() ? nullptr : inputs[0]);
+        return true;
+    }
+};
+
+/**
+ * @brief 源节点：由执行器直接注入输入帧包
+ */
+class MockSourceEntity : public ProcessEntity {
+public:
+    explicit MockSourceEntity(const std::string& name) : ProcessEntity(name) {
+        addOutputPort("output");
+    }
+
+    EntityType getType() const override { return EntityType::Input; }
+
+protected:
+    bool process(const std::vector<FramePacketPtr>& inputs,
+                 std::vector<FramePacketPtr>& outputs,
+                 PipelineContext& context) override {
+        (void)inputs;
+        (void)context;
+        (void)outputs;
+        return true;
+    }
+};
+
+/**
+ * @brief 构建 width 路并行、depth 层的菱形图：源 -> [width 条长 depth 的链] -> 合并
+ * @return 源节点 ID
+ */
+EntityId buildLayeredGraph(PipelineGraph& graph, int width, int depth) {
+    EntityId source = graph.addEntity(std::make_shared<MockSourceEntity>("source"));
+    auto sink = std::make_shared<MockGPUEntity>("sink", static_cast<size_t>(width));
+    EntityId sinkId = graph.addEntity(sink);
+
+    for (int branch = 0; branch < width; ++branch) {
+        EntityId previous = source;
+        for (int level = 0; level < depth; ++level) {
+            EntityId id = graph.addEntity(std::make_shared<MockGPUEntity>(
+                "node_" + std::to_string(branch) + "_" + std::to_string(level)));
+            graph.connect(previous, "output", id, "input0");
+            previous = id;
+        }
+        graph.connect(previous, "output", sinkId, "input" + std::to_string(branch));
+    }
+    return source;
+}
+
+struct ConvertCase {
+    input::InputFormat format;
+    const char* name;
+};
+
+const ConvertCase kConvertCases[] = {
+    {input::InputFormat::RGBA, "RGBA"},
+    {input::InputFormat::BGRA, "BGRA"},
+    {input::InputFormat::NV12, "NV12"},
+    {input::InputFormat::NV21, "NV21"},
+    {input::InputFormat::YUV420, "YUV420"},
+};
+
+// =============================================================================
+// 帧包池
+// =============================================================================
+
+void BM_FramePacketPoolAcquireRelease(benchmark::State& state) {
+    FramePacketPoolConfig config;
+    config.capacity = static_cast<uint32_t>(state.range(0));
+    config.blockOnEmpty = false;
+    auto pool = std::make_shared<FramePacketPool>(config);
+    pool->preallocate();
+
+    for (auto _ : state) {
+        FramePacketPtr packet = pool->acquire();
+        benchmark::DoNotOptimize(packet.get());
+        pool->release(std::move(packet));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FramePacketPoolAcquireRelease)->Arg(3)->Arg(5)->Arg(16);
+
+void BM_FramePacketPoolContended(benchmark::State& state) {
+    static std::shared_ptr<FramePacketPool> pool;
+    if (state.thread_index() == 0) {
+        FramePacketPoolConfig config;
+        config.capacity = 16;
+        config.blockOnEmpty = false;
+        pool = std::make_shared<FramePacketPool>(config);
+        pool->preallocate();
+    }
+
+    for (auto _ : state) {
+        FramePacketPtr packet = pool->tryAcquire();
+        benchmark::DoNotOptimize(packet.get());
+        packet.reset();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        pool.reset();
+    }
+}
+BENCHMARK(BM_FramePacketPoolContended)->ThreadRange(1, 4)->UseRealTime();
+
+// =============================================================================
+// 纹理池（需要可用的渲染上下文，否则跳过）
+// =============================================================================
+
+void BM_TexturePoolAcquire(benchmark::State& state) {
+    using namespace lrengine::render;
+
+    RenderContextDescriptor desc;
+#if defined(__APPLE__)
+    desc.backend = Backend::Metal;
+#elif defined(__ANDROID__)
+    desc.backend = Backend::OpenGLES;
+#else
+    desc.backend = Backend::OpenGL;
+#endif
+    desc.windowHandle = nullptr;
+    desc.width = 64;
+    desc.height = 64;
+    desc.vsync = false;
+    desc.applicationName = "pipeline_bench";
+
+    LRRenderContext* renderContext = LRRenderContext::Create(desc);
+    if (!renderContext) {
+        state.SkipWithError("No render context available");
+        return;
+    }
+
+    {
+        auto pool = std::make_shared<TexturePool>(renderContext);
+        const auto size = static_cast<uint32_t>(state.range(0));
+
+        // 预热：首个纹理在循环外创建，循环内测量命中复用的路径
+        pool->release(pool->acquire(size, size));
+
+        for (auto _ : state) {
+            auto texture = pool->acquire(size, size);
+            benchmark::DoNotOptimize(texture.get());
+            pool->release(std::move(texture));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    LRRenderContext::Destroy(renderContext);
+}
+BENCHMARK(BM_TexturePoolAcquire)->Arg(720)->Arg(1080);
+
+// =============================================================================
+// 图分层
+// =============================================================================
+
+void BM_GraphExecutionLevels(benchmark::State& state) {
+    PipelineGraph graph;
+    buildLayeredGraph(graph, 4, static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        auto levels = graph.getExecutionLevels();
+        benchmark::DoNotOptimize(levels.data());
+    }
+    state.counters["entities"] = static_cast<double>(4 * state.range(0) + 2);
+}
+BENCHMARK(BM_GraphExecutionLevels)->RangeMultiplier(4)->Range(2, 128);
+
+// =============================================================================
+// 输入格式转换
+// =============================================================================
+
+void BM_InputConvertToRGBA(benchmark::State& state) {
+    const ConvertCase& convertCase = kConvertCases[state.range(0)];
+    const auto width = static_cast<uint32_t>(state.range(1));
+    const auto height = static_cast<uint32_t>(state.range(2));
+
+    // 按最大的 RGBA 尺寸分配源数据，各格式共用
+    std::vector<uint8_t> source(static_cast<size_t>(width) * height * 4, 128);
+    std::vector<uint8_t> output(static_cast<size_t>(width) * height * 4);
+
+    input::CPUInputData data;
+    data.width = width;
+    data.height = height;
+    data.format = convertCase.format;
+    data.data = source.data();
+    data.dataSize = source.size();
+    switch (convertCase.format) {
+        case input::InputFormat::RGBA:
+        case input::InputFormat::BGRA:
+            data.stride = width * 4;
+            break;
+        case input::InputFormat::YUV420:
+            data.planeY = source.data();
+            data.planeU = data.planeY + static_cast<size_t>(width) * height;
+            data.planeV = data.planeU + static_cast<size_t>(width / 2) * (height / 2);
+            data.strideY = width;
+            data.strideU = width / 2;
+            data.strideV = width / 2;
+            break;
+        default:
+            data.planeY = source.data();
+            data.planeU = data.planeY + static_cast<size_t>(width) * height;
+            data.strideY = width;
+            data.strideU = width;
+            break;
+    }
+
+    input::InputEntity entity("bench_input");
+    for (auto _ : state) {
+        bool ok = input::InputEntityBenchAccess::convertToRGBA(entity, data, output.data());
+        benchmark::DoNotOptimize(ok);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(convertCase.name);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(output.size()));
+}
+BENCHMARK(BM_InputConvertToRGBA)
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {1280}, {720}})
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {1920}, {1080}})
+    ->ArgsProduct({{0, 2, 4}, {3840}, {2160}})
+    ->Unit(benchmark::kMicrosecond);
+
+// =============================================================================
+// 元数据
+// =============================================================================
+
+inline const MetadataKey<int64_t> kBenchTypedKey{"bench_typed"};
+
+void BM_MetadataStringSetGet(benchmark::State& state) {
+    FramePacket packet(1);
+    int64_t value = 0;
+    for (auto _ : state) {
+        packet.setMetadata("bench_value", value++);
+        auto result = packet.getMetadata<int64_t>("bench_value");
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MetadataStringSetGet);
+
+void BM_MetadataTypedSetGet(benchmark::State& state) {
+    FramePacket packet(1);
+    int64_t value = 0;
+    for (auto _ : state) {
+        packet.setMetadata(kBenchTypedKey, value++);
+        const int64_t* result = packet.getMetadata(kBenchTypedKey);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MetadataTypedSetGet);
+
+// =============================================================================
+// 端到端：合成图吞吐
+// =============================================================================
+
+void runGraphThroughput(benchmark::State& state, bool parallel) {
+    PipelineLog::setMinLevel(LogLevel::Warning);
+
+    PipelineGraph graph;
+    EntityId source = buildLayeredGraph(graph, static_cast<int>(state.range(0)),
+                                        static_cast<int>(state.range(1)));
+
+    ExecutorConfig config;
+    config.enableFrameSkipping = false;
+    config.enableParallelExecution = parallel;
+    PipelineExecutor executor(&graph, config);
+    executor.setContext(std::make_shared<PipelineContext>());
+    executor.setInputEntityId(source);
+    if (!executor.initialize()) {
+        state.SkipWithError("Executor initialization failed");
+        return;
+    }
+
+    uint64_t frameId = 0;
+    for (auto _ : state) {
+        auto packet = std::make_shared<FramePacket>(++frameId);
+        packet->setTimestamp(frameId * 33333);
+        benchmark::DoNotOptimize(executor.processFrame(std::move(packet)));
+    }
+    executor.flush();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["avg_frame_us"] = static_cast<double>(executor.getStats().averageFrameTime);
+
+    executor.shutdown();
+}
+
+void BM_GraphThroughputSerial(benchmark::State& state) {
+    runGraphThroughput(state, false);
+}
+BENCHMARK(BM_GraphThroughputSerial)->Args({1, 4})->Args({4, 4})->Args({8, 8})->UseRealTime();
+
+void BM_GraphThroughputParallel(benchmark::State& state) {
+    runGraphThroughput(state, true);
+}
+BENCHMARK(BM_GraphThroughputParallel)->Args({1, 4})->Args({4, 4})->Args({8, 8})->UseRealTime();
+
+// =============================================================================
+// 录制回放
+// =============================================================================
+
+/**
+ * @brief 模拟 CPU 节点：按缓存行读取整帧 CPU 缓冲，代表检测类负载的内存访问
+ */
+class MockCPUEntity : public ProcessEntity {
+public:
+    explicit MockCPUEntity(const std::string& name) : ProcessEntity(name) {
+        addInputPort("input0");
+        addOutputPort("output");
+    }
+
+    EntityType getType() const override { return EntityType::CPU; }
+
+    ExecutionQueue getExecutionQueue() const override { return ExecutionQueue::CPUParallel; }
+
+protected:
+    bool process(const std::vector<FramePacketPtr>& inputs,
+                 std::vector<FramePacketPtr>& outputs,
+                 PipelineContext& context) override {
+        (void)context;
+        if (inputs.empty() || !inputs[0]) {
+            return false;
+        }
+        const uint8_t* data = inputs[0]->getCpuBuffer();
+        uint32_t sum = 0;
+        for (size_t i = 0; data && i < inputs[0]->getCpuBufferSize(); i += 64) {
+            sum += data[i];
+        }
+        benchmark::DoNotOptimize(sum);
+        outputs.assign(1, inputs[0]);
+        return true;
+    }
+};
+
+/**
+ * 录制文件由 PIPELINE_BENCH_RECORDING 指定（InputEntity::startRecording 生成），未设置时跳过。
+ * 每次迭代以最快速度无丢帧地回放整份录制，经异步任务链执行；
+ * 计数器为各Entity执行耗时的 p50/p95（微秒）。
+ */
+void BM_ReplayRecording(benchmark::State& state) {
+    const char* path = std::getenv("PIPELINE_BENCH_RECORDING");
+    if (!path || !*path) {
+        state.SkipWithError("PIPELINE_BENCH_RECORDING not set");
+        return;
+    }
+    input::FrameRecordingReader reader;
+    if (!reader.open(path) || reader.getFrameCount() == 0) {
+        state.SkipWithError("Failed to open recording");
+        return;
+    }
+    PipelineLog::setMinLevel(LogLevel::Warning);
+
+    // 与录制时相同的输入配置，只保留 CPU 输出（无渲染上下文）
+    input::InputConfig inputConfig = reader.getInputConfig();
+    inputConfig.dataType = input::InputDataType::CPUBuffer;
+    inputConfig.enableDualOutput = false;
+    inputConfig.queueMode = input::InputQueueMode::Fifo;
+    auto inputEntity = std::make_shared<input::InputEntity>("replay_input");
+    inputEntity->configure(inputConfig);
+
+    PipelineGraph graph;
+    EntityId inputId = graph.addEntity(inputEntity);
+    EntityId consumerId = graph.addEntity(std::make_shared<MockCPUEntity>("consumer"));
+    graph.connect(inputId, input::CPU_OUTPUT_PORT, consumerId, "input0");
+
+    ExecutorConfig config;
+    config.enableFrameSkipping = false;
+    config.enableProfiling = true;
+    PipelineExecutor executor(&graph, config);
+    executor.setContext(std::make_shared<PipelineContext>());
+    executor.setInputEntityId(inputId);
+    if (!executor.initialize()) {
+        state.SkipWithError("Executor initialization failed");
+        return;
+    }
+    inputEntity->setExecutor(&executor);
+    inputEntity->startProcessingLoop();
+
+    input::FrameReplayer replayer(reader);
+    input::ReplayOptions options;
+    options.speed = input::ReplaySpeed::Max;
+    options.lossless = true;
+
+    uint64_t frames = 0;
+    for (auto _ : state) {
+        const ExecutionStats before = executor.getStats();
+        const uint64_t submitted = replayer.replay(*inputEntity, options);
+        frames += submitted;
+
+        // 等待本轮提交的帧全部结束（完成或丢弃）
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        for (;;) {
+            const ExecutionStats now = executor.getStats();
+            uint64_t finished = (now.totalFrames - before.totalFrames) +
+                                (now.droppedFrames - before.droppedFrames);
+            if (finished >= submitted || std::chrono::steady_clock::now() > deadline) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(frames));
+
+    const ProfilingSnapshot snapshot = executor.getProfilingSnapshot();
+    state.counters["frame_p50_us"] = static_cast<double>(snapshot.frameTime.p50);
+    state.counters["frame_p95_us"] = static_cast<double>(snapshot.frameTime.p95);
+    for (const auto& entity : snapshot.entities) {
+        state.counters[entity.name + ".p50_us"] = static_cast<double>(entity.wallTime.p50);
+        state.counters[entity.name + ".p95_us"] = static_cast<double>(entity.wallTime.p95);
+    }
+
+    inputEntity->stopProcessingLoop();
+    executor.shutdown();
+}
+BENCHMARK(BM_ReplayRecording)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // anonymous namespace
+
+BENCHMARK_MAIN();
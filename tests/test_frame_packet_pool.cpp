@@ -0,0 +1,263 @@
+/**
+ * @file test_frame_packet_pool.cpp
+ * @brief MPMCQueue / FramePacketPool 单元测试
+ */
+
+#include "pipeline/pool/FramePacketPool.h"
+#include "pipeline/utils/MPMCQueue.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace pipeline;
+
+void test_mpmc_capacity_and_order() {
+    std::cout << "=== Test: MPMC Capacity and Order ===" << std::endl;
+
+    // 容量向上取整为 2 的幂
+    MPMCQueue<int> queue(5);
+    assert(queue.capacity() == 8);
+    for (int i = 0; i < 8; ++i) {
+        assert(queue.tryPush(i));
+    }
+    assert(!queue.tryPush(8) && "Full queue should reject");
+    assert(queue.sizeApprox() == 8);
+
+    // 单线程下按入队顺序出队，多轮覆盖下标回绕
+    int expected = 0;
+    int next = 8;
+    int value = -1;
+    for (int round = 0; round < 50; ++round) {
+        assert(queue.tryPop(value) && value == expected++);
+        assert(queue.tryPush(next++));
+    }
+    while (queue.tryPop(value)) {
+        assert(value == expected++);
+    }
+    assert(expected == next);
+    assert(!queue.tryPop(value) && "Empty queue should not pop");
+
+    std::cout << "✓ MPMC capacity and order test passed" << std::endl;
+}
+
+void test_mpmc_multi_thread() {
+    std::cout << "=== Test: MPMC Multi-Thread ===" << std::endl;
+
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 100000;
+    constexpr int kTotal = kProducers * kPerProducer;
+
+    MPMCQueue<int> queue(64);
+    std::unique_ptr<std::atomic<uint8_t>[]> seen(new std::atomic<uint8_t>[kTotal]);
+    for (int i = 0; i < kTotal; ++i) {
+        seen[i].store(0, std::memory_order_relaxed);
+    }
+    std::atomic<int> consumed{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!queue.tryPush(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&] {
+            int value = -1;
+            while (consumed.load(std::memory_order_relaxed) < kTotal) {
+                if (queue.tryPop(value)) {
+                    assert(seen[value].fetch_add(1, std::memory_order_relaxed) == 0 &&
+                           "Each value should be popped exactly once");
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < kTotal; ++i) {
+        assert(seen[i].load(std::memory_order_relaxed) == 1);
+    }
+
+    std::cout << "✓ MPMC multi-thread test passed" << std::endl;
+}
+
+void test_pool_reuse() {
+    std::cout << "=== Test: Pool Acquire/Release Reuse ===" << std::endl;
+
+    FramePacketPoolConfig config;
+    config.capacity = 1;
+    auto pool = std::make_shared<FramePacketPool>(config);
+
+    FramePacket* first = nullptr;
+    {
+        auto packet = pool->acquire();
+        assert(packet != nullptr);
+        first = packet.get();
+        packet->setTimestamp(1234);
+        assert(pool->getInUseCount() == 1);
+        assert(pool->getCreatedCount() == 1);
+    }
+    // 最后一个引用释放时归还，不需要调用 release
+    assert(pool->getInUseCount() == 0);
+    assert(pool->getAvailableCount() == 1);
+    assert(pool->getTotalReleases() == 1);
+
+    auto again = pool->acquire();
+    assert(again.get() == first && "Released packet should be reused");
+    assert(again->getTimestamp() == 0 && "Reused packet should be reset");
+    assert(pool->getCreatedCount() == 1);
+
+    // 显式 release 与引用计数归还等价；共享引用仍在时不归还
+    auto shared = again;
+    pool->release(std::move(again));
+    assert(pool->getInUseCount() == 1);
+    shared.reset();
+    assert(pool->getInUseCount() == 0);
+    assert(pool->waitAllReleased(0));
+
+    std::cout << "✓ Pool reuse test passed" << std::endl;
+}
+
+void test_pool_capacity_cap() {
+    std::cout << "=== Test: Pool Capacity Cap ===" << std::endl;
+
+    FramePacketPoolConfig config;
+    config.capacity = 3;
+    config.blockOnEmpty = true;
+    config.blockTimeoutMs = 10;
+    auto pool = std::make_shared<FramePacketPool>(config);
+
+    std::vector<FramePacketPtr> held;
+    for (uint32_t i = 0; i < config.capacity; ++i) {
+        held.push_back(pool->acquire());
+        assert(held.back() != nullptr);
+    }
+    assert(pool->getCreatedCount() == config.capacity);
+
+    // 池满：非阻塞返回空，阻塞等待超时返回空
+    assert(pool->tryAcquire() == nullptr);
+    assert(pool->acquire() == nullptr);
+    assert(pool->getTimeoutCount() == 1);
+    assert(pool->getCreatedCount() == config.capacity && "Should never exceed capacity");
+
+    // 归还一个后即可再取
+    held.pop_back();
+    assert(pool->tryAcquire() != nullptr);
+
+    // 缩容：在外的帧包归还时释放，不再回到池中
+    pool->setCapacity(1);
+    held.clear();
+    assert(pool->getCreatedCount() <= 1);
+    assert(pool->getAvailableCount() <= 1);
+
+    std::cout << "✓ Pool capacity cap test passed" << std::endl;
+}
+
+void test_pool_destroyed_before_packet() {
+    std::cout << "=== Test: Packet Released After Pool Destroyed ===" << std::endl;
+
+    FramePacketPoolConfig config;
+    config.capacity = 2;
+    auto pool = std::make_shared<FramePacketPool>(config);
+    pool->preallocate();
+    assert(pool->getAvailableCount() == 2);
+
+    auto survivor = pool->acquire();
+    auto copy = survivor;
+    assert(survivor != nullptr);
+    pool.reset();
+
+    // 删除器持有池的共享状态，池销毁后归还直接释放
+    survivor->setTimestamp(42);
+    survivor.reset();
+    assert(copy->getTimestamp() == 42);
+    copy.reset();
+
+    std::cout << "✓ Packet after pool destruction test passed" << std::endl;
+}
+
+void test_pool_multi_thread() {
+    std::cout << "=== Test: Pool Multi-Thread Acquire/Release ===" << std::endl;
+
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 20000;
+
+    FramePacketPoolConfig config;
+    config.capacity = 3;
+    config.blockOnEmpty = true;
+    config.blockTimeoutMs = 1000;
+    auto pool = std::make_shared<FramePacketPool>(config);
+
+    std::atomic<int> acquired{0};
+    std::atomic<int> timeouts{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kIterations; ++i) {
+                auto packet = pool->acquire();
+                if (!packet) {
+                    timeouts.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                // 容量上限由已创建数保证；使用中计数在并发归还时可能短暂多计一个
+                assert(pool->getCreatedCount() <= config.capacity);
+                packet->setTimestamp(static_cast<uint64_t>(t) * kIterations + i);
+                acquired.fetch_add(1, std::memory_order_relaxed);
+                // 部分帧包交给另一个引用再释放，覆盖跨引用归还
+                if (i % 3 == 0) {
+                    FramePacketPtr handoff = std::move(packet);
+                    handoff.reset();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    assert(timeouts.load() == 0 && "Packets should cycle back before the timeout");
+    assert(acquired.load() == kThreads * kIterations);
+    assert(pool->waitAllReleased(1000));
+    assert(pool->getInUseCount() == 0);
+    assert(pool->getCreatedCount() <= config.capacity);
+    assert(pool->getTotalReleases() == static_cast<uint64_t>(acquired.load()));
+
+    std::cout << "✓ Pool multi-thread test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "FramePacket Pool Tests" << std::endl;
+    std::cout << "========================================" << std::endl << std::endl;
+
+    try {
+        test_mpmc_capacity_and_order();
+        test_mpmc_multi_thread();
+        test_pool_reuse();
+        test_pool_capacity_cap();
+        test_pool_destroyed_before_packet();
+        test_pool_multi_thread();
+
+        std::cout << std::endl << "========================================" << std::endl;
+        std::cout << "All pool tests passed! ✓" << std::endl;
+        std::cout << "========================================" << std::endl;
+
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,205 @@
+/**
+ * @file test_parameter_block.cpp
+ * @brief ParameterBlock 三缓冲参数单元测试
+ */
+
+#include "pipeline/utils/ParameterBlock.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace pipeline;
+
+namespace {
+
+// 各字段由同一次写入设为相同值，读到不相等即为撕裂
+struct TestParams {
+    int version = 0;
+    float intensity = 0.0f;
+    int a = 0;
+    int b = 0;
+    int c = 0;
+    int d = 0;
+};
+
+bool isConsistent(const TestParams& p) {
+    return p.a == p.version && p.b == p.version && p.c == p.version && p.d == p.version &&
+           p.intensity == static_cast<float>(p.version);
+}
+
+void setAll(TestParams& p, int version) {
+    p.version = version;
+    p.intensity = static_cast<float>(version);
+    p.a = version;
+    p.b = version;
+    p.c = version;
+    p.d = version;
+}
+
+} // anonymous namespace
+
+void test_parameter_initial_value() {
+    std::cout << "=== Test: Parameter Initial Value ===" << std::endl;
+
+    TestParams initial;
+    setAll(initial, 7);
+    ParameterBlock<TestParams> block(initial);
+
+    // 初值在所有槽中可见，但未发布前 acquire 不报告新值
+    assert(block.current().version == 7);
+    assert(!block.acquire() && "Nothing published yet");
+    assert(block.current().version == 7);
+    assert(block.read([](const TestParams& p) { return p.version; }) == 7);
+
+    std::cout << "✓ Parameter initial value test passed" << std::endl;
+}
+
+void test_parameter_publish_acquire() {
+    std::cout << "=== Test: Parameter Publish/Acquire ===" << std::endl;
+
+    ParameterBlock<TestParams> block;
+
+    // 发布后读取方在 acquire 之前看不到新值
+    block.update([](TestParams& p) { setAll(p, 1); });
+    assert(block.current().version == 0 && "Reader should not see unacquired values");
+    assert(block.read([](const TestParams& p) { return p.version; }) == 1);
+
+    assert(block.acquire());
+    assert(block.current().version == 1 && isConsistent(block.current()));
+    assert(!block.acquire() && "Same publish should be acquired only once");
+    assert(block.current().version == 1 && "Current should stay between acquires");
+
+    // update 在暂存副本上累积修改，未改动的字段保持上次的值
+    block.update([](TestParams& p) { p.intensity = 0.5f; });
+    assert(block.acquire());
+    assert(block.current().version == 1 && block.current().intensity == 0.5f);
+
+    // 整块替换
+    TestParams replaced;
+    setAll(replaced, 3);
+    block.publish(replaced);
+    assert(block.acquire());
+    assert(block.current().version == 3 && isConsistent(block.current()));
+
+    std::cout << "✓ Parameter publish/acquire test passed" << std::endl;
+}
+
+void test_parameter_latest_wins() {
+    std::cout << "=== Test: Parameter Latest Wins ===" << std::endl;
+
+    ParameterBlock<TestParams> block;
+
+    // 两次 acquire 之间多次发布，只取到最后一次
+    for (int round = 1; round <= 20; ++round) {
+        const int publishes = 1 + round % 4;
+        for (int i = 0; i < publishes; ++i) {
+            block.update([&](TestParams& p) { setAll(p, round * 10 + i); });
+        }
+        assert(block.acquire());
+        assert(block.current().version == round * 10 + publishes - 1);
+        assert(isConsistent(block.current()));
+        assert(!block.acquire());
+    }
+
+    std::cout << "✓ Parameter latest wins test passed" << std::endl;
+}
+
+void test_parameter_two_thread_stress() {
+    std::cout << "=== Test: Parameter Two-Thread Stress ===" << std::endl;
+
+    constexpr int kCount = 200000;
+    ParameterBlock<TestParams> block;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (int i = 1; i <= kCount; ++i) {
+            block.update([i](TestParams& p) { setAll(p, i); });
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    // 读取方看到的参数从不撕裂，版本单调不减，且最终取到最后一次发布
+    int last = 0;
+    int acquired = 0;
+    for (;;) {
+        const bool finished = done.load(std::memory_order_acquire);
+        if (block.acquire()) {
+            const TestParams& p = block.current();
+            assert(isConsistent(p) && "Reader should never see a torn parameter block");
+            assert(p.version > last && "Acquired versions should increase");
+            last = p.version;
+            ++acquired;
+        }
+        assert(isConsistent(block.current()));
+        if (finished && !block.acquire()) {
+            break;
+        }
+    }
+    writer.join();
+    assert(last == kCount && "Reader should end on the latest publish");
+    assert(acquired > 0);
+
+    std::cout << "✓ Parameter two-thread stress test passed" << std::endl;
+}
+
+void test_parameter_multi_writer_stress() {
+    std::cout << "=== Test: Parameter Multi-Writer Stress ===" << std::endl;
+
+    constexpr int kWriters = 3;
+    constexpr int kPerWriter = 50000;
+    ParameterBlock<TestParams> block;
+    std::atomic<int> finishedWriters{0};
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < kPerWriter; ++i) {
+                block.update([&](TestParams& p) { setAll(p, w * kPerWriter + i + 1); });
+                // 写入方视角同样一致
+                assert(block.read([](const TestParams& p) { return isConsistent(p); }));
+            }
+            finishedWriters.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    // 多个写入者由写锁串行，读取方仍只看到完整的某一次发布
+    while (finishedWriters.load(std::memory_order_acquire) < kWriters) {
+        if (block.acquire()) {
+            assert(isConsistent(block.current()));
+        }
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    block.acquire();
+    assert(isConsistent(block.current()));
+    assert(block.current().version == block.read([](const TestParams& p) { return p.version; }));
+
+    std::cout << "✓ Parameter multi-writer stress test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Parameter Block Tests" << std::endl;
+    std::cout << "========================================" << std::endl << std::endl;
+
+    try {
+        test_parameter_initial_value();
+        test_parameter_publish_acquire();
+        test_parameter_latest_wins();
+        test_parameter_two_thread_stress();
+        test_parameter_multi_writer_stress();
+
+        std::cout << std::endl << "========================================" << std::endl;
+        std::cout << "All parameter block tests passed! ✓" << std::endl;
+        std::cout << "========================================" << std::endl;
+
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,341 @@
+/**
+ * @file test_pipeline_graph.cpp
+ * @brief PipelineGraph 增量拓扑序与执行层级单元测试
+ *
+ * 每次增删边/节点后，把增量维护的拓扑序和层级与按当前边集完整重算的结果对比。
+ */
+
+#include "pipeline/core/PipelineGraph.h"
+#include "pipeline/entity/ProcessEntity.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace pipeline;
+
+namespace {
+
+// 每个节点的输入端口数（随机测试中多条入边各占一个端口）
+constexpr size_t kInputPortCount = 16;
+
+class MockEntity : public ProcessEntity {
+public:
+    explicit MockEntity(const std::string& name) : ProcessEntity(name) {
+        for (size_t i = 0; i < kInputPortCount; ++i) {
+            addInputPort("input" + std::to_string(i));
+        }
+        addOutputPort("output");
+    }
+
+    EntityType getType() const override { return EntityType::CPU; }
+
+protected:
+    bool process(const std::vector<FramePacketPtr>& inputs,
+                 std::vector<FramePacketPtr>& outputs,
+                 PipelineContext& context) override {
+        (void)context;
+        outputs.assign(1, inputs.empty() ? nullptr : inputs[0]);
+        return true;
+    }
+};
+
+EntityId addNode(PipelineGraph& graph, const std::string& name) {
+    return graph.addEntity(std::make_shared<MockEntity>(name));
+}
+
+bool connectNodes(PipelineGraph& graph, EntityId src, EntityId dst, size_t port = 0) {
+    return graph.connect(src, "output", dst, "input" + std::to_string(port));
+}
+
+// 按当前边集完整重算（Kahn）：返回每个节点到源节点的最长路径
+std::unordered_map<EntityId, uint32_t> referenceLevels(const PipelineGraph& graph) {
+    std::unordered_map<EntityId, size_t> inDegree;
+    std::unordered_map<EntityId, std::vector<EntityId>> successors;
+    for (const auto& entity : graph.getAllEntities()) {
+        inDegree[entity->getId()] = 0;
+    }
+    for (const auto& conn : graph.getAllConnections()) {
+        successors[conn.srcEntity].push_back(conn.dstEntity);
+        ++inDegree[conn.dstEntity];
+    }
+
+    std::unordered_map<EntityId, uint32_t> levels;
+    std::vector<EntityId> ready;
+    for (const auto& [id, degree] : inDegree) {
+        if (degree == 0) {
+            ready.push_back(id);
+            levels[id] = 0;
+        }
+    }
+    size_t visited = 0;
+    while (!ready.empty()) {
+        EntityId id = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (EntityId next : successors[id]) {
+            levels[next] = std::max(levels[next], levels[id] + 1);
+            if (--inDegree[next] == 0) {
+                ready.push_back(next);
+            }
+        }
+    }
+    assert(visited == inDegree.size() && "Reference sort found a cycle");
+    return levels;
+}
+
+// dst 是否可由 src 到达（用于判断新边是否成环）
+bool reachable(const PipelineGraph& graph, EntityId src, EntityId dst) {
+    std::unordered_set<EntityId> visited{src};
+    std::vector<EntityId> stack{src};
+    while (!stack.empty()) {
+        EntityId id = stack.back();
+        stack.pop_back();
+        if (id == dst) {
+            return true;
+        }
+        for (EntityId next : graph.getSuccessors(id)) {
+            if (visited.insert(next).second) {
+                stack.push_back(next);
+            }
+        }
+    }
+    return false;
+}
+
+// 增量结果与完整重算一致：拓扑序覆盖全部节点且每条边前指后，层级逐一相等
+void checkAgainstFullSort(const PipelineGraph& graph) {
+    const auto order = graph.getTopologicalOrder();
+    assert(order.size() == graph.getEntityCount());
+
+    std::unordered_map<EntityId, size_t> position;
+    for (size_t i = 0; i < order.size(); ++i) {
+        assert(graph.hasEntity(order[i]));
+        assert(position.emplace(order[i], i).second && "Entity appears twice in order");
+    }
+    for (const auto& conn : graph.getAllConnections()) {
+        assert(position.at(conn.srcEntity) < position.at(conn.dstEntity) && "Edge points backwards");
+    }
+    assert(!graph.hasCycle());
+
+    const auto expected = referenceLevels(graph);
+    const auto levels = graph.getExecutionLevels();
+    size_t total = 0;
+    for (size_t level = 0; level < levels.size(); ++level) {
+        assert(!levels[level].empty() && "Execution level left empty");
+        for (EntityId id : levels[level]) {
+            assert(expected.at(id) == level && "Level differs from full sort");
+            ++total;
+        }
+    }
+    assert(total == graph.getEntityCount());
+}
+
+} // anonymous namespace
+
+void test_graph_connect_sequence() {
+    std::cout << "=== Test: Graph Connect Sequence ===" << std::endl;
+
+    // 按加入顺序的逆序连成链，每条新边都要求重排
+    PipelineGraph graph;
+    std::vector<EntityId> nodes;
+    for (int i = 0; i < 8; ++i) {
+        nodes.push_back(addNode(graph, "node" + std::to_string(i)));
+    }
+    checkAgainstFullSort(graph);
+    assert(graph.getExecutionLevels().size() == 1);
+
+    for (size_t i = nodes.size() - 1; i > 0; --i) {
+        assert(connectNodes(graph, nodes[i], nodes[i - 1]));
+        checkAgainstFullSort(graph);
+    }
+    auto order = graph.getTopologicalOrder();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        assert(order[i] == nodes[nodes.size() - 1 - i]);
+    }
+    assert(graph.getExecutionLevels().size() == nodes.size());
+
+    // 跨层捷径不改变最长路径；重复连接视为成功且不新增边
+    const size_t edgeCount = graph.getAllConnections().size();
+    assert(connectNodes(graph, nodes[7], nodes[0], 1));
+    assert(connectNodes(graph, nodes[7], nodes[0], 1));
+    assert(graph.getAllConnections().size() == edgeCount + 1);
+    checkAgainstFullSort(graph);
+    assert(graph.getExecutionLevels().size() == nodes.size());
+
+    std::cout << "✓ Graph connect sequence test passed" << std::endl;
+}
+
+void test_graph_disconnect_sequence() {
+    std::cout << "=== Test: Graph Disconnect Sequence ===" << std::endl;
+
+    // 菱形：a -> b -> c -> d，a -> d
+    PipelineGraph graph;
+    EntityId a = addNode(graph, "a");
+    EntityId b = addNode(graph, "b");
+    EntityId c = addNode(graph, "c");
+    EntityId d = addNode(graph, "d");
+    assert(connectNodes(graph, a, b));
+    assert(connectNodes(graph, b, c));
+    assert(connectNodes(graph, c, d));
+    assert(connectNodes(graph, a, d, 1));
+    checkAgainstFullSort(graph);
+    assert(graph.getExecutionLevels().size() == 4);
+
+    // 断开长路径中间的边：d 的层级只剩 a -> d 支撑
+    assert(graph.disconnect(b, "output", c, "input0"));
+    checkAgainstFullSort(graph);
+    assert(graph.getExecutionLevels().size() == 2);
+
+    assert(!graph.disconnect(b, "output", c, "input0") && "Edge already removed");
+
+    assert(graph.disconnectAll(a, d));
+    checkAgainstFullSort(graph);
+
+    // 重新连回后层级恢复
+    assert(connectNodes(graph, b, c));
+    checkAgainstFullSort(graph);
+    assert(graph.getExecutionLevels().size() == 4);
+
+    // 断开节点的全部连接
+    graph.disconnectEntity(b);
+    checkAgainstFullSort(graph);
+    assert(graph.getInDegree(b) == 0 && graph.getOutDegree(b) == 0);
+
+    std::cout << "✓ Graph disconnect sequence test passed" << std::endl;
+}
+
+void test_graph_remove_entity() {
+    std::cout << "=== Test: Graph Remove Entity ===" << std::endl;
+
+    PipelineGraph graph;
+    std::vector<EntityId> nodes;
+    for (int i = 0; i < 10; ++i) {
+        nodes.push_back(addNode(graph, "node" + std::to_string(i)));
+        if (i > 0) {
+            assert(connectNodes(graph, nodes[i - 1], nodes[i]));
+        }
+    }
+    checkAgainstFullSort(graph);
+
+    // 删除过半节点触发拓扑序压实；下游层级随之降低
+    for (int i : {1, 3, 5, 7, 8, 9}) {
+        assert(graph.removeEntity(nodes[i]));
+        checkAgainstFullSort(graph);
+    }
+    assert(graph.getEntityCount() == 4);
+    assert(!graph.removeEntity(nodes[1]));
+
+    // 压实后继续增删
+    EntityId tail = addNode(graph, "tail");
+    assert(connectNodes(graph, tail, nodes[0]));
+    assert(connectNodes(graph, nodes[6], tail));
+    checkAgainstFullSort(graph);
+
+    std::cout << "✓ Graph remove entity test passed" << std::endl;
+}
+
+void test_graph_cycle_rejection() {
+    std::cout << "=== Test: Graph Cycle Rejection ===" << std::endl;
+
+    PipelineGraph graph;
+    EntityId a = addNode(graph, "a");
+    EntityId b = addNode(graph, "b");
+    EntityId c = addNode(graph, "c");
+    assert(connectNodes(graph, a, b));
+    assert(connectNodes(graph, b, c));
+
+    const auto order = graph.getTopologicalOrder();
+    const auto edgeCount = graph.getAllConnections().size();
+    const uint64_t version = graph.getVersion();
+
+    // 成环与自环都被拒绝，图保持不变
+    assert(!connectNodes(graph, c, a, 1));
+    assert(!connectNodes(graph, b, a, 1));
+    assert(!connectNodes(graph, a, a, 1));
+    assert(graph.getAllConnections().size() == edgeCount);
+    assert(graph.getVersion() == version);
+    assert(graph.getTopologicalOrder() == order);
+    assert(graph.getInDegree(a) == 0);
+    checkAgainstFullSort(graph);
+
+    // 断开后同一方向即可连接
+    assert(graph.disconnectAll(a, b));
+    assert(connectNodes(graph, c, a, 1));
+    checkAgainstFullSort(graph);
+
+    std::cout << "✓ Graph cycle rejection test passed" << std::endl;
+}
+
+void test_graph_random_sequence() {
+    std::cout << "=== Test: Graph Random Sequence ===" << std::endl;
+
+    // 固定种子，失败可复现
+    std::mt19937 rng(20240607u);
+    PipelineGraph graph;
+    std::vector<EntityId> nodes;
+    int nameIndex = 0;
+    for (int i = 0; i < 12; ++i) {
+        nodes.push_back(addNode(graph, "node" + std::to_string(nameIndex++)));
+    }
+
+    auto pick = [&](size_t count) {
+        return static_cast<size_t>(rng() % count);
+    };
+
+    for (int step = 0; step < 2000; ++step) {
+        const size_t op = pick(10);
+        if (op < 6) {
+            EntityId src = nodes[pick(nodes.size())];
+            EntityId dst = nodes[pick(nodes.size())];
+            const bool expected = src != dst && !reachable(graph, dst, src);
+            assert(connectNodes(graph, src, dst, pick(kInputPortCount)) == expected);
+        } else if (op < 8) {
+            auto connections = graph.getAllConnections();
+            if (!connections.empty()) {
+                const auto& conn = connections[pick(connections.size())];
+                if (op == 6) {
+                    assert(graph.disconnect(conn.srcEntity, conn.srcPort, conn.dstEntity, conn.dstPort));
+                } else {
+                    assert(graph.disconnectAll(conn.srcEntity, conn.dstEntity));
+                }
+            }
+        } else if (op == 8 && nodes.size() > 4) {
+            const size_t index = pick(nodes.size());
+            assert(graph.removeEntity(nodes[index]));
+            nodes.erase(nodes.begin() + static_cast<std::ptrdiff_t>(index));
+        } else {
+            nodes.push_back(addNode(graph, "node" + std::to_string(nameIndex++)));
+        }
+        checkAgainstFullSort(graph);
+    }
+
+    std::cout << "✓ Graph random sequence test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Pipeline Graph Tests" << std::endl;
+    std::cout << "========================================" << std::endl << std::endl;
+
+    try {
+        test_graph_connect_sequence();
+        test_graph_disconnect_sequence();
+        test_graph_remove_entity();
+        test_graph_cycle_rejection();
+        test_graph_random_sequence();
+
+        std::cout << std::endl << "========================================" << std::endl;
+        std::cout << "All graph tests passed! ✓" << std::endl;
+        std::cout << "========================================" << std::endl;
+
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -4,10 +4,14 @@
  */
 
 #include "pipeline/core/PipelineConfigJson.h"
+#include "pipeline/core/PipelineConfigBinary.h"
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 using namespace pipeline;
 
@@ -162,6 +166,165 @@ void test_json_platform_types() {
     std::cout << "✓ JSON platform types test passed" << std::endl;
 }
 
+// 二进制测试共用的配置：覆盖全部设置段、各类滤镜、字符串表与着色器键
+static const char* kBinaryTestJson = R"({
+    "version": "2.0",
+    "preset": "CameraPreview",
+    "platform": {
+        "type": "Android"
+    },
+    "input": {
+        "format": "NV12",
+        "width": 1280,
+        "height": 720
+    },
+    "output": {
+        "resolution": {
+            "width": 960,
+            "height": 540
+        }
+    },
+    "quality": "High",
+    "filters": [
+        { "type": "beauty", "params": { "smooth": 0.7, "whiten": 0.3 } },
+        { "type": "color", "params": { "name": "warm", "intensity": 0.8 } },
+        { "type": "sharpen", "params": { "amount": 0.4 } },
+        { "type": "blur", "params": { "radius": 3.0 } }
+    ],
+    "shaderCacheKeys": [42, "deadbeefcafe"]
+})";
+
+// 图结构签名：去掉实体 ID（全局递增，两次构建必然不同）后排序的节点与边标签
+static std::vector<std::string> graphSignature(const Pipeline& pipeline) {
+    std::vector<std::string> lines;
+    std::istringstream iss(pipeline.exportGraph());
+    std::string line;
+    while (std::getline(iss, line)) {
+        size_t label = line.find("[label=");
+        if (label == std::string::npos) {
+            continue;
+        }
+        std::string key = line.find(" -> ") < label ? "edge " : "node ";
+        lines.push_back(key + line.substr(label));
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+void test_binary_round_trip() {
+    std::cout << "=== Test: Binary Round Trip ===" << std::endl;
+    
+    auto binary = PipelineConfigLoader::compileBinary(kBinaryTestJson);
+    assert(binary && "Should compile JSON to binary");
+    const std::vector<uint8_t>& bytes = binary.value();
+    
+    // 视图中的取值与 JSON 一致
+    auto viewResult = BinaryGraphView::parse(bytes.data(), bytes.size());
+    assert(viewResult && "Compiled binary should parse");
+    const BinaryGraphView& view = viewResult.value();
+    
+    const BinaryGraphSettings& settings = view.settings();
+    assert(settings.flags == (kBinaryHasPlatform | kBinaryHasInput | kBinaryHasQuality | kBinaryHasResolution));
+    assert(settings.preset == static_cast<uint8_t>(PipelinePreset::CameraPreview));
+    assert(settings.platform == static_cast<uint8_t>(PlatformType::Android));
+    assert(settings.inputFormat == static_cast<uint8_t>(input::InputFormat::NV12));
+    assert(settings.quality == static_cast<uint8_t>(QualityLevel::High));
+    assert(settings.inputWidth == 1280 && settings.inputHeight == 720);
+    assert(settings.outputWidth == 960 && settings.outputHeight == 540);
+    
+    assert(view.filterCount() == 4);
+    assert(view.filter(0).kind == static_cast<uint8_t>(BinaryFilterKind::Beauty));
+    assert(view.filter(0).params[0] == 0.7f && view.filter(0).params[1] == 0.3f);
+    assert(view.filter(1).kind == static_cast<uint8_t>(BinaryFilterKind::Color));
+    assert(std::strcmp(view.string(view.filter(1).nameOffset), "warm") == 0);
+    assert(view.filter(1).params[0] == 0.8f);
+    assert(view.filter(2).kind == static_cast<uint8_t>(BinaryFilterKind::Sharpen));
+    assert(view.filter(2).params[0] == 0.4f);
+    assert(view.filter(3).kind == static_cast<uint8_t>(BinaryFilterKind::Blur));
+    assert(view.filter(3).params[0] == 3.0f);
+    assert(std::strcmp(view.string(kBinaryNoString), "") == 0);
+    
+    assert(view.shaderKeyCount() == 2);
+    assert(view.shaderKey(0) == 42);
+    assert(view.shaderKey(1) == 0xdeadbeefcafeull);
+    
+    // JSON 与二进制构建出相同的图
+    auto fromJson = PipelineConfigLoader::fromString(kBinaryTestJson);
+    auto fromBinary = PipelineBinaryLoader::fromMemory(bytes.data(), bytes.size());
+    assert(fromJson && fromJson.value() != nullptr);
+    assert(fromBinary && fromBinary.value() != nullptr);
+    assert(graphSignature(*fromJson.value()) == graphSignature(*fromBinary.value()));
+    
+    // 文件路径：compileBinaryFile + fromFile（mmap）
+    const char* jsonFile = "/tmp/test_pipeline_config_binary.json";
+    const char* binaryFile = "/tmp/test_pipeline_config.plbg";
+    std::ofstream file(jsonFile);
+    file << kBinaryTestJson;
+    file.close();
+    
+    auto compileResult = PipelineConfigLoader::compileBinaryFile(jsonFile, binaryFile);
+    assert(compileResult && "Should compile JSON file to binary file");
+    auto fromFile = PipelineBinaryLoader::fromFile(binaryFile);
+    assert(fromFile && fromFile.value() != nullptr);
+    assert(graphSignature(*fromFile.value()) == graphSignature(*fromJson.value()));
+    
+    std::remove(jsonFile);
+    std::remove(binaryFile);
+    
+    std::cout << "✓ Binary round trip test passed" << std::endl;
+}
+
+void test_binary_rejects_invalid() {
+    std::cout << "=== Test: Binary Rejects Invalid Input ===" << std::endl;
+    
+    auto binary = PipelineConfigLoader::compileBinary(kBinaryTestJson);
+    assert(binary);
+    const std::vector<uint8_t>& bytes = binary.value();
+    
+    // 截断：少于文件头、以及缺少尾部
+    assert(!BinaryGraphView::parse(bytes.data(), sizeof(BinaryGraphHeader) - 1));
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+    assert(!BinaryGraphView::parse(truncated.data(), truncated.size()));
+    assert(!PipelineBinaryLoader::fromMemory(truncated.data(), truncated.size()));
+    
+    // 校验和不匹配
+    std::vector<uint8_t> corrupted = bytes;
+    corrupted.back() ^= 0x5A;
+    assert(!BinaryGraphView::parse(corrupted.data(), corrupted.size()));
+    
+    // 版本不符（文件头不在校验和范围内，必须单独拒绝）
+    std::vector<uint8_t> wrongVersion = bytes;
+    auto* header = reinterpret_cast<BinaryGraphHeader*>(wrongVersion.data());
+    header->version = kBinaryGraphVersion + 1;
+    auto versionResult = BinaryGraphView::parse(wrongVersion.data(), wrongVersion.size());
+    assert(!versionResult);
+    assert(versionResult.error().category() == ErrorCategory::NotSupported);
+    
+    // 魔数错误
+    std::vector<uint8_t> wrongMagic = bytes;
+    reinterpret_cast<BinaryGraphHeader*>(wrongMagic.data())->magic = 0;
+    assert(!BinaryGraphView::parse(wrongMagic.data(), wrongMagic.size()));
+    
+    // 段越界（重算校验和，确保由越界检查拒绝）
+    std::vector<uint8_t> outOfBounds = bytes;
+    auto* oobHeader = reinterpret_cast<BinaryGraphHeader*>(outOfBounds.data());
+    oobHeader->filterCount = 1000;
+    oobHeader->checksum = binaryGraphChecksum(outOfBounds.data() + sizeof(BinaryGraphHeader),
+                                              outOfBounds.size() - sizeof(BinaryGraphHeader));
+    assert(!BinaryGraphView::parse(outOfBounds.data(), outOfBounds.size()));
+    
+    // 未按 8 字节对齐
+    std::vector<uint64_t> storage(bytes.size() / sizeof(uint64_t) + 2);
+    auto* misaligned = reinterpret_cast<uint8_t*>(storage.data()) + 4;
+    std::memcpy(misaligned, bytes.data(), bytes.size());
+    assert(!BinaryGraphView::parse(misaligned, bytes.size()));
+    
+    assert(!PipelineBinaryLoader::fromMemory(nullptr, 0));
+    assert(!PipelineBinaryLoader::fromFile("/tmp/does_not_exist.plbg"));
+    
+    std::cout << "✓ Binary invalid input test passed" << std::endl;
+}
+
 int main() {
     std::cout << "========================================" << std::endl;
     std::cout << "Pipeline JSON Config Tests" << std::endl;
@@ -174,6 +337,8 @@ int main() {
         test_json_export();
         test_json_parse_error();
         test_json_platform_types();
+        test_binary_round_trip();
+        test_binary_rejects_invalid();
         
         std::cout << std::endl << "========================================" << std::endl;
         std::cout << "All JSON tests passed! ✓" << std::endl;
@@ -0,0 +1,198 @@
+/**
+ * @file test_spsc_queue.cpp
+ * @brief SPSCQueue / LatestMailbox 单元测试
+ */
+
+#include "pipeline/utils/SPSCQueue.h"
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <thread>
+
+using namespace pipeline;
+
+void test_spsc_capacity() {
+    std::cout << "=== Test: SPSC Capacity ===" << std::endl;
+
+    // 槽数向上取 2 的幂，可入队数量仍严格等于 capacity
+    for (size_t capacity : {1, 3, 5, 6, 7, 8, 100}) {
+        SPSCQueue<int> queue(capacity);
+        assert(queue.capacity() == capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            assert(queue.tryPush(static_cast<int>(i)) && "Should accept up to capacity");
+        }
+        assert(!queue.tryPush(-1) && "Should reject beyond capacity");
+        assert(queue.sizeApprox() == capacity);
+
+        // 出队一个后恰好可再入队一个
+        int value = -1;
+        assert(queue.tryPop(value) && value == 0);
+        assert(queue.tryPush(-2));
+        assert(!queue.tryPush(-3));
+    }
+
+    // capacity 为 0 时按 1 处理
+    SPSCQueue<int> minimal(0);
+    assert(minimal.capacity() == 1);
+    assert(minimal.tryPush(1));
+    assert(!minimal.tryPush(2));
+
+    std::cout << "✓ SPSC capacity test passed" << std::endl;
+}
+
+void test_spsc_fifo_order() {
+    std::cout << "=== Test: SPSC FIFO Order ===" << std::endl;
+
+    // 容量非 2 的幂，多轮取还覆盖下标回绕
+    SPSCQueue<int> queue(3);
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 100; ++round) {
+        int pushes = 1 + round % 3;
+        for (int i = 0; i < pushes; ++i) {
+            assert(queue.tryPush(next++));
+        }
+        int value = -1;
+        while (queue.tryPop(value)) {
+            assert(value == expected++ && "Should pop in push order");
+        }
+        assert(queue.sizeApprox() == 0);
+    }
+    assert(expected == next);
+
+    int value = -1;
+    assert(!queue.tryPop(value) && "Empty queue should not pop");
+
+    std::cout << "✓ SPSC FIFO order test passed" << std::endl;
+}
+
+void test_spsc_releases_popped_slot() {
+    std::cout << "=== Test: SPSC Releases Popped Slot ===" << std::endl;
+
+    SPSCQueue<std::shared_ptr<int>> queue(2);
+    auto item = std::make_shared<int>(42);
+    std::weak_ptr<int> weak = item;
+    assert(queue.tryPush(std::move(item)));
+
+    std::shared_ptr<int> popped;
+    assert(queue.tryPop(popped) && *popped == 42);
+    popped.reset();
+    assert(weak.expired() && "Queue should not keep a popped element alive");
+
+    std::cout << "✓ SPSC popped slot release test passed" << std::endl;
+}
+
+void test_mailbox_publish_take() {
+    std::cout << "=== Test: Mailbox Publish/Take ===" << std::endl;
+
+    LatestMailbox<std::shared_ptr<int>> mailbox;
+    std::shared_ptr<int> value;
+    assert(!mailbox.hasValue());
+    assert(!mailbox.tryTake(value) && "Empty mailbox should not take");
+
+    // 首次发布不覆盖；未取走时再发布返回true，旧值立即释放
+    auto first = std::make_shared<int>(1);
+    std::weak_ptr<int> weakFirst = first;
+    assert(!mailbox.publish(std::move(first)));
+    assert(mailbox.hasValue());
+    assert(mailbox.publish(std::make_shared<int>(2)) && "Should report overwrite");
+    assert(weakFirst.expired() && "Overwritten value should be released");
+
+    assert(mailbox.tryTake(value) && *value == 2);
+    assert(!mailbox.hasValue());
+    assert(!mailbox.tryTake(value) && "Value should be taken only once");
+
+    // 取走后再发布不算覆盖
+    assert(!mailbox.publish(std::make_shared<int>(3)));
+    assert(mailbox.tryTake(value) && *value == 3);
+
+    std::cout << "✓ Mailbox publish/take test passed" << std::endl;
+}
+
+void test_spsc_two_thread_stress() {
+    std::cout << "=== Test: SPSC Two-Thread Stress ===" << std::endl;
+
+    constexpr int kCount = 1000000;
+    SPSCQueue<int> queue(7);
+
+    std::thread producer([&queue] {
+        for (int i = 0; i < kCount; ++i) {
+            while (!queue.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int value = -1;
+    while (expected < kCount) {
+        if (queue.tryPop(value)) {
+            assert(value == expected && "Consumer should see every value in order");
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    assert(!queue.tryPop(value));
+
+    std::cout << "✓ SPSC two-thread stress test passed" << std::endl;
+}
+
+void test_mailbox_two_thread_stress() {
+    std::cout << "=== Test: Mailbox Two-Thread Stress ===" << std::endl;
+
+    constexpr int kCount = 200000;
+    LatestMailbox<int> mailbox;
+    int overwritten = 0;
+
+    std::thread producer([&] {
+        for (int i = 1; i <= kCount; ++i) {
+            if (mailbox.publish(i)) {
+                ++overwritten;
+            }
+        }
+    });
+
+    // 取到的值严格递增；每个发布的值要么被取走，要么被覆盖
+    int taken = 0;
+    int last = 0;
+    int value = 0;
+    while (last < kCount) {
+        if (mailbox.tryTake(value)) {
+            assert(value > last && "Mailbox should only hand out newer values");
+            last = value;
+            ++taken;
+        }
+    }
+    producer.join();
+    assert(!mailbox.tryTake(value));
+    assert(taken + overwritten == kCount);
+
+    std::cout << "✓ Mailbox two-thread stress test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "SPSC Queue Tests" << std::endl;
+    std::cout << "========================================" << std::endl << std::endl;
+
+    try {
+        test_spsc_capacity();
+        test_spsc_fifo_order();
+        test_spsc_releases_popped_slot();
+        test_mailbox_publish_take();
+        test_spsc_two_thread_stress();
+        test_mailbox_two_thread_stress();
+
+        std::cout << std::endl << "========================================" << std::endl;
+        std::cout << "All SPSC queue tests passed! ✓" << std::endl;
+        std::cout << "========================================" << std::endl;
+
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+}